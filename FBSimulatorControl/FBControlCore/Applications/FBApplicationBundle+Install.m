@@ -9,6 +9,12 @@
 
 #import "FBApplicationBundle+Install.h"
 
+#import <signal.h>
+#import <stdlib.h>
+#import <unistd.h>
+
+#import "FBArchiveExtractionCache.h"
+#import "FBArchiveUnpacker.h"
 #import "FBBinaryDescriptor.h"
 #import "FBBinaryParser.h"
 #import "FBCollectionInformation.h"
@@ -16,8 +22,6 @@
 #import "FBControlCoreError.h"
 #import "FBControlCoreGlobalConfiguration.h"
 #import "FBControlCoreLogger.h"
-#import "FBTask.h"
-#import "FBTaskBuilder.h"
 
 @implementation FBExtractedApplication
 
@@ -36,6 +40,34 @@
 
 @end
 
+static const NSUInteger ExtractionCacheCapacity = 8;
+static NSString *const ExtractionCachePrefix = @"FBApplicationExtractionCache_";
+static char *ExtractionCacheRootPath = NULL;
+
+static void RemoveExtractionCache(void)
+{
+  if (!ExtractionCacheRootPath) {
+    return;
+  }
+  [NSFileManager.defaultManager removeItemAtPath:[NSFileManager.defaultManager stringWithFileSystemRepresentation:ExtractionCacheRootPath length:strlen(ExtractionCacheRootPath)] error:nil];
+}
+
+static void RemoveAbandonedExtractionCaches(void)
+{
+  NSString *temporaryDirectory = NSTemporaryDirectory();
+  for (NSString *name in [NSFileManager.defaultManager contentsOfDirectoryAtPath:temporaryDirectory error:nil]) {
+    if (![name hasPrefix:ExtractionCachePrefix]) {
+      continue;
+    }
+    pid_t processIdentifier = [name substringFromIndex:ExtractionCachePrefix.length].intValue;
+    // Only remove the caches of processes that no longer exist.
+    if (processIdentifier <= 0 || processIdentifier == getpid() || kill(processIdentifier, 0) == 0 || errno != ESRCH) {
+      continue;
+    }
+    [NSFileManager.defaultManager removeItemAtPath:[temporaryDirectory stringByAppendingPathComponent:name] error:nil];
+  }
+}
+
 static BOOL deleteDirectory(NSURL *path)
 {
   if (path == nil) {
@@ -50,18 +82,29 @@ static BOOL deleteDirectory(NSURL *path)
 
 + (FBFutureContext<FBExtractedApplication *> *)onQueue:(dispatch_queue_t)queue findOrExtractApplicationAtPath:(NSString *)path logger:(id<FBControlCoreLogger>)logger;
 {
-  NSURL *extractPath = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:NSProcessInfo.processInfo.globallyUniqueString] isDirectory:YES];
-  return [[FBApplicationBundle
-    findOrExtractApplicationAtPath:path extractPath:extractPath queue:queue logger:logger]
-    onQueue:queue pend:^(NSString *appPath) {
-      NSError *error = nil;
-      FBApplicationBundle *bundle = [FBApplicationBundle applicationWithPath:appPath error:&error];
-      if (!bundle) {
-        return [FBFuture futureWithError:error];
-      }
-      FBExtractedApplication *application = [[FBExtractedApplication alloc] initWithBundle:bundle extractedPath:extractPath];
-      return [FBFuture futureWithResult:application];
-  }];
+  // If it's an App, we don't need to do anything, just return early.
+  if ([FBApplicationBundle isApplicationAtPath:path]) {
+    NSURL *extractPath = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:NSProcessInfo.processInfo.globallyUniqueString] isDirectory:YES];
+    return [FBFutureContext futureContextWithFuture:[FBApplicationBundle extractedApplicationWithAppPath:path extractPath:extractPath]];
+  }
+  // The other case is that this is an IPA, check it is before extacting.
+  NSError *error = nil;
+  if (![FBApplicationBundle isIPAAtPath:path error:&error]) {
+    return [[[FBControlCoreError
+      describeFormat:@"File at path %@ is neither an IPA nor an .app", path]
+      causedBy:error]
+      failFutureContext];
+  }
+  // IPAs are extracted once per distinct content, each install then recieves its own copy of the extracted tree.
+  return [[FBApplicationBundle.extractionCache
+    extractArchiveAtPath:path logger:logger]
+    onQueue:queue pend:^(NSURL *extractPath) {
+      return [[FBApplicationBundle
+        findAppPathFromDirectory:extractPath]
+        onQueue:queue fmap:^(NSString *appPath) {
+          return [FBApplicationBundle extractedApplicationWithAppPath:appPath extractPath:extractPath];
+        }];
+    }];
 }
 
 + (NSString *)copyFrameworkToApplicationAtPath:(NSString *)appPath frameworkPath:(NSString *)frameworkPath
@@ -151,47 +194,41 @@ static unsigned short const TarFileMagicHeader = 0x8b1f;
   return magic == ZipFileMagicHeader;
 }
 
-+ (FBFutureContext<NSString *> *)findOrExtractApplicationAtPath:(NSString *)path extractPath:(NSURL *)extractPath queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
++ (FBArchiveExtractionCache *)extractionCache
+{
+  static dispatch_once_t onceToken;
+  static FBArchiveExtractionCache *cache;
+  dispatch_once(&onceToken, ^{
+    // The cache is private to this process, so that eviction can never race with another process that is using the same tree.
+    // It is removed when the process exits, and the caches of processes that exited without doing so are removed here.
+    RemoveAbandonedExtractionCaches();
+    NSString *directoryName = [NSString stringWithFormat:@"%@%d", ExtractionCachePrefix, getpid()];
+    NSURL *rootDirectory = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:directoryName] isDirectory:YES];
+    ExtractionCacheRootPath = strdup(rootDirectory.fileSystemRepresentation);
+    atexit(RemoveExtractionCache);
+    cache = [FBArchiveExtractionCache cacheWithRootDirectory:rootDirectory capacity:ExtractionCacheCapacity extractor:^(NSString *archivePath, NSURL *destination, id<FBControlCoreLogger> extractLogger) {
+      return [FBApplicationBundle extractIPAAtPath:archivePath toPath:destination logger:extractLogger];
+    }];
+  });
+  return cache;
+}
+
++ (FBFuture<NSNull *> *)extractIPAAtPath:(NSString *)path toPath:(NSURL *)extractPath logger:(id<FBControlCoreLogger>)logger
+{
+  [logger.debug logFormat:@"Extracting %@ to %@", path, extractPath.path];
+  dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+  return [FBArchiveUnpacker onQueue:queue extractArchiveAtPath:path toDirectory:extractPath];
+}
+
++ (FBFuture<FBExtractedApplication *> *)extractedApplicationWithAppPath:(NSString *)appPath extractPath:(NSURL *)extractPath
 {
-  // If it's an App, we don't need to do anything, just return early.
-  if ([FBApplicationBundle isApplicationAtPath:path]) {
-    return [FBFutureContext futureContextWithResult:path];
-  }
-  // The other case is that this is an IPA, check it is before extacting.
   NSError *error = nil;
-  if (![FBApplicationBundle isIPAAtPath:path error:&error]) {
-    return [[[FBControlCoreError
-      describeFormat:@"File at path %@ is neither an IPA nor an .app", path]
-      causedBy:error]
-      failFutureContext];
+  FBApplicationBundle *bundle = [FBApplicationBundle applicationWithPath:appPath error:&error];
+  if (!bundle) {
+    return [FBFuture futureWithError:error];
   }
-  // Create the path to extract into, if it doesn't exist yet.
-  if (![NSFileManager.defaultManager createDirectoryAtURL:extractPath withIntermediateDirectories:YES attributes:nil error:&error]) {
-    return [[[FBControlCoreError
-      describeFormat:@"Could not create temporary directory for IPA extraction %@", extractPath]
-      causedBy:error]
-      failFutureContext];
-  }
-  // Run the unzip command.
-  return [[[[[[[[FBTaskBuilder
-    withLaunchPath:@"/usr/bin/unzip"]
-    withArguments:@[@"-o", @"-d", extractPath.path, path]]
-    withAcceptableTerminationStatusCodes:[NSSet setWithObject:@0]]
-    withStdErrToLogger:logger.debug]
-    withStdOutToLogger:logger.debug]
-    runUntilCompletion]
-    onQueue:queue contextualTeardown:^(id _, FBFutureState __) {
-      [logger logFormat:@"Removing extracted directory %@", extractPath];
-      NSError *innerError = nil;
-      if ([NSFileManager.defaultManager removeItemAtURL:extractPath error:&innerError]) {
-        [logger logFormat:@"Removed extracted directory %@", extractPath];
-      } else {
-        [logger logFormat:@"Failed to remove extracted directory %@ with error %@", extractPath, innerError];
-      }
-    }]
-    onQueue:queue pend:^(FBTask *task) {
-      return [FBApplicationBundle findAppPathFromDirectory:extractPath];
-    }];
+  FBExtractedApplication *application = [[FBExtractedApplication alloc] initWithBundle:bundle extractedPath:extractPath];
+  return [FBFuture futureWithResult:application];
 }
 
 + (FBFuture<NSString *> *)findAppPathFromDirectory:(NSURL *)directory
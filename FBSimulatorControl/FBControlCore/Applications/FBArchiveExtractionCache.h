@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBFuture.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol FBControlCoreLogger;
+
+/**
+ A block that extracts the archive at a path into an existing, empty, directory.
+ */
+typedef FBFuture<NSNull *> *_Nonnull (^FBArchiveExtractor)(NSString *archivePath, NSURL *destination, id<FBControlCoreLogger> _Nullable logger);
+
+/**
+ A cache of extracted archives, keyed by the SHA-256 digest of the archive's contents.
+
+ Each archive is extracted at most once whilst it is in the cache, regardless of the path it is provided from.
+ Concurrent requests for the same archive share a single in-flight extraction.
+ Every request recieves its own copy of the extracted tree, so that modifications made by one consumer are not visible to any other.
+ This copy is made with clonefile(2) where available, falling back to copying, so consumers may modify files in place.
+
+ Extracted trees are reference counted by the contexts that use them.
+ When the number of cached trees exceeds the capacity, the least recently used trees that have no references are evicted.
+ */
+@interface FBArchiveExtractionCache : NSObject
+
+#pragma mark Initializers
+
+/**
+ Constructs a Cache.
+
+ @param rootDirectory the directory to extract into. It will be created if it does not exist. Extracted trees that are already in this directory are re-used.
+ @param capacity the number of extracted trees to retain once they are no longer referenced.
+ @param extractor the block that performs extraction.
+ @return a new Cache.
+ */
++ (instancetype)cacheWithRootDirectory:(NSURL *)rootDirectory capacity:(NSUInteger)capacity extractor:(FBArchiveExtractor)extractor;
+
+#pragma mark Public Methods
+
+/**
+ Obtains an extracted copy of an archive.
+ When the context is torn down, the copy is deleted and the reference to the cached tree is released.
+
+ @param path the path of the archive.
+ @param logger the (optional) logger to log to.
+ @return a context wrapping the directory that the archive has been extracted into.
+ */
+- (FBFutureContext<NSURL *> *)extractArchiveAtPath:(NSString *)path logger:(nullable id<FBControlCoreLogger>)logger;
+
+/**
+ Computes the content digest of a file, as used for the key of the cache.
+ Digests are memoized against the identity, size and modification date of the file.
+
+ @param path the path of the file.
+ @param error an error out for any error that occurs.
+ @return the hex encoded SHA-256 digest of the file, nil on error.
+ */
+- (nullable NSString *)contentDigestOfFileAtPath:(NSString *)path error:(NSError **)error;
+
+#pragma mark Properties
+
+/**
+ The directory that archives are extracted into.
+ */
+@property (nonatomic, copy, readonly) NSURL *rootDirectory;
+
+/**
+ The number of extractions that have been started by the cache.
+ */
+@property (nonatomic, assign, readonly) NSUInteger extractionCount;
+
+/**
+ The digests of the cached trees, from least to most recently used.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSString *> *cachedDigests;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,360 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBArchiveExtractionCache.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <dlfcn.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+#import "FBControlCoreError.h"
+#import "FBControlCoreLogger.h"
+
+static const size_t DigestReadSize = 1024 * 1024;
+static const uint32_t CloneNoFollow = 0x0001;
+static NSString *const InUseDirectoryName = @"in_use";
+
+typedef int (*CloneFileFunction)(const char *source, const char *destination, uint32_t flags);
+
+static CloneFileFunction CloneFile(void)
+{
+  // clonefile(2) is only present on macOS 10.12 and later.
+  static dispatch_once_t onceToken;
+  static CloneFileFunction function;
+  dispatch_once(&onceToken, ^{
+    function = (CloneFileFunction) dlsym(RTLD_DEFAULT, "clonefile");
+  });
+  return function;
+}
+
+static BOOL CloneTree(NSString *source, NSString *destination, NSError **error)
+{
+  CloneFileFunction cloneFile = CloneFile();
+  if (cloneFile && cloneFile(source.fileSystemRepresentation, destination.fileSystemRepresentation, CloneNoFollow) == 0) {
+    return YES;
+  }
+  // Cloning is not supported across volumes or on non-APFS volumes, remove anything that a failed clone left behind.
+  // The fallback is a full copy rather than hard links, as consumers such as codesigning modify files in place, which would otherwise write through to the cache.
+  [NSFileManager.defaultManager removeItemAtPath:destination error:nil];
+  NSError *innerError = nil;
+  if (![NSFileManager.defaultManager copyItemAtPath:source toPath:destination error:&innerError]) {
+    [NSFileManager.defaultManager removeItemAtPath:destination error:nil];
+    return [[[FBControlCoreError
+      describeFormat:@"Failed to copy extracted tree %@ to %@", source, destination]
+      causedBy:innerError]
+      failBool:error];
+  }
+  return YES;
+}
+
+@interface FBArchiveExtractionCache_Entry : NSObject
+
+@property (nonatomic, copy, readonly) NSString *digest;
+@property (nonatomic, copy, readonly) NSURL *directory;
+@property (nonatomic, strong, readonly) FBFuture<NSNull *> *extraction;
+@property (nonatomic, assign, readwrite) NSUInteger referenceCount;
+@property (nonatomic, assign, readwrite) uint64_t lastUsed;
+@property (nonatomic, assign, readonly) BOOL isExtracted;
+@property (nonatomic, assign, readonly) BOOL hasFailed;
+
+@end
+
+@implementation FBArchiveExtractionCache_Entry
+
+- (instancetype)initWithDigest:(NSString *)digest directory:(NSURL *)directory extraction:(FBFuture<NSNull *> *)extraction
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _digest = digest;
+  _directory = directory;
+  _extraction = extraction;
+
+  return self;
+}
+
+- (BOOL)isExtracted
+{
+  return self.extraction.state == FBFutureStateDone;
+}
+
+- (BOOL)hasFailed
+{
+  return self.extraction.hasCompleted && self.extraction.state != FBFutureStateDone;
+}
+
+@end
+
+@interface FBArchiveExtractionCache ()
+
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+@property (nonatomic, copy, readonly) FBArchiveExtractor extractor;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBArchiveExtractionCache_Entry *> *entries;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSString *> *memoizedDigests;
+@property (nonatomic, assign, readwrite) uint64_t clock;
+@property (nonatomic, assign, readwrite) NSUInteger mutableExtractionCount;
+
+@end
+
+@implementation FBArchiveExtractionCache
+
+#pragma mark Initializers
+
++ (instancetype)cacheWithRootDirectory:(NSURL *)rootDirectory capacity:(NSUInteger)capacity extractor:(FBArchiveExtractor)extractor
+{
+  return [[self alloc] initWithRootDirectory:rootDirectory capacity:capacity extractor:extractor];
+}
+
+- (instancetype)initWithRootDirectory:(NSURL *)rootDirectory capacity:(NSUInteger)capacity extractor:(FBArchiveExtractor)extractor
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _rootDirectory = [rootDirectory copy];
+  _capacity = capacity;
+  _extractor = [extractor copy];
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.archive_extraction_cache", DISPATCH_QUEUE_SERIAL);
+  _entries = [NSMutableDictionary dictionary];
+  _memoizedDigests = [NSMutableDictionary dictionary];
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (FBFutureContext<NSURL *> *)extractArchiveAtPath:(NSString *)path logger:(nullable id<FBControlCoreLogger>)logger
+{
+  dispatch_queue_t workQueue = dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+  FBFuture<FBArchiveExtractionCache_Entry *> *acquired = [[FBFuture
+    onQueue:workQueue resolveValue:^ NSString * (NSError **error) {
+      return [self contentDigestOfFileAtPath:path error:error];
+    }]
+    onQueue:self.queue map:^(NSString *digest) {
+      return [self acquireEntryForDigest:digest archivePath:path logger:logger];
+    }];
+
+  return [[[acquired
+    onQueue:self.queue contextualTeardown:^(FBArchiveExtractionCache_Entry *entry, FBFutureState __) {
+      [self releaseEntry:entry];
+    }]
+    onQueue:self.queue pend:^(FBArchiveExtractionCache_Entry *entry) {
+      return [entry.extraction onQueue:workQueue fmap:^(id _) {
+        // The reference to the entry is held until the context is torn down, so it cannot be evicted whilst being copied.
+        NSURL *destination = [[self.rootDirectory URLByAppendingPathComponent:InUseDirectoryName] URLByAppendingPathComponent:NSUUID.UUID.UUIDString];
+        NSError *error = nil;
+        if (![NSFileManager.defaultManager createDirectoryAtURL:destination.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:&error]) {
+          return [FBFuture futureWithError:error];
+        }
+        if (!CloneTree(entry.directory.path, destination.path, &error)) {
+          return [FBFuture futureWithError:error];
+        }
+        return [FBFuture futureWithResult:destination];
+      }];
+    }]
+    onQueue:workQueue contextualTeardown:^(NSURL *destination, FBFutureState __) {
+      [NSFileManager.defaultManager removeItemAtURL:destination error:nil];
+    }];
+}
+
+- (nullable NSString *)contentDigestOfFileAtPath:(NSString *)path error:(NSError **)error
+{
+  int fileDescriptor = open(path.fileSystemRepresentation, O_RDONLY);
+  if (fileDescriptor == -1) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to open %@ for reading: %s", path, strerror(errno)]
+      fail:error];
+  }
+  struct stat fileStat;
+  if (fstat(fileDescriptor, &fileStat) != 0) {
+    close(fileDescriptor);
+    return [[FBControlCoreError
+      describeFormat:@"Failed to stat %@: %s", path, strerror(errno)]
+      fail:error];
+  }
+  NSString *identity = [NSString stringWithFormat:
+    @"%d:%llu:%lld:%ld.%ld",
+    fileStat.st_dev,
+    (unsigned long long) fileStat.st_ino,
+    (long long) fileStat.st_size,
+    (long) fileStat.st_mtimespec.tv_sec,
+    (long) fileStat.st_mtimespec.tv_nsec
+  ];
+  @synchronized (self.memoizedDigests) {
+    NSString *digest = self.memoizedDigests[identity];
+    if (digest) {
+      close(fileDescriptor);
+      return digest;
+    }
+  }
+
+  CC_SHA256_CTX context;
+  CC_SHA256_Init(&context);
+  NSMutableData *buffer = [NSMutableData dataWithLength:DigestReadSize];
+  while (YES) {
+    ssize_t readLength = read(fileDescriptor, buffer.mutableBytes, DigestReadSize);
+    if (readLength == -1 && errno == EINTR) {
+      continue;
+    }
+    if (readLength == -1) {
+      close(fileDescriptor);
+      return [[FBControlCoreError
+        describeFormat:@"Failed to read %@: %s", path, strerror(errno)]
+        fail:error];
+    }
+    if (readLength == 0) {
+      break;
+    }
+    CC_SHA256_Update(&context, buffer.bytes, (CC_LONG) readLength);
+  }
+  close(fileDescriptor);
+
+  unsigned char bytes[CC_SHA256_DIGEST_LENGTH];
+  CC_SHA256_Final(bytes, &context);
+  NSMutableString *digest = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+  for (NSUInteger index = 0; index < CC_SHA256_DIGEST_LENGTH; index++) {
+    [digest appendFormat:@"%02x", bytes[index]];
+  }
+  @synchronized (self.memoizedDigests) {
+    self.memoizedDigests[identity] = digest;
+  }
+  return [digest copy];
+}
+
+#pragma mark Properties
+
+- (NSUInteger)extractionCount
+{
+  __block NSUInteger extractionCount = 0;
+  dispatch_sync(self.queue, ^{
+    extractionCount = self.mutableExtractionCount;
+  });
+  return extractionCount;
+}
+
+- (NSArray<NSString *> *)cachedDigests
+{
+  __block NSArray<NSString *> *digests = nil;
+  dispatch_sync(self.queue, ^{
+    digests = [[self entriesByRecency] valueForKey:@"digest"];
+  });
+  return digests;
+}
+
+#pragma mark Private
+
+- (FBArchiveExtractionCache_Entry *)acquireEntryForDigest:(NSString *)digest archivePath:(NSString *)archivePath logger:(nullable id<FBControlCoreLogger>)logger
+{
+  FBArchiveExtractionCache_Entry *entry = self.entries[digest];
+  // A failed extraction is retried by the next request, whilst the failed entry is released by its existing holders.
+  if (!entry || entry.hasFailed) {
+    NSURL *directory = [self.rootDirectory URLByAppendingPathComponent:digest];
+    FBFuture<NSNull *> *extraction = nil;
+    if ([NSFileManager.defaultManager fileExistsAtPath:directory.path]) {
+      [logger logFormat:@"Re-using existing extraction of %@ at %@", archivePath, directory];
+      extraction = [FBFuture futureWithResult:NSNull.null];
+    } else {
+      extraction = [self extractArchiveAtPath:archivePath intoDirectory:directory logger:logger];
+    }
+    entry = [[FBArchiveExtractionCache_Entry alloc] initWithDigest:digest directory:directory extraction:extraction];
+    self.entries[digest] = entry;
+  } else {
+    [logger logFormat:@"Using cached extraction of %@ at %@", archivePath, entry.directory];
+  }
+  entry.referenceCount += 1;
+  entry.lastUsed = ++self.clock;
+  return entry;
+}
+
+- (FBFuture<NSNull *> *)extractArchiveAtPath:(NSString *)archivePath intoDirectory:(NSURL *)directory logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self.mutableExtractionCount += 1;
+  // Extract into a staging directory, so that a partial extraction is never visible at the final location.
+  NSURL *staging = [self.rootDirectory URLByAppendingPathComponent:[NSString stringWithFormat:@"%@.partial-%@", directory.lastPathComponent, NSUUID.UUID.UUIDString]];
+  NSError *error = nil;
+  if (![NSFileManager.defaultManager createDirectoryAtURL:staging withIntermediateDirectories:YES attributes:nil error:&error]) {
+    return [[[FBControlCoreError
+      describeFormat:@"Could not create directory for extraction %@", staging]
+      causedBy:error]
+      failFuture];
+  }
+  [logger logFormat:@"Extracting %@ to %@", archivePath, directory];
+  return [[self.extractor(archivePath, staging, logger)
+    onQueue:self.queue fmap:^(id _) {
+      NSError *innerError = nil;
+      if (![NSFileManager.defaultManager moveItemAtURL:staging toURL:directory error:&innerError]) {
+        return [[[FBControlCoreError
+          describeFormat:@"Could not move extraction %@ to %@", staging, directory]
+          causedBy:innerError]
+          failFuture];
+      }
+      [logger logFormat:@"Extracted %@ to %@", archivePath, directory];
+      return [FBFuture futureWithResult:NSNull.null];
+    }]
+    onQueue:self.queue notifyOfCompletion:^(FBFuture *future) {
+      if (future.state != FBFutureStateDone) {
+        [NSFileManager.defaultManager removeItemAtURL:staging error:nil];
+      }
+    }];
+}
+
+- (void)releaseEntry:(FBArchiveExtractionCache_Entry *)entry
+{
+  entry.referenceCount -= 1;
+  if (entry.referenceCount == 0 && entry.hasFailed && self.entries[entry.digest] == entry) {
+    [self.entries removeObjectForKey:entry.digest];
+  }
+  [self evictIfNeeded];
+}
+
+- (void)evictIfNeeded
+{
+  if (self.entries.count <= self.capacity) {
+    return;
+  }
+  for (FBArchiveExtractionCache_Entry *entry in [self entriesByRecency]) {
+    if (self.entries.count <= self.capacity) {
+      return;
+    }
+    if (entry.referenceCount > 0 || !entry.isExtracted) {
+      continue;
+    }
+    [self.entries removeObjectForKey:entry.digest];
+    [self removeDirectory:entry.directory];
+  }
+}
+
+- (void)removeDirectory:(NSURL *)directory
+{
+  // Renaming is immediate, so the digest can be extracted again straight away, whilst the removal happens in the background.
+  NSURL *evicted = [self.rootDirectory URLByAppendingPathComponent:[NSString stringWithFormat:@"%@.evicted-%@", directory.lastPathComponent, NSUUID.UUID.UUIDString]];
+  if (![NSFileManager.defaultManager moveItemAtURL:directory toURL:evicted error:nil]) {
+    evicted = directory;
+  }
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_BACKGROUND, 0), ^{
+    [NSFileManager.defaultManager removeItemAtURL:evicted error:nil];
+  });
+}
+
+- (NSArray<FBArchiveExtractionCache_Entry *> *)entriesByRecency
+{
+  return [self.entries.allValues sortedArrayUsingComparator:^ NSComparisonResult (FBArchiveExtractionCache_Entry *left, FBArchiveExtractionCache_Entry *right) {
+    if (left.lastUsed == right.lastUsed) {
+      return NSOrderedSame;
+    }
+    return left.lastUsed < right.lastUsed ? NSOrderedAscending : NSOrderedDescending;
+  }];
+}
+
+@end
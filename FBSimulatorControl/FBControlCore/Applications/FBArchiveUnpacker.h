@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBDataConsumer.h>
+#import <FBControlCore/FBFuture.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Extracts ZIP archives (including IPAs) and TAR archives, optionally gzip compressed, without launching an external tool.
+
+ A ZIP archive on disk is extracted from its Central Directory, with the entries inflated and written on all available cores.
+ Output files are preallocated to their final size before they are written.
+
+ An Unpacker can also consume an archive as it arrives, as a Data Consumer, so that extraction can begin before the last byte has been recieved.
+ ZIP entries are dispatched to be inflated in parallel as soon as all of their compressed bytes have arrived.
+ Entries whose sizes are only known after their data, are inflated as they stream in.
+ As the permissions of ZIP entries are only present in the Central Directory at the end of the archive, these are applied once the whole archive has arrived.
+ TAR archives are inherently sequential, so are extracted serially.
+
+ Entries with absolute paths, or paths that would escape the destination, are rejected.
+ Entries are never written through a symbolic link, and symbolic links are created after all other entries.
+ */
+@interface FBArchiveUnpacker : NSObject <FBDataConsumer, FBDataConsumerLifecycle>
+
+#pragma mark Initializers
+
+/**
+ Constructs an Unpacker that extracts an archive as it is consumed.
+ The format of the archive is determined from its first bytes.
+
+ @param destination the existing directory to extract into.
+ @return a new Unpacker.
+ */
++ (instancetype)streamingUnpackerToDirectory:(NSURL *)destination;
+
+#pragma mark Public Methods
+
+/**
+ Extracts an archive on disk, synchronously.
+
+ @param path the path of the archive.
+ @param destination the existing directory to extract into.
+ @param error an error out for any error that occurs.
+ @return YES if successful, NO otherwise.
+ */
++ (BOOL)extractArchiveAtPath:(NSString *)path toDirectory:(NSURL *)destination error:(NSError **)error;
+
+/**
+ Extracts an archive on disk, asynchronously.
+
+ @param queue the queue to extract on.
+ @param path the path of the archive.
+ @param destination the existing directory to extract into.
+ @return a Future that resolves when the archive has been extracted.
+ */
++ (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue extractArchiveAtPath:(NSString *)path toDirectory:(NSURL *)destination;
+
+#pragma mark Properties
+
+/**
+ A Future that resolves when all of the consumed archive has been extracted, or fails on the first extraction error.
+ */
+@property (nonatomic, strong, readonly) FBFuture<NSNull *> *completed;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,1565 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBArchiveUnpacker.h"
+
+#import <fcntl.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <unistd.h>
+#import <zlib.h>
+
+#import "FBControlCoreError.h"
+
+static const uint32_t ZipLocalFileHeaderSignature = 0x04034b50;
+static const uint32_t ZipCentralDirectorySignature = 0x02014b50;
+static const uint32_t ZipEndOfCentralDirectorySignature = 0x06054b50;
+static const uint32_t Zip64EndOfCentralDirectorySignature = 0x06064b50;
+static const uint32_t Zip64EndOfCentralDirectoryLocatorSignature = 0x07064b50;
+static const uint32_t ZipDataDescriptorSignature = 0x08074b50;
+static const uint16_t ZipFlagEncrypted = 1 << 0;
+static const uint16_t ZipFlagDataDescriptor = 1 << 3;
+static const uint16_t ZipMethodStored = 0;
+static const uint16_t ZipMethodDeflated = 8;
+static const uint16_t Zip64ExtraFieldTag = 0x0001;
+static const uint16_t ZipHostUnix = 3;
+static const size_t ZipLocalFileHeaderLength = 30;
+static const size_t ZipCentralDirectoryHeaderLength = 46;
+static const size_t ZipEndOfCentralDirectoryLength = 22;
+static const size_t Zip64EndOfCentralDirectoryLocatorLength = 20;
+static const size_t Zip64EndOfCentralDirectoryLength = 56;
+static const size_t TarBlockSize = 512;
+static const size_t InflateBufferSize = 256 * 1024;
+static const size_t FileFeedSize = 1024 * 1024;
+
+#pragma mark Decoding
+
+static inline uint16_t ReadUInt16(const uint8_t *bytes)
+{
+  return (uint16_t) (bytes[0] | (bytes[1] << 8));
+}
+
+static inline uint32_t ReadUInt32(const uint8_t *bytes)
+{
+  return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+static inline uint64_t ReadUInt64(const uint8_t *bytes)
+{
+  return (uint64_t) ReadUInt32(bytes) | ((uint64_t) ReadUInt32(bytes + 4) << 32);
+}
+
+static BOOL ApplyZip64ExtraField(const uint8_t *extra, size_t length, uint64_t *uncompressedSize, uint64_t *compressedSize, uint64_t *_Nullable localHeaderOffset)
+{
+  // Only the values that overflowed in the fixed-size header are present in the extra field, in this order.
+  size_t position = 0;
+  while (position + 4 <= length) {
+    uint16_t tag = ReadUInt16(extra + position);
+    size_t fieldLength = ReadUInt16(extra + position + 2);
+    const uint8_t *field = extra + position + 4;
+    if (position + 4 + fieldLength > length) {
+      return NO;
+    }
+    if (tag == Zip64ExtraFieldTag) {
+      size_t fieldPosition = 0;
+      if (*uncompressedSize == UINT32_MAX && fieldPosition + 8 <= fieldLength) {
+        *uncompressedSize = ReadUInt64(field + fieldPosition);
+        fieldPosition += 8;
+      }
+      if (*compressedSize == UINT32_MAX && fieldPosition + 8 <= fieldLength) {
+        *compressedSize = ReadUInt64(field + fieldPosition);
+        fieldPosition += 8;
+      }
+      if (localHeaderOffset && *localHeaderOffset == UINT32_MAX && fieldPosition + 8 <= fieldLength) {
+        *localHeaderOffset = ReadUInt64(field + fieldPosition);
+      }
+      return YES;
+    }
+    position += 4 + fieldLength;
+  }
+  return NO;
+}
+
+#pragma mark Paths
+
+static NSString *ValidatedEntryPath(NSString *path, NSError **error)
+{
+  if (path.length == 0 || [path hasPrefix:@"/"]) {
+    return [[FBControlCoreError
+      describeFormat:@"Archive entry '%@' does not have a relative path", path]
+      fail:error];
+  }
+  for (NSString *component in [path componentsSeparatedByString:@"/"]) {
+    if ([component isEqualToString:@".."]) {
+      return [[FBControlCoreError
+        describeFormat:@"Archive entry '%@' escapes the destination directory", path]
+        fail:error];
+    }
+  }
+  return path;
+}
+
+static NSString *EntryPathFromBytes(const uint8_t *bytes, size_t length, NSError **error)
+{
+  // Names that are not UTF-8 are in the legacy code page, which is close enough to Latin-1 for file names.
+  NSString *path = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding]
+    ?: [[NSString alloc] initWithBytes:bytes length:length encoding:NSISOLatin1StringEncoding];
+  return ValidatedEntryPath(path, error);
+}
+
+static NSArray<NSString *> *EntryComponents(NSString *entryPath)
+{
+  NSMutableArray<NSString *> *components = [NSMutableArray array];
+  for (NSString *component in [entryPath componentsSeparatedByString:@"/"]) {
+    if (component.length == 0 || [component isEqualToString:@"."]) {
+      continue;
+    }
+    [components addObject:component];
+  }
+  return components;
+}
+
+static int OpenEntryDirectory(NSString *rootPath, NSArray<NSString *> *components, NSString *entryPath, BOOL create, NSError **error)
+{
+  int directory = open(rootPath.fileSystemRepresentation, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (directory == -1 && errno == ENOENT && create && [NSFileManager.defaultManager createDirectoryAtPath:rootPath withIntermediateDirectories:YES attributes:nil error:nil]) {
+    directory = open(rootPath.fileSystemRepresentation, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  }
+  if (directory == -1) {
+    [[FBControlCoreError
+      describeFormat:@"Failed to open destination directory %@: %s", rootPath, strerror(errno)]
+      failBool:error];
+    return -1;
+  }
+  // Each component is opened relative to the previous one without following symbolic links.
+  // This means that a link from an earlier entry, or one already in the destination, cannot redirect a later entry outside of the destination.
+  for (NSString *component in components) {
+    const char *name = component.fileSystemRepresentation;
+    if (create && mkdirat(directory, name, 0755) != 0 && errno != EEXIST) {
+      int mkdirError = errno;
+      close(directory);
+      [[FBControlCoreError
+        describeFormat:@"Failed to create directory %@ for archive entry '%@': %s", component, entryPath, strerror(mkdirError)]
+        failBool:error];
+      return -1;
+    }
+    int next = openat(directory, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    int openError = errno;
+    close(directory);
+    if (next == -1) {
+      [[FBControlCoreError
+        describeFormat:@"Archive entry '%@' passes through '%@', which is not a directory: %s", entryPath, component, strerror(openError)]
+        failBool:error];
+      return -1;
+    }
+    directory = next;
+  }
+  return directory;
+}
+
+static int OpenEntryParent(NSString *rootPath, NSString *entryPath, BOOL create, NSString *_Nullable *_Nonnull leafOut, NSError **error)
+{
+  NSArray<NSString *> *components = EntryComponents(entryPath);
+  if (components.count == 0) {
+    [[FBControlCoreError
+      describeFormat:@"Archive entry '%@' does not have a relative path", entryPath]
+      failBool:error];
+    return -1;
+  }
+  *leafOut = components.lastObject;
+  return OpenEntryDirectory(rootPath, [components subarrayWithRange:NSMakeRange(0, components.count - 1)], entryPath, create, error);
+}
+
+static BOOL EnsureEntryDirectory(NSString *rootPath, NSString *entryPath, NSError **error)
+{
+  int directory = OpenEntryDirectory(rootPath, EntryComponents(entryPath), entryPath, YES, error);
+  if (directory == -1) {
+    return NO;
+  }
+  close(directory);
+  return YES;
+}
+
+#pragma mark Output
+
+static mode_t FilePermissions(mode_t mode)
+{
+  // The owner must always be able to read and write an extracted file, so that it can be removed later.
+  return mode ? ((mode & 07777) | S_IRUSR | S_IWUSR) : 0644;
+}
+
+static int OpenOutputFile(NSString *rootPath, NSString *entryPath, uint64_t size, NSError **error)
+{
+  NSString *leaf = nil;
+  int directory = OpenEntryParent(rootPath, entryPath, YES, &leaf, error);
+  if (directory == -1) {
+    return -1;
+  }
+  int fileDescriptor = openat(directory, leaf.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0644);
+  int openError = errno;
+  close(directory);
+  if (fileDescriptor == -1) {
+    [[FBControlCoreError
+      describeFormat:@"Failed to open %@ for writing: %s", [rootPath stringByAppendingPathComponent:entryPath], strerror(openError)]
+      failBool:error];
+    return -1;
+  }
+#if defined(F_PREALLOCATE)
+  // Preallocation is only an optimization, so a failure to preallocate is ignored.
+  if (size > 0) {
+    fstore_t store = {F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, (off_t) size, 0};
+    if (fcntl(fileDescriptor, F_PREALLOCATE, &store) == -1) {
+      store.fst_flags = F_ALLOCATEALL;
+      fcntl(fileDescriptor, F_PREALLOCATE, &store);
+    }
+  }
+#endif
+  return fileDescriptor;
+}
+
+static BOOL WriteAll(int fileDescriptor, const uint8_t *bytes, size_t length)
+{
+  while (length > 0) {
+    ssize_t written = write(fileDescriptor, bytes, length);
+    if (written == -1 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return NO;
+    }
+    bytes += written;
+    length -= (size_t) written;
+  }
+  return YES;
+}
+
+static BOOL FinishOutputFile(int fileDescriptor, mode_t mode, BOOL success)
+{
+  fchmod(fileDescriptor, FilePermissions(mode));
+  close(fileDescriptor);
+  return success;
+}
+
+static BOOL CreateSymbolicLink(NSString *rootPath, NSString *entryPath, NSString *destination, NSError **error)
+{
+  NSString *leaf = nil;
+  int directory = OpenEntryParent(rootPath, entryPath, YES, &leaf, error);
+  if (directory == -1) {
+    return NO;
+  }
+  unlinkat(directory, leaf.fileSystemRepresentation, 0);
+  int result = symlinkat(destination.fileSystemRepresentation, directory, leaf.fileSystemRepresentation);
+  int linkError = errno;
+  close(directory);
+  if (result == 0) {
+    return YES;
+  }
+  return [[FBControlCoreError
+    describeFormat:@"Failed to create symbolic link %@ to %@: %s", [rootPath stringByAppendingPathComponent:entryPath], destination, strerror(linkError)]
+    failBool:error];
+}
+
+static BOOL CreateHardLink(NSString *rootPath, NSString *entryPath, NSString *targetPath, NSError **error)
+{
+  // The target is looked up with the same walk as any other entry, so it cannot be reached through a symbolic link.
+  NSString *targetLeaf = nil;
+  int targetDirectory = OpenEntryParent(rootPath, targetPath, NO, &targetLeaf, error);
+  if (targetDirectory == -1) {
+    return NO;
+  }
+  NSString *leaf = nil;
+  int directory = OpenEntryParent(rootPath, entryPath, YES, &leaf, error);
+  if (directory == -1) {
+    close(targetDirectory);
+    return NO;
+  }
+  unlinkat(directory, leaf.fileSystemRepresentation, 0);
+  int result = linkat(targetDirectory, targetLeaf.fileSystemRepresentation, directory, leaf.fileSystemRepresentation, 0);
+  int linkError = errno;
+  close(directory);
+  close(targetDirectory);
+  if (result == 0) {
+    return YES;
+  }
+  return [[FBControlCoreError
+    describeFormat:@"Failed to create hard link %@ to %@: %s", [rootPath stringByAppendingPathComponent:entryPath], targetPath, strerror(linkError)]
+    failBool:error];
+}
+
+static NSString *ReadSymbolicLinkPlaceholder(NSString *rootPath, NSString *entryPath)
+{
+  NSString *leaf = nil;
+  int directory = OpenEntryParent(rootPath, entryPath, NO, &leaf, NULL);
+  if (directory == -1) {
+    return nil;
+  }
+  int fileDescriptor = openat(directory, leaf.fileSystemRepresentation, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+  close(directory);
+  if (fileDescriptor == -1) {
+    return nil;
+  }
+  char destination[PATH_MAX];
+  ssize_t length = read(fileDescriptor, destination, sizeof(destination));
+  close(fileDescriptor);
+  if (length <= 0 || (size_t) length == sizeof(destination)) {
+    return nil;
+  }
+  return [[NSString alloc] initWithBytes:destination length:(NSUInteger) length encoding:NSUTF8StringEncoding];
+}
+
+static void SetEntryPermissions(NSString *rootPath, NSString *entryPath, mode_t mode)
+{
+  NSString *leaf = nil;
+  int directory = OpenEntryParent(rootPath, entryPath, NO, &leaf, NULL);
+  if (directory == -1) {
+    return;
+  }
+  fchmodat(directory, leaf.fileSystemRepresentation, FilePermissions(mode), AT_SYMLINK_NOFOLLOW);
+  close(directory);
+}
+
+typedef BOOL (^FBArchiveUnpackerSink)(const uint8_t *bytes, size_t length);
+
+static BOOL DecodeEntryData(uint16_t method, const uint8_t *data, uint64_t length, uint64_t expectedLength, uint32_t expectedCRC, NSString *path, FBArchiveUnpackerSink sink, NSError **error)
+{
+  uLong crc = crc32(0L, Z_NULL, 0);
+  uint64_t produced = 0;
+  if (method == ZipMethodStored) {
+    for (uint64_t offset = 0; offset < length; offset += InflateBufferSize) {
+      size_t chunkLength = (size_t) MIN((uint64_t) InflateBufferSize, length - offset);
+      crc = crc32(crc, data + offset, (uInt) chunkLength);
+      if (!sink(data + offset, chunkLength)) {
+        return [[FBControlCoreError
+          describeFormat:@"Failed to write %@: %s", path, strerror(errno)]
+          failBool:error];
+      }
+    }
+    produced = length;
+  } else if (method == ZipMethodDeflated) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+      return [[FBControlCoreError
+        describeFormat:@"Failed to initialize inflation of %@", path]
+        failBool:error];
+    }
+    uint8_t *buffer = malloc(InflateBufferSize);
+    uint64_t offered = 0;
+    int status = Z_OK;
+    BOOL writeFailed = NO;
+    while (status == Z_OK) {
+      if (stream.avail_in == 0 && offered < length) {
+        uInt chunkLength = (uInt) MIN(length - offered, (uint64_t) UINT32_MAX);
+        stream.next_in = (Bytef *) (data + offered);
+        stream.avail_in = chunkLength;
+        offered += chunkLength;
+      }
+      stream.next_out = buffer;
+      stream.avail_out = (uInt) InflateBufferSize;
+      status = inflate(&stream, Z_NO_FLUSH);
+      if (status != Z_OK && status != Z_STREAM_END) {
+        break;
+      }
+      size_t producedLength = InflateBufferSize - stream.avail_out;
+      if (producedLength == 0) {
+        continue;
+      }
+      crc = crc32(crc, buffer, (uInt) producedLength);
+      produced += producedLength;
+      if (!sink(buffer, producedLength)) {
+        writeFailed = YES;
+        break;
+      }
+    }
+    inflateEnd(&stream);
+    free(buffer);
+    if (writeFailed) {
+      return [[FBControlCoreError
+        describeFormat:@"Failed to write %@: %s", path, strerror(errno)]
+        failBool:error];
+    }
+    if (status != Z_STREAM_END) {
+      return [[FBControlCoreError
+        describeFormat:@"Failed to inflate %@, zlib status %d", path, status]
+        failBool:error];
+    }
+  } else {
+    return [[FBControlCoreError
+      describeFormat:@"Unsupported compression method %d for %@", method, path]
+      failBool:error];
+  }
+  if (produced != expectedLength || crc != expectedCRC) {
+    return [[FBControlCoreError
+      describeFormat:@"Extracted %@ is corrupt, expected %llu bytes with CRC %08x, got %llu bytes with CRC %08lx", path, expectedLength, expectedCRC, produced, crc]
+      failBool:error];
+  }
+  return YES;
+}
+
+#pragma mark ZIP Entries
+
+@interface FBArchiveUnpacker_ZipEntry : NSObject
+
+@property (nonatomic, copy, readwrite) NSString *path;
+@property (nonatomic, assign, readwrite) uint16_t flags;
+@property (nonatomic, assign, readwrite) uint16_t method;
+@property (nonatomic, assign, readwrite) uint32_t crc;
+@property (nonatomic, assign, readwrite) uint64_t compressedSize;
+@property (nonatomic, assign, readwrite) uint64_t uncompressedSize;
+@property (nonatomic, assign, readwrite) uint64_t localHeaderOffset;
+@property (nonatomic, assign, readwrite) uint64_t dataOffset;
+@property (nonatomic, assign, readwrite) mode_t mode;
+@property (nonatomic, assign, readonly) BOOL isDirectory;
+
+@end
+
+@implementation FBArchiveUnpacker_ZipEntry
+
+- (BOOL)isDirectory
+{
+  return [self.path hasSuffix:@"/"];
+}
+
+@end
+
+static FBArchiveUnpacker_ZipEntry *ParseCentralDirectoryRecord(const uint8_t *bytes, size_t length, size_t *recordLengthOut, NSError **error)
+{
+  if (length < ZipCentralDirectoryHeaderLength || ReadUInt32(bytes) != ZipCentralDirectorySignature) {
+    return [[FBControlCoreError
+      describe:@"Malformed ZIP Central Directory"]
+      fail:error];
+  }
+  size_t nameLength = ReadUInt16(bytes + 28);
+  size_t extraLength = ReadUInt16(bytes + 30);
+  size_t commentLength = ReadUInt16(bytes + 32);
+  size_t recordLength = ZipCentralDirectoryHeaderLength + nameLength + extraLength + commentLength;
+  if (recordLength > length) {
+    return [[FBControlCoreError
+      describe:@"Truncated ZIP Central Directory"]
+      fail:error];
+  }
+  NSString *path = EntryPathFromBytes(bytes + ZipCentralDirectoryHeaderLength, nameLength, error);
+  if (!path) {
+    return nil;
+  }
+  uint64_t uncompressedSize = ReadUInt32(bytes + 24);
+  uint64_t compressedSize = ReadUInt32(bytes + 20);
+  uint64_t localHeaderOffset = ReadUInt32(bytes + 42);
+  ApplyZip64ExtraField(bytes + ZipCentralDirectoryHeaderLength + nameLength, extraLength, &uncompressedSize, &compressedSize, &localHeaderOffset);
+
+  FBArchiveUnpacker_ZipEntry *entry = [FBArchiveUnpacker_ZipEntry new];
+  entry.path = path;
+  entry.flags = ReadUInt16(bytes + 8);
+  entry.method = ReadUInt16(bytes + 10);
+  entry.crc = ReadUInt32(bytes + 16);
+  entry.compressedSize = compressedSize;
+  entry.uncompressedSize = uncompressedSize;
+  entry.localHeaderOffset = localHeaderOffset;
+  entry.mode = (ReadUInt16(bytes + 4) >> 8) == ZipHostUnix ? (mode_t) (ReadUInt32(bytes + 38) >> 16) : 0;
+  *recordLengthOut = recordLength;
+  return entry;
+}
+
+static NSArray<FBArchiveUnpacker_ZipEntry *> *ParseCentralDirectory(const uint8_t *bytes, size_t length, NSError **error)
+{
+  if (length < ZipEndOfCentralDirectoryLength) {
+    return [[FBControlCoreError
+      describe:@"Archive is too short to be a ZIP"]
+      fail:error];
+  }
+  // The End of Central Directory record is followed by a comment of at most 64KiB.
+  size_t searchLimit = length > ZipEndOfCentralDirectoryLength + UINT16_MAX ? length - ZipEndOfCentralDirectoryLength - UINT16_MAX : 0;
+  size_t endOffset = length - ZipEndOfCentralDirectoryLength;
+  while (ReadUInt32(bytes + endOffset) != ZipEndOfCentralDirectorySignature) {
+    if (endOffset == searchLimit) {
+      return [[FBControlCoreError
+        describe:@"Could not find the ZIP End of Central Directory"]
+        fail:error];
+    }
+    endOffset--;
+  }
+  const uint8_t *end = bytes + endOffset;
+  uint64_t count = ReadUInt16(end + 10);
+  uint64_t directoryLength = ReadUInt32(end + 12);
+  uint64_t directoryOffset = ReadUInt32(end + 16);
+  if ((count == UINT16_MAX || directoryLength == UINT32_MAX || directoryOffset == UINT32_MAX) && endOffset >= Zip64EndOfCentralDirectoryLocatorLength) {
+    const uint8_t *locator = end - Zip64EndOfCentralDirectoryLocatorLength;
+    uint64_t zip64Offset = ReadUInt64(locator + 8);
+    if (ReadUInt32(locator) == Zip64EndOfCentralDirectoryLocatorSignature && zip64Offset + Zip64EndOfCentralDirectoryLength <= length && ReadUInt32(bytes + zip64Offset) == Zip64EndOfCentralDirectorySignature) {
+      count = ReadUInt64(bytes + zip64Offset + 32);
+      directoryLength = ReadUInt64(bytes + zip64Offset + 40);
+      directoryOffset = ReadUInt64(bytes + zip64Offset + 48);
+    }
+  }
+  if (directoryOffset + directoryLength > length) {
+    return [[FBControlCoreError
+      describe:@"ZIP Central Directory extends past the end of the archive"]
+      fail:error];
+  }
+
+  NSMutableArray<FBArchiveUnpacker_ZipEntry *> *entries = [NSMutableArray arrayWithCapacity:(NSUInteger) count];
+  size_t position = (size_t) directoryOffset;
+  size_t directoryEnd = (size_t) (directoryOffset + directoryLength);
+  for (uint64_t index = 0; index < count; index++) {
+    size_t recordLength = 0;
+    FBArchiveUnpacker_ZipEntry *entry = ParseCentralDirectoryRecord(bytes + position, directoryEnd - position, &recordLength, error);
+    if (!entry) {
+      return nil;
+    }
+    const uint8_t *local = bytes + entry.localHeaderOffset;
+    if (entry.localHeaderOffset + ZipLocalFileHeaderLength > length || ReadUInt32(local) != ZipLocalFileHeaderSignature) {
+      return [[FBControlCoreError
+        describeFormat:@"Malformed ZIP Local Header for %@", entry.path]
+        fail:error];
+    }
+    entry.dataOffset = entry.localHeaderOffset + ZipLocalFileHeaderLength + ReadUInt16(local + 26) + ReadUInt16(local + 28);
+    if (entry.dataOffset + entry.compressedSize > length) {
+      return [[FBControlCoreError
+        describeFormat:@"ZIP entry %@ extends past the end of the archive", entry.path]
+        fail:error];
+    }
+    [entries addObject:entry];
+    position += recordLength;
+  }
+  return entries;
+}
+
+static BOOL WriteZipEntry(FBArchiveUnpacker_ZipEntry *entry, const uint8_t *data, NSString *rootPath, NSError **error)
+{
+  NSString *path = [rootPath stringByAppendingPathComponent:entry.path];
+  if (entry.flags & ZipFlagEncrypted) {
+    return [[FBControlCoreError
+      describeFormat:@"Encrypted ZIP entry %@ is not supported", entry.path]
+      failBool:error];
+  }
+  if (S_ISLNK(entry.mode)) {
+    NSMutableData *destination = [NSMutableData data];
+    BOOL success = DecodeEntryData(entry.method, data, entry.compressedSize, entry.uncompressedSize, entry.crc, path, ^ BOOL (const uint8_t *bytes, size_t length) {
+      [destination appendBytes:bytes length:length];
+      return YES;
+    }, error);
+    if (!success) {
+      return NO;
+    }
+    return CreateSymbolicLink(rootPath, entry.path, [[NSString alloc] initWithData:destination encoding:NSUTF8StringEncoding], error);
+  }
+  int fileDescriptor = OpenOutputFile(rootPath, entry.path, entry.uncompressedSize, error);
+  if (fileDescriptor == -1) {
+    return NO;
+  }
+  BOOL success = DecodeEntryData(entry.method, data, entry.compressedSize, entry.uncompressedSize, entry.crc, path, ^ BOOL (const uint8_t *bytes, size_t length) {
+    return WriteAll(fileDescriptor, bytes, length);
+  }, error);
+  return FinishOutputFile(fileDescriptor, entry.mode, success);
+}
+
+static BOOL ExtractZip(const uint8_t *bytes, size_t length, NSString *rootPath, NSError **error)
+{
+  NSArray<FBArchiveUnpacker_ZipEntry *> *entries = ParseCentralDirectory(bytes, length, error);
+  if (!entries) {
+    return NO;
+  }
+
+  // All directories are created up-front, so that the files can then be written in any order.
+  // Symbolic links are created once everything else has been written, so that no entry is written through one.
+  NSMutableSet<NSString *> *directories = [NSMutableSet set];
+  NSMutableArray<FBArchiveUnpacker_ZipEntry *> *files = [NSMutableArray array];
+  NSMutableArray<FBArchiveUnpacker_ZipEntry *> *symbolicLinks = [NSMutableArray array];
+  for (FBArchiveUnpacker_ZipEntry *entry in entries) {
+    if (entry.isDirectory) {
+      [directories addObject:entry.path];
+      continue;
+    }
+    [directories addObject:entry.path.stringByDeletingLastPathComponent];
+    [S_ISLNK(entry.mode) ? symbolicLinks : files addObject:entry];
+  }
+  for (NSString *directory in directories) {
+    if (!EnsureEntryDirectory(rootPath, directory, error)) {
+      return NO;
+    }
+  }
+
+  // Taking the largest entries first keeps all cores busy until the end of the extraction.
+  [files sortUsingComparator:^ NSComparisonResult (FBArchiveUnpacker_ZipEntry *left, FBArchiveUnpacker_ZipEntry *right) {
+    if (left.uncompressedSize == right.uncompressedSize) {
+      return NSOrderedSame;
+    }
+    return left.uncompressedSize > right.uncompressedSize ? NSOrderedAscending : NSOrderedDescending;
+  }];
+  NSLock *lock = [NSLock new];
+  __block NSError *firstError = nil;
+  dispatch_apply(files.count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t index) {
+    [lock lock];
+    BOOL hasFailed = firstError != nil;
+    [lock unlock];
+    if (hasFailed) {
+      return;
+    }
+    FBArchiveUnpacker_ZipEntry *entry = files[index];
+    NSError *innerError = nil;
+    if (WriteZipEntry(entry, bytes + entry.dataOffset, rootPath, &innerError)) {
+      return;
+    }
+    [lock lock];
+    firstError = firstError ?: innerError;
+    [lock unlock];
+  });
+  if (firstError) {
+    if (error) {
+      *error = firstError;
+    }
+    return NO;
+  }
+  for (FBArchiveUnpacker_ZipEntry *entry in symbolicLinks) {
+    if (!WriteZipEntry(entry, bytes + entry.dataOffset, rootPath, error)) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+#pragma mark Streaming Formats
+
+@protocol FBArchiveUnpacker_Format <NSObject>
+
+/**
+ Consumes bytes from the front of the input.
+
+ @return the number of bytes consumed, 0 if more bytes are needed or -1 on error.
+ */
+- (NSInteger)consumeBytes:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error;
+
+/**
+ Completes extraction once all input has been recieved, with any bytes that were not consumed.
+ */
+- (BOOL)finishWithBytes:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error;
+
+/**
+ Stops extraction after an error, waiting for any outstanding work.
+ */
+- (void)abort;
+
+@end
+
+typedef NS_ENUM(NSUInteger, FBArchiveUnpackerZipState) {
+  FBArchiveUnpackerZipStateHeader = 0,
+  FBArchiveUnpackerZipStateData = 1,
+  FBArchiveUnpackerZipStateStreamingData = 2,
+  FBArchiveUnpackerZipStateDescriptor = 3,
+  FBArchiveUnpackerZipStateTrailer = 4,
+};
+
+@interface FBArchiveUnpacker_ZipStream : NSObject <FBArchiveUnpacker_Format>
+
+@property (nonatomic, copy, readonly) NSString *rootPath;
+@property (nonatomic, assign, readwrite) FBArchiveUnpackerZipState state;
+@property (nonatomic, strong, nullable, readwrite) FBArchiveUnpacker_ZipEntry *entry;
+@property (nonatomic, assign, readwrite) BOOL entryIsZip64;
+@property (nonatomic, assign, readonly) z_stream *stream;
+@property (nonatomic, assign, readwrite) BOOL streamInitialized;
+@property (nonatomic, strong, readonly) NSMutableData *outputBuffer;
+@property (nonatomic, assign, readwrite) int fileDescriptor;
+@property (nonatomic, assign, readwrite) uLong crc;
+@property (nonatomic, assign, readwrite) uint64_t producedLength;
+@property (nonatomic, strong, readonly) dispatch_group_t group;
+@property (nonatomic, strong, readonly) dispatch_semaphore_t semaphore;
+@property (nonatomic, strong, readonly) NSLock *lock;
+@property (nonatomic, strong, nullable, readwrite) NSError *asyncError;
+
+@end
+
+@implementation FBArchiveUnpacker_ZipStream
+
+- (instancetype)initWithRootPath:(NSString *)rootPath
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _rootPath = rootPath;
+  _stream = calloc(1, sizeof(z_stream));
+  _outputBuffer = [NSMutableData dataWithLength:InflateBufferSize];
+  _fileDescriptor = -1;
+  _group = dispatch_group_create();
+  // Bounds the number of buffered entries waiting to be written.
+  _semaphore = dispatch_semaphore_create((long) NSProcessInfo.processInfo.activeProcessorCount * 2);
+  _lock = [NSLock new];
+
+  return self;
+}
+
+- (void)dealloc
+{
+  [self closeStreamingEntry];
+  free(_stream);
+}
+
+#pragma mark FBArchiveUnpacker_Format
+
+- (NSInteger)consumeBytes:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error
+{
+  NSError *asyncError = self.pendingAsyncError;
+  if (asyncError) {
+    if (error) {
+      *error = asyncError;
+    }
+    return -1;
+  }
+  switch (self.state) {
+    case FBArchiveUnpackerZipStateHeader:
+      return [self consumeHeader:bytes length:length error:error];
+    case FBArchiveUnpackerZipStateData:
+      return [self consumeData:bytes length:length];
+    case FBArchiveUnpackerZipStateStreamingData:
+      return [self consumeStreamingData:bytes length:length error:error];
+    case FBArchiveUnpackerZipStateDescriptor:
+      return [self consumeDescriptor:bytes length:length error:error];
+    case FBArchiveUnpackerZipStateTrailer:
+      // The Central Directory is only interpreted once all of it has arrived.
+      return 0;
+  }
+  return 0;
+}
+
+- (BOOL)finishWithBytes:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error
+{
+  dispatch_group_wait(self.group, DISPATCH_TIME_FOREVER);
+  NSError *asyncError = self.pendingAsyncError;
+  if (asyncError) {
+    if (error) {
+      *error = asyncError;
+    }
+    return NO;
+  }
+  if (self.state != FBArchiveUnpackerZipStateHeader && self.state != FBArchiveUnpackerZipStateTrailer) {
+    [self closeStreamingEntry];
+    return [[FBControlCoreError
+      describeFormat:@"ZIP archive ended part way through %@", self.entry.path]
+      failBool:error];
+  }
+  // Local Headers do not contain permissions, so these are applied from the Central Directory.
+  size_t position = 0;
+  while (position + 4 <= length && ReadUInt32(bytes + position) == ZipCentralDirectorySignature) {
+    size_t recordLength = 0;
+    FBArchiveUnpacker_ZipEntry *entry = ParseCentralDirectoryRecord(bytes + position, length - position, &recordLength, error);
+    if (!entry) {
+      return NO;
+    }
+    position += recordLength;
+    if (entry.mode == 0 || entry.isDirectory) {
+      continue;
+    }
+    if (S_ISLNK(entry.mode)) {
+      // Links are only known from the Central Directory, so are created after all other entries have been written.
+      NSString *destination = ReadSymbolicLinkPlaceholder(self.rootPath, entry.path);
+      if (!destination || !CreateSymbolicLink(self.rootPath, entry.path, destination, error)) {
+        return [[FBControlCoreError
+          describeFormat:@"Failed to convert %@ to a symbolic link", [self.rootPath stringByAppendingPathComponent:entry.path]]
+          failBool:error];
+      }
+      continue;
+    }
+    SetEntryPermissions(self.rootPath, entry.path, entry.mode);
+  }
+  return YES;
+}
+
+- (void)abort
+{
+  dispatch_group_wait(self.group, DISPATCH_TIME_FOREVER);
+  [self closeStreamingEntry];
+}
+
+#pragma mark Private
+
+- (nullable NSError *)pendingAsyncError
+{
+  [self.lock lock];
+  NSError *error = self.asyncError;
+  [self.lock unlock];
+  return error;
+}
+
+- (NSInteger)consumeHeader:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error
+{
+  if (length < 4) {
+    return 0;
+  }
+  uint32_t signature = ReadUInt32(bytes);
+  if (signature == ZipCentralDirectorySignature || signature == ZipEndOfCentralDirectorySignature || signature == Zip64EndOfCentralDirectorySignature) {
+    self.state = FBArchiveUnpackerZipStateTrailer;
+    return 0;
+  }
+  if (signature != ZipLocalFileHeaderSignature) {
+    [[FBControlCoreError
+      describeFormat:@"Unexpected ZIP record signature %08x", signature]
+      failBool:error];
+    return -1;
+  }
+  if (length < ZipLocalFileHeaderLength) {
+    return 0;
+  }
+  size_t nameLength = ReadUInt16(bytes + 26);
+  size_t extraLength = ReadUInt16(bytes + 28);
+  size_t headerLength = ZipLocalFileHeaderLength + nameLength + extraLength;
+  if (length < headerLength) {
+    return 0;
+  }
+  NSString *entryPath = EntryPathFromBytes(bytes + ZipLocalFileHeaderLength, nameLength, error);
+  if (!entryPath) {
+    return -1;
+  }
+  uint64_t uncompressedSize = ReadUInt32(bytes + 22);
+  uint64_t compressedSize = ReadUInt32(bytes + 18);
+  FBArchiveUnpacker_ZipEntry *entry = [FBArchiveUnpacker_ZipEntry new];
+  entry.path = entryPath;
+  entry.flags = ReadUInt16(bytes + 6);
+  entry.method = ReadUInt16(bytes + 8);
+  entry.crc = ReadUInt32(bytes + 14);
+  self.entryIsZip64 = ApplyZip64ExtraField(bytes + ZipLocalFileHeaderLength + nameLength, extraLength, &uncompressedSize, &compressedSize, NULL);
+  entry.uncompressedSize = uncompressedSize;
+  entry.compressedSize = compressedSize;
+  self.entry = entry;
+
+  BOOL hasDescriptor = (entry.flags & ZipFlagDataDescriptor) != 0;
+  if (entry.isDirectory) {
+    if (!EnsureEntryDirectory(self.rootPath, entryPath, error)) {
+      return -1;
+    }
+    self.crc = crc32(0L, Z_NULL, 0);
+    self.producedLength = 0;
+    self.state = hasDescriptor ? FBArchiveUnpackerZipStateDescriptor : FBArchiveUnpackerZipStateHeader;
+    return (NSInteger) headerLength;
+  }
+  if (entry.flags & ZipFlagEncrypted) {
+    [[FBControlCoreError
+      describeFormat:@"Encrypted ZIP entry %@ is not supported", entryPath]
+      failBool:error];
+    return -1;
+  }
+  if (!hasDescriptor) {
+    self.state = FBArchiveUnpackerZipStateData;
+    return (NSInteger) headerLength;
+  }
+  // The size of the entry is only known after its data, so it must be inflated as it arrives.
+  if (entry.method != ZipMethodDeflated) {
+    [[FBControlCoreError
+      describeFormat:@"ZIP entry %@ is stored with a data descriptor, so cannot be streamed", entryPath]
+      failBool:error];
+    return -1;
+  }
+  self.fileDescriptor = OpenOutputFile(self.rootPath, entryPath, 0, error);
+  if (self.fileDescriptor == -1) {
+    return -1;
+  }
+  memset(self.stream, 0, sizeof(z_stream));
+  if (inflateInit2(self.stream, -MAX_WBITS) != Z_OK) {
+    [self closeStreamingEntry];
+    [[FBControlCoreError
+      describeFormat:@"Failed to initialize inflation of %@", entryPath]
+      failBool:error];
+    return -1;
+  }
+  self.streamInitialized = YES;
+  self.crc = crc32(0L, Z_NULL, 0);
+  self.producedLength = 0;
+  self.state = FBArchiveUnpackerZipStateStreamingData;
+  return (NSInteger) headerLength;
+}
+
+- (NSInteger)consumeData:(const uint8_t *)bytes length:(size_t)length
+{
+  FBArchiveUnpacker_ZipEntry *entry = self.entry;
+  if (length < entry.compressedSize) {
+    return 0;
+  }
+  // The entry is complete, so can be inflated and written whilst later entries arrive.
+  NSData *data = [NSData dataWithBytes:bytes length:(NSUInteger) entry.compressedSize];
+  NSString *rootPath = self.rootPath;
+  dispatch_semaphore_wait(self.semaphore, DISPATCH_TIME_FOREVER);
+  dispatch_group_async(self.group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+    NSError *innerError = nil;
+    if (!WriteZipEntry(entry, data.bytes, rootPath, &innerError)) {
+      [self.lock lock];
+      self.asyncError = self.asyncError ?: innerError;
+      [self.lock unlock];
+    }
+    dispatch_semaphore_signal(self.semaphore);
+  });
+  self.state = FBArchiveUnpackerZipStateHeader;
+  return (NSInteger) entry.compressedSize;
+}
+
+- (NSInteger)consumeStreamingData:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error
+{
+  z_stream *stream = self.stream;
+  uint8_t *buffer = self.outputBuffer.mutableBytes;
+  stream->next_in = (Bytef *) bytes;
+  stream->avail_in = (uInt) MIN(length, (size_t) UINT32_MAX);
+  size_t offered = stream->avail_in;
+  int status = Z_OK;
+  do {
+    stream->next_out = buffer;
+    stream->avail_out = (uInt) InflateBufferSize;
+    status = inflate(stream, Z_NO_FLUSH);
+    if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+      [self closeStreamingEntry];
+      [[FBControlCoreError
+        describeFormat:@"Failed to inflate %@, zlib status %d", self.entry.path, status]
+        failBool:error];
+      return -1;
+    }
+    size_t producedLength = InflateBufferSize - stream->avail_out;
+    if (producedLength > 0) {
+      self.crc = crc32(self.crc, buffer, (uInt) producedLength);
+      self.producedLength += producedLength;
+      if (!WriteAll(self.fileDescriptor, buffer, producedLength)) {
+        [self closeStreamingEntry];
+        [[FBControlCoreError
+          describeFormat:@"Failed to write %@: %s", self.entry.path, strerror(errno)]
+          failBool:error];
+        return -1;
+      }
+    }
+  } while (status == Z_OK && (stream->avail_in > 0 || stream->avail_out == 0));
+
+  size_t consumed = offered - stream->avail_in;
+  if (status == Z_STREAM_END) {
+    [self closeStreamingEntry];
+    self.state = FBArchiveUnpackerZipStateDescriptor;
+  }
+  return (NSInteger) consumed;
+}
+
+- (NSInteger)consumeDescriptor:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error
+{
+  if (length < 4) {
+    return 0;
+  }
+  // The signature of the descriptor is optional.
+  size_t signatureLength = ReadUInt32(bytes) == ZipDataDescriptorSignature ? 4 : 0;
+  size_t sizeLength = self.entryIsZip64 ? 8 : 4;
+  size_t descriptorLength = signatureLength + 4 + sizeLength * 2;
+  if (length < descriptorLength) {
+    return 0;
+  }
+  const uint8_t *fields = bytes + signatureLength;
+  uint32_t crc = ReadUInt32(fields);
+  uint64_t uncompressedSize = self.entryIsZip64 ? ReadUInt64(fields + 12) : ReadUInt32(fields + 8);
+  if (crc != self.crc || uncompressedSize != self.producedLength) {
+    [[FBControlCoreError
+      describeFormat:@"Extracted %@ is corrupt, expected %llu bytes with CRC %08x, got %llu bytes with CRC %08lx", self.entry.path, uncompressedSize, crc, self.producedLength, self.crc]
+      failBool:error];
+    return -1;
+  }
+  self.state = FBArchiveUnpackerZipStateHeader;
+  return (NSInteger) descriptorLength;
+}
+
+- (void)closeStreamingEntry
+{
+  if (self.streamInitialized) {
+    inflateEnd(self.stream);
+    self.streamInitialized = NO;
+  }
+  if (self.fileDescriptor != -1) {
+    FinishOutputFile(self.fileDescriptor, 0, YES);
+    self.fileDescriptor = -1;
+  }
+}
+
+@end
+
+typedef NS_ENUM(NSUInteger, FBArchiveUnpackerTarState) {
+  FBArchiveUnpackerTarStateHeader = 0,
+  FBArchiveUnpackerTarStateFileData = 1,
+  FBArchiveUnpackerTarStateCollect = 2,
+  FBArchiveUnpackerTarStateSkip = 3,
+  FBArchiveUnpackerTarStateEnd = 4,
+};
+
+static NSString *TarString(const uint8_t *field, size_t length)
+{
+  size_t stringLength = strnlen((const char *) field, length);
+  return [[NSString alloc] initWithBytes:field length:stringLength encoding:NSUTF8StringEncoding]
+    ?: [[NSString alloc] initWithBytes:field length:stringLength encoding:NSISOLatin1StringEncoding];
+}
+
+static uint64_t TarNumber(const uint8_t *field, size_t length)
+{
+  // Large values are stored in base-256, marked by the high bit of the first byte.
+  if (field[0] & 0x80) {
+    uint64_t value = field[0] & 0x7f;
+    for (size_t index = 1; index < length; index++) {
+      value = (value << 8) | field[index];
+    }
+    return value;
+  }
+  uint64_t value = 0;
+  for (size_t index = 0; index < length; index++) {
+    uint8_t character = field[index];
+    if (character == ' ' && value == 0) {
+      continue;
+    }
+    if (character < '0' || character > '7') {
+      break;
+    }
+    value = (value << 3) | (uint64_t) (character - '0');
+  }
+  return value;
+}
+
+@interface FBArchiveUnpacker_TarStream : NSObject <FBArchiveUnpacker_Format>
+
+@property (nonatomic, copy, readonly) NSString *rootPath;
+@property (nonatomic, assign, readonly) BOOL gzipped;
+@property (nonatomic, assign, readonly) z_stream *stream;
+@property (nonatomic, assign, readwrite) BOOL streamInitialized;
+@property (nonatomic, assign, readwrite) BOOL streamEnded;
+@property (nonatomic, strong, readonly) NSMutableData *outputBuffer;
+@property (nonatomic, strong, readonly) NSMutableData *tarBuffer;
+@property (nonatomic, assign, readwrite) FBArchiveUnpackerTarState state;
+@property (nonatomic, assign, readwrite) uint64_t remaining;
+@property (nonatomic, assign, readwrite) uint64_t padding;
+@property (nonatomic, assign, readwrite) NSUInteger zeroBlocks;
+@property (nonatomic, assign, readwrite) int fileDescriptor;
+@property (nonatomic, assign, readwrite) mode_t fileMode;
+@property (nonatomic, copy, nullable, readwrite) NSString *filePath;
+@property (nonatomic, assign, readwrite) char collectType;
+@property (nonatomic, strong, readonly) NSMutableData *collected;
+@property (nonatomic, copy, nullable, readwrite) NSString *pendingPath;
+@property (nonatomic, copy, nullable, readwrite) NSString *pendingLinkPath;
+@property (nonatomic, strong, readonly) NSMutableArray<NSArray<NSString *> *> *symbolicLinks;
+
+@end
+
+@implementation FBArchiveUnpacker_TarStream
+
+- (instancetype)initWithRootPath:(NSString *)rootPath gzipped:(BOOL)gzipped
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _rootPath = rootPath;
+  _gzipped = gzipped;
+  _stream = calloc(1, sizeof(z_stream));
+  _outputBuffer = [NSMutableData dataWithLength:InflateBufferSize];
+  _tarBuffer = [NSMutableData data];
+  _collected = [NSMutableData data];
+  _symbolicLinks = [NSMutableArray array];
+  _fileDescriptor = -1;
+
+  return self;
+}
+
+- (void)dealloc
+{
+  [self abort];
+  free(_stream);
+}
+
+#pragma mark FBArchiveUnpacker_Format
+
+- (NSInteger)consumeBytes:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error
+{
+  if (!self.gzipped) {
+    [self.tarBuffer appendBytes:bytes length:length];
+  } else if (![self inflateBytes:bytes length:length error:error]) {
+    return -1;
+  }
+  if (![self parseWithError:error]) {
+    return -1;
+  }
+  return (NSInteger) length;
+}
+
+- (BOOL)finishWithBytes:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error
+{
+  BOOL isComplete = self.state == FBArchiveUnpackerTarStateEnd || (self.state == FBArchiveUnpackerTarStateHeader && self.tarBuffer.length == 0);
+  [self abort];
+  if (!isComplete) {
+    return [[FBControlCoreError
+      describe:@"TAR archive ended part way through an entry"]
+      failBool:error];
+  }
+  for (NSArray<NSString *> *symbolicLink in self.symbolicLinks) {
+    if (!CreateSymbolicLink(self.rootPath, symbolicLink[0], symbolicLink[1], error)) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+- (void)abort
+{
+  if (self.streamInitialized) {
+    inflateEnd(self.stream);
+    self.streamInitialized = NO;
+  }
+  if (self.fileDescriptor != -1) {
+    FinishOutputFile(self.fileDescriptor, self.fileMode, YES);
+    self.fileDescriptor = -1;
+  }
+}
+
+#pragma mark Private
+
+- (BOOL)inflateBytes:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error
+{
+  if (self.streamEnded) {
+    return YES;
+  }
+  z_stream *stream = self.stream;
+  if (!self.streamInitialized) {
+    // Adding 16 to the window bits decodes the gzip wrapper.
+    if (inflateInit2(stream, MAX_WBITS + 16) != Z_OK) {
+      return [[FBControlCoreError
+        describe:@"Failed to initialize gzip decompression"]
+        failBool:error];
+    }
+    self.streamInitialized = YES;
+  }
+  uint8_t *buffer = self.outputBuffer.mutableBytes;
+  stream->next_in = (Bytef *) bytes;
+  stream->avail_in = (uInt) length;
+  int status = Z_OK;
+  do {
+    stream->next_out = buffer;
+    stream->avail_out = (uInt) InflateBufferSize;
+    status = inflate(stream, Z_NO_FLUSH);
+    if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+      return [[FBControlCoreError
+        describeFormat:@"Failed to decompress gzip stream, zlib status %d", status]
+        failBool:error];
+    }
+    [self.tarBuffer appendBytes:buffer length:InflateBufferSize - stream->avail_out];
+  } while (status == Z_OK && (stream->avail_in > 0 || stream->avail_out == 0));
+  if (status == Z_STREAM_END) {
+    inflateEnd(stream);
+    self.streamInitialized = NO;
+    self.streamEnded = YES;
+  }
+  return YES;
+}
+
+- (BOOL)parseWithError:(NSError **)error
+{
+  const uint8_t *bytes = self.tarBuffer.bytes;
+  size_t length = self.tarBuffer.length;
+  size_t position = 0;
+  BOOL progressing = YES;
+  while (progressing) {
+    size_t available = length - position;
+    switch (self.state) {
+      case FBArchiveUnpackerTarStateHeader:
+        if (available < TarBlockSize) {
+          progressing = NO;
+          break;
+        }
+        if (![self parseHeader:bytes + position error:error]) {
+          return NO;
+        }
+        position += TarBlockSize;
+        break;
+      case FBArchiveUnpackerTarStateFileData: {
+        size_t chunkLength = (size_t) MIN((uint64_t) available, self.remaining);
+        if (chunkLength > 0 && !WriteAll(self.fileDescriptor, bytes + position, chunkLength)) {
+          return [[FBControlCoreError
+            describeFormat:@"Failed to write %@: %s", self.filePath, strerror(errno)]
+            failBool:error];
+        }
+        position += chunkLength;
+        self.remaining -= chunkLength;
+        if (self.remaining > 0) {
+          progressing = NO;
+          break;
+        }
+        FinishOutputFile(self.fileDescriptor, self.fileMode, YES);
+        self.fileDescriptor = -1;
+        [self skip:self.padding];
+        break;
+      }
+      case FBArchiveUnpackerTarStateCollect: {
+        size_t chunkLength = (size_t) MIN((uint64_t) available, self.remaining);
+        [self.collected appendBytes:bytes + position length:chunkLength];
+        position += chunkLength;
+        self.remaining -= chunkLength;
+        if (self.remaining > 0) {
+          progressing = NO;
+          break;
+        }
+        [self applyCollected];
+        [self skip:self.padding];
+        break;
+      }
+      case FBArchiveUnpackerTarStateSkip: {
+        size_t chunkLength = (size_t) MIN((uint64_t) available, self.remaining);
+        position += chunkLength;
+        self.remaining -= chunkLength;
+        if (self.remaining > 0) {
+          progressing = NO;
+          break;
+        }
+        self.state = FBArchiveUnpackerTarStateHeader;
+        break;
+      }
+      case FBArchiveUnpackerTarStateEnd:
+        // Anything after the end-of-archive blocks is padding.
+        position = length;
+        progressing = NO;
+        break;
+    }
+  }
+  [self.tarBuffer replaceBytesInRange:NSMakeRange(0, position) withBytes:NULL length:0];
+  return YES;
+}
+
+- (void)skip:(uint64_t)length
+{
+  self.remaining = length;
+  self.state = length > 0 ? FBArchiveUnpackerTarStateSkip : FBArchiveUnpackerTarStateHeader;
+}
+
+- (BOOL)parseHeader:(const uint8_t *)header error:(NSError **)error
+{
+  BOOL isZeroBlock = YES;
+  for (size_t index = 0; index < TarBlockSize; index++) {
+    if (header[index] != 0) {
+      isZeroBlock = NO;
+      break;
+    }
+  }
+  if (isZeroBlock) {
+    self.zeroBlocks += 1;
+    if (self.zeroBlocks >= 2) {
+      self.state = FBArchiveUnpackerTarStateEnd;
+    }
+    return YES;
+  }
+  self.zeroBlocks = 0;
+
+  NSString *name = TarString(header, 100);
+  if (memcmp(header + 257, "ustar", 5) == 0) {
+    NSString *prefix = TarString(header + 345, 155);
+    if (prefix.length > 0) {
+      name = [prefix stringByAppendingPathComponent:name];
+    }
+  }
+  name = self.pendingPath ?: name;
+  NSString *linkName = self.pendingLinkPath ?: TarString(header + 157, 100);
+  self.pendingPath = nil;
+  self.pendingLinkPath = nil;
+  uint64_t size = TarNumber(header + 124, 12);
+  mode_t mode = (mode_t) TarNumber(header + 100, 8);
+  char type = (char) header[156];
+  self.padding = (TarBlockSize - size % TarBlockSize) % TarBlockSize;
+
+  switch (type) {
+    case 'x':
+    case 'L':
+    case 'K':
+      [self.collected setLength:0];
+      self.collectType = type;
+      self.remaining = size;
+      self.state = FBArchiveUnpackerTarStateCollect;
+      if (size == 0) {
+        [self applyCollected];
+        [self skip:self.padding];
+      }
+      return YES;
+    case '0':
+    case '\0':
+    case '7':
+    case '5':
+    case '2':
+    case '1':
+      break;
+    default:
+      // Global headers, devices and fifos are not extracted.
+      [self skip:size + self.padding];
+      return YES;
+  }
+
+  NSString *entryPath = ValidatedEntryPath(name, error);
+  if (!entryPath) {
+    return NO;
+  }
+  if (type == '5') {
+    [self skip:size + self.padding];
+    return EnsureEntryDirectory(self.rootPath, entryPath, error);
+  }
+  if (type == '2') {
+    // Links are created once the archive is complete, so that no later entry is written through one.
+    [self skip:size + self.padding];
+    [self.symbolicLinks addObject:@[entryPath, linkName]];
+    return YES;
+  }
+  if (type == '1') {
+    NSString *linkPath = ValidatedEntryPath(linkName, error);
+    if (!linkPath) {
+      return NO;
+    }
+    [self skip:size + self.padding];
+    return CreateHardLink(self.rootPath, entryPath, linkPath, error);
+  }
+  self.fileDescriptor = OpenOutputFile(self.rootPath, entryPath, size, error);
+  if (self.fileDescriptor == -1) {
+    return NO;
+  }
+  self.filePath = [self.rootPath stringByAppendingPathComponent:entryPath];
+  self.fileMode = mode;
+  self.remaining = size;
+  self.state = FBArchiveUnpackerTarStateFileData;
+  if (size == 0) {
+    FinishOutputFile(self.fileDescriptor, self.fileMode, YES);
+    self.fileDescriptor = -1;
+    [self skip:self.padding];
+  }
+  return YES;
+}
+
+- (void)applyCollected
+{
+  if (self.collectType == 'L' || self.collectType == 'K') {
+    NSString *value = TarString(self.collected.bytes, self.collected.length);
+    if (self.collectType == 'L') {
+      self.pendingPath = value;
+    } else {
+      self.pendingLinkPath = value;
+    }
+    return;
+  }
+  // Extended headers are a sequence of "<length> <key>=<value>\n" records.
+  const char *bytes = self.collected.bytes;
+  size_t length = self.collected.length;
+  size_t position = 0;
+  while (position < length) {
+    size_t recordLength = 0;
+    size_t cursor = position;
+    while (cursor < length && bytes[cursor] >= '0' && bytes[cursor] <= '9') {
+      recordLength = recordLength * 10 + (size_t) (bytes[cursor] - '0');
+      cursor++;
+    }
+    if (recordLength == 0 || position + recordLength > length || cursor >= length || bytes[cursor] != ' ') {
+      return;
+    }
+    NSString *record = [[NSString alloc] initWithBytes:bytes + cursor + 1 length:position + recordLength - cursor - 2 encoding:NSUTF8StringEncoding];
+    NSRange equals = [record rangeOfString:@"="];
+    if (equals.location != NSNotFound) {
+      NSString *key = [record substringToIndex:equals.location];
+      NSString *value = [record substringFromIndex:equals.location + 1];
+      if ([key isEqualToString:@"path"]) {
+        self.pendingPath = value;
+      } else if ([key isEqualToString:@"linkpath"]) {
+        self.pendingLinkPath = value;
+      }
+    }
+    position += recordLength;
+  }
+}
+
+@end
+
+#pragma mark - FBArchiveUnpacker
+
+@interface FBArchiveUnpacker ()
+
+@property (nonatomic, copy, readonly) NSString *rootPath;
+@property (nonatomic, strong, readonly) NSMutableData *buffer;
+@property (nonatomic, strong, nullable, readwrite) id<FBArchiveUnpacker_Format> format;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *mutableCompleted;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *mutableEofHasBeenReceived;
+@property (nonatomic, assign, readwrite) BOOL finished;
+
+@end
+
+@implementation FBArchiveUnpacker
+
+#pragma mark Initializers
+
++ (instancetype)streamingUnpackerToDirectory:(NSURL *)destination
+{
+  return [[self alloc] initWithRootPath:destination.path];
+}
+
+- (instancetype)initWithRootPath:(NSString *)rootPath
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _rootPath = rootPath;
+  _buffer = [NSMutableData data];
+  _mutableCompleted = [FBMutableFuture futureWithNameFormat:@"Extraction to %@", rootPath];
+  _mutableEofHasBeenReceived = FBMutableFuture.future;
+
+  return self;
+}
+
+#pragma mark Public Methods
+
++ (BOOL)extractArchiveAtPath:(NSString *)path toDirectory:(NSURL *)destination error:(NSError **)error
+{
+  int fileDescriptor = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor == -1) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to open %@ for reading: %s", path, strerror(errno)]
+      failBool:error];
+  }
+  struct stat fileStat;
+  if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0) {
+    close(fileDescriptor);
+    return [[FBControlCoreError
+      describeFormat:@"Archive %@ is empty or could not be read", path]
+      failBool:error];
+  }
+  size_t length = (size_t) fileStat.st_size;
+  const uint8_t *bytes = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (bytes == MAP_FAILED) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to map %@: %s", path, strerror(errno)]
+      failBool:error];
+  }
+
+  BOOL success = NO;
+  if (length >= 4 && ReadUInt32(bytes) == ZipLocalFileHeaderSignature) {
+    success = ExtractZip(bytes, length, destination.path, error);
+  } else {
+    // Other formats are sequential, so are fed through the streaming extractor.
+    madvise((void *) bytes, length, MADV_SEQUENTIAL);
+    FBArchiveUnpacker *unpacker = [[self alloc] initWithRootPath:destination.path];
+    success = YES;
+    for (size_t offset = 0; offset < length && success; offset += FileFeedSize) {
+      success = [unpacker consumeBytes:bytes + offset length:MIN(FileFeedSize, length - offset) error:error];
+    }
+    success = success && [unpacker finishWithError:error];
+    if (!success) {
+      [unpacker.format abort];
+    }
+  }
+  munmap((void *) bytes, length);
+  return success;
+}
+
++ (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue extractArchiveAtPath:(NSString *)path toDirectory:(NSURL *)destination
+{
+  return [FBFuture onQueue:queue resolveValue:^ NSNull * (NSError **error) {
+    if (![self extractArchiveAtPath:path toDirectory:destination error:error]) {
+      return nil;
+    }
+    return NSNull.null;
+  }];
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  @synchronized (self) {
+    if (self.finished) {
+      return;
+    }
+    NSError *error = nil;
+    if (![self consumeBytes:data.bytes length:data.length error:&error]) {
+      [self.format abort];
+      [self completeWithError:error];
+    }
+  }
+}
+
+- (void)consumeEndOfFile
+{
+  @synchronized (self) {
+    [self.mutableEofHasBeenReceived resolveWithResult:NSNull.null];
+    if (self.finished) {
+      return;
+    }
+    NSError *error = nil;
+    if (![self finishWithError:&error]) {
+      [self.format abort];
+      [self completeWithError:error];
+      return;
+    }
+    [self completeWithError:nil];
+  }
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)eofHasBeenReceived
+{
+  return self.mutableEofHasBeenReceived;
+}
+
+#pragma mark Properties
+
+- (FBFuture<NSNull *> *)completed
+{
+  return self.mutableCompleted;
+}
+
+#pragma mark Private
+
+- (BOOL)consumeBytes:(const uint8_t *)bytes length:(size_t)length error:(NSError **)error
+{
+  [self.buffer appendBytes:bytes length:length];
+  if (!self.format) {
+    if (self.buffer.length < 2) {
+      return YES;
+    }
+    const uint8_t *header = self.buffer.bytes;
+    if (header[0] == 'P' && header[1] == 'K') {
+      self.format = [[FBArchiveUnpacker_ZipStream alloc] initWithRootPath:self.rootPath];
+    } else {
+      self.format = [[FBArchiveUnpacker_TarStream alloc] initWithRootPath:self.rootPath gzipped:(header[0] == 0x1f && header[1] == 0x8b)];
+    }
+  }
+
+  size_t position = 0;
+  while (position < self.buffer.length) {
+    NSInteger consumed = [self.format consumeBytes:(const uint8_t *) self.buffer.bytes + position length:self.buffer.length - position error:error];
+    if (consumed < 0) {
+      return NO;
+    }
+    if (consumed == 0) {
+      break;
+    }
+    position += (size_t) consumed;
+  }
+  [self.buffer replaceBytesInRange:NSMakeRange(0, position) withBytes:NULL length:0];
+  return YES;
+}
+
+- (BOOL)finishWithError:(NSError **)error
+{
+  if (!self.format) {
+    return [[FBControlCoreError
+      describe:@"Archive ended before its format could be determined"]
+      failBool:error];
+  }
+  return [self.format finishWithBytes:self.buffer.bytes length:self.buffer.length error:error];
+}
+
+- (void)completeWithError:(nullable NSError *)error
+{
+  self.finished = YES;
+  self.buffer.length = 0;
+  if (error) {
+    [self.mutableCompleted resolveWithError:error];
+  } else {
+    [self.mutableCompleted resolveWithResult:NSNull.null];
+  }
+}
+
+@end
@@ -27,7 +27,8 @@ NS_ASSUME_NONNULL_BEGIN
 - (FBFuture<NSNull *> *)signBundleAtPath:(NSString *)bundlePath;
 
 /**
- Requests that the receiver codesigns a bundle and all bundles within its Frameworks directory.
+ Requests that the receiver codesigns a bundle and all code nested within its Frameworks and PlugIns directories.
+ Nested code is signed before the bundle that contains it.
 
  @param bundlePath path to bundle that should be signed.
  @return A future that resolves when the bundle has been signed.
@@ -44,8 +45,24 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+/**
+ A block that signs a single bundle or binary, without signing any code nested within it.
+
+ @param path the path of the bundle or binary to sign.
+ @param identityName the identity to sign with.
+ @return A future that resolves when the item has been signed.
+ */
+typedef FBFuture<NSNull *> *_Nonnull (^FBCodesignSigner)(NSString *path, NSString *identityName);
+
 /**
  A Default implementation of a Codesign Provider.
+
+ Recursive signing is performed bottom-up, with sibling items signed concurrently.
+ The CDHash of every item that is signed is recorded in an on-disk cache, keyed by the signing identity.
+ An item is not signed again if its current CDHash is in the cache, unless any code nested within it had to be signed.
+ Cached CDHashes are only trusted whilst the size, inode and modification time of every file in the item are unchanged.
+ The least recently used entries are evicted, and entries from other processes sharing the cache are merged when it is saved.
+ CDHashes are read from the Code Directory of the main executable, rather than by running codesign.
  */
 @interface FBCodesignProvider : NSObject <FBCodesignProvider>
 
@@ -65,6 +82,29 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (instancetype)codeSignCommandWithAdHocIdentity;
 
+/**
+ @param identityName identity used to codesign bundle.
+ @param signer the signer of individual items. If nil, /usr/bin/codesign is used.
+ @param cacheFilePath the path of the CDHash cache. If nil, no cache is used.
+ @return code sign command that signs bundles with given identity
+ */
++ (instancetype)codeSignCommandWithIdentityName:(NSString *)identityName signer:(nullable FBCodesignSigner)signer cacheFilePath:(nullable NSString *)cacheFilePath;
+
+/**
+ The default location of the CDHash cache.
+ */
+@property (nonatomic, class, copy, readonly) NSString *defaultCacheFilePath;
+
+/**
+ Reads the CDHash of a bundle, or a binary, from the Code Directory of the main executable.
+ Where there are multiple Code Directories, the one using the strongest hash is used, as with codesign.
+
+ @param path the path of the bundle or binary.
+ @param error an error out for any error that occurs.
+ @return the hex encoded CDHash, nil if the executable is not signed or could not be read.
+ */
++ (nullable NSString *)cdHashForItemAtPath:(NSString *)path error:(NSError **)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
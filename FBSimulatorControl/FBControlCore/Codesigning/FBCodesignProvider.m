@@ -9,15 +9,154 @@
 
 #import "FBCodesignProvider.h"
 
+#import <CommonCrypto/CommonDigest.h>
+#import <fcntl.h>
+#import <sys/file.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
 #import <FBControlCore/FBControlCore.h>
 
+#import "FBBinaryParser.h"
 #import "FBControlCoreError.h"
 
-static NSString *const CDHashPrefix = @"CDHash=";
+static const uint32_t CSMagicEmbeddedSignature = 0xfade0cc0;
+static const uint32_t CSMagicCodeDirectory = 0xfade0c02;
+static const uint32_t CSSlotCodeDirectory = 0;
+static const uint32_t CSSlotAlternateCodeDirectories = 0x1000;
+static const uint32_t CSSlotAlternateCodeDirectoryLimit = 5;
+static const size_t CSCodeDirectoryHashTypeOffset = 37;
+static const uint8_t CSHashTypeSHA1 = 1;
+static const uint8_t CSHashTypeSHA256 = 2;
+static const uint8_t CSHashTypeSHA256Truncated = 3;
+static const uint8_t CSHashTypeSHA384 = 4;
+static const NSUInteger CDHashLength = 20;
+static const NSUInteger CacheCapacityPerIdentity = 4096;
+static NSString *const CacheFingerprintKey = @"fingerprint";
+static NSString *const CacheLastUsedKey = @"last_used";
+
+typedef NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> FBCodesignCacheEntries;
+typedef NSMutableDictionary<NSString *, FBCodesignCacheEntries *> FBCodesignCache;
+
+static inline uint32_t ReadBigEndian32(const uint8_t *bytes)
+{
+  return ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) | ((uint32_t) bytes[2] << 8) | (uint32_t) bytes[3];
+}
+
+static NSString *HexString(const unsigned char *bytes, NSUInteger length)
+{
+  NSMutableString *string = [NSMutableString stringWithCapacity:length * 2];
+  for (NSUInteger index = 0; index < length; index++) {
+    [string appendFormat:@"%02x", bytes[index]];
+  }
+  return string;
+}
+
+static NSString *CDHashOfCodeDirectory(const uint8_t *bytes, uint32_t length)
+{
+  // The CDHash is the digest of the Code Directory, truncated to 20 bytes.
+  unsigned char digest[CC_SHA384_DIGEST_LENGTH];
+  switch (bytes[CSCodeDirectoryHashTypeOffset]) {
+    case CSHashTypeSHA1:
+      CC_SHA1(bytes, length, digest);
+      break;
+    case CSHashTypeSHA256:
+    case CSHashTypeSHA256Truncated:
+      CC_SHA256(bytes, length, digest);
+      break;
+    case CSHashTypeSHA384:
+      CC_SHA384(bytes, length, digest);
+      break;
+    default:
+      return nil;
+  }
+  return HexString(digest, CDHashLength);
+}
+
+static NSString *CDHashOfEmbeddedSignature(const uint8_t *bytes, size_t length)
+{
+  if (length < 12 || ReadBigEndian32(bytes) != CSMagicEmbeddedSignature) {
+    return nil;
+  }
+  uint32_t count = ReadBigEndian32(bytes + 8);
+  if (12 + (size_t) count * 8 > length) {
+    return nil;
+  }
+  // Signatures may contain a SHA-1 Code Directory alongside stronger alternates, codesign reports the strongest.
+  uint8_t bestHashType = 0;
+  NSString *bestHash = nil;
+  for (uint32_t index = 0; index < count; index++) {
+    const uint8_t *entry = bytes + 12 + index * 8;
+    uint32_t slot = ReadBigEndian32(entry);
+    uint32_t offset = ReadBigEndian32(entry + 4);
+    BOOL isCodeDirectory = slot == CSSlotCodeDirectory || (slot >= CSSlotAlternateCodeDirectories && slot < CSSlotAlternateCodeDirectories + CSSlotAlternateCodeDirectoryLimit);
+    if (!isCodeDirectory || (size_t) offset + CSCodeDirectoryHashTypeOffset + 1 > length) {
+      continue;
+    }
+    const uint8_t *codeDirectory = bytes + offset;
+    uint32_t codeDirectoryLength = ReadBigEndian32(codeDirectory + 4);
+    if (ReadBigEndian32(codeDirectory) != CSMagicCodeDirectory || (size_t) offset + codeDirectoryLength > length || codeDirectoryLength <= CSCodeDirectoryHashTypeOffset) {
+      continue;
+    }
+    uint8_t hashType = codeDirectory[CSCodeDirectoryHashTypeOffset];
+    if (hashType <= bestHashType) {
+      continue;
+    }
+    NSString *hash = CDHashOfCodeDirectory(codeDirectory, codeDirectoryLength);
+    if (hash) {
+      bestHash = hash;
+      bestHashType = hashType;
+    }
+  }
+  return bestHash;
+}
+
+static NSDictionary<NSString *, id> *CacheEntry(NSString *fingerprint)
+{
+  return @{CacheFingerprintKey: fingerprint, CacheLastUsedKey: @(NSDate.date.timeIntervalSince1970)};
+}
+
+static FBCodesignCache *CacheFromData(NSData *_Nullable data)
+{
+  FBCodesignCache *cache = [NSMutableDictionary dictionary];
+  NSDictionary<NSString *, id> *json = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+  if (![FBCollectionInformation isDictionaryHeterogeneous:json keyClass:NSString.class valueClass:NSDictionary.class]) {
+    return cache;
+  }
+  for (NSString *identity in json) {
+    NSDictionary<NSString *, id> *hashes = json[identity];
+    if (![FBCollectionInformation isDictionaryHeterogeneous:hashes keyClass:NSString.class valueClass:NSDictionary.class]) {
+      continue;
+    }
+    FBCodesignCacheEntries *entries = [NSMutableDictionary dictionary];
+    for (NSString *cdHash in hashes) {
+      NSDictionary<NSString *, id> *entry = hashes[cdHash];
+      if ([entry[CacheFingerprintKey] isKindOfClass:NSString.class] && [entry[CacheLastUsedKey] isKindOfClass:NSNumber.class]) {
+        entries[cdHash] = entry;
+      }
+    }
+    cache[identity] = entries;
+  }
+  return cache;
+}
+
+static void EvictLeastRecentlyUsed(FBCodesignCacheEntries *entries)
+{
+  if (entries.count <= CacheCapacityPerIdentity) {
+    return;
+  }
+  NSArray<NSString *> *leastRecentlyUsedFirst = [entries keysSortedByValueUsingComparator:^ NSComparisonResult (NSDictionary<NSString *, id> *left, NSDictionary<NSString *, id> *right) {
+    return [left[CacheLastUsedKey] compare:right[CacheLastUsedKey]];
+  }];
+  [entries removeObjectsForKeys:[leastRecentlyUsedFirst subarrayWithRange:NSMakeRange(0, entries.count - CacheCapacityPerIdentity)]];
+}
 
 @interface FBCodesignProvider ()
 
 @property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, copy, readonly) FBCodesignSigner signer;
+@property (nonatomic, copy, nullable, readonly) NSString *cacheFilePath;
+@property (nonatomic, strong, nullable, readwrite) FBCodesignCache *cache;
 
 @end
 
@@ -25,15 +164,20 @@ static NSString *const CDHashPrefix = @"CDHash=";
 
 + (instancetype)codeSignCommandWithIdentityName:(NSString *)identityName
 {
-  return [[self alloc] initWithIdentityName:identityName];
+  return [self codeSignCommandWithIdentityName:identityName signer:nil cacheFilePath:self.defaultCacheFilePath];
 }
 
 + (instancetype)codeSignCommandWithAdHocIdentity
 {
-  return [[self alloc] initWithIdentityName:@"-"];
+  return [self codeSignCommandWithIdentityName:@"-"];
+}
+
++ (instancetype)codeSignCommandWithIdentityName:(NSString *)identityName signer:(nullable FBCodesignSigner)signer cacheFilePath:(nullable NSString *)cacheFilePath
+{
+  return [[self alloc] initWithIdentityName:identityName signer:(signer ?: self.codesignToolSigner) cacheFilePath:cacheFilePath];
 }
 
-- (instancetype)initWithIdentityName:(NSString *)identityName
+- (instancetype)initWithIdentityName:(NSString *)identityName signer:(FBCodesignSigner)signer cacheFilePath:(nullable NSString *)cacheFilePath
 {
   self = [super init];
   if (!self) {
@@ -41,65 +185,295 @@ static NSString *const CDHashPrefix = @"CDHash=";
   }
 
   _identityName = identityName;
+  _signer = signer;
+  _cacheFilePath = cacheFilePath;
   _queue = dispatch_queue_create("com.facebook.fbcontrolcore.codesign", DISPATCH_QUEUE_CONCURRENT);
 
   return self;
 }
 
-#pragma mark - FBCodesignProvider protocol
+#pragma mark Properties
 
-+ (FBLogSearchPredicate *)logSearchPredicateForCDHash
++ (NSString *)defaultCacheFilePath
 {
-  return [FBLogSearchPredicate substrings:@[CDHashPrefix]];
+  NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject ?: NSTemporaryDirectory();
+  return [[caches stringByAppendingPathComponent:@"com.facebook.FBControlCore"] stringByAppendingPathComponent:@"codesign_cdhashes.json"];
 }
 
+#pragma mark - FBCodesignProvider protocol
+
 - (FBFuture<NSNull *> *)signBundleAtPath:(NSString *)bundlePath
 {
-  return [[[FBTaskBuilder
-    withLaunchPath:@"/usr/bin/codesign" arguments:@[@"-s", self.identityName, @"-f", bundlePath]]
-    runUntilCompletion]
-    mapReplace:NSNull.null];
+  return [self signRootItemAtPath:bundlePath recursive:NO];
 }
 
 - (FBFuture<NSNull *> *)recursivelySignBundleAtPath:(NSString *)bundlePath
 {
-  NSMutableArray<NSString *> *pathsToSign = [NSMutableArray arrayWithObject:bundlePath];
-  NSFileManager *fileManager = [NSFileManager defaultManager];
-  NSString *frameworksPath = [bundlePath stringByAppendingString:@"/Frameworks/"];
-  if ([fileManager fileExistsAtPath:frameworksPath]) {
-    NSError *fileSystemError;
-    for (NSString *frameworkPath in [fileManager contentsOfDirectoryAtPath:frameworksPath error:&fileSystemError]) {
-      [pathsToSign addObject:[frameworksPath stringByAppendingString:frameworkPath]];
+  return [self signRootItemAtPath:bundlePath recursive:YES];
+}
+
+- (FBFuture<NSString *> *)cdHashForBundleAtPath:(NSString *)bundlePath
+{
+  return [FBFuture onQueue:self.queue resolveValue:^ NSString * (NSError **error) {
+    return [FBCodesignProvider cdHashForItemAtPath:bundlePath error:error];
+  }];
+}
+
+#pragma mark Public
+
++ (nullable NSString *)cdHashForItemAtPath:(NSString *)path error:(NSError **)error
+{
+  NSString *executablePath = [self executablePathForItemAtPath:path];
+  if (!executablePath) {
+    return [[FBControlCoreError
+      describeFormat:@"Could not find an executable for %@", path]
+      fail:error];
+  }
+  FBMachOFile *file = [FBBinaryParser machOFileAtPath:executablePath error:error];
+  if (!file) {
+    return nil;
+  }
+  FBMachOSlice *slice = [self preferredSliceOfFile:file];
+  NSRange range = slice.codeSignatureRange;
+  if (range.location == NSNotFound) {
+    return [[FBControlCoreError
+      describeFormat:@"%@ is not signed", executablePath]
+      fail:error];
+  }
+  int fileDescriptor = open(executablePath.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor == -1) {
+    return [[FBControlCoreError
+      describeFormat:@"Could not open %@: %s", executablePath, strerror(errno)]
+      fail:error];
+  }
+  NSMutableData *signature = [NSMutableData dataWithLength:range.length];
+  ssize_t readLength = pread(fileDescriptor, signature.mutableBytes, range.length, (off_t) range.location);
+  close(fileDescriptor);
+  NSString *cdHash = readLength == (ssize_t) range.length ? CDHashOfEmbeddedSignature(signature.bytes, signature.length) : nil;
+  if (!cdHash) {
+    return [[FBControlCoreError
+      describeFormat:@"Could not find a Code Directory in the signature of %@", executablePath]
+      fail:error];
+  }
+  return cdHash;
+}
+
+#pragma mark Private
+
++ (FBCodesignSigner)codesignToolSigner
+{
+  return ^(NSString *path, NSString *identityName) {
+    return [[[FBTaskBuilder
+      withLaunchPath:@"/usr/bin/codesign" arguments:@[@"-s", identityName, @"-f", path]]
+      runUntilCompletion]
+      mapReplace:NSNull.null];
+  };
+}
+
+- (FBFuture<NSNull *> *)signRootItemAtPath:(NSString *)path recursive:(BOOL)recursive
+{
+  // The cache is saved before the future resolves, so that it is visible to any signing that follows.
+  return [[[self
+    signItemAtPath:path recursive:recursive]
+    onQueue:self.queue chain:^(FBFuture *future) {
+      [self persistCache];
+      return future;
+    }]
+    mapReplace:NSNull.null];
+}
+
+- (FBFuture<NSNumber *> *)signItemAtPath:(NSString *)path recursive:(BOOL)recursive
+{
+  // Nested code is signed first, as signing a bundle seals the signatures of everything within it.
+  NSMutableArray<FBFuture<NSNumber *> *> *nested = [NSMutableArray array];
+  if (recursive) {
+    for (NSString *nestedPath in [FBCodesignProvider nestedCodePathsInBundleAtPath:path]) {
+      [nested addObject:[self signItemAtPath:nestedPath recursive:YES]];
     }
-    if (fileSystemError) {
-      return [FBControlCoreError failFutureWithError:fileSystemError];
+  }
+  return [[FBFuture
+    futureWithFutures:nested]
+    onQueue:self.queue fmap:^(NSArray<NSNumber *> *nestedResults) {
+      // A bundle whose nested code has been re-signed has a stale seal, so must be re-signed regardless of the cache.
+      BOOL nestedWasSigned = [nestedResults containsObject:@YES];
+      if (!nestedWasSigned && [self isCachedItemAtPath:path]) {
+        return [FBFuture futureWithResult:@NO];
+      }
+      return [self.signer(path, self.identityName)
+        onQueue:self.queue map:^(id _) {
+          [self cacheItemAtPath:path];
+          return @YES;
+        }];
+    }];
+}
+
++ (NSArray<NSString *> *)nestedCodePathsInBundleAtPath:(NSString *)bundlePath
+{
+  NSMutableArray<NSString *> *paths = [NSMutableArray array];
+  for (NSString *directory in @[@"Frameworks", @"PlugIns", @"Contents/Frameworks", @"Contents/PlugIns"]) {
+    NSString *directoryPath = [bundlePath stringByAppendingPathComponent:directory];
+    for (NSString *name in [NSFileManager.defaultManager contentsOfDirectoryAtPath:directoryPath error:nil]) {
+      [paths addObject:[directoryPath stringByAppendingPathComponent:name]];
     }
   }
-  NSMutableArray<FBFuture<NSNull *> *> *futures = [NSMutableArray array];
-  for (NSString *pathToSign in pathsToSign) {
-    [futures addObject:[self signBundleAtPath:pathToSign]];
+  return paths;
+}
+
++ (nullable NSString *)executablePathForItemAtPath:(NSString *)path
+{
+  BOOL isDirectory = NO;
+  if (![NSFileManager.defaultManager fileExistsAtPath:path isDirectory:&isDirectory]) {
+    return nil;
   }
-  return [[FBFuture futureWithFutures:futures] mapReplace:NSNull.null];
+  if (!isDirectory) {
+    return path;
+  }
+  for (NSString *infoPlist in @[@"Info.plist", @"Contents/Info.plist", @"Resources/Info.plist"]) {
+    NSString *executableName = [NSDictionary dictionaryWithContentsOfFile:[path stringByAppendingPathComponent:infoPlist]][@"CFBundleExecutable"];
+    if (![executableName isKindOfClass:NSString.class]) {
+      continue;
+    }
+    for (NSString *directory in @[@"", @"Contents/MacOS"]) {
+      NSString *executablePath = [[path stringByAppendingPathComponent:directory] stringByAppendingPathComponent:executableName];
+      if ([NSFileManager.defaultManager fileExistsAtPath:executablePath]) {
+        return executablePath;
+      }
+    }
+  }
+  return nil;
 }
 
-- (FBFuture<NSString *> *)cdHashForBundleAtPath:(NSString *)bundlePath
++ (FBMachOSlice *)preferredSliceOfFile:(FBMachOFile *)file
+{
+#if defined(__arm64__)
+  NSString *hostArchitecture = @"arm64";
+#else
+  NSString *hostArchitecture = @"x86_64";
+#endif
+  for (FBMachOSlice *slice in file.slices) {
+    if ([slice.architecture isEqualToString:hostArchitecture]) {
+      return slice;
+    }
+  }
+  return file.slices.firstObject;
+}
+
++ (NSString *)contentFingerprintOfItemAtPath:(NSString *)path
 {
-  return [[[FBTaskBuilder
-    withLaunchPath:@"/usr/bin/codesign" arguments:@[@"-dvvvv", bundlePath]]
-    runUntilCompletion]
-    onQueue:self.queue fmap:^(FBTask *task) {
-      NSString *output = task.stdErr;
-      NSString *cdHash = [[[FBLogSearch
-        withText:output predicate:FBCodesignProvider.logSearchPredicateForCDHash]
-        firstMatchingLine]
-        stringByReplacingOccurrencesOfString:CDHashPrefix withString:@""];
-      if (!cdHash) {
-        return [[FBControlCoreError
-          describeFormat:@"Could not find '%@' in output: %@", CDHashPrefix, output]
-          failFuture];
+  // The CDHash covers the executable, but not changes to resources made after signing, so these are fingerprinted separately.
+  // The modification time has nanosecond precision, so that an edit in the same second as signing is not missed.
+  // The inode changes when a file is replaced, even if the size and modification time of the replacement are the same.
+  NSURL *url = [NSURL fileURLWithPath:path];
+  NSArray<NSURLResourceKey> *keys = @[NSURLIsRegularFileKey];
+  NSMutableArray<NSString *> *entries = [NSMutableArray array];
+  for (NSURL *fileURL in [NSFileManager.defaultManager enumeratorAtURL:url includingPropertiesForKeys:keys options:0 errorHandler:nil]) {
+    NSDictionary<NSURLResourceKey, id> *values = [fileURL resourceValuesForKeys:keys error:nil];
+    struct stat fileStat;
+    if (![values[NSURLIsRegularFileKey] boolValue] || lstat(fileURL.fileSystemRepresentation, &fileStat) != 0) {
+      continue;
+    }
+    NSString *relativePath = [fileURL.path substringFromIndex:MIN(url.path.length, fileURL.path.length)];
+    [entries addObject:[NSString stringWithFormat:@"%@:%lld:%llu:%ld.%09ld", relativePath, (long long) fileStat.st_size, (unsigned long long) fileStat.st_ino, (long) fileStat.st_mtimespec.tv_sec, (long) fileStat.st_mtimespec.tv_nsec]];
+  }
+  [entries sortUsingSelector:@selector(compare:)];
+  NSData *listing = [[entries componentsJoinedByString:@"\n"] dataUsingEncoding:NSUTF8StringEncoding];
+  unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+  CC_SHA256(listing.bytes, (CC_LONG) listing.length, digest);
+  return HexString(digest, CC_SHA256_DIGEST_LENGTH);
+}
+
+- (BOOL)isCachedItemAtPath:(NSString *)path
+{
+  if (!self.cacheFilePath) {
+    return NO;
+  }
+  NSString *cdHash = [FBCodesignProvider cdHashForItemAtPath:path error:nil];
+  if (!cdHash) {
+    return NO;
+  }
+  NSString *fingerprint = [FBCodesignProvider contentFingerprintOfItemAtPath:path];
+  @synchronized (self) {
+    FBCodesignCacheEntries *entries = self.loadedCache[self.identityName];
+    if (![entries[cdHash][CacheFingerprintKey] isEqualToString:fingerprint]) {
+      return NO;
+    }
+    // Hits are recorded, so that it is the least recently used entries that are evicted.
+    entries[cdHash] = CacheEntry(fingerprint);
+    return YES;
+  }
+}
+
+- (void)cacheItemAtPath:(NSString *)path
+{
+  if (!self.cacheFilePath) {
+    return;
+  }
+  NSString *cdHash = [FBCodesignProvider cdHashForItemAtPath:path error:nil];
+  if (!cdHash) {
+    return;
+  }
+  NSString *fingerprint = [FBCodesignProvider contentFingerprintOfItemAtPath:path];
+  @synchronized (self) {
+    FBCodesignCache *cache = self.loadedCache;
+    FBCodesignCacheEntries *entries = cache[self.identityName];
+    if (!entries) {
+      entries = [NSMutableDictionary dictionary];
+      cache[self.identityName] = entries;
+    }
+    entries[cdHash] = CacheEntry(fingerprint);
+    EvictLeastRecentlyUsed(entries);
+  }
+}
+
+- (FBCodesignCache *)loadedCache
+{
+  if (!self.cache) {
+    self.cache = CacheFromData([NSData dataWithContentsOfFile:self.cacheFilePath]);
+  }
+  return self.cache;
+}
+
+- (void)persistCache
+{
+  if (!self.cacheFilePath) {
+    return;
+  }
+  @synchronized (self) {
+    if (!self.cache) {
+      return;
+    }
+    [NSFileManager.defaultManager createDirectoryAtPath:self.cacheFilePath.stringByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:nil];
+    // Other processes may be signing with the same cache, so their entries are merged in whilst the lock is held.
+    // The cache is only an optimization, so failing to lock it means that it is not persisted.
+    NSString *lockPath = [self.cacheFilePath stringByAppendingPathExtension:@"lock"];
+    int lockDescriptor = open(lockPath.fileSystemRepresentation, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lockDescriptor == -1) {
+      return;
+    }
+    if (flock(lockDescriptor, LOCK_EX) != 0) {
+      close(lockDescriptor);
+      return;
+    }
+    FBCodesignCache *persisted = CacheFromData([NSData dataWithContentsOfFile:self.cacheFilePath]);
+    for (NSString *identity in persisted) {
+      FBCodesignCacheEntries *entries = self.cache[identity];
+      if (!entries) {
+        self.cache[identity] = persisted[identity];
+        continue;
       }
-      return [FBFuture futureWithResult:cdHash];
-    }];
+      [persisted[identity] enumerateKeysAndObjectsUsingBlock:^(NSString *cdHash, NSDictionary<NSString *, id> *entry, BOOL *stop) {
+        NSDictionary<NSString *, id> *existing = entries[cdHash];
+        if (!existing || [existing[CacheLastUsedKey] compare:entry[CacheLastUsedKey]] == NSOrderedAscending) {
+          entries[cdHash] = entry;
+        }
+      }];
+      EvictLeastRecentlyUsed(entries);
+    }
+    NSData *data = [NSJSONSerialization dataWithJSONObject:self.cache options:0 error:nil];
+    [data writeToFile:self.cacheFilePath atomically:YES];
+    flock(lockDescriptor, LOCK_UN);
+    close(lockDescriptor);
+  }
 }
 
 @end
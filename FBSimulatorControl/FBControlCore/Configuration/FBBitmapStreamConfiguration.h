@@ -33,6 +33,15 @@ extern FBBitmapStreamEncoding const FBBitmapStreamEncodingBGRA;
  */
 + (instancetype)configurationWithEncoding:(FBBitmapStreamEncoding)encoding framesPerSecond:(nullable NSNumber *)framesPerSecond;
 
+/**
+ The Designated Initializer, for a stream that adapts to the rate at which frames are consumed.
+
+ @param encoding the stream type to use.
+ @param framesPerSecond the maximum number of frames per second. nil if a lazy stream.
+ @param latencyBudget the end-to-end latency in seconds that the stream will lower its frame rate to stay within. nil if not adaptive.
+ */
++ (instancetype)configurationWithEncoding:(FBBitmapStreamEncoding)encoding framesPerSecond:(nullable NSNumber *)framesPerSecond latencyBudget:(nullable NSNumber *)latencyBudget;
+
 /**
  The encoding of the stream.
  */
@@ -44,6 +53,12 @@ extern FBBitmapStreamEncoding const FBBitmapStreamEncodingBGRA;
  */
 @property (nonatomic, copy, nullable, readonly) NSNumber *framesPerSecond;
 
+/**
+ The end-to-end latency in seconds that an adaptive stream should stay within.
+ nil if the stream should not adapt to the consumer.
+ */
+@property (nonatomic, copy, nullable, readonly) NSNumber *latencyBudget;
+
 @end
 
 NS_ASSUME_NONNULL_END
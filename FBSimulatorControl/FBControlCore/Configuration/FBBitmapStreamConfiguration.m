@@ -22,10 +22,15 @@ FBBitmapStreamEncoding const FBBitmapStreamEncodingBGRA = @"bgra";
 
 + (instancetype)configurationWithEncoding:(FBBitmapStreamEncoding)encoding framesPerSecond:(nullable NSNumber *)framesPerSecond
 {
-  return [[self alloc] initWithEncoding:encoding framesPerSecond:framesPerSecond];
+  return [[self alloc] initWithEncoding:encoding framesPerSecond:framesPerSecond latencyBudget:nil];
 }
 
-- (instancetype)initWithEncoding:(FBBitmapStreamEncoding)encoding framesPerSecond:(nullable NSNumber *)framesPerSecond
++ (instancetype)configurationWithEncoding:(FBBitmapStreamEncoding)encoding framesPerSecond:(nullable NSNumber *)framesPerSecond latencyBudget:(nullable NSNumber *)latencyBudget
+{
+  return [[self alloc] initWithEncoding:encoding framesPerSecond:framesPerSecond latencyBudget:latencyBudget];
+}
+
+- (instancetype)initWithEncoding:(FBBitmapStreamEncoding)encoding framesPerSecond:(nullable NSNumber *)framesPerSecond latencyBudget:(nullable NSNumber *)latencyBudget
 {
   self = [super init];
   if (!self) {
@@ -34,6 +39,7 @@ FBBitmapStreamEncoding const FBBitmapStreamEncodingBGRA = @"bgra";
 
   _encoding = encoding;
   _framesPerSecond = framesPerSecond;
+  _latencyBudget = latencyBudget;
 
   return self;
 }
@@ -54,20 +60,22 @@ FBBitmapStreamEncoding const FBBitmapStreamEncodingBGRA = @"bgra";
   }
 
   return (self.encoding == object.encoding || [self.encoding isEqualToString:object.encoding])
-      && (self.framesPerSecond == object.framesPerSecond || [self.framesPerSecond isEqualToNumber:object.framesPerSecond]);
+      && (self.framesPerSecond == object.framesPerSecond || [self.framesPerSecond isEqualToNumber:object.framesPerSecond])
+      && (self.latencyBudget == object.latencyBudget || [self.latencyBudget isEqualToNumber:object.latencyBudget]);
 }
 
 - (NSUInteger)hash
 {
-  return self.encoding.hash ^ self.framesPerSecond.hash;
+  return self.encoding.hash ^ self.framesPerSecond.hash ^ self.latencyBudget.hash;
 }
 
 - (NSString *)description
 {
   return [NSString stringWithFormat:
-    @"Encoding %@ | FPS %@",
+    @"Encoding %@ | FPS %@ | Latency Budget %@",
     self.encoding,
-    self.framesPerSecond
+    self.framesPerSecond,
+    self.latencyBudget
   ];
 }
 
@@ -75,12 +83,14 @@ FBBitmapStreamEncoding const FBBitmapStreamEncodingBGRA = @"bgra";
 
 static NSString *const KeyStreamEncoding = @"encoding";
 static NSString *const KeyFramesPerSecond = @"frames_per_second";
+static NSString *const KeyLatencyBudget = @"latency_budget";
 
 - (id)jsonSerializableRepresentation
 {
   return @{
     KeyStreamEncoding: self.encoding,
     KeyFramesPerSecond: self.framesPerSecond ?: NSNull.null,
+    KeyLatencyBudget: self.latencyBudget ?: NSNull.null,
   };
 }
 
@@ -103,7 +113,13 @@ static NSString *const KeyFramesPerSecond = @"frames_per_second";
       describeFormat:@"%@ is not a Number for %@", framesPerSecond, KeyFramesPerSecond]
       fail:error];
   }
-  return [[self alloc] initWithEncoding:encoding framesPerSecond:framesPerSecond];
+  NSNumber *latencyBudget = [FBCollectionOperations nullableValueForDictionary:json key:KeyLatencyBudget];
+  if (latencyBudget && ![latencyBudget isKindOfClass:NSNumber.class]) {
+    return [[FBControlCoreError
+      describeFormat:@"%@ is not a Number for %@", latencyBudget, KeyLatencyBudget]
+      fail:error];
+  }
+  return [[self alloc] initWithEncoding:encoding framesPerSecond:framesPerSecond latencyBudget:latencyBudget];
 }
 
 @end
@@ -22,6 +22,7 @@ NS_ASSUME_NONNULL_BEGIN
 extern FBiOSTargetFutureType const FBiOSTargetFutureTypeSearch;
 
 @class FBDiagnostic;
+@class FBIncrementalLogReader;
 @class FBLogSearchPredicate;
 
 @protocol FBiOSTarget;
@@ -89,6 +90,27 @@ typedef NS_OPTIONS(NSUInteger, FBBatchLogSearchOptions) {
  */
 - (FBBatchLogSearchResult *)searchDiagnostics:(NSArray<FBDiagnostic *> *)diagnostics;
 
+/**
+ Runs the Reciever over the lines appended to an array of Diagnostics since the last search with the same reader.
+ File backed diagnostics are read incrementally by the reader, other diagnostics are searched in full.
+
+ @param diagnostics an NSArray of FBDiagnostics to search.
+ @param reader the reader that retains the offsets of previous searches.
+ @return a search result
+ */
+- (FBBatchLogSearchResult *)searchDiagnostics:(NSArray<FBDiagnostic *> *)diagnostics sinceLastReadOf:(FBIncrementalLogReader *)reader;
+
+/**
+ Runs the Reciever over an array of Diagnostics, using a trigram index of each file backed diagnostic.
+ Indexes are built on the first search of a diagnostic and re-used by later searches, including those in other processes.
+ This is worthwhile when the same logs are searched repeatedly with different predicates.
+
+ @param diagnostics an NSArray of FBDiagnostics to search.
+ @param indexDirectory the directory to store indexes in.
+ @return a search result
+ */
+- (FBBatchLogSearchResult *)searchDiagnostics:(NSArray<FBDiagnostic *> *)diagnostics indexDirectory:(NSString *)indexDirectory;
+
 /**
  Runs the Reciever over an iOS Target.
 
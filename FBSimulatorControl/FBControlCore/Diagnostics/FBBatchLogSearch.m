@@ -16,7 +16,9 @@
 #import "FBControlCoreError.h"
 #import "FBDiagnostic.h"
 #import "FBEventReporter.h"
+#import "FBIncrementalLogReader.h"
 #import "FBLogCommands.h"
+#import "FBLogIndex.h"
 #import "FBLogSearch.h"
 #import "FBEventReporterSubject.h"
 #import "FBiOSTarget.h"
@@ -251,60 +253,51 @@ static NSString *const KeySince = @"since";
 {
   NSParameterAssert([FBCollectionInformation isArrayHeterogeneous:diagnostics withClass:FBDiagnostic.class]);
 
-  // Construct an NSDictionary<FBDiagnosticName, FBDiagnostic> of diagnostics.
-  NSDictionary *namesToDiagnostics = [NSDictionary dictionaryWithObjects:diagnostics forKeys:[diagnostics valueForKey:@"shortName"]];
+  return [self searchDiagnostics:diagnostics searchesForDiagnostic:^(FBDiagnostic *diagnostic, NSArray<FBLogSearchPredicate *> *predicates) {
+    NSMutableArray<FBLogSearch *> *searches = [NSMutableArray array];
+    for (FBLogSearchPredicate *predicate in predicates) {
+      [searches addObject:[FBDiagnosticLogSearch withDiagnostic:diagnostic predicate:predicate]];
+    }
+    return [searches copy];
+  }];
+}
 
-  // Construct and NSArray<FBLogSearch> instances
-  NSMutableArray *searchers = [NSMutableArray array];
-  for (NSString *diagnosticName in self.mapping.allKeys) {
-    NSArray *predicates = self.mapping[diagnosticName];
+- (FBBatchLogSearchResult *)searchDiagnostics:(NSArray<FBDiagnostic *> *)diagnostics sinceLastReadOf:(FBIncrementalLogReader *)reader
+{
+  NSParameterAssert([FBCollectionInformation isArrayHeterogeneous:diagnostics withClass:FBDiagnostic.class]);
 
-    if ([diagnosticName isEqualToString:@""]) {
-      for (FBDiagnostic *diagnostic in diagnostics) {
-        for (FBLogSearchPredicate *predicate in predicates) {
-          [searchers addObject:[FBDiagnosticLogSearch withDiagnostic:diagnostic predicate:predicate]];
-        }
+  return [self searchDiagnostics:diagnostics searchesForDiagnostic:^(FBDiagnostic *diagnostic, NSArray<FBLogSearchPredicate *> *predicates) {
+    // Diagnostics that are not backed by a file have constant content, so are searched in full.
+    NSMutableArray<FBLogSearch *> *searches = [NSMutableArray array];
+    if (!diagnostic.isBackedByFile) {
+      for (FBLogSearchPredicate *predicate in predicates) {
+        [searches addObject:[FBDiagnosticLogSearch withDiagnostic:diagnostic predicate:predicate]];
       }
+      return [searches copy];
     }
-    FBDiagnostic *diagnostic = namesToDiagnostics[diagnosticName];
-    if (!diagnostic) {
-      continue;
-    }
+    // The appended lines are read once, as reading them advances the offset of the reader.
+    NSArray<NSString *> *lines = [reader readAppendedLinesAtPath:diagnostic.asPath error:nil] ?: @[];
     for (FBLogSearchPredicate *predicate in predicates) {
-      [searchers addObject:[FBDiagnosticLogSearch withDiagnostic:diagnostic predicate:predicate]];
+      [searches addObject:[FBLogSearch withLines:lines predicate:predicate]];
     }
-  }
+    return [searches copy];
+  }];
+}
 
-  // Perform the search, concurrently
-  FBBatchLogSearchOptions options = self.options;
-  NSArray<NSArray *> *results = [FBConcurrentCollectionOperations
-    mapFilter:[searchers copy]
-    map:^ NSArray * (FBDiagnosticLogSearch *search) {
-      NSArray<NSString *> *matches = [FBBatchLogSearch search:search withOptions:options];
-      if (matches.count == 0) {
-       return nil;
-      }
-      return @[search.diagnostic.shortName, matches];
-    }
-    predicate:NSPredicate.notNullPredicate];
+- (FBBatchLogSearchResult *)searchDiagnostics:(NSArray<FBDiagnostic *> *)diagnostics indexDirectory:(NSString *)indexDirectory
+{
+  NSParameterAssert([FBCollectionInformation isArrayHeterogeneous:diagnostics withClass:FBDiagnostic.class]);
 
-  // Rebuild the output dictionary
-  NSMutableDictionary *output = [NSMutableDictionary dictionary];
-  for (NSArray *result in results) {
-    NSString *key = result[0];
-    NSArray<NSString *> *values = result[1];
-    NSMutableArray<NSString *> *matches = output[key];
-    if (!matches) {
-      matches = [NSMutableArray array];
-      output[key] = matches;
+  return [self searchDiagnostics:diagnostics searchesForDiagnostic:^(FBDiagnostic *diagnostic, NSArray<FBLogSearchPredicate *> *predicates) {
+    // Diagnostics that are not backed by a file, or fail to be indexed, are searched in full.
+    NSMutableArray<FBLogSearch *> *searches = [NSMutableArray array];
+    NSString *path = diagnostic.isBackedByFile ? diagnostic.asPath : nil;
+    FBLogIndex *index = path ? [FBLogIndex indexForPath:path indexPath:[FBLogIndex indexPathForPath:path inDirectory:indexDirectory] error:nil] : nil;
+    for (FBLogSearchPredicate *predicate in predicates) {
+      [searches addObject:index ? [index searchWithPredicate:predicate] : [FBDiagnosticLogSearch withDiagnostic:diagnostic predicate:predicate]];
     }
-    [matches addObjectsFromArray:values];
-  }
-
-  // The JSON Inflation will check the format, so is a sanity chek on the data structure.
-  FBBatchLogSearchResult *result = [FBBatchLogSearchResult inflateFromJSON:[output copy] error:nil];
-  NSAssert(result != nil, @"%@ search result should be well-formed, but isn't", output);
-  return result;
+    return [searches copy];
+  }];
 }
 
 - (FBFuture<FBBatchLogSearchResult *> *)searchOnTarget:(id<FBiOSTarget>)target
@@ -380,7 +373,76 @@ static NSString *const KeySince = @"since";
   return dateFormatter;
 }
 
-+ (NSArray<NSString *> *)search:(FBDiagnosticLogSearch *)search withOptions:(FBBatchLogSearchOptions)options
+- (FBBatchLogSearchResult *)searchDiagnostics:(NSArray<FBDiagnostic *> *)diagnostics searchesForDiagnostic:(NSArray<FBLogSearch *> *(^)(FBDiagnostic *diagnostic, NSArray<FBLogSearchPredicate *> *predicates))searchesForDiagnostic
+{
+  // Collect all of the predicates for each diagnostic, so that each diagnostic is only read once.
+  // Where multiple diagnostics share a name, the last one is searched by name.
+  NSMutableDictionary<id, NSNumber *> *namesToIndices = [NSMutableDictionary dictionary];
+  NSMutableArray<NSMutableArray<FBLogSearchPredicate *> *> *predicatesByIndex = [NSMutableArray array];
+  for (NSUInteger index = 0; index < diagnostics.count; index++) {
+    namesToIndices[diagnostics[index].shortName ?: (id) NSNull.null] = @(index);
+    [predicatesByIndex addObject:[NSMutableArray array]];
+  }
+  for (NSString *diagnosticName in self.mapping.allKeys) {
+    NSArray<FBLogSearchPredicate *> *predicates = self.mapping[diagnosticName];
+    if ([diagnosticName isEqualToString:@""]) {
+      for (NSMutableArray<FBLogSearchPredicate *> *diagnosticPredicates in predicatesByIndex) {
+        [diagnosticPredicates addObjectsFromArray:predicates];
+      }
+    }
+    NSNumber *index = namesToIndices[diagnosticName];
+    if (!index) {
+      continue;
+    }
+    [predicatesByIndex[index.unsignedIntegerValue] addObjectsFromArray:predicates];
+  }
+
+  // Construct an NSArray<[FBDiagnosticName, FBLogSearch]> of the searches to perform.
+  NSMutableArray<NSArray *> *searchers = [NSMutableArray array];
+  for (NSUInteger index = 0; index < diagnostics.count; index++) {
+    NSArray<FBLogSearchPredicate *> *predicates = predicatesByIndex[index];
+    if (predicates.count == 0) {
+      continue;
+    }
+    FBDiagnostic *diagnostic = diagnostics[index];
+    for (FBLogSearch *search in searchesForDiagnostic(diagnostic, predicates)) {
+      [searchers addObject:@[diagnostic.shortName, search]];
+    }
+  }
+
+  // Perform the search, concurrently
+  FBBatchLogSearchOptions options = self.options;
+  NSArray<NSArray *> *results = [FBConcurrentCollectionOperations
+    mapFilter:[searchers copy]
+    map:^ NSArray * (NSArray *searcher) {
+      NSArray<NSString *> *matches = [FBBatchLogSearch search:searcher[1] withOptions:options];
+      if (matches.count == 0) {
+       return nil;
+      }
+      return @[searcher[0], matches];
+    }
+    predicate:NSPredicate.notNullPredicate];
+
+  // Rebuild the output dictionary
+  NSMutableDictionary *output = [NSMutableDictionary dictionary];
+  for (NSArray *result in results) {
+    NSString *key = result[0];
+    NSArray<NSString *> *values = result[1];
+    NSMutableArray<NSString *> *matches = output[key];
+    if (!matches) {
+      matches = [NSMutableArray array];
+      output[key] = matches;
+    }
+    [matches addObjectsFromArray:values];
+  }
+
+  // The JSON Inflation will check the format, so is a sanity chek on the data structure.
+  FBBatchLogSearchResult *result = [FBBatchLogSearchResult inflateFromJSON:[output copy] error:nil];
+  NSAssert(result != nil, @"%@ search result should be well-formed, but isn't", output);
+  return result;
+}
+
++ (NSArray<NSString *> *)search:(FBLogSearch *)search withOptions:(FBBatchLogSearchOptions)options
 {
   BOOL lines = options & FBBatchLogSearchOptionsFullLines;
   BOOL first = options & FBBatchLogSearchOptionsFirstMatch;
@@ -82,6 +82,11 @@ typedef NSString *FBDiagnosticName NS_EXTENSIBLE_STRING_ENUM;
  */
 @property (nonatomic, readonly, assign) BOOL isSearchableAsText;
 
+/**
+ Whether the log is backed by a file, so its content may change as the file is written to.
+ */
+@property (nonatomic, readonly, assign) BOOL isBackedByFile;
+
 /**
  Writes the FBDiagnostic out to a file path.
  This call is optimised for backing store of the reciever.
@@ -133,6 +133,11 @@
   return self.asString != nil;
 }
 
+- (BOOL)isBackedByFile
+{
+  return NO;
+}
+
 - (BOOL)writeOutToFilePath:(NSString *)path error:(NSError **)error
 {
   return NO;
@@ -549,6 +554,11 @@
   return attributes[NSFileSize] && [attributes[NSFileSize] unsignedLongLongValue] > 0;
 }
 
+- (BOOL)isBackedByFile
+{
+  return YES;
+}
+
 - (BOOL)writeOutToFilePath:(NSString *)path error:(NSError **)error
 {
   if ([NSFileManager.defaultManager fileExistsAtPath:path] && ![NSFileManager.defaultManager removeItemAtPath:path error:error]) {
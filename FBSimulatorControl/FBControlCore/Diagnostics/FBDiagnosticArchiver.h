@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBDataConsumer.h>
+#import <FBControlCore/FBFuture.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBDiagnostic;
+@class FBDiagnosticQuery;
+
+@protocol FBControlCoreLogger;
+@protocol FBiOSTarget;
+
+/**
+ Produces the Diagnostics for a single entry in an archive.
+ */
+typedef FBFuture<NSArray<FBDiagnostic *> *> *_Nonnull (^FBDiagnosticArchiverProducer)(void);
+
+/**
+ The name of the manifest that is written as the last entry of the archive.
+ */
+extern NSString *const FBDiagnosticArchiverManifestName;
+
+/**
+ Collects Diagnostics from many targets into a single gzipped TAR archive.
+
+ Diagnostics are collected from up to 'maximumConcurrency' targets at once.
+ The Diagnostics of each target are placed in a directory named after the target, in the order that the targets finish.
+ The archive is streamed to the consumer as it is written, with files read in chunks, so neither the archive nor the files are held in memory.
+ If the consumer applies backpressure, writing is paused until it has drained.
+
+ A file that is shared between targets (such as the CoreSimulator log) is only stored once.
+ Subsequent occurences are stored as hard links to the first.
+
+ An archiver writes a single archive, so can only be used once.
+ */
+@interface FBDiagnosticArchiver : NSObject
+
+#pragma mark Initializers
+
+/**
+ Constructs an Archiver.
+
+ @param consumer the consumer of the gzipped archive. An end-of-file is sent once the archive has been written.
+ @param maximumConcurrency the maximum number of targets to collect from at once.
+ @param logger the logger to log to.
+ @return a new Archiver.
+ */
++ (instancetype)archiverWithConsumer:(id<FBDataConsumer>)consumer maximumConcurrency:(NSUInteger)maximumConcurrency logger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Runs the Diagnostic Query against each of the targets, archiving the results in a directory named by the UDID of the target.
+
+ @param query the query to run.
+ @param targets the targets to query.
+ @return a Future wrapping the manifest of the archive.
+ */
+- (FBFuture<NSDictionary<NSString *, id> *> *)archiveQuery:(FBDiagnosticQuery *)query ofTargets:(NSArray<id<FBiOSTarget>> *)targets;
+
+/**
+ Archives the Diagnostics from each of the producers, in a directory named by the key of the producer.
+ A producer that fails is recorded in the manifest, it does not fail the archive.
+
+ @param producers a mapping of directory name to producer.
+ @return a Future wrapping the manifest of the archive.
+ */
+- (FBFuture<NSDictionary<NSString *, id> *> *)archiveProducers:(NSDictionary<NSString *, FBDiagnosticArchiverProducer> *)producers;
+
+@end
+
+NS_ASSUME_NONNULL_END
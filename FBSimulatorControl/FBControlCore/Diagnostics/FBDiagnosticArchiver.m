@@ -0,0 +1,535 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBDiagnosticArchiver.h"
+
+#import <sys/stat.h>
+#import <zlib.h>
+
+#import "FBControlCoreError.h"
+#import "FBControlCoreLogger.h"
+#import "FBDiagnostic.h"
+#import "FBDiagnosticQuery.h"
+#import "FBiOSTarget.h"
+
+NSString *const FBDiagnosticArchiverManifestName = @"manifest.json";
+
+static NSString *const KeyTargets = @"targets";
+static NSString *const KeyFiles = @"files";
+static NSString *const KeyLinks = @"links";
+static NSString *const KeyErrors = @"errors";
+static NSString *const KeyFilesWritten = @"files_written";
+static NSString *const KeyFilesLinked = @"files_linked";
+static NSString *const KeyBytesRead = @"bytes_read";
+static NSString *const KeyBytesCompressed = @"bytes_compressed";
+
+static const size_t TarBlockSize = 512;
+static const size_t TarNameLength = 100;
+static const uint64_t TarMaximumOctalSize = 077777777777ULL;
+static const size_t ReadChunkSize = 256 * 1024;
+static const size_t DeflateBufferSize = 256 * 1024;
+
+static void AppendPaxRecord(NSMutableData *records, NSString *key, NSString *value)
+{
+  // The length of a record includes the digits of the length itself.
+  size_t base = 3 + strlen(key.UTF8String) + strlen(value.UTF8String);
+  size_t length = base;
+  while (YES) {
+    size_t total = base + (size_t) snprintf(NULL, 0, "%zu", length);
+    if (total == length) {
+      break;
+    }
+    length = total;
+  }
+  NSString *record = [NSString stringWithFormat:@"%zu %@=%@\n", length, key, value];
+  [records appendData:[record dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+static void WaitForConsumerToDrain(id<FBDataConsumer> consumer)
+{
+  if (![consumer conformsToProtocol:@protocol(FBDataConsumerBackpressure)]) {
+    return;
+  }
+  FBFuture<NSNull *> *drained = [(id<FBDataConsumerBackpressure>) consumer drained];
+  if (drained.hasCompleted) {
+    return;
+  }
+  dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+  [drained onQueue:dispatch_get_global_queue(QOS_CLASS_UTILITY, 0) notifyOfCompletion:^(FBFuture *_) {
+    dispatch_semaphore_signal(semaphore);
+  }];
+  dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+}
+
+@interface FBDiagnosticArchiver_TarWriter : NSObject
+
+@property (nonatomic, strong, readonly) id<FBDataConsumer> consumer;
+@property (nonatomic, assign, readonly) z_stream *stream;
+@property (nonatomic, strong, readonly) NSMutableData *outputBuffer;
+@property (nonatomic, strong, readonly) NSMutableData *readBuffer;
+@property (nonatomic, assign, readwrite) size_t outputLength;
+@property (nonatomic, assign, readwrite) uint64_t bytesRead;
+@property (nonatomic, assign, readwrite) uint64_t bytesCompressed;
+
+@end
+
+@implementation FBDiagnosticArchiver_TarWriter
+
+- (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _consumer = consumer;
+  _stream = calloc(1, sizeof(z_stream));
+  // Adding 16 to the window bits writes a gzip wrapper.
+  deflateInit2(_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+  _outputBuffer = [NSMutableData dataWithLength:DeflateBufferSize];
+  _readBuffer = [NSMutableData dataWithLength:ReadChunkSize];
+
+  return self;
+}
+
+- (void)dealloc
+{
+  deflateEnd(_stream);
+  free(_stream);
+}
+
+#pragma mark Entries
+
+- (BOOL)appendDirectory:(NSString *)archivePath mode:(mode_t)mode mtime:(time_t)mtime error:(NSError **)error
+{
+  return [self appendHeaderWithPath:[archivePath stringByAppendingString:@"/"] type:'5' size:0 mode:mode mtime:mtime linkPath:nil error:error];
+}
+
+- (BOOL)appendSymbolicLink:(NSString *)archivePath destination:(NSString *)destination mtime:(time_t)mtime error:(NSError **)error
+{
+  return [self appendHeaderWithPath:archivePath type:'2' size:0 mode:0755 mtime:mtime linkPath:destination error:error];
+}
+
+- (BOOL)appendHardLink:(NSString *)archivePath toArchivePath:(NSString *)linkPath mode:(mode_t)mode mtime:(time_t)mtime error:(NSError **)error
+{
+  return [self appendHeaderWithPath:archivePath type:'1' size:0 mode:mode mtime:mtime linkPath:linkPath error:error];
+}
+
+- (BOOL)appendData:(NSData *)data archivePath:(NSString *)archivePath error:(NSError **)error
+{
+  if (![self appendHeaderWithPath:archivePath type:'0' size:data.length mode:0644 mtime:(time_t) NSDate.date.timeIntervalSince1970 linkPath:nil error:error]) {
+    return NO;
+  }
+  if (![self writeBytes:data.bytes length:data.length flush:Z_NO_FLUSH error:error]) {
+    return NO;
+  }
+  return [self padEntryOfSize:data.length error:error];
+}
+
+- (BOOL)appendFileDescriptor:(int)fileDescriptor archivePath:(NSString *)archivePath size:(uint64_t)size mode:(mode_t)mode mtime:(time_t)mtime error:(NSError **)error
+{
+  if (![self appendHeaderWithPath:archivePath type:'0' size:size mode:mode mtime:mtime linkPath:nil error:error]) {
+    return NO;
+  }
+  uint8_t *buffer = self.readBuffer.mutableBytes;
+  uint64_t remaining = size;
+  while (remaining > 0) {
+    size_t chunkLength = (size_t) MIN(remaining, (uint64_t) ReadChunkSize);
+    ssize_t result = read(fileDescriptor, buffer, chunkLength);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      // The file has been truncated since the header was written, the remainder must still be written to keep the archive valid.
+      memset(buffer, 0, chunkLength);
+      result = (ssize_t) chunkLength;
+    }
+    if (![self writeBytes:buffer length:(size_t) result flush:Z_NO_FLUSH error:error]) {
+      return NO;
+    }
+    remaining -= (uint64_t) result;
+    self.bytesRead += (uint64_t) result;
+  }
+  return [self padEntryOfSize:size error:error];
+}
+
+- (BOOL)finishWithError:(NSError **)error
+{
+  uint8_t endOfArchive[TarBlockSize * 2];
+  memset(endOfArchive, 0, sizeof(endOfArchive));
+  if (![self writeBytes:endOfArchive length:sizeof(endOfArchive) flush:Z_FINISH error:error]) {
+    return NO;
+  }
+  [self.consumer consumeEndOfFile];
+  return YES;
+}
+
+#pragma mark Private
+
+- (BOOL)appendHeaderWithPath:(NSString *)path type:(char)type size:(uint64_t)size mode:(mode_t)mode mtime:(time_t)mtime linkPath:(nullable NSString *)linkPath error:(NSError **)error
+{
+  const char *name = path.UTF8String;
+  const char *link = linkPath.UTF8String ?: "";
+  size_t nameLength = strlen(name);
+  size_t linkLength = strlen(link);
+
+  // Values that don't fit in the ustar header are placed in a preceding pax extended header.
+  NSMutableData *records = [NSMutableData data];
+  if (nameLength >= TarNameLength) {
+    AppendPaxRecord(records, @"path", path);
+  }
+  if (linkLength >= TarNameLength) {
+    AppendPaxRecord(records, @"linkpath", linkPath);
+  }
+  if (size > TarMaximumOctalSize) {
+    AppendPaxRecord(records, @"size", [NSString stringWithFormat:@"%llu", size]);
+  }
+  if (records.length > 0) {
+    if (![self appendHeaderWithPath:@"././@PaxHeader" type:'x' size:records.length mode:0644 mtime:mtime linkPath:nil error:error]) {
+      return NO;
+    }
+    if (![self writeBytes:records.bytes length:records.length flush:Z_NO_FLUSH error:error]) {
+      return NO;
+    }
+    if (![self padEntryOfSize:records.length error:error]) {
+      return NO;
+    }
+  }
+
+  char header[TarBlockSize];
+  memset(header, 0, sizeof(header));
+  memcpy(header, name, MIN(nameLength, TarNameLength - 1));
+  snprintf(header + 100, 8, "%07o", (unsigned int) (mode & 07777));
+  snprintf(header + 108, 8, "%07o", 0);
+  snprintf(header + 116, 8, "%07o", 0);
+  snprintf(header + 124, 12, "%011llo", size > TarMaximumOctalSize ? 0 : size);
+  snprintf(header + 136, 12, "%011llo", (unsigned long long) MAX(mtime, 0));
+  memset(header + 148, ' ', 8);
+  header[156] = type;
+  memcpy(header + 157, link, MIN(linkLength, TarNameLength - 1));
+  memcpy(header + 257, "ustar", 6);
+  memcpy(header + 263, "00", 2);
+
+  unsigned int checksum = 0;
+  for (size_t index = 0; index < TarBlockSize; index++) {
+    checksum += (uint8_t) header[index];
+  }
+  snprintf(header + 148, 7, "%06o", checksum);
+  header[155] = ' ';
+
+  return [self writeBytes:header length:sizeof(header) flush:Z_NO_FLUSH error:error];
+}
+
+- (BOOL)padEntryOfSize:(uint64_t)size error:(NSError **)error
+{
+  size_t padding = (size_t) ((TarBlockSize - size % TarBlockSize) % TarBlockSize);
+  if (padding == 0) {
+    return YES;
+  }
+  uint8_t zeros[TarBlockSize];
+  memset(zeros, 0, sizeof(zeros));
+  return [self writeBytes:zeros length:padding flush:Z_NO_FLUSH error:error];
+}
+
+- (BOOL)writeBytes:(const void *)bytes length:(size_t)length flush:(int)flush error:(NSError **)error
+{
+  z_stream *stream = self.stream;
+  uint8_t *buffer = self.outputBuffer.mutableBytes;
+  stream->next_in = (Bytef *) bytes;
+  stream->avail_in = (uInt) length;
+  int status = Z_OK;
+  do {
+    stream->next_out = buffer + self.outputLength;
+    stream->avail_out = (uInt) (DeflateBufferSize - self.outputLength);
+    status = deflate(stream, flush);
+    if (status == Z_STREAM_ERROR) {
+      return [[FBControlCoreError
+        describeFormat:@"Failed to compress archive, zlib status %d", status]
+        failBool:error];
+    }
+    self.outputLength = DeflateBufferSize - stream->avail_out;
+    if (self.outputLength == DeflateBufferSize) {
+      [self emitOutput];
+    }
+  } while (stream->avail_in > 0 || (flush == Z_FINISH && status != Z_STREAM_END));
+  if (flush == Z_FINISH) {
+    [self emitOutput];
+  }
+  return YES;
+}
+
+- (void)emitOutput
+{
+  if (self.outputLength == 0) {
+    return;
+  }
+  [self.consumer consumeData:[NSData dataWithBytes:self.outputBuffer.bytes length:self.outputLength]];
+  self.bytesCompressed += self.outputLength;
+  self.outputLength = 0;
+  WaitForConsumerToDrain(self.consumer);
+}
+
+@end
+
+@interface FBDiagnosticArchiver ()
+
+@property (nonatomic, strong, readonly) id<FBDataConsumer> consumer;
+@property (nonatomic, assign, readonly) NSUInteger maximumConcurrency;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) FBDiagnosticArchiver_TarWriter *writer;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSDictionary<NSString *, id> *> *completed;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSString *> *archivePathsByFileIdentity;
+@property (nonatomic, strong, readonly) NSMutableSet<NSString *> *archivePaths;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *targetManifests;
+@property (nonatomic, copy, nullable, readwrite) NSDictionary<NSString *, FBDiagnosticArchiverProducer> *producers;
+@property (nonatomic, strong, nullable, readwrite) NSMutableArray<NSString *> *pendingNames;
+@property (nonatomic, assign, readwrite) NSUInteger runningCount;
+@property (nonatomic, assign, readwrite) NSUInteger filesWritten;
+@property (nonatomic, assign, readwrite) NSUInteger filesLinked;
+@property (nonatomic, strong, nullable, readwrite) NSError *writeError;
+
+@end
+
+@implementation FBDiagnosticArchiver
+
+#pragma mark Initializers
+
++ (instancetype)archiverWithConsumer:(id<FBDataConsumer>)consumer maximumConcurrency:(NSUInteger)maximumConcurrency logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithConsumer:consumer maximumConcurrency:MAX(maximumConcurrency, 1u) logger:logger];
+}
+
+- (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer maximumConcurrency:(NSUInteger)maximumConcurrency logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _consumer = consumer;
+  _maximumConcurrency = maximumConcurrency;
+  _logger = logger;
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.diagnostic_archiver", DISPATCH_QUEUE_SERIAL);
+  _writer = [[FBDiagnosticArchiver_TarWriter alloc] initWithConsumer:consumer];
+  _completed = FBMutableFuture.future;
+  _archivePathsByFileIdentity = [NSMutableDictionary dictionary];
+  _archivePaths = [NSMutableSet set];
+  _targetManifests = [NSMutableDictionary dictionary];
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<NSDictionary<NSString *, id> *> *)archiveQuery:(FBDiagnosticQuery *)query ofTargets:(NSArray<id<FBiOSTarget>> *)targets
+{
+  NSMutableDictionary<NSString *, FBDiagnosticArchiverProducer> *producers = [NSMutableDictionary dictionary];
+  for (id<FBiOSTarget> target in targets) {
+    producers[target.udid] = ^{
+      return [FBFuture onQueue:target.asyncQueue resolve:^{
+        return [query run:target];
+      }];
+    };
+  }
+  return [self archiveProducers:producers];
+}
+
+- (FBFuture<NSDictionary<NSString *, id> *> *)archiveProducers:(NSDictionary<NSString *, FBDiagnosticArchiverProducer> *)producers
+{
+  return [FBFuture onQueue:self.queue resolve:^{
+    if (self.producers) {
+      return [[FBControlCoreError
+        describe:@"A Diagnostic Archiver can only write a single archive"]
+        failFuture];
+    }
+    self.producers = producers;
+    self.pendingNames = [[producers.allKeys sortedArrayUsingSelector:@selector(compare:)] mutableCopy];
+    [self.logger logFormat:@"Archiving diagnostics of %lu targets, %lu at a time", (unsigned long) producers.count, (unsigned long) self.maximumConcurrency];
+    [self scheduleProducers];
+    return (FBFuture *) self.completed;
+  }];
+}
+
+#pragma mark Private
+
+- (void)scheduleProducers
+{
+  while (self.runningCount < self.maximumConcurrency && self.pendingNames.count > 0) {
+    NSString *name = self.pendingNames.firstObject;
+    [self.pendingNames removeObjectAtIndex:0];
+    self.runningCount += 1;
+    FBDiagnosticArchiverProducer producer = self.producers[name];
+    // The slot is only released once the diagnostics have been written, so that no more than 'maximumConcurrency' results are pending at once.
+    [producer() onQueue:self.queue notifyOfCompletion:^(FBFuture<NSArray<FBDiagnostic *> *> *future) {
+      [self appendDiagnosticsFromFuture:future name:name];
+      self.runningCount -= 1;
+      [self scheduleProducers];
+    }];
+  }
+  if (self.runningCount == 0 && self.pendingNames.count == 0 && !self.completed.hasCompleted) {
+    [self finish];
+  }
+}
+
+- (void)appendDiagnosticsFromFuture:(FBFuture<NSArray<FBDiagnostic *> *> *)future name:(NSString *)name
+{
+  NSString *directory = [name stringByReplacingOccurrencesOfString:@"/" withString:@"_"];
+  NSMutableArray<NSString *> *files = [NSMutableArray array];
+  NSMutableDictionary<NSString *, NSString *> *links = [NSMutableDictionary dictionary];
+  NSMutableArray<NSString *> *errors = [NSMutableArray array];
+
+  if (future.state != FBFutureStateDone) {
+    [errors addObject:future.error.localizedDescription ?: @"Collection was cancelled"];
+  }
+  for (FBDiagnostic *diagnostic in future.result ?: @[]) {
+    if (self.writeError) {
+      break;
+    }
+    if (!diagnostic.hasLogContent) {
+      continue;
+    }
+    NSString *path = diagnostic.asPath;
+    if (!path) {
+      continue;
+    }
+    NSString *archivePath = [self uniqueArchivePath:[directory stringByAppendingPathComponent:path.lastPathComponent]];
+    NSError *error = nil;
+    if (![self appendItemAtPath:path archivePath:archivePath followLinks:YES files:files links:links error:&error]) {
+      [self.logger logFormat:@"Failed to archive %@ of %@: %@", path, name, error];
+      [errors addObject:error.localizedDescription];
+    }
+  }
+
+  NSMutableDictionary<NSString *, id> *manifest = [NSMutableDictionary dictionary];
+  manifest[KeyFiles] = [files copy];
+  manifest[KeyLinks] = [links copy];
+  if (errors.count > 0) {
+    manifest[KeyErrors] = [errors copy];
+  }
+  self.targetManifests[name] = [manifest copy];
+}
+
+- (BOOL)appendItemAtPath:(NSString *)path archivePath:(NSString *)archivePath followLinks:(BOOL)followLinks files:(NSMutableArray<NSString *> *)files links:(NSMutableDictionary<NSString *, NSString *> *)links error:(NSError **)error
+{
+  struct stat info;
+  int result = followLinks ? stat(path.fileSystemRepresentation, &info) : lstat(path.fileSystemRepresentation, &info);
+  if (result != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to stat %@: %s", path, strerror(errno)]
+      failBool:error];
+  }
+  [self.archivePaths addObject:archivePath];
+
+  if (S_ISDIR(info.st_mode)) {
+    if (![self.writer appendDirectory:archivePath mode:info.st_mode mtime:info.st_mtime error:error]) {
+      return [self failWrite:error];
+    }
+    NSArray<NSString *> *children = [[NSFileManager.defaultManager contentsOfDirectoryAtPath:path error:error] sortedArrayUsingSelector:@selector(compare:)];
+    if (!children) {
+      return NO;
+    }
+    for (NSString *child in children) {
+      if (![self appendItemAtPath:[path stringByAppendingPathComponent:child] archivePath:[archivePath stringByAppendingPathComponent:child] followLinks:NO files:files links:links error:error]) {
+        return NO;
+      }
+    }
+    return YES;
+  }
+  if (S_ISLNK(info.st_mode)) {
+    NSString *destination = [NSFileManager.defaultManager destinationOfSymbolicLinkAtPath:path error:error];
+    if (!destination) {
+      return NO;
+    }
+    if (![self.writer appendSymbolicLink:archivePath destination:destination mtime:info.st_mtime error:error]) {
+      return [self failWrite:error];
+    }
+    [files addObject:archivePath];
+    return YES;
+  }
+  if (!S_ISREG(info.st_mode)) {
+    return YES;
+  }
+
+  // Files are identified by device and inode, so that the same file reached from different paths is also only stored once.
+  NSString *identity = [NSString stringWithFormat:@"%llu:%llu", (unsigned long long) info.st_dev, (unsigned long long) info.st_ino];
+  NSString *existing = self.archivePathsByFileIdentity[identity];
+  if (existing) {
+    if (![self.writer appendHardLink:archivePath toArchivePath:existing mode:info.st_mode mtime:info.st_mtime error:error]) {
+      return [self failWrite:error];
+    }
+    links[archivePath] = existing;
+    self.filesLinked += 1;
+    return YES;
+  }
+
+  int fileDescriptor = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor == -1) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to open %@: %s", path, strerror(errno)]
+      failBool:error];
+  }
+  // The size is taken from the open file, so that it is consistent with what will be read.
+  fstat(fileDescriptor, &info);
+  BOOL success = [self.writer appendFileDescriptor:fileDescriptor archivePath:archivePath size:(uint64_t) info.st_size mode:info.st_mode mtime:info.st_mtime error:error];
+  close(fileDescriptor);
+  if (!success) {
+    return [self failWrite:error];
+  }
+  self.archivePathsByFileIdentity[identity] = archivePath;
+  self.filesWritten += 1;
+  [files addObject:archivePath];
+  return YES;
+}
+
+- (BOOL)failWrite:(NSError **)error
+{
+  // A failure of the writer leaves the archive in an unknown state, so nothing else should be written.
+  self.writeError = error ? *error : [[FBControlCoreError describe:@"Failed to write archive"] build];
+  return NO;
+}
+
+- (NSString *)uniqueArchivePath:(NSString *)archivePath
+{
+  NSString *candidate = archivePath;
+  NSString *extension = archivePath.pathExtension;
+  NSString *base = archivePath.stringByDeletingPathExtension;
+  for (NSUInteger index = 1; [self.archivePaths containsObject:candidate]; index++) {
+    candidate = [NSString stringWithFormat:@"%@-%lu", base, (unsigned long) index];
+    if (extension.length > 0) {
+      candidate = [candidate stringByAppendingPathExtension:extension];
+    }
+  }
+  return candidate;
+}
+
+- (void)finish
+{
+  NSDictionary<NSString *, id> *manifest = @{
+    KeyTargets: [self.targetManifests copy],
+    KeyFilesWritten: @(self.filesWritten),
+    KeyFilesLinked: @(self.filesLinked),
+    KeyBytesRead: @(self.writer.bytesRead),
+  };
+  NSError *error = self.writeError;
+  if (!error) {
+    NSData *data = [NSJSONSerialization dataWithJSONObject:manifest options:NSJSONWritingPrettyPrinted error:&error];
+    if (data && [self.writer appendData:data archivePath:FBDiagnosticArchiverManifestName error:&error] && [self.writer finishWithError:&error]) {
+      NSMutableDictionary<NSString *, id> *completedManifest = [manifest mutableCopy];
+      completedManifest[KeyBytesCompressed] = @(self.writer.bytesCompressed);
+      [self.logger logFormat:@"Archived %lu files, with %lu shared files linked, compressing %llu bytes to %llu bytes", (unsigned long) self.filesWritten, (unsigned long) self.filesLinked, self.writer.bytesRead, self.writer.bytesCompressed];
+      [self.completed resolveWithResult:[completedManifest copy]];
+      return;
+    }
+  }
+  [self.consumer consumeEndOfFile];
+  [self.completed resolveWithError:error];
+}
+
+@end
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Reads the lines that have been appended to log files since the previous read.
+
+ A Reader represents a single consumer, remembering the offset that it has read up to in each file.
+ Only complete lines are returned, a partially written last line is returned once it has been terminated.
+ If a file has been replaced (the device or inode has changed), or truncated, it is read again from the start.
+ Lines written to a file after the last read, but before it was replaced, are not returned.
+
+ Offsets can be persisted to a file, so that they are retained across processes.
+ Each consumer should have its own state file.
+ */
+@interface FBIncrementalLogReader : NSObject
+
+#pragma mark Initializers
+
+/**
+ Constructs a Reader.
+
+ @param statePath the path to load and persist offsets to. If nil, offsets are only retained in memory.
+ @return a new Reader.
+ */
++ (instancetype)readerWithStatePath:(nullable NSString *)statePath;
+
+#pragma mark Public Methods
+
+/**
+ Reads the complete lines appended to a file since the last read.
+ The first read of a file starts from the beginning.
+
+ @param path the path of the file to read.
+ @param error an error out for any error that occurs.
+ @return the data of the lines, including the final newline, nil on error.
+ */
+- (nullable NSData *)readAppendedDataAtPath:(NSString *)path error:(NSError **)error;
+
+/**
+ Reads the complete lines appended to a file since the last read.
+ The first read of a file starts from the beginning.
+
+ @param path the path of the file to read.
+ @param error an error out for any error that occurs.
+ @return the lines, without newlines, nil on error.
+ */
+- (nullable NSArray<NSString *> *)readAppendedLinesAtPath:(NSString *)path error:(NSError **)error;
+
+/**
+ Forgets the offset of a file, so that the next read will start from the beginning.
+
+ @param path the path of the file.
+ */
+- (void)resetPath:(NSString *)path;
+
+#pragma mark Properties
+
+/**
+ The total number of bytes read by the reciever.
+ */
+@property (atomic, assign, readonly) uint64_t bytesRead;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,184 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBIncrementalLogReader.h"
+
+#import <sys/stat.h>
+
+#import "FBControlCoreError.h"
+#import "FBDelimiterScanner.h"
+
+static NSString *const KeyDevice = @"device";
+static NSString *const KeyInode = @"inode";
+static NSString *const KeyOffset = @"offset";
+
+@interface FBIncrementalLogReader ()
+
+@property (nonatomic, copy, nullable, readonly) NSString *statePath;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *offsets;
+@property (atomic, assign, readwrite) uint64_t bytesRead;
+
+@end
+
+@implementation FBIncrementalLogReader
+
+#pragma mark Initializers
+
++ (instancetype)readerWithStatePath:(nullable NSString *)statePath
+{
+  return [[self alloc] initWithStatePath:statePath offsets:[self offsetsFromStatePath:statePath]];
+}
+
+- (instancetype)initWithStatePath:(nullable NSString *)statePath offsets:(NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)offsets
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _statePath = statePath;
+  _offsets = offsets;
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (nullable NSData *)readAppendedDataAtPath:(NSString *)path error:(NSError **)error
+{
+  NSString *key = path.stringByStandardizingPath;
+  @synchronized (self) {
+    int fileDescriptor = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor == -1) {
+      return [[FBControlCoreError
+        describeFormat:@"Failed to open %@: %s", path, strerror(errno)]
+        fail:error];
+    }
+    // The identity and size are taken from the open file, so that they describe the file that is read from.
+    struct stat info;
+    if (fstat(fileDescriptor, &info) != 0) {
+      close(fileDescriptor);
+      return [[FBControlCoreError
+        describeFormat:@"Failed to stat %@: %s", path, strerror(errno)]
+        fail:error];
+    }
+    uint64_t offset = [self offsetForKey:key info:&info];
+    uint64_t size = (uint64_t) info.st_size;
+
+    NSMutableData *data = [NSMutableData dataWithLength:(NSUInteger) (size - offset)];
+    size_t length = 0;
+    while (length < data.length) {
+      ssize_t result = pread(fileDescriptor, (uint8_t *) data.mutableBytes + length, data.length - length, (off_t) (offset + length));
+      if (result < 0 && errno == EINTR) {
+        continue;
+      }
+      if (result <= 0) {
+        break;
+      }
+      length += (size_t) result;
+    }
+    close(fileDescriptor);
+    self.bytesRead += length;
+
+    // Only consume up to the last newline, the remainder of a line is read again once it has been completed.
+    const char *bytes = data.bytes;
+    while (length > 0 && bytes[length - 1] != '\n') {
+      length--;
+    }
+    data.length = length;
+    [self storeOffset:offset + length forKey:key info:&info];
+    return data;
+  }
+}
+
+- (nullable NSArray<NSString *> *)readAppendedLinesAtPath:(NSString *)path error:(NSError **)error
+{
+  NSData *data = [self readAppendedDataAtPath:path error:error];
+  if (!data) {
+    return nil;
+  }
+  // The data ends with a newline, so the empty final line is dropped.
+  NSArray<NSString *> *lines = [FBDelimiterScanner linesOfData:data];
+  return [lines subarrayWithRange:NSMakeRange(0, lines.count - 1)];
+}
+
+- (void)resetPath:(NSString *)path
+{
+  @synchronized (self) {
+    [self.offsets removeObjectForKey:path.stringByStandardizingPath];
+    [self persist];
+  }
+}
+
+#pragma mark Private
+
+- (uint64_t)offsetForKey:(NSString *)key info:(struct stat *)info
+{
+  NSDictionary<NSString *, NSNumber *> *entry = self.offsets[key];
+  if (!entry) {
+    return 0;
+  }
+  // A different file at the same path has replaced the previous one, as happens when a log is rotated.
+  if (entry[KeyDevice].unsignedLongLongValue != (unsigned long long) info->st_dev || entry[KeyInode].unsignedLongLongValue != (unsigned long long) info->st_ino) {
+    return 0;
+  }
+  // The file has been truncated.
+  uint64_t offset = entry[KeyOffset].unsignedLongLongValue;
+  if (offset > (uint64_t) info->st_size) {
+    return 0;
+  }
+  return offset;
+}
+
+- (void)storeOffset:(uint64_t)offset forKey:(NSString *)key info:(struct stat *)info
+{
+  NSDictionary<NSString *, NSNumber *> *entry = @{
+    KeyDevice: @((unsigned long long) info->st_dev),
+    KeyInode: @((unsigned long long) info->st_ino),
+    KeyOffset: @(offset),
+  };
+  if ([self.offsets[key] isEqualToDictionary:entry]) {
+    return;
+  }
+  self.offsets[key] = entry;
+  [self persist];
+}
+
+- (void)persist
+{
+  if (!self.statePath) {
+    return;
+  }
+  NSData *data = [NSJSONSerialization dataWithJSONObject:self.offsets options:0 error:nil];
+  [data writeToFile:self.statePath options:NSDataWritingAtomic error:nil];
+}
+
++ (NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)offsetsFromStatePath:(nullable NSString *)statePath
+{
+  NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *offsets = [NSMutableDictionary dictionary];
+  NSData *data = statePath ? [NSData dataWithContentsOfFile:statePath] : nil;
+  NSDictionary<NSString *, id> *json = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+  if (![json isKindOfClass:NSDictionary.class]) {
+    return offsets;
+  }
+  // Entries that are malformed are discarded, so the file will be read from the start.
+  for (NSString *key in json) {
+    NSDictionary<NSString *, NSNumber *> *entry = json[key];
+    if (![key isKindOfClass:NSString.class] || ![entry isKindOfClass:NSDictionary.class]) {
+      continue;
+    }
+    if (![entry[KeyDevice] isKindOfClass:NSNumber.class] || ![entry[KeyInode] isKindOfClass:NSNumber.class] || ![entry[KeyOffset] isKindOfClass:NSNumber.class]) {
+      continue;
+    }
+    offsets[key] = entry;
+  }
+  return offsets;
+}
+
+@end
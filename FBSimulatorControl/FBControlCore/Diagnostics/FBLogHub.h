@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBDataConsumer.h>
+#import <FBControlCore/FBiOSTargetFuture.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBLogSearchPredicate;
+
+@protocol FBControlCoreLogger;
+
+/**
+ A Subscriber to a FBLogHub.
+ Cancelling the 'completed' Future will unsubscribe.
+ */
+@interface FBLogHubSubscription : NSObject <FBiOSTargetContinuation>
+
+/**
+ The number of matching lines that were dropped because the consumer could not keep up.
+ This is always zero for subscriptions with an unbounded queue.
+ */
+@property (atomic, assign, readonly) NSUInteger linesDropped;
+
+@end
+
+/**
+ Splits the output of a single log stream into lines, delivering them to many subscribers.
+ Each subscriber has its own predicate, and a queue of lines waiting to be consumed, so that a slow subscriber does not slow down others.
+ Subscribers that bound their queue have lines dropped whilst it is full, other subscribers receive every line.
+ A window of recent lines is retained, so that subscribers that attach late can have them replayed.
+ */
+@interface FBLogHub : NSObject <FBDataConsumer, FBDataConsumerLifecycle>
+
+#pragma mark Initializers
+
+/**
+ Constructs a Log Hub.
+
+ @param replayCapacity the number of recent lines to retain for replay.
+ @param logger the logger to log to.
+ @return a new Log Hub.
+ */
++ (instancetype)hubWithReplayCapacity:(NSUInteger)replayCapacity logger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Properties
+
+/**
+ The number of active subscriptions.
+ */
+@property (atomic, assign, readonly) NSUInteger subscriberCount;
+
+#pragma mark Public Methods
+
+/**
+ Subscribes to the lines of the log.
+ Each line is passed to the consumer with a trailing newline.
+ The consumer recieves an end-of-file when the log ends, or when the subscription is cancelled.
+
+ @param predicate the predicate to filter lines with. If nil all lines are consumed.
+ @param consumer the consumer of lines.
+ @param queueCapacity the maximum number of lines waiting to be consumed. Further lines are dropped until the consumer catches up. 0 for an unbounded queue, where no lines are dropped.
+ @param replay YES if recent lines should be consumed before new lines, NO otherwise.
+ @return a new Subscription.
+ */
+- (FBLogHubSubscription *)subscribeWithPredicate:(nullable FBLogSearchPredicate *)predicate consumer:(id<FBDataConsumer>)consumer queueCapacity:(NSUInteger)queueCapacity replay:(BOOL)replay;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,261 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBLogHub.h"
+
+#import "FBControlCoreLogger.h"
+#import "FBLogSearch.h"
+#import "FBLogTailConfiguration.h"
+
+@interface FBLogHubSubscription ()
+
+@property (nonatomic, copy, nullable, readonly) FBLogSearchPredicate *predicate;
+@property (nonatomic, strong, readonly) id<FBDataConsumer> consumer;
+@property (nonatomic, assign, readonly) NSUInteger queueCapacity;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *mutableCompleted;
+
+@property (atomic, assign, readwrite) NSUInteger linesDropped;
+@property (nonatomic, assign, readwrite) NSUInteger pending;
+@property (nonatomic, assign, readwrite) BOOL finished;
+
+@end
+
+@implementation FBLogHubSubscription
+
+@synthesize futureType = _futureType;
+
+- (instancetype)initWithPredicate:(nullable FBLogSearchPredicate *)predicate consumer:(id<FBDataConsumer>)consumer queueCapacity:(NSUInteger)queueCapacity
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _predicate = [predicate copy];
+  _consumer = consumer;
+  _queueCapacity = queueCapacity;
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.log_hub.subscription", DISPATCH_QUEUE_SERIAL);
+  _mutableCompleted = FBMutableFuture.future;
+  _futureType = FBiOSTargetFutureTypeLogTail;
+
+  return self;
+}
+
+- (FBFuture<NSNull *> *)completed
+{
+  return self.mutableCompleted;
+}
+
+- (BOOL)matchesLine:(NSData *)line string:(NSString **)string
+{
+  if (!self.predicate) {
+    return YES;
+  }
+  // The string is shared between subscribers, so that it is only decoded once per line.
+  if (!*string) {
+    *string = [[NSString alloc] initWithData:line encoding:NSUTF8StringEncoding] ?: @"";
+  }
+  return [self.predicate match:*string] != nil;
+}
+
+- (BOOL)enqueueLine:(NSData *)line
+{
+  @synchronized (self) {
+    if (self.finished) {
+      return YES;
+    }
+    if (self.queueCapacity > 0 && self.pending >= self.queueCapacity) {
+      self.linesDropped++;
+      return NO;
+    }
+    self.pending++;
+  }
+  dispatch_async(self.queue, ^{
+    [self.consumer consumeData:line];
+    @synchronized (self) {
+      self.pending--;
+    }
+  });
+  return YES;
+}
+
+- (void)finish
+{
+  @synchronized (self) {
+    if (self.finished) {
+      return;
+    }
+    self.finished = YES;
+  }
+  // Lines that have been enqueued are consumed before the end-of-file.
+  dispatch_async(self.queue, ^{
+    [self.consumer consumeEndOfFile];
+    [self.mutableCompleted resolveWithResult:NSNull.null];
+  });
+}
+
+@end
+
+@interface FBLogHub ()
+
+@property (nonatomic, assign, readonly) NSUInteger replayCapacity;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) NSMutableData *partialLine;
+@property (nonatomic, strong, readonly) NSMutableArray<NSData *> *recentLines;
+@property (nonatomic, strong, readonly) NSMutableArray<FBLogHubSubscription *> *subscriptions;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *eofHasBeenReceived;
+@property (nonatomic, assign, readwrite) BOOL ended;
+
+@end
+
+@implementation FBLogHub
+
+#pragma mark Initializers
+
++ (instancetype)hubWithReplayCapacity:(NSUInteger)replayCapacity logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithReplayCapacity:replayCapacity logger:logger];
+}
+
+- (instancetype)initWithReplayCapacity:(NSUInteger)replayCapacity logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _replayCapacity = replayCapacity;
+  _logger = logger;
+  _partialLine = [NSMutableData data];
+  _recentLines = [NSMutableArray array];
+  _subscriptions = [NSMutableArray array];
+  _eofHasBeenReceived = FBMutableFuture.future;
+
+  return self;
+}
+
+#pragma mark Properties
+
+- (NSUInteger)subscriberCount
+{
+  @synchronized (self) {
+    return self.subscriptions.count;
+  }
+}
+
+#pragma mark Public Methods
+
+- (FBLogHubSubscription *)subscribeWithPredicate:(nullable FBLogSearchPredicate *)predicate consumer:(id<FBDataConsumer>)consumer queueCapacity:(NSUInteger)queueCapacity replay:(BOOL)replay
+{
+  FBLogHubSubscription *subscription = [[FBLogHubSubscription alloc] initWithPredicate:predicate consumer:consumer queueCapacity:queueCapacity];
+  __weak typeof(self) weakSelf = self;
+  [subscription.mutableCompleted onQueue:subscription.queue respondToCancellation:^{
+    [weakSelf removeSubscription:subscription];
+    [subscription finish];
+    return [FBFuture futureWithResult:NSNull.null];
+  }];
+
+  @synchronized (self) {
+    // Replaying whilst holding the lock means that no lines are missed or repeated between the replay and new lines.
+    if (replay) {
+      for (NSData *line in self.recentLines) {
+        NSString *string = nil;
+        if ([subscription matchesLine:line string:&string]) {
+          [subscription enqueueLine:line];
+        }
+      }
+    }
+    if (self.ended) {
+      [subscription finish];
+      return subscription;
+    }
+    [self.subscriptions addObject:subscription];
+  }
+  [self.logger.debug logFormat:@"Added log subscriber, %lu subscribers", (unsigned long) self.subscriberCount];
+  return subscription;
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  @synchronized (self) {
+    if (self.ended) {
+      return;
+    }
+    [self.partialLine appendData:data];
+    const uint8_t *bytes = self.partialLine.bytes;
+    NSUInteger length = self.partialLine.length;
+    NSUInteger start = 0;
+    while (start < length) {
+      const uint8_t *newline = memchr(bytes + start, '\n', length - start);
+      if (!newline) {
+        break;
+      }
+      NSUInteger end = (NSUInteger) (newline - bytes) + 1;
+      [self publishLine:[NSData dataWithBytes:bytes + start length:end - start]];
+      start = end;
+    }
+    if (start > 0) {
+      [self.partialLine replaceBytesInRange:NSMakeRange(0, start) withBytes:NULL length:0];
+    }
+  }
+}
+
+- (void)consumeEndOfFile
+{
+  NSArray<FBLogHubSubscription *> *subscriptions = nil;
+  @synchronized (self) {
+    if (self.ended) {
+      return;
+    }
+    if (self.partialLine.length > 0) {
+      [self.partialLine appendBytes:"\n" length:1];
+      [self publishLine:[self.partialLine copy]];
+      self.partialLine.length = 0;
+    }
+    self.ended = YES;
+    subscriptions = [self.subscriptions copy];
+    [self.subscriptions removeAllObjects];
+  }
+  for (FBLogHubSubscription *subscription in subscriptions) {
+    [subscription finish];
+  }
+  [self.eofHasBeenReceived resolveWithResult:NSNull.null];
+}
+
+#pragma mark Private
+
+- (void)publishLine:(NSData *)line
+{
+  [self.recentLines addObject:line];
+  if (self.recentLines.count > self.replayCapacity) {
+    [self.recentLines removeObjectAtIndex:0];
+  }
+  NSString *string = nil;
+  for (FBLogHubSubscription *subscription in self.subscriptions) {
+    if (![subscription matchesLine:line string:&string] || [subscription enqueueLine:line]) {
+      continue;
+    }
+    if (subscription.linesDropped == 1) {
+      [self.logger.debug log:@"Log subscriber is not keeping up, lines will be dropped"];
+    }
+  }
+}
+
+- (void)removeSubscription:(FBLogHubSubscription *)subscription
+{
+  @synchronized (self) {
+    [self.subscriptions removeObject:subscription];
+  }
+  [self.logger.debug logFormat:@"Removed log subscriber, %lu subscribers", (unsigned long) self.subscriberCount];
+}
+
+@end
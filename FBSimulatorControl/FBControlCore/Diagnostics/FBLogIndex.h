@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBFuture.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBLogSearch;
+@class FBLogSearchPredicate;
+
+/**
+ An on-disk trigram index of the lines of a log file.
+
+ The index maps each three byte sequence in the log to the lines that contain it.
+ Searches with substring predicates only read the lines that contain every trigram of a substring, instead of the whole log.
+ Regex predicates, and substrings that are shorter than three characters or are not ASCII, are searched with a full scan.
+
+ The index records the identity, size and modification date of the log that it was built from.
+ If the log no longer matches, the index is rebuilt, so indexes are best suited to logs that are no longer written to.
+ */
+@interface FBLogIndex : NSObject
+
+#pragma mark Initializers
+
+/**
+ Loads the index for a log, building and writing the index first if it does not exist or is out of date.
+
+ @param path the path of the log file.
+ @param indexPath the path of the index file.
+ @param error an error out for any error that occurs.
+ @return an index if successful, nil otherwise.
+ */
++ (nullable instancetype)indexForPath:(NSString *)path indexPath:(NSString *)indexPath error:(NSError **)error;
+
+/**
+ Loads or builds the index for a log on a queue, so that it can be built in the background ahead of the first search.
+
+ @param path the path of the log file.
+ @param indexPath the path of the index file.
+ @param queue the queue to build on.
+ @return a future wrapping the index.
+ */
++ (FBFuture<FBLogIndex *> *)onQueue:(dispatch_queue_t)queue indexForPath:(NSString *)path indexPath:(NSString *)indexPath;
+
+/**
+ The path of the index file for a log within a directory of indexes.
+
+ @param path the path of the log file.
+ @param directory the directory that indexes are stored in.
+ @return the path of the index file.
+ */
++ (NSString *)indexPathForPath:(NSString *)path inDirectory:(NSString *)directory;
+
+#pragma mark Public Methods
+
+/**
+ The lines of the log that may match the predicate.
+
+ @param predicate the predicate to search with.
+ @return the numbers of the candidate lines, or nil if the predicate cannot use the index and all lines must be searched.
+ */
+- (nullable NSIndexSet *)candidateLinesForPredicate:(FBLogSearchPredicate *)predicate;
+
+/**
+ A Log Search over the lines of the log that may match the predicate.
+
+ @param predicate the predicate to search with.
+ @return a Log Search.
+ */
+- (FBLogSearch *)searchWithPredicate:(FBLogSearchPredicate *)predicate;
+
+#pragma mark Properties
+
+/**
+ The path of the log file that is indexed.
+ */
+@property (nonatomic, copy, readonly) NSString *path;
+
+/**
+ The number of lines in the log file.
+ */
+@property (nonatomic, assign, readonly) NSUInteger lineCount;
+
+/**
+ The number of distinct trigrams in the log file.
+ */
+@property (nonatomic, assign, readonly) NSUInteger trigramCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,557 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBLogIndex.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+
+#import "FBControlCoreError.h"
+#import "FBDelimiterScanner.h"
+#import "FBLogSearch.h"
+
+static const char FBLogIndexMagic[4] = {'F', 'B', 'L', 'I'};
+static const uint32_t FBLogIndexVersion = 2;
+
+/**
+ The index file consists of the header, followed by:
+ - The byte offset of the start of each line, with the length of the log as the final offset.
+ - The trigram table, sorted by trigram.
+ - The postings of each trigram, as delta encoded varints of ascending line numbers.
+ */
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint64_t device;
+  uint64_t inode;
+  uint64_t size;
+  uint64_t modificationSeconds;
+  uint64_t modificationNanoseconds;
+  uint32_t lineCount;
+  uint32_t trigramCount;
+  uint64_t postingsLength;
+} FBLogIndexHeader;
+
+typedef struct {
+  uint32_t trigram;
+  uint32_t count;
+  uint64_t offset;
+} FBLogIndexTrigram;
+
+#pragma mark Building
+
+typedef struct {
+  uint32_t key; // The trigram + 1, 0 for an unused slot.
+  uint32_t lastLine;
+  uint32_t count;
+  uint32_t length;
+  uint32_t capacity;
+  uint8_t *postings;
+} FBLogIndexBuilderEntry;
+
+typedef struct {
+  FBLogIndexBuilderEntry *entries;
+  size_t capacity;
+  size_t count;
+} FBLogIndexBuilder;
+
+static inline uint32_t Trigram(const uint8_t *bytes)
+{
+  return ((uint32_t) bytes[0] << 16) | ((uint32_t) bytes[1] << 8) | (uint32_t) bytes[2];
+}
+
+static inline size_t BuilderSlot(uint32_t key, size_t capacity)
+{
+  return (size_t) ((key * 0x9E3779B97F4A7C15ull) >> 32) & (capacity - 1);
+}
+
+static FBLogIndexBuilderEntry *BuilderEntry(FBLogIndexBuilder *builder, uint32_t key)
+{
+  size_t slot = BuilderSlot(key, builder->capacity);
+  while (builder->entries[slot].key != 0 && builder->entries[slot].key != key) {
+    slot = (slot + 1) & (builder->capacity - 1);
+  }
+  return &builder->entries[slot];
+}
+
+static void BuilderGrow(FBLogIndexBuilder *builder)
+{
+  FBLogIndexBuilderEntry *previous = builder->entries;
+  size_t previousCapacity = builder->capacity;
+  builder->capacity = previousCapacity * 2;
+  builder->entries = calloc(builder->capacity, sizeof(FBLogIndexBuilderEntry));
+  for (size_t index = 0; index < previousCapacity; index++) {
+    if (previous[index].key == 0) {
+      continue;
+    }
+    *BuilderEntry(builder, previous[index].key) = previous[index];
+  }
+  free(previous);
+}
+
+static void BuilderAppendVarint(FBLogIndexBuilderEntry *entry, uint32_t value)
+{
+  if (entry->capacity - entry->length < 5) {
+    entry->capacity = MAX(entry->capacity * 2, 8u);
+    entry->postings = realloc(entry->postings, entry->capacity);
+  }
+  while (value >= 0x80) {
+    entry->postings[entry->length++] = (uint8_t) (value | 0x80);
+    value >>= 7;
+  }
+  entry->postings[entry->length++] = (uint8_t) value;
+}
+
+static void BuilderAdd(FBLogIndexBuilder *builder, uint32_t trigram, uint32_t line)
+{
+  uint32_t key = trigram + 1;
+  FBLogIndexBuilderEntry *entry = BuilderEntry(builder, key);
+  if (entry->key == 0) {
+    if ((builder->count + 1) * 2 > builder->capacity) {
+      BuilderGrow(builder);
+      entry = BuilderEntry(builder, key);
+    }
+    entry->key = key;
+    builder->count++;
+  } else if (entry->lastLine == line) {
+    // Each line is only posted once per trigram.
+    return;
+  }
+  BuilderAppendVarint(entry, entry->count == 0 ? line : line - entry->lastLine);
+  entry->lastLine = line;
+  entry->count++;
+}
+
+static int CompareBuilderEntries(const void *left, const void *right)
+{
+  uint32_t leftKey = (*(FBLogIndexBuilderEntry *const *) left)->key;
+  uint32_t rightKey = (*(FBLogIndexBuilderEntry *const *) right)->key;
+  return leftKey < rightKey ? -1 : (leftKey > rightKey ? 1 : 0);
+}
+
+#pragma mark Querying
+
+static const uint8_t *DecodeVarint(const uint8_t *bytes, const uint8_t *end, uint32_t *value)
+{
+  uint32_t result = 0;
+  for (uint32_t shift = 0; bytes < end && shift < 35; shift += 7) {
+    uint8_t byte = *bytes++;
+    result |= (uint32_t) (byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return bytes;
+    }
+  }
+  return NULL;
+}
+
+static int CompareTrigramCounts(const void *left, const void *right)
+{
+  uint32_t leftCount = (*(const FBLogIndexTrigram *const *) left)->count;
+  uint32_t rightCount = (*(const FBLogIndexTrigram *const *) right)->count;
+  return leftCount < rightCount ? -1 : (leftCount > rightCount ? 1 : 0);
+}
+
+@interface FBLogIndex ()
+
+@property (nonatomic, strong, readonly) NSData *data;
+
+@end
+
+@implementation FBLogIndex
+{
+  const FBLogIndexHeader *_header;
+  const uint64_t *_lineOffsets;
+  const FBLogIndexTrigram *_trigrams;
+  const uint8_t *_postings;
+}
+
+#pragma mark Initializers
+
++ (nullable instancetype)indexForPath:(NSString *)path indexPath:(NSString *)indexPath error:(NSError **)error
+{
+  struct stat info;
+  if (stat(path.fileSystemRepresentation, &info) != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to stat %@: %s", path, strerror(errno)]
+      fail:error];
+  }
+  NSData *data = [NSData dataWithContentsOfFile:indexPath options:NSDataReadingMappedIfSafe error:nil];
+  if (data && [self isValidIndex:data info:&info]) {
+    return [[self alloc] initWithPath:path data:data];
+  }
+
+  data = [self buildIndexForPath:path error:error];
+  if (!data) {
+    return nil;
+  }
+  if (![NSFileManager.defaultManager createDirectoryAtPath:indexPath.stringByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:error]) {
+    return nil;
+  }
+  if (![data writeToFile:indexPath options:NSDataWritingAtomic error:error]) {
+    return nil;
+  }
+  return [[self alloc] initWithPath:path data:data];
+}
+
++ (FBFuture<FBLogIndex *> *)onQueue:(dispatch_queue_t)queue indexForPath:(NSString *)path indexPath:(NSString *)indexPath
+{
+  return [FBFuture onQueue:queue resolveValue:^ FBLogIndex * (NSError **error) {
+    return [FBLogIndex indexForPath:path indexPath:indexPath error:error];
+  }];
+}
+
++ (NSString *)indexPathForPath:(NSString *)path inDirectory:(NSString *)directory
+{
+  const char *representation = path.stringByStandardizingPath.fileSystemRepresentation;
+  unsigned char bytes[CC_SHA256_DIGEST_LENGTH];
+  CC_SHA256(representation, (CC_LONG) strlen(representation), bytes);
+  NSMutableString *digest = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+  for (NSUInteger index = 0; index < CC_SHA256_DIGEST_LENGTH; index++) {
+    [digest appendFormat:@"%02x", bytes[index]];
+  }
+  return [directory stringByAppendingPathComponent:[digest stringByAppendingPathExtension:@"logindex"]];
+}
+
+- (instancetype)initWithPath:(NSString *)path data:(NSData *)data
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _path = path;
+  _data = data;
+  _header = data.bytes;
+  _lineOffsets = (const uint64_t *) (_header + 1);
+  _trigrams = (const FBLogIndexTrigram *) (_lineOffsets + _header->lineCount + 1);
+  _postings = (const uint8_t *) (_trigrams + _header->trigramCount);
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (nullable NSIndexSet *)candidateLinesForPredicate:(FBLogSearchPredicate *)predicate
+{
+  NSArray<NSString *> *substrings = predicate.substrings;
+  if (!substrings) {
+    return nil;
+  }
+  // A line is a candidate if it may contain any of the substrings.
+  NSMutableIndexSet *candidates = [NSMutableIndexSet indexSet];
+  for (NSString *substring in substrings) {
+    NSIndexSet *lines = [self candidateLinesForSubstring:substring];
+    if (!lines) {
+      return nil;
+    }
+    [candidates addIndexes:lines];
+  }
+  return [candidates copy];
+}
+
+- (FBLogSearch *)searchWithPredicate:(FBLogSearchPredicate *)predicate
+{
+  NSIndexSet *candidates = [self candidateLinesForPredicate:predicate];
+  NSArray<NSString *> *lines = candidates ? [self linesAtIndexes:candidates] : nil;
+  if (lines) {
+    return [FBLogSearch withLines:lines predicate:predicate];
+  }
+  NSData *data = [NSData dataWithContentsOfFile:self.path options:NSDataReadingMappedIfSafe error:nil] ?: NSData.data;
+  return [FBLogSearch withLines:[FBDelimiterScanner linesOfTextData:data] predicate:predicate];
+}
+
+#pragma mark Properties
+
+- (NSUInteger)lineCount
+{
+  return _header->lineCount;
+}
+
+- (NSUInteger)trigramCount
+{
+  return _header->trigramCount;
+}
+
+#pragma mark Private
+
++ (BOOL)isValidIndex:(NSData *)data info:(struct stat *)info
+{
+  if (data.length < sizeof(FBLogIndexHeader)) {
+    return NO;
+  }
+  const FBLogIndexHeader *header = data.bytes;
+  if (memcmp(header->magic, FBLogIndexMagic, sizeof(FBLogIndexMagic)) != 0 || header->version != FBLogIndexVersion) {
+    return NO;
+  }
+  // The log has been replaced or modified since the index was built.
+  if (header->device != (uint64_t) info->st_dev || header->inode != (uint64_t) info->st_ino || header->size != (uint64_t) info->st_size) {
+    return NO;
+  }
+  if (header->modificationSeconds != (uint64_t) info->st_mtimespec.tv_sec || header->modificationNanoseconds != (uint64_t) info->st_mtimespec.tv_nsec) {
+    return NO;
+  }
+  uint64_t expectedLength = sizeof(FBLogIndexHeader)
+    + ((uint64_t) header->lineCount + 1) * sizeof(uint64_t)
+    + (uint64_t) header->trigramCount * sizeof(FBLogIndexTrigram)
+    + header->postingsLength;
+  return expectedLength == data.length;
+}
+
++ (nullable NSData *)buildIndexForPath:(NSString *)path error:(NSError **)error
+{
+  int fileDescriptor = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor == -1) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to open %@: %s", path, strerror(errno)]
+      fail:error];
+  }
+  // The identity is taken from the open file, so that it describes the content that is indexed.
+  struct stat info;
+  if (fstat(fileDescriptor, &info) != 0) {
+    close(fileDescriptor);
+    return [[FBControlCoreError
+      describeFormat:@"Failed to stat %@: %s", path, strerror(errno)]
+      fail:error];
+  }
+  size_t length = (size_t) info.st_size;
+  const uint8_t *bytes = NULL;
+  if (length > 0) {
+    void *mapped = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapped == MAP_FAILED) {
+      close(fileDescriptor);
+      return [[FBControlCoreError
+        describeFormat:@"Failed to map %@: %s", path, strerror(errno)]
+        fail:error];
+    }
+    bytes = mapped;
+  }
+  close(fileDescriptor);
+
+  NSMutableData *lineOffsets = [NSMutableData data];
+  uint64_t offset = 0;
+  [lineOffsets appendBytes:&offset length:sizeof(offset)];
+  FBLogIndexBuilder builder = {
+    .entries = calloc(1024, sizeof(FBLogIndexBuilderEntry)),
+    .capacity = 1024,
+    .count = 0,
+  };
+  uint32_t line = 0;
+  BOOL tooManyLines = NO;
+  // A binary log has no lines, so that indexed searches agree with unindexed ones.
+  BOOL isText = FBDelimiterBytesAreText(bytes, length);
+  for (size_t index = 0; isText && index < length; index++) {
+    if (bytes[index] == '\n') {
+      if (line == UINT32_MAX - 1) {
+        tooManyLines = YES;
+        break;
+      }
+      line++;
+      offset = index + 1;
+      [lineOffsets appendBytes:&offset length:sizeof(offset)];
+      continue;
+    }
+    if (index + 2 < length && bytes[index + 1] != '\n' && bytes[index + 2] != '\n') {
+      BuilderAdd(&builder, Trigram(bytes + index), line);
+    }
+  }
+  if (bytes) {
+    munmap((void *) bytes, length);
+  }
+  if (tooManyLines) {
+    for (size_t index = 0; index < builder.capacity; index++) {
+      free(builder.entries[index].postings);
+    }
+    free(builder.entries);
+    return [[FBControlCoreError
+      describeFormat:@"%@ has too many lines to index", path]
+      fail:error];
+  }
+  // An unterminated final line ends at the end of the log.
+  if (isText && offset != (uint64_t) length) {
+    offset = length;
+    [lineOffsets appendBytes:&offset length:sizeof(offset)];
+  }
+
+  FBLogIndexBuilderEntry **entries = calloc(MAX(builder.count, 1u), sizeof(FBLogIndexBuilderEntry *));
+  size_t entryCount = 0;
+  uint64_t postingsLength = 0;
+  for (size_t index = 0; index < builder.capacity; index++) {
+    if (builder.entries[index].key == 0) {
+      continue;
+    }
+    entries[entryCount++] = &builder.entries[index];
+    postingsLength += builder.entries[index].length;
+  }
+  qsort(entries, entryCount, sizeof(FBLogIndexBuilderEntry *), CompareBuilderEntries);
+
+  FBLogIndexHeader header = {
+    .version = FBLogIndexVersion,
+    .device = (uint64_t) info.st_dev,
+    .inode = (uint64_t) info.st_ino,
+    .size = (uint64_t) info.st_size,
+    .modificationSeconds = (uint64_t) info.st_mtimespec.tv_sec,
+    .modificationNanoseconds = (uint64_t) info.st_mtimespec.tv_nsec,
+    .lineCount = (uint32_t) (lineOffsets.length / sizeof(uint64_t) - 1),
+    .trigramCount = (uint32_t) entryCount,
+    .postingsLength = postingsLength,
+  };
+  memcpy(header.magic, FBLogIndexMagic, sizeof(FBLogIndexMagic));
+
+  NSMutableData *data = [NSMutableData dataWithCapacity:sizeof(header) + lineOffsets.length + entryCount * sizeof(FBLogIndexTrigram) + postingsLength];
+  [data appendBytes:&header length:sizeof(header)];
+  [data appendData:lineOffsets];
+  uint64_t postingsOffset = 0;
+  for (size_t index = 0; index < entryCount; index++) {
+    FBLogIndexTrigram trigram = {
+      .trigram = entries[index]->key - 1,
+      .count = entries[index]->count,
+      .offset = postingsOffset,
+    };
+    [data appendBytes:&trigram length:sizeof(trigram)];
+    postingsOffset += entries[index]->length;
+  }
+  for (size_t index = 0; index < entryCount; index++) {
+    [data appendBytes:entries[index]->postings length:entries[index]->length];
+  }
+
+  free(entries);
+  for (size_t index = 0; index < builder.capacity; index++) {
+    free(builder.entries[index].postings);
+  }
+  free(builder.entries);
+  return data;
+}
+
+- (nullable const FBLogIndexTrigram *)lookupTrigram:(uint32_t)trigram
+{
+  size_t lower = 0;
+  size_t upper = _header->trigramCount;
+  while (lower < upper) {
+    size_t middle = lower + (upper - lower) / 2;
+    if (_trigrams[middle].trigram < trigram) {
+      lower = middle + 1;
+    } else {
+      upper = middle;
+    }
+  }
+  if (lower < _header->trigramCount && _trigrams[lower].trigram == trigram) {
+    return &_trigrams[lower];
+  }
+  return NULL;
+}
+
+- (nullable NSIndexSet *)candidateLinesForSubstring:(NSString *)substring
+{
+  // Substrings are matched as characters rather than bytes, so only ASCII substrings have an unambiguous byte sequence.
+  NSData *needle = [substring dataUsingEncoding:NSASCIIStringEncoding];
+  if (!needle || needle.length < 3) {
+    return nil;
+  }
+  const uint8_t *needleBytes = needle.bytes;
+  size_t trigramCount = needle.length - 2;
+  const FBLogIndexTrigram **trigrams = calloc(trigramCount, sizeof(FBLogIndexTrigram *));
+  for (size_t index = 0; index < trigramCount; index++) {
+    trigrams[index] = [self lookupTrigram:Trigram(needleBytes + index)];
+    if (!trigrams[index]) {
+      free(trigrams);
+      return [NSIndexSet indexSet];
+    }
+  }
+  // Intersect the postings from the rarest trigram upwards, so that the candidates are as few as possible from the start.
+  qsort(trigrams, trigramCount, sizeof(FBLogIndexTrigram *), CompareTrigramCounts);
+
+  const uint8_t *postingsEnd = _postings + _header->postingsLength;
+  uint32_t *candidates = calloc(MAX(trigrams[0]->count, 1u), sizeof(uint32_t));
+  size_t candidateCount = 0;
+  uint32_t line = 0;
+  const uint8_t *cursor = _postings + trigrams[0]->offset;
+  for (uint32_t index = 0; index < trigrams[0]->count && cursor; index++) {
+    uint32_t delta = 0;
+    cursor = DecodeVarint(cursor, postingsEnd, &delta);
+    line = index == 0 ? delta : line + delta;
+    candidates[candidateCount++] = line;
+  }
+  for (size_t trigramIndex = 1; trigramIndex < trigramCount && candidateCount > 0; trigramIndex++) {
+    const FBLogIndexTrigram *trigram = trigrams[trigramIndex];
+    size_t kept = 0;
+    size_t candidateIndex = 0;
+    line = 0;
+    cursor = _postings + trigram->offset;
+    for (uint32_t index = 0; index < trigram->count && cursor && candidateIndex < candidateCount; index++) {
+      uint32_t delta = 0;
+      cursor = DecodeVarint(cursor, postingsEnd, &delta);
+      line = index == 0 ? delta : line + delta;
+      while (candidateIndex < candidateCount && candidates[candidateIndex] < line) {
+        candidateIndex++;
+      }
+      if (candidateIndex < candidateCount && candidates[candidateIndex] == line) {
+        candidates[kept++] = line;
+        candidateIndex++;
+      }
+    }
+    candidateCount = kept;
+  }
+
+  NSMutableIndexSet *lines = [NSMutableIndexSet indexSet];
+  for (size_t index = 0; index < candidateCount; index++) {
+    [lines addIndex:candidates[index]];
+  }
+  free(candidates);
+  free(trigrams);
+  return [lines copy];
+}
+
+- (nullable NSArray<NSString *> *)linesAtIndexes:(NSIndexSet *)indexes
+{
+  int fileDescriptor = open(self.path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor == -1) {
+    return nil;
+  }
+  // The log has changed since the index was loaded, so the offsets of lines cannot be relied upon.
+  struct stat info;
+  if (fstat(fileDescriptor, &info) != 0 || (uint64_t) info.st_size != _header->size || (uint64_t) info.st_ino != _header->inode) {
+    close(fileDescriptor);
+    return nil;
+  }
+  NSMutableArray<NSString *> *lines = [NSMutableArray array];
+  NSMutableData *buffer = [NSMutableData data];
+  __block BOOL failed = NO;
+  [indexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+    if (index >= self->_header->lineCount) {
+      *stop = failed = YES;
+      return;
+    }
+    uint64_t start = self->_lineOffsets[index];
+    size_t length = (size_t) (self->_lineOffsets[index + 1] - start);
+    buffer.length = length;
+    size_t read = 0;
+    while (read < length) {
+      ssize_t result = pread(fileDescriptor, (uint8_t *) buffer.mutableBytes + read, length - read, (off_t) (start + read));
+      if (result < 0 && errno == EINTR) {
+        continue;
+      }
+      if (result <= 0) {
+        *stop = failed = YES;
+        return;
+      }
+      read += (size_t) result;
+    }
+    const char *bytes = buffer.bytes;
+    while (length > 0 && (bytes[length - 1] == '\n' || bytes[length - 1] == '\r')) {
+      length--;
+    }
+    [lines addObject:FBDelimiterLineFromBytes((const uint8_t *) bytes, length) ?: @""];
+  }];
+  close(fileDescriptor);
+  return failed ? nil : [lines copy];
+}
+
+@end
@@ -39,6 +39,24 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (instancetype)regex:(NSString *)regex;
 
+#pragma mark Matching
+
+/**
+ Matches a single line against the predicate.
+
+ @param line the line to match.
+ @return the matching substring of the line, nil if the line does not match.
+ */
+- (nullable NSString *)match:(NSString *)line;
+
+#pragma mark Properties
+
+/**
+ The substrings that the predicate matches, a line matches if it contains any of them.
+ nil if the predicate does not match on substrings, as is the case for regexes.
+ */
+@property (nonatomic, copy, nullable, readonly) NSArray<NSString *> *substrings;
+
 #pragma mark Helpers
 
 /**
@@ -66,6 +84,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (FBLogSearch *)withText:(NSString *)text predicate:(FBLogSearchPredicate *)predicate;
 
+/**
+ A Log search on lines that have already been split.
+
+ @param lines the lines to search through.
+ @param predicate the predicate to search with.
+ @return a Log Search.
+ */
++ (FBLogSearch *)withLines:(NSArray<NSString *> *)lines predicate:(FBLogSearchPredicate *)predicate;
+
 /**
  Returns all of the Lines that will be Searched.
  */
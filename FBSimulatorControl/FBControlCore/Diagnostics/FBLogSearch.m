@@ -12,6 +12,7 @@
 #import "FBCollectionInformation.h"
 #import "FBConcurrentCollectionOperations.h"
 #import "FBControlCoreError.h"
+#import "FBDelimiterScanner.h"
 #import "FBDiagnostic.h"
 #import "NSPredicate+FBControlCore.h"
 
@@ -100,6 +101,8 @@ static NSString *const KeyRegex = @"regex";
 
 @implementation FBLogSearchPredicate_Substrings
 
+@synthesize substrings = _substrings;
+
 - (instancetype)initWithSubstrings:(NSArray *)substrings
 {
   self = [super init];
@@ -230,6 +233,11 @@ static NSString *const KeyRegex = @"regex";
   return nil;
 }
 
+- (NSArray<NSString *> *)substrings
+{
+  return nil;
+}
+
 #pragma mark NSCopying
 
 - (instancetype)copyWithZone:(NSZone *)zone
@@ -290,7 +298,12 @@ static NSString *const KeyRegex = @"regex";
 
 + (FBLogSearch *)withText:(NSString *)text predicate:(FBLogSearchPredicate *)predicate
 {
-  NSArray<NSString *> *lines = [text componentsSeparatedByCharactersInSet:NSCharacterSet.newlineCharacterSet];
+  NSArray<NSString *> *lines = [FBDelimiterScanner linesOfData:[text dataUsingEncoding:NSUTF8StringEncoding]];
+  return [[FBLogSearch_WithStorage alloc] initWithStoredLines:lines prediate:predicate];
+}
+
++ (FBLogSearch *)withLines:(NSArray<NSString *> *)lines predicate:(FBLogSearchPredicate *)predicate
+{
   return [[FBLogSearch_WithStorage alloc] initWithStoredLines:lines prediate:predicate];
 }
 
@@ -375,9 +388,16 @@ static NSString *const KeyRegex = @"regex";
 
 - (NSArray<NSString *> *)lines
 {
-  return self.diagnostic.isSearchableAsText
-    ? [self.diagnostic.asString componentsSeparatedByCharactersInSet:NSCharacterSet.newlineCharacterSet]
-    : @[];
+  // File backed diagnostics are split from their data, rather than decoding the whole file to a string first.
+  // Data containing NUL bytes is binary, so is not searchable as text.
+  NSData *data = self.diagnostic.isBackedByFile ? self.diagnostic.asData : nil;
+  if (data) {
+    return [FBDelimiterScanner linesOfTextData:data];
+  }
+  if (!self.diagnostic.isSearchableAsText) {
+    return @[];
+  }
+  return [FBDelimiterScanner linesOfData:[self.diagnostic.asString dataUsingEncoding:NSUTF8StringEncoding]];
 }
 
 @end
@@ -16,6 +16,8 @@
 #import <FBControlCore/FBApplicationInstallConfiguration.h>
 #import <FBControlCore/FBApplicationLaunchConfiguration.h>
 #import <FBControlCore/FBArchitecture.h>
+#import <FBControlCore/FBArchiveExtractionCache.h>
+#import <FBControlCore/FBArchiveUnpacker.h>
 #import <FBControlCore/FBASLParser.h>
 #import <FBControlCore/FBBatchLogSearch.h>
 #import <FBControlCore/FBBinaryDescriptor.h>
@@ -39,19 +41,23 @@
 #import <FBControlCore/FBDataConsumer.h>
 #import <FBControlCore/FBDebugDescribeable.h>
 #import <FBControlCore/FBDebuggerCommands.h>
+#import <FBControlCore/FBDelimiterScanner.h>
 #import <FBControlCore/FBDiagnostic.h>
+#import <FBControlCore/FBDiagnosticArchiver.h>
 #import <FBControlCore/FBDiagnosticQuery.h>
 #import <FBControlCore/FBDispatchSourceNotifier.h>
 #import <FBControlCore/FBEventConstants.h>
 #import <FBControlCore/FBEventInterpreter.h>
 #import <FBControlCore/FBEventReporter.h>
 #import <FBControlCore/FBEventReporterSubject.h>
+#import <FBControlCore/FBFileCopier.h>
 #import <FBControlCore/FBFileFinder.h>
 #import <FBControlCore/FBFileManager.h>
 #import <FBControlCore/FBFileReader.h>
 #import <FBControlCore/FBFileWriter.h>
 #import <FBControlCore/FBFuture.h>
 #import <FBControlCore/FBFutureContextManager.h>
+#import <FBControlCore/FBIncrementalLogReader.h>
 #import <FBControlCore/FBInstalledApplication.h>
 #import <FBControlCore/FBiOSActionReader.h>
 #import <FBControlCore/FBiOSActionRouter.h>
@@ -70,20 +76,25 @@
 #import <FBControlCore/FBListApplicationsConfiguration.h>
 #import <FBControlCore/FBLocalizationOverride.h>
 #import <FBControlCore/FBLogCommands.h>
+#import <FBControlCore/FBLogHub.h>
+#import <FBControlCore/FBLogIndex.h>
 #import <FBControlCore/FBLogSearch.h>
 #import <FBControlCore/FBLogTailConfiguration.h>
+#import <FBControlCore/FBProcessExitWatcher.h>
 #import <FBControlCore/FBProcessFetcher+Helpers.h>
 #import <FBControlCore/FBProcessFetcher.h>
 #import <FBControlCore/FBProcessInfo.h>
 #import <FBControlCore/FBProcessLaunchConfiguration.h>
 #import <FBControlCore/FBProcessOutputConfiguration.h>
 #import <FBControlCore/FBProcessStream.h>
+#import <FBControlCore/FBProcessTable.h>
 #import <FBControlCore/FBProcessTerminationStrategy.h>
 #import <FBControlCore/FBReportingiOSActionReaderDelegate.h>
 #import <FBControlCore/FBScale.h>
 #import <FBControlCore/FBScreenshotCommands.h>
 #import <FBControlCore/FBServiceManagement.h>
 #import <FBControlCore/FBSettingsApproval.h>
+#import <FBControlCore/FBSharedMemoryFrameBuffer.h>
 #import <FBControlCore/FBSocketConnectionManager.h>
 #import <FBControlCore/FBSocketServer.h>
 #import <FBControlCore/FBSubstringUtilities.h>
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBFuture.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Notifies of the exit of arbitrary processes, without polling the process table.
+
+ All watched processes are multiplexed onto a single kqueue, with a single dispatch source for the whole watcher.
+ A Future for a process resolves as soon as the kernel delivers the exit event for it.
+ Where kqueue is unavailable, all watched processes are checked on a single shared timer instead.
+
+ Each call to wait returns a distinct Future, so cancelling one waiter does not affect any other waiter for the same process.
+ The kernel registration for a process is removed once there are no remaining waiters for it.
+ */
+@interface FBProcessExitWatcher : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Shared Watcher.
+ */
+@property (nonatomic, strong, readonly, class) FBProcessExitWatcher *sharedWatcher;
+
+/**
+ Constructs a new Watcher, independent of the Shared Watcher.
+
+ @return a new Watcher.
+ */
++ (instancetype)watcher;
+
+#pragma mark Public Methods
+
+/**
+ Waits for the exit of a process.
+ If the process does not exist at the time of the call, the Future resolves immediately.
+
+ @param processIdentifier the Process Identifier of the process to wait for.
+ @return a Future that resolves when the process has exited.
+ */
+- (FBFuture<NSNull *> *)waitForExitOfProcessIdentifier:(pid_t)processIdentifier;
+
+/**
+ The Process Identifiers that currently have at least one waiter, in ascending order.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSNumber *> *watchedProcessIdentifiers;
+
+@end
+
+NS_ASSUME_NONNULL_END
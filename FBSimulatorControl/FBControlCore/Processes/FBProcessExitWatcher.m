@@ -0,0 +1,267 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBProcessExitWatcher.h"
+
+#import <errno.h>
+#import <signal.h>
+#import <unistd.h>
+
+#if defined(__APPLE__)
+#import <sys/event.h>
+#endif
+
+static const NSTimeInterval PollingInterval = 0.1;
+static const int EventBatchSize = 32;
+
+static BOOL ProcessExists(pid_t processIdentifier)
+{
+  return kill(processIdentifier, 0) == 0 || errno != ESRCH;
+}
+
+@interface FBProcessExitWatcher ()
+
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSNumber *, NSMutableArray<FBMutableFuture<NSNull *> *> *> *waiters;
+@property (nonatomic, assign, readonly) int kqueueFileDescriptor;
+@property (nonatomic, strong, readonly) NSMutableSet<NSNumber *> *polledProcessIdentifiers;
+@property (nonatomic, strong, nullable, readonly) dispatch_source_t eventSource;
+@property (nonatomic, strong, nullable, readwrite) dispatch_source_t pollingTimer;
+
+@end
+
+@implementation FBProcessExitWatcher
+
+#pragma mark Initializers
+
++ (FBProcessExitWatcher *)sharedWatcher
+{
+  static dispatch_once_t onceToken;
+  static FBProcessExitWatcher *watcher;
+  dispatch_once(&onceToken, ^{
+    watcher = [self watcher];
+  });
+  return watcher;
+}
+
++ (instancetype)watcher
+{
+  return [[self alloc] init];
+}
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.process_exit_watcher", DISPATCH_QUEUE_SERIAL);
+  _waiters = [NSMutableDictionary dictionary];
+  _polledProcessIdentifiers = [NSMutableSet set];
+  _kqueueFileDescriptor = -1;
+
+#if defined(__APPLE__)
+  int fileDescriptor = kqueue();
+  if (fileDescriptor != -1) {
+    _kqueueFileDescriptor = fileDescriptor;
+    _eventSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t) fileDescriptor, 0, _queue);
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(_eventSource, ^{
+      [weakSelf drainEvents];
+    });
+    dispatch_source_set_cancel_handler(_eventSource, ^{
+      close(fileDescriptor);
+    });
+    dispatch_resume(_eventSource);
+  }
+#endif
+
+  return self;
+}
+
+- (void)dealloc
+{
+  if (_eventSource) {
+    dispatch_source_cancel(_eventSource);
+  }
+  if (_pollingTimer) {
+    dispatch_source_cancel(_pollingTimer);
+  }
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<NSNull *> *)waitForExitOfProcessIdentifier:(pid_t)processIdentifier
+{
+  FBMutableFuture<NSNull *> *future = [FBMutableFuture futureWithNameFormat:@"Exit of process %d", processIdentifier];
+  dispatch_async(self.queue, ^{
+    [self addWaiter:future forProcessIdentifier:processIdentifier];
+  });
+  __weak typeof(self) weakSelf = self;
+  return [future onQueue:self.queue respondToCancellation:^{
+    [weakSelf removeWaiter:future forProcessIdentifier:processIdentifier];
+    return [FBFuture futureWithResult:NSNull.null];
+  }];
+}
+
+- (NSArray<NSNumber *> *)watchedProcessIdentifiers
+{
+  __block NSArray<NSNumber *> *processIdentifiers = nil;
+  dispatch_sync(self.queue, ^{
+    processIdentifiers = [self.waiters.allKeys sortedArrayUsingSelector:@selector(compare:)];
+  });
+  return processIdentifiers;
+}
+
+#pragma mark Private
+
+- (void)addWaiter:(FBMutableFuture<NSNull *> *)future forProcessIdentifier:(pid_t)processIdentifier
+{
+  if (future.hasCompleted) {
+    return;
+  }
+  NSNumber *key = @(processIdentifier);
+  NSMutableArray<FBMutableFuture<NSNull *> *> *waiters = self.waiters[key];
+  if (waiters) {
+    [waiters addObject:future];
+    return;
+  }
+  if (![self registerProcessIdentifier:processIdentifier]) {
+    [future resolveWithResult:NSNull.null];
+    return;
+  }
+  self.waiters[key] = [NSMutableArray arrayWithObject:future];
+  [self updatePollingTimer];
+}
+
+- (void)removeWaiter:(FBMutableFuture<NSNull *> *)future forProcessIdentifier:(pid_t)processIdentifier
+{
+  NSNumber *key = @(processIdentifier);
+  NSMutableArray<FBMutableFuture<NSNull *> *> *waiters = self.waiters[key];
+  [waiters removeObjectIdenticalTo:future];
+  if (!waiters || waiters.count > 0) {
+    return;
+  }
+  [self.waiters removeObjectForKey:key];
+  [self unregisterProcessIdentifier:processIdentifier];
+  [self updatePollingTimer];
+}
+
+- (void)processIdentifierDidExit:(pid_t)processIdentifier
+{
+  NSNumber *key = @(processIdentifier);
+  NSArray<FBMutableFuture<NSNull *> *> *waiters = self.waiters[key];
+  [self.waiters removeObjectForKey:key];
+  [self.polledProcessIdentifiers removeObject:key];
+  for (FBMutableFuture<NSNull *> *waiter in waiters) {
+    [waiter resolveWithResult:NSNull.null];
+  }
+  [self updatePollingTimer];
+}
+
+#pragma mark Registration
+
+- (BOOL)registerProcessIdentifier:(pid_t)processIdentifier
+{
+#if defined(__APPLE__)
+  if (self.kqueueFileDescriptor != -1) {
+    // The registration is oneshot as a process can only exit once.
+    // A process that does not exist, or is a zombie, fails with ESRCH and has therefore already exited.
+    struct kevent change;
+    EV_SET(&change, (uintptr_t) processIdentifier, EVFILT_PROC, EV_ADD | EV_ONESHOT, NOTE_EXIT, 0, NULL);
+    if (kevent(self.kqueueFileDescriptor, &change, 1, NULL, 0, NULL) == 0) {
+      return YES;
+    }
+    if (errno == ESRCH) {
+      return NO;
+    }
+    // Any other failure falls back to polling for this process alone.
+  }
+#endif
+  if (!ProcessExists(processIdentifier)) {
+    return NO;
+  }
+  [self.polledProcessIdentifiers addObject:@(processIdentifier)];
+  return YES;
+}
+
+- (void)unregisterProcessIdentifier:(pid_t)processIdentifier
+{
+  NSNumber *key = @(processIdentifier);
+  if ([self.polledProcessIdentifiers containsObject:key]) {
+    [self.polledProcessIdentifiers removeObject:key];
+    return;
+  }
+#if defined(__APPLE__)
+  // This fails if the exit event is already pending, which is harmless as there are no waiters left to resolve.
+  struct kevent change;
+  EV_SET(&change, (uintptr_t) processIdentifier, EVFILT_PROC, EV_DELETE, NOTE_EXIT, 0, NULL);
+  kevent(self.kqueueFileDescriptor, &change, 1, NULL, 0, NULL);
+#endif
+}
+
+#pragma mark kqueue
+
+- (void)drainEvents
+{
+#if defined(__APPLE__)
+  struct kevent events[EventBatchSize];
+  struct timespec timeout = {0, 0};
+  while (YES) {
+    int count = kevent(self.kqueueFileDescriptor, NULL, 0, events, EventBatchSize, &timeout);
+    for (int index = 0; index < count; index++) {
+      struct kevent event = events[index];
+      if (event.filter != EVFILT_PROC || (event.fflags & NOTE_EXIT) == 0) {
+        continue;
+      }
+      [self processIdentifierDidExit:(pid_t) event.ident];
+    }
+    if (count < EventBatchSize) {
+      return;
+    }
+  }
+#endif
+}
+
+#pragma mark Polling
+
+- (void)updatePollingTimer
+{
+  BOOL needsTimer = self.polledProcessIdentifiers.count > 0;
+  if (!needsTimer && self.pollingTimer) {
+    dispatch_source_cancel(self.pollingTimer);
+    self.pollingTimer = nil;
+    return;
+  }
+  if (!needsTimer || self.pollingTimer) {
+    return;
+  }
+  dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.queue);
+  uint64_t interval = (uint64_t) (PollingInterval * NSEC_PER_SEC);
+  dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t) interval), interval, interval / 10);
+  __weak typeof(self) weakSelf = self;
+  dispatch_source_set_event_handler(timer, ^{
+    [weakSelf pollProcessIdentifiers];
+  });
+  dispatch_resume(timer);
+  self.pollingTimer = timer;
+}
+
+- (void)pollProcessIdentifiers
+{
+  for (NSNumber *processIdentifier in [self.polledProcessIdentifiers copy]) {
+    if (ProcessExists(processIdentifier.intValue)) {
+      continue;
+    }
+    [self processIdentifierDidExit:processIdentifier.intValue];
+  }
+}
+
+@end
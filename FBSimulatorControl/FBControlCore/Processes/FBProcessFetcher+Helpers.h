@@ -59,9 +59,10 @@ NS_ASSUME_NONNULL_BEGIN
 - (BOOL)processExists:(FBProcessInfo *)process error:(NSError **)error;
 
 /**
- Uses the reciever to wait for the termination of a process.
+ Waits for the termination of a process.
+ The exit is delivered by the Shared FBProcessExitWatcher, rather than by polling the process table.
 
- @param queue the queue to poll on.
+ @param queue the queue to check the process on.
  @param process the process to wait for.
  @return a Future that resolves when the process dies.
  */
@@ -16,6 +16,7 @@
 #import "NSRunLoop+FBControlCore.h"
 #import "FBBinaryDescriptor.h"
 #import "FBDispatchSourceNotifier.h"
+#import "FBProcessExitWatcher.h"
 
 @implementation FBProcessFetcher (Helpers)
 
@@ -64,9 +65,12 @@
 
 - (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue waitForProcessToDie:(FBProcessInfo *)process
 {
-  return [FBFuture onQueue:queue resolveWhen:^BOOL{
-    FBProcessInfo *polledProcess = [self processInfoFor:process.processIdentifier];
-    return polledProcess == nil;
+  return [FBFuture onQueue:queue resolve:^{
+    // If the Process Identifier now belongs to a different process, the original process has already died.
+    if (![self processExists:process error:nil]) {
+      return [FBFuture futureWithResult:NSNull.null];
+    }
+    return [FBProcessExitWatcher.sharedWatcher waitForExitOfProcessIdentifier:process.processIdentifier];
   }];
 }
 
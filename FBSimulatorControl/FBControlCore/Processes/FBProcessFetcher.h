@@ -10,6 +10,7 @@
 #import <Foundation/Foundation.h>
 
 @class FBProcessInfo;
+@class FBProcessTable;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -83,6 +84,25 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (pid_t)processWithOpenFileTo:(const char *)filePath;
 
+#pragma mark Process Table
+
+/**
+ Takes a snapshot of the Process Table, with a single walk of the kernel's process list.
+ Use this instead of the above queries when making many queries, for example when matching processes against a set of Simulators.
+
+ @return a new Process Table.
+ */
+- (FBProcessTable *)processTableSnapshot;
+
+/**
+ Obtains a snapshot of the Process Table that is no older than the provided age.
+ The last snapshot taken by this method is re-used if it is young enough, otherwise a new snapshot is taken.
+
+ @param maximumAge the maximum age of the snapshot in seconds. Zero will always take a new snapshot.
+ @return a Process Table.
+ */
+- (FBProcessTable *)processTableWithMaximumAge:(NSTimeInterval)maximumAge;
+
 @end
 
 NS_ASSUME_NONNULL_END
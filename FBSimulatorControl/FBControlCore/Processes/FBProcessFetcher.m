@@ -9,12 +9,15 @@
 
 #import "FBProcessFetcher.h"
 
+#include <errno.h>
 #include <libproc.h>
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/sysctl.h>
 
 #import "FBProcessInfo.h"
+#import "FBProcessTable.h"
 
 #define PID_MAX 99999
 
@@ -152,6 +155,63 @@ static BOOL ProcessNameForProcessIdentifier(pid_t processIdentifier, char *buffe
   return proc_name(processIdentifier, buffer, (uint32_t) bufferSize) > 1;
 }
 
+static BOOL AllProcInfo(struct kinfo_proc **procsOut, size_t *countOut)
+{
+  int name[4] = { CTL_KERN, KERN_PROC, KERN_PROC_ALL, 0 };
+  // The process table can grow between sizing the buffer and filling it, so allow some headroom and retry.
+  for (int attempt = 0; attempt < 3; attempt++) {
+    size_t size = 0;
+    if (sysctl(name, 4, NULL, &size, NULL, 0) == -1) {
+      return NO;
+    }
+    size += size / 8;
+    struct kinfo_proc *procs = malloc(size);
+    if (sysctl(name, 4, procs, &size, NULL, 0) == -1) {
+      free(procs);
+      if (errno == ENOMEM) {
+        continue;
+      }
+      return NO;
+    }
+    *procsOut = procs;
+    *countOut = size / sizeof(struct kinfo_proc);
+    return YES;
+  }
+  return NO;
+}
+
+static uint64_t StartTimeOfProc(const struct kinfo_proc *proc)
+{
+  return ((uint64_t) proc->kp_proc.p_starttime.tv_sec * USEC_PER_SEC) + (uint64_t) proc->kp_proc.p_starttime.tv_usec;
+}
+
+/**
+ The Process Info of a process, with the start time that identifies it.
+ */
+@interface FBProcessFetcher_CachedInfo : NSObject
+
+@property (nonatomic, assign, readonly) uint64_t startTime;
+@property (nonatomic, strong, readonly) FBProcessInfo *processInfo;
+
+@end
+
+@implementation FBProcessFetcher_CachedInfo
+
+- (instancetype)initWithStartTime:(uint64_t)startTime processInfo:(FBProcessInfo *)processInfo
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _startTime = startTime;
+  _processInfo = processInfo;
+
+  return self;
+}
+
+@end
+
 @interface FBProcessFetcher ()
 
 @property (nonatomic, assign, readonly) size_t argumentBufferSize;
@@ -160,6 +220,9 @@ static BOOL ProcessNameForProcessIdentifier(pid_t processIdentifier, char *buffe
 @property (nonatomic, assign, readonly) size_t pidBufferSize;
 @property (nonatomic, assign, readonly) pid_t *pidBuffer;
 
+@property (nonatomic, strong, nullable, readwrite) FBProcessTable *lastProcessTable;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSNumber *, FBProcessFetcher_CachedInfo *> *processInfoCache;
+
 @end
 
 @implementation FBProcessFetcher
@@ -179,6 +242,8 @@ static BOOL ProcessNameForProcessIdentifier(pid_t processIdentifier, char *buffe
   _pidBufferSize = sizeof(pid_t) * PID_MAX;
   _pidBuffer = malloc(_pidBufferSize);
 
+  _processInfoCache = [NSMutableDictionary dictionary];
+
   return self;
 }
 
@@ -299,4 +364,94 @@ static BOOL ProcessNameForProcessIdentifier(pid_t processIdentifier, char *buffe
   return proc.kp_eproc.e_ppid;
 }
 
+#pragma mark Process Table
+
+- (FBProcessTable *)processTableSnapshot
+{
+  NSMutableDictionary<NSNumber *, NSNumber *> *parents = [NSMutableDictionary dictionary];
+  NSMutableDictionary<NSNumber *, NSString *> *names = [NSMutableDictionary dictionary];
+  NSMutableDictionary<NSNumber *, NSNumber *> *startTimes = [NSMutableDictionary dictionary];
+
+  struct kinfo_proc *procs = NULL;
+  size_t count = 0;
+  if (AllProcInfo(&procs, &count)) {
+    char nameBuffer[2 * MAXCOMLEN + 1];
+    for (size_t index = 0; index < count; index++) {
+      pid_t processIdentifier = procs[index].kp_proc.p_pid;
+      NSNumber *key = @(processIdentifier);
+      parents[key] = @(procs[index].kp_eproc.e_ppid);
+      startTimes[key] = @(StartTimeOfProc(&procs[index]));
+      // p_comm is truncated to MAXCOMLEN, so only ask for the full name when it may have been truncated.
+      const char *name = procs[index].kp_proc.p_comm;
+      if (strnlen(name, MAXCOMLEN + 1) >= MAXCOMLEN && ProcessNameForProcessIdentifier(processIdentifier, nameBuffer, sizeof(nameBuffer))) {
+        name = nameBuffer;
+      }
+      names[key] = [[NSString alloc] initWithBytes:name length:strnlen(name, sizeof(nameBuffer)) encoding:NSUTF8StringEncoding];
+    }
+    free(procs);
+  }
+
+  // Processes that have exited can't be queried again, so their cached info is discarded.
+  NSMutableDictionary<NSNumber *, FBProcessFetcher_CachedInfo *> *cache = self.processInfoCache;
+  @synchronized (cache) {
+    for (NSNumber *processIdentifier in cache.allKeys) {
+      if (![startTimes[processIdentifier] isEqualToNumber:@(cache[processIdentifier].startTime)]) {
+        [cache removeObjectForKey:processIdentifier];
+      }
+    }
+  }
+
+  // Each table has its own argument buffer, so that live lookups from the table do not race with the queries of the reciever.
+  // Live lookups can come from any thread, so the buffer is locked.
+  NSMutableData *argumentBuffer = [NSMutableData dataWithLength:sizeof(char) * ARG_MAX];
+  return [FBProcessTable tableWithParents:parents names:names infoProvider:^ FBProcessInfo * (pid_t processIdentifier) {
+    NSNumber *key = @(processIdentifier);
+    NSNumber *startTime = startTimes[key];
+    if (!startTime) {
+      @synchronized (argumentBuffer) {
+        return ProcessInfoForProcessIdentifier(processIdentifier, argumentBuffer.mutableBytes, argumentBuffer.length);
+      }
+    }
+    // The arguments and environment of a process don't change, so they are shared between snapshots for as long as the process lives.
+    @synchronized (cache) {
+      FBProcessFetcher_CachedInfo *cached = cache[key];
+      if (cached && cached.startTime == startTime.unsignedLongLongValue) {
+        return cached.processInfo;
+      }
+    }
+    FBProcessInfo *processInfo = nil;
+    @synchronized (argumentBuffer) {
+      processInfo = ProcessInfoForProcessIdentifier(processIdentifier, argumentBuffer.mutableBytes, argumentBuffer.length);
+    }
+    // The Process Identifier may have been re-used since the snapshot, in which case the info describes a different process.
+    struct kinfo_proc proc;
+    if (!processInfo || !ProcInfoForProcessIdentifier(processIdentifier, &proc) || StartTimeOfProc(&proc) != startTime.unsignedLongLongValue) {
+      return nil;
+    }
+    @synchronized (cache) {
+      cache[key] = [[FBProcessFetcher_CachedInfo alloc] initWithStartTime:startTime.unsignedLongLongValue processInfo:processInfo];
+    }
+    return processInfo;
+  }];
+}
+
+- (FBProcessTable *)processTableWithMaximumAge:(NSTimeInterval)maximumAge
+{
+  // Callers on different queues share the last snapshot, so it is only read and replaced under the lock.
+  @synchronized (self) {
+    FBProcessTable *table = self.lastProcessTable;
+    if (table && maximumAge > 0 && (CFAbsoluteTimeGetCurrent() - table.timestamp) <= maximumAge) {
+      return table;
+    }
+  }
+  // Taking the snapshot walks the whole process table, so it is done outside the lock so that callers with a recent enough snapshot are not blocked.
+  FBProcessTable *table = [self processTableSnapshot];
+  @synchronized (self) {
+    if (!self.lastProcessTable || self.lastProcessTable.timestamp < table.timestamp) {
+      self.lastProcessTable = table;
+    }
+  }
+  return table;
+}
+
 @end
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class FBProcessInfo;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A block that obtains the full Process Info for a Process Identifier, from the live process.
+ The block should return nil if the live process is no longer the process that was in the snapshot, for example if the Process Identifier has been re-used.
+ */
+typedef FBProcessInfo *_Nullable (^FBProcessTableInfoProvider)(pid_t processIdentifier);
+
+/**
+ An immutable snapshot of the Process Table of the Host.
+
+ The Process Identifier, Parent Process Identifier and Name of every process are collected in a single pass.
+ Parent to children and name to process identifier indexes are built from these, so that repeated queries do not need to walk the process table again.
+ The full Process Info, which contains the arguments and environment, is only obtained for the processes that are queried. It is cached per process for the lifetime of the snapshot.
+ Processes that are not in the snapshot, such as those launched after it was taken, are looked up live.
+
+ The querying methods mirror those of FBProcessFetcher and are safe to call from multiple threads.
+ */
+@interface FBProcessTable : NSObject
+
+#pragma mark Initializers
+
+/**
+ Constructs a Process Table from pre-collected process information.
+
+ @param parents a mapping of Process Identifier to Parent Process Identifier, for every process in the table.
+ @param names a mapping of Process Identifier to Process Name.
+ @param infoProvider a block that is called the first time a process in the table is queried, and every time a process that is not in the table is queried.
+ @return a new Process Table.
+ */
++ (instancetype)tableWithParents:(NSDictionary<NSNumber *, NSNumber *> *)parents names:(NSDictionary<NSNumber *, NSString *> *)names infoProvider:(FBProcessTableInfoProvider)infoProvider;
+
+/**
+ Constructs a Process Table from a procfs(5) filesystem, such as that mounted at /proc on Linux.
+ The arguments and environment of each process are read from the "cmdline" and "environ" files.
+
+ @param procPath the path of the procfs mount.
+ @return a new Process Table.
+ */
++ (instancetype)tableFromProcFileSystemAtPath:(NSString *)procPath;
+
+#pragma mark Properties
+
+/**
+ When the snapshot was taken, in seconds since the reference date.
+ */
+@property (nonatomic, assign, readonly) CFAbsoluteTime timestamp;
+
+/**
+ The Process Identifiers of all processes in the snapshot, in ascending order.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSNumber *> *processIdentifiers;
+
+#pragma mark Indexed Queries
+
+/**
+ The Parent Process Identifier of a process.
+
+ @param child the Process Identifier of the child process.
+ @return the Parent Process Identifier, -1 if the process is not in the snapshot.
+ */
+- (pid_t)parentOf:(pid_t)child;
+
+/**
+ The Name of a process.
+
+ @param processIdentifier the Process Identifier of the process.
+ @return the name of the process, nil if the process is not in the snapshot.
+ */
+- (nullable NSString *)processNameFor:(pid_t)processIdentifier;
+
+/**
+ The Process Identifiers of the direct children of a process.
+
+ @param parent the Process Identifier of the parent.
+ @return the Process Identifiers of the children, in ascending order.
+ */
+- (NSArray<NSNumber *> *)subprocessIdentifiersOf:(pid_t)parent;
+
+/**
+ The Process Identifiers of the processes with a given name.
+
+ @param processName the name to match exactly.
+ @return the Process Identifiers of the processes, in ascending order.
+ */
+- (NSArray<NSNumber *> *)processIdentifiersWithName:(NSString *)processName;
+
+/**
+ The first child process of a parent, whose name contains a substring.
+
+ @param parent the Process Identifier of the parent process.
+ @param name the substring of the name of the child process.
+ @return a Process Identifier of the child process if one could be found, -1 otherwise.
+ */
+- (pid_t)subprocessOf:(pid_t)parent withName:(NSString *)name;
+
+#pragma mark Process Info Queries
+
+/**
+ The Process Info for a process.
+
+ @param processIdentifier the Process Identifier to obtain process info for.
+ @return an FBProcessInfo object, cached if the process is in the snapshot. nil if the info could not be obtained.
+ */
+- (nullable FBProcessInfo *)processInfoFor:(pid_t)processIdentifier;
+
+/**
+ The Process Info of the direct children of a process.
+
+ @param parent the Process Identifier of the parent.
+ @return an NSArray<FBProcessInfo> of the parent's child processes.
+ */
+- (NSArray<FBProcessInfo *> *)subprocessesOf:(pid_t)parent;
+
+/**
+ The Process Info of the processes with a given name.
+
+ @param processName the name of the processes to fetch.
+ @return an NSArray<FBProcessInfo> of the found processes.
+ */
+- (NSArray<FBProcessInfo *> *)processesWithProcessName:(NSString *)processName;
+
+/**
+ The Process Info of the processes with a given substring in their launch path.
+
+ @param substring the substring that must exist in the launch path.
+ @return an NSArray<FBProcessInfo> of the found processes.
+ */
+- (NSArray<FBProcessInfo *> *)processesWithLaunchPathSubstring:(NSString *)substring;
+
+@end
+
+NS_ASSUME_NONNULL_END
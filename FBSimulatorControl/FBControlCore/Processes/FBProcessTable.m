@@ -0,0 +1,266 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBProcessTable.h"
+
+#import "FBProcessInfo.h"
+
+#pragma mark procfs
+
+static NSArray<NSString *> *ProcFileSystemNullSeparatedStrings(NSString *path)
+{
+  NSData *data = [NSData dataWithContentsOfFile:path];
+  if (!data) {
+    return nil;
+  }
+  NSMutableArray<NSString *> *strings = [NSMutableArray array];
+  const char *bytes = data.bytes;
+  NSUInteger start = 0;
+  for (NSUInteger index = 0; index <= data.length; index++) {
+    if (index < data.length && bytes[index] != '\0') {
+      continue;
+    }
+    if (index > start) {
+      NSString *string = [[NSString alloc] initWithBytes:bytes + start length:index - start encoding:NSUTF8StringEncoding];
+      if (string) {
+        [strings addObject:string];
+      }
+    }
+    start = index + 1;
+  }
+  return strings;
+}
+
+static BOOL ProcFileSystemReadStat(NSString *statPath, pid_t *parentOut, NSString **nameOut)
+{
+  // The format is "pid (comm) state ppid ...", where comm may itself contain spaces or parentheses.
+  NSString *stat = [NSString stringWithContentsOfFile:statPath encoding:NSUTF8StringEncoding error:nil];
+  if (!stat) {
+    return NO;
+  }
+  NSRange open = [stat rangeOfString:@"("];
+  NSRange close = [stat rangeOfString:@")" options:NSBackwardsSearch];
+  if (open.location == NSNotFound || close.location == NSNotFound || close.location < open.location) {
+    return NO;
+  }
+  NSArray<NSString *> *fields = [[stat substringFromIndex:close.location + 1]
+    componentsSeparatedByCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+  fields = [fields filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"length > 0"]];
+  if (fields.count < 2) {
+    return NO;
+  }
+  *nameOut = [stat substringWithRange:NSMakeRange(open.location + 1, close.location - open.location - 1)];
+  *parentOut = fields[1].intValue;
+  return YES;
+}
+
+static FBProcessInfo *ProcFileSystemProcessInfo(NSString *procPath, pid_t processIdentifier)
+{
+  NSString *directory = [procPath stringByAppendingPathComponent:@(processIdentifier).stringValue];
+  NSArray<NSString *> *arguments = ProcFileSystemNullSeparatedStrings([directory stringByAppendingPathComponent:@"cmdline"]);
+  // Kernel threads have no arguments and no executable.
+  if (arguments.count == 0) {
+    return nil;
+  }
+  NSString *launchPath = [NSFileManager.defaultManager destinationOfSymbolicLinkAtPath:[directory stringByAppendingPathComponent:@"exe"] error:nil] ?: arguments.firstObject;
+
+  NSMutableDictionary<NSString *, NSString *> *environment = [NSMutableDictionary dictionary];
+  for (NSString *variable in ProcFileSystemNullSeparatedStrings([directory stringByAppendingPathComponent:@"environ"])) {
+    NSRange equals = [variable rangeOfString:@"="];
+    if (equals.location == NSNotFound) {
+      continue;
+    }
+    environment[[variable substringToIndex:equals.location]] = [variable substringFromIndex:equals.location + 1];
+  }
+  return [[FBProcessInfo alloc]
+    initWithProcessIdentifier:processIdentifier
+    launchPath:launchPath
+    arguments:arguments
+    environment:[environment copy]];
+}
+
+@interface FBProcessTable ()
+
+@property (nonatomic, copy, readonly) NSDictionary<NSNumber *, NSNumber *> *parents;
+@property (nonatomic, copy, readonly) NSDictionary<NSNumber *, NSString *> *names;
+@property (nonatomic, copy, readonly) NSDictionary<NSNumber *, NSArray<NSNumber *> *> *children;
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, NSArray<NSNumber *> *> *processIdentifiersByName;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSNumber *, id> *processInfos;
+@property (nonatomic, copy, readonly) FBProcessTableInfoProvider infoProvider;
+
+@end
+
+@implementation FBProcessTable
+
+#pragma mark Initializers
+
++ (instancetype)tableWithParents:(NSDictionary<NSNumber *, NSNumber *> *)parents names:(NSDictionary<NSNumber *, NSString *> *)names infoProvider:(FBProcessTableInfoProvider)infoProvider
+{
+  return [[self alloc] initWithParents:parents names:names infoProvider:infoProvider];
+}
+
++ (instancetype)tableFromProcFileSystemAtPath:(NSString *)procPath
+{
+  NSMutableDictionary<NSNumber *, NSNumber *> *parents = [NSMutableDictionary dictionary];
+  NSMutableDictionary<NSNumber *, NSString *> *names = [NSMutableDictionary dictionary];
+  NSCharacterSet *nonDigits = NSCharacterSet.decimalDigitCharacterSet.invertedSet;
+
+  for (NSString *entry in [NSFileManager.defaultManager contentsOfDirectoryAtPath:procPath error:nil]) {
+    if (entry.length == 0 || [entry rangeOfCharacterFromSet:nonDigits].location != NSNotFound) {
+      continue;
+    }
+    pid_t parent = -1;
+    NSString *name = nil;
+    NSString *statPath = [[procPath stringByAppendingPathComponent:entry] stringByAppendingPathComponent:@"stat"];
+    if (!ProcFileSystemReadStat(statPath, &parent, &name)) {
+      continue;
+    }
+    NSNumber *processIdentifier = @(entry.intValue);
+    parents[processIdentifier] = @(parent);
+    names[processIdentifier] = name;
+  }
+
+  NSString *path = [procPath copy];
+  return [self tableWithParents:parents names:names infoProvider:^ FBProcessInfo * (pid_t processIdentifier) {
+    return ProcFileSystemProcessInfo(path, processIdentifier);
+  }];
+}
+
+- (instancetype)initWithParents:(NSDictionary<NSNumber *, NSNumber *> *)parents names:(NSDictionary<NSNumber *, NSString *> *)names infoProvider:(FBProcessTableInfoProvider)infoProvider
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _timestamp = CFAbsoluteTimeGetCurrent();
+  _parents = [parents copy];
+  _names = [names copy];
+  _infoProvider = [infoProvider copy];
+  _processIdentifiers = [parents.allKeys sortedArrayUsingSelector:@selector(compare:)];
+
+  NSMutableDictionary<NSNumber *, NSMutableArray<NSNumber *> *> *children = [NSMutableDictionary dictionary];
+  NSMutableDictionary<NSString *, NSMutableArray<NSNumber *> *> *processIdentifiersByName = [NSMutableDictionary dictionary];
+  for (NSNumber *processIdentifier in _processIdentifiers) {
+    NSNumber *parent = parents[processIdentifier];
+    if (!children[parent]) {
+      children[parent] = [NSMutableArray array];
+    }
+    [children[parent] addObject:processIdentifier];
+
+    NSString *name = names[processIdentifier];
+    if (!name) {
+      continue;
+    }
+    if (!processIdentifiersByName[name]) {
+      processIdentifiersByName[name] = [NSMutableArray array];
+    }
+    [processIdentifiersByName[name] addObject:processIdentifier];
+  }
+  _processInfos = [NSMutableDictionary dictionary];
+  _children = [children copy];
+  _processIdentifiersByName = [processIdentifiersByName copy];
+
+  return self;
+}
+
+#pragma mark Indexed Queries
+
+- (pid_t)parentOf:(pid_t)child
+{
+  NSNumber *parent = self.parents[@(child)];
+  return parent ? parent.intValue : -1;
+}
+
+- (nullable NSString *)processNameFor:(pid_t)processIdentifier
+{
+  return self.names[@(processIdentifier)];
+}
+
+- (NSArray<NSNumber *> *)subprocessIdentifiersOf:(pid_t)parent
+{
+  return self.children[@(parent)] ?: @[];
+}
+
+- (NSArray<NSNumber *> *)processIdentifiersWithName:(NSString *)processName
+{
+  return self.processIdentifiersByName[processName] ?: @[];
+}
+
+- (pid_t)subprocessOf:(pid_t)parent withName:(NSString *)name
+{
+  for (NSNumber *processIdentifier in [self subprocessIdentifiersOf:parent]) {
+    if ([self.names[processIdentifier] rangeOfString:name].location != NSNotFound) {
+      return processIdentifier.intValue;
+    }
+  }
+  return -1;
+}
+
+#pragma mark Process Info Queries
+
+- (nullable FBProcessInfo *)processInfoFor:(pid_t)processIdentifier
+{
+  NSNumber *key = @(processIdentifier);
+  if (!self.parents[key]) {
+    // The process may have been launched after the snapshot was taken.
+    return self.infoProvider(processIdentifier);
+  }
+  @synchronized (self.processInfos) {
+    id cached = self.processInfos[key];
+    if (cached) {
+      return cached == NSNull.null ? nil : cached;
+    }
+  }
+  // The provider may be slow, so it is called outside the lock. Concurrent queries for the same process may both call it.
+  FBProcessInfo *process = self.infoProvider(processIdentifier);
+  @synchronized (self.processInfos) {
+    self.processInfos[key] = process ?: NSNull.null;
+  }
+  return process;
+}
+
+- (NSArray<FBProcessInfo *> *)subprocessesOf:(pid_t)parent
+{
+  return [self processInfoForProcessIdentifiers:[self subprocessIdentifiersOf:parent]];
+}
+
+- (NSArray<FBProcessInfo *> *)processesWithProcessName:(NSString *)processName
+{
+  return [self processInfoForProcessIdentifiers:[self processIdentifiersWithName:processName]];
+}
+
+- (NSArray<FBProcessInfo *> *)processesWithLaunchPathSubstring:(NSString *)substring
+{
+  NSMutableArray<FBProcessInfo *> *processes = [NSMutableArray array];
+  for (FBProcessInfo *process in [self processInfoForProcessIdentifiers:self.processIdentifiers]) {
+    if ([process.launchPath rangeOfString:substring].location == NSNotFound) {
+      continue;
+    }
+    [processes addObject:process];
+  }
+  return [processes copy];
+}
+
+#pragma mark Private
+
+- (NSArray<FBProcessInfo *> *)processInfoForProcessIdentifiers:(NSArray<NSNumber *> *)processIdentifiers
+{
+  NSMutableArray<FBProcessInfo *> *processes = [NSMutableArray array];
+  for (NSNumber *processIdentifier in processIdentifiers) {
+    FBProcessInfo *process = [self processInfoFor:processIdentifier.intValue];
+    if (!process) {
+      continue;
+    }
+    [processes addObject:process];
+  }
+  return [processes copy];
+}
+
+@end
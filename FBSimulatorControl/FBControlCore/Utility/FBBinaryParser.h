@@ -9,10 +9,104 @@
 
 #import <Foundation/Foundation.h>
 
+#import <FBControlCore/FBFuture.h>
+
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ The information parsed from a single architecture of a Mach-O binary.
+ */
+@interface FBMachOSlice : NSObject
+
+/**
+ The name of the architecture, nil if the CPU Type is not known.
+ */
+@property (nonatomic, copy, nullable, readonly) NSString *architecture;
+
+/**
+ The CPU Type and Subtype of the slice.
+ */
+@property (nonatomic, assign, readonly) int32_t cpuType;
+@property (nonatomic, assign, readonly) int32_t cpuSubtype;
+
+/**
+ The Mach-O File Type, for example MH_EXECUTE or MH_DYLIB.
+ */
+@property (nonatomic, assign, readonly) uint32_t fileType;
+
+/**
+ The range of the slice within the file.
+ */
+@property (nonatomic, assign, readonly) NSRange range;
+
+/**
+ The commands of all load commands, in the order they appear.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSNumber *> *loadCommands;
+
+/**
+ The UUID from LC_UUID, if present.
+ */
+@property (nonatomic, copy, nullable, readonly) NSUUID *uuid;
+
+/**
+ The install name from LC_ID_DYLIB, if present.
+ */
+@property (nonatomic, copy, nullable, readonly) NSString *installName;
+
+/**
+ The install names of all linked dylibs, including weak, re-exported, lazy and upward links.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSString *> *linkedDylibs;
+
+/**
+ The paths from all LC_RPATH commands.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSString *> *rpaths;
+
+/**
+ The range of the Code Signature within the file, from LC_CODE_SIGNATURE.
+ The location is NSNotFound if the slice is not signed.
+ */
+@property (nonatomic, assign, readonly) NSRange codeSignatureRange;
+
+/**
+ YES if the slice has an LC_ENCRYPTION_INFO command with a non-zero cryptid.
+ */
+@property (nonatomic, assign, readonly) BOOL isEncrypted;
+
+@end
+
+/**
+ The information parsed from a thin or fat Mach-O binary.
+ */
+@interface FBMachOFile : NSObject
+
+/**
+ The path the file was parsed from.
+ */
+@property (nonatomic, copy, readonly) NSString *path;
+
+/**
+ YES if the file is a fat binary, NO otherwise.
+ */
+@property (nonatomic, assign, readonly) BOOL isFat;
+
+/**
+ The slices of the binary. A thin binary has a single slice.
+ */
+@property (nonatomic, copy, readonly) NSArray<FBMachOSlice *> *slices;
+
+/**
+ The names of the known architectures of all slices.
+ */
+@property (nonatomic, copy, readonly) NSSet<NSString *> *architectures;
+
+@end
+
 /**
  Parsers the Mach-O Header of a binary.
+ Files are memory mapped and parsed in place, with the results memoized against the identity, size and modification date of the file.
  */
 @interface FBBinaryParser : NSObject
 
@@ -25,6 +119,25 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (nullable NSSet<NSString *> *)architecturesForBinaryAtPath:(NSString *)binaryPath error:(NSError **)error;
 
+/**
+ Parses the fat header and load commands of a binary.
+
+ @param binaryPath the Path of the Binary to parse.
+ @param error an error out for any error that occurred.
+ @return the parsed file, nil on error.
+ */
++ (nullable FBMachOFile *)machOFileAtPath:(NSString *)binaryPath error:(NSError **)error;
+
+/**
+ Finds and parses all of the Mach-O binaries within a bundle, in parallel.
+ Files that are not Mach-O binaries are ignored.
+
+ @param bundlePath the path of the bundle to scan.
+ @param queue the queue to resolve the future on.
+ @return a Future wrapping the parsed files, keyed by their path.
+ */
++ (FBFuture<NSDictionary<NSString *, FBMachOFile *> *> *)onQueue:(dispatch_queue_t)queue machOFilesInBundleAtPath:(NSString *)bundlePath;
+
 @end
 
 NS_ASSUME_NONNULL_END
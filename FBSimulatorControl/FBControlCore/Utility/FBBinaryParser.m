@@ -9,15 +9,25 @@
 
 #import "FBBinaryParser.h"
 
+#include <fcntl.h>
+#include <libkern/OSByteOrder.h>
 #include <mach/machine.h>
-#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <mach-o/fat.h>
 #include <mach-o/loader.h>
-#include <mach-o/swap.h>
 
 #import "FBControlCoreError.h"
 
+#ifndef FAT_MAGIC_64
+#define FAT_MAGIC_64 0xcafebabf
+#define FAT_CIGAM_64 0xbfbafeca
+#endif
+
+static const NSUInteger MachOCacheLimit = 1024;
+
 static inline NSString *ArchitectureForCPUType(cpu_type_t cpuType)
 {
   NSDictionary *lookup = @{
@@ -37,9 +47,11 @@ static inline NSString *MagicNameForMagic(uint32_t magic)
     @(MH_MAGIC_64) : @"MH_MAGIC_64",
     @(MH_CIGAM_64) : @"MH_CIGAM_64",
     @(FAT_MAGIC) : @"FAT_MAGIC",
-    @(FAT_CIGAM) : @"FAT_CIGAM"
+    @(FAT_CIGAM) : @"FAT_CIGAM",
+    @(FAT_MAGIC_64) : @"FAT_MAGIC_64",
+    @(FAT_CIGAM_64) : @"FAT_CIGAM_64",
   };
-  return lookup[@(magic)];
+  return lookup[@(magic)] ?: [NSString stringWithFormat:@"%08x", magic];
 }
 
 static inline BOOL IsMagic32(uint32_t magic)
@@ -54,12 +66,12 @@ static inline BOOL IsMagic64(uint32_t magic)
 
 static inline BOOL IsFatMagic(uint32_t magic)
 {
-  return magic == FAT_MAGIC || magic == FAT_CIGAM;
+  return magic == FAT_MAGIC || magic == FAT_CIGAM || magic == FAT_MAGIC_64 || magic == FAT_CIGAM_64;
 }
 
 static inline BOOL IsSwap(uint32_t magic)
 {
-  return magic == MH_CIGAM || magic == MH_CIGAM_64 || magic == FAT_CIGAM;
+  return magic == MH_CIGAM || magic == MH_CIGAM_64 || magic == FAT_CIGAM || magic == FAT_CIGAM_64;
 }
 
 static inline BOOL IsMagic(uint32_t magic)
@@ -67,126 +79,376 @@ static inline BOOL IsMagic(uint32_t magic)
   return IsMagic32(magic) || IsMagic64(magic) || IsFatMagic(magic);
 }
 
-static inline uint32_t GetMagic(FILE *file)
+static inline uint32_t Read32(const uint8_t *bytes, BOOL swap)
 {
-  // Get then read from the current position.
-  long position = ftell(file);
-  uint32_t magic;
-  fread(&magic, sizeof(uint32_t), 1, file);
+  // Mapped bytes are not guaranteed to be aligned, so are copied out.
+  uint32_t value;
+  memcpy(&value, bytes, sizeof(value));
+  return swap ? OSSwapInt32(value) : value;
+}
 
-  // Move back to the previous position now we know the magic.
-  fseek(file, position, SEEK_SET);
-  return magic;
+static inline uint64_t Read64(const uint8_t *bytes, BOOL swap)
+{
+  uint64_t value;
+  memcpy(&value, bytes, sizeof(value));
+  return swap ? OSSwapInt64(value) : value;
 }
 
-static inline NSString *ReadArch32(FILE *file, uint32_t magic)
+static inline NSString *ReadLoadCommandString(const uint8_t *command, uint32_t commandSize, uint32_t offset)
 {
-  struct mach_header header;
-  fread(&header, sizeof(struct mach_header), 1, file);
-  if (IsSwap(magic)) {
-    swap_mach_header(&header, 0);
+  if (offset >= commandSize) {
+    return nil;
   }
-  return ArchitectureForCPUType(header.cputype);
+  const char *string = (const char *) command + offset;
+  size_t length = strnlen(string, commandSize - offset);
+  return [[NSString alloc] initWithBytes:string length:length encoding:NSUTF8StringEncoding];
 }
 
-static inline NSString *ReadArch64(FILE *file, uint32_t magic)
+@interface FBMachOSlice ()
+
+@property (nonatomic, copy, nullable, readwrite) NSString *architecture;
+@property (nonatomic, assign, readwrite) int32_t cpuType;
+@property (nonatomic, assign, readwrite) int32_t cpuSubtype;
+@property (nonatomic, assign, readwrite) uint32_t fileType;
+@property (nonatomic, assign, readwrite) NSRange range;
+@property (nonatomic, copy, readwrite) NSArray<NSNumber *> *loadCommands;
+@property (nonatomic, copy, nullable, readwrite) NSUUID *uuid;
+@property (nonatomic, copy, nullable, readwrite) NSString *installName;
+@property (nonatomic, copy, readwrite) NSArray<NSString *> *linkedDylibs;
+@property (nonatomic, copy, readwrite) NSArray<NSString *> *rpaths;
+@property (nonatomic, assign, readwrite) NSRange codeSignatureRange;
+@property (nonatomic, assign, readwrite) BOOL isEncrypted;
+
+@end
+
+@implementation FBMachOSlice
+
+- (NSString *)description
 {
-  struct mach_header_64 header;
-  fread(&header, sizeof(struct mach_header_64), 1, file);
-  if (IsSwap(magic)) {
-    swap_mach_header_64(&header, 0);
-  }
-  return ArchitectureForCPUType(header.cputype);
+  return [NSString stringWithFormat:
+    @"%@ | UUID %@ | %lu Load Commands | %lu Linked Dylibs",
+    self.architecture ?: @(self.cpuType),
+    self.uuid.UUIDString,
+    (unsigned long) self.loadCommands.count,
+    (unsigned long) self.linkedDylibs.count
+  ];
 }
 
-static inline NSString *ReadArch(FILE *file, uint32_t magic)
+@end
+
+@interface FBMachOFile ()
+
+@property (nonatomic, copy, readwrite) NSString *path;
+@property (nonatomic, copy, readwrite) NSString *identity;
+@property (nonatomic, assign, readwrite) BOOL isFat;
+@property (nonatomic, copy, readwrite) NSArray<FBMachOSlice *> *slices;
+
+@end
+
+@implementation FBMachOFile
+
+- (NSSet<NSString *> *)architectures
 {
-  if (IsMagic32(magic)) {
-    return ReadArch32(file, magic);
-  }
-  if (IsMagic64(magic)) {
-    return ReadArch64(file, magic);
+  NSMutableSet<NSString *> *architectures = [NSMutableSet set];
+  for (FBMachOSlice *slice in self.slices) {
+    if (slice.architecture) {
+      [architectures addObject:slice.architecture];
+    }
   }
-  abort();
+  return [architectures copy];
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"%@ %@ %@", self.isFat ? @"Fat" : @"Thin", self.path, self.slices];
 }
 
-static inline NSArray *ReadArchsFat(FILE *file, uint32_t fatMagic)
+@end
+
+static FBMachOSlice *ParseSlice(const uint8_t *bytes, size_t fileLength, size_t offset, size_t length, NSString *path, NSError **error)
 {
-  // Get the Fat Header.
-  struct fat_header header;
-  fread(&header, sizeof(struct fat_header), 1, file);
-  if (IsSwap(fatMagic)) {
-    swap_fat_header(&header, 0);
+  if (offset > fileLength || length > fileLength - offset || length < sizeof(struct mach_header)) {
+    return [[FBControlCoreError
+      describeFormat:@"Slice at offset %zu of length %zu is out of the bounds of %@", offset, length, path]
+      fail:error];
+  }
+  const uint8_t *header = bytes + offset;
+  uint32_t magic = Read32(header, NO);
+  if (!IsMagic32(magic) && !IsMagic64(magic)) {
+    return [[FBControlCoreError
+      describeFormat:@"Could not interpret magic %@ of slice at offset %zu in file %@", MagicNameForMagic(magic), offset, path]
+      fail:error];
   }
+  BOOL swap = IsSwap(magic);
+  size_t headerLength = IsMagic64(magic) ? sizeof(struct mach_header_64) : sizeof(struct mach_header);
+  uint32_t commandCount = Read32(header + offsetof(struct mach_header, ncmds), swap);
+  uint32_t commandsLength = Read32(header + offsetof(struct mach_header, sizeofcmds), swap);
+  if (headerLength + commandsLength > length) {
+    return [[FBControlCoreError
+      describeFormat:@"Load commands of slice at offset %zu extend past the end of %@", offset, path]
+      fail:error];
+  }
+
+  FBMachOSlice *slice = [FBMachOSlice new];
+  slice.cpuType = (int32_t) Read32(header + offsetof(struct mach_header, cputype), swap);
+  slice.cpuSubtype = (int32_t) Read32(header + offsetof(struct mach_header, cpusubtype), swap);
+  slice.fileType = Read32(header + offsetof(struct mach_header, filetype), swap);
+  slice.architecture = ArchitectureForCPUType(slice.cpuType);
+  slice.range = NSMakeRange(offset, length);
+  slice.codeSignatureRange = NSMakeRange(NSNotFound, 0);
 
-  NSMutableArray *array = [NSMutableArray array];
-  long fatArchPosition = sizeof(struct fat_header);
-  for (uint32_t index = 0; index < header.nfat_arch; index++) {
-    // Seek-to then get the Fat Arch info
-    fseek(file, fatArchPosition, SEEK_SET);
-    struct fat_arch fatArch;
-    fread(&fatArch, sizeof(struct fat_arch), 1, file);
-    if (IsSwap(fatMagic)) {
-      swap_fat_arch(&fatArch, 1, 0);
+  NSMutableArray<NSNumber *> *loadCommands = [NSMutableArray arrayWithCapacity:commandCount];
+  NSMutableArray<NSString *> *linkedDylibs = [NSMutableArray array];
+  NSMutableArray<NSString *> *rpaths = [NSMutableArray array];
+  const uint8_t *commands = header + headerLength;
+  size_t position = 0;
+  for (uint32_t index = 0; index < commandCount; index++) {
+    if (position + sizeof(struct load_command) > commandsLength) {
+      return [[FBControlCoreError
+        describeFormat:@"Load command %u of slice at offset %zu is truncated in %@", index, offset, path]
+        fail:error];
     }
+    const uint8_t *command = commands + position;
+    uint32_t commandType = Read32(command, swap);
+    uint32_t commandSize = Read32(command + offsetof(struct load_command, cmdsize), swap);
+    if (commandSize < sizeof(struct load_command) || position + commandSize > commandsLength) {
+      return [[FBControlCoreError
+        describeFormat:@"Load command %u of slice at offset %zu has an invalid size %u in %@", index, offset, commandSize, path]
+        fail:error];
+    }
+    [loadCommands addObject:@(commandType)];
 
-    // Seek to the start position of the arch
-    fseek(file, fatArch.offset, SEEK_SET);
-    uint32_t magic = GetMagic(file);
-    if (!IsMagic(magic)){
-      return nil;
+    switch (commandType) {
+      case LC_UUID:
+        if (commandSize >= sizeof(struct uuid_command)) {
+          slice.uuid = [[NSUUID alloc] initWithUUIDBytes:command + offsetof(struct uuid_command, uuid)];
+        }
+        break;
+      case LC_ID_DYLIB:
+        slice.installName = ReadLoadCommandString(command, commandSize, Read32(command + offsetof(struct dylib_command, dylib.name.offset), swap));
+        break;
+      case LC_LOAD_DYLIB:
+      case LC_LOAD_WEAK_DYLIB:
+      case LC_REEXPORT_DYLIB:
+      case LC_LAZY_LOAD_DYLIB:
+      case LC_LOAD_UPWARD_DYLIB: {
+        NSString *dylib = ReadLoadCommandString(command, commandSize, Read32(command + offsetof(struct dylib_command, dylib.name.offset), swap));
+        if (dylib) {
+          [linkedDylibs addObject:dylib];
+        }
+        break;
+      }
+      case LC_RPATH: {
+        NSString *rpath = ReadLoadCommandString(command, commandSize, Read32(command + offsetof(struct rpath_command, path.offset), swap));
+        if (rpath) {
+          [rpaths addObject:rpath];
+        }
+        break;
+      }
+      case LC_CODE_SIGNATURE:
+        if (commandSize >= sizeof(struct linkedit_data_command)) {
+          uint32_t dataOffset = Read32(command + offsetof(struct linkedit_data_command, dataoff), swap);
+          uint32_t dataLength = Read32(command + offsetof(struct linkedit_data_command, datasize), swap);
+          slice.codeSignatureRange = NSMakeRange(offset + dataOffset, dataLength);
+        }
+        break;
+      case LC_ENCRYPTION_INFO:
+      case LC_ENCRYPTION_INFO_64:
+        if (commandSize >= sizeof(struct encryption_info_command)) {
+          slice.isEncrypted = slice.isEncrypted || Read32(command + offsetof(struct encryption_info_command, cryptid), swap) != 0;
+        }
+        break;
+      default:
+        break;
     }
+    position += commandSize;
+  }
+  slice.loadCommands = loadCommands;
+  slice.linkedDylibs = linkedDylibs;
+  slice.rpaths = rpaths;
+  return slice;
+}
 
-    // Get the Arch
-    NSString *arch = ReadArch(file, magic);
-    if (!arch) {
+static NSArray<FBMachOSlice *> *ParseFat(const uint8_t *bytes, size_t length, uint32_t magic, NSString *path, NSError **error)
+{
+  // Fat headers are always big-endian.
+  BOOL swap = IsSwap(magic);
+  BOOL is64 = magic == FAT_MAGIC_64 || magic == FAT_CIGAM_64;
+  uint32_t archCount = Read32(bytes + offsetof(struct fat_header, nfat_arch), swap);
+  size_t archLength = is64 ? 32 : sizeof(struct fat_arch);
+  if (sizeof(struct fat_header) + (size_t) archCount * archLength > length) {
+    return [[FBControlCoreError
+      describeFormat:@"Fat header of %@ has %u architectures, more than will fit in the file", path, archCount]
+      fail:error];
+  }
+  NSMutableArray<FBMachOSlice *> *slices = [NSMutableArray arrayWithCapacity:archCount];
+  for (uint32_t index = 0; index < archCount; index++) {
+    const uint8_t *arch = bytes + sizeof(struct fat_header) + index * archLength;
+    // fat_arch_64 has 64-bit offset and size fields, following the cputype and cpusubtype.
+    uint64_t offset = is64 ? Read64(arch + 8, swap) : Read32(arch + offsetof(struct fat_arch, offset), swap);
+    uint64_t size = is64 ? Read64(arch + 16, swap) : Read32(arch + offsetof(struct fat_arch, size), swap);
+    FBMachOSlice *slice = ParseSlice(bytes, length, (size_t) offset, (size_t) size, path, error);
+    if (!slice) {
       return nil;
     }
-    [array addObject:arch];
-    fatArchPosition += sizeof(struct fat_arch);
+    [slices addObject:slice];
   }
-
-  return [array copy];
+  return slices;
 }
 
-static inline NSArray *ReadArchs(FILE *file, uint32_t magic)
+static BOOL FileHasMachOMagic(NSString *path)
 {
-  if (IsFatMagic(magic)) {
-    return ReadArchsFat(file, magic);
-  }
-  if (IsMagic32(magic) || IsMagic64(magic)) {
-    NSString *arch = IsMagic32(magic) ? ReadArch32(file, magic) : ReadArch64(file, magic);
-    return arch ? @[arch] : @[];
+  int fileDescriptor = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor == -1) {
+    return NO;
   }
-  abort();
+  uint32_t magic = 0;
+  ssize_t readLength = pread(fileDescriptor, &magic, sizeof(magic), 0);
+  close(fileDescriptor);
+  return readLength == sizeof(magic) && IsMagic(magic);
 }
 
 @implementation FBBinaryParser
 
+#pragma mark Public
+
 + (NSSet<NSString *> *)architecturesForBinaryAtPath:(NSString *)binaryPath error:(NSError **)error
 {
-  FILE *file = fopen(binaryPath.UTF8String, "rb");
-  if (file == NULL) {
-    return [[FBControlCoreError describeFormat:@"Could not fopen file at path %@", binaryPath] fail:error];
+  return [self machOFileAtPath:binaryPath error:error].architectures;
+}
+
++ (nullable FBMachOFile *)machOFileAtPath:(NSString *)binaryPath error:(NSError **)error
+{
+  int fileDescriptor = open(binaryPath.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor == -1) {
+    return [[FBControlCoreError describeFormat:@"Could not open file at path %@: %s", binaryPath, strerror(errno)] fail:error];
+  }
+  struct stat fileStat;
+  if (fstat(fileDescriptor, &fileStat) != 0) {
+    close(fileDescriptor);
+    return [[FBControlCoreError describeFormat:@"Could not stat file at path %@: %s", binaryPath, strerror(errno)] fail:error];
+  }
+  NSString *identity = [NSString stringWithFormat:
+    @"%d:%llu:%lld:%ld.%ld",
+    fileStat.st_dev,
+    (unsigned long long) fileStat.st_ino,
+    (long long) fileStat.st_size,
+    (long) fileStat.st_mtimespec.tv_sec,
+    (long) fileStat.st_mtimespec.tv_nsec
+  ];
+  FBMachOFile *cached = [self.cache objectForKey:binaryPath];
+  if ([cached.identity isEqualToString:identity]) {
+    close(fileDescriptor);
+    return cached;
   }
 
-  // Seek to and read the magic.
-  rewind(file);
-  uint32_t magic = GetMagic(file);
+  size_t length = (size_t) fileStat.st_size;
+  if (length < sizeof(uint32_t)) {
+    close(fileDescriptor);
+    return [[FBControlCoreError describeFormat:@"File at path %@ is too short to be a Mach-O", binaryPath] fail:error];
+  }
+  const uint8_t *bytes = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (bytes == MAP_FAILED) {
+    return [[FBControlCoreError describeFormat:@"Could not map file at path %@: %s", binaryPath, strerror(errno)] fail:error];
+  }
 
-  if (!IsMagic(magic)) {
-    fclose(file);
-    return [[FBControlCoreError describeFormat:@"Could not interpret magic '%d' in file %@", magic, binaryPath] fail:error];
+  FBMachOFile *file = [self parseMappedBytes:bytes length:length path:binaryPath error:error];
+  munmap((void *) bytes, length);
+  if (!file) {
+    return nil;
   }
+  file.identity = identity;
+  [self.cache setObject:file forKey:binaryPath];
+  return file;
+}
 
-  NSArray *archs = ReadArchs(file, magic);
-  if (!archs) {
-    fclose(file);
-    return [[FBControlCoreError describeFormat:@"Could not read architechtures of magic %@ in file %@", MagicNameForMagic(magic), binaryPath] fail:error];
++ (FBFuture<NSDictionary<NSString *, FBMachOFile *> *> *)onQueue:(dispatch_queue_t)queue machOFilesInBundleAtPath:(NSString *)bundlePath
+{
+  return [FBFuture onQueue:queue resolveValue:^ NSDictionary<NSString *, FBMachOFile *> * (NSError **error) {
+    NSArray<NSString *> *candidates = [self regularFilesInDirectory:bundlePath error:error];
+    if (!candidates) {
+      return nil;
+    }
+    NSMutableDictionary<NSString *, FBMachOFile *> *files = [NSMutableDictionary dictionary];
+    dispatch_apply(candidates.count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t index) {
+      // Most files in a bundle are resources, these are rejected by their magic without being mapped.
+      NSString *path = candidates[index];
+      if (!FileHasMachOMagic(path)) {
+        return;
+      }
+      FBMachOFile *file = [self machOFileAtPath:path error:nil];
+      if (!file) {
+        return;
+      }
+      @synchronized (files) {
+        files[path] = file;
+      }
+    });
+    return [files copy];
+  }];
+}
+
+#pragma mark Private
+
++ (NSCache<NSString *, FBMachOFile *> *)cache
+{
+  static dispatch_once_t onceToken;
+  static NSCache<NSString *, FBMachOFile *> *cache;
+  dispatch_once(&onceToken, ^{
+    cache = [NSCache new];
+    cache.name = @"com.facebook.fbcontrolcore.binary_parser";
+    cache.countLimit = MachOCacheLimit;
+  });
+  return cache;
+}
+
++ (nullable FBMachOFile *)parseMappedBytes:(const uint8_t *)bytes length:(size_t)length path:(NSString *)path error:(NSError **)error
+{
+  uint32_t magic = Read32(bytes, NO);
+  if (!IsMagic(magic)) {
+    return [[FBControlCoreError describeFormat:@"Could not interpret magic '%d' in file %@", magic, path] fail:error];
+  }
+  NSArray<FBMachOSlice *> *slices = nil;
+  if (IsFatMagic(magic)) {
+    if (length < sizeof(struct fat_header)) {
+      return [[FBControlCoreError describeFormat:@"Fat header of %@ is truncated", path] fail:error];
+    }
+    slices = ParseFat(bytes, length, magic, path, error);
+  } else {
+    FBMachOSlice *slice = ParseSlice(bytes, length, 0, length, path, error);
+    slices = slice ? @[slice] : nil;
   }
+  if (!slices) {
+    return nil;
+  }
+  FBMachOFile *file = [FBMachOFile new];
+  file.path = path;
+  file.isFat = IsFatMagic(magic);
+  file.slices = slices;
+  return file;
+}
 
-  fclose(file);
-  return [NSSet setWithArray:archs];
++ (nullable NSArray<NSString *> *)regularFilesInDirectory:(NSString *)directory error:(NSError **)error
+{
+  NSURL *directoryURL = [NSURL fileURLWithPath:directory isDirectory:YES];
+  NSDirectoryEnumerator<NSURL *> *enumerator = [NSFileManager.defaultManager
+    enumeratorAtURL:directoryURL
+    includingPropertiesForKeys:@[NSURLIsRegularFileKey]
+    options:0
+    errorHandler:nil];
+  if (!enumerator) {
+    return [[FBControlCoreError describeFormat:@"Could not enumerate bundle at path %@", directory] fail:error];
+  }
+  NSMutableArray<NSString *> *paths = [NSMutableArray array];
+  for (NSURL *url in enumerator) {
+    NSNumber *isRegularFile = nil;
+    [url getResourceValue:&isRegularFile forKey:NSURLIsRegularFileKey error:nil];
+    if (isRegularFile.boolValue) {
+      [paths addObject:url.path];
+    }
+  }
+  return paths;
 }
 
 @end
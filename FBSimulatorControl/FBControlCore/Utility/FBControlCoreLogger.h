@@ -23,6 +23,7 @@ typedef NS_ENUM(NSUInteger, FBControlCoreLogLevel) {
 };
 
 @protocol FBDataConsumer;
+@class FBFuture<T>;
 
 /**
  A Protocol for Classes that recieve Logger Messages.
@@ -92,6 +93,20 @@ typedef NS_ENUM(NSUInteger, FBControlCoreLogLevel) {
 
 @end
 
+/**
+ A Logger that writes messages in the background.
+ */
+@protocol FBControlCoreBackgroundLogger <FBControlCoreLogger>
+
+/**
+ Writes all of the messages that were logged before this call.
+
+ @return a Future that resolves when the messages have been passed to the consumer.
+ */
+- (FBFuture<NSNull *> *)flush;
+
+@end
+
 /**
  Implementations of Loggers.
  */
@@ -123,6 +138,19 @@ typedef NS_ENUM(NSUInteger, FBControlCoreLogLevel) {
  */
 + (id<FBControlCoreLogger>)loggerToConsumer:(id<FBDataConsumer>)consumer;
 
+/**
+ Log to a Consumer, in the background.
+ The calling thread only enqueues the message, the timestamping, prefixing, encoding and writing all happen on a background queue.
+ Messages are written to the consumer in batches, so the consumer does not need to be thread safe.
+ Messages more verbose than the level are discarded before any formatting occurs.
+ If messages are logged faster than they can be written, the excess are dropped and the number dropped is logged.
+
+ @param consumer the consumer to write data to.
+ @param level the most verbose level of message to log.
+ @return a logger instance, messages logged to it or any derived logger can be flushed from it.
+ */
++ (id<FBControlCoreBackgroundLogger>)backgroundLoggerToConsumer:(id<FBDataConsumer>)consumer level:(FBControlCoreLogLevel)level;
+
 /**
  Log to a File Handle.
 
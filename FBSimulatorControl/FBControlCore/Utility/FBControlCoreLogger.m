@@ -12,6 +12,9 @@
 #import "FBDataConsumer.h"
 #import "FBFileWriter.h"
 #import "FBControlCoreLogger+OSLog.h"
+#import "FBFuture.h"
+
+static const NSUInteger BackgroundLoggerCapacity = 4096;
 
 @interface FBControlCoreLogger_NSLog : NSObject <FBControlCoreLogger>
 
@@ -274,6 +277,268 @@
 
 @end
 
+/**
+ A message that has been logged, but not yet formatted.
+ The strings are retained until the message has been written.
+ */
+typedef struct {
+  CFAbsoluteTime timestamp;
+  CFStringRef name;
+  CFStringRef message;
+  BOOL dateFormat;
+} FBControlCoreLogger_BackgroundMessage;
+
+static void FBControlCoreLogger_BackgroundMessageRelease(FBControlCoreLogger_BackgroundMessage message)
+{
+  CFRelease(message.message);
+  if (message.name) {
+    CFRelease(message.name);
+  }
+}
+
+@interface FBControlCoreLogger_BackgroundSink : NSObject
+
+@property (nonatomic, strong, readonly) id<FBDataConsumer> consumer;
+@property (nonatomic, assign, readonly) FBControlCoreLogLevel level;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) dispatch_source_t wakeup;
+@property (nonatomic, strong, readonly) NSLock *lock;
+
+@property (nonatomic, assign, readwrite) FBControlCoreLogger_BackgroundMessage *pending;
+@property (nonatomic, assign, readwrite) FBControlCoreLogger_BackgroundMessage *draining;
+@property (nonatomic, assign, readwrite) NSUInteger pendingCount;
+@property (nonatomic, assign, readwrite) NSUInteger droppedCount;
+
+@property (nonatomic, strong, readonly) NSMutableString *batch;
+@property (nonatomic, strong, readonly) NSDateFormatter *secondFormatter;
+@property (nonatomic, strong, readonly) NSDateFormatter *timeZoneFormatter;
+@property (nonatomic, assign, readwrite) CFAbsoluteTime cachedSecond;
+@property (nonatomic, copy, nullable, readwrite) NSString *cachedSecondString;
+@property (nonatomic, copy, nullable, readwrite) NSString *cachedTimeZoneString;
+
+@end
+
+@implementation FBControlCoreLogger_BackgroundSink
+
+- (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer level:(FBControlCoreLogLevel)level
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _consumer = consumer;
+  _level = level;
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.logger.background", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+  _lock = [NSLock new];
+  _pending = calloc(BackgroundLoggerCapacity, sizeof(FBControlCoreLogger_BackgroundMessage));
+  _draining = calloc(BackgroundLoggerCapacity, sizeof(FBControlCoreLogger_BackgroundMessage));
+  _batch = [NSMutableString string];
+  _secondFormatter = [NSDateFormatter new];
+  _secondFormatter.dateFormat = @"yyyy-MM-dd HH:mm:ss";
+  _timeZoneFormatter = [NSDateFormatter new];
+  _timeZoneFormatter.dateFormat = @"ZZZ";
+  _cachedSecond = -1;
+
+  // Wakeups are coalesced, so a burst of messages is drained and written together.
+  _wakeup = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_ADD, 0, 0, _queue);
+  __weak typeof(self) weakSelf = self;
+  dispatch_source_set_event_handler(_wakeup, ^{
+    [weakSelf drain];
+  });
+  dispatch_resume(_wakeup);
+
+  return self;
+}
+
+- (void)dealloc
+{
+  dispatch_source_cancel(_wakeup);
+  [self drain];
+  free(_pending);
+  free(_draining);
+}
+
+#pragma mark Public
+
+- (void)enqueueMessage:(NSString *)message name:(nullable NSString *)name dateFormat:(BOOL)dateFormat
+{
+  FBControlCoreLogger_BackgroundMessage entry = {
+    .timestamp = dateFormat ? CFAbsoluteTimeGetCurrent() : 0,
+    .name = name ? (CFStringRef) CFBridgingRetain(name) : NULL,
+    .message = (CFStringRef) CFBridgingRetain([message copy]),
+    .dateFormat = dateFormat,
+  };
+
+  [self.lock lock];
+  BOOL full = self.pendingCount == BackgroundLoggerCapacity;
+  if (full) {
+    self.droppedCount += 1;
+  } else {
+    self.pending[self.pendingCount] = entry;
+    self.pendingCount += 1;
+  }
+  [self.lock unlock];
+
+  if (full) {
+    FBControlCoreLogger_BackgroundMessageRelease(entry);
+    return;
+  }
+  dispatch_source_merge_data(self.wakeup, 1);
+}
+
+- (FBFuture<NSNull *> *)flush
+{
+  return [FBFuture onQueue:self.queue resolveValue:^(NSError **_) {
+    [self drain];
+    return NSNull.null;
+  }];
+}
+
+#pragma mark Private
+
+- (void)drain
+{
+  // Swap the buffers, so that the lock is only held for the swap and not whilst formatting.
+  [self.lock lock];
+  FBControlCoreLogger_BackgroundMessage *messages = self.pending;
+  NSUInteger count = self.pendingCount;
+  NSUInteger dropped = self.droppedCount;
+  self.pending = self.draining;
+  self.draining = messages;
+  self.pendingCount = 0;
+  self.droppedCount = 0;
+  [self.lock unlock];
+
+  NSMutableString *batch = self.batch;
+  [batch setString:@""];
+  for (NSUInteger index = 0; index < count; index++) {
+    FBControlCoreLogger_BackgroundMessage message = messages[index];
+    NSString *line = [FBControlCoreLogger loggableStringLine:(__bridge NSString *) message.message];
+    if (line) {
+      if (message.dateFormat) {
+        [self appendTimestamp:message.timestamp toString:batch];
+      }
+      if (message.name) {
+        [batch appendFormat:@"[%@] ", (__bridge NSString *) message.name];
+      }
+      [batch appendString:line];
+      [batch appendString:@"\n"];
+    }
+    FBControlCoreLogger_BackgroundMessageRelease(message);
+  }
+  if (dropped > 0) {
+    [batch appendFormat:@"[%lu log messages dropped]\n", (unsigned long) dropped];
+  }
+  if (batch.length == 0) {
+    return;
+  }
+  [self.consumer consumeData:[batch dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+- (void)appendTimestamp:(CFAbsoluteTime)timestamp toString:(NSMutableString *)string
+{
+  // Formatting a date is expensive, so only the millisecond component is formatted for each message in the same second.
+  CFAbsoluteTime second = floor(timestamp);
+  if (second != self.cachedSecond) {
+    NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:second];
+    self.cachedSecond = second;
+    self.cachedSecondString = [self.secondFormatter stringFromDate:date];
+    self.cachedTimeZoneString = [self.timeZoneFormatter stringFromDate:date];
+  }
+  int milliseconds = (int) ((timestamp - second) * 1000);
+  [string appendFormat:@"%@.%03d%@ ", self.cachedSecondString, milliseconds, self.cachedTimeZoneString];
+}
+
+@end
+
+@interface FBControlCoreLogger_Background : NSObject <FBControlCoreBackgroundLogger>
+
+@property (nonatomic, strong, readonly) FBControlCoreLogger_BackgroundSink *sink;
+@property (nonatomic, assign, readonly) BOOL dateFormat;
+@property (nonatomic, assign, readonly) BOOL enabled;
+
+@end
+
+@implementation FBControlCoreLogger_Background
+
+@synthesize name = _name;
+@synthesize level = _level;
+
+- (instancetype)initWithSink:(FBControlCoreLogger_BackgroundSink *)sink name:(nullable NSString *)name level:(FBControlCoreLogLevel)level dateFormat:(BOOL)dateFormat
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _sink = sink;
+  _name = name;
+  _level = level;
+  _dateFormat = dateFormat;
+  _enabled = level <= sink.level;
+
+  return self;
+}
+
+#pragma mark Protocol Implementation
+
+- (id<FBControlCoreLogger>)log:(NSString *)message
+{
+  if (!self.enabled) {
+    return self;
+  }
+  [self.sink enqueueMessage:message name:self.name dateFormat:self.dateFormat];
+  return self;
+}
+
+- (id<FBControlCoreLogger>)logFormat:(NSString *)format, ... NS_FORMAT_FUNCTION(1,2)
+{
+  // Return before the arguments are formatted, so disabled levels are close to free.
+  if (!self.enabled) {
+    return self;
+  }
+  va_list args;
+  va_start(args, format);
+  NSString *string = [[NSString alloc] initWithFormat:format arguments:args];
+  va_end(args);
+
+  [self.sink enqueueMessage:string name:self.name dateFormat:self.dateFormat];
+  return self;
+}
+
+- (id<FBControlCoreLogger>)info
+{
+  return [[self.class alloc] initWithSink:self.sink name:self.name level:FBControlCoreLogLevelInfo dateFormat:self.dateFormat];
+}
+
+- (id<FBControlCoreLogger>)debug
+{
+  return [[self.class alloc] initWithSink:self.sink name:self.name level:FBControlCoreLogLevelDebug dateFormat:self.dateFormat];
+}
+
+- (id<FBControlCoreLogger>)error
+{
+  return [[self.class alloc] initWithSink:self.sink name:self.name level:FBControlCoreLogLevelError dateFormat:self.dateFormat];
+}
+
+- (id<FBControlCoreLogger>)withName:(NSString *)name
+{
+  return [[self.class alloc] initWithSink:self.sink name:name level:self.level dateFormat:self.dateFormat];
+}
+
+- (id<FBControlCoreLogger>)withDateFormatEnabled:(BOOL)enabled __attribute__((no_sanitize("bool")))
+{
+  return [[self.class alloc] initWithSink:self.sink name:self.name level:self.level dateFormat:enabled];
+}
+
+- (FBFuture<NSNull *> *)flush
+{
+  return [self.sink flush];
+}
+
+@end
+
 @implementation FBControlCoreLogger
 
 #pragma mark Public
@@ -317,6 +582,12 @@
   return [[FBControlCoreLogger_Consumer alloc] initWithConsumer:consumer name:nil dateFormatter:nil];
 }
 
++ (id<FBControlCoreBackgroundLogger>)backgroundLoggerToConsumer:(id<FBDataConsumer>)consumer level:(FBControlCoreLogLevel)level
+{
+  FBControlCoreLogger_BackgroundSink *sink = [[FBControlCoreLogger_BackgroundSink alloc] initWithConsumer:consumer level:level];
+  return [[FBControlCoreLogger_Background alloc] initWithSink:sink name:nil level:FBControlCoreLogLevelInfo dateFormat:NO];
+}
+
 + (id<FBControlCoreLogger>)loggerToFileHandle:(NSFileHandle *)fileHandle
 {
   id<FBDataConsumer> consumer = [FBFileWriter syncWriterWithFileHandle:fileHandle];
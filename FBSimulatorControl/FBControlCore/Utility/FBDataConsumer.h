@@ -64,6 +64,36 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+/**
+ A consumer that buffers data that it has not yet been able to write, so that producers can slow down when it is unable to keep up.
+ */
+@protocol FBDataConsumerBackpressure <NSObject>
+
+/**
+ The number of bytes that have been consumed, but not yet written.
+ */
+@property (atomic, assign, readonly) NSUInteger pendingBytes;
+
+/**
+ The number of bytes that have been discarded, instead of being written.
+ */
+@property (atomic, assign, readonly) NSUInteger droppedBytes;
+
+/**
+ A Future that resolves when the consumer is ready to accept more data.
+ This is pending from when the pending bytes exceed the high water mark, until they fall back to the low water mark.
+ Otherwise, it is already resolved.
+ */
+@property (nonatomic, strong, readonly) FBFuture<NSNull *> *drained;
+
+/**
+ A Future that resolves when all of the data consumed so far has been written or dropped, so that there are no pending bytes.
+ Unlike drained, this waits for all pending bytes, not just those above the low water mark.
+ */
+@property (nonatomic, strong, readonly) FBFuture<NSNull *> *flushed;
+
+@end
+
 /**
  The non-mutating methods of a buffer.
  */
@@ -151,6 +181,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Adapts a NSData consumer to a dispatch_data consumer.
+ If the consumer conforms to FBDataConsumerBackpressure, so will the adapted consumer.
 
  @param consumer the consumer to adapt.
  @return a NSData consumer.
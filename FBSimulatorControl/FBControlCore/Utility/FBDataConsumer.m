@@ -5,6 +5,7 @@
 #import "FBCollectionInformation.h"
 #import "FBControlCoreError.h"
 #import "FBControlCoreLogger.h"
+#import "FBDelimiterScanner.h"
 
 @interface FBDataConsumerAdaptor ()
 
@@ -91,6 +92,36 @@
 
 @end
 
+@interface FBDataConsumerAdaptor_ToDispatchDataBackpressure : FBDataConsumerAdaptor_ToDispatchData <FBDataConsumerBackpressure>
+
+@end
+
+@implementation FBDataConsumerAdaptor_ToDispatchDataBackpressure
+
+#pragma mark FBDataConsumerBackpressure
+
+- (NSUInteger)pendingBytes
+{
+  return ((id<FBDataConsumerBackpressure>) self.consumer).pendingBytes;
+}
+
+- (NSUInteger)droppedBytes
+{
+  return ((id<FBDataConsumerBackpressure>) self.consumer).droppedBytes;
+}
+
+- (FBFuture<NSNull *> *)drained
+{
+  return ((id<FBDataConsumerBackpressure>) self.consumer).drained;
+}
+
+- (FBFuture<NSNull *> *)flushed
+{
+  return ((id<FBDataConsumerBackpressure>) self.consumer).flushed;
+}
+
+@end
+
 @implementation FBDataConsumerAdaptor
 
 #pragma mark Initializers
@@ -102,6 +133,9 @@
 
 + (id<FBDataConsumer, FBDataConsumerLifecycle>)dataConsumerForDispatchDataConsumer:(id<FBDispatchDataConsumer, FBDataConsumerLifecycle>)consumer;
 {
+  if ([consumer conformsToProtocol:@protocol(FBDataConsumerBackpressure)]) {
+    return [[FBDataConsumerAdaptor_ToDispatchDataBackpressure alloc] initWithConsumer:consumer];
+  }
   return [[FBDataConsumerAdaptor_ToDispatchData alloc] initWithConsumer:consumer];
 }
 
@@ -207,8 +241,7 @@
 
 - (NSArray<NSString *> *)lines
 {
-  NSString *output = [[NSString alloc] initWithData:self.data encoding:NSUTF8StringEncoding];
-  return [output componentsSeparatedByCharactersInSet:NSCharacterSet.newlineCharacterSet];
+  return [FBDelimiterScanner linesOfData:self.data];
 }
 
 #pragma mark FBDataConsumer
@@ -271,12 +304,12 @@
   if (self.buffer.length == 0) {
     return nil;
   }
-  NSRange newlineRange = [self.buffer rangeOfData:terminal options:0 range:NSMakeRange(0, self.buffer.length)];
-  if (newlineRange.location == NSNotFound) {
+  NSUInteger location = [FBDelimiterScanner locationOfTerminal:terminal inData:self.buffer];
+  if (location == NSNotFound) {
     return nil;
   }
-  NSData *lineData = [self.buffer subdataWithRange:NSMakeRange(0, newlineRange.location)];
-  [self.buffer replaceBytesInRange:NSMakeRange(0, newlineRange.location + terminal.length) withBytes:"" length:0];
+  NSData *lineData = [self.buffer subdataWithRange:NSMakeRange(0, location)];
+  [self.buffer replaceBytesInRange:NSMakeRange(0, location + terminal.length) withBytes:"" length:0];
   return lineData;
 }
 
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Finds the positions of a delimiter byte in a range of bytes.
+ 16 bytes are compared at a time with SSE2 or NEON, where available.
+ Scanning stops once the capacity is reached, so that large ranges can be scanned in fixed size batches.
+
+ @param bytes the bytes to scan.
+ @param length the number of bytes to scan.
+ @param delimiter the delimiter to find.
+ @param positions the array to write the positions into, in ascending order.
+ @param capacity the number of positions that the array can hold.
+ @return the number of positions written. If this is equal to the capacity, scanning should continue from after the last position.
+ */
+extern size_t FBDelimiterScanPositions(const uint8_t *bytes, size_t length, uint8_t delimiter, size_t *positions, size_t capacity);
+
+/**
+ Finds the first position of a delimiter byte in a range of bytes.
+
+ @param bytes the bytes to scan.
+ @param length the number of bytes to scan.
+ @param delimiter the delimiter to find.
+ @return the position of the delimiter, or the length if it is not present.
+ */
+extern size_t FBDelimiterScanFirst(const uint8_t *bytes, size_t length, uint8_t delimiter);
+
+/**
+ Decodes a single line, excluding its newline.
+ A trailing carriage return is removed. Lines that are not valid UTF-8 are decoded as Latin-1.
+
+ @param bytes the bytes of the line.
+ @param length the number of bytes in the line.
+ @return the decoded line.
+ */
+extern NSString *FBDelimiterLineFromBytes(const uint8_t *bytes, size_t length);
+
+/**
+ Whether a range of bytes is text, rather than binary.
+ Bytes containing a NUL are binary, so are not split into lines or searched.
+
+ @param bytes the bytes to check.
+ @param length the number of bytes to check.
+ @return YES if the bytes are text, NO otherwise.
+ */
+extern BOOL FBDelimiterBytesAreText(const uint8_t *bytes, size_t length);
+
+/**
+ Splitting of buffers into lines, using the delimiter scanning functions.
+ */
+@interface FBDelimiterScanner : NSObject
+
+/**
+ Finds the first occurrence of a byte sequence in data.
+
+ @param terminal the byte sequence to find.
+ @param data the data to search in.
+ @return the location of the terminal, NSNotFound if it is not present.
+ */
++ (NSUInteger)locationOfTerminal:(NSData *)terminal inData:(NSData *)data;
+
+/**
+ Splits data into lines.
+ Lines are separated by newlines, a carriage return preceding a newline is removed.
+ As with -[NSString componentsSeparatedByString:], data that ends in a newline has an empty final line.
+ Lines that are not valid UTF-8 are decoded as Latin-1.
+
+ @param data the data to split.
+ @return the lines of the data.
+ */
++ (NSArray<NSString *> *)linesOfData:(NSData *)data;
+
+/**
+ Splits data into lines, if it is text.
+
+ @param data the data to split.
+ @return the lines of the data, empty if the data is binary.
+ */
++ (NSArray<NSString *> *)linesOfTextData:(NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
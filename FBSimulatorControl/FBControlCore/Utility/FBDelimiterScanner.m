@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBDelimiterScanner.h"
+
+#if defined(__SSE2__)
+#import <emmintrin.h>
+#elif defined(__ARM_NEON)
+#import <arm_neon.h>
+#endif
+
+size_t FBDelimiterScanPositions(const uint8_t *bytes, size_t length, uint8_t delimiter, size_t *positions, size_t capacity)
+{
+  size_t count = 0;
+  size_t index = 0;
+  if (capacity == 0) {
+    return 0;
+  }
+#if defined(__SSE2__)
+  __m128i needle = _mm_set1_epi8((char) delimiter);
+  for (; index + 16 <= length; index += 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *) (bytes + index));
+    uint32_t mask = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+    while (mask != 0) {
+      positions[count++] = index + (size_t) __builtin_ctz(mask);
+      if (count == capacity) {
+        return count;
+      }
+      mask &= mask - 1;
+    }
+  }
+#elif defined(__ARM_NEON)
+  uint8x16_t needle = vdupq_n_u8(delimiter);
+  for (; index + 16 <= length; index += 16) {
+    uint8x16_t matches = vceqq_u8(vld1q_u8(bytes + index), needle);
+    // NEON has no movemask, so narrow the comparison to a nibble per byte, then keep one bit of each nibble.
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0) & 0x8888888888888888ull;
+    while (mask != 0) {
+      positions[count++] = index + (size_t) (__builtin_ctzll(mask) >> 2);
+      if (count == capacity) {
+        return count;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+  for (; index < length; index++) {
+    if (bytes[index] != delimiter) {
+      continue;
+    }
+    positions[count++] = index;
+    if (count == capacity) {
+      return count;
+    }
+  }
+  return count;
+}
+
+size_t FBDelimiterScanFirst(const uint8_t *bytes, size_t length, uint8_t delimiter)
+{
+  size_t position = 0;
+  return FBDelimiterScanPositions(bytes, length, delimiter, &position, 1) == 1 ? position : length;
+}
+
+NSString *FBDelimiterLineFromBytes(const uint8_t *bytes, size_t length)
+{
+  if (length > 0 && bytes[length - 1] == '\r') {
+    length--;
+  }
+  return [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding]
+    ?: [[NSString alloc] initWithBytes:bytes length:length encoding:NSISOLatin1StringEncoding];
+}
+
+BOOL FBDelimiterBytesAreText(const uint8_t *bytes, size_t length)
+{
+  return FBDelimiterScanFirst(bytes, length, '\0') == length;
+}
+
+@implementation FBDelimiterScanner
+
++ (NSUInteger)locationOfTerminal:(NSData *)terminal inData:(NSData *)data
+{
+  if (terminal.length == 0 || terminal.length > data.length) {
+    return NSNotFound;
+  }
+  const uint8_t *bytes = data.bytes;
+  const uint8_t *terminalBytes = terminal.bytes;
+  size_t lastStart = data.length - terminal.length;
+  size_t start = 0;
+  // Find each occurrence of the first byte of the terminal, then compare the remainder.
+  while (start <= lastStart) {
+    start += FBDelimiterScanFirst(bytes + start, lastStart + 1 - start, terminalBytes[0]);
+    if (start > lastStart) {
+      break;
+    }
+    if (memcmp(bytes + start + 1, terminalBytes + 1, terminal.length - 1) == 0) {
+      return start;
+    }
+    start++;
+  }
+  return NSNotFound;
+}
+
++ (NSArray<NSString *> *)linesOfData:(NSData *)data
+{
+  if (data.length == 0) {
+    return @[@""];
+  }
+  const uint8_t *bytes = data.bytes;
+  size_t length = data.length;
+  NSMutableArray<NSString *> *lines = [NSMutableArray array];
+  size_t positions[1024];
+  size_t capacity = sizeof(positions) / sizeof(positions[0]);
+  size_t lineStart = 0;
+  while (YES) {
+    size_t count = FBDelimiterScanPositions(bytes + lineStart, length - lineStart, '\n', positions, capacity);
+    size_t batchStart = lineStart;
+    for (size_t index = 0; index < count; index++) {
+      size_t newline = batchStart + positions[index];
+      [lines addObject:FBDelimiterLineFromBytes(bytes + lineStart, newline - lineStart)];
+      lineStart = newline + 1;
+    }
+    if (count < capacity) {
+      break;
+    }
+  }
+  [lines addObject:FBDelimiterLineFromBytes(bytes + lineStart, length - lineStart)];
+  return [lines copy];
+}
+
++ (NSArray<NSString *> *)linesOfTextData:(NSData *)data
+{
+  return FBDelimiterBytesAreText(data.bytes, data.length) ? [self linesOfData:data] : @[];
+}
+
+@end
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBFuture.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Counts of the work performed by FBFileCopier.
+ */
+@interface FBFileCopyStatistics : NSObject
+
+/**
+ The number of items that were cloned, sharing storage with the source.
+ A directory that is cloned in a single operation counts as one item.
+ */
+@property (atomic, assign, readonly) NSUInteger filesCloned;
+
+/**
+ The number of files whose contents were copied.
+ */
+@property (atomic, assign, readonly) NSUInteger filesCopied;
+
+/**
+ The number of files that were already up-to-date in the destination.
+ */
+@property (atomic, assign, readonly) NSUInteger filesSkipped;
+
+/**
+ The number of bytes that were copied.
+ */
+@property (atomic, assign, readonly) unsigned long long bytesCopied;
+
+@end
+
+/**
+ Copies files and directories, making the destination identical to the source.
+
+ - If the destination does not exist, the source is cloned with clonefile(2) where the volume supports it, so no data is copied.
+ - Otherwise, the destination is updated in place. Entries that are not in the source are removed.
+   Files with the same size and modification date, or the same size and SHA-256, are left alone.
+   Other files are cloned, or copied in parallel chunks when cloning is unsupported.
+   Files are written to a temporary name and renamed into place.
+
+ Merging updates the destination in the same way, but leaves entries that are not in the source in place.
+
+ Hashes of source files are remembered by path, size and modification date.
+ This means that pushing the same source to many destinations only hashes the source once.
+ */
+@interface FBFileCopier : NSObject
+
+/**
+ Makes the destination identical to the source.
+
+ @param sourcePath the file or directory to copy.
+ @param destinationPath the path to copy to. The parent directory must exist.
+ @param error an error out for any error that occurs.
+ @return the statistics of the copy on success, nil otherwise.
+ */
++ (nullable FBFileCopyStatistics *)synchronizeItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)error;
+
+/**
+ Copies the source into the destination, without removing entries of the destination that are not in the source.
+ Entries that are in both are updated as when synchronizing.
+
+ @param sourcePath the file or directory to copy.
+ @param destinationPath the path to copy to. The parent directory must exist.
+ @param error an error out for any error that occurs.
+ @return the statistics of the copy on success, nil otherwise.
+ */
++ (nullable FBFileCopyStatistics *)mergeItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)error;
+
+/**
+ Makes the destination identical to the source, asynchronously.
+
+ @param queue the queue to perform the copy on.
+ @param sourcePath the file or directory to copy.
+ @param destinationPath the path to copy to. The parent directory must exist.
+ @return A Future that resolves with the statistics of the copy.
+ */
++ (FBFuture<FBFileCopyStatistics *> *)onQueue:(dispatch_queue_t)queue synchronizeItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,447 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBFileCopier.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <sys/clonefile.h>
+#import <sys/stat.h>
+#import <sys/time.h>
+
+#import "FBControlCoreError.h"
+
+static const off_t FBFileCopierChunkSize = 8 * 1024 * 1024;
+static const size_t FBFileCopierHashBufferSize = 1024 * 1024;
+
+// Modification dates are written with utimes(2), so are only compared to the microsecond.
+static BOOL FBFileCopierModificationTimesEqual(struct timespec left, struct timespec right)
+{
+  return left.tv_sec == right.tv_sec && left.tv_nsec / 1000 == right.tv_nsec / 1000;
+}
+
+static BOOL FBFileCopierClone(NSString *sourcePath, NSString *destinationPath)
+{
+  if (@available(macOS 10.12, *)) {
+    return clonefile(sourcePath.fileSystemRepresentation, destinationPath.fileSystemRepresentation, CLONE_NOFOLLOW) == 0;
+  }
+  return NO;
+}
+
+@interface FBFileCopyStatistics ()
+
+@property (atomic, assign, readwrite) NSUInteger filesCloned;
+@property (atomic, assign, readwrite) NSUInteger filesCopied;
+@property (atomic, assign, readwrite) NSUInteger filesSkipped;
+@property (atomic, assign, readwrite) unsigned long long bytesCopied;
+
+@end
+
+@implementation FBFileCopyStatistics
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:
+    @"Cloned %lu | Copied %lu (%llu bytes) | Skipped %lu",
+    (unsigned long) self.filesCloned,
+    (unsigned long) self.filesCopied,
+    self.bytesCopied,
+    (unsigned long) self.filesSkipped
+  ];
+}
+
+@end
+
+@interface FBFileCopier_File : NSObject
+
+@property (nonatomic, copy, readonly) NSString *sourcePath;
+@property (nonatomic, copy, readonly) NSString *destinationPath;
+@property (nonatomic, assign, readonly) off_t size;
+@property (nonatomic, assign, readonly) mode_t mode;
+@property (nonatomic, assign, readonly) struct timespec modificationTime;
+
+@end
+
+@implementation FBFileCopier_File
+
+- (instancetype)initWithSourcePath:(NSString *)sourcePath destinationPath:(NSString *)destinationPath stat:(const struct stat *)sourceStat
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _sourcePath = sourcePath;
+  _destinationPath = destinationPath;
+  _size = sourceStat->st_size;
+  _mode = sourceStat->st_mode & 07777;
+  _modificationTime = sourceStat->st_mtimespec;
+
+  return self;
+}
+
+@end
+
+@implementation FBFileCopier
+
+#pragma mark Public
+
++ (nullable FBFileCopyStatistics *)synchronizeItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)error
+{
+  return [self copyItemAtPath:sourcePath toPath:destinationPath removeExtraneous:YES error:error];
+}
+
++ (nullable FBFileCopyStatistics *)mergeItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)error
+{
+  return [self copyItemAtPath:sourcePath toPath:destinationPath removeExtraneous:NO error:error];
+}
+
++ (FBFuture<FBFileCopyStatistics *> *)onQueue:(dispatch_queue_t)queue synchronizeItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath
+{
+  return [FBFuture onQueue:queue resolve:^{
+    NSError *error = nil;
+    FBFileCopyStatistics *statistics = [FBFileCopier synchronizeItemAtPath:sourcePath toPath:destinationPath error:&error];
+    if (!statistics) {
+      return [FBFuture futureWithError:error];
+    }
+    return [FBFuture futureWithResult:statistics];
+  }];
+}
+
+#pragma mark Copying
+
++ (nullable FBFileCopyStatistics *)copyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath removeExtraneous:(BOOL)removeExtraneous error:(NSError **)error
+{
+  FBFileCopyStatistics *statistics = [FBFileCopyStatistics new];
+  struct stat sourceStat;
+  if (lstat(sourcePath.fileSystemRepresentation, &sourceStat) != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Could not stat %@: %s", sourcePath, strerror(errno)]
+      fail:error];
+  }
+
+  // When there is nothing to update, the whole tree can be cloned in one operation.
+  struct stat destinationStat;
+  if (lstat(destinationPath.fileSystemRepresentation, &destinationStat) != 0 && FBFileCopierClone(sourcePath, destinationPath)) {
+    statistics.filesCloned = 1;
+    return statistics;
+  }
+
+  NSMutableArray<FBFileCopier_File *> *files = [NSMutableArray array];
+  if (![self mirrorItemAtPath:sourcePath stat:&sourceStat toPath:destinationPath removeExtraneous:removeExtraneous files:files error:error]) {
+    return nil;
+  }
+
+  // The contents of files are independent, so are synchronized concurrently.
+  __block NSError *firstError = nil;
+  dispatch_apply(files.count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t index) {
+    NSError *fileError = nil;
+    if ([self synchronizeFile:files[index] statistics:statistics error:&fileError]) {
+      return;
+    }
+    @synchronized (files) {
+      if (!firstError) {
+        firstError = fileError;
+      }
+    }
+  });
+  if (firstError) {
+    return [FBControlCoreError failWithError:firstError errorOut:error];
+  }
+  return statistics;
+}
+
+#pragma mark Mirroring the Tree
+
++ (BOOL)mirrorItemAtPath:(NSString *)sourcePath stat:(const struct stat *)sourceStat toPath:(NSString *)destinationPath removeExtraneous:(BOOL)removeExtraneous files:(NSMutableArray<FBFileCopier_File *> *)files error:(NSError **)error
+{
+  struct stat destinationStat;
+  BOOL destinationExists = lstat(destinationPath.fileSystemRepresentation, &destinationStat) == 0;
+  mode_t sourceType = sourceStat->st_mode & S_IFMT;
+  if (destinationExists && (destinationStat.st_mode & S_IFMT) != sourceType) {
+    if (![NSFileManager.defaultManager removeItemAtPath:destinationPath error:error]) {
+      return NO;
+    }
+    destinationExists = NO;
+  }
+
+  switch (sourceType) {
+    case S_IFDIR:
+      return [self mirrorDirectoryAtPath:sourcePath stat:sourceStat toPath:destinationPath destinationExists:destinationExists removeExtraneous:removeExtraneous files:files error:error];
+    case S_IFLNK:
+      return [self mirrorSymbolicLinkAtPath:sourcePath toPath:destinationPath destinationExists:destinationExists error:error];
+    case S_IFREG:
+      [files addObject:[[FBFileCopier_File alloc] initWithSourcePath:sourcePath destinationPath:destinationPath stat:sourceStat]];
+      return YES;
+    default:
+      // Sockets, fifos and devices are not copied.
+      return YES;
+  }
+}
+
++ (BOOL)mirrorDirectoryAtPath:(NSString *)sourcePath stat:(const struct stat *)sourceStat toPath:(NSString *)destinationPath destinationExists:(BOOL)destinationExists removeExtraneous:(BOOL)removeExtraneous files:(NSMutableArray<FBFileCopier_File *> *)files error:(NSError **)error
+{
+  if (!destinationExists && mkdir(destinationPath.fileSystemRepresentation, (sourceStat->st_mode & 07777) | S_IRWXU) != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Could not create directory %@: %s", destinationPath, strerror(errno)]
+      failBool:error];
+  }
+  NSArray<NSString *> *sourceEntries = [NSFileManager.defaultManager contentsOfDirectoryAtPath:sourcePath error:error];
+  if (!sourceEntries) {
+    return NO;
+  }
+  if (destinationExists && removeExtraneous) {
+    NSArray<NSString *> *destinationEntries = [NSFileManager.defaultManager contentsOfDirectoryAtPath:destinationPath error:error];
+    if (!destinationEntries) {
+      return NO;
+    }
+    NSSet<NSString *> *sourceNames = [NSSet setWithArray:sourceEntries];
+    for (NSString *name in destinationEntries) {
+      if ([sourceNames containsObject:name]) {
+        continue;
+      }
+      if (![NSFileManager.defaultManager removeItemAtPath:[destinationPath stringByAppendingPathComponent:name] error:error]) {
+        return NO;
+      }
+    }
+  }
+  for (NSString *name in sourceEntries) {
+    NSString *sourceChild = [sourcePath stringByAppendingPathComponent:name];
+    struct stat childStat;
+    if (lstat(sourceChild.fileSystemRepresentation, &childStat) != 0) {
+      return [[FBControlCoreError
+        describeFormat:@"Could not stat %@: %s", sourceChild, strerror(errno)]
+        failBool:error];
+    }
+    if (![self mirrorItemAtPath:sourceChild stat:&childStat toPath:[destinationPath stringByAppendingPathComponent:name] removeExtraneous:removeExtraneous files:files error:error]) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
++ (BOOL)mirrorSymbolicLinkAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath destinationExists:(BOOL)destinationExists error:(NSError **)error
+{
+  NSString *target = [NSFileManager.defaultManager destinationOfSymbolicLinkAtPath:sourcePath error:error];
+  if (!target) {
+    return NO;
+  }
+  if (destinationExists) {
+    if ([[NSFileManager.defaultManager destinationOfSymbolicLinkAtPath:destinationPath error:nil] isEqualToString:target]) {
+      return YES;
+    }
+    if (![NSFileManager.defaultManager removeItemAtPath:destinationPath error:error]) {
+      return NO;
+    }
+  }
+  if (symlink(target.fileSystemRepresentation, destinationPath.fileSystemRepresentation) != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Could not create symbolic link %@: %s", destinationPath, strerror(errno)]
+      failBool:error];
+  }
+  return YES;
+}
+
+#pragma mark Synchronizing Files
+
++ (BOOL)synchronizeFile:(FBFileCopier_File *)file statistics:(FBFileCopyStatistics *)statistics error:(NSError **)error
+{
+  if ([self destinationIsUpToDate:file]) {
+    @synchronized (statistics) {
+      statistics.filesSkipped++;
+    }
+    return YES;
+  }
+
+  // Writing to a temporary file, then renaming, means that the destination is never partially written.
+  NSString *temporaryPath = [file.destinationPath.stringByDeletingLastPathComponent stringByAppendingPathComponent:[NSString stringWithFormat:@".%@.%@", file.destinationPath.lastPathComponent, NSUUID.UUID.UUIDString]];
+  BOOL cloned = FBFileCopierClone(file.sourcePath, temporaryPath);
+  if (!cloned && ![self copyContentsOfFile:file toPath:temporaryPath error:error]) {
+    unlink(temporaryPath.fileSystemRepresentation);
+    return NO;
+  }
+  if (![self setAttributesOfFile:file atPath:temporaryPath error:error]) {
+    unlink(temporaryPath.fileSystemRepresentation);
+    return NO;
+  }
+  if (rename(temporaryPath.fileSystemRepresentation, file.destinationPath.fileSystemRepresentation) != 0) {
+    unlink(temporaryPath.fileSystemRepresentation);
+    return [[FBControlCoreError
+      describeFormat:@"Could not move %@ to %@: %s", temporaryPath, file.destinationPath, strerror(errno)]
+      failBool:error];
+  }
+  @synchronized (statistics) {
+    if (cloned) {
+      statistics.filesCloned++;
+    } else {
+      statistics.filesCopied++;
+      statistics.bytesCopied += (unsigned long long) file.size;
+    }
+  }
+  return YES;
+}
+
++ (BOOL)destinationIsUpToDate:(FBFileCopier_File *)file
+{
+  struct stat destinationStat;
+  if (lstat(file.destinationPath.fileSystemRepresentation, &destinationStat) != 0 || !S_ISREG(destinationStat.st_mode) || destinationStat.st_size != file.size) {
+    return NO;
+  }
+  if (FBFileCopierModificationTimesEqual(destinationStat.st_mtimespec, file.modificationTime)) {
+    return YES;
+  }
+  // The file may have been re-generated with the same contents, in which case only the attributes are updated.
+  NSData *sourceHash = [self sourceHashOfFile:file];
+  NSData *destinationHash = [self hashOfFileAtPath:file.destinationPath];
+  if (!sourceHash || ![sourceHash isEqualToData:destinationHash]) {
+    return NO;
+  }
+  return [self setAttributesOfFile:file atPath:file.destinationPath error:nil];
+}
+
++ (BOOL)copyContentsOfFile:(FBFileCopier_File *)file toPath:(NSString *)destinationPath error:(NSError **)error
+{
+  int sourceDescriptor = open(file.sourcePath.fileSystemRepresentation, O_RDONLY);
+  if (sourceDescriptor < 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Could not open %@: %s", file.sourcePath, strerror(errno)]
+      failBool:error];
+  }
+  int destinationDescriptor = open(destinationPath.fileSystemRepresentation, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (destinationDescriptor < 0) {
+    close(sourceDescriptor);
+    return [[FBControlCoreError
+      describeFormat:@"Could not create %@: %s", destinationPath, strerror(errno)]
+      failBool:error];
+  }
+
+  // Large files are copied as chunks at independent offsets, so the chunks are copied concurrently.
+  off_t size = file.size;
+  size_t chunkCount = (size_t) ((size + FBFileCopierChunkSize - 1) / FBFileCopierChunkSize);
+  __block int failure = ftruncate(destinationDescriptor, size) == 0 ? 0 : errno;
+  NSObject *failureLock = [NSObject new];
+  void (^copyChunk)(size_t) = ^(size_t index) {
+    off_t offset = (off_t) index * FBFileCopierChunkSize;
+    off_t end = MIN(offset + FBFileCopierChunkSize, size);
+    size_t bufferSize = (size_t) MIN(FBFileCopierChunkSize, (off_t) FBFileCopierHashBufferSize);
+    void *buffer = malloc(bufferSize);
+    int chunkFailure = 0;
+    while (offset < end) {
+      ssize_t readLength = pread(sourceDescriptor, buffer, (size_t) MIN((off_t) bufferSize, end - offset), offset);
+      if (readLength <= 0) {
+        chunkFailure = readLength == 0 ? EIO : errno;
+        break;
+      }
+      ssize_t written = 0;
+      while (written < readLength) {
+        ssize_t result = pwrite(destinationDescriptor, (uint8_t *) buffer + written, (size_t) (readLength - written), offset + written);
+        if (result < 0) {
+          chunkFailure = errno;
+          break;
+        }
+        written += result;
+      }
+      if (written < readLength) {
+        break;
+      }
+      offset += readLength;
+    }
+    free(buffer);
+    if (chunkFailure == 0) {
+      return;
+    }
+    // Chunks fail independently, the first failure is reported.
+    @synchronized (failureLock) {
+      if (failure == 0) {
+        failure = chunkFailure;
+      }
+    }
+  };
+  if (failure == 0 && chunkCount == 1) {
+    copyChunk(0);
+  } else if (failure == 0 && chunkCount > 1) {
+    dispatch_apply(chunkCount, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), copyChunk);
+  }
+  close(sourceDescriptor);
+  if (close(destinationDescriptor) != 0 && failure == 0) {
+    failure = errno;
+  }
+  if (failure != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Could not copy %@ to %@: %s", file.sourcePath, destinationPath, strerror(failure)]
+      failBool:error];
+  }
+  return YES;
+}
+
++ (BOOL)setAttributesOfFile:(FBFileCopier_File *)file atPath:(NSString *)path error:(NSError **)error
+{
+  struct timespec modificationTime = file.modificationTime;
+  struct timeval times[2] = {
+    {.tv_sec = modificationTime.tv_sec, .tv_usec = (suseconds_t) (modificationTime.tv_nsec / 1000)},
+    {.tv_sec = modificationTime.tv_sec, .tv_usec = (suseconds_t) (modificationTime.tv_nsec / 1000)},
+  };
+  if (chmod(path.fileSystemRepresentation, file.mode) != 0 || utimes(path.fileSystemRepresentation, times) != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Could not set attributes of %@: %s", path, strerror(errno)]
+      failBool:error];
+  }
+  return YES;
+}
+
+#pragma mark Hashing
+
++ (NSCache<NSString *, NSArray<id> *> *)sourceHashes
+{
+  static dispatch_once_t onceToken;
+  static NSCache<NSString *, NSArray<id> *> *cache;
+  dispatch_once(&onceToken, ^{
+    cache = [NSCache new];
+  });
+  return cache;
+}
+
++ (nullable NSData *)sourceHashOfFile:(FBFileCopier_File *)file
+{
+  // Entries are only valid for the same size and modification date of the source.
+  NSArray<id> *key = @[@(file.size), @(file.modificationTime.tv_sec), @(file.modificationTime.tv_nsec)];
+  NSArray<id> *entry = [self.sourceHashes objectForKey:file.sourcePath];
+  if ([[entry subarrayWithRange:NSMakeRange(0, key.count)] isEqualToArray:key]) {
+    return entry.lastObject;
+  }
+  NSData *hash = [self hashOfFileAtPath:file.sourcePath];
+  if (hash) {
+    [self.sourceHashes setObject:[key arrayByAddingObject:hash] forKey:file.sourcePath];
+  }
+  return hash;
+}
+
++ (nullable NSData *)hashOfFileAtPath:(NSString *)path
+{
+  int descriptor = open(path.fileSystemRepresentation, O_RDONLY);
+  if (descriptor < 0) {
+    return nil;
+  }
+  CC_SHA256_CTX context;
+  CC_SHA256_Init(&context);
+  void *buffer = malloc(FBFileCopierHashBufferSize);
+  ssize_t length = 0;
+  while ((length = read(descriptor, buffer, FBFileCopierHashBufferSize)) > 0) {
+    CC_SHA256_Update(&context, buffer, (CC_LONG) length);
+  }
+  free(buffer);
+  close(descriptor);
+  if (length < 0) {
+    return nil;
+  }
+  NSMutableData *digest = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+  CC_SHA256_Final(digest.mutableBytes, &context);
+  return digest;
+}
+
+@end
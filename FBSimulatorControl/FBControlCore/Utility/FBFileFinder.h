@@ -9,10 +9,23 @@
 
 #import <Foundation/Foundation.h>
 
+#import <FBControlCore/FBFuture.h>
+
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ A block that is called with the path of each file that is found.
+ */
+typedef void (^FBFileFinderMatchHandler)(NSString *path);
+
 /**
  Utility methods for files.
+
+ Directories are walked by multiple threads, with each directory read by readdir(3).
+ Globs are compiled once per search, rather than per directory.
+ A glob without a leading '/' matches the trailing components of a path at any depth.
+ A glob with a leading '/' is anchored to the searched directory, so subtrees that cannot match an anchored glob are not walked.
+ Symbolic links to files are matched, symbolic links to directories are not followed.
  */
 @interface FBFileFinder : NSObject
 
@@ -34,6 +47,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (NSArray<NSString *> *)recursiveFindByFilenameGlobs:(NSArray<NSString *> *)filenameGlobs inDirectory:(NSString *)directory;
 
+/**
+ Recursively searches the provided directory with provided filename globs, reporting each file as soon as it is found.
+
+ @param queue the queue to call the handler on.
+ @param filenameGlobs the filename globs to search for. Must not be nil.
+ @param directory the directory to search from. Must not be nil.
+ @param handler the handler to call with each found file.
+ @return a Future that resolves when the search is complete, and the handler has been called for all found files.
+ */
++ (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue findByFilenameGlobs:(NSArray<NSString *> *)filenameGlobs inDirectory:(NSString *)directory handler:(FBFileFinderMatchHandler)handler;
+
 /**
  Recursively searches the provided directory, finding the most recent files with the provided filenames.
 
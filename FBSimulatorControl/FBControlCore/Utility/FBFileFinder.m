@@ -9,83 +9,380 @@
 
 #import "FBFileFinder.h"
 
-#include <glob.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
 
-@implementation FBFileFinder
+#import "FBFuture.h"
 
-+ (NSArray<NSString *> *)recursiveFindFiles:(NSArray<NSString *> *)filenames inDirectory:(NSString *)directory
+typedef NS_ENUM(NSUInteger, FBFileFinderPatternKind) {
+  FBFileFinderPatternKindLiteral = 0,
+  FBFileFinderPatternKindAny = 1,
+  FBFileFinderPatternKindPrefix = 2,
+  FBFileFinderPatternKindSuffix = 3,
+  FBFileFinderPatternKindGeneral = 4,
+};
+
+/**
+ A single path component of a glob, compiled into the cheapest matcher that is equivalent to fnmatch(3).
+ */
+@interface FBFileFinder_Pattern : NSObject
+
+@property (nonatomic, assign, readonly) FBFileFinderPatternKind kind;
+@property (nonatomic, copy, readonly) NSData *bytes;
+@property (nonatomic, assign, readonly) BOOL matchesLeadingPeriod;
+
+@end
+
+@implementation FBFileFinder_Pattern
+
++ (instancetype)literal:(NSString *)literal
 {
-  NSParameterAssert(filenames);
-  NSParameterAssert(directory);
+  return [[self alloc] initWithKind:FBFileFinderPatternKindLiteral string:literal];
+}
 
-  BOOL isDirectory = NO;
-  if (![NSFileManager.defaultManager fileExistsAtPath:directory isDirectory:&isDirectory]) {
-    return @[];
++ (instancetype)compile:(NSString *)component
+{
+  NSCharacterSet *metacharacters = [NSCharacterSet characterSetWithCharactersInString:@"*?[\\"];
+  if ([component rangeOfCharacterFromSet:metacharacters].location == NSNotFound) {
+    return [[self alloc] initWithKind:FBFileFinderPatternKindLiteral string:component];
   }
-  if (!isDirectory) {
-    return @[];
+  if ([component isEqualToString:@"*"]) {
+    return [[self alloc] initWithKind:FBFileFinderPatternKindAny string:@""];
+  }
+  NSString *inner = [component substringWithRange:NSMakeRange(1, component.length - 1)];
+  if ([component hasPrefix:@"*"] && [inner rangeOfCharacterFromSet:metacharacters].location == NSNotFound) {
+    return [[self alloc] initWithKind:FBFileFinderPatternKindSuffix string:inner];
+  }
+  inner = [component substringToIndex:component.length - 1];
+  if ([component hasSuffix:@"*"] && [inner rangeOfCharacterFromSet:metacharacters].location == NSNotFound) {
+    return [[self alloc] initWithKind:FBFileFinderPatternKindPrefix string:inner];
   }
+  return [[self alloc] initWithKind:FBFileFinderPatternKindGeneral string:component];
+}
+
+- (instancetype)initWithKind:(FBFileFinderPatternKind)kind string:(NSString *)string
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _kind = kind;
+  // The General kind is passed to fnmatch, so is NUL-terminated.
+  NSMutableData *bytes = [[string dataUsingEncoding:NSUTF8StringEncoding] mutableCopy];
+  if (kind == FBFileFinderPatternKindGeneral) {
+    [bytes appendBytes:"\0" length:1];
+  }
+  _bytes = [bytes copy];
+  // Like glob(3), a wildcard at the start of a pattern does not match a leading period.
+  // fnmatch is passed FNM_PERIOD for the General kind.
+  _matchesLeadingPeriod = kind == FBFileFinderPatternKindLiteral || kind == FBFileFinderPatternKindGeneral || (kind == FBFileFinderPatternKindPrefix && [string hasPrefix:@"."]);
+
+  return self;
+}
+
+- (BOOL)matchesName:(const char *)name length:(size_t)length
+{
+  const char *bytes = self.bytes.bytes;
+  size_t bytesLength = self.bytes.length;
+  if (name[0] == '.' && !self.matchesLeadingPeriod) {
+    return NO;
+  }
+  switch (self.kind) {
+    case FBFileFinderPatternKindLiteral:
+      return length == bytesLength && memcmp(name, bytes, length) == 0;
+    case FBFileFinderPatternKindAny:
+      return YES;
+    case FBFileFinderPatternKindPrefix:
+      return length >= bytesLength && memcmp(name, bytes, bytesLength) == 0;
+    case FBFileFinderPatternKindSuffix:
+      return length >= bytesLength && memcmp(name + length - bytesLength, bytes, bytesLength) == 0;
+    case FBFileFinderPatternKindGeneral:
+      return fnmatch(bytes, name, FNM_PERIOD) == 0;
+  }
+  return NO;
+}
+
+@end
+
+/**
+ A glob, compiled into one pattern per path component.
+ */
+@interface FBFileFinder_Glob : NSObject
 
-  NSSet *filenameSet = [NSSet setWithArray:filenames];
-  NSMutableSet *foundFiles = [NSMutableSet set];
-  NSString *currentFile = nil;
-  NSDirectoryEnumerator *enumerator = [NSFileManager.defaultManager enumeratorAtPath:directory];
+@property (nonatomic, copy, readonly) NSArray<FBFileFinder_Pattern *> *components;
+@property (nonatomic, assign, readonly) BOOL anchored;
 
-  while ((currentFile = enumerator.nextObject)) {
-    if (![filenameSet containsObject:currentFile.lastPathComponent]) {
+@end
+
+@implementation FBFileFinder_Glob
+
++ (instancetype)compile:(NSString *)glob
+{
+  NSMutableArray<FBFileFinder_Pattern *> *components = [NSMutableArray array];
+  for (NSString *component in [glob componentsSeparatedByString:@"/"]) {
+    if (component.length == 0 || [component isEqualToString:@"."]) {
       continue;
     }
-    [foundFiles addObject:[directory stringByAppendingPathComponent:currentFile]];
+    [components addObject:[FBFileFinder_Pattern compile:component]];
   }
-  return [foundFiles allObjects];
+  return [[self alloc] initWithComponents:components anchored:[glob hasPrefix:@"/"]];
 }
 
-+ (NSArray<NSString *> *)recursiveFindByFilenameGlobs:(NSArray<NSString *> *)filenameGlobs inDirectory:(NSString *)directory
++ (instancetype)filename:(NSString *)filename
 {
-  NSParameterAssert(filenameGlobs);
-  NSParameterAssert(directory);
+  return [[self alloc] initWithComponents:@[[FBFileFinder_Pattern literal:filename]] anchored:NO];
+}
 
-  BOOL isDirectory = NO;
-  if (![NSFileManager.defaultManager fileExistsAtPath:directory isDirectory:&isDirectory]) {
-    return @[];
+- (instancetype)initWithComponents:(NSArray<FBFileFinder_Pattern *> *)components anchored:(BOOL)anchored
+{
+  self = [super init];
+  if (!self) {
+    return nil;
   }
-  if (!isDirectory) {
-    return @[];
+
+  _components = components;
+  _anchored = anchored;
+
+  return self;
+}
+
+- (BOOL)matchesName:(const char *)name length:(size_t)length directoryComponents:(NSArray<NSData *> *)directoryComponents
+{
+  NSUInteger count = self.components.count;
+  NSUInteger depth = directoryComponents.count;
+  if (count == 0 || count > depth + 1 || (self.anchored && count != depth + 1)) {
+    return NO;
+  }
+  if (![self.components.lastObject matchesName:name length:length]) {
+    return NO;
   }
+  // Match the remaining components against the trailing directory components.
+  for (NSUInteger index = 1; index < count; index++) {
+    NSData *directoryName = directoryComponents[depth - index];
+    if (![self.components[count - 1 - index] matchesName:directoryName.bytes length:directoryName.length - 1]) {
+      return NO;
+    }
+  }
+  return YES;
+}
 
-  NSMutableArray<NSString *> *foundFiles = [NSMutableArray array];
+- (BOOL)canMatchBelowDirectoryComponents:(NSArray<NSData *> *)directoryComponents
+{
+  if (!self.anchored) {
+    return YES;
+  }
+  NSUInteger depth = directoryComponents.count;
+  if (self.components.count <= depth) {
+    return NO;
+  }
+  for (NSUInteger index = 0; index < depth; index++) {
+    NSData *directoryName = directoryComponents[index];
+    if (![self.components[index] matchesName:directoryName.bytes length:directoryName.length - 1]) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+@end
+
+/**
+ Walks a directory tree, reading each directory in a separate work item on a concurrent queue.
+ The names of the directories above an entry are kept as NUL-terminated file system representations, so that they are only converted once per directory.
+ */
+@interface FBFileFinder_Walker : NSObject
+
+@property (nonatomic, copy, readonly) NSArray<FBFileFinder_Glob *> *globs;
+@property (nonatomic, assign, readonly) BOOL matchesDirectories;
+@property (nonatomic, copy, readonly) FBFileFinderMatchHandler handler;
+@property (nonatomic, strong, readonly) dispatch_group_t group;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+
+@end
 
-  NSArray<NSString *> *subdirectories = [[NSFileManager defaultManager] subpathsOfDirectoryAtPath:directory error:nil];
-  NSEnumerator *dirsEnumerator = [subdirectories objectEnumerator];
-  NSString *subdirectory;
-  while (subdirectory = [dirsEnumerator nextObject]) {
-    NSString *fullDirectory = [directory stringByAppendingPathComponent:subdirectory];
-
-    for (NSString *filenameGlob in filenameGlobs) {
-      NSString *globPathComponent = [NSString stringWithFormat: @"/%@", filenameGlob];
-      const char *fullPattern = [[fullDirectory stringByAppendingPathComponent: globPathComponent] UTF8String];
-
-      glob_t gt;
-      if (glob(fullPattern, 0, NULL, &gt) == 0) {
-        for (int i = 0; i < gt.gl_matchc; i++) {
-          size_t len = strlen(gt.gl_pathv[i]);
-          NSString *filePath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:gt.gl_pathv[i] length:len];
-
-          if (![NSFileManager.defaultManager fileExistsAtPath:filePath isDirectory:&isDirectory]) {
-            continue;
-          }
-          if (isDirectory) {
-            continue; // Don't copy directory.
-          }
-
-          [foundFiles addObject:filePath];
-        }
+@implementation FBFileFinder_Walker
+
+- (instancetype)initWithGlobs:(NSArray<FBFileFinder_Glob *> *)globs matchesDirectories:(BOOL)matchesDirectories handler:(FBFileFinderMatchHandler)handler
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _globs = globs;
+  _matchesDirectories = matchesDirectories;
+  _handler = handler;
+  _group = dispatch_group_create();
+  _queue = dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+
+  return self;
+}
+
+- (BOOL)startWalkingDirectory:(NSString *)directory
+{
+  BOOL isDirectory = NO;
+  if (![NSFileManager.defaultManager fileExistsAtPath:directory isDirectory:&isDirectory] || !isDirectory) {
+    return NO;
+  }
+  dispatch_group_async(self.group, self.queue, ^{
+    [self walkDirectory:directory components:@[]];
+  });
+  return YES;
+}
+
+- (void)walkDirectory:(NSString *)directory components:(NSArray<NSData *> *)components
+{
+  DIR *handle = opendir(directory.fileSystemRepresentation);
+  if (!handle) {
+    return;
+  }
+  struct dirent *entry = NULL;
+  while ((entry = readdir(handle))) {
+    const char *name = entry->d_name;
+    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+      continue;
+    }
+    size_t length = strlen(name);
+    NSString *path = nil;
+    BOOL isDirectory = entry->d_type == DT_DIR;
+    BOOL isFile = entry->d_type == DT_REG;
+    // Only entries that the directory entry does not describe need a stat.
+    if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+      path = [directory stringByAppendingPathComponent:[NSFileManager.defaultManager stringWithFileSystemRepresentation:name length:length]];
+      struct stat status;
+      if (stat(path.fileSystemRepresentation, &status) != 0) {
+        continue;
+      }
+      isFile = S_ISREG(status.st_mode);
+      // Linked directories are matched, but not followed, so that cycles are not walked.
+      isDirectory = S_ISDIR(status.st_mode);
+      if (isDirectory && entry->d_type == DT_LNK) {
+        isDirectory = NO;
+        isFile = self.matchesDirectories;
       }
-      globfree(&gt);
+    }
+    if (isDirectory) {
+      [self visitDirectoryNamed:name length:length path:path parent:directory components:components];
+      continue;
+    }
+    if (!isFile || ![self matchesName:name length:length components:components]) {
+      continue;
+    }
+    self.handler(path ?: [directory stringByAppendingPathComponent:[NSFileManager.defaultManager stringWithFileSystemRepresentation:name length:length]]);
+  }
+  closedir(handle);
+}
+
+- (void)visitDirectoryNamed:(const char *)name length:(size_t)length path:(nullable NSString *)path parent:(NSString *)parent components:(NSArray<NSData *> *)components
+{
+  path = path ?: [parent stringByAppendingPathComponent:[NSFileManager.defaultManager stringWithFileSystemRepresentation:name length:length]];
+  if (self.matchesDirectories && [self matchesName:name length:length components:components]) {
+    self.handler(path);
+  }
+  NSArray<NSData *> *childComponents = [components arrayByAddingObject:[NSData dataWithBytes:name length:length + 1]];
+  if (![self canMatchBelowDirectoryComponents:childComponents]) {
+    return;
+  }
+  dispatch_group_async(self.group, self.queue, ^{
+    [self walkDirectory:path components:childComponents];
+  });
+}
+
+- (BOOL)matchesName:(const char *)name length:(size_t)length components:(NSArray<NSData *> *)components
+{
+  for (FBFileFinder_Glob *glob in self.globs) {
+    if ([glob matchesName:name length:length directoryComponents:components]) {
+      return YES;
     }
   }
+  return NO;
+}
+
+- (BOOL)canMatchBelowDirectoryComponents:(NSArray<NSData *> *)components
+{
+  for (FBFileFinder_Glob *glob in self.globs) {
+    if ([glob canMatchBelowDirectoryComponents:components]) {
+      return YES;
+    }
+  }
+  return NO;
+}
+
+@end
+
+@implementation FBFileFinder
+
+#pragma mark Private
+
++ (NSArray<FBFileFinder_Glob *> *)compileGlobs:(NSArray<NSString *> *)filenameGlobs
+{
+  NSMutableArray<FBFileFinder_Glob *> *globs = [NSMutableArray array];
+  for (NSString *filenameGlob in filenameGlobs) {
+    [globs addObject:[FBFileFinder_Glob compile:filenameGlob]];
+  }
+  return [globs copy];
+}
+
++ (NSArray<NSString *> *)synchronouslyWalkDirectory:(NSString *)directory globs:(NSArray<FBFileFinder_Glob *> *)globs matchesDirectories:(BOOL)matchesDirectories
+{
+  NSMutableArray<NSString *> *foundFiles = [NSMutableArray array];
+  FBFileFinder_Walker *walker = [[FBFileFinder_Walker alloc] initWithGlobs:globs matchesDirectories:matchesDirectories handler:^(NSString *path) {
+    @synchronized (foundFiles) {
+      [foundFiles addObject:path];
+    }
+  }];
+  if (![walker startWalkingDirectory:directory]) {
+    return @[];
+  }
+  dispatch_group_wait(walker.group, DISPATCH_TIME_FOREVER);
+  // The order that work items complete in is not stable, so sort for deterministic results.
+  return [foundFiles sortedArrayUsingSelector:@selector(compare:)];
+}
+
+#pragma mark Public
+
++ (NSArray<NSString *> *)recursiveFindFiles:(NSArray<NSString *> *)filenames inDirectory:(NSString *)directory
+{
+  NSParameterAssert(filenames);
+  NSParameterAssert(directory);
+
+  NSMutableArray<FBFileFinder_Glob *> *globs = [NSMutableArray array];
+  for (NSString *filename in [NSSet setWithArray:filenames]) {
+    [globs addObject:[FBFileFinder_Glob filename:filename]];
+  }
+  return [self synchronouslyWalkDirectory:directory globs:globs matchesDirectories:YES];
+}
+
++ (NSArray<NSString *> *)recursiveFindByFilenameGlobs:(NSArray<NSString *> *)filenameGlobs inDirectory:(NSString *)directory
+{
+  NSParameterAssert(filenameGlobs);
+  NSParameterAssert(directory);
+
+  return [self synchronouslyWalkDirectory:directory globs:[self compileGlobs:filenameGlobs] matchesDirectories:NO];
+}
+
++ (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue findByFilenameGlobs:(NSArray<NSString *> *)filenameGlobs inDirectory:(NSString *)directory handler:(FBFileFinderMatchHandler)handler
+{
+  NSParameterAssert(filenameGlobs);
+  NSParameterAssert(directory);
 
-  return [NSArray arrayWithArray:foundFiles];
+  FBMutableFuture<NSNull *> *future = [FBMutableFuture future];
+  dispatch_group_t handlerGroup = dispatch_group_create();
+  FBFileFinder_Walker *walker = [[FBFileFinder_Walker alloc] initWithGlobs:[self compileGlobs:filenameGlobs] matchesDirectories:NO handler:^(NSString *path) {
+    dispatch_group_async(handlerGroup, queue, ^{
+      handler(path);
+    });
+  }];
+  [walker startWalkingDirectory:directory];
+  // Resolve once the walk has finished, and every found file has been delivered.
+  dispatch_group_notify(walker.group, walker.queue, ^{
+    dispatch_group_notify(handlerGroup, queue, ^{
+      [future resolveWithResult:NSNull.null];
+    });
+  });
+  return future;
 }
 
 + (NSArray<NSString *> *)mostRecentFindFiles:(NSArray<NSString *> *)filenames inDirectory:(NSString *)directory
@@ -20,6 +20,7 @@ typedef NS_ENUM(NSUInteger, FBFileReaderState) {
 
 /**
  Reads a file in the background, forwarding to a consumer.
+ If the consumer conforms to FBDataConsumerBackpressure, reading pauses whenever the consumer has fallen behind, until it has drained.
  */
 @interface FBFileReader : NSObject
 
@@ -5,6 +5,8 @@
 #import "FBControlCoreError.h"
 #import "FBControlCoreLogger.h"
 
+static const size_t BackpressureReadLength = 64 * 1024;
+
 static NSString *StateStringFromState(FBFileReaderState state)
 {
   switch (state) {
@@ -27,6 +29,7 @@ static NSString *StateStringFromState(FBFileReaderState state)
 
 @property (nonatomic, copy, readonly) NSString *targeting;
 @property (nonatomic, strong, readonly) id<FBDispatchDataConsumer> consumer;
+@property (nonatomic, strong, nullable, readonly) id<FBDataConsumerBackpressure> backpressure;
 @property (nonatomic, strong, readonly) dispatch_queue_t readQueue;
 @property (nonatomic, strong, readonly) FBMutableFuture<NSNumber *> *ioChannelFinishedReadOperation;
 @property (nonatomic, strong, readonly) NSFileHandle *fileHandle;
@@ -34,9 +37,16 @@ static NSString *StateStringFromState(FBFileReaderState state)
 
 @property (atomic, assign, readwrite) FBFileReaderState state;
 @property (nonatomic, strong, nullable, readwrite) dispatch_io_t io;
+// Only read or written on the readQueue, which the read handlers, the drain notification and stopping all run on.
+@property (nonatomic, assign, readwrite) BOOL waitingForDrain;
 
 @end
 
+static id<FBDataConsumerBackpressure> BackpressureForConsumer(id consumer)
+{
+  return [consumer conformsToProtocol:@protocol(FBDataConsumerBackpressure)] ? consumer : nil;
+}
+
 @implementation FBFileReader
 
 #pragma mark Initializers
@@ -48,13 +58,14 @@ static NSString *StateStringFromState(FBFileReaderState state)
 
 + (instancetype)readerWithFileHandle:(NSFileHandle *)fileHandle consumer:(id<FBDataConsumer>)consumer logger:(nullable id<FBControlCoreLogger>)logger
 {
-  return [self dispatchDataReaderWithFileHandle:fileHandle consumer:[FBDataConsumerAdaptor dispatchDataConsumerForDataConsumer:consumer] logger:logger];
+  NSString *targeting = [NSString stringWithFormat:@"fd %d", fileHandle.fileDescriptor];
+  return [[self alloc] initWithFileHandle:fileHandle consumer:[FBDataConsumerAdaptor dispatchDataConsumerForDataConsumer:consumer] backpressure:BackpressureForConsumer(consumer) targeting:targeting queue:self.createQueue logger:logger];
 }
 
 + (instancetype)dispatchDataReaderWithFileHandle:(NSFileHandle *)fileHandle consumer:(id<FBDispatchDataConsumer>)consumer logger:(nullable id<FBControlCoreLogger>)logger
 {
   NSString *targeting = [NSString stringWithFormat:@"fd %d", fileHandle.fileDescriptor];
-  return [[self alloc] initWithFileHandle:fileHandle consumer:consumer targeting:targeting queue:self.createQueue logger:logger];
+  return [[self alloc] initWithFileHandle:fileHandle consumer:consumer backpressure:BackpressureForConsumer(consumer) targeting:targeting queue:self.createQueue logger:logger];
 }
 
 + (FBFuture<FBFileReader *> *)readerWithFilePath:(NSString *)filePath consumer:(id<FBDataConsumer>)consumer logger:(nullable id<FBControlCoreLogger>)logger
@@ -68,11 +79,11 @@ static NSString *StateStringFromState(FBFileReaderState state)
         fail:error];
     }
     NSFileHandle *fileHandle = [[NSFileHandle alloc] initWithFileDescriptor:fileDescriptor closeOnDealloc:YES];
-    return [[self alloc] initWithFileHandle:fileHandle consumer:[FBDataConsumerAdaptor dispatchDataConsumerForDataConsumer:consumer] targeting:filePath queue:queue logger:logger];
+    return [[self alloc] initWithFileHandle:fileHandle consumer:[FBDataConsumerAdaptor dispatchDataConsumerForDataConsumer:consumer] backpressure:BackpressureForConsumer(consumer) targeting:filePath queue:queue logger:logger];
   }];
 }
 
-- (instancetype)initWithFileHandle:(NSFileHandle *)fileHandle consumer:(id<FBDispatchDataConsumer>)consumer targeting:(NSString *)targeting queue:(dispatch_queue_t)queue logger:(nullable id<FBControlCoreLogger>)logger
+- (instancetype)initWithFileHandle:(NSFileHandle *)fileHandle consumer:(id<FBDispatchDataConsumer>)consumer backpressure:(nullable id<FBDataConsumerBackpressure>)backpressure targeting:(NSString *)targeting queue:(dispatch_queue_t)queue logger:(nullable id<FBControlCoreLogger>)logger
 {
   self = [super init];
   if (!self) {
@@ -81,6 +92,7 @@ static NSString *StateStringFromState(FBFileReaderState state)
 
   _fileHandle = fileHandle;
   _consumer = consumer;
+  _backpressure = backpressure;
   _targeting = targeting;
   _readQueue = queue;
   _ioChannelFinishedReadOperation = [FBMutableFuture futureWithNameFormat:@"IO Channel Read of %@", targeting];
@@ -155,21 +167,61 @@ static NSString *StateStringFromState(FBFileReaderState state)
 
   // Report partial results with as little as 1 byte read.
   dispatch_io_set_low_water(self.io, 1);
+  void (^readFinished)(int) = ^(int errorCode) {
+    readErrorCode = errorCode;
+    [self ioChannelHasFinishedReadOperation:fileHandle withErrorCode:errorCode];
+  };
+  self.state = FBFileReaderStateReading;
+  if (self.backpressure) {
+    [self readBoundedLengthFromChannel:self.io consumer:consumer readFinished:readFinished];
+    return [FBFuture futureWithResult:NSNull.null];
+  }
   dispatch_io_read(self.io, 0, SIZE_MAX, self.readQueue, ^(bool done, dispatch_data_t dispatchData, int errorCode) {
     if (dispatchData != NULL) {
       [consumer consumeData:dispatchData];
     }
     if (done) {
-      readErrorCode = errorCode;
-      [self ioChannelHasFinishedReadOperation:fileHandle withErrorCode:errorCode];
+      readFinished(errorCode);
     }
   });
-  self.state = FBFileReaderStateReading;
   return [FBFuture futureWithResult:NSNull.null];
 }
 
+- (void)readBoundedLengthFromChannel:(dispatch_io_t)io consumer:(id<FBDispatchDataConsumer>)consumer readFinished:(void (^)(int))readFinished
+{
+  // A single unbounded read will keep delivering data however far behind the consumer is.
+  // Instead, read a bounded length at a time and only read the next once the consumer has drained.
+  // The read handler and drain notification run on the readQueue, the same queue that stopping runs on.
+  __block size_t lengthRead = 0;
+  dispatch_io_read(io, 0, BackpressureReadLength, self.readQueue, ^(bool done, dispatch_data_t dispatchData, int errorCode) {
+    if (dispatchData != NULL) {
+      lengthRead += dispatch_data_get_size(dispatchData);
+      [consumer consumeData:dispatchData];
+    }
+    if (!done) {
+      return;
+    }
+    // A read may finish short of the requested length without being at the end-of-file, so only a read of no data is the end-of-file.
+    // Reading may also have been stopped during the read.
+    if (errorCode != 0 || lengthRead == 0 || self.state != FBFileReaderStateReading) {
+      readFinished(errorCode);
+      return;
+    }
+    self.waitingForDrain = YES;
+    [self.backpressure.drained onQueue:self.readQueue notifyOfCompletion:^(FBFuture *_) {
+      // Reading may have been stopped whilst waiting.
+      if (!self.waitingForDrain) {
+        return;
+      }
+      self.waitingForDrain = NO;
+      [self readBoundedLengthFromChannel:io consumer:consumer readFinished:readFinished];
+    }];
+  });
+}
+
 - (FBFuture<NSNumber *> *)stopReadingNow
 {
+  // Called on the readQueue, so is serialized with the read handlers.
   // The only error condition is that we haven't yet started reading
   if (self.state == FBFileReaderStateNotStarted) {
     return [[FBControlCoreError
@@ -181,6 +233,13 @@ static NSString *StateStringFromState(FBFileReaderState state)
     return self.ioChannelFinishedReadOperation;
   }
 
+  // When waiting for the consumer to drain there is no read operation to be interrupted, so finish now.
+  if (self.waitingForDrain) {
+    self.waitingForDrain = NO;
+    dispatch_io_close(self.io, DISPATCH_IO_STOP);
+    return [self ioChannelHasFinishedReadOperation:self.fileHandle withErrorCode:ECANCELED];
+  }
+
   // dispatch_io_close will stop future reads of the io channel.
   // However, it does not mean that the dispatch_io_read callback will recieve further calls.
   // The true arbiter of whether we have reached the end of a read operation is 'done' being set in dispatch_io_read.
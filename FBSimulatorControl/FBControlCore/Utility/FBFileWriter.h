@@ -13,6 +13,24 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ What a bounded writer does with data when the pending bytes are above the high water mark.
+ */
+typedef NS_ENUM(NSUInteger, FBFileWriterOverflowPolicy) {
+  FBFileWriterOverflowPolicyBuffer = 0, /** All data is buffered, producers should wait on the drained future **/
+  FBFileWriterOverflowPolicyDropNewest = 1, /** Data that arrives whilst above the high water mark is discarded **/
+  FBFileWriterOverflowPolicyCoalesce = 2, /** Data that arrives during a write is coalesced into the next write, discarding the oldest whole chunks of unwritten data above the high water mark **/
+};
+
+/**
+ The limits of a bounded writer.
+ */
+typedef struct {
+  NSUInteger highWaterMark;
+  NSUInteger lowWaterMark;
+  FBFileWriterOverflowPolicy overflowPolicy;
+} FBFileWriterBackpressureConfiguration;
+
 /**
  A Data Consumer that writes out to a file or file descriptor.
  The dual of FBFileReader.
@@ -47,6 +65,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (nullable id<FBDataConsumer, FBDataConsumerLifecycle>)asyncWriterWithFileHandle:(NSFileHandle *)fileHandle error:(NSError **)error;
 
+/**
+ Creates a non-blocking Data Consumer from a file handle, that bounds the amount of data that is waiting to be written.
+ The file handle will be closed when and end-of-file is sent.
+
+ @param fileHandle the file handle to write to.
+ @param configuration the water marks and overflow policy.
+ @param error an error out for any error that occurs.
+ @return a data consumer on success, nil otherwise.
+ */
++ (nullable id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerBackpressure>)boundedAsyncWriterWithFileHandle:(NSFileHandle *)fileHandle configuration:(FBFileWriterBackpressureConfiguration)configuration error:(NSError **)error;
+
 /**
  Creates a non-blocking Dispatch Data Consumer from a file Handle.
 
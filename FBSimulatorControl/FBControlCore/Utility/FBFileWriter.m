@@ -39,6 +39,19 @@
 
 @end
 
+@interface FBFileWriter_Bounded : FBFileWriter_Async <FBDataConsumerBackpressure>
+
+@property (nonatomic, assign, readonly) FBFileWriterBackpressureConfiguration configuration;
+@property (nonatomic, strong, nullable, readwrite) FBMutableFuture<NSNull *> *drainedMutable;
+@property (nonatomic, strong, nullable, readwrite) FBMutableFuture<NSNull *> *flushedMutable;
+@property (nonatomic, strong, readonly) NSMutableArray<dispatch_data_t> *coalescedChunks;
+@property (nonatomic, assign, readwrite) NSUInteger coalescedSize;
+@property (nonatomic, assign, readwrite) BOOL writeInFlight;
+
+- (instancetype)initWithFileHandle:(NSFileHandle *)fileHandle writeQueue:(dispatch_queue_t)writeQueue configuration:(FBFileWriterBackpressureConfiguration)configuration;
+
+@end
+
 @implementation FBFileWriter
 
 #pragma mark Initializers
@@ -97,6 +110,17 @@
   return [self asyncWriterWithFileHandle:fileHandle queue:queue error:error];
 }
 
++ (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerBackpressure>)boundedAsyncWriterWithFileHandle:(NSFileHandle *)fileHandle configuration:(FBFileWriterBackpressureConfiguration)configuration error:(NSError **)error
+{
+  NSParameterAssert(configuration.lowWaterMark <= configuration.highWaterMark);
+
+  FBFileWriter_Bounded *writer = [[FBFileWriter_Bounded alloc] initWithFileHandle:fileHandle writeQueue:self.createWorkQueue configuration:configuration];
+  if (![writer startReadingWithError:error]) {
+    return nil;
+  }
+  return (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerBackpressure>) [FBDataConsumerAdaptor dataConsumerForDispatchDataConsumer:writer];
+}
+
 + (id<FBDataConsumer, FBDataConsumerLifecycle>)syncWriterForFilePath:(NSString *)filePath error:(NSError **)error
 {
   NSFileHandle *fileHandle = [self fileHandleForPath:filePath error:error];
@@ -270,3 +294,187 @@
 }
 
 @end
+
+@implementation FBFileWriter_Bounded
+
+@synthesize pendingBytes = _pendingBytes;
+@synthesize droppedBytes = _droppedBytes;
+
+#pragma mark Initializers
+
+- (instancetype)initWithFileHandle:(NSFileHandle *)fileHandle writeQueue:(dispatch_queue_t)writeQueue configuration:(FBFileWriterBackpressureConfiguration)configuration
+{
+  self = [super initWithFileHandle:fileHandle writeQueue:writeQueue];
+  if (!self) {
+    return nil;
+  }
+
+  _configuration = configuration;
+  _coalescedChunks = [NSMutableArray array];
+
+  return self;
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(dispatch_data_t)data
+{
+  NSParameterAssert(self.io);
+
+  NSUInteger size = dispatch_data_get_size(data);
+  @synchronized (self) {
+    switch (self.configuration.overflowPolicy) {
+      case FBFileWriterOverflowPolicyDropNewest:
+        // Always accept data when nothing is pending, otherwise a single large chunk could never be written.
+        if (_pendingBytes > 0 && _pendingBytes + size > self.configuration.highWaterMark) {
+          _droppedBytes += size;
+          [self startBackpressure];
+          return;
+        }
+        break;
+      case FBFileWriterOverflowPolicyCoalesce:
+        if (self.writeInFlight) {
+          [self coalesceData:data size:size];
+          return;
+        }
+        break;
+      default:
+        break;
+    }
+    _pendingBytes += size;
+    [self writeData:data size:size];
+    [self updateBackpressure];
+  }
+}
+
+- (void)consumeEndOfFile
+{
+  @synchronized (self) {
+    // Coalesced data is only written after the write in flight, which may be after the channel has been closed.
+    // Stream channels write in order, so it can be written now.
+    [self writeCoalescedData];
+  }
+  [super consumeEndOfFile];
+}
+
+#pragma mark FBDataConsumerBackpressure
+
+- (NSUInteger)pendingBytes
+{
+  @synchronized (self) {
+    return _pendingBytes;
+  }
+}
+
+- (NSUInteger)droppedBytes
+{
+  @synchronized (self) {
+    return _droppedBytes;
+  }
+}
+
+- (FBFuture<NSNull *> *)drained
+{
+  @synchronized (self) {
+    return self.drainedMutable ?: [FBFuture futureWithResult:NSNull.null];
+  }
+}
+
+- (FBFuture<NSNull *> *)flushed
+{
+  @synchronized (self) {
+    if (_pendingBytes == 0) {
+      return [FBFuture futureWithResult:NSNull.null];
+    }
+    if (!self.flushedMutable) {
+      self.flushedMutable = [FBMutableFuture futureWithName:@"Writer flushed"];
+    }
+    return self.flushedMutable;
+  }
+}
+
+#pragma mark Private
+
+- (void)writeData:(dispatch_data_t)data size:(NSUInteger)size
+{
+  self.writeInFlight = YES;
+  __weak typeof(self) weakSelf = self;
+  dispatch_io_write(self.io, 0, data, self.writeQueue, ^(bool done, dispatch_data_t remainder, int error) {
+    // The handler may be called multiple times with partial progress, the bytes are only released when the whole write is done.
+    if (done) {
+      [weakSelf writeDidFinishWithSize:size];
+    }
+  });
+}
+
+- (void)writeDidFinishWithSize:(NSUInteger)size
+{
+  @synchronized (self) {
+    _pendingBytes -= MIN(size, _pendingBytes);
+    self.writeInFlight = NO;
+    if (self.io) {
+      [self writeCoalescedData];
+    }
+    [self updateBackpressure];
+  }
+}
+
+- (void)coalesceData:(dispatch_data_t)data size:(NSUInteger)size
+{
+  [self.coalescedChunks addObject:data];
+  self.coalescedSize += size;
+  _pendingBytes += size;
+
+  // Keep the most recent chunks, up to the high water mark.
+  // Whole chunks are discarded, as the consumer may depend upon each chunk being intact, such as a chunk being a frame.
+  // The most recent chunk is always kept, even if it is larger than the high water mark on its own.
+  while (self.coalescedSize > self.configuration.highWaterMark && self.coalescedChunks.count > 1) {
+    NSUInteger oldestSize = dispatch_data_get_size(self.coalescedChunks.firstObject);
+    [self.coalescedChunks removeObjectAtIndex:0];
+    self.coalescedSize -= oldestSize;
+    _pendingBytes -= oldestSize;
+    _droppedBytes += oldestSize;
+  }
+  [self updateBackpressure];
+}
+
+- (void)writeCoalescedData
+{
+  if (self.coalescedChunks.count == 0) {
+    return;
+  }
+  dispatch_data_t coalescedData = dispatch_data_empty;
+  for (dispatch_data_t chunk in self.coalescedChunks) {
+    coalescedData = dispatch_data_create_concat(coalescedData, chunk);
+  }
+  NSUInteger size = self.coalescedSize;
+  [self.coalescedChunks removeAllObjects];
+  self.coalescedSize = 0;
+  [self writeData:coalescedData size:size];
+}
+
+- (void)updateBackpressure
+{
+  if (_pendingBytes == 0 && self.flushedMutable) {
+    FBMutableFuture<NSNull *> *flushed = self.flushedMutable;
+    self.flushedMutable = nil;
+    [flushed resolveWithResult:NSNull.null];
+  }
+  if (_pendingBytes > self.configuration.highWaterMark) {
+    [self startBackpressure];
+  } else if (_pendingBytes <= self.configuration.lowWaterMark && self.drainedMutable) {
+    FBMutableFuture<NSNull *> *drained = self.drainedMutable;
+    self.drainedMutable = nil;
+    [drained resolveWithResult:NSNull.null];
+  }
+}
+
+- (void)startBackpressure
+{
+  if (self.drainedMutable) {
+    return;
+  }
+  self.drainedMutable = [FBMutableFuture futureWithName:@"Writer drained"];
+}
+
+@end
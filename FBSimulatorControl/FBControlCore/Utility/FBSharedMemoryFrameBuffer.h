@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBDataConsumer.h>
+#import <FBControlCore/FBFuture.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol FBControlCoreLogger;
+
+/**
+ The Layout of a Shared Memory Frame Buffer.
+ The Shared Memory Object starts with a FBSharedMemoryFrameHeader, followed by FBSharedMemoryFrameSlotCount slots of frame data.
+ Fields that change once the buffer is created must be read with acquire semantics, for example with __atomic_load_n.
+
+ A frame is published by:
+ 1) Setting the 'sequence' of the oldest slot to 0.
+ 2) Copying the frame into the slot and setting the 'length' of the slot.
+ 3) Setting the 'sequence' of the slot, then 'latestSequence' in the header, to the sequence number of the frame.
+ 4) Writing a byte to the fifo at 'notificationPath'.
+
+ A reader copies the slot at 'latestSequence % FBSharedMemoryFrameSlotCount'.
+ The copy is only valid if the 'sequence' of the slot is equal to the sequence number before and after copying.
+ */
+extern const uint32_t FBSharedMemoryFrameMagic;
+extern const uint32_t FBSharedMemoryFrameVersion;
+
+#define FBSharedMemoryFrameSlotCount 3
+
+typedef struct {
+  uint64_t sequence;
+  uint64_t length;
+} FBSharedMemoryFrameSlot;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t dataOffset;
+  uint64_t slotStride;
+  uint64_t slotCapacity;
+  uint64_t latestSequence;
+  uint64_t writerClosed;
+  FBSharedMemoryFrameSlot slots[FBSharedMemoryFrameSlotCount];
+  char notificationPath[1024];
+} FBSharedMemoryFrameHeader;
+
+/**
+ A Data Consumer that publishes each consumed NSData as a frame in a POSIX Shared Memory triple buffer.
+ This means that local readers do not need a copy through kernel buffers, as is the case for sockets and files.
+ Frames are never queued, a reader that is slower than the writer will only see the most recent frame.
+ The Shared Memory Object and notification fifo are removed when an end-of-file is consumed.
+ */
+@interface FBSharedMemoryFrameWriter : NSObject <FBDataConsumer, FBDataConsumerLifecycle>
+
+#pragma mark Initializers
+
+/**
+ Creates a Shared Memory Object and notification fifo for frames.
+
+ @param name the name of the Shared Memory Object, passed to shm_open(2). Must start with a '/', and be at most 31 characters.
+ @param frameCapacity the size of the largest frame. Larger frames are dropped.
+ @param logger the logger to log to.
+ @param error an error out for any error that occurs.
+ @return a new writer on success, nil otherwise.
+ */
++ (nullable instancetype)writerWithName:(NSString *)name frameCapacity:(size_t)frameCapacity logger:(nullable id<FBControlCoreLogger>)logger error:(NSError **)error;
+
+#pragma mark Properties
+
+/**
+ The name of the Shared Memory Object.
+ */
+@property (nonatomic, copy, readonly) NSString *name;
+
+/**
+ The path of the fifo that a byte is written to for each frame.
+ */
+@property (nonatomic, copy, readonly) NSString *notificationPath;
+
+/**
+ The number of frames that have been published.
+ */
+@property (atomic, assign, readonly) uint64_t framesWritten;
+
+/**
+ The number of frames that were larger than the capacity of a slot.
+ */
+@property (atomic, assign, readonly) uint64_t framesDropped;
+
+@end
+
+/**
+ Reads frames from a Shared Memory Object created by FBSharedMemoryFrameWriter.
+ */
+@interface FBSharedMemoryFrameReader : NSObject
+
+#pragma mark Initializers
+
+/**
+ Maps an existing Shared Memory Object for reading.
+
+ @param name the name of the Shared Memory Object.
+ @param error an error out for any error that occurs.
+ @return a new reader on success, nil otherwise.
+ */
++ (nullable instancetype)readerWithName:(NSString *)name error:(NSError **)error;
+
+#pragma mark Properties
+
+/**
+ The size of the largest frame.
+ */
+@property (nonatomic, assign, readonly) size_t frameCapacity;
+
+#pragma mark Public Methods
+
+/**
+ Copies the most recently published frame.
+
+ @param sequence an outparam for the sequence number of the frame. Sequence numbers start at 1.
+ @return the frame, or nil if no frame has been published, or the writer did not stop overwriting it.
+ */
+- (nullable NSData *)latestFrameWithSequence:(nullable uint64_t *)sequence;
+
+/**
+ Calls the handler with each new frame, until the writer consumes an end-of-file.
+ Frames that are published faster than they can be handled are skipped.
+
+ @param queue the queue to call the handler on.
+ @param handler the handler to call with the frame and its sequence number.
+ @return a Future that resolves when the writer has finished. Cancelling it stops the reading.
+ */
+- (FBFuture<NSNull *> *)consumeFramesOnQueue:(dispatch_queue_t)queue handler:(void (^)(NSData *frame, uint64_t sequence))handler;
+
+@end
+
+NS_ASSUME_NONNULL_END
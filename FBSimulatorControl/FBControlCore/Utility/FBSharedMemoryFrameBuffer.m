@@ -0,0 +1,361 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBSharedMemoryFrameBuffer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#import "FBControlCoreError.h"
+#import "FBControlCoreLogger.h"
+
+const uint32_t FBSharedMemoryFrameMagic = 0x46425346;
+const uint32_t FBSharedMemoryFrameVersion = 1;
+
+// Frame data starts on a page boundary, for both 4k and 16k pages.
+static const size_t FBSharedMemoryFrameDataAlignment = 16384;
+static const size_t FBSharedMemoryFrameSlotAlignment = 64;
+static const NSUInteger FBSharedMemoryFrameReadAttempts = 8;
+
+static size_t FBSharedMemoryFrameRoundUp(size_t value, size_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+static uint8_t *FBSharedMemoryFrameSlotData(FBSharedMemoryFrameHeader *header, uint64_t sequence)
+{
+  return ((uint8_t *) header) + header->dataOffset + (header->slotStride * (sequence % FBSharedMemoryFrameSlotCount));
+}
+
+@interface FBSharedMemoryFrameWriter ()
+
+@property (nonatomic, assign, readonly) FBSharedMemoryFrameHeader *header;
+@property (nonatomic, assign, readonly) size_t mappingSize;
+@property (nonatomic, assign, readonly) int notificationDescriptor;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *eofFuture;
+@property (nonatomic, assign, readwrite) BOOL finished;
+@property (atomic, assign, readwrite) uint64_t framesWritten;
+@property (atomic, assign, readwrite) uint64_t framesDropped;
+
+@end
+
+@implementation FBSharedMemoryFrameWriter
+
+#pragma mark Initializers
+
++ (nullable instancetype)writerWithName:(NSString *)name frameCapacity:(size_t)frameCapacity logger:(nullable id<FBControlCoreLogger>)logger error:(NSError **)error
+{
+  NSString *notificationPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.fifo", NSUUID.UUID.UUIDString]];
+  if (strlen(notificationPath.fileSystemRepresentation) >= sizeof(((FBSharedMemoryFrameHeader *) NULL)->notificationPath)) {
+    return [[FBControlCoreError
+      describeFormat:@"Notification path %@ is too long", notificationPath]
+      fail:error];
+  }
+
+  size_t slotStride = FBSharedMemoryFrameRoundUp(MAX(frameCapacity, (size_t) 1), FBSharedMemoryFrameSlotAlignment);
+  size_t dataOffset = FBSharedMemoryFrameRoundUp(sizeof(FBSharedMemoryFrameHeader), FBSharedMemoryFrameDataAlignment);
+  size_t mappingSize = dataOffset + (slotStride * FBSharedMemoryFrameSlotCount);
+
+  int fileDescriptor = shm_open(name.UTF8String, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fileDescriptor < 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to create shared memory %@: %s", name, strerror(errno)]
+      fail:error];
+  }
+  if (ftruncate(fileDescriptor, (off_t) mappingSize) != 0) {
+    NSString *reason = @(strerror(errno));
+    close(fileDescriptor);
+    shm_unlink(name.UTF8String);
+    return [[FBControlCoreError
+      describeFormat:@"Failed to size shared memory %@ to %zu bytes: %@", name, mappingSize, reason]
+      fail:error];
+  }
+  void *mapping = mmap(NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (mapping == MAP_FAILED) {
+    NSString *reason = @(strerror(errno));
+    shm_unlink(name.UTF8String);
+    return [[FBControlCoreError
+      describeFormat:@"Failed to map shared memory %@: %@", name, reason]
+      fail:error];
+  }
+  if (mkfifo(notificationPath.fileSystemRepresentation, S_IRUSR | S_IWUSR) != 0) {
+    NSString *reason = @(strerror(errno));
+    munmap(mapping, mappingSize);
+    shm_unlink(name.UTF8String);
+    return [[FBControlCoreError
+      describeFormat:@"Failed to create notification fifo %@: %@", notificationPath, reason]
+      fail:error];
+  }
+  // Opening for reading and writing means that the open does not wait for a reader, and readers see an end-of-file when it is closed.
+  int notificationDescriptor = open(notificationPath.fileSystemRepresentation, O_RDWR | O_NONBLOCK);
+  if (notificationDescriptor < 0) {
+    NSString *reason = @(strerror(errno));
+    unlink(notificationPath.fileSystemRepresentation);
+    munmap(mapping, mappingSize);
+    shm_unlink(name.UTF8String);
+    return [[FBControlCoreError
+      describeFormat:@"Failed to open notification fifo %@: %@", notificationPath, reason]
+      fail:error];
+  }
+
+  FBSharedMemoryFrameHeader *header = mapping;
+  header->version = FBSharedMemoryFrameVersion;
+  header->dataOffset = dataOffset;
+  header->slotStride = slotStride;
+  header->slotCapacity = frameCapacity;
+  strlcpy(header->notificationPath, notificationPath.fileSystemRepresentation, sizeof(header->notificationPath));
+  // The magic is written last, so that a reader never sees a partially initialized header.
+  __atomic_store_n(&header->magic, FBSharedMemoryFrameMagic, __ATOMIC_RELEASE);
+
+  return [[self alloc] initWithName:name notificationPath:notificationPath header:header mappingSize:mappingSize notificationDescriptor:notificationDescriptor logger:logger];
+}
+
+- (instancetype)initWithName:(NSString *)name notificationPath:(NSString *)notificationPath header:(FBSharedMemoryFrameHeader *)header mappingSize:(size_t)mappingSize notificationDescriptor:(int)notificationDescriptor logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _name = name;
+  _notificationPath = notificationPath;
+  _header = header;
+  _mappingSize = mappingSize;
+  _notificationDescriptor = notificationDescriptor;
+  _logger = logger;
+  _eofFuture = FBMutableFuture.future;
+
+  return self;
+}
+
+- (void)dealloc
+{
+  [self consumeEndOfFile];
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  @synchronized (self) {
+    if (self.finished) {
+      return;
+    }
+    FBSharedMemoryFrameHeader *header = self.header;
+    if (data.length > header->slotCapacity) {
+      if (self.framesDropped == 0) {
+        [self.logger logFormat:@"Dropping frame of %lu bytes, larger than the capacity of %llu bytes", (unsigned long) data.length, header->slotCapacity];
+      }
+      self.framesDropped += 1;
+      return;
+    }
+
+    // The slot is marked as being written before any of its data changes.
+    uint64_t sequence = self.framesWritten + 1;
+    FBSharedMemoryFrameSlot *slot = &header->slots[sequence % FBSharedMemoryFrameSlotCount];
+    __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    uint8_t *slotData = FBSharedMemoryFrameSlotData(header, sequence);
+    [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+      memcpy(slotData + byteRange.location, bytes, byteRange.length);
+    }];
+    __atomic_store_n(&slot->length, (uint64_t) data.length, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->latestSequence, sequence, __ATOMIC_RELEASE);
+    self.framesWritten = sequence;
+
+    // A full fifo means that the reader has yet to see a previous notification, so another is not needed.
+    uint8_t notification = 1;
+    write(self.notificationDescriptor, &notification, sizeof(notification));
+  }
+}
+
+- (void)consumeEndOfFile
+{
+  @synchronized (self) {
+    if (self.finished) {
+      return;
+    }
+    self.finished = YES;
+    __atomic_store_n(&self.header->writerClosed, 1, __ATOMIC_RELEASE);
+    uint8_t notification = 1;
+    write(self.notificationDescriptor, &notification, sizeof(notification));
+
+    // Existing readers keep their mappings and fifo descriptors, so both can be removed now.
+    close(self.notificationDescriptor);
+    munmap(self.header, self.mappingSize);
+    shm_unlink(self.name.UTF8String);
+    unlink(self.notificationPath.fileSystemRepresentation);
+  }
+  [self.eofFuture resolveWithResult:NSNull.null];
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)eofHasBeenReceived
+{
+  return self.eofFuture;
+}
+
+@end
+
+@interface FBSharedMemoryFrameReader ()
+
+@property (nonatomic, assign, readonly) FBSharedMemoryFrameHeader *header;
+@property (nonatomic, assign, readonly) size_t mappingSize;
+
+@end
+
+@implementation FBSharedMemoryFrameReader
+
+#pragma mark Initializers
+
++ (nullable instancetype)readerWithName:(NSString *)name error:(NSError **)error
+{
+  int fileDescriptor = shm_open(name.UTF8String, O_RDONLY);
+  if (fileDescriptor < 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to open shared memory %@: %s", name, strerror(errno)]
+      fail:error];
+  }
+  struct stat status;
+  if (fstat(fileDescriptor, &status) != 0 || (size_t) status.st_size < sizeof(FBSharedMemoryFrameHeader)) {
+    close(fileDescriptor);
+    return [[FBControlCoreError
+      describeFormat:@"Shared memory %@ is too small to contain a frame header", name]
+      fail:error];
+  }
+  size_t mappingSize = (size_t) status.st_size;
+  void *mapping = mmap(NULL, mappingSize, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (mapping == MAP_FAILED) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to map shared memory %@: %s", name, strerror(errno)]
+      fail:error];
+  }
+
+  FBSharedMemoryFrameHeader *header = mapping;
+  if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != FBSharedMemoryFrameMagic || header->version != FBSharedMemoryFrameVersion) {
+    munmap(mapping, mappingSize);
+    return [[FBControlCoreError
+      describeFormat:@"Shared memory %@ does not contain frames of version %u", name, FBSharedMemoryFrameVersion]
+      fail:error];
+  }
+  if (header->slotCapacity > header->slotStride || header->dataOffset + (header->slotStride * FBSharedMemoryFrameSlotCount) > mappingSize) {
+    munmap(mapping, mappingSize);
+    return [[FBControlCoreError
+      describeFormat:@"Shared memory %@ has slots that are outside of its %zu bytes", name, mappingSize]
+      fail:error];
+  }
+
+  return [[self alloc] initWithHeader:header mappingSize:mappingSize];
+}
+
+- (instancetype)initWithHeader:(FBSharedMemoryFrameHeader *)header mappingSize:(size_t)mappingSize
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _header = header;
+  _mappingSize = mappingSize;
+
+  return self;
+}
+
+- (void)dealloc
+{
+  munmap(_header, _mappingSize);
+}
+
+#pragma mark Properties
+
+- (size_t)frameCapacity
+{
+  return (size_t) self.header->slotCapacity;
+}
+
+#pragma mark Public Methods
+
+- (nullable NSData *)latestFrameWithSequence:(nullable uint64_t *)sequenceOut
+{
+  FBSharedMemoryFrameHeader *header = self.header;
+  for (NSUInteger attempt = 0; attempt < FBSharedMemoryFrameReadAttempts; attempt++) {
+    uint64_t sequence = __atomic_load_n(&header->latestSequence, __ATOMIC_ACQUIRE);
+    if (sequence == 0) {
+      return nil;
+    }
+    FBSharedMemoryFrameSlot *slot = &header->slots[sequence % FBSharedMemoryFrameSlotCount];
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != sequence) {
+      continue;
+    }
+    uint64_t length = __atomic_load_n(&slot->length, __ATOMIC_RELAXED);
+    if (length > header->slotCapacity) {
+      continue;
+    }
+    NSData *frame = [NSData dataWithBytes:FBSharedMemoryFrameSlotData(header, sequence) length:(NSUInteger) length];
+    // If the writer has started on the slot again during the copy, the copy may be torn.
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) != sequence) {
+      continue;
+    }
+    if (sequenceOut) {
+      *sequenceOut = sequence;
+    }
+    return frame;
+  }
+  return nil;
+}
+
+- (FBFuture<NSNull *> *)consumeFramesOnQueue:(dispatch_queue_t)queue handler:(void (^)(NSData *frame, uint64_t sequence))handler
+{
+  int fileDescriptor = open(self.header->notificationPath, O_RDONLY | O_NONBLOCK);
+  if (fileDescriptor < 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to open notification fifo %s: %s", self.header->notificationPath, strerror(errno)]
+      failFuture];
+  }
+
+  FBMutableFuture<NSNull *> *future = FBMutableFuture.future;
+  dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t) fileDescriptor, 0, queue);
+  __block uint64_t lastSequence = 0;
+  dispatch_source_set_event_handler(source, ^{
+    // Notifications are coalesced, since only the latest frame is read.
+    uint8_t notifications[256];
+    ssize_t result = 0;
+    while ((result = read(fileDescriptor, notifications, sizeof(notifications))) > 0) {
+    }
+    uint64_t sequence = 0;
+    NSData *frame = [self latestFrameWithSequence:&sequence];
+    if (frame && sequence > lastSequence) {
+      lastSequence = sequence;
+      handler(frame, sequence);
+    }
+    if (result == 0 || __atomic_load_n(&self.header->writerClosed, __ATOMIC_ACQUIRE)) {
+      dispatch_source_cancel(source);
+    }
+  });
+  dispatch_source_set_cancel_handler(source, ^{
+    close(fileDescriptor);
+    [future resolveWithResult:NSNull.null];
+  });
+  dispatch_resume(source);
+
+  return [future onQueue:queue respondToCancellation:^{
+    dispatch_source_cancel(source);
+    return [FBFuture futureWithResult:NSNull.null];
+  }];
+}
+
+@end
@@ -9,6 +9,7 @@
 
 #import <Foundation/Foundation.h>
 
+#import <FBControlCore/FBDataConsumer.h>
 #import <FBControlCore/FBiOSTargetFuture.h>
 
 NS_ASSUME_NONNULL_BEGIN
@@ -92,6 +93,17 @@ extern FBiOSTargetFutureType const FBiOSTargetFutureTypeUploadedBinary;
  */
 + (nullable)bufferWithHeader:(FBUploadHeader *)header workingDirectory:(NSString *)workingDirectory;
 
+/**
+ Creates a new Binary Buffer, that also forwards the uploaded bytes to a consumer as they arrive.
+ This allows the upload to be processed, for example by a streaming FBArchiveUnpacker, before the upload is complete.
+
+ @param header the header from which to make a buffer.
+ @param workingDirectory the Working Directory to write to.
+ @param consumer the (optional) consumer to forward bytes to. End-of-File is sent to the consumer when the upload is complete.
+ @return a new Binary Buffer.
+ */
++ (nullable)bufferWithHeader:(FBUploadHeader *)header workingDirectory:(NSString *)workingDirectory consumer:(nullable id<FBDataConsumer>)consumer;
+
 /**
  Write the data to the buffer.
 
@@ -235,6 +235,7 @@ static NSString *const KeyPath = @"path";
 
 @property (nonatomic, copy, readonly) FBUploadHeader *header;
 @property (nonatomic, copy, readonly) NSString *filePath;
+@property (nonatomic, strong, readwrite, nullable) id<FBDataConsumer> consumer;
 
 @property (nonatomic, strong, readwrite, nullable) FBUploadedDestination *binary;
 @property (nonatomic, assign, readwrite) size_t position;
@@ -267,16 +268,25 @@ static size_t ToFileThreshold = 2 * 1024 * 1024;
 }
 
 + (nullable)bufferWithHeader:(FBUploadHeader *)header workingDirectory:(NSString *)workingDirectory
+{
+  return [self bufferWithHeader:header workingDirectory:workingDirectory consumer:nil];
+}
+
++ (nullable)bufferWithHeader:(FBUploadHeader *)header workingDirectory:(NSString *)workingDirectory consumer:(nullable id<FBDataConsumer>)consumer
 {
   NSString *filePath = [self outputFilePathWithWorkingDirectory:workingDirectory pathExtension:header.extension];
 
+  FBUploadBuffer *buffer = nil;
   if (header.size > ToFileThreshold) {
     NSError *error = nil;
     id<FBDataConsumer> writer = [FBFileWriter syncWriterForFilePath:filePath error:&error];
     NSAssert(writer, @"Could not create writer %@", error);
-    return [[FBUploadBuffer_ToFile alloc] initWithHeader:header filePath:filePath writer:writer];
+    buffer = [[FBUploadBuffer_ToFile alloc] initWithHeader:header filePath:filePath writer:writer];
+  } else {
+    buffer = [[FBUploadBuffer_InMemory alloc] initWithHeader:header filePath:filePath];
   }
-  return [[FBUploadBuffer_InMemory alloc] initWithHeader:header filePath:filePath];
+  buffer.consumer = consumer;
+  return buffer;
 }
 
 - (instancetype)initWithHeader:(FBUploadHeader *)header filePath:(NSString *)filePath
@@ -322,6 +332,7 @@ static size_t ToFileThreshold = 2 * 1024 * 1024;
   }
   // Append the data, return the remainder.
   [self writeData:toWrite];
+  [self.consumer consumeData:toWrite];
   self.position = self.position + dataToConsume;
   if (remainderOut) {
     *remainderOut = remainder;
@@ -330,6 +341,8 @@ static size_t ToFileThreshold = 2 * 1024 * 1024;
   // We're at the end, so return the uploaded binary.
   if (self.position == self.header.size) {
     FBUploadedDestination *binary = [self constructUploadedBinary];
+    [self.consumer consumeEndOfFile];
+    self.consumer = nil;
     self.binary = binary;
     return binary;
   }
@@ -53,6 +53,16 @@
  */
 + (NSString *)agentCrashPathWithCustomDeviceSet;
 
+/**
+ A thin arm64 Mach-O dylib, with an install name, UUID, linked dylibs, an rpath and a code signature.
+ */
++ (NSString *)thinMachOPath;
+
+/**
+ A fat Mach-O executable, with x86_64 and i386 slices.
+ */
++ (NSString *)fatMachOPath;
+
 /**
  All of the above, in a directory
  */
@@ -48,6 +48,16 @@
   return [[NSBundle bundleForClass:self] pathForResource:@"agent_custom_set" ofType:@"crash"];
 }
 
++ (NSString *)thinMachOPath
+{
+  return [[NSBundle bundleForClass:self] pathForResource:@"macho_thin_arm64" ofType:@"bin"];
+}
+
++ (NSString *)fatMachOPath
+{
+  return [[NSBundle bundleForClass:self] pathForResource:@"macho_fat_x86" ofType:@"bin"];
+}
+
 + (NSString *)bundleResource
 {
   return [NSBundle bundleForClass:self].resourcePath;
@@ -14,6 +14,48 @@
 #import <sys/types.h>
 #import <sys/stat.h>
 
+@interface FBFileReaderTests_BackpressureConsumer : NSObject <FBDataConsumer, FBDataConsumerBackpressure>
+
+@property (atomic, assign, readwrite) NSUInteger bytesConsumed;
+@property (atomic, assign, readwrite) BOOL didRecieveEOF;
+@property (atomic, strong, readwrite) FBMutableFuture<NSNull *> *drainedMutable;
+
+@end
+
+@implementation FBFileReaderTests_BackpressureConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  self.bytesConsumed += data.length;
+}
+
+- (void)consumeEndOfFile
+{
+  self.didRecieveEOF = YES;
+}
+
+- (NSUInteger)pendingBytes
+{
+  return self.drainedMutable.hasCompleted ? 0 : self.bytesConsumed;
+}
+
+- (NSUInteger)droppedBytes
+{
+  return 0;
+}
+
+- (FBFuture<NSNull *> *)drained
+{
+  return self.drainedMutable;
+}
+
+- (FBFuture<NSNull *> *)flushed
+{
+  return self.drainedMutable;
+}
+
+@end
+
 @interface FBFileReaderTests : XCTestCase <FBDataConsumer>
 
 @property (atomic, assign, readwrite) BOOL didRecieveEOF;
@@ -370,6 +412,63 @@
   XCTAssertEqual(reader.state, FBFileReaderStateFinishedReadingInError);
 }
 
+- (void)testPausesReadingUntilConsumerHasDrained
+{
+  FBFileReaderTests_BackpressureConsumer *consumer = [FBFileReaderTests_BackpressureConsumer new];
+  consumer.drainedMutable = FBMutableFuture.future;
+  NSError *error = nil;
+  FBFileReader *reader = [[FBFileReader readerWithFilePath:@"/dev/zero" consumer:consumer logger:nil] await:&error];
+  XCTAssertNil(error);
+  BOOL success = [[reader startReading] await:&error] != nil;
+  XCTAssertNil(error);
+  XCTAssertTrue(success);
+
+  // Only a single bounded read should be delivered, as the consumer has not drained.
+  NSUInteger bytesBeforeDrain = 64 * 1024;
+  NSPredicate *predicate = [NSPredicate predicateWithBlock:^ BOOL (id _, id __) {
+    return consumer.bytesConsumed >= bytesBeforeDrain;
+  }];
+  [self waitForExpectations:@[[self expectationForPredicate:predicate evaluatedWithObject:self handler:nil]] timeout:FBControlCoreGlobalConfiguration.fastTimeout];
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.2]];
+  XCTAssertEqual(consumer.bytesConsumed, bytesBeforeDrain);
+
+  // Draining resumes reading.
+  [consumer.drainedMutable resolveWithResult:NSNull.null];
+  predicate = [NSPredicate predicateWithBlock:^ BOOL (id _, id __) {
+    return consumer.bytesConsumed > bytesBeforeDrain;
+  }];
+  [self waitForExpectations:@[[self expectationForPredicate:predicate evaluatedWithObject:self handler:nil]] timeout:FBControlCoreGlobalConfiguration.fastTimeout];
+
+  NSNumber *result = [[reader stopReading] await:&error];
+  XCTAssertNil(error);
+  XCTAssertEqualObjects(result, @(ECANCELED));
+  XCTAssertTrue(consumer.didRecieveEOF);
+}
+
+- (void)testStopsReadingWhilstWaitingForConsumerToDrain
+{
+  FBFileReaderTests_BackpressureConsumer *consumer = [FBFileReaderTests_BackpressureConsumer new];
+  consumer.drainedMutable = FBMutableFuture.future;
+  NSError *error = nil;
+  FBFileReader *reader = [[FBFileReader readerWithFilePath:@"/dev/zero" consumer:consumer logger:nil] await:&error];
+  XCTAssertNil(error);
+  BOOL success = [[reader startReading] await:&error] != nil;
+  XCTAssertNil(error);
+  XCTAssertTrue(success);
+
+  NSPredicate *predicate = [NSPredicate predicateWithBlock:^ BOOL (id _, id __) {
+    return consumer.bytesConsumed > 0;
+  }];
+  [self waitForExpectations:@[[self expectationForPredicate:predicate evaluatedWithObject:self handler:nil]] timeout:FBControlCoreGlobalConfiguration.fastTimeout];
+
+  // The consumer never drains, but stopping should still finish.
+  NSNumber *result = [[reader stopReading] await:&error];
+  XCTAssertNil(error);
+  XCTAssertEqualObjects(result, @(ECANCELED));
+  XCTAssertEqual(reader.state, FBFileReaderStateFinishedReadingByCancellation);
+  XCTAssertTrue(consumer.didRecieveEOF);
+}
+
 #pragma mark FBDataConsumer Implementation
 
 - (void)consumeEndOfFile
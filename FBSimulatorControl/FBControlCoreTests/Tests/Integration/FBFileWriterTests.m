@@ -62,6 +62,132 @@
   [writer consumeEndOfFile];
 }
 
+- (NSData *)chunkWithByte:(uint8_t)byte
+{
+  NSMutableData *data = [NSMutableData dataWithLength:128 * 1024];
+  memset(data.mutableBytes, byte, data.length);
+  return data;
+}
+
+- (FBFuture<NSData *> *)readToEndOfPipe:(NSPipe *)pipe
+{
+  return [FBFuture onQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0) resolveValue:^(NSError **_) {
+    return [pipe.fileHandleForReading readDataToEndOfFile];
+  }];
+}
+
+- (void)testBoundedWriterAppliesBackpressure
+{
+  // Nothing reads from the pipe, so writes cannot complete beyond the capacity of the pipe.
+  NSPipe *pipe = NSPipe.pipe;
+  FBFileWriterBackpressureConfiguration configuration = {.highWaterMark = 256 * 1024, .lowWaterMark = 64 * 1024, .overflowPolicy = FBFileWriterOverflowPolicyBuffer};
+  NSError *error = nil;
+  id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerBackpressure> writer = [FBFileWriter boundedAsyncWriterWithFileHandle:pipe.fileHandleForWriting configuration:configuration error:&error];
+  XCTAssertNil(error);
+  XCTAssertNotNil(writer);
+  XCTAssertTrue(writer.drained.hasCompleted);
+
+  for (uint8_t index = 0; index < 4; index++) {
+    [writer consumeData:[self chunkWithByte:index]];
+  }
+  XCTAssertGreaterThan(writer.pendingBytes, configuration.highWaterMark);
+  XCTAssertEqual(writer.droppedBytes, 0u);
+  FBFuture<NSNull *> *drained = writer.drained;
+  XCTAssertFalse(drained.hasCompleted);
+
+  // Reading from the pipe drains the writer.
+  FBFuture<NSData *> *read = [self readToEndOfPipe:pipe];
+  XCTAssertNotNil([drained awaitWithTimeout:FBControlCoreGlobalConfiguration.fastTimeout error:&error]);
+  XCTAssertNil(error);
+  XCTAssertLessThanOrEqual(writer.pendingBytes, configuration.lowWaterMark);
+
+  // Flushing waits for all of the pending bytes, not just those above the low water mark.
+  XCTAssertNotNil([writer.flushed awaitWithTimeout:FBControlCoreGlobalConfiguration.fastTimeout error:&error]);
+  XCTAssertNil(error);
+  XCTAssertEqual(writer.pendingBytes, 0u);
+
+  [writer consumeEndOfFile];
+  NSData *data = [read awaitWithTimeout:FBControlCoreGlobalConfiguration.fastTimeout error:&error];
+  XCTAssertNil(error);
+  XCTAssertEqual(data.length, 4 * 128 * 1024u);
+}
+
+- (void)testBoundedWriterDropsNewestData
+{
+  NSPipe *pipe = NSPipe.pipe;
+  FBFileWriterBackpressureConfiguration configuration = {.highWaterMark = 256 * 1024, .lowWaterMark = 0, .overflowPolicy = FBFileWriterOverflowPolicyDropNewest};
+  NSError *error = nil;
+  id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerBackpressure> writer = [FBFileWriter boundedAsyncWriterWithFileHandle:pipe.fileHandleForWriting configuration:configuration error:&error];
+  XCTAssertNil(error);
+
+  for (uint8_t index = 0; index < 4; index++) {
+    [writer consumeData:[self chunkWithByte:index]];
+  }
+  XCTAssertEqual(writer.pendingBytes, 256 * 1024u);
+  XCTAssertEqual(writer.droppedBytes, 256 * 1024u);
+  XCTAssertFalse(writer.drained.hasCompleted);
+
+  FBFuture<NSData *> *read = [self readToEndOfPipe:pipe];
+  [writer consumeEndOfFile];
+  NSData *data = [read awaitWithTimeout:FBControlCoreGlobalConfiguration.fastTimeout error:&error];
+  XCTAssertNil(error);
+  NSMutableData *expected = [NSMutableData data];
+  [expected appendData:[self chunkWithByte:0]];
+  [expected appendData:[self chunkWithByte:1]];
+  XCTAssertEqualObjects(data, expected);
+}
+
+- (void)testBoundedWriterCoalescesMostRecentData
+{
+  NSPipe *pipe = NSPipe.pipe;
+  FBFileWriterBackpressureConfiguration configuration = {.highWaterMark = 256 * 1024, .lowWaterMark = 0, .overflowPolicy = FBFileWriterOverflowPolicyCoalesce};
+  NSError *error = nil;
+  id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerBackpressure> writer = [FBFileWriter boundedAsyncWriterWithFileHandle:pipe.fileHandleForWriting configuration:configuration error:&error];
+  XCTAssertNil(error);
+
+  // The first chunk is in flight, the remainder are coalesced with the oldest being discarded.
+  for (uint8_t index = 0; index < 4; index++) {
+    [writer consumeData:[self chunkWithByte:index]];
+  }
+  XCTAssertEqual(writer.droppedBytes, 128 * 1024u);
+  XCTAssertEqual(writer.pendingBytes, 3 * 128 * 1024u);
+
+  FBFuture<NSData *> *read = [self readToEndOfPipe:pipe];
+  [writer consumeEndOfFile];
+  NSData *data = [read awaitWithTimeout:FBControlCoreGlobalConfiguration.fastTimeout error:&error];
+  XCTAssertNil(error);
+  NSMutableData *expected = [NSMutableData data];
+  [expected appendData:[self chunkWithByte:0]];
+  [expected appendData:[self chunkWithByte:2]];
+  [expected appendData:[self chunkWithByte:3]];
+  XCTAssertEqualObjects(data, expected);
+}
+
+- (void)testBoundedWriterCoalescesWholeChunks
+{
+  NSPipe *pipe = NSPipe.pipe;
+  FBFileWriterBackpressureConfiguration configuration = {.highWaterMark = 200 * 1024, .lowWaterMark = 0, .overflowPolicy = FBFileWriterOverflowPolicyCoalesce};
+  NSError *error = nil;
+  id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerBackpressure> writer = [FBFileWriter boundedAsyncWriterWithFileHandle:pipe.fileHandleForWriting configuration:configuration error:&error];
+  XCTAssertNil(error);
+
+  // The high water mark is not a multiple of the chunk size, but no chunk is truncated to fit.
+  for (uint8_t index = 0; index < 4; index++) {
+    [writer consumeData:[self chunkWithByte:index]];
+  }
+  XCTAssertEqual(writer.droppedBytes, 2 * 128 * 1024u);
+  XCTAssertEqual(writer.pendingBytes, 2 * 128 * 1024u);
+
+  FBFuture<NSData *> *read = [self readToEndOfPipe:pipe];
+  [writer consumeEndOfFile];
+  NSData *data = [read awaitWithTimeout:FBControlCoreGlobalConfiguration.fastTimeout error:&error];
+  XCTAssertNil(error);
+  NSMutableData *expected = [NSMutableData data];
+  [expected appendData:[self chunkWithByte:0]];
+  [expected appendData:[self chunkWithByte:3]];
+  XCTAssertEqualObjects(data, expected);
+}
+
 - (void)testOpeningAFifoAtBothEndsAsynchronously
 {
   id<FBAccumulatingBuffer> consumer = [FBLineBuffer accumulatingBuffer];
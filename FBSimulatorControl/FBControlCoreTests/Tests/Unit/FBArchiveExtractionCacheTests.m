@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBArchiveExtractionCacheTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSURL *directory;
+@property (nonatomic, strong, readwrite) FBArchiveExtractionCache *cache;
+@property (nonatomic, strong, readwrite) NSMutableArray<NSString *> *extractedArchives;
+@property (nonatomic, strong, readwrite, nullable) FBFuture<NSNull *> *pendingExtraction;
+@property (nonatomic, assign, readwrite) BOOL failExtraction;
+
+@end
+
+@implementation FBArchiveExtractionCacheTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString] isDirectory:YES];
+  [NSFileManager.defaultManager createDirectoryAtURL:self.directory withIntermediateDirectories:YES attributes:nil error:nil];
+  self.extractedArchives = [NSMutableArray array];
+  self.cache = [self cacheWithCapacity:4];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtURL:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (FBArchiveExtractionCache *)cacheWithCapacity:(NSUInteger)capacity
+{
+  // The 'archive' is a text file, extracting it writes its contents into a single file.
+  return [FBArchiveExtractionCache
+    cacheWithRootDirectory:[self.directory URLByAppendingPathComponent:@"cache"]
+    capacity:capacity
+    extractor:^(NSString *archivePath, NSURL *destination, id<FBControlCoreLogger> logger) {
+      @synchronized (self.extractedArchives) {
+        [self.extractedArchives addObject:archivePath];
+      }
+      if (self.failExtraction) {
+        return [[FBControlCoreError describe:@"Extraction Failed"] failFuture];
+      }
+      NSData *contents = [NSData dataWithContentsOfFile:archivePath];
+      [NSFileManager.defaultManager createDirectoryAtURL:[destination URLByAppendingPathComponent:@"Payload"] withIntermediateDirectories:YES attributes:nil error:nil];
+      [contents writeToURL:[destination URLByAppendingPathComponent:@"Payload/contents.txt"] atomically:NO];
+      FBFuture<NSNull *> *extraction = [FBFuture futureWithResult:NSNull.null];
+      return self.pendingExtraction ? [self.pendingExtraction mapReplace:NSNull.null] : extraction;
+    }];
+}
+
+- (NSString *)archiveWithContents:(NSString *)contents
+{
+  NSString *path = [self.directory.path stringByAppendingPathComponent:[NSUUID.UUID.UUIDString stringByAppendingPathExtension:@"ipa"]];
+  [contents writeToFile:path atomically:NO encoding:NSUTF8StringEncoding error:nil];
+  return path;
+}
+
+- (NSString *)extractAndReadArchiveAtPath:(NSString *)path
+{
+  NSError *error = nil;
+  NSString *contents = [[[self.cache
+    extractArchiveAtPath:path logger:nil]
+    onQueue:dispatch_get_main_queue() pop:^(NSURL *extracted) {
+      return [FBFuture futureWithResult:[NSString stringWithContentsOfURL:[extracted URLByAppendingPathComponent:@"Payload/contents.txt"] encoding:NSUTF8StringEncoding error:nil]];
+    }]
+    awaitWithTimeout:5 error:&error];
+  XCTAssertNil(error);
+  return contents;
+}
+
+- (void)waitForCachedDigestCount:(NSUInteger)count
+{
+  FBArchiveExtractionCache *cache = self.cache;
+  NSError *error = nil;
+  BOOL success = [[FBFuture onQueue:dispatch_get_main_queue() resolveWhen:^ BOOL {
+    return cache.cachedDigests.count == count;
+  }] awaitWithTimeout:5 error:&error] != nil;
+  XCTAssertTrue(success);
+}
+
+- (void)testIdenticalContentsAreExtractedOnce
+{
+  NSString *first = [self archiveWithContents:@"FOO"];
+  NSString *second = [self archiveWithContents:@"FOO"];
+
+  XCTAssertEqualObjects([self extractAndReadArchiveAtPath:first], @"FOO");
+  XCTAssertEqualObjects([self extractAndReadArchiveAtPath:second], @"FOO");
+  XCTAssertEqualObjects([self extractAndReadArchiveAtPath:first], @"FOO");
+
+  XCTAssertEqual(self.cache.extractionCount, 1u);
+  XCTAssertEqualObjects([self.cache contentDigestOfFileAtPath:first error:nil], [self.cache contentDigestOfFileAtPath:second error:nil]);
+  XCTAssertEqualObjects([self.cache contentDigestOfFileAtPath:first error:nil], @"9520437ce8902eb379a7d8aaa98fc4c94eeb07b6684854868fa6f72bf34b0fd3");
+}
+
+- (void)testConcurrentRequestsShareExtraction
+{
+  FBMutableFuture<NSNull *> *pending = FBMutableFuture.future;
+  self.pendingExtraction = pending;
+  NSString *archive = [self archiveWithContents:@"BAR"];
+
+  NSMutableArray<FBFuture<NSURL *> *> *futures = [NSMutableArray array];
+  NSMutableArray<FBMutableFuture<NSNull *> *> *holds = [NSMutableArray array];
+  for (NSUInteger index = 0; index < 8; index++) {
+    FBMutableFuture<NSNull *> *hold = FBMutableFuture.future;
+    FBMutableFuture<NSURL *> *extracted = FBMutableFuture.future;
+    [[self.cache
+      extractArchiveAtPath:archive logger:nil]
+      onQueue:dispatch_get_main_queue() pop:^(NSURL *directory) {
+        [extracted resolveWithResult:directory];
+        return hold;
+      }];
+    [futures addObject:extracted];
+    [holds addObject:hold];
+  }
+  [pending resolveWithResult:NSNull.null];
+
+  NSError *error = nil;
+  NSArray<NSURL *> *directories = [[FBFuture futureWithFutures:futures] awaitWithTimeout:5 error:&error];
+  XCTAssertNil(error);
+  XCTAssertEqual(self.cache.extractionCount, 1u);
+  // Each request recieves a distinct copy of the tree.
+  XCTAssertEqual([NSSet setWithArray:directories].count, 8u);
+  for (NSURL *directory in directories) {
+    XCTAssertEqualObjects([NSString stringWithContentsOfURL:[directory URLByAppendingPathComponent:@"Payload/contents.txt"] encoding:NSUTF8StringEncoding error:nil], @"BAR");
+  }
+  // Modifying one copy does not affect the others.
+  [@"NEW" writeToURL:[directories[0] URLByAppendingPathComponent:@"Payload/new.txt"] atomically:NO encoding:NSUTF8StringEncoding error:nil];
+  XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:[directories[1] URLByAppendingPathComponent:@"Payload/new.txt"].path]);
+  // Writing into an existing file of one copy, as codesigning does, does not write through to the others or to the cache.
+  NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:[directories[0] URLByAppendingPathComponent:@"Payload/contents.txt"].path];
+  [handle writeData:[@"BAZ" dataUsingEncoding:NSUTF8StringEncoding]];
+  [handle closeFile];
+  XCTAssertEqualObjects([NSString stringWithContentsOfURL:[directories[1] URLByAppendingPathComponent:@"Payload/contents.txt"] encoding:NSUTF8StringEncoding error:nil], @"BAR");
+  XCTAssertEqualObjects([self extractAndReadArchiveAtPath:archive], @"BAR");
+
+  for (FBMutableFuture<NSNull *> *hold in holds) {
+    [hold resolveWithResult:NSNull.null];
+  }
+}
+
+- (void)testEvictsLeastRecentlyUsed
+{
+  self.cache = [self cacheWithCapacity:2];
+  NSString *first = [self archiveWithContents:@"1"];
+  NSString *second = [self archiveWithContents:@"2"];
+  NSString *third = [self archiveWithContents:@"3"];
+
+  [self extractAndReadArchiveAtPath:first];
+  [self extractAndReadArchiveAtPath:second];
+  [self extractAndReadArchiveAtPath:first];
+  [self extractAndReadArchiveAtPath:third];
+  [self waitForCachedDigestCount:2];
+
+  NSArray<NSString *> *expected = @[
+    [self.cache contentDigestOfFileAtPath:first error:nil],
+    [self.cache contentDigestOfFileAtPath:third error:nil],
+  ];
+  XCTAssertEqualObjects(self.cache.cachedDigests, expected);
+
+  // The evicted archive has to be extracted again.
+  [self extractAndReadArchiveAtPath:second];
+  XCTAssertEqual(self.cache.extractionCount, 4u);
+}
+
+- (void)testDoesNotEvictReferencedTrees
+{
+  self.cache = [self cacheWithCapacity:1];
+  NSString *held = [self archiveWithContents:@"HELD"];
+  FBMutableFuture<NSNull *> *hold = FBMutableFuture.future;
+  FBMutableFuture<NSNull *> *entered = FBMutableFuture.future;
+  FBFuture *popped = [[self.cache
+    extractArchiveAtPath:held logger:nil]
+    onQueue:dispatch_get_main_queue() pop:^(NSURL *directory) {
+      [entered resolveWithResult:NSNull.null];
+      return hold;
+    }];
+  XCTAssertNotNil([entered awaitWithTimeout:5 error:nil]);
+
+  [self extractAndReadArchiveAtPath:[self archiveWithContents:@"OTHER"]];
+  [self waitForCachedDigestCount:1];
+  XCTAssertEqualObjects(self.cache.cachedDigests, @[[self.cache contentDigestOfFileAtPath:held error:nil]]);
+
+  [hold resolveWithResult:NSNull.null];
+  XCTAssertNotNil([popped awaitWithTimeout:5 error:nil]);
+  XCTAssertEqualObjects([self extractAndReadArchiveAtPath:held], @"HELD");
+  XCTAssertEqual(self.cache.extractionCount, 2u);
+}
+
+- (void)testFailedExtractionIsRetried
+{
+  NSString *archive = [self archiveWithContents:@"RETRY"];
+  self.failExtraction = YES;
+  NSError *error = nil;
+  XCTAssertNil([[[self.cache extractArchiveAtPath:archive logger:nil] onQueue:dispatch_get_main_queue() pop:^(NSURL *directory) {
+    return [FBFuture futureWithResult:directory];
+  }] awaitWithTimeout:5 error:&error]);
+  XCTAssertNotNil(error);
+
+  self.failExtraction = NO;
+  XCTAssertEqualObjects([self extractAndReadArchiveAtPath:archive], @"RETRY");
+  XCTAssertEqual(self.cache.extractionCount, 2u);
+}
+
+@end
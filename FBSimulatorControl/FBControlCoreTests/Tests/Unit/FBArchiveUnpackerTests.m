@@ -0,0 +1,257 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+#import <sys/stat.h>
+
+static void AppendTarEntry(NSMutableData *archive, NSString *name, char type, NSString *linkName, NSData *contents)
+{
+  uint8_t header[512] = {0};
+  strncpy((char *) header, name.UTF8String, 100);
+  snprintf((char *) header + 100, 8, "%07o", 0644);
+  snprintf((char *) header + 124, 12, "%011lo", (unsigned long) contents.length);
+  header[156] = (uint8_t) type;
+  strncpy((char *) header + 157, linkName.UTF8String, 100);
+  memcpy(header + 257, "ustar\0" "00", 8);
+  memset(header + 148, ' ', 8);
+  unsigned int checksum = 0;
+  for (size_t index = 0; index < sizeof(header); index++) {
+    checksum += header[index];
+  }
+  snprintf((char *) header + 148, 8, "%06o", checksum);
+  [archive appendBytes:header length:sizeof(header)];
+  [archive appendData:contents];
+  [archive increaseLengthBy:(512 - contents.length % 512) % 512];
+}
+
+@interface FBArchiveUnpackerTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+@property (nonatomic, copy, readwrite) NSString *sourceDirectory;
+
+@end
+
+@implementation FBArchiveUnpackerTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  self.sourceDirectory = [self.directory stringByAppendingPathComponent:@"Source"];
+  NSString *bundle = [self.sourceDirectory stringByAppendingPathComponent:@"Payload/Foo.app"];
+  [NSFileManager.defaultManager createDirectoryAtPath:[bundle stringByAppendingPathComponent:@"Resources"] withIntermediateDirectories:YES attributes:nil error:nil];
+  [@"#!/bin/sh\necho foo\n" writeToFile:[bundle stringByAppendingPathComponent:@"Foo"] atomically:NO encoding:NSUTF8StringEncoding error:nil];
+  chmod([bundle stringByAppendingPathComponent:@"Foo"].fileSystemRepresentation, 0755);
+  NSMutableString *resource = [NSMutableString string];
+  for (NSUInteger index = 0; index < 20000; index++) {
+    [resource appendFormat:@"Line %lu\n", (unsigned long) index];
+  }
+  [resource writeToFile:[bundle stringByAppendingPathComponent:@"Resources/Large.txt"] atomically:NO encoding:NSUTF8StringEncoding error:nil];
+  [NSFileManager.defaultManager createSymbolicLinkAtPath:[bundle stringByAppendingPathComponent:@"Link.txt"] withDestinationPath:@"Resources/Large.txt" error:nil];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (NSString *)archivePathWithName:(NSString *)name
+{
+  return [self.directory stringByAppendingPathComponent:name];
+}
+
+- (void)runArchiverWithLaunchPath:(NSString *)launchPath arguments:(NSArray<NSString *> *)arguments
+{
+  // Archivers name entries relative to the working directory, which is set by the shell.
+  NSArray<NSString *> *shellArguments = [@[@"-c", @"cd \"$0\" && exec \"$@\"", self.sourceDirectory, launchPath] arrayByAddingObjectsFromArray:arguments];
+  NSError *error = nil;
+  BOOL success = [[[[FBTaskBuilder
+    withLaunchPath:@"/bin/sh"]
+    withArguments:shellArguments]
+    runUntilCompletion]
+    awaitWithTimeout:20 error:&error] != nil;
+  XCTAssertTrue(success, @"%@", error);
+}
+
+- (NSURL *)emptyDestination
+{
+  NSString *destination = [self.directory stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  [NSFileManager.defaultManager createDirectoryAtPath:destination withIntermediateDirectories:YES attributes:nil error:nil];
+  return [NSURL fileURLWithPath:destination isDirectory:YES];
+}
+
+- (void)assertExtractedBundleAtDirectory:(NSURL *)destination
+{
+  NSString *bundle = [destination.path stringByAppendingPathComponent:@"Payload/Foo.app"];
+  NSString *source = [self.sourceDirectory stringByAppendingPathComponent:@"Payload/Foo.app"];
+  XCTAssertEqualObjects([NSData dataWithContentsOfFile:[bundle stringByAppendingPathComponent:@"Resources/Large.txt"]], [NSData dataWithContentsOfFile:[source stringByAppendingPathComponent:@"Resources/Large.txt"]]);
+  XCTAssertTrue([NSFileManager.defaultManager isExecutableFileAtPath:[bundle stringByAppendingPathComponent:@"Foo"]]);
+  XCTAssertEqualObjects([NSFileManager.defaultManager destinationOfSymbolicLinkAtPath:[bundle stringByAppendingPathComponent:@"Link.txt"] error:nil], @"Resources/Large.txt");
+}
+
+- (void)streamArchiveAtPath:(NSString *)archivePath toDirectory:(NSURL *)destination chunkSize:(NSUInteger)chunkSize
+{
+  NSData *archive = [NSData dataWithContentsOfFile:archivePath];
+  FBArchiveUnpacker *unpacker = [FBArchiveUnpacker streamingUnpackerToDirectory:destination];
+  for (NSUInteger offset = 0; offset < archive.length; offset += chunkSize) {
+    [unpacker consumeData:[archive subdataWithRange:NSMakeRange(offset, MIN(chunkSize, archive.length - offset))]];
+  }
+  [unpacker consumeEndOfFile];
+  NSError *error = nil;
+  XCTAssertNotNil([unpacker.completed awaitWithTimeout:20 error:&error], @"%@", error);
+}
+
+- (void)testExtractsZipFromDisk
+{
+  NSString *archive = [self archivePathWithName:@"Foo.ipa"];
+  [self runArchiverWithLaunchPath:@"/usr/bin/zip" arguments:@[@"-q", @"-r", @"-y", archive, @"Payload"]];
+  NSURL *destination = [self emptyDestination];
+
+  NSError *error = nil;
+  XCTAssertTrue([FBArchiveUnpacker extractArchiveAtPath:archive toDirectory:destination error:&error], @"%@", error);
+  [self assertExtractedBundleAtDirectory:destination];
+}
+
+- (void)testStreamsZipWithDataDescriptors
+{
+  // ditto writes the sizes of entries after their data.
+  NSString *archive = [self archivePathWithName:@"Foo.zip"];
+  [self runArchiverWithLaunchPath:@"/usr/bin/ditto" arguments:@[@"-c", @"-k", @"--sequesterRsrc", @".", archive]];
+  NSURL *destination = [self emptyDestination];
+
+  [self streamArchiveAtPath:archive toDirectory:destination chunkSize:1000];
+  [self assertExtractedBundleAtDirectory:destination];
+}
+
+- (void)testStreamsZipWithKnownSizes
+{
+  NSString *archive = [self archivePathWithName:@"Foo.ipa"];
+  [self runArchiverWithLaunchPath:@"/usr/bin/zip" arguments:@[@"-q", @"-r", @"-y", archive, @"Payload"]];
+  NSURL *destination = [self emptyDestination];
+
+  [self streamArchiveAtPath:archive toDirectory:destination chunkSize:777];
+  [self assertExtractedBundleAtDirectory:destination];
+}
+
+- (void)testExtractsCompressedTar
+{
+  NSString *archive = [self archivePathWithName:@"Foo.tar.gz"];
+  [self runArchiverWithLaunchPath:@"/usr/bin/tar" arguments:@[@"-c", @"-z", @"-f", archive, @"Payload"]];
+  NSURL *streamDestination = [self emptyDestination];
+  NSURL *fileDestination = [self emptyDestination];
+
+  [self streamArchiveAtPath:archive toDirectory:streamDestination chunkSize:4096];
+  [self assertExtractedBundleAtDirectory:streamDestination];
+  NSError *error = nil;
+  XCTAssertTrue([FBArchiveUnpacker extractArchiveAtPath:archive toDirectory:fileDestination error:&error], @"%@", error);
+  [self assertExtractedBundleAtDirectory:fileDestination];
+}
+
+- (void)testRejectsEntriesOutsideOfDestination
+{
+  // A ZIP with a single stored, empty, entry named "../evil".
+  NSMutableData *archive = [NSMutableData data];
+  const char *name = "../evil";
+  uint16_t nameLength = (uint16_t) strlen(name);
+  uint8_t local[30] = {0x50, 0x4b, 0x03, 0x04, 20, 0};
+  local[26] = (uint8_t) nameLength;
+  [archive appendBytes:local length:sizeof(local)];
+  [archive appendBytes:name length:nameLength];
+  uint8_t central[46] = {0x50, 0x4b, 0x01, 0x02, 20, 0, 20, 0};
+  central[28] = (uint8_t) nameLength;
+  uint32_t directoryOffset = (uint32_t) archive.length;
+  [archive appendBytes:central length:sizeof(central)];
+  [archive appendBytes:name length:nameLength];
+  uint32_t directoryLength = (uint32_t) archive.length - directoryOffset;
+  uint8_t end[22] = {0x50, 0x4b, 0x05, 0x06, 0, 0, 0, 0, 1, 0, 1, 0};
+  memcpy(end + 12, &directoryLength, 4);
+  memcpy(end + 16, &directoryOffset, 4);
+  [archive appendBytes:end length:sizeof(end)];
+  NSString *archivePath = [self.directory stringByAppendingPathComponent:@"Evil.zip"];
+  [archive writeToFile:archivePath atomically:NO];
+  NSURL *destination = [self emptyDestination];
+
+  NSError *error = nil;
+  XCTAssertFalse([FBArchiveUnpacker extractArchiveAtPath:archivePath toDirectory:destination error:&error]);
+  XCTAssertNotNil(error);
+
+  FBArchiveUnpacker *unpacker = [FBArchiveUnpacker streamingUnpackerToDirectory:destination];
+  [unpacker consumeData:archive];
+  [unpacker consumeEndOfFile];
+  XCTAssertNil([unpacker.completed awaitWithTimeout:5 error:&error]);
+  XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:[self.directory stringByAppendingPathComponent:@"evil"]]);
+}
+
+- (void)assertRejectsTarEntries:(void (^)(NSMutableData *archive))entries prepareDestination:(void (^)(NSURL *destination))prepareDestination
+{
+  NSMutableData *archive = [NSMutableData data];
+  entries(archive);
+  [archive increaseLengthBy:1024];
+  NSString *archivePath = [self.directory stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.tar", NSUUID.UUID.UUIDString]];
+  [archive writeToFile:archivePath atomically:NO];
+
+  NSURL *destination = [self emptyDestination];
+  prepareDestination(destination);
+  NSError *error = nil;
+  XCTAssertFalse([FBArchiveUnpacker extractArchiveAtPath:archivePath toDirectory:destination error:&error]);
+  XCTAssertNotNil(error);
+
+  destination = [self emptyDestination];
+  prepareDestination(destination);
+  FBArchiveUnpacker *unpacker = [FBArchiveUnpacker streamingUnpackerToDirectory:destination];
+  [unpacker consumeData:archive];
+  [unpacker consumeEndOfFile];
+  XCTAssertNil([unpacker.completed awaitWithTimeout:5 error:&error]);
+}
+
+- (void)testRejectsEntriesWrittenThroughSymbolicLinks
+{
+  NSString *outside = [self.directory stringByAppendingPathComponent:@"Outside"];
+  [NSFileManager.defaultManager createDirectoryAtPath:outside withIntermediateDirectories:YES attributes:nil error:nil];
+
+  [self assertRejectsTarEntries:^(NSMutableData *archive) {
+    AppendTarEntry(archive, @"a", '2', outside, NSData.data);
+    AppendTarEntry(archive, @"a/x", '0', @"", [@"evil" dataUsingEncoding:NSUTF8StringEncoding]);
+  } prepareDestination:^(NSURL *destination) {}];
+  XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:[outside stringByAppendingPathComponent:@"x"]]);
+
+  // A link that is already in the destination is not followed either.
+  [self assertRejectsTarEntries:^(NSMutableData *archive) {
+    AppendTarEntry(archive, @"a/x", '0', @"", [@"evil" dataUsingEncoding:NSUTF8StringEncoding]);
+  } prepareDestination:^(NSURL *destination) {
+    [NSFileManager.defaultManager createSymbolicLinkAtPath:[destination.path stringByAppendingPathComponent:@"a"] withDestinationPath:outside error:nil];
+  }];
+  XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:[outside stringByAppendingPathComponent:@"x"]]);
+}
+
+- (void)testRejectsHardLinksThroughSymbolicLinks
+{
+  NSString *outside = [self.directory stringByAppendingPathComponent:@"Outside"];
+  [NSFileManager.defaultManager createDirectoryAtPath:outside withIntermediateDirectories:YES attributes:nil error:nil];
+  NSString *secret = [outside stringByAppendingPathComponent:@"secret"];
+  [@"secret" writeToFile:secret atomically:NO encoding:NSUTF8StringEncoding error:nil];
+
+  [self assertRejectsTarEntries:^(NSMutableData *archive) {
+    AppendTarEntry(archive, @"a", '2', outside, NSData.data);
+    AppendTarEntry(archive, @"b", '1', @"a/secret", NSData.data);
+    AppendTarEntry(archive, @"b", '0', @"", [@"evil" dataUsingEncoding:NSUTF8StringEncoding]);
+  } prepareDestination:^(NSURL *destination) {}];
+  XCTAssertEqualObjects([NSString stringWithContentsOfFile:secret encoding:NSUTF8StringEncoding error:nil], @"secret");
+  struct stat secretStat;
+  XCTAssertEqual(stat(secret.fileSystemRepresentation, &secretStat), 0);
+  XCTAssertEqual(secretStat.st_nlink, 1u);
+}
+
+@end
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+#import <mach-o/loader.h>
+
+#import "FBControlCoreFixtures.h"
+
+@interface FBBinaryParserTests : XCTestCase
+
+@end
+
+@implementation FBBinaryParserTests
+
+- (void)testParsesThinLoadCommands
+{
+  NSError *error = nil;
+  FBMachOFile *file = [FBBinaryParser machOFileAtPath:FBControlCoreFixtures.thinMachOPath error:&error];
+  XCTAssertNil(error);
+  XCTAssertFalse(file.isFat);
+  XCTAssertEqualObjects(file.architectures, [NSSet setWithObject:@"arm64"]);
+  XCTAssertEqual(file.slices.count, 1u);
+
+  FBMachOSlice *slice = file.slices.firstObject;
+  XCTAssertEqual(slice.fileType, (uint32_t) MH_DYLIB);
+  XCTAssertEqualObjects(slice.uuid, [[NSUUID alloc] initWithUUIDString:@"8A1E5B7C-3F2D-4C1B-9E0A-6D5F4C3B2A19"]);
+  XCTAssertEqualObjects(slice.installName, @"@rpath/Fixture.framework/Fixture");
+  NSArray<NSString *> *expectedDylibs = @[@"/usr/lib/libSystem.B.dylib", @"/System/Library/Frameworks/UIKit.framework/UIKit"];
+  XCTAssertEqualObjects(slice.linkedDylibs, expectedDylibs);
+  XCTAssertEqualObjects(slice.rpaths, @[@"@executable_path/Frameworks"]);
+  XCTAssertEqual(slice.codeSignatureRange.location, 0x1000u);
+  XCTAssertEqual(slice.codeSignatureRange.length, 0x20u);
+  XCTAssertEqual(slice.loadCommands.count, 6u);
+  XCTAssertFalse(slice.isEncrypted);
+}
+
+- (void)testParsesFatSlices
+{
+  NSError *error = nil;
+  FBMachOFile *file = [FBBinaryParser machOFileAtPath:FBControlCoreFixtures.fatMachOPath error:&error];
+  XCTAssertNil(error);
+  XCTAssertTrue(file.isFat);
+  XCTAssertEqual(file.slices.count, 2u);
+  NSSet<NSString *> *expected = [NSSet setWithArray:@[@"x86_64", @"i386"]];
+  XCTAssertEqualObjects(file.architectures, expected);
+  XCTAssertEqualObjects([FBBinaryParser architecturesForBinaryAtPath:FBControlCoreFixtures.fatMachOPath error:nil], expected);
+
+  FBMachOSlice *x86_64 = file.slices[0];
+  XCTAssertEqual(x86_64.range.location, 0x1000u);
+  XCTAssertEqual(x86_64.fileType, (uint32_t) MH_EXECUTE);
+  XCTAssertEqualObjects(x86_64.uuid, [[NSUUID alloc] initWithUUIDString:@"11111111-2222-3333-4444-555555555555"]);
+  XCTAssertEqualObjects(x86_64.linkedDylibs, @[@"/usr/lib/libSystem.B.dylib"]);
+  XCTAssertEqual(x86_64.codeSignatureRange.location, (NSUInteger) NSNotFound);
+
+  FBMachOSlice *i386 = file.slices[1];
+  XCTAssertEqual(i386.range.location, 0x2000u);
+  XCTAssertEqualObjects(i386.uuid, [[NSUUID alloc] initWithUUIDString:@"66666666-7777-8888-9999-AAAAAAAAAAAA"]);
+  XCTAssertEqualObjects(i386.linkedDylibs, @[]);
+}
+
+- (void)testMemoizesUntilModified
+{
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  XCTAssertTrue([NSFileManager.defaultManager copyItemAtPath:FBControlCoreFixtures.thinMachOPath toPath:path error:nil]);
+
+  FBMachOFile *first = [FBBinaryParser machOFileAtPath:path error:nil];
+  XCTAssertNotNil(first);
+  XCTAssertEqual([FBBinaryParser machOFileAtPath:path error:nil], first);
+
+  [NSFileManager.defaultManager removeItemAtPath:path error:nil];
+  XCTAssertTrue([NSFileManager.defaultManager copyItemAtPath:FBControlCoreFixtures.fatMachOPath toPath:path error:nil]);
+  FBMachOFile *second = [FBBinaryParser machOFileAtPath:path error:nil];
+  XCTAssertNotEqual(second, first);
+  XCTAssertTrue(second.isFat);
+
+  [NSFileManager.defaultManager removeItemAtPath:path error:nil];
+}
+
+- (void)testRejectsTruncatedBinaries
+{
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  NSData *data = [NSData dataWithContentsOfFile:FBControlCoreFixtures.fatMachOPath];
+  [[data subdataWithRange:NSMakeRange(0, 0x1800)] writeToFile:path atomically:NO];
+
+  NSError *error = nil;
+  XCTAssertNil([FBBinaryParser machOFileAtPath:path error:&error]);
+  XCTAssertNotNil(error);
+
+  [NSFileManager.defaultManager removeItemAtPath:path error:nil];
+}
+
+- (void)testRejectsSlicesWhoseBoundsOverflow
+{
+  // A 64-bit fat header with a single slice, whose offset plus size wraps around to a small value.
+  uint8_t bytes[0x1000] = {0};
+  uint32_t header[2] = { OSSwapHostToBigInt32(0xcafebabf), OSSwapHostToBigInt32(1) };
+  memcpy(bytes, header, sizeof(header));
+  uint64_t offset = OSSwapHostToBigInt64(UINT64_MAX - 0x7ff);
+  uint64_t size = OSSwapHostToBigInt64(0x1000);
+  memcpy(bytes + sizeof(header) + 8, &offset, sizeof(offset));
+  memcpy(bytes + sizeof(header) + 16, &size, sizeof(size));
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  [[NSData dataWithBytes:bytes length:sizeof(bytes)] writeToFile:path atomically:NO];
+
+  NSError *error = nil;
+  XCTAssertNil([FBBinaryParser machOFileAtPath:path error:&error]);
+  XCTAssertNotNil(error);
+
+  [NSFileManager.defaultManager removeItemAtPath:path error:nil];
+}
+
+- (void)testScansBundleInParallel
+{
+  NSString *bundle = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  NSString *frameworks = [bundle stringByAppendingPathComponent:@"Frameworks/Fixture.framework"];
+  [NSFileManager.defaultManager createDirectoryAtPath:frameworks withIntermediateDirectories:YES attributes:nil error:nil];
+  [NSFileManager.defaultManager copyItemAtPath:FBControlCoreFixtures.fatMachOPath toPath:[bundle stringByAppendingPathComponent:@"App"] error:nil];
+  [NSFileManager.defaultManager copyItemAtPath:FBControlCoreFixtures.thinMachOPath toPath:[frameworks stringByAppendingPathComponent:@"Fixture"] error:nil];
+  [@"Not a binary" writeToFile:[bundle stringByAppendingPathComponent:@"Info.plist"] atomically:NO encoding:NSUTF8StringEncoding error:nil];
+
+  NSError *error = nil;
+  NSDictionary<NSString *, FBMachOFile *> *files = [[FBBinaryParser onQueue:dispatch_get_main_queue() machOFilesInBundleAtPath:bundle] awaitWithTimeout:5 error:&error];
+  XCTAssertNil(error);
+  XCTAssertEqual(files.count, 2u);
+  NSSet<NSString *> *names = [NSSet setWithArray:[files.allKeys valueForKey:@"lastPathComponent"]];
+  NSSet<NSString *> *expected = [NSSet setWithArray:@[@"App", @"Fixture"]];
+  XCTAssertEqualObjects(names, expected);
+
+  [NSFileManager.defaultManager removeItemAtPath:bundle error:nil];
+}
+
+@end
@@ -24,6 +24,8 @@
     [FBBitmapStreamConfiguration configurationWithEncoding:FBBitmapStreamEncodingBGRA framesPerSecond:@60],
     [FBBitmapStreamConfiguration configurationWithEncoding:FBBitmapStreamEncodingBGRA framesPerSecond:nil],
     [FBBitmapStreamConfiguration configurationWithEncoding:FBBitmapStreamEncodingH264 framesPerSecond:nil],
+    [FBBitmapStreamConfiguration configurationWithEncoding:FBBitmapStreamEncodingBGRA framesPerSecond:@60 latencyBudget:@0.1],
+    [FBBitmapStreamConfiguration configurationWithEncoding:FBBitmapStreamEncodingBGRA framesPerSecond:nil latencyBudget:@0.25],
   ];
 
   [self assertEqualityOfCopy:configurations];
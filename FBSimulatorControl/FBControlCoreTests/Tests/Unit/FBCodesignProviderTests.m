@@ -0,0 +1,222 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <CommonCrypto/CommonDigest.h>
+#import <FBControlCore/FBControlCore.h>
+#import <mach-o/loader.h>
+#import <sys/stat.h>
+
+static void AppendBigEndian32(NSMutableData *data, uint32_t value)
+{
+  uint32_t bigEndian = CFSwapInt32HostToBig(value);
+  [data appendBytes:&bigEndian length:sizeof(bigEndian)];
+}
+
+static NSData *CodeDirectoryWithIdentifier(NSString *identifier)
+{
+  // Only the header fields that are inspected are populated.
+  NSData *identifierData = [identifier dataUsingEncoding:NSUTF8StringEncoding];
+  NSMutableData *codeDirectory = [NSMutableData dataWithLength:88];
+  [codeDirectory appendData:identifierData];
+  [codeDirectory appendBytes:"\0" length:1];
+  uint8_t *bytes = codeDirectory.mutableBytes;
+  uint32_t header[] = {CFSwapInt32HostToBig(0xfade0c02), CFSwapInt32HostToBig((uint32_t) codeDirectory.length), CFSwapInt32HostToBig(0x20400)};
+  memcpy(bytes, header, sizeof(header));
+  bytes[36] = CC_SHA256_DIGEST_LENGTH;
+  bytes[37] = 2;
+  return codeDirectory;
+}
+
+static NSData *SignedBinaryWithCodeDirectory(NSData *codeDirectory)
+{
+  NSMutableData *signature = [NSMutableData data];
+  AppendBigEndian32(signature, 0xfade0cc0);
+  AppendBigEndian32(signature, (uint32_t) (20 + codeDirectory.length));
+  AppendBigEndian32(signature, 1);
+  AppendBigEndian32(signature, 0);
+  AppendBigEndian32(signature, 20);
+  [signature appendData:codeDirectory];
+
+  struct mach_header_64 header = {MH_MAGIC_64, CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_ALL, MH_EXECUTE, 1, sizeof(struct linkedit_data_command), 0, 0};
+  struct linkedit_data_command command = {LC_CODE_SIGNATURE, sizeof(struct linkedit_data_command), 0x1000, (uint32_t) signature.length};
+  NSMutableData *binary = [NSMutableData dataWithBytes:&header length:sizeof(header)];
+  [binary appendBytes:&command length:sizeof(command)];
+  binary.length = 0x1000;
+  [binary appendData:signature];
+  return binary;
+}
+
+@interface FBCodesignProviderTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+@property (nonatomic, strong, readwrite) NSMutableArray<NSString *> *signedPaths;
+@property (nonatomic, strong, readwrite) FBCodesignProvider *codesign;
+
+@end
+
+@implementation FBCodesignProviderTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  [NSFileManager.defaultManager createDirectoryAtPath:self.directory withIntermediateDirectories:YES attributes:nil error:nil];
+  self.signedPaths = [NSMutableArray array];
+  self.codesign = [self providerWithCache:[self.directory stringByAppendingPathComponent:@"cache.json"]];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (FBCodesignProvider *)providerWithCache:(NSString *)cacheFilePath
+{
+  // "Signing" replaces the executable with one that has a new, unique, Code Directory.
+  NSMutableArray<NSString *> *signedPaths = self.signedPaths;
+  return [FBCodesignProvider codeSignCommandWithIdentityName:@"-" signer:^(NSString *path, NSString *identityName) {
+    @synchronized (signedPaths) {
+      [signedPaths addObject:path.lastPathComponent];
+    }
+    NSString *executable = [path stringByAppendingPathComponent:path.lastPathComponent.stringByDeletingPathExtension];
+    if (![NSFileManager.defaultManager fileExistsAtPath:executable]) {
+      executable = path;
+    }
+    [SignedBinaryWithCodeDirectory(CodeDirectoryWithIdentifier(NSUUID.UUID.UUIDString)) writeToFile:executable atomically:YES];
+    return [FBFuture futureWithResult:NSNull.null];
+  } cacheFilePath:cacheFilePath];
+}
+
+- (NSString *)createBundleAtPath:(NSString *)path
+{
+  NSString *name = path.lastPathComponent.stringByDeletingPathExtension;
+  [NSFileManager.defaultManager createDirectoryAtPath:path withIntermediateDirectories:YES attributes:nil error:nil];
+  [@{@"CFBundleExecutable": name} writeToFile:[path stringByAppendingPathComponent:@"Info.plist"] atomically:NO];
+  [[@"unsigned" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:[path stringByAppendingPathComponent:name] atomically:NO];
+  return path;
+}
+
+- (NSString *)createApplication
+{
+  NSString *application = [self createBundleAtPath:[self.directory stringByAppendingPathComponent:@"App.app"]];
+  [self createBundleAtPath:[application stringByAppendingPathComponent:@"Frameworks/A.framework"]];
+  [[@"unsigned" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:[application stringByAppendingPathComponent:@"Frameworks/libB.dylib"] atomically:NO];
+  NSString *extension = [self createBundleAtPath:[application stringByAppendingPathComponent:@"PlugIns/C.appex"]];
+  [self createBundleAtPath:[extension stringByAppendingPathComponent:@"Frameworks/D.framework"]];
+  return application;
+}
+
+- (void)signRecursively:(NSString *)path
+{
+  NSError *error = nil;
+  XCTAssertNotNil([[self.codesign recursivelySignBundleAtPath:path] awaitWithTimeout:5 error:&error]);
+  XCTAssertNil(error);
+}
+
+- (void)testSignsNestedCodeBeforeContainingBundle
+{
+  [self signRecursively:[self createApplication]];
+
+  NSSet<NSString *> *expected = [NSSet setWithArray:@[@"App.app", @"A.framework", @"libB.dylib", @"C.appex", @"D.framework"]];
+  XCTAssertEqualObjects([NSSet setWithArray:self.signedPaths], expected);
+  XCTAssertEqual(self.signedPaths.count, expected.count);
+  XCTAssertEqualObjects(self.signedPaths.lastObject, @"App.app");
+  XCTAssertLessThan([self.signedPaths indexOfObject:@"D.framework"], [self.signedPaths indexOfObject:@"C.appex"]);
+}
+
+- (void)testSkipsItemsWithCachedCDHash
+{
+  NSString *application = [self createApplication];
+  [self signRecursively:application];
+  XCTAssertEqual(self.signedPaths.count, 5u);
+
+  [self.signedPaths removeAllObjects];
+  [self signRecursively:application];
+  XCTAssertEqualObjects(self.signedPaths, @[]);
+
+  // The cache is persisted.
+  self.codesign = [self providerWithCache:[self.directory stringByAppendingPathComponent:@"cache.json"]];
+  [self signRecursively:application];
+  XCTAssertEqualObjects(self.signedPaths, @[]);
+
+  // Changing nested code re-signs it and the bundles that contain it.
+  [[@"rebuilt" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:[application stringByAppendingPathComponent:@"Frameworks/libB.dylib"] atomically:NO];
+  [self signRecursively:application];
+  NSArray<NSString *> *expected = @[@"libB.dylib", @"App.app"];
+  XCTAssertEqualObjects(self.signedPaths, expected);
+}
+
+- (void)testResignsItemsEditedInTheSameSecond
+{
+  NSString *application = [self createApplication];
+  NSString *resource = [application stringByAppendingPathComponent:@"Resource.txt"];
+  [[@"before" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:resource atomically:NO];
+  [self signRecursively:application];
+
+  // An edit of the same size, whose modification time only differs by a nanosecond.
+  struct stat resourceStat;
+  XCTAssertEqual(stat(resource.fileSystemRepresentation, &resourceStat), 0);
+  [[@"after!" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:resource atomically:NO];
+  struct timespec times[2] = {resourceStat.st_atimespec, resourceStat.st_mtimespec};
+  times[1].tv_nsec = (times[1].tv_nsec + 1) % 1000000000;
+  XCTAssertEqual(utimensat(AT_FDCWD, resource.fileSystemRepresentation, times, 0), 0);
+
+  [self.signedPaths removeAllObjects];
+  [self signRecursively:application];
+  XCTAssertEqualObjects(self.signedPaths, @[@"App.app"]);
+}
+
+- (void)testMergesCachesSavedByOtherProviders
+{
+  NSString *cacheFilePath = [self.directory stringByAppendingPathComponent:@"cache.json"];
+  FBCodesignProvider *first = [self providerWithCache:cacheFilePath];
+  FBCodesignProvider *second = [self providerWithCache:cacheFilePath];
+  NSString *a = [self createBundleAtPath:[self.directory stringByAppendingPathComponent:@"A.framework"]];
+  NSString *b = [self createBundleAtPath:[self.directory stringByAppendingPathComponent:@"B.framework"]];
+  NSString *c = [self createBundleAtPath:[self.directory stringByAppendingPathComponent:@"C.framework"]];
+
+  // Both providers have loaded the cache before either of them saves.
+  XCTAssertNotNil([[second signBundleAtPath:b] awaitWithTimeout:5 error:nil]);
+  XCTAssertNotNil([[first signBundleAtPath:a] awaitWithTimeout:5 error:nil]);
+  XCTAssertNotNil([[second signBundleAtPath:c] awaitWithTimeout:5 error:nil]);
+
+  [self.signedPaths removeAllObjects];
+  self.codesign = [self providerWithCache:cacheFilePath];
+  for (NSString *bundle in @[a, b, c]) {
+    XCTAssertNotNil([[self.codesign signBundleAtPath:bundle] awaitWithTimeout:5 error:nil]);
+  }
+  XCTAssertEqualObjects(self.signedPaths, @[]);
+}
+
+- (void)testReadsCDHashFromCodeDirectory
+{
+  NSString *bundle = [self createBundleAtPath:[self.directory stringByAppendingPathComponent:@"Signed.framework"]];
+  NSData *codeDirectory = CodeDirectoryWithIdentifier(@"com.facebook.signed");
+  [SignedBinaryWithCodeDirectory(codeDirectory) writeToFile:[bundle stringByAppendingPathComponent:@"Signed"] atomically:NO];
+  unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+  CC_SHA256(codeDirectory.bytes, (CC_LONG) codeDirectory.length, digest);
+  NSMutableString *expected = [NSMutableString string];
+  for (NSUInteger index = 0; index < 20; index++) {
+    [expected appendFormat:@"%02x", digest[index]];
+  }
+
+  NSError *error = nil;
+  NSString *cdHash = [[self.codesign cdHashForBundleAtPath:bundle] awaitWithTimeout:5 error:&error];
+  XCTAssertNil(error);
+  XCTAssertEqualObjects(cdHash, expected);
+
+  XCTAssertNil([[self.codesign cdHashForBundleAtPath:[self createBundleAtPath:[self.directory stringByAppendingPathComponent:@"Unsigned.framework"]]] awaitWithTimeout:5 error:nil]);
+}
+
+@end
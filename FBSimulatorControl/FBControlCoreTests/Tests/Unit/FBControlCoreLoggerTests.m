@@ -79,4 +79,64 @@
   XCTAssertEqualObjects(expected, actual);
 }
 
+- (void)testBackgroundLoggerWritesAfterFlush
+{
+  id<FBConsumableBuffer> consumer = FBLineBuffer.consumableBuffer;
+  id<FBControlCoreBackgroundLogger> logger = [FBControlCoreLogger backgroundLoggerToConsumer:consumer level:FBControlCoreLogLevelInfo];
+
+  [logger log:@"HELLO"];
+  [[logger withName:@"foo"] logFormat:@"%@ %d", @"WORLD", 1];
+  [logger log:@"   "];
+
+  NSError *error = nil;
+  XCTAssertNotNil([logger.flush await:&error]);
+  XCTAssertNil(error);
+  XCTAssertEqualObjects(consumer.consumeLineString, @"HELLO");
+  XCTAssertEqualObjects(consumer.consumeLineString, @"[foo] WORLD 1");
+  XCTAssertNil(consumer.consumeLineString);
+}
+
+- (void)testBackgroundLoggerDiscardsMessagesAboveLevel
+{
+  id<FBConsumableBuffer> consumer = FBLineBuffer.consumableBuffer;
+  id<FBControlCoreBackgroundLogger> logger = [FBControlCoreLogger backgroundLoggerToConsumer:consumer level:FBControlCoreLogLevelInfo];
+
+  [logger.debug log:@"DEBUG"];
+  [logger.info log:@"INFO"];
+  [logger.error log:@"ERROR"];
+
+  XCTAssertNotNil([logger.flush await:nil]);
+  XCTAssertEqualObjects(consumer.lines, (@[@"INFO", @"ERROR", @""]));
+}
+
+- (void)testBackgroundLoggerFormatsDates
+{
+  id<FBConsumableBuffer> consumer = FBLineBuffer.consumableBuffer;
+  id<FBControlCoreBackgroundLogger> logger = [FBControlCoreLogger backgroundLoggerToConsumer:consumer level:FBControlCoreLogLevelInfo];
+
+  [[logger withDateFormatEnabled:YES] log:@"HELLO"];
+  XCTAssertNotNil([logger.flush await:nil]);
+
+  NSString *line = consumer.consumeLineString;
+  NSRegularExpression *expression = [NSRegularExpression regularExpressionWithPattern:@"^\\d{4}-\\d{2}-\\d{2} \\d{2}:\\d{2}:\\d{2}\\.\\d{3}[+-]\\d{4} HELLO$" options:0 error:nil];
+  XCTAssertEqual([expression numberOfMatchesInString:line options:0 range:NSMakeRange(0, line.length)], 1u, @"Unexpected line %@", line);
+}
+
+- (void)testThreadSafetyOfBackgroundLogger
+{
+  id<FBConsumableBuffer> consumer = FBLineBuffer.consumableBuffer;
+  id<FBControlCoreBackgroundLogger> logger = [FBControlCoreLogger backgroundLoggerToConsumer:consumer level:FBControlCoreLogLevelDebug];
+
+  dispatch_apply(1000, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^(size_t index) {
+    [logger logFormat:@"%zu", index];
+  });
+  XCTAssertNotNil([logger.flush await:nil]);
+
+  NSMutableSet<NSString *> *expected = [NSMutableSet setWithObject:@""];
+  for (NSUInteger index = 0; index < 1000; index++) {
+    [expected addObject:@(index).stringValue];
+  }
+  XCTAssertEqualObjects([NSSet setWithArray:consumer.lines], expected);
+}
+
 @end
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBDelimiterScannerTests : XCTestCase
+
+@end
+
+@implementation FBDelimiterScannerTests
+
+- (void)testScansPositionsAtEveryAlignmentAndCapacity
+{
+  uint8_t bytes[80];
+  for (NSUInteger index = 0; index < sizeof(bytes); index++) {
+    bytes[index] = (index % 7 == 0 || index == 15 || index == 16 || index == 79) ? '\n' : 'a';
+  }
+  for (size_t offset = 0; offset < 17; offset++) {
+    NSMutableArray<NSNumber *> *expected = [NSMutableArray array];
+    for (size_t index = offset; index < sizeof(bytes); index++) {
+      if (bytes[index] == '\n') {
+        [expected addObject:@(index)];
+      }
+    }
+    for (size_t capacity = 1; capacity < 5; capacity++) {
+      NSMutableArray<NSNumber *> *actual = [NSMutableArray array];
+      size_t positions[4];
+      size_t start = offset;
+      while (YES) {
+        size_t count = FBDelimiterScanPositions(bytes + start, sizeof(bytes) - start, '\n', positions, capacity);
+        for (size_t index = 0; index < count; index++) {
+          [actual addObject:@(start + positions[index])];
+        }
+        if (count < capacity) {
+          break;
+        }
+        start += positions[count - 1] + 1;
+      }
+      XCTAssertEqualObjects(actual, expected, @"Offset %zu Capacity %zu", offset, capacity);
+    }
+    XCTAssertEqual(FBDelimiterScanFirst(bytes + offset, sizeof(bytes) - offset, '\n') + offset, expected.firstObject.unsignedIntegerValue);
+  }
+  XCTAssertEqual(FBDelimiterScanFirst(bytes, sizeof(bytes), 'b'), sizeof(bytes));
+}
+
+- (void)testLocatesTerminals
+{
+  NSData *data = [@"foo\r\nbar\nba\nbaz\n" dataUsingEncoding:NSUTF8StringEncoding];
+  XCTAssertEqual([FBDelimiterScanner locationOfTerminal:[@"\n" dataUsingEncoding:NSUTF8StringEncoding] inData:data], 4u);
+  XCTAssertEqual([FBDelimiterScanner locationOfTerminal:[@"\r\n" dataUsingEncoding:NSUTF8StringEncoding] inData:data], 3u);
+  XCTAssertEqual([FBDelimiterScanner locationOfTerminal:[@"baz" dataUsingEncoding:NSUTF8StringEncoding] inData:data], 12u);
+  XCTAssertEqual([FBDelimiterScanner locationOfTerminal:[@"baz\n\n" dataUsingEncoding:NSUTF8StringEncoding] inData:data], (NSUInteger) NSNotFound);
+  XCTAssertEqual([FBDelimiterScanner locationOfTerminal:[@"foo" dataUsingEncoding:NSUTF8StringEncoding] inData:NSData.data], (NSUInteger) NSNotFound);
+}
+
+- (void)testSplitsLines
+{
+  XCTAssertEqualObjects([FBDelimiterScanner linesOfData:NSData.data], @[@""]);
+  XCTAssertEqualObjects([FBDelimiterScanner linesOfData:[@"foo\r\nbar\n\nbaz" dataUsingEncoding:NSUTF8StringEncoding]], (@[@"foo", @"bar", @"", @"baz"]));
+  XCTAssertEqualObjects([FBDelimiterScanner linesOfData:[@"foo\n" dataUsingEncoding:NSUTF8StringEncoding]], (@[@"foo", @""]));
+
+  const uint8_t invalid[] = {'a', 0xff, '\n', 'b'};
+  NSArray<NSString *> *lines = [FBDelimiterScanner linesOfData:[NSData dataWithBytes:invalid length:sizeof(invalid)]];
+  XCTAssertEqual(lines.count, 2u);
+  XCTAssertEqualObjects(lines[1], @"b");
+  XCTAssertEqualObjects(FBDelimiterLineFromBytes((const uint8_t *) "foo\r", 4), @"foo");
+  XCTAssertEqualObjects(FBDelimiterLineFromBytes(invalid, 2), @"a\u00ff");
+}
+
+- (void)testDoesNotSplitBinaryData
+{
+  const uint8_t binary[] = {'a', '\n', 'b', 0, 'c'};
+  XCTAssertFalse(FBDelimiterBytesAreText(binary, sizeof(binary)));
+  XCTAssertTrue(FBDelimiterBytesAreText(binary, 3));
+  XCTAssertEqualObjects([FBDelimiterScanner linesOfTextData:[NSData dataWithBytes:binary length:sizeof(binary)]], @[]);
+  XCTAssertEqualObjects([FBDelimiterScanner linesOfTextData:[NSData dataWithBytes:binary length:3]], (@[@"a", @"b"]));
+}
+
+- (void)testSplitsMoreLinesThanABatch
+{
+  NSMutableString *text = [NSMutableString string];
+  for (NSUInteger index = 0; index < 5000; index++) {
+    [text appendFormat:@"Line %lu\n", (unsigned long) index];
+  }
+  NSArray<NSString *> *lines = [FBDelimiterScanner linesOfData:[text dataUsingEncoding:NSUTF8StringEncoding]];
+  XCTAssertEqualObjects(lines, [text componentsSeparatedByString:@"\n"]);
+}
+
+@end
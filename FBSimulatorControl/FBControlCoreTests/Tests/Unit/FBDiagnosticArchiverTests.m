@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <sys/stat.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBDiagnosticArchiverTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+
+@end
+
+@implementation FBDiagnosticArchiverTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"FBDiagnosticArchiverTests_%@", NSUUID.UUID.UUIDString]];
+  [NSFileManager.defaultManager createDirectoryAtPath:self.directory withIntermediateDirectories:YES attributes:nil error:nil];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (NSString *)writeFile:(NSString *)name contents:(NSString *)contents
+{
+  NSString *path = [self.directory stringByAppendingPathComponent:name];
+  [NSFileManager.defaultManager createDirectoryAtPath:path.stringByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:nil];
+  XCTAssertTrue([contents writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil]);
+  return path;
+}
+
+- (FBDiagnostic *)diagnosticAtPath:(NSString *)path
+{
+  return [[[FBDiagnosticBuilder builder] updatePath:path] build];
+}
+
+- (NSDictionary<NSString *, id> *)archiveProducers:(NSDictionary<NSString *, FBDiagnosticArchiverProducer> *)producers maximumConcurrency:(NSUInteger)maximumConcurrency extractTo:(NSString *)extractPath
+{
+  [NSFileManager.defaultManager createDirectoryAtPath:extractPath withIntermediateDirectories:YES attributes:nil error:nil];
+  FBArchiveUnpacker *unpacker = [FBArchiveUnpacker streamingUnpackerToDirectory:[NSURL fileURLWithPath:extractPath]];
+  FBDiagnosticArchiver *archiver = [FBDiagnosticArchiver archiverWithConsumer:unpacker maximumConcurrency:maximumConcurrency logger:nil];
+
+  NSError *error = nil;
+  NSDictionary<NSString *, id> *manifest = [[archiver archiveProducers:producers] awaitWithTimeout:10 error:&error];
+  XCTAssertNotNil(manifest, @"%@", error);
+  XCTAssertNotNil([unpacker.completed awaitWithTimeout:10 error:&error], @"%@", error);
+  return manifest;
+}
+
+- (void)testArchivesAndLinksSharedFiles
+{
+  NSString *shared = [self writeFile:@"source/CoreSimulator.log" contents:@"shared"];
+  NSString *first = [self writeFile:@"source/first/system.log" contents:@"first"];
+  NSString *second = [self writeFile:@"source/second/system.log" contents:@"second"];
+  NSString *container = [self.directory stringByAppendingPathComponent:@"source/container"];
+  [self writeFile:@"source/container/Documents/data.txt" contents:@"data"];
+  NSString *longName = [@"" stringByPaddingToLength:120 withString:@"a" startingAtIndex:0];
+  NSString *longFile = [self writeFile:[@"source" stringByAppendingPathComponent:longName] contents:@"long"];
+
+  NSDictionary<NSString *, FBDiagnosticArchiverProducer> *producers = @{
+    @"first": ^{
+      return [FBFuture futureWithResult:@[[self diagnosticAtPath:shared], [self diagnosticAtPath:first], [self diagnosticAtPath:longFile]]];
+    },
+    @"second": ^{
+      return [FBFuture futureWithResult:@[[self diagnosticAtPath:shared], [self diagnosticAtPath:second], [self diagnosticAtPath:container]]];
+    },
+    @"third": ^{
+      return [[FBControlCoreError describe:@"No Diagnostics"] failFuture];
+    },
+  };
+  NSString *extractPath = [self.directory stringByAppendingPathComponent:@"extracted"];
+  NSDictionary<NSString *, id> *manifest = [self archiveProducers:producers maximumConcurrency:2 extractTo:extractPath];
+
+  XCTAssertEqualObjects(manifest[@"files_written"], @5);
+  XCTAssertEqualObjects(manifest[@"files_linked"], @1);
+  XCTAssertEqualObjects(manifest[@"targets"][@"first"][@"files"], (@[@"first/CoreSimulator.log", @"first/system.log", [@"first" stringByAppendingPathComponent:longName]]));
+  XCTAssertEqualObjects(manifest[@"targets"][@"second"][@"links"], (@{@"second/CoreSimulator.log": @"first/CoreSimulator.log"}));
+  XCTAssertEqualObjects(manifest[@"targets"][@"third"][@"errors"], @[@"No Diagnostics"]);
+
+  NSString *(^read)(NSString *) = ^(NSString *path) {
+    return [NSString stringWithContentsOfFile:[extractPath stringByAppendingPathComponent:path] encoding:NSUTF8StringEncoding error:nil];
+  };
+  XCTAssertEqualObjects(read(@"first/CoreSimulator.log"), @"shared");
+  XCTAssertEqualObjects(read(@"second/CoreSimulator.log"), @"shared");
+  XCTAssertEqualObjects(read(@"first/system.log"), @"first");
+  XCTAssertEqualObjects(read(@"second/system.log"), @"second");
+  XCTAssertEqualObjects(read(@"second/container/Documents/data.txt"), @"data");
+  XCTAssertEqualObjects(read([@"first" stringByAppendingPathComponent:longName]), @"long");
+  XCTAssertNotNil(read(FBDiagnosticArchiverManifestName));
+
+  struct stat firstInfo;
+  struct stat secondInfo;
+  XCTAssertEqual(stat([extractPath stringByAppendingPathComponent:@"first/CoreSimulator.log"].fileSystemRepresentation, &firstInfo), 0);
+  XCTAssertEqual(stat([extractPath stringByAppendingPathComponent:@"second/CoreSimulator.log"].fileSystemRepresentation, &secondInfo), 0);
+  XCTAssertEqual(firstInfo.st_ino, secondInfo.st_ino);
+}
+
+- (void)testBoundsConcurrency
+{
+  NSString *path = [self writeFile:@"source/system.log" contents:@"log"];
+  __block NSInteger running = 0;
+  __block NSInteger maximumRunning = 0;
+  NSMutableDictionary<NSString *, FBDiagnosticArchiverProducer> *producers = [NSMutableDictionary dictionary];
+  for (NSUInteger index = 0; index < 12; index++) {
+    producers[[NSString stringWithFormat:@"target_%lu", (unsigned long) index]] = ^{
+      @synchronized (self) {
+        running += 1;
+        maximumRunning = MAX(running, maximumRunning);
+      }
+      FBFuture<NSArray<FBDiagnostic *> *> *future = [[FBFuture futureWithResult:@[[self diagnosticAtPath:path]]] delay:0.05];
+      return [future onQueue:dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0) map:^(NSArray<FBDiagnostic *> *diagnostics) {
+        @synchronized (self) {
+          running -= 1;
+        }
+        return diagnostics;
+      }];
+    };
+  }
+  NSString *extractPath = [self.directory stringByAppendingPathComponent:@"extracted"];
+  NSDictionary<NSString *, id> *manifest = [self archiveProducers:producers maximumConcurrency:3 extractTo:extractPath];
+
+  XCTAssertEqual(maximumRunning, 3);
+  XCTAssertEqualObjects(manifest[@"files_written"], @1);
+  XCTAssertEqualObjects(manifest[@"files_linked"], @11);
+  XCTAssertEqual([manifest[@"targets"] count], 12u);
+}
+
+@end
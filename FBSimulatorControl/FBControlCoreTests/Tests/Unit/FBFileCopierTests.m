@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBFileCopierTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+@property (nonatomic, copy, readwrite) NSString *source;
+@property (nonatomic, copy, readwrite) NSString *destination;
+
+@end
+
+@implementation FBFileCopierTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  self.source = [self.directory stringByAppendingPathComponent:@"Source"];
+  self.destination = [self.directory stringByAppendingPathComponent:@"Destination"];
+  [NSFileManager.defaultManager createDirectoryAtPath:[self.source stringByAppendingPathComponent:@"Nested"] withIntermediateDirectories:YES attributes:nil error:nil];
+  [self writeString:@"first" toPath:@"a.txt"];
+  [self writeString:@"second" toPath:@"Nested/b.txt"];
+  [NSFileManager.defaultManager createSymbolicLinkAtPath:[self.source stringByAppendingPathComponent:@"link"] withDestinationPath:@"a.txt" error:nil];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (void)writeString:(NSString *)string toPath:(NSString *)path
+{
+  [[string dataUsingEncoding:NSUTF8StringEncoding] writeToFile:[self.source stringByAppendingPathComponent:path] atomically:NO];
+}
+
+- (NSString *)destinationStringAtPath:(NSString *)path
+{
+  return [NSString stringWithContentsOfFile:[self.destination stringByAppendingPathComponent:path] encoding:NSUTF8StringEncoding error:nil];
+}
+
+- (FBFileCopyStatistics *)synchronize
+{
+  NSError *error = nil;
+  FBFileCopyStatistics *statistics = [FBFileCopier synchronizeItemAtPath:self.source toPath:self.destination error:&error];
+  XCTAssertNotNil(statistics, @"%@", error);
+  return statistics;
+}
+
+- (void)assertDestinationMatchesSource
+{
+  NSArray<NSString *> *sourceEntries = [[NSFileManager.defaultManager subpathsOfDirectoryAtPath:self.source error:nil] sortedArrayUsingSelector:@selector(compare:)];
+  NSArray<NSString *> *destinationEntries = [[NSFileManager.defaultManager subpathsOfDirectoryAtPath:self.destination error:nil] sortedArrayUsingSelector:@selector(compare:)];
+  XCTAssertEqualObjects(destinationEntries, sourceEntries);
+  for (NSString *path in sourceEntries) {
+    NSString *sourcePath = [self.source stringByAppendingPathComponent:path];
+    NSString *destinationPath = [self.destination stringByAppendingPathComponent:path];
+    NSString *link = [NSFileManager.defaultManager destinationOfSymbolicLinkAtPath:sourcePath error:nil];
+    if (link) {
+      XCTAssertEqualObjects([NSFileManager.defaultManager destinationOfSymbolicLinkAtPath:destinationPath error:nil], link);
+      continue;
+    }
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:destinationPath], [NSData dataWithContentsOfFile:sourcePath], @"%@", path);
+  }
+}
+
+- (void)testCopiesTreeToNewDestination
+{
+  [self synchronize];
+  [self assertDestinationMatchesSource];
+}
+
+- (void)testUpdatesOnlyChangedFiles
+{
+  [self synchronize];
+
+  FBFileCopyStatistics *statistics = [self synchronize];
+  XCTAssertEqual(statistics.filesSkipped, 2u);
+  XCTAssertEqual(statistics.filesCopied + statistics.filesCloned, 0u);
+
+  // Changed contents are written, extraneous files are removed.
+  [self writeString:@"changed" toPath:@"Nested/b.txt"];
+  [[@"extra" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:[self.destination stringByAppendingPathComponent:@"extra.txt"] atomically:NO];
+  statistics = [self synchronize];
+  XCTAssertEqual(statistics.filesSkipped, 1u);
+  XCTAssertEqual(statistics.filesCopied + statistics.filesCloned, 1u);
+  [self assertDestinationMatchesSource];
+}
+
+- (void)testSkipsRewrittenFilesWithSameContents
+{
+  [self synchronize];
+
+  [NSThread sleepForTimeInterval:0.01];
+  [self writeString:@"first" toPath:@"a.txt"];
+  FBFileCopyStatistics *statistics = [self synchronize];
+  XCTAssertEqual(statistics.filesSkipped, 2u);
+  [self assertDestinationMatchesSource];
+}
+
+- (void)testReplacesItemsOfDifferentType
+{
+  [self synchronize];
+
+  [NSFileManager.defaultManager removeItemAtPath:[self.source stringByAppendingPathComponent:@"Nested"] error:nil];
+  [self writeString:@"now a file" toPath:@"Nested"];
+  [self synchronize];
+  [self assertDestinationMatchesSource];
+  XCTAssertEqualObjects([self destinationStringAtPath:@"Nested"], @"now a file");
+}
+
+- (void)testCopiesLargeFilesInChunks
+{
+  NSMutableData *data = [NSMutableData dataWithLength:20 * 1024 * 1024 + 17];
+  arc4random_buf(data.mutableBytes, data.length);
+  [data writeToFile:[self.source stringByAppendingPathComponent:@"large.bin"] atomically:NO];
+  [self synchronize];
+
+  [data replaceBytesInRange:NSMakeRange(data.length - 1, 1) withBytes:"\0"];
+  [data writeToFile:[self.source stringByAppendingPathComponent:@"large.bin"] atomically:NO];
+  [self synchronize];
+  [self assertDestinationMatchesSource];
+}
+
+- (void)testMergeKeepsExtraneousFiles
+{
+  [self synchronize];
+
+  [self writeString:@"changed" toPath:@"Nested/b.txt"];
+  [[@"extra" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:[self.destination stringByAppendingPathComponent:@"Nested/extra.txt"] atomically:NO];
+  NSError *error = nil;
+  FBFileCopyStatistics *statistics = [FBFileCopier mergeItemAtPath:self.source toPath:self.destination error:&error];
+  XCTAssertNotNil(statistics, @"%@", error);
+  XCTAssertEqual(statistics.filesSkipped, 1u);
+  XCTAssertEqual(statistics.filesCopied + statistics.filesCloned, 1u);
+  XCTAssertEqualObjects([self destinationStringAtPath:@"Nested/b.txt"], @"changed");
+  XCTAssertEqualObjects([self destinationStringAtPath:@"Nested/extra.txt"], @"extra");
+}
+
+@end
@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBFileFinderTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+
+@end
+
+@implementation FBFileFinderTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  for (NSString *path in @[@"Root.log", @"Documents/a.png", @"Documents/b.txt", @"Documents/Nested/c.png", @"Library/Caches/d.png", @"Library/Caches/.hidden.png", @"Library/Logs/e.log", @"tmp/f.crash"]) {
+    [self createFile:path];
+  }
+  [NSFileManager.defaultManager createDirectoryAtPath:[self.directory stringByAppendingPathComponent:@"Library/Directory.png"] withIntermediateDirectories:YES attributes:nil error:nil];
+  [NSFileManager.defaultManager createSymbolicLinkAtPath:[self.directory stringByAppendingPathComponent:@"tmp/Loop"] withDestinationPath:self.directory error:nil];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (void)createFile:(NSString *)relativePath
+{
+  NSString *path = [self.directory stringByAppendingPathComponent:relativePath];
+  [NSFileManager.defaultManager createDirectoryAtPath:path.stringByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:nil];
+  [relativePath writeToFile:path atomically:NO encoding:NSUTF8StringEncoding error:nil];
+}
+
+- (NSArray<NSString *> *)relativePaths:(NSArray<NSString *> *)paths
+{
+  NSMutableArray<NSString *> *relativePaths = [NSMutableArray array];
+  for (NSString *path in paths) {
+    [relativePaths addObject:[path substringFromIndex:self.directory.length + 1]];
+  }
+  return [relativePaths sortedArrayUsingSelector:@selector(compare:)];
+}
+
+- (void)testFindsFilenameGlobsAtAnyDepth
+{
+  NSArray<NSString *> *found = [self relativePaths:[FBFileFinder recursiveFindByFilenameGlobs:@[@"*.png", @"*.log"] inDirectory:self.directory]];
+  NSArray<NSString *> *expected = @[@"Documents/Nested/c.png", @"Documents/a.png", @"Library/Caches/d.png", @"Library/Logs/e.log", @"Root.log"];
+  XCTAssertEqualObjects(found, expected);
+}
+
+- (void)testMatchesTrailingPathComponents
+{
+  NSArray<NSString *> *found = [self relativePaths:[FBFileFinder recursiveFindByFilenameGlobs:@[@"Caches/*", @"L?gs/e.*"] inDirectory:self.directory]];
+  NSArray<NSString *> *expected = @[@"Library/Caches/d.png", @"Library/Logs/e.log"];
+  XCTAssertEqualObjects(found, expected);
+}
+
+- (void)testAnchoredGlobsOnlyMatchFromSearchedDirectory
+{
+  NSArray<NSString *> *found = [self relativePaths:[FBFileFinder recursiveFindByFilenameGlobs:@[@"/Documents/*.png", @"/Caches/*"] inDirectory:self.directory]];
+  XCTAssertEqualObjects(found, @[@"Documents/a.png"]);
+}
+
+- (void)testFindsExactFilenames
+{
+  NSArray<NSString *> *found = [self relativePaths:[FBFileFinder recursiveFindFiles:@[@"c.png", @"f.crash", @"Missing"] inDirectory:self.directory]];
+  NSArray<NSString *> *expected = @[@"Documents/Nested/c.png", @"tmp/f.crash"];
+  XCTAssertEqualObjects(found, expected);
+
+  XCTAssertEqualObjects([FBFileFinder recursiveFindFiles:@[@"c.png"] inDirectory:[self.directory stringByAppendingPathComponent:@"Missing"]], @[]);
+}
+
+- (void)testStreamsResultsBeforeCompletion
+{
+  NSMutableArray<NSString *> *found = [NSMutableArray array];
+  NSMutableArray<NSNumber *> *statesAtDelivery = [NSMutableArray array];
+  // The handler and the completion are both on the main queue, so the future is assigned before the first delivery.
+  __block FBFuture<NSNull *> *future = nil;
+  future = [FBFileFinder onQueue:dispatch_get_main_queue() findByFilenameGlobs:@[@"*.png"] inDirectory:self.directory handler:^(NSString *path) {
+    [found addObject:path];
+    [statesAtDelivery addObject:@(future.state)];
+  }];
+
+  NSError *error = nil;
+  XCTAssertNotNil([future awaitWithTimeout:5 error:&error]);
+  XCTAssertNil(error);
+  NSArray<NSString *> *expected = @[@"Documents/Nested/c.png", @"Documents/a.png", @"Library/Caches/d.png"];
+  XCTAssertEqualObjects([self relativePaths:found], expected);
+  XCTAssertEqualObjects(statesAtDelivery, (@[@(FBFutureStateRunning), @(FBFutureStateRunning), @(FBFutureStateRunning)]));
+}
+
+@end
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBIncrementalLogReaderTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+@property (nonatomic, copy, readwrite) NSString *logPath;
+
+@end
+
+@implementation FBIncrementalLogReaderTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"FBIncrementalLogReaderTests_%@", NSUUID.UUID.UUIDString]];
+  [NSFileManager.defaultManager createDirectoryAtPath:self.directory withIntermediateDirectories:YES attributes:nil error:nil];
+  self.logPath = [self.directory stringByAppendingPathComponent:@"system.log"];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (void)append:(NSString *)text
+{
+  if (![NSFileManager.defaultManager fileExistsAtPath:self.logPath]) {
+    XCTAssertTrue([text writeToFile:self.logPath atomically:NO encoding:NSUTF8StringEncoding error:nil]);
+    return;
+  }
+  NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:self.logPath];
+  [handle seekToEndOfFile];
+  [handle writeData:[text dataUsingEncoding:NSUTF8StringEncoding]];
+  [handle closeFile];
+}
+
+- (NSArray<NSString *> *)readLines:(FBIncrementalLogReader *)reader
+{
+  NSError *error = nil;
+  NSArray<NSString *> *lines = [reader readAppendedLinesAtPath:self.logPath error:&error];
+  XCTAssertNotNil(lines, @"%@", error);
+  return lines;
+}
+
+- (void)testReadsAppendedLinesOnly
+{
+  FBIncrementalLogReader *reader = [FBIncrementalLogReader readerWithStatePath:nil];
+  [self append:@"first\nsecond\nthi"];
+
+  XCTAssertEqualObjects([self readLines:reader], (@[@"first", @"second"]));
+  XCTAssertEqualObjects([self readLines:reader], @[]);
+
+  [self append:@"rd\nfourth\n"];
+  XCTAssertEqualObjects([self readLines:reader], (@[@"third", @"fourth"]));
+  XCTAssertEqualObjects([self readLines:reader], @[]);
+}
+
+- (void)testReadsFromStartAfterRotationOrTruncation
+{
+  FBIncrementalLogReader *reader = [FBIncrementalLogReader readerWithStatePath:nil];
+  [self append:@"first\nsecond\n"];
+  XCTAssertEqualObjects([self readLines:reader], (@[@"first", @"second"]));
+
+  // Replacing the file changes the inode, even if the new file is larger.
+  NSString *rotated = [self.directory stringByAppendingPathComponent:@"system.log.new"];
+  XCTAssertTrue([@"rotated first\nrotated second\nrotated third\n" writeToFile:rotated atomically:NO encoding:NSUTF8StringEncoding error:nil]);
+  XCTAssertEqual(rename(rotated.fileSystemRepresentation, self.logPath.fileSystemRepresentation), 0);
+  XCTAssertEqualObjects([self readLines:reader], (@[@"rotated first", @"rotated second", @"rotated third"]));
+
+  NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:self.logPath];
+  [handle truncateFileAtOffset:0];
+  [handle closeFile];
+  [self append:@"truncated\n"];
+  XCTAssertEqualObjects([self readLines:reader], @[@"truncated"]);
+
+  [reader resetPath:self.logPath];
+  XCTAssertEqualObjects([self readLines:reader], @[@"truncated"]);
+}
+
+- (void)testPersistsOffsetsAcrossReaders
+{
+  NSString *statePath = [self.directory stringByAppendingPathComponent:@"offsets.json"];
+  [self append:@"first\n"];
+  FBIncrementalLogReader *reader = [FBIncrementalLogReader readerWithStatePath:statePath];
+  XCTAssertEqualObjects([self readLines:reader], @[@"first"]);
+  XCTAssertEqual(reader.bytesRead, 6u);
+
+  [self append:@"second\n"];
+  reader = [FBIncrementalLogReader readerWithStatePath:statePath];
+  XCTAssertEqualObjects([self readLines:reader], @[@"second"]);
+  XCTAssertEqual(reader.bytesRead, 7u);
+}
+
+- (void)testBatchSearchSinceLastRead
+{
+  [self append:@"Foo 1\nBar 1\n"];
+  FBDiagnostic *diagnostic = [[[[FBDiagnosticBuilder builder] updatePath:self.logPath] updateShortName:@"system_log"] build];
+  FBBatchLogSearch *search = [FBBatchLogSearch searchWithMapping:@{@"system_log": @[[FBLogSearchPredicate substrings:@[@"Foo"]]]} options:FBBatchLogSearchOptionsFullLines since:nil error:nil];
+  FBIncrementalLogReader *reader = [FBIncrementalLogReader readerWithStatePath:nil];
+
+  XCTAssertEqualObjects([search searchDiagnostics:@[diagnostic] sinceLastReadOf:reader].mapping, (@{@"system_log": @[@"Foo 1"]}));
+  XCTAssertEqualObjects([search searchDiagnostics:@[diagnostic] sinceLastReadOf:reader].mapping, @{});
+
+  [self append:@"Bar 2\nFoo 2\n"];
+  XCTAssertEqualObjects([search searchDiagnostics:@[diagnostic] sinceLastReadOf:reader].mapping, (@{@"system_log": @[@"Foo 2"]}));
+  XCTAssertEqualObjects([search searchDiagnostics:@[diagnostic]].mapping, (@{@"system_log": @[@"Foo 1", @"Foo 2"]}));
+}
+
+@end
@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBLogHubTests : XCTestCase
+
+@end
+
+@implementation FBLogHubTests
+
+- (void)consumeString:(NSString *)string hub:(FBLogHub *)hub
+{
+  [hub consumeData:[string dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+- (NSArray<NSString *> *)linesOfBuffer:(id<FBAccumulatingBuffer>)buffer
+{
+  NSError *error = nil;
+  XCTAssertNotNil([buffer.eofHasBeenReceived awaitWithTimeout:5 error:&error], @"%@", error);
+  NSArray<NSString *> *lines = buffer.lines;
+  if ([lines.lastObject isEqualToString:@""]) {
+    lines = [lines subarrayWithRange:NSMakeRange(0, lines.count - 1)];
+  }
+  return lines;
+}
+
+- (void)testSplitsLinesToSubscribersWithPredicates
+{
+  FBLogHub *hub = [FBLogHub hubWithReplayCapacity:10 logger:nil];
+  id<FBAccumulatingBuffer> all = FBLineBuffer.accumulatingBuffer;
+  id<FBAccumulatingBuffer> crashes = FBLineBuffer.accumulatingBuffer;
+  [hub subscribeWithPredicate:nil consumer:all queueCapacity:100 replay:NO];
+  [hub subscribeWithPredicate:[FBLogSearchPredicate substrings:@[@"crash"]] consumer:crashes queueCapacity:100 replay:NO];
+  XCTAssertEqual(hub.subscriberCount, 2u);
+
+  [self consumeString:@"first line\nsecond " hub:hub];
+  [self consumeString:@"line with crash\nthird" hub:hub];
+  [hub consumeEndOfFile];
+
+  NSArray<NSString *> *expected = @[@"first line", @"second line with crash", @"third"];
+  XCTAssertEqualObjects([self linesOfBuffer:all], expected);
+  XCTAssertEqualObjects([self linesOfBuffer:crashes], @[@"second line with crash"]);
+  XCTAssertEqual(hub.subscriberCount, 0u);
+}
+
+- (void)testReplaysRecentLinesToLateSubscribers
+{
+  FBLogHub *hub = [FBLogHub hubWithReplayCapacity:2 logger:nil];
+  [self consumeString:@"one\ntwo\nthree\n" hub:hub];
+
+  id<FBAccumulatingBuffer> replayed = FBLineBuffer.accumulatingBuffer;
+  id<FBAccumulatingBuffer> live = FBLineBuffer.accumulatingBuffer;
+  [hub subscribeWithPredicate:nil consumer:replayed queueCapacity:100 replay:YES];
+  [hub subscribeWithPredicate:nil consumer:live queueCapacity:100 replay:NO];
+  [self consumeString:@"four\n" hub:hub];
+  [hub consumeEndOfFile];
+
+  NSArray<NSString *> *expected = @[@"two", @"three", @"four"];
+  XCTAssertEqualObjects([self linesOfBuffer:replayed], expected);
+  XCTAssertEqualObjects([self linesOfBuffer:live], @[@"four"]);
+}
+
+- (void)testCancellingUnsubscribes
+{
+  FBLogHub *hub = [FBLogHub hubWithReplayCapacity:10 logger:nil];
+  id<FBAccumulatingBuffer> buffer = FBLineBuffer.accumulatingBuffer;
+  FBLogHubSubscription *subscription = [hub subscribeWithPredicate:nil consumer:buffer queueCapacity:100 replay:NO];
+  [self consumeString:@"before\n" hub:hub];
+  [[subscription.completed cancel] awaitWithTimeout:5 error:nil];
+  XCTAssertEqual(hub.subscriberCount, 0u);
+  [self consumeString:@"after\n" hub:hub];
+
+  XCTAssertEqualObjects([self linesOfBuffer:buffer], @[@"before"]);
+  XCTAssertEqualObjects(subscription.futureType, FBiOSTargetFutureTypeLogTail);
+}
+
+- (void)testSlowSubscribersDropLines
+{
+  FBLogHub *hub = [FBLogHub hubWithReplayCapacity:10 logger:nil];
+  dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+  NSMutableArray<NSString *> *slowLines = [NSMutableArray array];
+  id<FBDataConsumer> slow = [FBLineDataConsumer synchronousReaderWithConsumer:^(NSString *line) {
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    [slowLines addObject:line];
+  }];
+  id<FBAccumulatingBuffer> fast = FBLineBuffer.accumulatingBuffer;
+  FBLogHubSubscription *slowSubscription = [hub subscribeWithPredicate:nil consumer:slow queueCapacity:2 replay:NO];
+  [hub subscribeWithPredicate:nil consumer:fast queueCapacity:100 replay:NO];
+
+  for (NSUInteger index = 0; index < 10; index++) {
+    [self consumeString:[NSString stringWithFormat:@"%lu\n", (unsigned long) index] hub:hub];
+  }
+  [hub consumeEndOfFile];
+  for (NSUInteger index = 0; index < 10; index++) {
+    dispatch_semaphore_signal(semaphore);
+  }
+
+  XCTAssertEqual([self linesOfBuffer:fast].count, 10u);
+  XCTAssertEqual(slowSubscription.linesDropped, 8u);
+  XCTAssertNotNil([slowSubscription.completed awaitWithTimeout:5 error:nil]);
+  NSArray<NSString *> *expected = @[@"0", @"1"];
+  XCTAssertEqualObjects(slowLines, expected);
+}
+
+- (void)testUnboundedSubscribersReceiveEveryLine
+{
+  FBLogHub *hub = [FBLogHub hubWithReplayCapacity:10 logger:nil];
+  dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+  NSMutableArray<NSString *> *slowLines = [NSMutableArray array];
+  id<FBDataConsumer> slow = [FBLineDataConsumer synchronousReaderWithConsumer:^(NSString *line) {
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    [slowLines addObject:line];
+  }];
+  FBLogHubSubscription *subscription = [hub subscribeWithPredicate:nil consumer:slow queueCapacity:0 replay:NO];
+
+  NSMutableArray<NSString *> *expected = [NSMutableArray array];
+  for (NSUInteger index = 0; index < 100; index++) {
+    [expected addObject:[NSString stringWithFormat:@"%lu", (unsigned long) index]];
+    [self consumeString:[expected.lastObject stringByAppendingString:@"\n"] hub:hub];
+  }
+  [hub consumeEndOfFile];
+  for (NSUInteger index = 0; index < expected.count; index++) {
+    dispatch_semaphore_signal(semaphore);
+  }
+
+  XCTAssertNotNil([subscription.completed awaitWithTimeout:5 error:nil]);
+  XCTAssertEqual(subscription.linesDropped, 0u);
+  XCTAssertEqualObjects(slowLines, expected);
+}
+
+@end
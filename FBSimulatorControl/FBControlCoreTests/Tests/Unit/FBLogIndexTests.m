@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBLogIndexTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+@property (nonatomic, copy, readwrite) NSString *logPath;
+@property (nonatomic, copy, readwrite) NSString *indexPath;
+
+@end
+
+@implementation FBLogIndexTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"FBLogIndexTests_%@", NSUUID.UUID.UUIDString]];
+  [NSFileManager.defaultManager createDirectoryAtPath:self.directory withIntermediateDirectories:YES attributes:nil error:nil];
+  self.logPath = [self.directory stringByAppendingPathComponent:@"system.log"];
+  self.indexPath = [FBLogIndex indexPathForPath:self.logPath inDirectory:[self.directory stringByAppendingPathComponent:@"indexes"]];
+
+  NSString *log = [@[
+    @"Jan 1 00:00:00 SpringBoard[100]: Application launched com.example.app",
+    @"Jan 1 00:00:01 backboardd[101]: Display on",
+    @"Jan 1 00:00:02 com.example.app[102]: Assertion failure in -[Foo bar]",
+    @"Jan 1 00:00:03 SpringBoard[100]: Application terminated com.example.app",
+    @"Jan 1 00:00:04 com.example.app[103]: Foobar ready",
+    @"Jan 1 00:00:05 unterminated final line",
+  ] componentsJoinedByString:@"\n"];
+  [log writeToFile:self.logPath atomically:YES encoding:NSUTF8StringEncoding error:nil];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (FBLogIndex *)index
+{
+  NSError *error = nil;
+  FBLogIndex *index = [FBLogIndex indexForPath:self.logPath indexPath:self.indexPath error:&error];
+  XCTAssertNotNil(index, @"%@", error);
+  return index;
+}
+
+- (void)testIndexesLines
+{
+  FBLogIndex *index = self.index;
+  XCTAssertEqual(index.lineCount, 6u);
+  XCTAssertGreaterThan(index.trigramCount, 0u);
+  XCTAssertTrue([NSFileManager.defaultManager fileExistsAtPath:self.indexPath]);
+}
+
+- (void)testSubstringSearchOnlyTouchesCandidateLines
+{
+  FBLogIndex *index = self.index;
+  FBLogSearchPredicate *predicate = [FBLogSearchPredicate substrings:@[@"Application", @"Foobar"]];
+
+  NSMutableIndexSet *expected = [NSMutableIndexSet indexSetWithIndex:0];
+  [expected addIndex:3];
+  [expected addIndex:4];
+  XCTAssertEqualObjects([index candidateLinesForPredicate:predicate], expected);
+  XCTAssertEqualObjects([index searchWithPredicate:predicate].matchingLines, (@[
+    @"Jan 1 00:00:00 SpringBoard[100]: Application launched com.example.app",
+    @"Jan 1 00:00:03 SpringBoard[100]: Application terminated com.example.app",
+    @"Jan 1 00:00:04 com.example.app[103]: Foobar ready",
+  ]));
+  XCTAssertEqualObjects([index searchWithPredicate:[FBLogSearchPredicate substrings:@[@"final line"]]].matchingLines, @[@"Jan 1 00:00:05 unterminated final line"]);
+  XCTAssertEqualObjects([index candidateLinesForPredicate:[FBLogSearchPredicate substrings:@[@"Not Present"]]], [NSIndexSet indexSet]);
+}
+
+- (void)testFallsBackToFullScan
+{
+  FBLogIndex *index = self.index;
+
+  FBLogSearchPredicate *regex = [FBLogSearchPredicate regex:@"backboard+d"];
+  XCTAssertNil([index candidateLinesForPredicate:regex]);
+  XCTAssertEqualObjects([index searchWithPredicate:regex].allMatches, @[@"backboardd"]);
+
+  FBLogSearchPredicate *shortSubstring = [FBLogSearchPredicate substrings:@[@"ay"]];
+  XCTAssertNil([index candidateLinesForPredicate:shortSubstring]);
+  XCTAssertEqualObjects([index searchWithPredicate:shortSubstring].matchingLines, @[@"Jan 1 00:00:01 backboardd[101]: Display on"]);
+}
+
+- (void)testDoesNotSearchBinaryLogs
+{
+  NSMutableData *data = [[@"Jan 1 00:00:00 SpringBoard[100]: Display on\n" dataUsingEncoding:NSUTF8StringEncoding] mutableCopy];
+  [data appendBytes:"\0\x01\x02" length:3];
+  [data writeToFile:self.logPath atomically:YES];
+  FBLogIndex *index = self.index;
+
+  XCTAssertEqual(index.lineCount, 0u);
+  XCTAssertEqualObjects([index searchWithPredicate:[FBLogSearchPredicate substrings:@[@"Display"]]].matchingLines, @[]);
+  XCTAssertNil([index candidateLinesForPredicate:[FBLogSearchPredicate substrings:@[@"ay"]]]);
+  XCTAssertEqualObjects([index searchWithPredicate:[FBLogSearchPredicate substrings:@[@"ay"]]].matchingLines, @[]);
+}
+
+- (void)testRebuildsWhenLogChanges
+{
+  XCTAssertEqual(self.index.lineCount, 6u);
+  NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:self.indexPath error:nil];
+  XCTAssertEqual(self.index.lineCount, 6u);
+  XCTAssertEqualObjects([NSFileManager.defaultManager attributesOfItemAtPath:self.indexPath error:nil][NSFileSystemFileNumber], attributes[NSFileSystemFileNumber]);
+
+  [@"Foobar rotated\n" writeToFile:self.logPath atomically:YES encoding:NSUTF8StringEncoding error:nil];
+  FBLogIndex *index = self.index;
+  XCTAssertEqual(index.lineCount, 1u);
+  XCTAssertEqualObjects([index searchWithPredicate:[FBLogSearchPredicate substrings:@[@"Foobar"]]].matchingLines, @[@"Foobar rotated"]);
+}
+
+- (void)testBatchSearchWithIndexMatchesFullSearch
+{
+  FBDiagnostic *diagnostic = [[[[FBDiagnosticBuilder builder] updatePath:self.logPath] updateShortName:@"system_log"] build];
+  FBBatchLogSearch *search = [FBBatchLogSearch searchWithMapping:@{@"": @[[FBLogSearchPredicate substrings:@[@"com.example.app"]], [FBLogSearchPredicate regex:@"Foo.ar"]]} options:FBBatchLogSearchOptionsFullLines since:nil error:nil];
+  NSString *indexDirectory = [self.directory stringByAppendingPathComponent:@"indexes"];
+
+  NSDictionary *expected = [search searchDiagnostics:@[diagnostic]].mapping;
+  XCTAssertEqual([expected[@"system_log"] count], 5u);
+  XCTAssertEqualObjects([[search searchDiagnostics:@[diagnostic] indexDirectory:indexDirectory].mapping[@"system_log"] sortedArrayUsingSelector:@selector(compare:)], [expected[@"system_log"] sortedArrayUsingSelector:@selector(compare:)]);
+}
+
+@end
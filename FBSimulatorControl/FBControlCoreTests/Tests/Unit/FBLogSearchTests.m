@@ -100,6 +100,19 @@
   XCTAssertNil(searcher.firstMatchingLine);
 }
 
+- (void)testDoesNotFindInFilesContainingNulBytes
+{
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  NSMutableData *data = [[@"Installed apps did change\n" dataUsingEncoding:NSUTF8StringEncoding] mutableCopy];
+  [data increaseLengthBy:4];
+  XCTAssertTrue([data writeToFile:path atomically:NO]);
+  FBDiagnostic *diagnostic = [[[FBDiagnosticBuilder builder] updatePath:path] build];
+
+  FBLogSearch *searcher = [FBDiagnosticLogSearch withDiagnostic:diagnostic predicate:[FBLogSearchPredicate substrings:@[@"Installed apps did change"]]];
+  XCTAssertNil(searcher.firstMatch);
+  [NSFileManager.defaultManager removeItemAtPath:path error:nil];
+}
+
 - (void)testCompilesSubstringMatchingArgumentsForLogCommand
 {
   NSArray<FBLogSearchPredicate *> *predicates = @[
@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBProcessExitWatcherTests : XCTestCase
+
+@property (nonatomic, strong) NSMutableArray<NSTask *> *tasks;
+
+@end
+
+@implementation FBProcessExitWatcherTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.tasks = [NSMutableArray array];
+}
+
+- (void)tearDown
+{
+  for (NSTask *task in self.tasks) {
+    if (task.isRunning) {
+      [task terminate];
+    }
+  }
+
+  [super tearDown];
+}
+
+- (pid_t)launchSleep
+{
+  NSTask *task = [[NSTask alloc] init];
+  task.launchPath = @"/bin/sleep";
+  task.arguments = @[@"30"];
+  [task launch];
+  [self.tasks addObject:task];
+  return task.processIdentifier;
+}
+
+- (void)testResolvesWhenProcessExits
+{
+  FBProcessExitWatcher *watcher = FBProcessExitWatcher.watcher;
+  pid_t processIdentifier = [self launchSleep];
+  FBFuture<NSNull *> *future = [watcher waitForExitOfProcessIdentifier:processIdentifier];
+  XCTAssertEqualObjects(watcher.watchedProcessIdentifiers, @[@(processIdentifier)]);
+  XCTAssertEqual(future.state, FBFutureStateRunning);
+
+  kill(processIdentifier, SIGKILL);
+  NSError *error = nil;
+  XCTAssertNotNil([future awaitWithTimeout:5 error:&error]);
+  XCTAssertNil(error);
+  XCTAssertEqualObjects(watcher.watchedProcessIdentifiers, @[]);
+}
+
+- (void)testMultiplexesManyProcesses
+{
+  FBProcessExitWatcher *watcher = FBProcessExitWatcher.watcher;
+  NSMutableArray<NSNumber *> *processIdentifiers = [NSMutableArray array];
+  NSMutableArray<FBFuture<NSNull *> *> *futures = [NSMutableArray array];
+  for (NSUInteger index = 0; index < 8; index++) {
+    pid_t processIdentifier = [self launchSleep];
+    [processIdentifiers addObject:@(processIdentifier)];
+    [futures addObject:[watcher waitForExitOfProcessIdentifier:processIdentifier]];
+    // A second waiter for the same process shares the registration.
+    [futures addObject:[watcher waitForExitOfProcessIdentifier:processIdentifier]];
+  }
+  XCTAssertEqual(watcher.watchedProcessIdentifiers.count, 8u);
+
+  for (NSNumber *processIdentifier in processIdentifiers) {
+    kill(processIdentifier.intValue, SIGKILL);
+  }
+  NSError *error = nil;
+  XCTAssertNotNil([[FBFuture futureWithFutures:futures] awaitWithTimeout:5 error:&error]);
+  XCTAssertNil(error);
+}
+
+- (void)testResolvesImmediatelyForMissingProcess
+{
+  NSTask *task = [NSTask launchedTaskWithLaunchPath:@"/usr/bin/true" arguments:@[]];
+  [task waitUntilExit];
+
+  NSError *error = nil;
+  FBFuture<NSNull *> *future = [FBProcessExitWatcher.sharedWatcher waitForExitOfProcessIdentifier:task.processIdentifier];
+  XCTAssertNotNil([future awaitWithTimeout:1 error:&error]);
+  XCTAssertNil(error);
+}
+
+- (void)testCancellingOneWaiterKeepsOthers
+{
+  FBProcessExitWatcher *watcher = FBProcessExitWatcher.watcher;
+  pid_t processIdentifier = [self launchSleep];
+  FBFuture<NSNull *> *cancelled = [watcher waitForExitOfProcessIdentifier:processIdentifier];
+  FBFuture<NSNull *> *remaining = [watcher waitForExitOfProcessIdentifier:processIdentifier];
+
+  XCTAssertNotNil([cancelled.cancel awaitWithTimeout:1 error:nil]);
+  XCTAssertEqual(cancelled.state, FBFutureStateCancelled);
+  XCTAssertEqualObjects(watcher.watchedProcessIdentifiers, @[@(processIdentifier)]);
+
+  kill(processIdentifier, SIGKILL);
+  XCTAssertNotNil([remaining awaitWithTimeout:5 error:nil]);
+  XCTAssertEqual(remaining.state, FBFutureStateDone);
+}
+
+- (void)testCancellingAllWaitersStopsWatching
+{
+  FBProcessExitWatcher *watcher = FBProcessExitWatcher.watcher;
+  pid_t processIdentifier = [self launchSleep];
+  FBFuture<NSNull *> *future = [watcher waitForExitOfProcessIdentifier:processIdentifier];
+  XCTAssertEqualObjects(watcher.watchedProcessIdentifiers, @[@(processIdentifier)]);
+
+  XCTAssertNotNil([future.cancel awaitWithTimeout:1 error:nil]);
+  XCTAssertEqualObjects(watcher.watchedProcessIdentifiers, @[]);
+}
+
+- (void)testProcessFetcherWaitsForProcessToDie
+{
+  FBProcessFetcher *fetcher = [FBProcessFetcher new];
+  pid_t processIdentifier = [self launchSleep];
+  FBProcessInfo *process = [fetcher processInfoFor:processIdentifier];
+  XCTAssertNotNil(process);
+
+  FBFuture<NSNull *> *future = [fetcher onQueue:dispatch_get_main_queue() waitForProcessToDie:process];
+  kill(processIdentifier, SIGKILL);
+  NSError *error = nil;
+  XCTAssertNotNil([future awaitWithTimeout:5 error:&error]);
+  XCTAssertNil(error);
+}
+
+@end
@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBProcessTableTests : XCTestCase
+
+@property (nonatomic, copy) NSString *procPath;
+
+@end
+
+@implementation FBProcessTableTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.procPath = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.procPath error:nil];
+
+  [super tearDown];
+}
+
+- (void)writeProcess:(pid_t)processIdentifier stat:(NSString *)stat cmdline:(NSString *)cmdline environ:(NSString *)environ
+{
+  NSString *directory = [self.procPath stringByAppendingPathComponent:@(processIdentifier).stringValue];
+  [NSFileManager.defaultManager createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+  [[stat dataUsingEncoding:NSUTF8StringEncoding] writeToFile:[directory stringByAppendingPathComponent:@"stat"] atomically:YES];
+  [[cmdline dataUsingEncoding:NSUTF8StringEncoding] writeToFile:[directory stringByAppendingPathComponent:@"cmdline"] atomically:YES];
+  [[environ dataUsingEncoding:NSUTF8StringEncoding] writeToFile:[directory stringByAppendingPathComponent:@"environ"] atomically:YES];
+}
+
+- (void)testIndexesFromProvidedProcesses
+{
+  __block NSUInteger providerCalls = 0;
+  __block NSString *launchPath = @"/bin/foo";
+  FBProcessTable *table = [FBProcessTable
+    tableWithParents:@{@1: @0, @10: @1, @11: @1, @12: @10, @13: @10}
+    names:@{@1: @"launchd", @10: @"launchd_sim", @11: @"launchd_sim", @12: @"SpringBoard", @13: @"backboardd"}
+    infoProvider:^ FBProcessInfo * (pid_t processIdentifier) {
+      providerCalls++;
+      if (processIdentifier == 13 || processIdentifier == 999) {
+        return nil;
+      }
+      return [[FBProcessInfo alloc] initWithProcessIdentifier:processIdentifier launchPath:launchPath arguments:@[launchPath] environment:@{}];
+    }];
+  // Process Info is only obtained when queried.
+  XCTAssertEqual(providerCalls, 0u);
+
+  XCTAssertEqualObjects(table.processIdentifiers, (@[@1, @10, @11, @12, @13]));
+  XCTAssertEqual([table parentOf:12], 10);
+  XCTAssertEqual([table parentOf:999], -1);
+  XCTAssertEqualObjects([table processNameFor:12], @"SpringBoard");
+  XCTAssertEqualObjects([table subprocessIdentifiersOf:1], (@[@10, @11]));
+  XCTAssertEqualObjects([table subprocessIdentifiersOf:12], @[]);
+  XCTAssertEqualObjects([table processIdentifiersWithName:@"launchd_sim"], (@[@10, @11]));
+  XCTAssertEqual([table subprocessOf:10 withName:@"Board"], 12);
+  XCTAssertEqual([table subprocessOf:10 withName:@"nope"], -1);
+
+  XCTAssertEqual(providerCalls, 0u);
+
+  XCTAssertEqual([table processesWithProcessName:@"launchd_sim"].count, 2u);
+  XCTAssertEqual([table subprocessesOf:10].count, 1u);
+  XCTAssertEqual(providerCalls, 4u);
+
+  // Process Info is cached once it has been obtained, including when there is none.
+  launchPath = @"/bin/bar";
+  XCTAssertEqualObjects([table processInfoFor:12].launchPath, @"/bin/foo");
+  XCTAssertNil([table processInfoFor:13]);
+  XCTAssertEqualObjects([table processInfoFor:1].launchPath, @"/bin/bar");
+  XCTAssertEqual(providerCalls, 5u);
+}
+
+- (void)testLooksUpProcessesMissingFromTheSnapshot
+{
+  __block NSUInteger providerCalls = 0;
+  FBProcessTable *table = [FBProcessTable
+    tableWithParents:@{@1: @0}
+    names:@{@1: @"launchd"}
+    infoProvider:^ FBProcessInfo * (pid_t processIdentifier) {
+      providerCalls++;
+      if (processIdentifier == 999) {
+        return nil;
+      }
+      return [[FBProcessInfo alloc] initWithProcessIdentifier:processIdentifier launchPath:@"/bin/foo" arguments:@[@"/bin/foo"] environment:@{}];
+    }];
+
+  XCTAssertEqual([table processInfoFor:20].processIdentifier, 20);
+  XCTAssertNil([table processInfoFor:999]);
+  XCTAssertEqual(providerCalls, 3u);
+  XCTAssertEqualObjects([table subprocessIdentifiersOf:20], @[]);
+}
+
+- (void)testSnapshotFindsProcessesLaunchedAfterIt
+{
+  FBProcessFetcher *fetcher = [FBProcessFetcher new];
+  FBProcessTable *table = [fetcher processTableSnapshot];
+  NSTask *task = [NSTask launchedTaskWithLaunchPath:@"/bin/sleep" arguments:@[@"5"]];
+
+  XCTAssertEqualObjects([table processInfoFor:task.processIdentifier].launchPath, @"/bin/sleep");
+  [task terminate];
+  [task waitUntilExit];
+}
+
+- (void)testSnapshotIsSharedAcrossQueues
+{
+  FBProcessFetcher *fetcher = [FBProcessFetcher new];
+  dispatch_apply(16, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^(size_t iteration) {
+    XCTAssertNotNil([[fetcher processTableWithMaximumAge:60] processInfoFor:NSProcessInfo.processInfo.processIdentifier]);
+  });
+}
+
+- (void)testReadsProcFileSystem
+{
+  [self writeProcess:1 stat:@"1 (init) S 0 1 1 0 -1" cmdline:@"/sbin/init\0" environ:@"HOME=/\0"];
+  [self writeProcess:42 stat:@"42 (my (odd) name) S 1 42 42 0 -1" cmdline:@"/usr/bin/odd\0--flag\0value\0" environ:@"A=1\0B=x=y\0"];
+  [self writeProcess:43 stat:@"43 (kthreadd) S 1 0 0 0 -1" cmdline:@"" environ:@""];
+  [NSFileManager.defaultManager createDirectoryAtPath:[self.procPath stringByAppendingPathComponent:@"self"] withIntermediateDirectories:YES attributes:nil error:nil];
+
+  FBProcessTable *table = [FBProcessTable tableFromProcFileSystemAtPath:self.procPath];
+  XCTAssertEqualObjects(table.processIdentifiers, (@[@1, @42, @43]));
+  XCTAssertEqualObjects([table processNameFor:42], @"my (odd) name");
+  XCTAssertEqual([table parentOf:42], 1);
+  XCTAssertEqualObjects([table subprocessIdentifiersOf:1], (@[@42, @43]));
+
+  FBProcessInfo *process = [table processInfoFor:42];
+  XCTAssertEqualObjects(process.launchPath, @"/usr/bin/odd");
+  XCTAssertEqualObjects(process.arguments, (@[@"/usr/bin/odd", @"--flag", @"value"]));
+  XCTAssertEqualObjects(process.environment, (@{@"A": @"1", @"B": @"x=y"}));
+  XCTAssertNil([table processInfoFor:43]);
+  XCTAssertEqualObjects([table processesWithLaunchPathSubstring:@"odd"], @[process]);
+}
+
+- (void)testSnapshotOfHostContainsCurrentProcess
+{
+  FBProcessFetcher *fetcher = [FBProcessFetcher new];
+  pid_t processIdentifier = NSProcessInfo.processInfo.processIdentifier;
+  FBProcessTable *table = [fetcher processTableSnapshot];
+
+  XCTAssertEqual([table parentOf:processIdentifier], [fetcher parentOf:processIdentifier]);
+  XCTAssertEqualObjects([table processInfoFor:processIdentifier], [fetcher processInfoFor:processIdentifier]);
+  XCTAssertTrue([[table subprocessIdentifiersOf:[fetcher parentOf:processIdentifier]] containsObject:@(processIdentifier)]);
+}
+
+- (void)testSnapshotIsReusedWithinMaximumAge
+{
+  FBProcessFetcher *fetcher = [FBProcessFetcher new];
+  FBProcessTable *first = [fetcher processTableWithMaximumAge:60];
+  XCTAssertEqual([fetcher processTableWithMaximumAge:60], first);
+  XCTAssertNotEqual([fetcher processTableWithMaximumAge:0], first);
+}
+
+- (void)testProcessInfoIsSharedBetweenSnapshots
+{
+  FBProcessFetcher *fetcher = [FBProcessFetcher new];
+  pid_t processIdentifier = NSProcessInfo.processInfo.processIdentifier;
+  FBProcessInfo *first = [[fetcher processTableWithMaximumAge:0] processInfoFor:processIdentifier];
+  FBProcessInfo *second = [[fetcher processTableWithMaximumAge:0] processInfoFor:processIdentifier];
+
+  XCTAssertNotNil(first);
+  XCTAssertEqual(first, second);
+}
+
+@end
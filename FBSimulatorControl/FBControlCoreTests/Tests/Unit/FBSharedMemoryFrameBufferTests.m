@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+static NSData *SyntheticFrame(uint8_t value, size_t length)
+{
+  NSMutableData *frame = [NSMutableData dataWithLength:length];
+  memset(frame.mutableBytes, value, length);
+  return frame;
+}
+
+@interface FBSharedMemoryFrameBufferTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *name;
+
+@end
+
+@implementation FBSharedMemoryFrameBufferTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  // Shared memory names are limited to 31 characters.
+  self.name = [NSString stringWithFormat:@"/fbtest.%@", [NSUUID.UUID.UUIDString substringToIndex:8]];
+}
+
+- (FBSharedMemoryFrameWriter *)writerWithCapacity:(size_t)capacity
+{
+  NSError *error = nil;
+  FBSharedMemoryFrameWriter *writer = [FBSharedMemoryFrameWriter writerWithName:self.name frameCapacity:capacity logger:nil error:&error];
+  XCTAssertNotNil(writer, @"%@", error);
+  return writer;
+}
+
+- (void)testReadsLatestFrame
+{
+  FBSharedMemoryFrameWriter *writer = [self writerWithCapacity:1024];
+  NSError *error = nil;
+  FBSharedMemoryFrameReader *reader = [FBSharedMemoryFrameReader readerWithName:self.name error:&error];
+  XCTAssertNotNil(reader, @"%@", error);
+  XCTAssertEqual(reader.frameCapacity, 1024u);
+  XCTAssertNil([reader latestFrameWithSequence:nil]);
+
+  for (uint8_t value = 1; value <= 5; value++) {
+    [writer consumeData:SyntheticFrame(value, 100 * value)];
+  }
+  uint64_t sequence = 0;
+  XCTAssertEqualObjects([reader latestFrameWithSequence:&sequence], SyntheticFrame(5, 500));
+  XCTAssertEqual(sequence, 5u);
+
+  [writer consumeData:SyntheticFrame(6, 2048)];
+  XCTAssertEqual(writer.framesDropped, 1u);
+  XCTAssertEqual(writer.framesWritten, 5u);
+  XCTAssertEqualObjects([reader latestFrameWithSequence:&sequence], SyntheticFrame(5, 500));
+
+  // The name is removed at end-of-file, but the existing mapping is still readable.
+  [writer consumeEndOfFile];
+  XCTAssertNil([FBSharedMemoryFrameReader readerWithName:self.name error:nil]);
+  XCTAssertEqualObjects([reader latestFrameWithSequence:nil], SyntheticFrame(5, 500));
+}
+
+- (void)testRejectsExistingName
+{
+  FBSharedMemoryFrameWriter *writer = [self writerWithCapacity:16];
+  NSError *error = nil;
+  XCTAssertNil([FBSharedMemoryFrameWriter writerWithName:self.name frameCapacity:16 logger:nil error:&error]);
+  XCTAssertNotNil(error);
+  [writer consumeEndOfFile];
+}
+
+- (void)testNotifiesUntilEndOfFile
+{
+  FBSharedMemoryFrameWriter *writer = [self writerWithCapacity:64];
+  FBSharedMemoryFrameReader *reader = [FBSharedMemoryFrameReader readerWithName:self.name error:nil];
+  NSMutableArray<NSNumber *> *sequences = [NSMutableArray array];
+  __block NSData *lastFrame = nil;
+  FBFuture<NSNull *> *completed = [reader consumeFramesOnQueue:dispatch_get_main_queue() handler:^(NSData *frame, uint64_t sequence) {
+    [sequences addObject:@(sequence)];
+    lastFrame = frame;
+  }];
+
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+    for (uint8_t value = 1; value <= 100; value++) {
+      [writer consumeData:SyntheticFrame(value, 64)];
+    }
+    [writer consumeEndOfFile];
+  });
+
+  NSError *error = nil;
+  XCTAssertNotNil([completed awaitWithTimeout:5 error:&error], @"%@", error);
+  XCTAssertGreaterThan(sequences.count, 0u);
+  XCTAssertEqualObjects(sequences.lastObject, @100);
+  XCTAssertEqualObjects(lastFrame, SyntheticFrame(100, 64));
+  NSArray<NSNumber *> *sorted = [sequences sortedArrayUsingSelector:@selector(compare:)];
+  XCTAssertEqualObjects(sequences, sorted);
+}
+
+@end
@@ -17,6 +17,9 @@
 #import "FBDevice+Private.h"
 #import "FBDeviceControlError.h"
 #import "FBAFCConnection.h"
+#import "FBAFCTransfer.h"
+
+static const NSUInteger TransferConnectionCount = 4;
 
 @interface FBDeviceApplicationDataCommands ()
 
@@ -63,15 +66,13 @@
 
 - (FBFuture<NSNull *> *)copyItemsAtURLs:(NSArray<NSURL *> *)paths toContainerPath:(NSString *)containerPath inBundleID:(NSString *)bundleID
 {
-  return [self handleWithAFCSessionForBundleID:bundleID operationBlock:^ NSNull * (FBAFCConnection *afc, NSError **error) {
-    for (NSURL *path in paths) {
-      BOOL success = [afc copyFromHost:path toContainerPath:containerPath error:error];
-      if (!success) {
-        return nil;
-      }
-    }
-    return NSNull.null;
-  }];
+  id<FBControlCoreLogger> logger = self.device.logger;
+  return [[self.device.amDevice
+    houseArrestAFCConnectionsForBundleID:bundleID count:TransferConnectionCount afcCalls:self.afcCalls]
+    onQueue:self.device.workQueue pop:^(NSArray<FBAFCConnection *> *connections) {
+      FBAFCTransfer *transfer = [FBAFCTransfer transferWithConnections:connections chunkSize:FBAFCTransfer.defaultChunkSize logger:logger];
+      return [transfer onQueue:self.device.workQueue copyItemsAtURLs:paths toContainerPath:containerPath];
+    }];
 }
 
 - (FBFuture<NSNull *> *)copyDataFromContainerOfApplication:(NSString *)bundleID atContainerPath:(NSString *)containerPath toDestinationPath:(NSString *)destinationPath
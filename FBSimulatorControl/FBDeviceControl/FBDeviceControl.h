@@ -8,6 +8,7 @@
  */
 
 #import <FBDeviceControl/FBAFCConnection.h>
+#import <FBDeviceControl/FBAFCTransfer.h>
 #import <FBDeviceControl/FBAMDevice.h>
 #import <FBDeviceControl/FBAMDevice+Private.h>
 #import <FBDeviceControl/FBAMDefines.h>
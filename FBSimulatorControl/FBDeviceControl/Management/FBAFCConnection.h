@@ -66,6 +66,28 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)createDirectory:(NSString *)path error:(NSError **)error;
 
+/**
+ Creates many Directories, in the order provided.
+ Parent directories must precede their children.
+
+ @param paths the paths to create.
+ @param error an error out for any error that occurs.
+ @return YES if successful, NO otherwise.
+ */
+- (BOOL)createDirectories:(NSArray<NSString *> *)paths error:(NSError **)error;
+
+/**
+ Writes a file on the host to a path, streaming it in chunks.
+ The host file is memory-mapped and read sequentially, so it is never read into memory in its entirety.
+
+ @param hostPath the path of the file on the host.
+ @param containerPath the file path relative to the application container.
+ @param chunkSize the maximum number of bytes to write in a single AFC write.
+ @param error an error out for any error that occurs.
+ @return YES if successful, NO otherwise.
+ */
+- (BOOL)writeFileAtHostPath:(NSString *)hostPath toContainerPath:(NSString *)containerPath chunkSize:(size_t)chunkSize error:(NSError **)error;
+
 /**
  Get the contents of a directory.
 
@@ -12,9 +12,12 @@
 #import <FBControlCore/FBControlCore.h>
 
 #include <dlfcn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #import "FBDeviceControlError.h"
 #import "FBAMDServiceConnection.h"
+#import "FBAFCTransfer.h"
 
 static NSString *AFCCodeKey = @"AFCCode";
 static NSString *AFCDomainKey = @"AFCDomain";
@@ -50,20 +53,9 @@ static AFCCalls defaultCalls;
 
 - (BOOL)copyFromHost:(NSURL *)url toContainerPath:(NSString *)containerPath error:(NSError **)error
 {
-  NSNumber *isDir;
-  if (![url getResourceValue:&isDir forKey:NSURLIsDirectoryKey error:error]) {
-    return NO;
-  }
-  if (isDir.boolValue) {
-    containerPath = [containerPath stringByAppendingPathComponent:url.lastPathComponent];
-    BOOL success = [self createDirectory:containerPath error:error];
-    if (!success) {
-      return NO;
-    }
-    return [self copyContentsOfHostDirectory:url toContainerPath:containerPath error:error];
-  } else {
-    return [self copyFileFromHost:url toContainerPath:[containerPath stringByAppendingPathComponent:url.lastPathComponent] error:error];
-  }
+  return [[FBAFCTransfer
+    transferWithConnections:@[self] chunkSize:FBAFCTransfer.defaultChunkSize logger:self.logger]
+    copyItemsAtURLs:@[url] toContainerPath:containerPath error:error];
 }
 
 - (BOOL)createDirectory:(NSString *)path error:(NSError **)error
@@ -80,6 +72,86 @@ static AFCCalls defaultCalls;
   return YES;
 }
 
+- (BOOL)createDirectories:(NSArray<NSString *> *)paths error:(NSError **)error
+{
+  [self.logger logFormat:@"Creating %lu Directories", (unsigned long) paths.count];
+  for (NSString *path in paths) {
+    mach_error_t result = self.calls.DirectoryCreate(self.connection, path.UTF8String);
+    if (result != 0) {
+      return [[[FBDeviceControlError
+        describeFormat:@"Error when creating directory %@: %@", path, [self errorMessageWithCode:result]]
+        logger:self.logger]
+        failBool:error];
+    }
+  }
+  [self.logger logFormat:@"Created %lu Directories", (unsigned long) paths.count];
+  return YES;
+}
+
+- (BOOL)writeFileAtHostPath:(NSString *)hostPath toContainerPath:(NSString *)containerPath chunkSize:(size_t)chunkSize error:(NSError **)error
+{
+  NSParameterAssert(chunkSize > 0);
+  int fileDescriptor = open(hostPath.fileSystemRepresentation, O_RDONLY);
+  if (fileDescriptor == -1) {
+    return [[FBDeviceControlError
+      describeFormat:@"Could not open file on host %@: %s", hostPath, strerror(errno)]
+      failBool:error];
+  }
+  struct stat fileStat;
+  if (fstat(fileDescriptor, &fileStat) != 0) {
+    close(fileDescriptor);
+    return [[FBDeviceControlError
+      describeFormat:@"Could not stat file on host %@: %s", hostPath, strerror(errno)]
+      failBool:error];
+  }
+
+  // Empty files cannot be mapped, files that cannot be mapped are read through a single chunk-sized buffer instead.
+  size_t length = (size_t) fileStat.st_size;
+  void *mapping = MAP_FAILED;
+  if (length > 0) {
+    mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  }
+  if (mapping != MAP_FAILED) {
+    madvise(mapping, length, MADV_SEQUENTIAL);
+  }
+
+  CFTypeRef fileReference;
+  mach_error_t result = self.calls.FileRefOpen(self.connection, containerPath.UTF8String, FBAFCreateReadAndWrite, &fileReference);
+  if (result != 0) {
+    if (mapping != MAP_FAILED) {
+      munmap(mapping, length);
+    }
+    close(fileDescriptor);
+    return [[[FBDeviceControlError
+      describeFormat:@"Error when opening file: %@", [self errorMessageWithCode:result]]
+      logger:self.logger]
+      failBool:error];
+  }
+
+  int readError = 0;
+  if (mapping != MAP_FAILED) {
+    result = [self writeMapping:mapping length:length toFile:fileReference chunkSize:chunkSize];
+    munmap(mapping, length);
+  } else if (length > 0) {
+    result = [self writeFileDescriptor:fileDescriptor toFile:fileReference chunkSize:chunkSize readError:&readError];
+  }
+  self.calls.FileRefClose(self.connection, fileReference);
+  close(fileDescriptor);
+
+  if (readError != 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Error when reading file on host %@: %s", hostPath, strerror(readError)]
+      failBool:error];
+  }
+  if (result != 0) {
+    return [[[FBDeviceControlError
+      describeFormat:@"Error when writing file: %@", [self errorMessageWithCode:result]]
+      logger:self.logger]
+      failBool:error];
+  }
+  return YES;
+}
+
 const char *SingleDot = ".";
 const char *DoubleDot = "..";
 
@@ -200,65 +272,46 @@ const char *DoubleDot = "..";
 
 #pragma mark Private
 
-- (BOOL)copyFileFromHost:(NSURL *)path toContainerPath:(NSString *)containerPath error:(NSError **)error
+- (mach_error_t)writeMapping:(const uint8_t *)mapping length:(size_t)length toFile:(CFTypeRef)fileReference chunkSize:(size_t)chunkSize
 {
-  [self.logger logFormat:@"Copying %@ to %@", path, containerPath];
-  NSData *data = [NSData dataWithContentsOfURL:path];
-  if (!data) {
-    return [[FBDeviceControlError
-      describeFormat:@"Could not find file on host: %@", path]
-      failBool:error];
-  }
-
-  CFTypeRef fileReference;
-  mach_error_t result = self.calls.FileRefOpen(self.connection, containerPath.UTF8String, FBAFCreateReadAndWrite, &fileReference);
-  if (result != 0) {
-    return [[[FBDeviceControlError
-      describeFormat:@"Error when opening file: %@", [self errorMessageWithCode:result]]
-      logger:self.logger]
-      failBool:error];
-  }
-
-  __block mach_error_t writeResult = 0;
-  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
-    if (byteRange.length == 0) {
-      return;
+  size_t pageMask = (size_t) getpagesize() - 1;
+  for (size_t offset = 0; offset < length; offset += chunkSize) {
+    size_t chunkLength = MIN(chunkSize, length - offset);
+    // Ask for the following chunk to be paged in whilst the current one is being written.
+    size_t nextOffset = offset + chunkLength;
+    if (nextOffset < length) {
+      size_t alignedOffset = nextOffset & ~pageMask;
+      size_t adviseLength = MIN(chunkSize, length - nextOffset) + (nextOffset - alignedOffset);
+      madvise((void *) (mapping + alignedOffset), adviseLength, MADV_WILLNEED);
     }
-    writeResult = self.calls.FileRefWrite(self.connection, fileReference, bytes, byteRange.length);
-    if (writeResult != 0) {
-      *stop = YES;
+    mach_error_t result = self.calls.FileRefWrite(self.connection, fileReference, mapping + offset, chunkLength);
+    if (result != 0) {
+      return result;
     }
-  }];
-  self.calls.FileRefClose(self.connection, fileReference);
-  if (writeResult != 0) {
-    return [[[FBDeviceControlError
-      describeFormat:@"Error when writing file: %@", [self errorMessageWithCode:writeResult]]
-      logger:self.logger]
-      failBool:error];
   }
-  [self.logger logFormat:@"Copied from %@ to %@", path, containerPath];
-  return YES;
+  return 0;
 }
 
-- (BOOL)copyContentsOfHostDirectory:(NSURL *)path toContainerPath:(NSString *)containerPath error:(NSError **)error
+- (mach_error_t)writeFileDescriptor:(int)fileDescriptor toFile:(CFTypeRef)fileReference chunkSize:(size_t)chunkSize readError:(int *)readError
 {
-  [self.logger logFormat:@"Copying from %@ to %@", path, containerPath];
-  NSFileManager *fileManager = NSFileManager.defaultManager;
-  NSDirectoryEnumerator<NSURL *> *urls = [fileManager
-    enumeratorAtURL:path
-    includingPropertiesForKeys:@[NSURLIsDirectoryKey]
-    options:NSDirectoryEnumerationSkipsSubdirectoryDescendants
-    errorHandler:NULL];
-
-  for (NSURL *url in urls) {
-    BOOL success = [self copyFromHost:url toContainerPath:containerPath error:error];
-    if (!success) {
-      [self.logger logFormat:@"Failed to copy %@ to %@ with error %@", path, containerPath, *error];
-      return NO;
+  NSMutableData *buffer = [NSMutableData dataWithLength:chunkSize];
+  while (YES) {
+    ssize_t readLength = read(fileDescriptor, buffer.mutableBytes, chunkSize);
+    if (readLength == -1 && errno == EINTR) {
+      continue;
+    }
+    if (readLength == -1) {
+      *readError = errno;
+      return 0;
+    }
+    if (readLength == 0) {
+      return 0;
+    }
+    mach_error_t result = self.calls.FileRefWrite(self.connection, fileReference, buffer.bytes, (uint64_t) readLength);
+    if (result != 0) {
+      return result;
     }
   }
-  [self.logger logFormat:@"Copied from %@ to %@", path, containerPath];
-  return YES;
 }
 
 - (BOOL)removePathAndContents:(NSString *)path error:(NSError **)error
@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBAFCConnection;
+
+/**
+ Copies files and directories from the host into a container, over one or more AFC Connections.
+
+ The transfer first walks the host items to build a plan of every directory and file to copy.
+ All directories are then created in a single pass, parents before children, before any file is written.
+ Files are streamed from memory-mapped host files in fixed-size chunks, so that a file is never read into memory in its entirety.
+ When more than one connection is provided, files are distributed across them, largest first, so that several files are in flight at once.
+ The first failure on any connection stops the remaining work on all connections.
+ */
+@interface FBAFCTransfer : NSObject
+
+#pragma mark Initializers
+
+/**
+ Constructs a Transfer.
+
+ @param connections the connections to transfer over. Must contain at least one connection. Each connection is used by at most one thread at a time.
+ @param chunkSize the maximum number of bytes to write in a single AFC write.
+ @param logger the logger to use.
+ @return a new Transfer.
+ */
++ (instancetype)transferWithConnections:(NSArray<FBAFCConnection *> *)connections chunkSize:(size_t)chunkSize logger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Properties
+
+/**
+ The default chunk size.
+ */
+@property (nonatomic, assign, readonly, class) size_t defaultChunkSize;
+
+#pragma mark Public Methods
+
+/**
+ Copies items from the host into a container.
+ Each item can represent a file or a directory, directories are copied recursively.
+
+ @param urls the items on the host to copy.
+ @param containerPath the directory relative to the application container to copy into.
+ @param error an error out for any error that occurs.
+ @return YES if successful, NO otherwise.
+ */
+- (BOOL)copyItemsAtURLs:(NSArray<NSURL *> *)urls toContainerPath:(NSString *)containerPath error:(NSError **)error;
+
+/**
+ Copies items from the host into a container, without blocking the queue.
+ The plan is made and the directories are created on the queue, the files are then copied on background threads.
+
+ @param queue the queue to plan the transfer on.
+ @param urls the items on the host to copy.
+ @param containerPath the directory relative to the application container to copy into.
+ @return a Future that resolves when all of the items have been copied.
+ */
+- (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue copyItemsAtURLs:(NSArray<NSURL *> *)urls toContainerPath:(NSString *)containerPath;
+
+@end
+
+NS_ASSUME_NONNULL_END
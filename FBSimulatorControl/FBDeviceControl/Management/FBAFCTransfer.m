@@ -0,0 +1,242 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBAFCTransfer.h"
+
+#import <FBControlCore/FBControlCore.h>
+
+#import "FBAFCConnection.h"
+
+static const size_t DefaultChunkSize = 1024 * 1024;
+
+@interface FBAFCTransfer_File : NSObject
+
+@property (nonatomic, copy, readonly) NSString *hostPath;
+@property (nonatomic, copy, readonly) NSString *containerPath;
+@property (nonatomic, assign, readonly) unsigned long long size;
+
+@end
+
+@implementation FBAFCTransfer_File
+
+- (instancetype)initWithHostPath:(NSString *)hostPath containerPath:(NSString *)containerPath size:(unsigned long long)size
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _hostPath = hostPath;
+  _containerPath = containerPath;
+  _size = size;
+
+  return self;
+}
+
+@end
+
+@interface FBAFCTransfer_Plan : NSObject
+
+@property (nonatomic, strong, readonly) NSMutableArray<NSString *> *directories;
+@property (nonatomic, strong, readonly) NSMutableArray<FBAFCTransfer_File *> *files;
+@property (nonatomic, assign, readwrite) unsigned long long totalSize;
+
+@end
+
+@implementation FBAFCTransfer_Plan
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _directories = [NSMutableArray array];
+  _files = [NSMutableArray array];
+
+  return self;
+}
+
+@end
+
+@interface FBAFCTransfer ()
+
+@property (nonatomic, copy, readonly) NSArray<FBAFCConnection *> *connections;
+@property (nonatomic, assign, readonly) size_t chunkSize;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+
+@end
+
+@implementation FBAFCTransfer
+
+#pragma mark Initializers
+
++ (instancetype)transferWithConnections:(NSArray<FBAFCConnection *> *)connections chunkSize:(size_t)chunkSize logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithConnections:connections chunkSize:chunkSize logger:logger];
+}
+
+- (instancetype)initWithConnections:(NSArray<FBAFCConnection *> *)connections chunkSize:(size_t)chunkSize logger:(nullable id<FBControlCoreLogger>)logger
+{
+  NSParameterAssert(connections.count > 0);
+  NSParameterAssert(chunkSize > 0);
+
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _connections = [connections copy];
+  _chunkSize = chunkSize;
+  _logger = logger;
+
+  return self;
+}
+
+#pragma mark Properties
+
++ (size_t)defaultChunkSize
+{
+  return DefaultChunkSize;
+}
+
+#pragma mark Public Methods
+
+- (BOOL)copyItemsAtURLs:(NSArray<NSURL *> *)urls toContainerPath:(NSString *)containerPath error:(NSError **)error
+{
+  return [[self onQueue:dispatch_get_global_queue(QOS_CLASS_UTILITY, 0) copyItemsAtURLs:urls toContainerPath:containerPath] await:error] != nil;
+}
+
+- (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue copyItemsAtURLs:(NSArray<NSURL *> *)urls toContainerPath:(NSString *)containerPath
+{
+  return [FBFuture onQueue:queue resolve:^ FBFuture<NSNull *> * {
+    NSDate *start = NSDate.date;
+    NSError *error = nil;
+    FBAFCTransfer_Plan *plan = [FBAFCTransfer_Plan new];
+    for (NSURL *url in urls) {
+      if (![self addItemAtURL:url containerPath:containerPath toPlan:plan error:&error]) {
+        return [FBFuture futureWithError:error];
+      }
+    }
+
+    // Directories are created up-front on a single connection, so that any file can then be written on any connection.
+    if (plan.directories.count > 0 && ![self.connections.firstObject createDirectories:plan.directories error:&error]) {
+      return [FBFuture futureWithError:error];
+    }
+    return [[self
+      copyFiles:plan.files]
+      onQueue:queue map:^(NSNull *result) {
+        [self.logger logFormat:
+          @"Copied %lu files (%llu bytes) and %lu directories over %lu connections in %.2f seconds",
+          (unsigned long) plan.files.count,
+          plan.totalSize,
+          (unsigned long) plan.directories.count,
+          (unsigned long) [self workerCountForFileCount:plan.files.count],
+          [NSDate.date timeIntervalSinceDate:start]
+        ];
+        return result;
+      }];
+  }];
+}
+
+#pragma mark Private
+
+- (BOOL)addItemAtURL:(NSURL *)url containerPath:(NSString *)containerPath toPlan:(FBAFCTransfer_Plan *)plan error:(NSError **)error
+{
+  NSNumber *isDirectory = nil;
+  if (![url getResourceValue:&isDirectory forKey:NSURLIsDirectoryKey error:error]) {
+    return NO;
+  }
+  NSString *destination = [containerPath stringByAppendingPathComponent:url.lastPathComponent];
+  if (!isDirectory.boolValue) {
+    NSNumber *size = nil;
+    if (![url getResourceValue:&size forKey:NSURLFileSizeKey error:error]) {
+      return NO;
+    }
+    [plan.files addObject:[[FBAFCTransfer_File alloc] initWithHostPath:url.path containerPath:destination size:size.unsignedLongLongValue]];
+    plan.totalSize += size.unsignedLongLongValue;
+    return YES;
+  }
+
+  [plan.directories addObject:destination];
+  NSArray<NSURL *> *children = [NSFileManager.defaultManager
+    contentsOfDirectoryAtURL:url
+    includingPropertiesForKeys:@[NSURLIsDirectoryKey, NSURLFileSizeKey]
+    options:0
+    error:error];
+  if (!children) {
+    return NO;
+  }
+  for (NSURL *child in children) {
+    if (![self addItemAtURL:child containerPath:destination toPlan:plan error:error]) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+- (NSUInteger)workerCountForFileCount:(NSUInteger)fileCount
+{
+  return MAX(MIN(self.connections.count, fileCount), (NSUInteger) 1);
+}
+
+- (FBFuture<NSNull *> *)copyFiles:(NSArray<FBAFCTransfer_File *> *)files
+{
+  // Taking the largest files first means that the connections are more evenly loaded at the end of the transfer.
+  NSArray<FBAFCTransfer_File *> *ordered = [files sortedArrayUsingComparator:^ NSComparisonResult (FBAFCTransfer_File *left, FBAFCTransfer_File *right) {
+    if (left.size == right.size) {
+      return NSOrderedSame;
+    }
+    return left.size > right.size ? NSOrderedAscending : NSOrderedDescending;
+  }];
+
+  NSLock *lock = [NSLock new];
+  __block NSUInteger nextIndex = 0;
+  __block NSError *firstError = nil;
+  dispatch_group_t group = dispatch_group_create();
+  dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+  size_t chunkSize = self.chunkSize;
+
+  NSUInteger workerCount = [self workerCountForFileCount:files.count];
+  for (NSUInteger workerIndex = 0; workerIndex < workerCount; workerIndex++) {
+    FBAFCConnection *connection = self.connections[workerIndex];
+    dispatch_group_async(group, queue, ^{
+      while (YES) {
+        [lock lock];
+        FBAFCTransfer_File *file = (firstError || nextIndex >= ordered.count) ? nil : ordered[nextIndex++];
+        [lock unlock];
+        if (!file) {
+          return;
+        }
+        NSError *innerError = nil;
+        if ([connection writeFileAtHostPath:file.hostPath toContainerPath:file.containerPath chunkSize:chunkSize error:&innerError]) {
+          continue;
+        }
+        [lock lock];
+        firstError = firstError ?: innerError;
+        [lock unlock];
+        return;
+      }
+    });
+  }
+
+  // The caller's queue is not blocked whilst the workers run, the future resolves once they have all finished.
+  FBMutableFuture<NSNull *> *future = FBMutableFuture.future;
+  dispatch_group_notify(group, queue, ^{
+    if (firstError) {
+      [future resolveWithError:firstError];
+    } else {
+      [future resolveWithResult:NSNull.null];
+    }
+  });
+  return future;
+}
+
+@end
@@ -121,6 +121,18 @@ extern NSNotificationName const FBAMDeviceNotificationNameDeviceDetached;
  */
 - (FBFutureContext<FBAFCConnection *> *)houseArrestAFCConnectionForBundleID:(NSString *)bundleID afcCalls:(AFCCalls)afcCalls;
 
+/**
+ Starts several independent house arrest connections for a given bundle id, for transfers that are pipelined over more than one connection.
+ These connections are not pooled and are closed when the context is torn down.
+ If fewer connections than requested can be started, the context contains those that could be, failing only if none could be started.
+
+ @param bundleID the bundle id to use.
+ @param count the number of connections to start.
+ @param afcCalls the AFC calls to inject
+ @return a Future context wrapping the AFC Connections.
+ */
+- (FBFutureContext<NSArray<FBAFCConnection *> *> *)houseArrestAFCConnectionsForBundleID:(NSString *)bundleID count:(NSUInteger)count afcCalls:(AFCCalls)afcCalls;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -381,6 +381,45 @@ static const NSTimeInterval ServiceReuseTimeout = 6.0;
     }];
 }
 
+- (FBFutureContext<NSArray<FBAFCConnection *> *> *)houseArrestAFCConnectionsForBundleID:(NSString *)bundleID count:(NSUInteger)count afcCalls:(AFCCalls)afcCalls
+{
+  return [[self
+    connectToDeviceWithPurpose:@"house_arrest_transfer"]
+    onQueue:self.workQueue push:^ FBFutureContext<NSArray<FBAFCConnection *> *> * (FBAMDevice *device) {
+      NSMutableArray<FBAFCConnection *> *connections = [NSMutableArray array];
+      NSString *lastErrorMessage = nil;
+      for (NSUInteger index = 0; index < count; index++) {
+        AFCConnectionRef afcConnection = NULL;
+        int status = self.calls.CreateHouseArrestService(
+          self.amDevice,
+          (__bridge CFStringRef _Nonnull)(bundleID),
+          NULL,
+          &afcConnection
+        );
+        if (status != 0) {
+          lastErrorMessage = CFBridgingRelease(self.calls.CopyErrorText(status));
+          break;
+        }
+        [connections addObject:[[FBAFCConnection alloc] initWithConnection:afcConnection calls:afcCalls logger:self.logger]];
+      }
+      if (connections.count == 0) {
+        return [[FBDeviceControlError
+          describeFormat:@"Failed to start house_arrest service for '%@' with error (%@)", bundleID, lastErrorMessage]
+          failFutureContext];
+      }
+      if (connections.count < count) {
+        [self.logger logFormat:@"Started %lu of %lu house_arrest connections for '%@' (%@)", (unsigned long) connections.count, (unsigned long) count, bundleID, lastErrorMessage];
+      }
+      return [[FBFuture
+        futureWithResult:[connections copy]]
+        onQueue:self.workQueue contextualTeardown:^(NSArray<FBAFCConnection *> *started, FBFutureState __) {
+          for (FBAFCConnection *connection in started) {
+            [connection closeWithError:nil];
+          }
+        }];
+    }];
+}
+
 #pragma mark FBFutureContextManager Implementation
 
 - (FBFuture<FBAMDevice *> *)prepare:(id<FBControlCoreLogger>)logger
@@ -0,0 +1,261 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBDeviceControl/FBDeviceControl.h>
+
+/**
+ An in-memory container, shared by all connections.
+ */
+static NSMutableDictionary<NSString *, NSMutableData *> *sFiles;
+static NSMutableArray<NSString *> *sEvents;
+static NSMutableArray<NSNumber *> *sWriteLengths;
+static NSMutableSet *sWritingConnections;
+static NSString *sFailingPath;
+static dispatch_semaphore_t sWriteGate;
+
+static int memoryDirectoryCreate(AFCConnectionRef connection, const char *dir)
+{
+  @synchronized (sFiles) {
+    [sEvents addObject:[@"mkdir " stringByAppendingString:@(dir)]];
+  }
+  return 0;
+}
+
+static int memoryFileOpen(AFCConnectionRef connection, const char *_Nonnull path, FBAFCReadMode mode, CFTypeRef *_Nonnull ref)
+{
+  NSString *fileName = @(path);
+  @synchronized (sFiles) {
+    [sEvents addObject:[@"open " stringByAppendingString:fileName]];
+    sFiles[fileName] = [NSMutableData data];
+  }
+  *ref = CFBridgingRetain(fileName);
+  return 0;
+}
+
+static int memoryFileWrite(AFCConnectionRef connection, CFTypeRef ref, const void *buf, uint64_t len)
+{
+  NSString *fileName = (__bridge NSString *)(ref);
+  if ([fileName isEqualToString:sFailingPath]) {
+    return 1;
+  }
+  // Writes can be held until the gate is opened.
+  if (sWriteGate) {
+    dispatch_semaphore_wait(sWriteGate, DISPATCH_TIME_FOREVER);
+    dispatch_semaphore_signal(sWriteGate);
+  }
+  @synchronized (sFiles) {
+    [sFiles[fileName] appendBytes:buf length:(NSUInteger) len];
+    [sWriteLengths addObject:@(len)];
+    [sWritingConnections addObject:(__bridge id)(connection)];
+  }
+  return 0;
+}
+
+static int memoryFileClose(AFCConnectionRef connection, CFTypeRef ref)
+{
+  CFRelease(ref);
+  return 0;
+}
+
+static char *memoryErrorString(int errorCode)
+{
+  return (char *) "Injected Failure";
+}
+
+static CFDictionaryRef memoryCopyLastErrorInfo(AFCConnectionRef connection)
+{
+  return NULL;
+}
+
+@interface FBAFCTransferTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSURL *hostDirectory;
+@property (nonatomic, copy, readwrite) NSArray<FBAFCConnection *> *connections;
+
+@end
+
+@implementation FBAFCTransferTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  sFiles = [NSMutableDictionary dictionary];
+  sEvents = [NSMutableArray array];
+  sWriteLengths = [NSMutableArray array];
+  sWritingConnections = [NSMutableSet set];
+  sFailingPath = nil;
+  sWriteGate = nil;
+
+  AFCCalls calls = {
+    .DirectoryCreate = memoryDirectoryCreate,
+    .FileRefOpen = memoryFileOpen,
+    .FileRefWrite = memoryFileWrite,
+    .FileRefClose = memoryFileClose,
+    .ErrorString = memoryErrorString,
+    .ConnectionCopyLastErrorInfo = memoryCopyLastErrorInfo,
+  };
+  NSMutableArray<FBAFCConnection *> *connections = [NSMutableArray array];
+  for (NSUInteger index = 0; index < 4; index++) {
+    // The connection value identifies which connection a write happened on.
+    [connections addObject:[[FBAFCConnection alloc] initWithConnection:(__bridge AFCConnectionRef)(@(index)) calls:calls logger:nil]];
+  }
+  self.connections = connections;
+
+  self.hostDirectory = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString] isDirectory:YES];
+  [NSFileManager.defaultManager createDirectoryAtURL:self.hostDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtURL:self.hostDirectory error:nil];
+
+  [super tearDown];
+}
+
+- (NSData *)writeFile:(NSString *)relativePath length:(NSUInteger)length
+{
+  NSMutableData *data = [NSMutableData dataWithLength:length];
+  uint8_t *bytes = data.mutableBytes;
+  for (NSUInteger index = 0; index < length; index++) {
+    bytes[index] = (uint8_t) ((index * 31 + relativePath.length) & 0xff);
+  }
+  NSURL *url = [self.hostDirectory URLByAppendingPathComponent:relativePath];
+  [NSFileManager.defaultManager createDirectoryAtURL:url.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:nil];
+  [data writeToURL:url atomically:NO];
+  return data;
+}
+
+- (NSString *)containerPathOf:(NSString *)relativePath
+{
+  return [self.hostDirectory.lastPathComponent stringByAppendingPathComponent:relativePath];
+}
+
+- (void)testStreamsLargeFileInChunks
+{
+  size_t chunkSize = 64 * 1024;
+  NSData *expected = [self writeFile:@"large.bin" length:chunkSize * 3 + 100];
+  FBAFCTransfer *transfer = [FBAFCTransfer transferWithConnections:@[self.connections.firstObject] chunkSize:chunkSize logger:nil];
+
+  NSError *error = nil;
+  BOOL success = [transfer copyItemsAtURLs:@[self.hostDirectory] toContainerPath:@"" error:&error];
+  XCTAssertNil(error);
+  XCTAssertTrue(success);
+
+  XCTAssertEqualObjects(sFiles[[self containerPathOf:@"large.bin"]], expected);
+  NSArray<NSNumber *> *expectedLengths = @[@(chunkSize), @(chunkSize), @(chunkSize), @100];
+  XCTAssertEqualObjects(sWriteLengths, expectedLengths);
+}
+
+- (void)testCreatesAllDirectoriesBeforeAnyFile
+{
+  [self writeFile:@"a/b/c/deep.txt" length:10];
+  [self writeFile:@"a/shallow.txt" length:10];
+  [self writeFile:@"d/other.txt" length:10];
+  FBAFCTransfer *transfer = [FBAFCTransfer transferWithConnections:self.connections chunkSize:FBAFCTransfer.defaultChunkSize logger:nil];
+
+  NSError *error = nil;
+  BOOL success = [transfer copyItemsAtURLs:@[self.hostDirectory] toContainerPath:@"" error:&error];
+  XCTAssertNil(error);
+  XCTAssertTrue(success);
+
+  NSUInteger firstOpen = [sEvents indexOfObjectPassingTest:^ BOOL (NSString *event, NSUInteger index, BOOL *stop) {
+    return [event hasPrefix:@"open "];
+  }];
+  NSArray<NSString *> *directoryEvents = [sEvents subarrayWithRange:NSMakeRange(0, firstOpen)];
+  XCTAssertEqual(directoryEvents.count, 5u);
+  for (NSString *directory in @[@"", @"a", @"a/b", @"a/b/c", @"d"]) {
+    NSString *event = [@"mkdir " stringByAppendingString:[self containerPathOf:directory]];
+    XCTAssertTrue([directoryEvents containsObject:event]);
+  }
+  // Parents are always created before their children.
+  XCTAssertLessThan(
+    [directoryEvents indexOfObject:[@"mkdir " stringByAppendingString:[self containerPathOf:@"a"]]],
+    [directoryEvents indexOfObject:[@"mkdir " stringByAppendingString:[self containerPathOf:@"a/b/c"]]]
+  );
+}
+
+- (void)testPipelinesManyFilesOverConnections
+{
+  NSMutableDictionary<NSString *, NSData *> *expected = [NSMutableDictionary dictionary];
+  for (NSUInteger index = 0; index < 200; index++) {
+    NSString *relativePath = [NSString stringWithFormat:@"dir%lu/file%lu.bin", (unsigned long) (index % 7), (unsigned long) index];
+    expected[[self containerPathOf:relativePath]] = [self writeFile:relativePath length:index * 97];
+  }
+  FBAFCTransfer *transfer = [FBAFCTransfer transferWithConnections:self.connections chunkSize:4096 logger:nil];
+
+  NSError *error = nil;
+  BOOL success = [transfer copyItemsAtURLs:@[self.hostDirectory] toContainerPath:@"" error:&error];
+  XCTAssertNil(error);
+  XCTAssertTrue(success);
+
+  XCTAssertEqualObjects(sFiles, expected);
+  XCTAssertGreaterThan(sWritingConnections.count, 1u);
+  XCTAssertLessThanOrEqual(sWritingConnections.count, self.connections.count);
+  for (NSNumber *length in sWriteLengths) {
+    XCTAssertLessThanOrEqual(length.unsignedIntegerValue, 4096u);
+  }
+}
+
+- (void)testCopiesWithoutBlockingTheQueue
+{
+  NSMutableDictionary<NSString *, NSData *> *expected = [NSMutableDictionary dictionary];
+  for (NSUInteger index = 0; index < 20; index++) {
+    NSString *relativePath = [NSString stringWithFormat:@"file%lu.bin", (unsigned long) index];
+    expected[[self containerPathOf:relativePath]] = [self writeFile:relativePath length:64 * 1024];
+  }
+  FBAFCTransfer *transfer = [FBAFCTransfer transferWithConnections:self.connections chunkSize:4096 logger:nil];
+  dispatch_queue_t queue = dispatch_queue_create("com.facebook.fbdevicecontrol.tests.afctransfer", DISPATCH_QUEUE_SERIAL);
+
+  // Writes are held, so the queue must be free whilst the files are still being written.
+  sWriteGate = dispatch_semaphore_create(0);
+  FBFuture<NSNull *> *future = [transfer onQueue:queue copyItemsAtURLs:@[self.hostDirectory] toContainerPath:@""];
+  __block BOOL queueWasFree = NO;
+  dispatch_sync(queue, ^{
+    queueWasFree = YES;
+  });
+  XCTAssertTrue(queueWasFree);
+  XCTAssertFalse(future.hasCompleted);
+
+  dispatch_semaphore_signal(sWriteGate);
+  NSError *error = nil;
+  XCTAssertNotNil([future await:&error]);
+  XCTAssertNil(error);
+  XCTAssertEqualObjects(sFiles, expected);
+}
+
+- (void)testFailsOnFirstWriteError
+{
+  for (NSUInteger index = 0; index < 20; index++) {
+    [self writeFile:[NSString stringWithFormat:@"file%lu.bin", (unsigned long) index] length:1024];
+  }
+  sFailingPath = [self containerPathOf:@"file7.bin"];
+  FBAFCTransfer *transfer = [FBAFCTransfer transferWithConnections:self.connections chunkSize:FBAFCTransfer.defaultChunkSize logger:nil];
+
+  NSError *error = nil;
+  BOOL success = [transfer copyItemsAtURLs:@[self.hostDirectory] toContainerPath:@"" error:&error];
+  XCTAssertFalse(success);
+  XCTAssertNotNil(error);
+}
+
+- (void)testFailsForMissingHostFile
+{
+  NSURL *missing = [self.hostDirectory URLByAppendingPathComponent:@"missing.bin"];
+  FBAFCTransfer *transfer = [FBAFCTransfer transferWithConnections:self.connections chunkSize:FBAFCTransfer.defaultChunkSize logger:nil];
+
+  NSError *error = nil;
+  BOOL success = [transfer copyItemsAtURLs:@[missing] toContainerPath:@"" error:&error];
+  XCTAssertFalse(success);
+  XCTAssertNotNil(error);
+  XCTAssertEqual(sEvents.count, 0u);
+}
+
+@end
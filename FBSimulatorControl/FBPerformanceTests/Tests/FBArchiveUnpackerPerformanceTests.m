@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBArchiveUnpackerPerformanceTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+@property (nonatomic, copy, readwrite) NSString *archivePath;
+
+@end
+
+@implementation FBArchiveUnpackerPerformanceTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  NSString *source = [self.directory stringByAppendingPathComponent:@"Source"];
+  NSString *resources = [source stringByAppendingPathComponent:@"Payload/Foo.app/Resources"];
+  [NSFileManager.defaultManager createDirectoryAtPath:resources withIntermediateDirectories:YES attributes:nil error:nil];
+  NSMutableString *resource = [NSMutableString string];
+  for (NSUInteger index = 0; index < 20000; index++) {
+    [resource appendFormat:@"Line %lu\n", (unsigned long) index];
+  }
+  NSData *large = [resource dataUsingEncoding:NSUTF8StringEncoding];
+  for (NSUInteger index = 0; index < 200; index++) {
+    [large writeToFile:[resources stringByAppendingPathComponent:[NSString stringWithFormat:@"Copy%lu.txt", (unsigned long) index]] atomically:NO];
+  }
+  self.archivePath = [self.directory stringByAppendingPathComponent:@"Benchmark.ipa"];
+  NSError *error = nil;
+  BOOL success = [[[[FBTaskBuilder
+    withLaunchPath:@"/bin/sh"]
+    withArguments:@[@"-c", @"cd \"$0\" && exec /usr/bin/zip -q -r -y \"$1\" Payload", source, self.archivePath]]
+    runUntilCompletion]
+    awaitWithTimeout:60 error:&error] != nil;
+  XCTAssertTrue(success, @"%@", error);
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (NSURL *)emptyDestination
+{
+  NSString *destination = [self.directory stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  [NSFileManager.defaultManager createDirectoryAtPath:destination withIntermediateDirectories:YES attributes:nil error:nil];
+  return [NSURL fileURLWithPath:destination isDirectory:YES];
+}
+
+- (void)testUnzip
+{
+  [self measureBlock:^{
+    NSURL *destination = [self emptyDestination];
+    [[[[FBTaskBuilder
+      withLaunchPath:@"/usr/bin/unzip"]
+      withArguments:@[@"-q", @"-o", @"-d", destination.path, self.archivePath]]
+      runUntilCompletion]
+      awaitWithTimeout:60 error:nil];
+  }];
+}
+
+- (void)testUnpacker
+{
+  [self measureBlock:^{
+    NSURL *destination = [self emptyDestination];
+    NSError *error = nil;
+    XCTAssertTrue([FBArchiveUnpacker extractArchiveAtPath:self.archivePath toDirectory:destination error:&error], @"%@", error);
+  }];
+}
+
+@end
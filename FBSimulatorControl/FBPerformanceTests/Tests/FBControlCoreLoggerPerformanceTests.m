@@ -0,0 +1,33 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBControlCoreLoggerPerformanceTests : XCTestCase
+
+@end
+
+@implementation FBControlCoreLoggerPerformanceTests
+
+- (void)testBackgroundLogger
+{
+  id<FBControlCoreBackgroundLogger> logger = [FBControlCoreLogger backgroundLoggerToConsumer:FBLineBuffer.accumulatingBuffer level:FBControlCoreLogLevelInfo];
+  id<FBControlCoreLogger> debug = logger.debug;
+  [self measureBlock:^{
+    for (NSUInteger index = 0; index < 1000; index++) {
+      [logger logFormat:@"Message %lu", (unsigned long) index];
+      [debug logFormat:@"Discarded %lu", (unsigned long) index];
+    }
+    [logger.flush await:nil];
+  }];
+}
+
+@end
@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+static const NSUInteger LineCount = 500000;
+
+@interface FBDelimiterScannerPerformanceTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSData *data;
+
+@end
+
+@implementation FBDelimiterScannerPerformanceTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  // Lines of varying length, in the format of a Simulator's system log.
+  NSMutableData *data = [NSMutableData data];
+  for (NSUInteger index = 0; index < LineCount; index++) {
+    NSString *line = [NSString stringWithFormat:@"Nov 17 12:37:58 simulator SpringBoard[%lu]: Installed apps did change %@\n", (unsigned long) index, [@"" stringByPaddingToLength:index % 97 withString:@"x" startingAtIndex:0]];
+    [data appendData:[line dataUsingEncoding:NSUTF8StringEncoding]];
+  }
+  self.data = data;
+}
+
+- (void)testScanPositions
+{
+  NSData *data = self.data;
+  const uint8_t *bytes = data.bytes;
+  [self measureBlock:^{
+    size_t positions[1024];
+    size_t offset = 0;
+    NSUInteger lineCount = 0;
+    while (YES) {
+      size_t count = FBDelimiterScanPositions(bytes + offset, data.length - offset, '\n', positions, 1024);
+      lineCount += count;
+      if (count < 1024) {
+        break;
+      }
+      offset += positions[count - 1] + 1;
+    }
+    XCTAssertEqual(lineCount, LineCount);
+  }];
+}
+
+- (void)testLinesOfData
+{
+  [self measureBlock:^{
+    XCTAssertEqual([FBDelimiterScanner linesOfData:self.data].count, LineCount + 1);
+  }];
+}
+
+@end
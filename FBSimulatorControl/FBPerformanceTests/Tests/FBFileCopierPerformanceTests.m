@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBFileCopierPerformanceTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+@property (nonatomic, copy, readwrite) NSString *source;
+@property (nonatomic, copy, readwrite) NSString *destination;
+
+@end
+
+@implementation FBFileCopierPerformanceTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  self.source = [self.directory stringByAppendingPathComponent:@"Source"];
+  self.destination = [self.directory stringByAppendingPathComponent:@"Destination"];
+  [NSFileManager.defaultManager createDirectoryAtPath:[self.source stringByAppendingPathComponent:@"Nested"] withIntermediateDirectories:YES attributes:nil error:nil];
+  for (NSUInteger index = 0; index < 200; index++) {
+    NSMutableData *data = [NSMutableData dataWithLength:64 * 1024];
+    arc4random_buf(data.mutableBytes, data.length);
+    [data writeToFile:[self.source stringByAppendingPathComponent:[NSString stringWithFormat:@"Nested/%lu.bin", (unsigned long) index]] atomically:NO];
+  }
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (void)testSynchronizeUnchangedTree
+{
+  NSError *error = nil;
+  XCTAssertNotNil([FBFileCopier synchronizeItemAtPath:self.source toPath:self.destination error:&error], @"%@", error);
+  [self measureBlock:^{
+    FBFileCopyStatistics *statistics = [FBFileCopier synchronizeItemAtPath:self.source toPath:self.destination error:nil];
+    XCTAssertEqual(statistics.filesSkipped, 200u);
+  }];
+}
+
+@end
@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+@interface FBFileFinderPerformanceTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+
+@end
+
+@implementation FBFileFinderPerformanceTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  for (NSUInteger directory = 0; directory < 50; directory++) {
+    NSString *nested = [self.directory stringByAppendingPathComponent:[NSString stringWithFormat:@"Bulk/%lu/Nested", (unsigned long) directory]];
+    [NSFileManager.defaultManager createDirectoryAtPath:nested withIntermediateDirectories:YES attributes:nil error:nil];
+    for (NSUInteger file = 0; file < 40; file++) {
+      NSString *path = [nested stringByAppendingPathComponent:[NSString stringWithFormat:@"%lu.%@", (unsigned long) file, file % 2 ? @"png" : @"dat"]];
+      [NSData.data writeToFile:path atomically:NO];
+    }
+  }
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (void)testGlobWalk
+{
+  [self measureBlock:^{
+    XCTAssertEqual([FBFileFinder recursiveFindByFilenameGlobs:@[@"*.png"] inDirectory:self.directory].count, 1000u);
+  }];
+}
+
+- (void)testTrailingComponentGlobWalk
+{
+  [self measureBlock:^{
+    XCTAssertEqual([FBFileFinder recursiveFindByFilenameGlobs:@[@"Nested/*.png", @"Bulk/*/Nested/1*.dat"] inDirectory:self.directory].count, 1000u + 50u * 5u);
+  }];
+}
+
+@end
@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <libkern/OSByteOrder.h>
+
+#import <XCTestBootstrap/FBLogicReporterAdapter.h>
+#import <XCTestBootstrap/FBLogicReporterBinaryDecoder.h>
+#import <XCTestBootstrap/FBXCTestReporter.h>
+
+static const NSUInteger TestCount = 20000;
+
+/**
+ A reporter that does nothing, so that only the decoding is measured.
+ */
+@interface FBLogicReporterBinaryDecoderPerformanceTests_NullReporter : NSObject <FBXCTestReporter>
+
+@property (nonatomic, assign, readwrite) NSUInteger finishedCount;
+
+@end
+
+@implementation FBLogicReporterBinaryDecoderPerformanceTests_NullReporter
+
+- (void)processWaitingForDebuggerWithProcessIdentifier:(pid_t)pid {}
+- (void)debuggerAttached {}
+- (void)didBeginExecutingTestPlan {}
+- (void)didFinishExecutingTestPlan {}
+- (void)testSuite:(NSString *)testSuite didStartAt:(NSString *)startTime {}
+- (void)testCaseDidFailForTestClass:(NSString *)testClass method:(NSString *)method withMessage:(NSString *)message file:(NSString *)file line:(NSUInteger)line {}
+- (void)testCaseDidStartForTestClass:(NSString *)testClass method:(NSString *)method {}
+- (void)finishedWithSummary:(FBTestManagerResultSummary *)summary {}
+- (void)testHadOutput:(NSString *)output {}
+- (void)handleExternalEvent:(NSString *)event {}
+- (BOOL)printReportWithError:(NSError **)error { return YES; }
+
+- (void)testCaseDidFinishForTestClass:(NSString *)testClass method:(NSString *)method withStatus:(FBTestReportStatus)status duration:(NSTimeInterval)duration
+{
+  self.finishedCount++;
+}
+
+@end
+
+static void AppendFrame(NSMutableData *data, FBLogicReporterBinaryFrameType type, NSData *payload)
+{
+  uint32_t length = OSSwapHostToLittleInt32((uint32_t) payload.length + 1);
+  [data appendBytes:&length length:sizeof(length)];
+  [data appendBytes:&type length:sizeof(type)];
+  [data appendData:payload];
+}
+
+static void AppendUInt32(NSMutableData *payload, uint32_t value)
+{
+  value = OSSwapHostToLittleInt32(value);
+  [payload appendBytes:&value length:sizeof(value)];
+}
+
+static void AppendDouble(NSMutableData *payload, double value)
+{
+  uint64_t raw = 0;
+  memcpy(&raw, &value, sizeof(raw));
+  raw = OSSwapHostToLittleInt64(raw);
+  [payload appendBytes:&raw length:sizeof(raw)];
+}
+
+static void AppendStringDefinition(NSMutableData *data, uint32_t index, NSString *string)
+{
+  NSMutableData *payload = [NSMutableData data];
+  AppendUInt32(payload, index);
+  [payload appendData:[string dataUsingEncoding:NSUTF8StringEncoding]];
+  AppendFrame(data, FBLogicReporterBinaryFrameTypeString, payload);
+}
+
+@interface FBLogicReporterBinaryDecoderPerformanceTests : XCTestCase
+
+@end
+
+@implementation FBLogicReporterBinaryDecoderPerformanceTests
+
+- (void)testJSONEvents
+{
+  NSMutableArray<NSData *> *lines = [NSMutableArray array];
+  for (NSUInteger index = 0; index < TestCount; index++) {
+    NSString *method = [NSString stringWithFormat:@"testMethod%lu", (unsigned long) index];
+    [lines addObject:[NSJSONSerialization dataWithJSONObject:@{@"event": @"begin-test", @"className": @"OmniClass", @"methodName": method, @"timestamp": @1510917478} options:0 error:nil]];
+    [lines addObject:[NSJSONSerialization dataWithJSONObject:@{@"event": @"end-test", @"className": @"OmniClass", @"methodName": method, @"result": @"success", @"totalDuration": @0.005, @"exceptions": @[], @"timestamp": @1510917478} options:0 error:nil]];
+  }
+
+  [self measureBlock:^{
+    FBLogicReporterBinaryDecoderPerformanceTests_NullReporter *reporter = [FBLogicReporterBinaryDecoderPerformanceTests_NullReporter new];
+    FBLogicReporterAdapter *adapter = [[FBLogicReporterAdapter alloc] initWithReporter:reporter logger:nil];
+    for (NSData *line in lines) {
+      [adapter handleEventJSONData:line];
+    }
+    XCTAssertEqual(reporter.finishedCount, TestCount);
+  }];
+}
+
+- (void)testBinaryEvents
+{
+  NSMutableData *data = [NSMutableData dataWithBytes:FBLogicReporterBinaryMagic length:sizeof(FBLogicReporterBinaryMagic)];
+  AppendStringDefinition(data, 0, @"OmniClass");
+  for (NSUInteger index = 0; index < TestCount; index++) {
+    uint32_t methodIndex = (uint32_t) index + 1;
+    AppendStringDefinition(data, methodIndex, [NSString stringWithFormat:@"testMethod%lu", (unsigned long) index]);
+
+    NSMutableData *begin = [NSMutableData data];
+    AppendDouble(begin, 1510917478);
+    AppendUInt32(begin, 0);
+    AppendUInt32(begin, methodIndex);
+    AppendFrame(data, FBLogicReporterBinaryFrameTypeBeginTest, begin);
+
+    NSMutableData *end = [NSMutableData data];
+    AppendDouble(end, 1510917478);
+    AppendUInt32(end, 0);
+    AppendUInt32(end, methodIndex);
+    uint8_t result = FBLogicReporterBinaryTestResultSuccess;
+    [end appendBytes:&result length:sizeof(result)];
+    AppendDouble(end, 0.005);
+    uint8_t hasFailure = 0;
+    [end appendBytes:&hasFailure length:sizeof(hasFailure)];
+    AppendFrame(data, FBLogicReporterBinaryFrameTypeEndTest, end);
+  }
+
+  [self measureBlock:^{
+    FBLogicReporterBinaryDecoderPerformanceTests_NullReporter *reporter = [FBLogicReporterBinaryDecoderPerformanceTests_NullReporter new];
+    FBLogicReporterAdapter *adapter = [[FBLogicReporterAdapter alloc] initWithReporter:reporter logger:nil];
+    // Deliver in pipe-sized chunks, as the file reader would.
+    for (NSUInteger offset = 0; offset < data.length; offset += 16384) {
+      [adapter handleEventBinaryData:[data subdataWithRange:NSMakeRange(offset, MIN(16384u, data.length - offset))]];
+    }
+    XCTAssertEqual(reporter.finishedCount, TestCount);
+  }];
+}
+
+@end
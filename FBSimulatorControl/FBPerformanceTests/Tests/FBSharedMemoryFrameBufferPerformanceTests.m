@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+static const size_t FrameSize = 750 * 1334 * 4;
+
+static NSData *SyntheticFrame(uint8_t value, size_t length)
+{
+  NSMutableData *frame = [NSMutableData dataWithLength:length];
+  memset(frame.mutableBytes, value, length);
+  return frame;
+}
+
+@interface FBSharedMemoryFrameBufferPerformanceTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *name;
+
+@end
+
+@implementation FBSharedMemoryFrameBufferPerformanceTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  // Shared memory names are limited to 31 characters.
+  self.name = [NSString stringWithFormat:@"/fbperf.%@", [NSUUID.UUID.UUIDString substringToIndex:8]];
+}
+
+- (void)testSharedMemory
+{
+  NSError *error = nil;
+  FBSharedMemoryFrameWriter *writer = [FBSharedMemoryFrameWriter writerWithName:self.name frameCapacity:FrameSize logger:nil error:&error];
+  XCTAssertNotNil(writer, @"%@", error);
+  FBSharedMemoryFrameReader *reader = [FBSharedMemoryFrameReader readerWithName:self.name error:nil];
+  NSData *frame = SyntheticFrame(0x7f, FrameSize);
+  [self measureBlock:^{
+    for (NSUInteger index = 0; index < 60; index++) {
+      [writer consumeData:frame];
+      XCTAssertNotNil([reader latestFrameWithSequence:nil]);
+    }
+  }];
+  [writer consumeEndOfFile];
+}
+
+- (void)testPipe
+{
+  NSPipe *pipe = NSPipe.pipe;
+  id<FBDataConsumer> writer = [FBFileWriter syncWriterWithFileHandle:pipe.fileHandleForWriting];
+  NSData *frame = SyntheticFrame(0x7f, FrameSize);
+  [self measureBlock:^{
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+      for (NSUInteger index = 0; index < 60; index++) {
+        [writer consumeData:frame];
+      }
+    });
+    NSMutableData *received = [NSMutableData dataWithLength:FrameSize];
+    for (NSUInteger index = 0; index < 60; index++) {
+      size_t offset = 0;
+      while (offset < FrameSize) {
+        ssize_t result = read(pipe.fileHandleForReading.fileDescriptor, received.mutableBytes + offset, FrameSize - offset);
+        if (result <= 0) {
+          break;
+        }
+        offset += (size_t) result;
+      }
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+  }];
+  [writer consumeEndOfFile];
+}
+
+@end
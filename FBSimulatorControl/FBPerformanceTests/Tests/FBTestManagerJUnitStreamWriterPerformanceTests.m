@@ -0,0 +1,35 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <XCTestBootstrap/XCTestBootstrap.h>
+
+@interface FBTestManagerJUnitStreamWriterPerformanceTests : XCTestCase
+
+@end
+
+@implementation FBTestManagerJUnitStreamWriterPerformanceTests
+
+- (void)testStreamingManyTestCases
+{
+  NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.xml", NSUUID.UUID.UUIDString]];
+  [self measureBlock:^{
+    FBTestManagerJUnitStreamWriter *writer = [FBTestManagerJUnitStreamWriter writerForFilePath:filePath packagePrefix:nil error:nil];
+    [writer startTestSuite:@"Large"];
+    for (NSUInteger index = 0; index < 20000; index++) {
+      [writer finishTestCaseForTestClass:@"LargeTest" method:@"testMethod" duration:0.001 failures:@[]];
+    }
+    [writer finishTestSuiteWithSummary:[[FBTestManagerResultSummary alloc] initWithTestSuite:@"Large" finishTime:[NSDate date] runCount:20000 failureCount:0 unexpected:0 testDuration:20 totalDuration:20]];
+    XCTAssertTrue([writer finishWithError:nil]);
+  }];
+  [NSFileManager.defaultManager removeItemAtPath:filePath error:nil];
+}
+
+@end
@@ -53,15 +53,17 @@
     onQueue:self.simulator.asyncQueue fmap:^(NSString *dataContainer) {
       NSError *error;
       NSURL *basePathURL =  [NSURL fileURLWithPathComponents:@[dataContainer, containerPath]];
-      NSFileManager *fileManager = NSFileManager.defaultManager;
       for (NSURL *url in paths) {
         NSURL *destURL = [basePathURL URLByAppendingPathComponent:url.lastPathComponent];
-        if (![fileManager copyItemAtURL:url toURL:destURL error:&error]) {
+        // Only the files that differ from those already in the container are written, other files in the container are kept.
+        FBFileCopyStatistics *statistics = [FBFileCopier mergeItemAtPath:url.path toPath:destURL.path error:&error];
+        if (!statistics) {
           return [[[FBSimulatorError
             describeFormat:@"Could not copy from %@ to %@", url, destURL]
             causedBy:error]
             failFuture];
         }
+        [self.simulator.logger.debug logFormat:@"Copied %@ to %@: %@", url, destURL, statistics];
       }
       return [FBFuture futureWithResult:NSNull.null];
     }];
@@ -85,24 +87,16 @@
         }
         dstPath = [dstPath stringByAppendingPathComponent:[source lastPathComponent]];
       }
-      // if it already exists at the destination path we should remove it before copying again
-      if ([NSFileManager.defaultManager fileExistsAtPath:dstPath]) {
-        NSError *removeError;
-        if (![NSFileManager.defaultManager removeItemAtPath:dstPath error:&removeError]) {
-          return [[[FBSimulatorError
-            describeFormat:@"Could not remove %@", dstPath]
-            causedBy:removeError]
-            failFuture];
-        }
-      }
-
+      // If it already exists at the destination path, only the files that differ are written.
       NSError *copyError;
-      if (![NSFileManager.defaultManager copyItemAtPath:source toPath:dstPath error:&copyError]) {
+      FBFileCopyStatistics *statistics = [FBFileCopier synchronizeItemAtPath:source toPath:dstPath error:&copyError];
+      if (!statistics) {
         return [[[FBSimulatorError
           describeFormat:@"Could not copy from %@ to %@", source, dstPath]
           causedBy:copyError]
           failFuture];
       }
+      [self.simulator.logger.debug logFormat:@"Copied %@ to %@: %@", source, dstPath, statistics];
       return [FBFuture futureWithResult:NSNull.null];
     }];
 }
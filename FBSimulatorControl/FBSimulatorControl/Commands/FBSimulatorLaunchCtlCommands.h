@@ -15,6 +15,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @class FBProcessInfo;
 @class FBSimulator;
+@class FBSimulatorServiceMonitor;
 
 /**
  Protocol for interacting with a Simulator's launchctl
@@ -30,6 +31,14 @@ NS_ASSUME_NONNULL_BEGIN
 
 #pragma mark Querying Services
 
+/**
+ The Monitor of the Simulator's launchctl services.
+ Queries are answered from the Monitor's snapshot when it is recent, so that launchctl is not invoked for each query.
+
+ @return the Service Monitor.
+ */
+- (FBSimulatorServiceMonitor *)serviceMonitor;
+
 /**
  Finds the Service Name for a provided process.
  Will fail if there is no process matching the Process Info found.
@@ -67,6 +76,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Returns the currently running launchctl services.
+ This always fetches a new snapshot, rather than using a cached one.
  Returns a Mapping of Service Name to Process Identifier.
  NSNull is used to represent services that do not have a Process Identifier.
 
@@ -18,12 +18,14 @@
 #import "FBSimulator+Private.h"
 #import "FBSimulator.h"
 #import "FBSimulatorProcessFetcher.h"
+#import "FBSimulatorServiceMonitor.h"
 #import "FBSimulatorError.h"
 
 @interface FBSimulatorLaunchCtlCommands ()
 
-@property (nonatomic, strong, readonly) FBSimulator *simulator;
+@property (nonatomic, weak, readonly) FBSimulator *simulator;
 @property (nonatomic, strong, readonly) FBBinaryDescriptor *launchCtlBinary;
+@property (nonatomic, strong, readonly) FBSimulatorServiceMonitor *serviceMonitor;
 
 - (instancetype)initWithSimulator:(FBSimulator *)simulator launchCtlBinary:(FBBinaryDescriptor *)launchCtlBinary;
 
@@ -59,6 +61,18 @@
   _simulator = simulator;
   _launchCtlBinary = launchCtlBinary;
 
+  // The monitor must not retain the Simulator, as these commands are retained by the Simulator.
+  __weak typeof(self) weakSelf = self;
+  _serviceMonitor = [FBSimulatorServiceMonitor
+    monitorWithListProvider:^{
+      FBSimulatorLaunchCtlCommands *commands = weakSelf;
+      if (!commands) {
+        return [[FBSimulatorError describe:@"Simulator has been deallocated"] failFuture];
+      }
+      return [commands runWithArguments:@[@"list"]];
+    }
+    logger:[simulator.logger withName:@"launchctl"]];
+
   return self;
 }
 
@@ -77,32 +91,27 @@
 
 - (FBFuture<NSString *> *)serviceNameForProcess:(FBProcessInfo *)process
 {
+  NSNumber *processIdentifier = @(process.processIdentifier);
   return [[self
-    serviceNameAndProcessIdentifierForSubstring:@(process.processIdentifier).stringValue]
-    onQueue:self.simulator.asyncQueue map:^(NSArray<id> *tuple) {
-      return [tuple firstObject];
+    servicesMatching:^(NSString *serviceName, id serviceProcessIdentifier) {
+      return [serviceProcessIdentifier isEqual:processIdentifier];
+    }]
+    onQueue:self.simulator.asyncQueue fmap:^(NSDictionary<NSString *, NSNumber *> *serviceNameToProcessIdentifier) {
+      NSString *serviceName = serviceNameToProcessIdentifier.allKeys.firstObject;
+      if (!serviceName) {
+        return [[FBSimulatorError
+          describeFormat:@"No Matching processes for %@", processIdentifier]
+          failFuture];
+      }
+      return [FBFuture futureWithResult:serviceName];
     }];
 }
 
 - (FBFuture<NSDictionary<NSString *, NSNumber *> *> *)serviceNamesAndProcessIdentifiersForSubstring:(NSString *)substring
 {
-  return [[self
-    runWithArguments:@[@"list"]]
-    onQueue:self.simulator.asyncQueue fmap:^(NSString *text) {
-      FBLogSearchPredicate *predicate = [FBLogSearchPredicate substrings:@[substring]];
-      FBLogSearch *search = [FBLogSearch withText:text predicate:predicate];
-      NSMutableDictionary<NSString *, NSNumber *> *mapping = [NSMutableDictionary dictionary];
-      for (NSString *line in search.matchingLines) {
-        NSError *error = nil;
-        pid_t processIdentifier = 0;
-        NSString *serviceName = [FBSimulatorLaunchCtlCommands extractServiceNameFromListLine:line processIdentifierOut:&processIdentifier error:&error];
-        if (!serviceName) {
-          return [FBControlCoreError failFutureWithError:error];
-        }
-        mapping[serviceName] = @(processIdentifier);
-      }
-      return [FBFuture futureWithResult:mapping];
-    }];
+  return [self servicesMatching:^(NSString *serviceName, id processIdentifier) {
+    return (BOOL) ([serviceName containsString:substring] || [[processIdentifier description] isEqualToString:substring]);
+  }];
 }
 
 - (FBFuture<NSArray<id> *> *)serviceNameAndProcessIdentifierForSubstring:(NSString *)substring
@@ -137,47 +146,32 @@
 
 - (FBFuture<NSDictionary<NSString *, id> *> *)listServices
 {
-  return [[self
-    runWithArguments:@[@"list"]]
-    onQueue:self.simulator.asyncQueue fmap:^(NSString *text) {
-      NSArray<NSString *> *lines = [text componentsSeparatedByCharactersInSet:NSCharacterSet.newlineCharacterSet];
-      if (lines.count < 2) {
-        return [[FBSimulatorError
-          describeFormat:@"Insufficient number of lines from output '%@'", text]
-          failFuture];
-      }
-      lines = [lines subarrayWithRange:NSMakeRange(1, lines.count -1)];
-
-      NSMutableDictionary<NSString *, id> *services = [NSMutableDictionary dictionary];
-      for (NSString *line in lines) {
-        if (line.length == 0) {
-          continue;
-        }
-        pid_t processIdentifier = -1;
-        NSError *error = nil;
-        NSString *serviceName = [FBSimulatorLaunchCtlCommands extractServiceNameFromListLine:line processIdentifierOut:&processIdentifier error:&error];
-        if (!serviceName) {
-          return [FBSimulatorError failFutureWithError:error];
-        }
-        services[serviceName] = processIdentifier > 0 ? @(processIdentifier) : NSNull.null;
-      }
-      return [FBFuture futureWithResult:[services copy]];
-    }];
+  return [self.serviceMonitor refresh];
 }
 
 #pragma mark Manipulating Services
 
 - (FBFuture<NSString *> *)stopServiceWithName:(NSString *)serviceName
 {
-  return [[self
+  FBSimulatorServiceMonitor *serviceMonitor = self.serviceMonitor;
+  return [[[self
     runWithArguments:@[@"stop", serviceName]]
+    onQueue:self.simulator.asyncQueue map:^(NSString *output) {
+      [serviceMonitor invalidate];
+      return output;
+    }]
     rephraseFailure:@"Failed to stop service '%@'", serviceName];
 }
 
 - (FBFuture<NSString *> *)startServiceWithName:(NSString *)serviceName
 {
-  return [[self
+  FBSimulatorServiceMonitor *serviceMonitor = self.serviceMonitor;
+  return [[[self
     runWithArguments:@[@"start", serviceName]]
+    onQueue:self.simulator.asyncQueue map:^(NSString *output) {
+      [serviceMonitor invalidate];
+      return output;
+    }]
     rephraseFailure:@"Failed to start service '%@'", serviceName];
 }
 
@@ -208,34 +202,36 @@
   return regex;
 }
 
-+ (NSString *)extractServiceNameFromListLine:(NSString *)line processIdentifierOut:(pid_t *)processIdentifierOut error:(NSError **)error
+- (FBFuture<NSDictionary<NSString *, NSNumber *> *> *)servicesMatching:(BOOL (^)(NSString *serviceName, id processIdentifier))predicate
 {
-  NSArray<NSString *> *words = [line componentsSeparatedByCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
-  if (words.count != 3) {
-    return [[FBSimulatorError
-      describeFormat:@"Output does not have exactly three words: %@", [FBCollectionInformation oneLineDescriptionFromArray:words]]
-      fail:error];
-  }
-  NSString *serviceName = [words lastObject];
-  NSString *processIdentifierString = [words firstObject];
-  if ([processIdentifierString isEqualToString:@"-"]) {
-    if (processIdentifierOut) {
-      *processIdentifierOut = -1;
-    }
-    return serviceName;
-  }
-
-  NSInteger processIdentifierInteger = [processIdentifierString integerValue];
-  if (processIdentifierInteger < 1) {
-    return [[FBSimulatorError
-      describeFormat:@"Expected a process identifier as first word, but got %@ from %@", processIdentifierString, [FBCollectionInformation oneLineDescriptionFromArray:words]]
-      fail:error];
-  }
-  if (processIdentifierOut) {
-    *processIdentifierOut = (pid_t) processIdentifierInteger;
-  }
+  // A recent snapshot may not contain services that have just started, so fetch a new snapshot before reporting no matches.
+  FBSimulatorServiceMonitor *serviceMonitor = self.serviceMonitor;
+  dispatch_queue_t queue = self.simulator.asyncQueue;
+  return [[serviceMonitor
+    servicesWithMaximumAge:FBSimulatorServiceMonitorMaximumSnapshotAge]
+    onQueue:queue fmap:^(NSDictionary<NSString *, id> *services) {
+      NSDictionary<NSString *, NSNumber *> *matches = [FBSimulatorLaunchCtlCommands servicesIn:services matching:predicate];
+      if (matches.count > 0) {
+        return [FBFuture futureWithResult:matches];
+      }
+      return [[serviceMonitor
+        refresh]
+        onQueue:queue map:^(NSDictionary<NSString *, id> *refreshed) {
+          return [FBSimulatorLaunchCtlCommands servicesIn:refreshed matching:predicate];
+        }];
+    }];
+}
 
-  return serviceName;
++ (NSDictionary<NSString *, NSNumber *> *)servicesIn:(NSDictionary<NSString *, id> *)services matching:(BOOL (^)(NSString *serviceName, id processIdentifier))predicate
+{
+  NSMutableDictionary<NSString *, NSNumber *> *matches = [NSMutableDictionary dictionary];
+  [services enumerateKeysAndObjectsUsingBlock:^(NSString *serviceName, id processIdentifier, BOOL *_) {
+    if (!predicate(serviceName, processIdentifier)) {
+      return;
+    }
+    matches[serviceName] = [processIdentifier isKindOfClass:NSNumber.class] ? processIdentifier : @(-1);
+  }];
+  return [matches copy];
 }
 
 - (FBFuture<NSString *> *)runWithArguments:(NSArray<NSString *> *)arguments
@@ -15,10 +15,31 @@ NS_ASSUME_NONNULL_BEGIN
 
 @class FBSimulator;
 
+/**
+ Log Commands that are specific to Simulators.
+ */
+@protocol FBSimulatorLogCommands <FBLogCommands>
+
+/**
+ Subscribes to the log of the Simulator.
+ Subscribers with the same arguments share a single 'log stream' process, which is stopped when the last subscriber is cancelled.
+ The subscriber is attached before a new 'log stream' process is started, so it receives the first lines of the process.
+
+ @param arguments the arguments for 'log stream'.
+ @param predicate the predicate to filter lines with. If nil all lines are consumed.
+ @param consumer the consumer of lines.
+ @param replay YES if recently logged lines should be consumed before new lines, NO otherwise.
+ @param queueCapacity the maximum number of lines waiting to be consumed, beyond which lines are dropped and counted on the Subscription. 0 if no lines should be dropped.
+ @return a Future that resolves with the Subscription when the log stream has started. Cancelling the 'completed' Future of the Subscription will unsubscribe.
+ */
+- (FBFuture<FBLogHubSubscription *> *)subscribeToLog:(NSArray<NSString *> *)arguments predicate:(nullable FBLogSearchPredicate *)predicate consumer:(id<FBDataConsumer>)consumer replay:(BOOL)replay queueCapacity:(NSUInteger)queueCapacity;
+
+@end
+
 /**
  An implementation of Log Commands for Simulators.
  */
-@interface FBSimulatorLogCommands : NSObject <FBLogCommands, FBiOSTargetCommand>
+@interface FBSimulatorLogCommands : NSObject <FBSimulatorLogCommands, FBiOSTargetCommand>
 
 @end
 
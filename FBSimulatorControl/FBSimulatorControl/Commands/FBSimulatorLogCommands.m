@@ -17,9 +17,36 @@
 #import "FBSimulatorAgentOperation.h"
 #import "FBSimulatorError.h"
 
+static const NSUInteger FBSimulatorLogReplayCapacity = 1000;
+
+@interface FBSimulatorLogCommands_Stream : NSObject
+
+@property (nonatomic, strong, readonly) FBLogHub *hub;
+@property (nonatomic, strong, nullable, readwrite) FBFuture<FBSimulatorAgentOperation *> *operation;
+@property (nonatomic, assign, readwrite) NSUInteger attachments;
+
+@end
+
+@implementation FBSimulatorLogCommands_Stream
+
+- (instancetype)initWithHub:(FBLogHub *)hub
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _hub = hub;
+
+  return self;
+}
+
+@end
+
 @interface FBSimulatorLogCommands ()
 
 @property (nonatomic, weak, readonly) FBSimulator *simulator;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSArray<NSString *> *, FBSimulatorLogCommands_Stream *> *streams;
 
 @end
 
@@ -40,6 +67,7 @@
   }
 
   _simulator = simulator;
+  _streams = [NSMutableDictionary dictionary];
 
   return self;
 }
@@ -48,7 +76,34 @@
 
 - (FBFuture<id<FBiOSTargetContinuation>> *)tailLog:(NSArray<NSString *> *)arguments consumer:(id<FBDataConsumer>)consumer
 {
-  return (FBFuture<id<FBiOSTargetContinuation>> *) [self startLogCommand:[@[@"stream"] arrayByAddingObjectsFromArray:arguments] consumer:consumer];
+  // Tailing is lossless, the consumer receives every line however far behind it falls.
+  return (FBFuture<id<FBiOSTargetContinuation>> *) [self subscribeToLog:arguments predicate:nil consumer:consumer replay:NO queueCapacity:0];
+}
+
+- (FBFuture<FBLogHubSubscription *> *)subscribeToLog:(NSArray<NSString *> *)arguments predicate:(nullable FBLogSearchPredicate *)predicate consumer:(id<FBDataConsumer>)consumer replay:(BOOL)replay queueCapacity:(NSUInteger)queueCapacity
+{
+  dispatch_queue_t queue = self.simulator.workQueue;
+  return [FBFuture onQueue:queue resolve:^{
+    FBSimulatorLogCommands_Stream *stream = [self streamWithArguments:arguments];
+    stream.attachments++;
+    // Subscribing before the process is started means that no lines are missed between the start of the process and the subscription.
+    FBLogHubSubscription *subscription = [stream.hub subscribeWithPredicate:predicate consumer:consumer queueCapacity:queueCapacity replay:replay];
+    [subscription.completed onQueue:queue notifyOfCompletion:^(FBFuture *_) {
+      [self detachFromStream:stream arguments:arguments];
+    }];
+    if (!stream.operation) {
+      [self startStream:stream arguments:arguments];
+    }
+    return [[stream.operation
+      onQueue:queue map:^(FBSimulatorAgentOperation *_) {
+        return subscription;
+      }]
+      onQueue:queue notifyOfCompletion:^(FBFuture *future) {
+        if (future.state != FBFutureStateDone) {
+          [subscription.completed cancel];
+        }
+      }];
+  }];
 }
 
 - (FBFuture<NSArray<NSString *> *> *)logLinesWithArguments:(NSArray<NSString *> *)arguments
@@ -67,6 +122,53 @@
 
 #pragma mark Private
 
+- (FBSimulatorLogCommands_Stream *)streamWithArguments:(NSArray<NSString *> *)arguments
+{
+  FBSimulatorLogCommands_Stream *stream = self.streams[arguments];
+  if (stream) {
+    return stream;
+  }
+  // A single 'log stream' is shared between all subscribers with the same arguments.
+  FBLogHub *hub = [FBLogHub hubWithReplayCapacity:FBSimulatorLogReplayCapacity logger:[self.simulator.logger withName:@"log_hub"]];
+  stream = [[FBSimulatorLogCommands_Stream alloc] initWithHub:hub];
+  self.streams[arguments] = stream;
+  return stream;
+}
+
+- (void)startStream:(FBSimulatorLogCommands_Stream *)stream arguments:(NSArray<NSString *> *)arguments
+{
+  FBLogHub *hub = stream.hub;
+  FBFuture<FBSimulatorAgentOperation *> *operation = [self startLogCommand:[@[@"stream"] arrayByAddingObjectsFromArray:arguments] consumer:hub];
+  stream.operation = operation;
+
+  // Once the process exits, the next subscriber will start a new stream.
+  dispatch_queue_t queue = self.simulator.workQueue;
+  [[operation
+    onQueue:queue fmap:^(FBSimulatorAgentOperation *agent) {
+      return agent.processStatus;
+    }]
+    onQueue:queue notifyOfCompletion:^(FBFuture *_) {
+      if (self.streams[arguments] == stream) {
+        [self.streams removeObjectForKey:arguments];
+      }
+      [hub consumeEndOfFile];
+    }];
+}
+
+- (void)detachFromStream:(FBSimulatorLogCommands_Stream *)stream arguments:(NSArray<NSString *> *)arguments
+{
+  stream.attachments--;
+  if (stream.attachments > 0) {
+    return;
+  }
+  if (self.streams[arguments] == stream) {
+    [self.streams removeObjectForKey:arguments];
+  }
+  [stream.operation onQueue:self.simulator.workQueue fmap:^(FBSimulatorAgentOperation *agent) {
+    return [agent.completed cancel];
+  }];
+}
+
 - (FBFuture<NSNull *> *)runLogCommandAndWait:(NSArray<NSString *> *)arguments consumer:(id<FBDataConsumer>)consumer
 {
   return [[[self
@@ -17,6 +17,7 @@
 #import "FBSimulatorError.h"
 #import "FBSimulatorBootConfiguration.h"
 #import "FBDefaultsModificationStrategy.h"
+#import "FBTCCDatabaseModificationStrategy.h"
 
 FBiOSTargetFutureType const FBiOSTargetFutureTypeApproval = @"approve";
 
@@ -76,7 +77,7 @@ FBiOSTargetFutureType const FBiOSTargetFutureTypeApproval = @"approve";
 
   // Composing different futures due to differences in how these operate.
   NSMutableArray<FBFuture<NSNull *> *> *futures = [NSMutableArray array];
-  if ([[NSSet setWithArray:FBSimulatorSettingsCommands.tccDatabaseMapping.allKeys] intersectsSet:services]) {
+  if ([FBTCCDatabaseModificationStrategy.supportedServices intersectsSet:services]) {
     [futures addObject:[self modifyTCCDatabaseWithBundleIDs:bundleIDs toServices:services]];
   }
   if ([services containsObject:FBSettingsApprovalServiceLocation]) {
@@ -133,44 +134,19 @@ FBiOSTargetFutureType const FBiOSTargetFutureTypeApproval = @"approve";
 - (FBFuture<NSNull *> *)modifyTCCDatabaseWithBundleIDs:(NSSet<NSString *> *)bundleIDs toServices:(NSSet<FBSettingsApprovalService> *)services
 {
   NSString *databasePath = [self.simulator.dataDirectory stringByAppendingPathComponent:@"Library/TCC/TCC.db"];
-  if (!databasePath) {
+  if (![NSFileManager.defaultManager fileExistsAtPath:databasePath]) {
     return [[FBSimulatorError
       describeFormat:@"Expected file to exist at path %@ but it was not there", databasePath]
       failFuture];
   }
 
-  id<FBControlCoreLogger> logger = [self.simulator.logger withName:@"sqlite_auth"];
-  dispatch_queue_t queue = self.simulator.asyncQueue;
-
-  return [[[FBSimulatorSettingsCommands
-    buildRowsForDatabase:databasePath bundleIDs:bundleIDs services:services queue:queue logger:logger]
-    onQueue:self.simulator.workQueue fmap:^(NSString *rows) {
-      return [FBSimulatorSettingsCommands
-        runSqliteCommandOnDatabase:databasePath
-        arguments:@[[NSString stringWithFormat:@"INSERT or REPLACE INTO access VALUES %@", rows]]
-        queue:queue
-        logger:logger];
-    }]
-    mapReplace:NSNull.null];
+  return [[FBTCCDatabaseModificationStrategy
+    strategyWithSimulators:@[self.simulator]]
+    grantAccess:bundleIDs toServices:services];
 }
 
 #pragma mark Private
 
-+ (NSDictionary<FBSettingsApprovalService, NSString *> *)tccDatabaseMapping
-{
-  static dispatch_once_t onceToken;
-  static NSDictionary<FBSettingsApprovalService, NSString *> *mapping;
-  dispatch_once(&onceToken, ^{
-    mapping = @{
-      FBSettingsApprovalServiceContacts: @"kTCCServiceAddressBook",
-      FBSettingsApprovalServicePhotos: @"kTCCServicePhotos",
-      FBSettingsApprovalServiceCamera: @"kTCCServiceCamera",
-      FBSettingsApprovalServiceMicrophone: @"kTCCServiceMicrophone",
-    };
-  });
-  return mapping;
-}
-
 + (NSSet<NSString *> *)permissibleAddressBookDBFilenames
 {
   static dispatch_once_t onceToken;
@@ -188,72 +164,6 @@ FBiOSTargetFutureType const FBiOSTargetFutureTypeApproval = @"approve";
   return filenames;
 }
 
-+ (NSSet<FBSettingsApprovalService> *)filteredTCCApprovals:(NSSet<FBSettingsApprovalService> *)approvals
-{
-  NSMutableSet<FBSettingsApprovalService> *filtered = [NSMutableSet setWithSet:approvals];
-  [filtered intersectSet:[NSSet setWithArray:self.tccDatabaseMapping.allKeys]];
-  return [filtered copy];
-}
-
-+ (FBFuture<NSString *> *)buildRowsForDatabase:(NSString *)databasePath bundleIDs:(NSSet<NSString *> *)bundleIDs services:(NSSet<FBSettingsApprovalService> *)services queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
-{
-  NSParameterAssert(bundleIDs.count >= 1);
-  NSParameterAssert(services.count >= 1);
-
-  return [[self
-    runSqliteCommandOnDatabase:databasePath arguments:@[@".schema access"] queue:queue logger:logger]
-    onQueue:queue map:^(NSString *result) {
-      if ([result containsString:@"last_modified"]) {
-        return [FBSimulatorSettingsCommands postiOS12ApprovalRowsForBundleIDs:bundleIDs services:services];
-      } else {
-        return [FBSimulatorSettingsCommands preiOS12ApprovalRowsForBundleIDs:bundleIDs services:services];
-      }
-    }];
-}
-
-+ (NSString *)preiOS12ApprovalRowsForBundleIDs:(NSSet<NSString *> *)bundleIDs services:(NSSet<FBSettingsApprovalService> *)services
-{
-  NSMutableArray<NSString *> *tuples = [NSMutableArray array];
-  for (NSString *bundleID in bundleIDs) {
-    for (FBSettingsApprovalService service in [self filteredTCCApprovals:services]) {
-      NSString *serviceName = self.tccDatabaseMapping[service];
-      [tuples addObject:[NSString stringWithFormat:@"('%@', '%@', 0, 1, 0, 0, 0)", serviceName, bundleID]];
-    }
-  }
-  return [tuples componentsJoinedByString:@", "];
-}
-
-+ (NSString *)postiOS12ApprovalRowsForBundleIDs:(NSSet<NSString *> *)bundleIDs services:(NSSet<FBSettingsApprovalService> *)services
-{
-  NSUInteger timestamp = (NSUInteger) NSDate.date.timeIntervalSince1970;
-  NSMutableArray<NSString *> *tuples = [NSMutableArray array];
-  for (NSString *bundleID in bundleIDs) {
-    for (FBSettingsApprovalService service in [self filteredTCCApprovals:services]) {
-      NSString *serviceName = self.tccDatabaseMapping[service];
-      [tuples addObject:[NSString stringWithFormat:@"('%@', '%@', 0, 1, 1, NULL, NULL, NULL, 'UNUSED', NULL, NULL, %lu)", serviceName, bundleID, timestamp]];
-    }
-  }
-  return [tuples componentsJoinedByString:@", "];
-}
-
-+ (FBFuture<NSString *> *)runSqliteCommandOnDatabase:(NSString *)databasePath arguments:(NSArray<NSString *> *)arguments queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
-{
-  return [[[[[FBTaskBuilder
-    withLaunchPath:@"/usr/bin/sqlite3" arguments:[@[databasePath] arrayByAddingObjectsFromArray:arguments]]
-    withStdOutInMemoryAsString]
-    withStdErrInMemoryAsString]
-    runUntilCompletion]
-    onQueue:queue fmap:^(FBTask<NSNull *, NSString *, NSString *> *task) {
-      if ([task.stdErr hasPrefix:@"Error"]) {
-        return [[[FBSimulatorError
-          describeFormat:@"Failed to execute sqlite command: %@", task.stdErr]
-          logger:logger]
-          failFuture];
-      }
-      return [FBFuture futureWithResult:task.stdOut];
-    }];
-}
-
 + (NSArray<NSString *> *)contactsDatabaseFilePathsFromContainingDirectory:(NSString *)databaseDirectory error:(NSError **)error
 {
   NSMutableArray<NSString *> *filePaths = [NSMutableArray array];
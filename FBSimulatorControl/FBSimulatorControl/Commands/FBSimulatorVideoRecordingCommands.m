@@ -87,6 +87,10 @@
     connectToFramebuffer]
     onQueue:self.simulator.workQueue map:^(FBFramebuffer *framebuffer) {
       NSNumber *framesPerSecond = configuration.framesPerSecond;
+      NSNumber *latencyBudget = configuration.latencyBudget;
+      if (latencyBudget) {
+        return [FBSimulatorBitmapStream adaptiveStreamWithFramebuffer:framebuffer framesPerSecond:(framesPerSecond ?: @60).unsignedIntegerValue latencyBudget:latencyBudget.doubleValue logger:logger];
+      }
       if (framesPerSecond) {
         return [FBSimulatorBitmapStream eagerStreamWithFramebuffer:framebuffer framesPerSecond:framesPerSecond.unsignedIntegerValue logger:logger];
       }
@@ -251,6 +251,11 @@ FBDiagnosticName const FBDiagnosticNameSimulatorBootstrap = @"launchd_bootstrap"
 
 }
 
+- (void)simulatorDidBoot:(FBSimulatorBootTimeline *)timeline
+{
+
+}
+
 - (void)didChangeState:(FBiOSTargetState)state
 {
 
@@ -104,6 +104,13 @@
   }
 }
 
+- (void)simulatorDidBoot:(FBSimulatorBootTimeline *)timeline
+{
+  for (id<FBSimulatorEventSink> sink in self.sinks) {
+    [sink simulatorDidBoot:timeline];
+  }
+}
+
 - (void)didChangeState:(FBiOSTargetState)state
 {
   for (id<FBSimulatorEventSink> sink in self.sinks) {
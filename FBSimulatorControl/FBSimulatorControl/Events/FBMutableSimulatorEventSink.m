@@ -61,6 +61,11 @@
   [self.eventSink applicationDidTerminate:operation expected:expected];
 }
 
+- (void)simulatorDidBoot:(FBSimulatorBootTimeline *)timeline
+{
+  [self.eventSink simulatorDidBoot:timeline];
+}
+
 - (void)didChangeState:(FBiOSTargetState)state
 {
   [self.eventSink didChangeState:state];
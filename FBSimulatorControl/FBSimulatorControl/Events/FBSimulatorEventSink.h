@@ -16,6 +16,7 @@ NS_ASSUME_NONNULL_BEGIN
 @class FBProcessInfo;
 @class FBSimulator;
 @class FBSimulatorAgentOperation;
+@class FBSimulatorBootTimeline;
 @class FBSimulatorConnection;
 @class FBTestManager;
 @protocol FBJSONSerializable;
@@ -64,6 +65,13 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)simulatorDidLaunch:(FBProcessInfo *)launchdProcess;
 
+/**
+ Event for the completion of a Simulator's boot, once it has been verified as usable.
+
+ @param timeline the Phases that the Simulator passed through whilst booting.
+ */
+- (void)simulatorDidBoot:(FBSimulatorBootTimeline *)timeline;
+
 /**
  Event for the termination of a Simulator's launchd_sim.
 
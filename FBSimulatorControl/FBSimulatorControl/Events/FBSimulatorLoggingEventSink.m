@@ -14,6 +14,7 @@
 #import "FBSimulator.h"
 #import "FBSimulatorAgentOperation.h"
 #import "FBSimulatorApplicationOperation.h"
+#import "FBSimulatorBootTimeline.h"
 
 NSString *BoolDescription(BOOL b);
 NSString *BoolDescription(BOOL b)
@@ -100,6 +101,12 @@ NSString *BoolDescription(BOOL b)
   [self.logger logFormat:@"Application Did Terminate => Expected %@ %@", BoolDescription(expected), operation];
 }
 
+- (void)simulatorDidBoot:(FBSimulatorBootTimeline *)timeline
+{
+  NSData *data = [NSJSONSerialization dataWithJSONObject:timeline.jsonSerializableRepresentation options:0 error:nil];
+  [self.logger logFormat:@"Simulator Did Boot => %@", [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding]];
+}
+
 - (void)didChangeState:(FBiOSTargetState)state
 {
   [self.logger logFormat:@"Did Change State => %@", FBiOSTargetStateStringFromState(state)];
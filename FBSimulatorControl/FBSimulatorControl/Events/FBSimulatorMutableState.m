@@ -124,6 +124,11 @@
   [self.sink applicationDidTerminate:operation expected:expected];
 }
 
+- (void)simulatorDidBoot:(FBSimulatorBootTimeline *)timeline
+{
+  [self.sink simulatorDidBoot:timeline];
+}
+
 - (void)didChangeState:(FBiOSTargetState)state
 {
   if (state == self.lastKnownState) {
@@ -28,6 +28,11 @@ extern FBSimulatorNotificationName const FBSimulatorNotificationNameDidLaunch;
  */
 extern FBSimulatorNotificationName const FBSimulatorNotificationNameDidTerminate;
 
+/**
+ Notification that is fired when a Simulator has finished Booting.
+ */
+extern FBSimulatorNotificationName const FBSimulatorNotificationNameDidBoot;
+
 /**
  Notification that is fired when a Simulator's Container Process Starts.
  */
@@ -98,6 +103,11 @@ extern FBSimulatorNotificationUserInfoKey const FBSimulatorNotificationUserInfoK
  */
 extern FBSimulatorNotificationUserInfoKey const FBSimulatorNotificationUserInfoKeyState;
 
+/**
+ Notification UserInfo for the Boot Timeline.
+ */
+extern FBSimulatorNotificationUserInfoKey const FBSimulatorNotificationUserInfoKeyBootTimeline;
+
 /**
  Notification UserInfo for Test Manager.
  */
@@ -14,6 +14,7 @@
 
 FBSimulatorNotificationName const FBSimulatorNotificationNameDidLaunch = @"FBSimulatorNotificationNameDidLaunch";
 FBSimulatorNotificationName const FBSimulatorNotificationNameDidTerminate = @"FBSimulatorNotificationNameDidTerminate";
+FBSimulatorNotificationName const FBSimulatorNotificationNameDidBoot = @"FBSimulatorNotificationNameDidBoot";
 FBSimulatorNotificationName const FBSimulatorNotificationNameSimulatorApplicationDidLaunch = @"FBSimulatorNotificationNameSimulatorApplicationDidLaunch";
 FBSimulatorNotificationName const FBSimulatorNotificationNameSimulatorApplicationDidTerminate = @"FBSimulatorNotificationNameSimulatorApplicationDidTerminate";
 FBSimulatorNotificationName const FBSimulatorNotificationNameConnectionDidConnect = @"FBSimulatorNotificationNameConnectionDidConnect";
@@ -29,6 +30,7 @@ NSString *const FBSimulatorNotificationUserInfoKeyProcess = @"process";
 NSString *const FBSimulatorNotificationUserInfoKeyProcessIdentifier = @"pid";
 NSString *const FBSimulatorNotificationUserInfoKeyConnection = @"connection";
 NSString *const FBSimulatorNotificationUserInfoKeyState = @"simulator_state";
+NSString *const FBSimulatorNotificationUserInfoKeyBootTimeline = @"boot_timeline";
 NSString *const FBSimulatorNotificationUserInfoKeyTestManager = @"testManager";
 NSString *const FBSimulatorNotificationUserInfoKeyWaitingForDebugger = @"waiting_for_debugger";
 
@@ -125,6 +127,13 @@ NSString *const FBSimulatorNotificationUserInfoKeyWaitingForDebugger = @"waiting
   }];
 }
 
+- (void)simulatorDidBoot:(FBSimulatorBootTimeline *)timeline
+{
+  [self materializeNotification:FBSimulatorNotificationNameDidBoot userInfo:@{
+    FBSimulatorNotificationUserInfoKeyBootTimeline : timeline
+  }];
+}
+
 - (void)didChangeState:(FBiOSTargetState)state
 {
   [self materializeNotification:FBSimulatorNotificationNameStateDidChange userInfo:@{
@@ -34,6 +34,7 @@
 #import <FBSimulatorControl/FBSimulatorBitmapStream.h>
 #import <FBSimulatorControl/FBSimulatorBootConfiguration.h>
 #import <FBSimulatorControl/FBSimulatorBootStrategy.h>
+#import <FBSimulatorControl/FBSimulatorBootTimeline.h>
 #import <FBSimulatorControl/FBSimulatorBridge.h>
 #import <FBSimulatorControl/FBSimulatorBridgeCommands.h>
 #import <FBSimulatorControl/FBSimulatorConfiguration+CoreSimulator.h>
@@ -54,6 +55,7 @@
 #import <FBSimulatorControl/FBSimulatorIndigoHID.h>
 #import <FBSimulatorControl/FBSimulatorLaunchCtlCommands.h>
 #import <FBSimulatorControl/FBSimulatorLifecycleCommands.h>
+#import <FBSimulatorControl/FBSimulatorLogCommands.h>
 #import <FBSimulatorControl/FBSimulatorLoggingEventSink.h>
 #import <FBSimulatorControl/FBSimulatorMediaCommands.h>
 #import <FBSimulatorControl/FBSimulatorMutableState.h>
@@ -64,6 +66,7 @@
 #import <FBSimulatorControl/FBSimulatorProcessFetcher.h>
 #import <FBSimulatorControl/FBSimulatorScreenshotCommands.h>
 #import <FBSimulatorControl/FBSimulatorServiceContext.h>
+#import <FBSimulatorControl/FBSimulatorServiceMonitor.h>
 #import <FBSimulatorControl/FBSimulatorSet+Private.h>
 #import <FBSimulatorControl/FBSimulatorSet.h>
 #import <FBSimulatorControl/FBSimulatorSettingsCommands.h>
@@ -76,6 +79,7 @@
 #import <FBSimulatorControl/FBSimulatorXCTestCommands.h>
 #import <FBSimulatorControl/FBSimulatorXCTestProcessExecutor.h>
 #import <FBSimulatorControl/FBSurfaceImageGenerator.h>
+#import <FBSimulatorControl/FBTCCDatabaseModificationStrategy.h>
 #import <FBSimulatorControl/FBVideoEncoderConfiguration.h>
 #import <FBSimulatorControl/FBVideoEncoderSimulatorKit.h>
 #import <FBSimulatorControl/NSPredicate+FBSimulatorControl.h>
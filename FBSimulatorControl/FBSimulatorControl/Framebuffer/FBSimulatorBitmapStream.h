@@ -49,6 +49,45 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (instancetype)eagerStreamWithFramebuffer:(FBFramebuffer *)framebuffer framesPerSecond:(NSUInteger)framesPerSecond logger:(id<FBControlCoreLogger>)logger;
 
+/**
+ Constructs a Bitmap Stream.
+ Bitmaps will be written when there is a new bitmap available, at a rate that adapts to how quickly the consumer accepts them.
+ If the consumer is still writing a previous frame, only the newest bitmap is written once it is done, older bitmaps are dropped.
+ The frame rate is lowered when the end-to-end latency is above the latency budget, and raised again when it is well within it.
+ The end-to-end latency is from when a new bitmap is available, to when the consumer has accepted it.
+ Consumers that conform to FBDataConsumerBackpressure have accepted a frame when it has been flushed, otherwise when -[FBDataConsumer consumeData:] returns.
+ As a consumer is only given a frame once it has flushed the previous one, it never coalesces or drops part of the framed output.
+
+ @param framebuffer the framebuffer to get frames from.
+ @param framesPerSecond the maximum number of frames to send per second.
+ @param latencyBudget the end-to-end latency in seconds to stay within.
+ @param logger the logger to log to.
+ @return a new Bitmap Stream object.
+ */
++ (instancetype)adaptiveStreamWithFramebuffer:(FBFramebuffer *)framebuffer framesPerSecond:(NSUInteger)framesPerSecond latencyBudget:(NSTimeInterval)latencyBudget logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Properties
+
+/**
+ The number of frames that have been written to the consumer.
+ */
+@property (atomic, assign, readonly) NSUInteger framesWritten;
+
+/**
+ The number of frames that were replaced by a newer frame before they could be written.
+ */
+@property (atomic, assign, readonly) NSUInteger framesDropped;
+
+/**
+ A moving average of the end-to-end latency of written frames, in seconds.
+ */
+@property (atomic, assign, readonly) NSTimeInterval averageLatency;
+
+/**
+ The current maximum number of frames per second. 0 if the rate is not limited.
+ */
+@property (atomic, assign, readonly) double effectiveFramesPerSecond;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -47,6 +47,8 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
   };
 }
 
+static const NSTimeInterval FBBitmapStreamAdaptiveMaximumInterval = 1;
+
 @interface FBSimulatorBitmapStream_Lazy : FBSimulatorBitmapStream
 
 @end
@@ -60,6 +62,20 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 
 @end
 
+@interface FBSimulatorBitmapStream_Adaptive : FBSimulatorBitmapStream
+
+@property (nonatomic, assign, readonly) NSTimeInterval minimumInterval;
+@property (nonatomic, assign, readonly) NSTimeInterval latencyBudget;
+@property (nonatomic, assign, readwrite) NSTimeInterval interval;
+@property (nonatomic, assign, readwrite) NSTimeInterval pendingFrameTime;
+@property (nonatomic, assign, readwrite) NSTimeInterval lastWriteTime;
+@property (nonatomic, assign, readwrite) BOOL writing;
+@property (nonatomic, assign, readwrite) BOOL writeScheduled;
+
+- (instancetype)initWithFramebuffer:(FBFramebuffer *)framebuffer writeQueue:(dispatch_queue_t)writeQueue minimumInterval:(NSTimeInterval)minimumInterval latencyBudget:(NSTimeInterval)latencyBudget logger:(id<FBControlCoreLogger>)logger;
+
+@end
+
 
 @interface FBSimulatorBitmapStream ()
 
@@ -73,7 +89,13 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 @property (nonatomic, assign, nullable, readwrite) CVPixelBufferRef pixelBuffer;
 @property (nonatomic, copy, nullable, readwrite) NSDictionary<NSString *, id> *pixelBufferAttributes;
 
+@property (atomic, assign, readwrite) NSUInteger framesWritten;
+@property (atomic, assign, readwrite) NSUInteger framesDropped;
+@property (atomic, assign, readwrite) NSTimeInterval averageLatency;
+@property (atomic, assign, readwrite) double effectiveFramesPerSecond;
+
 - (void)pushFrame;
+- (void)recordWrittenFrameWithLatency:(NSTimeInterval)latency;
 
 @end
 
@@ -95,6 +117,12 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
   return [[FBSimulatorBitmapStream_Eager alloc] initWithFramebuffer:framebuffer writeQueue:self.writeQueue timeInterval:timeInterval logger:logger];
 }
 
++ (instancetype)adaptiveStreamWithFramebuffer:(FBFramebuffer *)framebuffer framesPerSecond:(NSUInteger)framesPerSecond latencyBudget:(NSTimeInterval)latencyBudget logger:(id<FBControlCoreLogger>)logger
+{
+  NSTimeInterval minimumInterval = 1.0 / MAX(framesPerSecond, (NSUInteger) 1);
+  return [[FBSimulatorBitmapStream_Adaptive alloc] initWithFramebuffer:framebuffer writeQueue:self.writeQueue minimumInterval:minimumInterval latencyBudget:latencyBudget logger:logger];
+}
+
 - (instancetype)initWithFramebuffer:(FBFramebuffer *)framebuffer writeQueue:(dispatch_queue_t)writeQueue logger:(id<FBControlCoreLogger>)logger
 {
   self = [super init];
@@ -240,7 +268,15 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
   if (!self.pixelBuffer || !self.consumer) {
     return;
   }
+  NSTimeInterval startTime = NSProcessInfo.processInfo.systemUptime;
   [FBSimulatorBitmapStream writeBitmap:self.pixelBuffer consumer:self.consumer];
+  [self recordWrittenFrameWithLatency:NSProcessInfo.processInfo.systemUptime - startTime];
+}
+
+- (void)recordWrittenFrameWithLatency:(NSTimeInterval)latency
+{
+  self.averageLatency = self.framesWritten == 0 ? latency : ((self.averageLatency * 7) + latency) / 8;
+  self.framesWritten += 1;
 }
 
 + (void)writeBitmap:(CVPixelBufferRef)pixelBuffer consumer:(id<FBDataConsumer>)consumer
@@ -255,6 +291,19 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
   CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
 }
 
++ (void)copyBitmap:(CVPixelBufferRef)pixelBuffer consumer:(id<FBDataConsumer>)consumer
+{
+  CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+
+  void *baseAddress = CVPixelBufferGetBaseAddress(pixelBuffer);
+  size_t size = CVPixelBufferGetDataSize(pixelBuffer);
+  NSData *data = [NSData dataWithBytes:baseAddress length:size];
+
+  CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+
+  [consumer consumeData:data];
+}
+
 #pragma mark FBiOSTargetContinuation
 
 - (FBiOSTargetFutureType)futureType
@@ -290,6 +339,7 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
   }
 
   _timeInterval = timeInterval;
+  self.effectiveFramesPerSecond = (double) NSEC_PER_SEC / timeInterval;
 
   return self;
 }
@@ -313,3 +363,106 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 }
 
 @end
+
+@implementation FBSimulatorBitmapStream_Adaptive
+
+- (instancetype)initWithFramebuffer:(FBFramebuffer *)framebuffer writeQueue:(dispatch_queue_t)writeQueue minimumInterval:(NSTimeInterval)minimumInterval latencyBudget:(NSTimeInterval)latencyBudget logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super initWithFramebuffer:framebuffer writeQueue:writeQueue logger:logger];
+  if (!self) {
+    return nil;
+  }
+
+  _minimumInterval = minimumInterval;
+  _latencyBudget = latencyBudget;
+  _interval = minimumInterval;
+  self.effectiveFramesPerSecond = 1 / minimumInterval;
+
+  return self;
+}
+
+#pragma mark FBFramebufferConsumer
+
+- (void)didReceiveDamageRect:(CGRect)rect
+{
+  [self pushFrame];
+}
+
+#pragma mark Private
+
+- (void)pushFrame
+{
+  if (!self.pixelBuffer || !self.consumer) {
+    return;
+  }
+  // The surface always contains the newest frame, so a frame that is already waiting is replaced by this one.
+  // Latency is measured from when the oldest unwritten frame was available.
+  if (self.pendingFrameTime > 0) {
+    self.framesDropped += 1;
+  } else {
+    self.pendingFrameTime = NSProcessInfo.processInfo.systemUptime;
+  }
+  [self writePendingFrameWhenReady];
+}
+
+- (void)writePendingFrameWhenReady
+{
+  if (self.writing || self.writeScheduled || self.pendingFrameTime == 0) {
+    return;
+  }
+  NSTimeInterval delay = self.lastWriteTime + self.interval - NSProcessInfo.processInfo.systemUptime;
+  if (delay <= 0) {
+    [self writePendingFrame];
+    return;
+  }
+  self.writeScheduled = YES;
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (delay * NSEC_PER_SEC)), self.writeQueue, ^{
+    self.writeScheduled = NO;
+    [self writePendingFrameWhenReady];
+  });
+}
+
+- (void)writePendingFrame
+{
+  NSTimeInterval frameTime = self.pendingFrameTime;
+  self.pendingFrameTime = 0;
+  self.writing = YES;
+  self.lastWriteTime = NSProcessInfo.processInfo.systemUptime;
+
+  id<FBDataConsumer> consumer = self.consumer;
+  if (![consumer conformsToProtocol:@protocol(FBDataConsumerBackpressure)]) {
+    [FBSimulatorBitmapStream writeBitmap:self.pixelBuffer consumer:consumer];
+    [self frameAcceptedWithAvailableTime:frameTime];
+    return;
+  }
+  // The consumer writes after this returns, so it needs a copy of the surface.
+  // The next frame is only written once this one has been flushed, rather than drained below a water mark.
+  // This means that the consumer only ever has one frame pending, so frames are never coalesced or dropped by it.
+  [FBSimulatorBitmapStream copyBitmap:self.pixelBuffer consumer:consumer];
+  [[(id<FBDataConsumerBackpressure>) consumer flushed] onQueue:self.writeQueue notifyOfCompletion:^(FBFuture *_) {
+    [self frameAcceptedWithAvailableTime:frameTime];
+  }];
+}
+
+- (void)frameAcceptedWithAvailableTime:(NSTimeInterval)frameTime
+{
+  NSTimeInterval latency = NSProcessInfo.processInfo.systemUptime - frameTime;
+  [self recordWrittenFrameWithLatency:latency];
+
+  // Halve the frame rate when over budget, then recover by one frame per second whilst comfortably within it.
+  NSTimeInterval interval = self.interval;
+  if (latency > self.latencyBudget) {
+    interval = MIN(interval * 2, FBBitmapStreamAdaptiveMaximumInterval);
+  } else if (latency < self.latencyBudget / 2) {
+    interval = MAX(1 / ((1 / interval) + 1), self.minimumInterval);
+  }
+  if (interval != self.interval) {
+    self.interval = interval;
+    self.effectiveFramesPerSecond = 1 / interval;
+  }
+
+  self.writing = NO;
+  [self writePendingFrameWhenReady];
+}
+
+@end
@@ -344,7 +344,9 @@
   dispatch_once(&onceToken, ^{
     statefulCommands = [NSSet setWithArray:@[
       FBSimulatorCrashLogCommands.class,
+      FBSimulatorLaunchCtlCommands.class,
       FBSimulatorLifecycleCommands.class,
+      FBSimulatorLogCommands.class,
       FBSimulatorScreenshotCommands.class,
       FBSimulatorVideoRecordingCommands.class,
     ]];
@@ -22,6 +22,9 @@
 NSString *const FBSimulatorControlSimulatorLaunchEnvironmentSimulatorUDID = @"FBSIMULATORCONTROL_SIM_UDID";
 NSString *const FBSimulatorControlSimulatorLaunchEnvironmentDeviceSetPath = @"FBSIMULATORCONTROL_SIM_SET_PATH";
 
+// Queries over many Simulators, such as inflating a Simulator Set, share a Process Table snapshot of up to this age.
+static NSTimeInterval const ProcessTableMaximumAge = 1.0;
+
 @implementation FBSimulatorProcessFetcher
 
 + (instancetype)fetcherWithProcessFetcher:(FBProcessFetcher *)processFetcher
@@ -43,17 +46,21 @@ NSString *const FBSimulatorControlSimulatorLaunchEnvironmentDeviceSetPath = @"FB
 
 - (NSArray<FBProcessInfo *> *)simulatorApplicationProcesses
 {
-  NSArray<NSRunningApplication *> *runningApplications = [NSRunningApplication runningApplicationsWithBundleIdentifier:@"com.apple.iphonesimulator"];
-  return [self.processFetcher processInfoForRunningApplications:runningApplications];
+  return [self simulatorApplicationProcessesInTable:self.processTable];
 }
 
 - (NSDictionary<NSString *, FBProcessInfo *> *)simulatorApplicationProcessesByUDIDs:(NSArray<NSString *> *)udids unclaimed:(NSArray<FBProcessInfo *> *_Nullable * _Nullable)unclaimedOut
+{
+  return [self simulatorApplicationProcessesByUDIDs:udids inTable:self.processTable unclaimed:unclaimedOut];
+}
+
+- (NSDictionary<NSString *, FBProcessInfo *> *)simulatorApplicationProcessesByUDIDs:(NSArray<NSString *> *)udids inTable:(FBProcessTable *)table unclaimed:(NSArray<FBProcessInfo *> *_Nullable * _Nullable)unclaimedOut
 {
   NSMutableDictionary<NSString *, FBProcessInfo *> *dictionary = [NSMutableDictionary dictionary];
   NSMutableArray<FBProcessInfo *> *unclaimed = [NSMutableArray array];
   NSSet<NSString *> *fetchSet = [NSSet setWithArray:udids];
 
-  for (FBProcessInfo *process in self.simulatorApplicationProcesses) {
+  for (FBProcessInfo *process in [self simulatorApplicationProcessesInTable:table]) {
     NSString *udid = [FBSimulatorProcessFetcher udidForSimulatorApplicationProcess:process];
     if (!udid) {
       [unclaimed addObject:process];
@@ -82,7 +89,9 @@ NSString *const FBSimulatorControlSimulatorLaunchEnvironmentDeviceSetPath = @"FB
 
 - (nullable FBProcessInfo *)simulatorApplicationProcessForSimDevice:(SimDevice *)simDevice
 {
-  return [self simulatorApplicationProcessesByUDIDs:@[simDevice.UDID.UUIDString] unclaimed:nil][simDevice.UDID.UUIDString];
+  // A single Simulator may be polled for, so the snapshot must always be fresh.
+  FBProcessTable *table = [self.processFetcher processTableWithMaximumAge:0];
+  return [self simulatorApplicationProcessesByUDIDs:@[simDevice.UDID.UUIDString] inTable:table unclaimed:nil][simDevice.UDID.UUIDString];
 }
 
 - (nullable FBProcessInfo *)simulatorApplicationProcessForSimDevice:(SimDevice *)simDevice timeout:(NSTimeInterval)timeout
@@ -96,7 +105,7 @@ NSString *const FBSimulatorControlSimulatorLaunchEnvironmentDeviceSetPath = @"FB
 
 - (NSArray<FBProcessInfo *> *)launchdProcesses
 {
-  return [self.processFetcher processesWithProcessName:@"launchd_sim"];
+  return [self.processTable processesWithProcessName:@"launchd_sim"];
 }
 
 - (NSDictionary<NSString *, FBProcessInfo *> *)launchdProcessesByUDIDs:(NSArray<NSString *> *)udids
@@ -104,6 +113,7 @@ NSString *const FBSimulatorControlSimulatorLaunchEnvironmentDeviceSetPath = @"FB
   NSDictionary<NSString *, NSString *> *serviceNameToUDID = [FBSimulatorProcessFetcher launchdSimServiceNamesToUDIDs:udids];
   NSDictionary<NSString *, NSDictionary<NSString *, id> *> *jobs = [FBServiceManagement jobInformationForUserServicesNamed:serviceNameToUDID.allKeys];
 
+  FBProcessTable *table = self.processTable;
   NSMutableDictionary<NSString *, FBProcessInfo *> *processes = [NSMutableDictionary dictionary];
   for (NSString *serviceName in serviceNameToUDID.allKeys) {
     NSString *udid = serviceNameToUDID[serviceName];
@@ -111,7 +121,8 @@ NSString *const FBSimulatorControlSimulatorLaunchEnvironmentDeviceSetPath = @"FB
     if (!job) {
       continue;
     }
-    FBProcessInfo *process = [self.processFetcher processInfoForJobDictionary:job];
+    NSNumber *processIdentifier = job[@"PID"];
+    FBProcessInfo *process = processIdentifier ? [table processInfoFor:processIdentifier.intValue] : nil;
     if (!process) {
       continue;
     }
@@ -191,6 +202,24 @@ NSString *const FBSimulatorControlSimulatorLaunchEnvironmentDeviceSetPath = @"FB
 
 #pragma mark Private
 
+- (FBProcessTable *)processTable
+{
+  return [self.processFetcher processTableWithMaximumAge:ProcessTableMaximumAge];
+}
+
+- (NSArray<FBProcessInfo *> *)simulatorApplicationProcessesInTable:(FBProcessTable *)table
+{
+  NSMutableArray<FBProcessInfo *> *processes = [NSMutableArray array];
+  for (NSRunningApplication *runningApplication in [NSRunningApplication runningApplicationsWithBundleIdentifier:@"com.apple.iphonesimulator"]) {
+    FBProcessInfo *process = [table processInfoFor:runningApplication.processIdentifier];
+    if (!process) {
+      continue;
+    }
+    [processes addObject:process];
+  }
+  return [processes copy];
+}
+
 + (nullable NSString *)udidForLaunchdSim:(FBProcessInfo *)process
 {
   if ([process.launchPath rangeOfString:@"launchd_sim"].location == NSNotFound) {
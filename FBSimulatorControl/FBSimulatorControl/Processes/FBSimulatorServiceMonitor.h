@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A block that fetches the output of 'launchctl list'.
+ */
+typedef FBFuture<NSString *> *_Nonnull (^FBSimulatorServiceListProvider)(void);
+
+/**
+ The maximum age of a snapshot that is used to answer queries without refreshing.
+ */
+extern const NSTimeInterval FBSimulatorServiceMonitorMaximumSnapshotAge;
+
+/**
+ Keeps a snapshot of the launchd services of a Simulator.
+ There is a single refresher for each monitor, so concurrent queries and waiters share the same launchctl invocation.
+ Each new snapshot is diffed against the previous one, and waiters are only re-evaluated when services have started or stopped.
+ */
+@interface FBSimulatorServiceMonitor : NSObject
+
+#pragma mark Initializers
+
+/**
+ Constructs a Service Monitor.
+
+ @param listProvider the block to fetch 'launchctl list' output with.
+ @param logger the logger to log to.
+ @return a new Service Monitor.
+ */
++ (instancetype)monitorWithListProvider:(FBSimulatorServiceListProvider)listProvider logger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Properties
+
+/**
+ The most recent snapshot, a Mapping of Service Name to Process Identifier.
+ NSNull is used to represent services that do not have a Process Identifier.
+ */
+@property (atomic, copy, nullable, readonly) NSDictionary<NSString *, id> *services;
+
+/**
+ The number of times that the services have been fetched.
+ */
+@property (atomic, assign, readonly) NSUInteger refreshCount;
+
+#pragma mark Public Methods
+
+/**
+ Fetches a new snapshot of the services.
+ If a fetch is already in progress, the result of that fetch is used.
+
+ @return A Future, wrapping a Mapping of Service Name to Process identifier.
+ */
+- (FBFuture<NSDictionary<NSString *, id> *> *)refresh;
+
+/**
+ Returns the cached snapshot if it is recent enough, otherwise fetches a new snapshot.
+
+ @param maximumAge the maximum age of the cached snapshot.
+ @return A Future, wrapping a Mapping of Service Name to Process identifier.
+ */
+- (FBFuture<NSDictionary<NSString *, id> *> *)servicesWithMaximumAge:(NSTimeInterval)maximumAge;
+
+/**
+ Resolves when all of the services have a Process Identifier.
+ The services are refreshed periodically whilst there are waiters, every 0.5s and backing off to every 2s whilst they are unchanged.
+
+ @param serviceNames the names of the services to wait for.
+ @return A Future that resolves when the services are running. Cancelling it stops the wait.
+ */
+- (FBFuture<NSNull *> *)waitUntilServicesAreRunning:(NSArray<NSString *> *)serviceNames;
+
+/**
+ Marks the cached snapshot as stale, so that the next query fetches a new snapshot.
+ A refresh that is in flight when the snapshot is invalidated is discarded, and its callers receive the next snapshot instead.
+ Should be called when services have been started or stopped.
+ */
+- (void)invalidate;
+
+#pragma mark Parsing
+
+/**
+ Parses the output of 'launchctl list'.
+
+ @param output the output, including the header line.
+ @param error an error out for any error that occurs.
+ @return a Mapping of Service Name to Process Identifier on success, nil otherwise.
+ */
++ (nullable NSDictionary<NSString *, id> *)servicesFromListOutput:(NSString *)output error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,319 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBSimulatorServiceMonitor.h"
+
+#import "FBSimulatorError.h"
+
+const NSTimeInterval FBSimulatorServiceMonitorMaximumSnapshotAge = 0.5;
+// Polling backs off while the services are unchanged, as each poll runs launchctl.
+static const NSTimeInterval FBSimulatorServiceMonitorMinimumPollInterval = 0.5;
+static const NSTimeInterval FBSimulatorServiceMonitorMaximumPollInterval = 2.0;
+
+@interface FBSimulatorServiceMonitor_Waiter : NSObject
+
+@property (nonatomic, copy, readonly) NSArray<NSString *> *serviceNames;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *future;
+
+@end
+
+@implementation FBSimulatorServiceMonitor_Waiter
+
+- (instancetype)initWithServiceNames:(NSArray<NSString *> *)serviceNames
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _serviceNames = [serviceNames copy];
+  _future = FBMutableFuture.future;
+
+  return self;
+}
+
+- (BOOL)isSatisfiedByServices:(NSDictionary<NSString *, id> *)services
+{
+  for (NSString *serviceName in self.serviceNames) {
+    if (![services[serviceName] isKindOfClass:NSNumber.class]) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+@end
+
+@interface FBSimulatorServiceMonitor ()
+
+@property (nonatomic, copy, readonly) FBSimulatorServiceListProvider listProvider;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) NSMutableArray<FBSimulatorServiceMonitor_Waiter *> *waiters;
+
+@property (atomic, copy, nullable, readwrite) NSDictionary<NSString *, id> *services;
+@property (atomic, assign, readwrite) NSUInteger refreshCount;
+@property (nonatomic, strong, nullable, readwrite) NSDate *snapshotDate;
+@property (nonatomic, assign, readwrite) NSUInteger generation;
+@property (nonatomic, strong, nullable, readwrite) FBFuture<NSDictionary<NSString *, id> *> *inflightRefresh;
+@property (nonatomic, assign, readwrite) BOOL polling;
+@property (nonatomic, assign, readwrite) NSTimeInterval pollInterval;
+
+@end
+
+@implementation FBSimulatorServiceMonitor
+
+#pragma mark Initializers
+
++ (instancetype)monitorWithListProvider:(FBSimulatorServiceListProvider)listProvider logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithListProvider:listProvider logger:logger];
+}
+
+- (instancetype)initWithListProvider:(FBSimulatorServiceListProvider)listProvider logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _listProvider = [listProvider copy];
+  _logger = logger;
+  _queue = dispatch_queue_create("com.facebook.fbsimulatorcontrol.service_monitor", DISPATCH_QUEUE_SERIAL);
+  _waiters = [NSMutableArray array];
+  _pollInterval = FBSimulatorServiceMonitorMinimumPollInterval;
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<NSDictionary<NSString *, id> *> *)refresh
+{
+  return [FBFuture onQueue:self.queue resolve:^{
+    return [self refreshOnQueue];
+  }];
+}
+
+- (FBFuture<NSDictionary<NSString *, id> *> *)servicesWithMaximumAge:(NSTimeInterval)maximumAge
+{
+  return [FBFuture onQueue:self.queue resolve:^ FBFuture<NSDictionary<NSString *, id> *> * {
+    NSDictionary<NSString *, id> *services = self.services;
+    if (services && self.snapshotDate && -[self.snapshotDate timeIntervalSinceNow] <= maximumAge) {
+      return [FBFuture futureWithResult:services];
+    }
+    return [self refreshOnQueue];
+  }];
+}
+
+- (FBFuture<NSNull *> *)waitUntilServicesAreRunning:(NSArray<NSString *> *)serviceNames
+{
+  FBSimulatorServiceMonitor_Waiter *waiter = [[FBSimulatorServiceMonitor_Waiter alloc] initWithServiceNames:serviceNames];
+  dispatch_async(self.queue, ^{
+    [self.waiters addObject:waiter];
+    self.pollInterval = FBSimulatorServiceMonitorMinimumPollInterval;
+    [self startPollingOnQueue];
+  });
+  return [waiter.future onQueue:self.queue respondToCancellation:^{
+    [self.waiters removeObject:waiter];
+    return [FBFuture futureWithResult:NSNull.null];
+  }];
+}
+
+- (void)invalidate
+{
+  dispatch_async(self.queue, ^{
+    self.generation++;
+    self.snapshotDate = nil;
+    self.inflightRefresh = nil;
+  });
+}
+
+#pragma mark Parsing
+
++ (nullable NSDictionary<NSString *, id> *)servicesFromListOutput:(NSString *)output error:(NSError **)error
+{
+  // A single pass over the bytes, the output is large and this is called on every refresh.
+  const char *bytes = output.UTF8String;
+  const char *headerEnd = bytes ? strchr(bytes, '\n') : NULL;
+  if (!headerEnd) {
+    return [[FBSimulatorError
+      describeFormat:@"Insufficient number of lines from output '%@'", output]
+      fail:error];
+  }
+
+  NSMutableDictionary<NSString *, id> *services = [NSMutableDictionary dictionary];
+  const char *line = headerEnd + 1;
+  while (*line != '\0') {
+    const char *lineEnd = strchr(line, '\n');
+    if (!lineEnd) {
+      lineEnd = line + strlen(line);
+    }
+    const char *fields[3];
+    size_t fieldLengths[3];
+    NSUInteger fieldCount = 0;
+    const char *cursor = line;
+    while (cursor < lineEnd) {
+      while (cursor < lineEnd && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) {
+        cursor++;
+      }
+      if (cursor == lineEnd) {
+        break;
+      }
+      const char *fieldStart = cursor;
+      while (cursor < lineEnd && *cursor != ' ' && *cursor != '\t' && *cursor != '\r') {
+        cursor++;
+      }
+      if (fieldCount < 3) {
+        fields[fieldCount] = fieldStart;
+        fieldLengths[fieldCount] = (size_t) (cursor - fieldStart);
+      }
+      fieldCount++;
+    }
+    if (fieldCount == 0) {
+      line = *lineEnd == '\0' ? lineEnd : lineEnd + 1;
+      continue;
+    }
+    if (fieldCount != 3) {
+      return [[FBSimulatorError
+        describeFormat:@"Output does not have exactly three words: %@", [[NSString alloc] initWithBytes:line length:(NSUInteger) (lineEnd - line) encoding:NSUTF8StringEncoding]]
+        fail:error];
+    }
+    NSString *serviceName = [[NSString alloc] initWithBytes:fields[2] length:fieldLengths[2] encoding:NSUTF8StringEncoding];
+    if (fieldLengths[0] == 1 && fields[0][0] == '-') {
+      services[serviceName] = NSNull.null;
+    } else {
+      pid_t processIdentifier = 0;
+      for (size_t index = 0; index < fieldLengths[0]; index++) {
+        char character = fields[0][index];
+        if (character < '0' || character > '9') {
+          processIdentifier = 0;
+          break;
+        }
+        processIdentifier = processIdentifier * 10 + (character - '0');
+      }
+      if (processIdentifier < 1) {
+        return [[FBSimulatorError
+          describeFormat:@"Expected a process identifier as first word, but got %@ for %@", [[NSString alloc] initWithBytes:fields[0] length:fieldLengths[0] encoding:NSUTF8StringEncoding], serviceName]
+          fail:error];
+      }
+      services[serviceName] = @(processIdentifier);
+    }
+    line = *lineEnd == '\0' ? lineEnd : lineEnd + 1;
+  }
+  return [services copy];
+}
+
+#pragma mark Private
+
+- (FBFuture<NSDictionary<NSString *, id> *> *)refreshOnQueue
+{
+  if (self.inflightRefresh) {
+    return self.inflightRefresh;
+  }
+  NSUInteger generation = self.generation;
+  FBFuture<NSDictionary<NSString *, id> *> *refresh = [self.listProvider() onQueue:self.queue fmap:^(NSString *output) {
+    // The snapshot was invalidated whilst this refresh was in flight, so the output may predate the change.
+    if (generation != self.generation) {
+      return [self refreshOnQueue];
+    }
+    NSError *error = nil;
+    NSDictionary<NSString *, id> *services = [FBSimulatorServiceMonitor servicesFromListOutput:output error:&error];
+    if (!services) {
+      return [FBFuture futureWithError:error];
+    }
+    [self updateServices:services];
+    return [FBFuture futureWithResult:services];
+  }];
+  self.inflightRefresh = refresh;
+  [refresh onQueue:self.queue notifyOfCompletion:^(FBFuture *_) {
+    if (self.inflightRefresh == refresh) {
+      self.inflightRefresh = nil;
+    }
+  }];
+  return refresh;
+}
+
+- (void)updateServices:(NSDictionary<NSString *, id> *)services
+{
+  NSDictionary<NSString *, id> *previous = self.services;
+  self.services = services;
+  self.snapshotDate = NSDate.date;
+  self.refreshCount++;
+
+  NSMutableArray<NSString *> *started = [NSMutableArray array];
+  NSMutableArray<NSString *> *stopped = [NSMutableArray array];
+  [services enumerateKeysAndObjectsUsingBlock:^(NSString *serviceName, id processIdentifier, BOOL *_) {
+    id previousProcessIdentifier = previous[serviceName];
+    if ([processIdentifier isKindOfClass:NSNumber.class] && ![processIdentifier isEqual:previousProcessIdentifier]) {
+      [started addObject:serviceName];
+    }
+  }];
+  [previous enumerateKeysAndObjectsUsingBlock:^(NSString *serviceName, id previousProcessIdentifier, BOOL *_) {
+    if ([previousProcessIdentifier isKindOfClass:NSNumber.class] && ![services[serviceName] isKindOfClass:NSNumber.class]) {
+      [stopped addObject:serviceName];
+    }
+  }];
+  if (previous && started.count == 0 && stopped.count == 0) {
+    return;
+  }
+  // Services tend to start in bursts, so poll quickly again after a change.
+  self.pollInterval = FBSimulatorServiceMonitorMinimumPollInterval;
+  if (previous) {
+    [self.logger.debug logFormat:@"Services started %@, stopped %@", [FBCollectionInformation oneLineDescriptionFromArray:started], [FBCollectionInformation oneLineDescriptionFromArray:stopped]];
+  }
+  [self resolveWaitersWithServices:services];
+}
+
+- (void)resolveWaitersWithServices:(NSDictionary<NSString *, id> *)services
+{
+  for (FBSimulatorServiceMonitor_Waiter *waiter in [self.waiters copy]) {
+    if (waiter.future.state != FBFutureStateRunning) {
+      [self.waiters removeObject:waiter];
+      continue;
+    }
+    if ([waiter isSatisfiedByServices:services]) {
+      [self.waiters removeObject:waiter];
+      [waiter.future resolveWithResult:NSNull.null];
+    }
+  }
+}
+
+- (void)startPollingOnQueue
+{
+  if (self.polling) {
+    return;
+  }
+  self.polling = YES;
+  [self pollOnQueue];
+}
+
+- (void)pollOnQueue
+{
+  // Waiters may have been satisfied by a recent snapshot that was fetched for another query.
+  if (self.services && self.snapshotDate && -[self.snapshotDate timeIntervalSinceNow] <= FBSimulatorServiceMonitorMaximumSnapshotAge) {
+    [self resolveWaitersWithServices:self.services];
+  }
+  if (self.waiters.count == 0) {
+    self.polling = NO;
+    return;
+  }
+  [[self refreshOnQueue] onQueue:self.queue notifyOfCompletion:^(FBFuture *future) {
+    if (future.error) {
+      [self.logger.debug logFormat:@"Failed to fetch services %@", future.error];
+    }
+    NSTimeInterval interval = self.pollInterval;
+    self.pollInterval = MIN(interval * 2, FBSimulatorServiceMonitorMaximumPollInterval);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (interval * NSEC_PER_SEC)), self.queue, ^{
+      [self pollOnQueue];
+    });
+  }];
+}
+
+@end
@@ -27,6 +27,7 @@
 #import "FBSimulatorSubprocessTerminationStrategy.h"
 #import "FBProcessLaunchConfiguration+Simulator.h"
 #import "FBSimulatorLaunchCtlCommands.h"
+#import "FBSimulatorServiceMonitor.h"
 
 @interface FBApplicationLaunchStrategy ()
 
@@ -72,6 +73,8 @@
     installedApplicationWithBundleID:appLaunch.bundleID]
     rephraseFailure:@"App %@ can't be launched as it isn't installed", appLaunch.bundleID]
     onQueue:simulator.workQueue fmap:^(id _) {
+      // Whether to fail or relaunch depends upon the application running now, not in a recent snapshot.
+      [simulator.serviceMonitor invalidate];
       return [self.simulator runningApplicationWithBundleID:appLaunch.bundleID];
     }]
     onQueue:simulator.workQueue chain:^FBFuture<NSNull *> *(FBFuture<FBProcessInfo *> *processFuture) {
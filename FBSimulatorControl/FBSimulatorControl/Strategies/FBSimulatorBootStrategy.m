@@ -625,11 +625,15 @@
     return [FBFuture futureWithResult:launchdProcess];
   }
 
-  // Now wait for the services.
-  return [[[FBSimulatorBootVerificationStrategy
-    strategyWithSimulator:self.simulator]
+  // Now wait for the services, then report how long each phase of the boot took.
+  FBSimulator *simulator = self.simulator;
+  FBSimulatorBootVerificationStrategy *verificationStrategy = [FBSimulatorBootVerificationStrategy strategyWithSimulator:simulator];
+  return [[verificationStrategy
     verifySimulatorIsBooted]
-    mapReplace:launchdProcess];
+    onQueue:simulator.workQueue map:^(id _) {
+      [simulator.eventSink simulatorDidBoot:verificationStrategy.timeline];
+      return launchdProcess;
+    }];
 }
 
 @end
@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Boot Phase Enumeration.
+ */
+typedef NSString *FBSimulatorBootPhase NS_STRING_ENUM;
+
+/**
+ launchd_sim is bringing up the System Daemons.
+ */
+extern FBSimulatorBootPhase const FBSimulatorBootPhaseLaunchd;
+
+/**
+ Waiting on backboardd to start.
+ */
+extern FBSimulatorBootPhase const FBSimulatorBootPhaseBackboard;
+
+/**
+ Waiting on datamigrator, typically on the first boot after creation or erase.
+ */
+extern FBSimulatorBootPhase const FBSimulatorBootPhaseDataMigration;
+
+/**
+ Waiting on the System Application (SpringBoard) to start.
+ */
+extern FBSimulatorBootPhase const FBSimulatorBootPhaseSystemApp;
+
+/**
+ The Timing of a single Boot Phase.
+ Times are relative to the start of the boot.
+ */
+@interface FBSimulatorBootPhaseTiming : NSObject <NSCopying, FBJSONSerializable>
+
+/**
+ The Phase.
+ */
+@property (nonatomic, copy, readonly) FBSimulatorBootPhase phase;
+
+/**
+ The time at which the Phase was first observed.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval startTime;
+
+/**
+ The duration of the Phase, or NAN if the Phase has not finished.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval duration;
+
+@end
+
+/**
+ Records the Phases that a Simulator passes through whilst booting.
+ */
+@interface FBSimulatorBootTimeline : NSObject <FBJSONSerializable>
+
+#pragma mark Initializers
+
+/**
+ Constructs an empty timeline.
+
+ @return a new Boot Timeline.
+ */
++ (instancetype)timeline;
+
+#pragma mark Recording
+
+/**
+ Records an observation of a Phase.
+ A Phase that is the same as the current Phase is ignored, otherwise the current Phase is finished and the new one is started.
+
+ @param phase the observed phase.
+ @param elapsedTime the time since the start of the boot.
+ */
+- (void)recordPhase:(FBSimulatorBootPhase)phase elapsedTime:(NSTimeInterval)elapsedTime;
+
+/**
+ Finishes the current Phase and the timeline.
+ Subsequent observations are ignored.
+
+ @param elapsedTime the time since the start of the boot.
+ */
+- (void)completeWithElapsedTime:(NSTimeInterval)elapsedTime;
+
+#pragma mark Properties
+
+/**
+ The Phases in the order that they were observed.
+ */
+@property (nonatomic, copy, readonly) NSArray<FBSimulatorBootPhaseTiming *> *phases;
+
+/**
+ The total time taken to boot, or NAN if the boot has not completed.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval totalDuration;
+
+/**
+ Whether the timeline has been completed.
+ */
+@property (nonatomic, assign, readonly) BOOL completed;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,208 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBSimulatorBootTimeline.h"
+
+FBSimulatorBootPhase const FBSimulatorBootPhaseLaunchd = @"launchd";
+FBSimulatorBootPhase const FBSimulatorBootPhaseBackboard = @"backboard";
+FBSimulatorBootPhase const FBSimulatorBootPhaseDataMigration = @"data_migration";
+FBSimulatorBootPhase const FBSimulatorBootPhaseSystemApp = @"system_app";
+
+static NSString *const KeyPhase = @"phase";
+static NSString *const KeyStart = @"start";
+static NSString *const KeyDuration = @"duration";
+static NSString *const KeyPhases = @"phases";
+static NSString *const KeyTotal = @"total";
+static NSString *const KeyCompleted = @"completed";
+
+static id JSONTimeInterval(NSTimeInterval interval)
+{
+  return isnan(interval) ? NSNull.null : @(interval);
+}
+
+@implementation FBSimulatorBootPhaseTiming
+
+- (instancetype)initWithPhase:(FBSimulatorBootPhase)phase startTime:(NSTimeInterval)startTime duration:(NSTimeInterval)duration
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _phase = phase;
+  _startTime = startTime;
+  _duration = duration;
+
+  return self;
+}
+
+#pragma mark NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+  return self;
+}
+
+#pragma mark NSObject
+
+- (BOOL)isEqual:(FBSimulatorBootPhaseTiming *)object
+{
+  if (![object isKindOfClass:self.class]) {
+    return NO;
+  }
+  return [self.phase isEqualToString:object.phase]
+      && self.startTime == object.startTime
+      && (self.duration == object.duration || (isnan(self.duration) && isnan(object.duration)));
+}
+
+- (NSUInteger)hash
+{
+  return self.phase.hash ^ (NSUInteger) (self.startTime * 1000);
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"%@ | Start %f | Duration %f", self.phase, self.startTime, self.duration];
+}
+
+#pragma mark FBJSONSerializable
+
+- (id)jsonSerializableRepresentation
+{
+  return @{
+    KeyPhase: self.phase,
+    KeyStart: @(self.startTime),
+    KeyDuration: JSONTimeInterval(self.duration),
+  };
+}
+
+@end
+
+@interface FBSimulatorBootTimeline ()
+
+@property (nonatomic, strong, readonly) NSMutableArray<FBSimulatorBootPhaseTiming *> *finishedPhases;
+@property (nonatomic, copy, nullable, readwrite) FBSimulatorBootPhase currentPhase;
+@property (nonatomic, assign, readwrite) NSTimeInterval currentPhaseStart;
+@property (nonatomic, assign, readwrite) NSTimeInterval lastElapsedTime;
+@property (nonatomic, assign, readwrite) NSTimeInterval totalDuration;
+
+@end
+
+@implementation FBSimulatorBootTimeline
+
+#pragma mark Initializers
+
++ (instancetype)timeline
+{
+  return [[self alloc] init];
+}
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _finishedPhases = [NSMutableArray array];
+  _totalDuration = NAN;
+
+  return self;
+}
+
+#pragma mark Recording
+
+- (void)recordPhase:(FBSimulatorBootPhase)phase elapsedTime:(NSTimeInterval)elapsedTime
+{
+  @synchronized (self) {
+    if (self.completed || [phase isEqualToString:self.currentPhase]) {
+      return;
+    }
+    elapsedTime = [self clampElapsedTime:elapsedTime];
+    [self finishCurrentPhaseAtElapsedTime:elapsedTime];
+    self.currentPhase = phase;
+    self.currentPhaseStart = elapsedTime;
+  }
+}
+
+- (void)completeWithElapsedTime:(NSTimeInterval)elapsedTime
+{
+  @synchronized (self) {
+    if (self.completed) {
+      return;
+    }
+    elapsedTime = [self clampElapsedTime:elapsedTime];
+    [self finishCurrentPhaseAtElapsedTime:elapsedTime];
+    self.totalDuration = elapsedTime;
+  }
+}
+
+#pragma mark Properties
+
+- (NSArray<FBSimulatorBootPhaseTiming *> *)phases
+{
+  @synchronized (self) {
+    if (!self.currentPhase) {
+      return [self.finishedPhases copy];
+    }
+    FBSimulatorBootPhaseTiming *current = [[FBSimulatorBootPhaseTiming alloc] initWithPhase:self.currentPhase startTime:self.currentPhaseStart duration:NAN];
+    return [self.finishedPhases arrayByAddingObject:current];
+  }
+}
+
+- (BOOL)completed
+{
+  @synchronized (self) {
+    return !isnan(self.totalDuration);
+  }
+}
+
+#pragma mark FBJSONSerializable
+
+- (id)jsonSerializableRepresentation
+{
+  NSMutableArray<id> *phases = [NSMutableArray array];
+  for (FBSimulatorBootPhaseTiming *timing in self.phases) {
+    [phases addObject:timing.jsonSerializableRepresentation];
+  }
+  return @{
+    KeyPhases: [phases copy],
+    KeyTotal: JSONTimeInterval(self.totalDuration),
+    KeyCompleted: @(self.completed),
+  };
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return [FBCollectionInformation oneLineDescriptionFromArray:self.phases];
+}
+
+#pragma mark Private
+
+- (NSTimeInterval)clampElapsedTime:(NSTimeInterval)elapsedTime
+{
+  // Elapsed times come from separate samples of the boot status, so never let a phase have a negative duration.
+  elapsedTime = MAX(elapsedTime, self.lastElapsedTime);
+  self.lastElapsedTime = elapsedTime;
+  return elapsedTime;
+}
+
+- (void)finishCurrentPhaseAtElapsedTime:(NSTimeInterval)elapsedTime
+{
+  if (!self.currentPhase) {
+    return;
+  }
+  FBSimulatorBootPhaseTiming *timing = [[FBSimulatorBootPhaseTiming alloc] initWithPhase:self.currentPhase startTime:self.currentPhaseStart duration:elapsedTime - self.currentPhaseStart];
+  [self.finishedPhases addObject:timing];
+  self.currentPhase = nil;
+}
+
+@end
@@ -14,6 +14,7 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class FBSimulator;
+@class FBSimulatorBootTimeline;
 
 /**
  A Strategy for determining that a Simulator is actually usable after it is booted.
@@ -44,6 +45,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (FBFuture<NSNull *> *)verifySimulatorIsBooted;
 
+#pragma mark Properties
+
+/**
+ The Phases that the Simulator passed through during verification.
+ This is only populated when CoreSimulator reports the Boot Status of the Simulator.
+ When booting, the Boot Strategy reports the timeline to the Simulator's Event Sink once verification succeeds.
+ */
+@property (nonatomic, strong, readonly) FBSimulatorBootTimeline *timeline;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -14,8 +14,11 @@
 
 #import <FBControlCore/FBControlCore.h>
 
+#import "FBCoreSimulatorNotifier.h"
 #import "FBSimulator.h"
+#import "FBSimulatorBootTimeline.h"
 #import "FBSimulatorError.h"
+#import "FBSimulatorServiceMonitor.h"
 
 @interface FBSimulatorBootVerificationStrategy ()
 
@@ -62,14 +65,15 @@
   }
 
   _simulator = simulator;
+  _timeline = FBSimulatorBootTimeline.timeline;
 
   return self;
 }
 
 #pragma mark Public
 
-static NSTimeInterval BootVerificationWaitInterval = 0.5; // 500ms
-static NSTimeInterval BootVerificationStallInterval = 1.5; // 60s
+static NSTimeInterval BootVerificationStallInterval = 1.5; // 1.5s
+static NSTimeInterval BootVerificationFallbackInterval = 2.0; // 2s
 
 - (FBFuture<NSNull *> *)verifySimulatorIsBooted
 {
@@ -78,43 +82,70 @@ static NSTimeInterval BootVerificationStallInterval = 1.5; // 60s
   return [[simulator
     resolveState:FBiOSTargetStateBooted]
     onQueue:simulator.workQueue fmap:^FBFuture *(NSNull *_) {
-      return [FBFuture onQueue:simulator.workQueue resolveUntil:^{
-        return [[self performBootVerification] delay:BootVerificationWaitInterval];
-      }];
+      return [self waitForBootVerification];
     }];
 }
 
 #pragma mark Private
 
-- (FBFuture<NSNull *> *)performBootVerification
- {
-   NSAssert(NO, @"-[%@ %@] is abstract and should be overridden", NSStringFromClass(self.class), NSStringFromSelector(_cmd));
-   return nil;
- }
+- (FBFuture<NSNull *> *)waitForBootVerification
+{
+  NSAssert(NO, @"-[%@ %@] is abstract and should be overridden", NSStringFromClass(self.class), NSStringFromSelector(_cmd));
+  return nil;
+}
 
 @end
 
 @implementation FBSimulatorBootVerificationStrategy_SimDeviceBootInfo
 
-- (FBFuture<NSNull *> *)performBootVerification
+- (FBFuture<NSNull *> *)waitForBootVerification
+{
+  // SimDevice broadcasts a notification whenever the Boot Status changes, so the Boot Status is checked on each notification.
+  // The timer is a fallback in the event that a notification is missed, and also allows for stalls to be logged.
+  dispatch_queue_t queue = self.simulator.workQueue;
+  FBMutableFuture<NSNull *> *future = FBMutableFuture.future;
+  FBCoreSimulatorNotifier *notifier = [FBCoreSimulatorNotifier notifierForSimDevice:self.simulator.device queue:queue block:^(NSDictionary *info) {
+    [self checkBootInfo:future];
+  }];
+  FBDispatchSourceNotifier *timer = [FBDispatchSourceNotifier timerNotifierNotifierWithTimeInterval:(uint64_t) (BootVerificationFallbackInterval * NSEC_PER_SEC) queue:queue handler:^(FBDispatchSourceNotifier *_) {
+    [self checkBootInfo:future];
+  }];
+  // The Simulator may have finished booting before the notifier was registered.
+  dispatch_async(queue, ^{
+    [self checkBootInfo:future];
+  });
+  return [future onQueue:queue notifyOfCompletion:^(FBFuture *_) {
+    [notifier terminate];
+    [timer terminate];
+  }];
+}
+
+- (void)checkBootInfo:(FBMutableFuture<NSNull *> *)future
 {
+  if (future.hasCompleted) {
+    return;
+  }
+  // CoreSimulator may not have a Boot Status yet, so keep waiting for one.
   SimDeviceBootInfo *bootInfo = self.simulator.device.bootStatus;
   if (!bootInfo) {
-    return [[FBSimulatorError
-      describeFormat:@"No bootInfo for %@", self.simulator]
-      failFuture];
+    return;
   }
   [self updateBootInfo:bootInfo];
   if (bootInfo.status != SimDeviceBootInfoStatusBooted) {
-    return [[FBSimulatorError
-      describeFormat:@"Not booted, status is %@", bootInfo]
-      failFuture];
+    return;
   }
-  return [FBFuture futureWithResult:NSNull.null];
+  [future resolveWithResult:NSNull.null];
 }
 
 - (void)updateBootInfo:(SimDeviceBootInfo *)bootInfo
 {
+  FBSimulatorBootPhase phase = [FBSimulatorBootVerificationStrategy_SimDeviceBootInfo bootPhase:bootInfo.status];
+  if (phase) {
+    [self.timeline recordPhase:phase elapsedTime:bootInfo.bootElapsedTime];
+  } else if (bootInfo.status == SimDeviceBootInfoStatusBooted) {
+    [self.timeline completeWithElapsedTime:bootInfo.bootElapsedTime];
+  }
+
   // The isEqual Method implementation does *not* take into account -[SimDeviceBootInfo bootElapsedTime].
   // We can check that the differences between the last info and the current one are greater some 'stall threshold.
   // This can be indicative that something has gone wrong in the boot process.
@@ -173,6 +204,22 @@ static NSTimeInterval BootVerificationStallInterval = 1.5; // 60s
   }
 }
 
++ (nullable FBSimulatorBootPhase)bootPhase:(SimDeviceBootInfoStatus)status
+{
+  switch (status) {
+    case SimDeviceBootInfoStatusBooting:
+      return FBSimulatorBootPhaseLaunchd;
+    case SimDeviceBootInfoStatusWaitingOnBackboard:
+      return FBSimulatorBootPhaseBackboard;
+    case SimDeviceBootInfoStatusWaitingOnDataMigration:
+      return FBSimulatorBootPhaseDataMigration;
+    case SimDeviceBootInfoStatusWaitingOnSystemApp:
+      return FBSimulatorBootPhaseSystemApp;
+    default:
+      return nil;
+  }
+}
+
 + (NSString *)dataMigrationString:(SimDeviceBootInfo *)bootInfo
 {
   if (bootInfo.status != SimDeviceBootInfoStatusWaitingOnDataMigration) {
@@ -201,21 +248,10 @@ static NSTimeInterval BootVerificationStallInterval = 1.5; // 60s
   return self;
 }
 
-- (FBFuture<NSNull *> *)performBootVerification
+- (FBFuture<NSNull *> *)waitForBootVerification
 {
-  return [[self.simulator
-    listServices]
-    onQueue:self.simulator.asyncQueue fmap:^(NSDictionary<NSString *, id> *services) {
-      NSDictionary<id, NSString *> *processIdentifiers = [NSDictionary
-        dictionaryWithObjects:self.requiredServiceNames
-        forKeys:[services objectsForKeys:self.requiredServiceNames notFoundMarker:NSNull.null]];
-      if (processIdentifiers[NSNull.null]) {
-        return [[FBSimulatorError
-          describeFormat:@"Service %@ has not started", processIdentifiers[NSNull.null]]
-          failFuture];
-      }
-      return [FBFuture futureWithResult:NSNull.null];
-    }];
+  // The Service Monitor has a single refresher for all waiters, so there is no need to poll launchctl here.
+  return [self.simulator.serviceMonitor waitUntilServicesAreRunning:self.requiredServiceNames];
 }
 
 /*
@@ -62,7 +62,8 @@
   }
 
   // Get the Service Name and then stop using the Service Name.
-  return [[[self.simulator
+  // Stopping the Service does not wait for the process to exit, so wait on the exit from the kernel.
+  return [[[[self.simulator
     serviceNameForProcess:process]
     rephraseFailure:@"Could not Obtain the Service Name for %@", process.shortDescription]
     onQueue:self.simulator.workQueue fmap:^FBFuture *(NSString *serviceName) {
@@ -76,6 +77,12 @@
           stopServiceWithName:serviceName]
           rephraseFailure:@"Failed to stop service '%@'", serviceName];
       }
+    }]
+    onQueue:self.simulator.workQueue fmap:^FBFuture *(id _) {
+      // Wait on the Process Info rather than the Process Identifier, so that a re-used pid is not mistaken for the process.
+      return [[self.simulator.processFetcher.processFetcher
+        onQueue:self.simulator.workQueue waitForProcessToDie:process]
+        timeout:FBControlCoreGlobalConfiguration.regularTimeout waitingFor:@"%@ to exit", process.shortDescription];
     }];
 }
 
@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBSimulator;
+
+/**
+ Grants access to privacy-protected services by writing to the TCC Database of Simulators.
+ The database is written in-process, with all approvals for a database in a single transaction.
+ Each database is written concurrently, so the same approvals can be applied to many Simulators at once.
+ */
+@interface FBTCCDatabaseModificationStrategy : NSObject
+
+#pragma mark Initializers
+
+/**
+ A Strategy for the TCC Databases of Simulators.
+
+ @param simulators the Simulators to modify.
+ @return a new strategy.
+ */
++ (instancetype)strategyWithSimulators:(NSArray<FBSimulator *> *)simulators;
+
+/**
+ A Strategy for TCC Databases at the provided paths.
+
+ @param databasePaths the paths of the TCC Databases.
+ @param logger the logger to log to.
+ @return a new strategy.
+ */
++ (instancetype)strategyWithDatabasePaths:(NSArray<NSString *> *)databasePaths logger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Properties
+
+/**
+ The services that can be approved in the TCC Database.
+ */
+@property (nonatomic, copy, readonly, class) NSSet<FBSettingsApprovalService> *supportedServices;
+
+#pragma mark Public Methods
+
+/**
+ Grants the applications access to the services, in every database.
+ Services that are not in supportedServices are ignored.
+
+ @param bundleIDs the bundle ids of the applications.
+ @param services the services to grant access to.
+ @return a Future that resolves when all databases have been written.
+ */
+- (FBFuture<NSNull *> *)grantAccess:(NSSet<NSString *> *)bundleIDs toServices:(NSSet<FBSettingsApprovalService> *)services;
+
+@end
+
+NS_ASSUME_NONNULL_END
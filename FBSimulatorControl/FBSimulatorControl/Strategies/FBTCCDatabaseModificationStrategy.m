@@ -0,0 +1,213 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBTCCDatabaseModificationStrategy.h"
+
+#import <sqlite3.h>
+
+#import "FBSimulator.h"
+#import "FBSimulatorError.h"
+
+// The access table has 7 columns before iOS 12, 12 columns with a last_modified column from iOS 12.
+static const char *FBTCCInsertPreiOS12 = "INSERT OR REPLACE INTO access VALUES (?1, ?2, 0, 1, 0, 0, 0)";
+static const char *FBTCCInsertPostiOS12 = "INSERT OR REPLACE INTO access VALUES (?1, ?2, 0, 1, 1, NULL, NULL, NULL, 'UNUSED', NULL, NULL, ?3)";
+static const int FBTCCBusyTimeoutMilliseconds = 10000;
+
+@interface FBTCCDatabaseModificationStrategy ()
+
+@property (nonatomic, copy, readonly) NSArray<NSString *> *databasePaths;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+
+@end
+
+@implementation FBTCCDatabaseModificationStrategy
+
+#pragma mark Initializers
+
++ (instancetype)strategyWithSimulators:(NSArray<FBSimulator *> *)simulators
+{
+  NSMutableArray<NSString *> *databasePaths = [NSMutableArray array];
+  for (FBSimulator *simulator in simulators) {
+    [databasePaths addObject:[simulator.dataDirectory stringByAppendingPathComponent:@"Library/TCC/TCC.db"]];
+  }
+  id<FBControlCoreLogger> logger = [simulators.firstObject.logger withName:@"tcc"];
+  return [self strategyWithDatabasePaths:databasePaths logger:logger];
+}
+
++ (instancetype)strategyWithDatabasePaths:(NSArray<NSString *> *)databasePaths logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithDatabasePaths:databasePaths logger:logger];
+}
+
+- (instancetype)initWithDatabasePaths:(NSArray<NSString *> *)databasePaths logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _databasePaths = [databasePaths copy];
+  _logger = logger;
+
+  return self;
+}
+
+#pragma mark Properties
+
++ (NSDictionary<FBSettingsApprovalService, NSString *> *)serviceNames
+{
+  static dispatch_once_t onceToken;
+  static NSDictionary<FBSettingsApprovalService, NSString *> *mapping;
+  dispatch_once(&onceToken, ^{
+    mapping = @{
+      FBSettingsApprovalServiceContacts: @"kTCCServiceAddressBook",
+      FBSettingsApprovalServicePhotos: @"kTCCServicePhotos",
+      FBSettingsApprovalServiceCamera: @"kTCCServiceCamera",
+      FBSettingsApprovalServiceMicrophone: @"kTCCServiceMicrophone",
+    };
+  });
+  return mapping;
+}
+
++ (NSSet<FBSettingsApprovalService> *)supportedServices
+{
+  return [NSSet setWithArray:self.serviceNames.allKeys];
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<NSNull *> *)grantAccess:(NSSet<NSString *> *)bundleIDs toServices:(NSSet<FBSettingsApprovalService> *)services
+{
+  NSMutableArray<NSString *> *serviceNames = [NSMutableArray array];
+  for (FBSettingsApprovalService service in services) {
+    NSString *serviceName = FBTCCDatabaseModificationStrategy.serviceNames[service];
+    if (serviceName) {
+      [serviceNames addObject:serviceName];
+    }
+  }
+  NSArray<NSString *> *clients = bundleIDs.allObjects;
+  if (serviceNames.count == 0 || clients.count == 0) {
+    return [FBFuture futureWithResult:NSNull.null];
+  }
+
+  // Each database is written on a concurrent queue, so that many Simulators are written in parallel.
+  dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+  id<FBControlCoreLogger> logger = self.logger;
+  NSMutableArray<FBFuture<NSNull *> *> *futures = [NSMutableArray array];
+  for (NSString *databasePath in self.databasePaths) {
+    [futures addObject:[FBFuture onQueue:queue resolve:^{
+      NSError *error = nil;
+      if (![FBTCCDatabaseModificationStrategy insertClients:clients services:serviceNames intoDatabaseAtPath:databasePath error:&error]) {
+        [logger logFormat:@"Failed to modify %@: %@", databasePath, error];
+        return [FBFuture futureWithError:error];
+      }
+      [logger logFormat:@"Granted %@ access to %@ in %@", [FBCollectionInformation oneLineDescriptionFromArray:clients], [FBCollectionInformation oneLineDescriptionFromArray:serviceNames], databasePath];
+      return [FBFuture futureWithResult:NSNull.null];
+    }]];
+  }
+  return [[FBFuture futureWithFutures:futures] mapReplace:NSNull.null];
+}
+
+#pragma mark Private
+
++ (BOOL)insertClients:(NSArray<NSString *> *)clients services:(NSArray<NSString *> *)services intoDatabaseAtPath:(NSString *)databasePath error:(NSError **)error
+{
+  sqlite3 *database = NULL;
+  if (sqlite3_open_v2(databasePath.fileSystemRepresentation, &database, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK) {
+    NSString *message = database ? @(sqlite3_errmsg(database)) : @"Out of memory";
+    sqlite3_close(database);
+    return [[FBSimulatorError
+      describeFormat:@"Failed to open TCC Database at %@: %@", databasePath, message]
+      failBool:error];
+  }
+  // Simulator daemons may be reading the database, so wait for their locks rather than failing.
+  sqlite3_busy_timeout(database, FBTCCBusyTimeoutMilliseconds);
+
+  BOOL success = [self insertClients:clients services:services intoDatabase:database path:databasePath error:error];
+  sqlite3_close(database);
+  return success;
+}
+
++ (BOOL)insertClients:(NSArray<NSString *> *)clients services:(NSArray<NSString *> *)services intoDatabase:(sqlite3 *)database path:(NSString *)databasePath error:(NSError **)error
+{
+  NSNumber *hasLastModified = [self accessTableHasLastModifiedColumn:database path:databasePath error:error];
+  if (!hasLastModified) {
+    return NO;
+  }
+  if (sqlite3_exec(database, "BEGIN IMMEDIATE", NULL, NULL, NULL) != SQLITE_OK) {
+    return [self failWithDatabase:database path:databasePath action:@"begin a transaction" error:error];
+  }
+
+  sqlite3_stmt *statement = NULL;
+  const char *sql = hasLastModified.boolValue ? FBTCCInsertPostiOS12 : FBTCCInsertPreiOS12;
+  if (sqlite3_prepare_v2(database, sql, -1, &statement, NULL) != SQLITE_OK) {
+    [self failWithDatabase:database path:databasePath action:@"prepare the insert" error:error];
+    sqlite3_exec(database, "ROLLBACK", NULL, NULL, NULL);
+    return NO;
+  }
+  sqlite3_int64 timestamp = (sqlite3_int64) NSDate.date.timeIntervalSince1970;
+  for (NSString *client in clients) {
+    for (NSString *service in services) {
+      sqlite3_bind_text(statement, 1, service.UTF8String, -1, SQLITE_TRANSIENT);
+      sqlite3_bind_text(statement, 2, client.UTF8String, -1, SQLITE_TRANSIENT);
+      if (hasLastModified.boolValue) {
+        sqlite3_bind_int64(statement, 3, timestamp);
+      }
+      if (sqlite3_step(statement) != SQLITE_DONE) {
+        [self failWithDatabase:database path:databasePath action:[NSString stringWithFormat:@"grant %@ to %@", service, client] error:error];
+        sqlite3_finalize(statement);
+        sqlite3_exec(database, "ROLLBACK", NULL, NULL, NULL);
+        return NO;
+      }
+      sqlite3_reset(statement);
+    }
+  }
+  sqlite3_finalize(statement);
+
+  if (sqlite3_exec(database, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+    [self failWithDatabase:database path:databasePath action:@"commit the transaction" error:error];
+    sqlite3_exec(database, "ROLLBACK", NULL, NULL, NULL);
+    return NO;
+  }
+  return YES;
+}
+
++ (nullable NSNumber *)accessTableHasLastModifiedColumn:(sqlite3 *)database path:(NSString *)databasePath error:(NSError **)error
+{
+  sqlite3_stmt *statement = NULL;
+  if (sqlite3_prepare_v2(database, "PRAGMA table_info(access)", -1, &statement, NULL) != SQLITE_OK) {
+    [self failWithDatabase:database path:databasePath action:@"read the schema" error:error];
+    return nil;
+  }
+  NSUInteger columnCount = 0;
+  BOOL hasLastModified = NO;
+  while (sqlite3_step(statement) == SQLITE_ROW) {
+    columnCount++;
+    const unsigned char *name = sqlite3_column_text(statement, 1);
+    if (name && strcmp((const char *) name, "last_modified") == 0) {
+      hasLastModified = YES;
+    }
+  }
+  sqlite3_finalize(statement);
+  if (columnCount == 0) {
+    return [[FBSimulatorError
+      describeFormat:@"TCC Database at %@ does not have an access table", databasePath]
+      fail:error];
+  }
+  return @(hasLastModified);
+}
+
++ (BOOL)failWithDatabase:(sqlite3 *)database path:(NSString *)databasePath action:(NSString *)action error:(NSError **)error
+{
+  return [[FBSimulatorError
+    describeFormat:@"Failed to %@ in TCC Database at %@: %s", action, databasePath, sqlite3_errmsg(database)]
+    failBool:error];
+}
+
+@end
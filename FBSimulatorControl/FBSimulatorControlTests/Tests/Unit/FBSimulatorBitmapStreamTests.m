@@ -0,0 +1,242 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <CoreVideo/CoreVideo.h>
+#import <IOSurface/IOSurface.h>
+
+#import <FBControlCore/FBControlCore.h>
+#import <FBSimulatorControl/FBSimulatorControl.h>
+
+/**
+ A Framebuffer with a fixed surface, whose damage is reported by the test.
+ */
+@interface FBSimulatorBitmapStreamTests_Framebuffer : FBFramebuffer
+
+@property (nonatomic, assign, readonly) IOSurfaceRef surface;
+@property (nonatomic, weak, readwrite) id<FBFramebufferConsumer> consumer;
+@property (nonatomic, strong, readwrite) dispatch_queue_t queue;
+
+@end
+
+@implementation FBSimulatorBitmapStreamTests_Framebuffer
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  NSDictionary<NSString *, id> *properties = @{
+    (NSString *) kIOSurfaceWidth: @4,
+    (NSString *) kIOSurfaceHeight: @4,
+    (NSString *) kIOSurfaceBytesPerElement: @4,
+    (NSString *) kIOSurfacePixelFormat: @(kCVPixelFormatType_32BGRA),
+  };
+  _surface = IOSurfaceCreate((__bridge CFDictionaryRef) properties);
+
+  return self;
+}
+
+- (void)dealloc
+{
+  CFRelease(_surface);
+}
+
+- (nullable IOSurfaceRef)attachConsumer:(id<FBFramebufferConsumer>)consumer onQueue:(dispatch_queue_t)queue
+{
+  self.consumer = consumer;
+  self.queue = queue;
+  return self.surface;
+}
+
+- (void)detachConsumer:(id<FBFramebufferConsumer>)consumer
+{
+  self.consumer = nil;
+}
+
+- (NSArray<id<FBFramebufferConsumer>> *)attachedConsumers
+{
+  id<FBFramebufferConsumer> consumer = self.consumer;
+  return consumer ? @[consumer] : @[];
+}
+
+- (BOOL)isConsumerAttached:(id<FBFramebufferConsumer>)consumer
+{
+  return self.consumer == consumer;
+}
+
+- (void)damage
+{
+  dispatch_sync(self.queue, ^{
+    [self.consumer didReceiveDamageRect:CGRectZero];
+  });
+}
+
+@end
+
+/**
+ A Consumer that holds on to every frame until the test finishes writing it.
+ Drained is always resolved, as a single frame is below the high water mark.
+ */
+@interface FBSimulatorBitmapStreamTests_Consumer : NSObject <FBDataConsumer, FBDataConsumerBackpressure>
+
+@property (nonatomic, strong, readonly) NSMutableArray<NSData *> *frames;
+@property (nonatomic, strong, nullable, readwrite) FBMutableFuture<NSNull *> *flushedMutable;
+
+@end
+
+@implementation FBSimulatorBitmapStreamTests_Consumer
+
+@synthesize pendingBytes = _pendingBytes;
+@synthesize droppedBytes = _droppedBytes;
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _frames = [NSMutableArray array];
+
+  return self;
+}
+
+- (void)consumeData:(NSData *)data
+{
+  @synchronized (self) {
+    [self.frames addObject:data];
+    _pendingBytes += data.length;
+    self.flushedMutable = self.flushedMutable ?: FBMutableFuture.future;
+  }
+}
+
+- (void)consumeEndOfFile
+{
+}
+
+- (NSUInteger)frameCount
+{
+  @synchronized (self) {
+    return self.frames.count;
+  }
+}
+
+- (void)finishWriting
+{
+  FBMutableFuture<NSNull *> *flushed = nil;
+  @synchronized (self) {
+    _pendingBytes = 0;
+    flushed = self.flushedMutable;
+    self.flushedMutable = nil;
+  }
+  [flushed resolveWithResult:NSNull.null];
+}
+
+- (FBFuture<NSNull *> *)drained
+{
+  return [FBFuture futureWithResult:NSNull.null];
+}
+
+- (FBFuture<NSNull *> *)flushed
+{
+  @synchronized (self) {
+    return self.flushedMutable ?: [FBFuture futureWithResult:NSNull.null];
+  }
+}
+
+@end
+
+@interface FBSimulatorBitmapStreamTests : XCTestCase
+
+@property (nonatomic, strong, readwrite) FBSimulatorBitmapStreamTests_Framebuffer *framebuffer;
+@property (nonatomic, strong, readwrite) FBSimulatorBitmapStreamTests_Consumer *consumer;
+
+@end
+
+@implementation FBSimulatorBitmapStreamTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.framebuffer = [FBSimulatorBitmapStreamTests_Framebuffer new];
+  self.consumer = [FBSimulatorBitmapStreamTests_Consumer new];
+}
+
+- (FBSimulatorBitmapStream *)startAdaptiveStreamWithFramesPerSecond:(NSUInteger)framesPerSecond latencyBudget:(NSTimeInterval)latencyBudget
+{
+  FBSimulatorBitmapStream *stream = [FBSimulatorBitmapStream adaptiveStreamWithFramebuffer:self.framebuffer framesPerSecond:framesPerSecond latencyBudget:latencyBudget logger:FBControlCoreGlobalConfiguration.defaultLogger];
+  NSError *error = nil;
+  XCTAssertNotNil([[stream startStreaming:self.consumer] awaitWithTimeout:5 error:&error], @"%@", error);
+  return stream;
+}
+
+- (void)waitForFrameCount:(NSUInteger)frameCount
+{
+  NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5];
+  while (self.consumer.frameCount < frameCount && deadline.timeIntervalSinceNow > 0) {
+    [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+  }
+  XCTAssertEqual(self.consumer.frameCount, frameCount);
+}
+
+- (void)testWritesTheNewestFrameOnceThePreviousFrameIsFlushed
+{
+  FBSimulatorBitmapStream *stream = [self startAdaptiveStreamWithFramesPerSecond:1000 latencyBudget:10];
+  [self waitForFrameCount:1];
+
+  // The first frame has not been flushed, so newer frames replace each other rather than being written.
+  [self.framebuffer damage];
+  [self.framebuffer damage];
+  [self.framebuffer damage];
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+  XCTAssertEqual(self.consumer.frameCount, 1u);
+  XCTAssertEqual(stream.framesWritten, 0u);
+  XCTAssertEqual(stream.framesDropped, 2u);
+
+  [self.consumer finishWriting];
+  [self waitForFrameCount:2];
+  XCTAssertEqual(stream.framesWritten, 1u);
+  XCTAssertEqual(stream.framesDropped, 2u);
+
+  [self.consumer finishWriting];
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+  XCTAssertEqual(self.consumer.frameCount, 2u);
+  XCTAssertEqual(stream.framesWritten, 2u);
+  XCTAssertGreaterThan(stream.averageLatency, 0);
+  XCTAssertEqualObjects(self.consumer.frames[0], self.consumer.frames[1]);
+}
+
+- (void)testLowersTheFrameRateWhenOverTheLatencyBudget
+{
+  FBSimulatorBitmapStream *stream = [self startAdaptiveStreamWithFramesPerSecond:60 latencyBudget:0.2];
+  XCTAssertEqualWithAccuracy(stream.effectiveFramesPerSecond, 60, 0.001);
+  [self waitForFrameCount:1];
+
+  // A frame that takes longer than the budget to flush halves the frame rate.
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+  [self.consumer finishWriting];
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+  XCTAssertEqualWithAccuracy(stream.effectiveFramesPerSecond, 30, 0.001);
+
+  // A frame that is flushed well within the budget raises it by one frame per second.
+  [self.framebuffer damage];
+  [self waitForFrameCount:2];
+  [self.consumer finishWriting];
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+  XCTAssertEqualWithAccuracy(stream.effectiveFramesPerSecond, 31, 0.001);
+  XCTAssertEqual(stream.framesWritten, 2u);
+  XCTAssertEqual(stream.framesDropped, 0u);
+}
+
+@end
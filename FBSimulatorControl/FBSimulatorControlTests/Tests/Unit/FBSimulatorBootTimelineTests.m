@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBSimulatorControl/FBSimulatorControl.h>
+
+@interface FBSimulatorBootTimelineTests : XCTestCase
+
+@end
+
+@implementation FBSimulatorBootTimelineTests
+
+- (void)testRecordsPhaseTransitions
+{
+  FBSimulatorBootTimeline *timeline = FBSimulatorBootTimeline.timeline;
+  [timeline recordPhase:FBSimulatorBootPhaseLaunchd elapsedTime:0.5];
+  [timeline recordPhase:FBSimulatorBootPhaseLaunchd elapsedTime:1];
+  [timeline recordPhase:FBSimulatorBootPhaseDataMigration elapsedTime:2];
+  [timeline recordPhase:FBSimulatorBootPhaseSystemApp elapsedTime:10];
+  XCTAssertFalse(timeline.completed);
+  XCTAssertTrue(isnan(timeline.totalDuration));
+  XCTAssertEqual(timeline.phases.count, 3u);
+  XCTAssertTrue(isnan(timeline.phases.lastObject.duration));
+
+  [timeline completeWithElapsedTime:12];
+  XCTAssertTrue(timeline.completed);
+  XCTAssertEqual(timeline.totalDuration, 12);
+
+  NSArray<FBSimulatorBootPhaseTiming *> *phases = timeline.phases;
+  XCTAssertEqualObjects([phases valueForKey:@"phase"], (@[FBSimulatorBootPhaseLaunchd, FBSimulatorBootPhaseDataMigration, FBSimulatorBootPhaseSystemApp]));
+  XCTAssertEqual(phases[0].startTime, 0.5);
+  XCTAssertEqual(phases[0].duration, 1.5);
+  XCTAssertEqual(phases[1].startTime, 2);
+  XCTAssertEqual(phases[1].duration, 8);
+  XCTAssertEqual(phases[2].startTime, 10);
+  XCTAssertEqual(phases[2].duration, 2);
+
+  // Observations after completion are ignored.
+  [timeline recordPhase:FBSimulatorBootPhaseBackboard elapsedTime:20];
+  XCTAssertEqual(timeline.phases.count, 3u);
+}
+
+- (void)testElapsedTimeDoesNotGoBackwards
+{
+  FBSimulatorBootTimeline *timeline = FBSimulatorBootTimeline.timeline;
+  [timeline recordPhase:FBSimulatorBootPhaseLaunchd elapsedTime:3];
+  [timeline recordPhase:FBSimulatorBootPhaseBackboard elapsedTime:2];
+  [timeline completeWithElapsedTime:4];
+
+  NSArray<FBSimulatorBootPhaseTiming *> *phases = timeline.phases;
+  XCTAssertEqual(phases[0].duration, 0);
+  XCTAssertEqual(phases[1].startTime, 3);
+  XCTAssertEqual(phases[1].duration, 1);
+}
+
+- (void)testJSONRepresentation
+{
+  FBSimulatorBootTimeline *timeline = FBSimulatorBootTimeline.timeline;
+  [timeline recordPhase:FBSimulatorBootPhaseSystemApp elapsedTime:1];
+  NSDictionary<NSString *, id> *expected = @{
+    @"phases": @[@{@"phase": @"system_app", @"start": @1, @"duration": NSNull.null}],
+    @"total": NSNull.null,
+    @"completed": @NO,
+  };
+  XCTAssertEqualObjects(timeline.jsonSerializableRepresentation, expected);
+  XCTAssertTrue([NSJSONSerialization isValidJSONObject:timeline.jsonSerializableRepresentation]);
+
+  [timeline completeWithElapsedTime:3];
+  expected = @{
+    @"phases": @[@{@"phase": @"system_app", @"start": @1, @"duration": @2}],
+    @"total": @3,
+    @"completed": @YES,
+  };
+  XCTAssertEqualObjects(timeline.jsonSerializableRepresentation, expected);
+}
+
+@end
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+#import <FBSimulatorControl/FBSimulatorControl.h>
+
+@interface FBSimulatorServiceMonitorTests : XCTestCase
+
+@property (atomic, copy, readwrite) NSString *output;
+@property (atomic, assign, readwrite) NSUInteger invocations;
+@property (nonatomic, strong, readwrite) FBSimulatorServiceMonitor *monitor;
+
+@end
+
+@implementation FBSimulatorServiceMonitorTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.output = @"PID\tStatus\tLabel\n-\t0\tcom.apple.SpringBoard\n";
+  self.invocations = 0;
+  __weak typeof(self) weakSelf = self;
+  self.monitor = [FBSimulatorServiceMonitor monitorWithListProvider:^{
+    weakSelf.invocations++;
+    return [FBFuture futureWithDelay:0.05 future:[FBFuture futureWithResult:weakSelf.output]];
+  } logger:nil];
+}
+
+- (void)testParsesListOutput
+{
+  NSString *output = @"PID\tStatus\tLabel\n1234\t0\tcom.apple.backboardd\n-\t78\tcom.apple.mobileassetd\n42\t-\tUIKitApplication:com.foo.bar[0x1234]\n\n";
+  NSError *error = nil;
+  NSDictionary<NSString *, id> *services = [FBSimulatorServiceMonitor servicesFromListOutput:output error:&error];
+  XCTAssertNil(error);
+  NSDictionary<NSString *, id> *expected = @{
+    @"com.apple.backboardd": @1234,
+    @"com.apple.mobileassetd": NSNull.null,
+    @"UIKitApplication:com.foo.bar[0x1234]": @42,
+  };
+  XCTAssertEqualObjects(services, expected);
+}
+
+- (void)testRejectsMalformedListOutput
+{
+  XCTAssertNil([FBSimulatorServiceMonitor servicesFromListOutput:@"" error:nil]);
+  XCTAssertNil([FBSimulatorServiceMonitor servicesFromListOutput:@"PID\tStatus\tLabel\n12\tcom.apple.foo\n" error:nil]);
+  XCTAssertNil([FBSimulatorServiceMonitor servicesFromListOutput:@"PID\tStatus\tLabel\nabc\t0\tcom.apple.foo\n" error:nil]);
+}
+
+- (void)testConcurrentRefreshesShareAnInvocation
+{
+  NSMutableArray<FBFuture *> *futures = [NSMutableArray array];
+  for (NSUInteger index = 0; index < 10; index++) {
+    [futures addObject:[self.monitor refresh]];
+  }
+  NSError *error = nil;
+  XCTAssertNotNil([[FBFuture futureWithFutures:futures] awaitWithTimeout:5 error:&error], @"%@", error);
+  XCTAssertEqual(self.invocations, 1u);
+  XCTAssertEqual(self.monitor.refreshCount, 1u);
+
+  // A recent snapshot is used without invoking the provider, until it is invalidated.
+  XCTAssertNotNil([[self.monitor servicesWithMaximumAge:60] awaitWithTimeout:5 error:nil]);
+  XCTAssertEqual(self.invocations, 1u);
+  [self.monitor invalidate];
+  XCTAssertNotNil([[self.monitor servicesWithMaximumAge:60] awaitWithTimeout:5 error:nil]);
+  XCTAssertEqual(self.invocations, 2u);
+}
+
+- (void)testInvalidationDiscardsRefreshesInFlight
+{
+  FBFuture<NSDictionary<NSString *, id> *> *refresh = [self.monitor refresh];
+  self.output = @"PID\tStatus\tLabel\n12\t0\tcom.apple.SpringBoard\n";
+  [self.monitor invalidate];
+
+  NSError *error = nil;
+  NSDictionary<NSString *, id> *expected = @{@"com.apple.SpringBoard": @12};
+  XCTAssertEqualObjects([refresh awaitWithTimeout:5 error:&error], expected, @"%@", error);
+  XCTAssertEqualObjects(self.monitor.services, expected);
+  XCTAssertEqual(self.invocations, 2u);
+  XCTAssertEqual(self.monitor.refreshCount, 1u);
+}
+
+- (void)testWaitersResolveWhenServicesStart
+{
+  FBFuture<NSNull *> *springboard = [self.monitor waitUntilServicesAreRunning:@[@"com.apple.SpringBoard"]];
+  FBFuture<NSNull *> *both = [self.monitor waitUntilServicesAreRunning:@[@"com.apple.SpringBoard", @"com.apple.backboardd"]];
+  XCTAssertNil([springboard awaitWithTimeout:0.5 error:nil]);
+
+  self.output = @"PID\tStatus\tLabel\n12\t0\tcom.apple.SpringBoard\n";
+  NSError *error = nil;
+  XCTAssertNotNil([springboard awaitWithTimeout:5 error:&error], @"%@", error);
+  XCTAssertEqual(both.state, FBFutureStateRunning);
+
+  self.output = @"PID\tStatus\tLabel\n12\t0\tcom.apple.SpringBoard\n13\t0\tcom.apple.backboardd\n";
+  XCTAssertNotNil([both awaitWithTimeout:5 error:&error], @"%@", error);
+
+  // Polling stops once there are no waiters.
+  NSUInteger invocations = self.invocations;
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1]];
+  XCTAssertLessThanOrEqual(self.invocations, invocations + 1);
+}
+
+- (void)testPollingBacksOffWhilstServicesAreUnchanged
+{
+  FBFuture<NSNull *> *waiter = [self.monitor waitUntilServicesAreRunning:@[@"com.apple.backboardd"]];
+  // Polls at 0, 0.5, 1.5 and 3.5 seconds, rather than every 0.5 seconds.
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:4]];
+  XCTAssertGreaterThanOrEqual(self.invocations, 3u);
+  XCTAssertLessThanOrEqual(self.invocations, 5u);
+
+  [[waiter cancel] awaitWithTimeout:5 error:nil];
+}
+
+- (void)testCancelledWaitersStopPolling
+{
+  FBFuture<NSNull *> *waiter = [self.monitor waitUntilServicesAreRunning:@[@"com.apple.backboardd"]];
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+  XCTAssertGreaterThan(self.invocations, 0u);
+  [[waiter cancel] awaitWithTimeout:5 error:nil];
+
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+  NSUInteger invocations = self.invocations;
+  [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1]];
+  XCTAssertEqual(self.invocations, invocations);
+}
+
+@end
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+#import <FBSimulatorControl/FBSimulatorControl.h>
+
+static NSString *const PreiOS12Schema = @"CREATE TABLE access (service TEXT NOT NULL, client TEXT NOT NULL, client_type INTEGER NOT NULL, allowed INTEGER NOT NULL, prompt_count INTEGER NOT NULL, csreq BLOB, policy_id INTEGER, PRIMARY KEY (service, client, client_type));";
+static NSString *const PostiOS12Schema = @"CREATE TABLE access (service TEXT NOT NULL, client TEXT NOT NULL, client_type INTEGER NOT NULL, allowed INTEGER NOT NULL, prompt_count INTEGER NOT NULL, csreq BLOB, policy_id INTEGER, indirect_object_identifier_type INTEGER, indirect_object_identifier TEXT, indirect_object_code_identity BLOB, flags INTEGER, last_modified INTEGER NOT NULL DEFAULT (CAST(strftime('%s','now') AS INTEGER)), PRIMARY KEY (service, client, client_type, indirect_object_identifier));";
+
+@interface FBTCCDatabaseModificationStrategyTests : XCTestCase
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+
+@end
+
+@implementation FBTCCDatabaseModificationStrategyTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  [NSFileManager.defaultManager createDirectoryAtPath:self.directory withIntermediateDirectories:YES attributes:nil error:nil];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (NSString *)runSQL:(NSString *)sql onDatabase:(NSString *)databasePath
+{
+  NSError *error = nil;
+  FBTask<NSNull *, NSString *, NSString *> *task = [[[[[FBTaskBuilder
+    withLaunchPath:@"/usr/bin/sqlite3" arguments:@[databasePath, sql]]
+    withStdOutInMemoryAsString]
+    withStdErrInMemoryAsString]
+    runUntilCompletion]
+    awaitWithTimeout:5 error:&error];
+  XCTAssertNotNil(task, @"%@", error);
+  return [task.stdOut stringByTrimmingCharactersInSet:NSCharacterSet.newlineCharacterSet];
+}
+
+- (NSArray<NSString *> *)createDatabasesWithSchema:(NSString *)schema count:(NSUInteger)count
+{
+  NSMutableArray<NSString *> *databasePaths = [NSMutableArray array];
+  for (NSUInteger index = 0; index < count; index++) {
+    NSString *databasePath = [self.directory stringByAppendingPathComponent:[NSString stringWithFormat:@"TCC-%lu.db", (unsigned long) index]];
+    [self runSQL:schema onDatabase:databasePath];
+    [databasePaths addObject:databasePath];
+  }
+  return databasePaths;
+}
+
+- (void)grantAccessInDatabases:(NSArray<NSString *> *)databasePaths
+{
+  NSSet<NSString *> *bundleIDs = [NSSet setWithArray:@[@"com.foo.bar", @"com.foo.baz"]];
+  NSSet<FBSettingsApprovalService> *services = [NSSet setWithArray:@[FBSettingsApprovalServiceCamera, FBSettingsApprovalServicePhotos, FBSettingsApprovalServiceLocation]];
+  NSError *error = nil;
+  XCTAssertNotNil([[[FBTCCDatabaseModificationStrategy strategyWithDatabasePaths:databasePaths logger:nil] grantAccess:bundleIDs toServices:services] awaitWithTimeout:10 error:&error], @"%@", error);
+}
+
+- (void)assertApprovalsInDatabases:(NSArray<NSString *> *)databasePaths
+{
+  NSString *expected = @"kTCCServiceCamera|com.foo.bar|1\nkTCCServiceCamera|com.foo.baz|1\nkTCCServicePhotos|com.foo.bar|1\nkTCCServicePhotos|com.foo.baz|1";
+  for (NSString *databasePath in databasePaths) {
+    XCTAssertEqualObjects([self runSQL:@"SELECT service, client, allowed FROM access ORDER BY service, client" onDatabase:databasePath], expected);
+  }
+}
+
+- (void)testGrantsAccessPreiOS12
+{
+  NSArray<NSString *> *databasePaths = [self createDatabasesWithSchema:PreiOS12Schema count:1];
+  [self grantAccessInDatabases:databasePaths];
+  [self assertApprovalsInDatabases:databasePaths];
+}
+
+- (void)testGrantsAccessPostiOS12
+{
+  NSArray<NSString *> *databasePaths = [self createDatabasesWithSchema:PostiOS12Schema count:1];
+  [self grantAccessInDatabases:databasePaths];
+  [self assertApprovalsInDatabases:databasePaths];
+  XCTAssertEqualObjects([self runSQL:@"SELECT COUNT(*) FROM access WHERE last_modified > 0" onDatabase:databasePaths.firstObject], @"4");
+}
+
+- (void)testGrantsAccessInManyDatabasesIdempotently
+{
+  NSArray<NSString *> *databasePaths = [self createDatabasesWithSchema:PreiOS12Schema count:8];
+  [self grantAccessInDatabases:databasePaths];
+  [self grantAccessInDatabases:databasePaths];
+  [self assertApprovalsInDatabases:databasePaths];
+}
+
+- (void)testFailsWithoutAccessTable
+{
+  NSString *databasePath = [self.directory stringByAppendingPathComponent:@"Empty.db"];
+  [self runSQL:@"CREATE TABLE other (value TEXT);" onDatabase:databasePath];
+  NSError *error = nil;
+  XCTAssertNil([[[FBTCCDatabaseModificationStrategy strategyWithDatabasePaths:@[databasePath] logger:nil] grantAccess:[NSSet setWithObject:@"com.foo.bar"] toServices:[NSSet setWithObject:FBSettingsApprovalServiceCamera]] awaitWithTimeout:5 error:&error]);
+  XCTAssertNotNil(error);
+}
+
+@end
@@ -143,3 +143,25 @@ typedef NS_ENUM(NSInteger, OTestExitCode) {
 #define kReporter_OutputBeforeTestBundleStarts_OutputKey @"output"
 
 #define kReporter_SimulatorOutput_OutputKey @"output"
+
+// Binary framing of events, opted into via the environment.
+// This must be kept in sync with FBLogicReporterBinaryDecoder in XCTestBootstrap.
+#define kReporter_Binary_EnvironmentKey "OTEST_SHIM_BINARY_EVENTS"
+#define kReporter_Binary_Magic "\xFB" "XT\x01"
+#define kReporter_Binary_MagicLength 4
+
+typedef NS_ENUM(uint8_t, ReporterBinaryFrameType) {
+  kReporter_Binary_FrameString = 1,
+  kReporter_Binary_FrameBeginTestSuite = 2,
+  kReporter_Binary_FrameEndTestSuite = 3,
+  kReporter_Binary_FrameBeginTest = 4,
+  kReporter_Binary_FrameEndTest = 5,
+  kReporter_Binary_FrameJSON = 6,
+  kReporter_Binary_FrameEndOfStream = 7,
+};
+
+typedef NS_ENUM(uint8_t, ReporterBinaryTestResult) {
+  kReporter_Binary_ResultSuccess = 0,
+  kReporter_Binary_ResultFailure = 1,
+  kReporter_Binary_ResultError = 2,
+};
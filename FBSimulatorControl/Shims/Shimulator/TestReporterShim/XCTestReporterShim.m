@@ -10,6 +10,7 @@
 #import <Foundation/Foundation.h>
 
 #import <dlfcn.h>
+#import <libkern/OSByteOrder.h>
 #import <objc/message.h>
 #import <objc/runtime.h>
 
@@ -265,6 +266,17 @@ static int __testSuiteDepth = 0;
 
 static NSString *__testScope = nil;
 
+static BOOL __binaryEvents = NO;
+static NSMutableData *__binaryFrame = nil;
+static NSMutableDictionary<NSString *, NSNumber *> *__binaryStrings = nil;
+static dispatch_source_t __binaryFlushTimer = nil;
+
+// Binary events are buffered, but are flushed at least this often so the reader sees progress.
+static const size_t kBinaryEventsBufferSize = 64 * 1024;
+static const uint64_t kBinaryEventsFlushInterval = 100 * NSEC_PER_MSEC;
+
+static void *const kEventQueueSpecificKey = (void *) &kEventQueueSpecificKey;
+
 static dispatch_queue_t EventQueue()
 {
   static dispatch_queue_t eventQueue = {0};
@@ -273,11 +285,23 @@ static dispatch_queue_t EventQueue()
   dispatch_once(&onceToken, ^{
     // We'll serialize all events through this queue.
     eventQueue = dispatch_queue_create(kEventQueueLabel, DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(eventQueue, kEventQueueSpecificKey, kEventQueueSpecificKey, NULL);
   });
 
   return eventQueue;
 }
 
+// Runs the block on the Event Queue, inline if already there (e.g. a signal delivered on the queue's thread).
+static void SyncOnEventQueue(dispatch_block_t block)
+{
+  dispatch_queue_t queue = EventQueue();
+  if (dispatch_get_specific(kEventQueueSpecificKey) == kEventQueueSpecificKey) {
+    block();
+    return;
+  }
+  dispatch_sync(queue, block);
+}
+
 static void PrintJSON(id JSONObject)
 {
   NSError *error = nil;
@@ -296,6 +320,109 @@ static void PrintJSON(id JSONObject)
   fflush(__stdout);
 }
 
+#pragma mark - Binary Events
+
+static void BinaryAppendUInt8(NSMutableData *data, uint8_t value)
+{
+  [data appendBytes:&value length:sizeof(value)];
+}
+
+static void BinaryAppendUInt32(NSMutableData *data, uint32_t value)
+{
+  value = OSSwapHostToLittleInt32(value);
+  [data appendBytes:&value length:sizeof(value)];
+}
+
+static void BinaryAppendDouble(NSMutableData *data, double value)
+{
+  uint64_t raw = 0;
+  memcpy(&raw, &value, sizeof(raw));
+  raw = OSSwapHostToLittleInt64(raw);
+  [data appendBytes:&raw length:sizeof(raw)];
+}
+
+static void BinaryWriteFrame(ReporterBinaryFrameType type, const void *payload, size_t payloadLength)
+{
+  uint32_t length = OSSwapHostToLittleInt32((uint32_t) payloadLength + 1);
+  fwrite(&length, sizeof(length), 1, __stdout);
+  fwrite(&type, sizeof(type), 1, __stdout);
+  fwrite(payload, 1, payloadLength, __stdout);
+}
+
+// Must be called on the Event Queue, or once the flush timer has been cancelled.
+static void BinaryFlush()
+{
+  if (__stdout == NULL) {
+    return;
+  }
+  fflush(__stdout);
+}
+
+static void StartBinaryFlushTimer()
+{
+  __binaryFlushTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, EventQueue());
+  dispatch_source_set_timer(__binaryFlushTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t) kBinaryEventsFlushInterval), kBinaryEventsFlushInterval, kBinaryEventsFlushInterval / 10);
+  dispatch_source_set_event_handler(__binaryFlushTimer, ^{
+    if (dispatch_source_testcancel(__binaryFlushTimer)) {
+      return;
+    }
+    BinaryFlush();
+  });
+  dispatch_resume(__binaryFlushTimer);
+}
+
+static NSMutableData *BinaryBeginFrame()
+{
+  __binaryFrame.length = 0;
+  return __binaryFrame;
+}
+
+static void BinaryEndFrame(ReporterBinaryFrameType type)
+{
+  BinaryWriteFrame(type, __binaryFrame.bytes, __binaryFrame.length);
+}
+
+// Strings are written once, subsequent references are by index.
+static void BinaryAppendString(NSMutableData *data, NSString *string)
+{
+  NSNumber *index = __binaryStrings[string];
+  if (!index) {
+    index = @(__binaryStrings.count);
+    __binaryStrings[string] = index;
+    NSMutableData *definition = [NSMutableData data];
+    BinaryAppendUInt32(definition, index.unsignedIntValue);
+    [definition appendData:[string dataUsingEncoding:NSUTF8StringEncoding]];
+    BinaryWriteFrame(kReporter_Binary_FrameString, definition.bytes, definition.length);
+  }
+  BinaryAppendUInt32(data, index.unsignedIntValue);
+}
+
+static void ConfigureBinaryEventsIfRequested()
+{
+  const char *binaryEvents = getenv(kReporter_Binary_EnvironmentKey);
+  if (!binaryEvents || strcmp(binaryEvents, "1") != 0) {
+    return;
+  }
+  __binaryEvents = YES;
+  __binaryFrame = [NSMutableData dataWithCapacity:256];
+  __binaryStrings = [NSMutableDictionary dictionary];
+  setvbuf(__stdout, NULL, _IOFBF, kBinaryEventsBufferSize);
+  fwrite(kReporter_Binary_Magic, 1, kReporter_Binary_MagicLength, __stdout);
+  BinaryFlush();
+  StartBinaryFlushTimer();
+}
+
+static void PrintEvent(NSDictionary *event)
+{
+  if (!__binaryEvents) {
+    PrintJSON(event);
+    return;
+  }
+  NSData *data = [NSJSONSerialization dataWithJSONObject:event options:0 error:nil];
+  BinaryWriteFrame(kReporter_Binary_FrameJSON, data.bytes, data.length);
+  BinaryFlush();
+}
+
 #pragma mark - XCToolLog function declarations
 
 static void XCToolLog_testSuiteDidStart(NSString *testDescription);
@@ -320,6 +447,13 @@ static void XCToolLog_testSuiteDidStart(NSString *name)
 {
   if (__testSuiteDepth > 0) {
     dispatch_sync(EventQueue(), ^{
+      if (__binaryEvents) {
+        NSMutableData *frame = BinaryBeginFrame();
+        BinaryAppendDouble(frame, [[NSDate date] timeIntervalSince1970]);
+        BinaryAppendString(frame, name);
+        BinaryEndFrame(kReporter_Binary_FrameBeginTestSuite);
+        return;
+      }
       PrintJSON(EventDictionaryWithNameAndContent(
         kReporter_Events_BeginTestSuite,
         @{kReporter_BeginTestSuite_SuiteKey : name}
@@ -344,7 +478,20 @@ static void XCToolLog_testSuiteDidStop(NSString *testSuiteName, XCTestSuiteRun *
 {
   __testSuiteDepth--;
 
-  if (__testSuiteDepth > 0) {
+  if (__testSuiteDepth > 0 && __binaryEvents) {
+    dispatch_sync(EventQueue(), ^{
+      NSMutableData *frame = BinaryBeginFrame();
+      BinaryAppendDouble(frame, [[NSDate date] timeIntervalSince1970]);
+      BinaryAppendString(frame, testSuiteName);
+      BinaryAppendUInt32(frame, (uint32_t) [run testCaseCount]);
+      BinaryAppendUInt32(frame, (uint32_t) [run totalFailureCount]);
+      BinaryAppendUInt32(frame, (uint32_t) [run unexpectedExceptionCount]);
+      BinaryAppendDouble(frame, [run testDuration]);
+      BinaryAppendDouble(frame, [run totalDuration]);
+      BinaryEndFrame(kReporter_Binary_FrameEndTestSuite);
+      BinaryFlush();
+    });
+  } else if (__testSuiteDepth > 0) {
     NSDictionary *content =
       @{
         kReporter_EndTestSuite_SuiteKey : testSuiteName,
@@ -381,6 +528,18 @@ static void XCToolLog_testCaseDidStart(NSString *fullTestName)
     NSString *className = nil;
     NSString *methodName = nil;
     ParseClassAndMethodFromTestName(&className, &methodName, fullTestName);
+    __testExceptions = [[NSMutableArray alloc] init];
+
+    if (__binaryEvents) {
+      NSMutableData *frame = BinaryBeginFrame();
+      BinaryAppendDouble(frame, [[NSDate date] timeIntervalSince1970]);
+      BinaryAppendString(frame, className);
+      BinaryAppendString(frame, methodName);
+      BinaryEndFrame(kReporter_Binary_FrameBeginTest);
+      // Flush the start of each test, so that the test that was running is known if the process dies.
+      BinaryFlush();
+      return;
+    }
 
     PrintJSON(EventDictionaryWithNameAndContent(
       kReporter_Events_BeginTest, @{
@@ -388,8 +547,6 @@ static void XCToolLog_testCaseDidStart(NSString *fullTestName)
         kReporter_BeginTest_ClassNameKey : className,
         kReporter_BeginTest_MethodNameKey : methodName,
     }));
-
-    __testExceptions = [[NSMutableArray alloc] init];
   });
 }
 
@@ -427,6 +584,26 @@ static void XCToolLog_testCaseDidStop(NSString *fullTestName, NSNumber *unexpect
       succeeded = YES;
     }
 
+    if (__binaryEvents) {
+      // Only the last exception is reported, as with the JSON events.
+      // Failing results without an exception are still reported as failures by the decoder.
+      NSDictionary *exception = __testExceptions.lastObject;
+      NSMutableData *frame = BinaryBeginFrame();
+      BinaryAppendDouble(frame, [[NSDate date] timeIntervalSince1970]);
+      BinaryAppendString(frame, className);
+      BinaryAppendString(frame, methodName);
+      BinaryAppendUInt8(frame, errored ? kReporter_Binary_ResultError : (failed ? kReporter_Binary_ResultFailure : kReporter_Binary_ResultSuccess));
+      BinaryAppendDouble(frame, [totalDuration doubleValue]);
+      BinaryAppendUInt8(frame, exception != nil);
+      if (exception) {
+        BinaryAppendString(frame, exception[kReporter_EndTest_Exception_FilePathInProjectKey]);
+        BinaryAppendUInt32(frame, (uint32_t) [exception[kReporter_EndTest_Exception_LineNumberKey] unsignedIntegerValue]);
+        [frame appendData:[exception[kReporter_EndTest_Exception_ReasonKey] dataUsingEncoding:NSUTF8StringEncoding]];
+      }
+      BinaryEndFrame(kReporter_Binary_FrameEndTest);
+      return;
+    }
+
     // report test results
     NSArray *retExceptions = [__testExceptions copy];
     NSDictionary *json = EventDictionaryWithNameAndContent(
@@ -538,7 +715,7 @@ static void XCWaitForDebuggerIfNeeded()
       int pid = [[NSProcessInfo processInfo] processIdentifier];
       NSString *beginMessage = [NSString stringWithFormat:@"Waiting for debugger to be attached to pid '%d' ...", pid];
       dispatch_sync(EventQueue(), ^{
-        PrintJSON(EventDictionaryWithNameAndContent(
+        PrintEvent(EventDictionaryWithNameAndContent(
           kReporter_Events_BeginStatus,
           @{
             kReporter_BeginStatus_MessageKey : beginMessage,
@@ -552,7 +729,7 @@ static void XCWaitForDebuggerIfNeeded()
 
       NSString *endMessage = [NSString stringWithFormat:@"Debugger was successfully attached to pid '%d'.", pid];
       dispatch_sync(EventQueue(), ^{
-        PrintJSON(EventDictionaryWithNameAndContent(
+        PrintEvent(EventDictionaryWithNameAndContent(
           kReporter_Events_EndStatus,
           @{
             kReporter_BeginStatus_MessageKey : endMessage,
@@ -617,16 +794,26 @@ static void UpdateTestScope()
  *  if a test calls `exit()` or `abort()`. The found workaround was to print
  *  anithing to a pipe before closing it. Simply closing a pipe doesn't send EOF
  *  to the pipe reader. Printing "\n" should be safe because reader is skipping
- *  empty lines.
+ *  empty lines. A binary event stream ends with an End of Stream frame instead,
+ *  as a newline would be read as the start of a frame.
  */
 static void PrintNewlineAndCloseFDs()
 {
-  if (__stdout == NULL) {
-    return;
-  }
-  fprintf(__stdout, "\n");
-  fclose(__stdout);
-  __stdout = NULL;
+  // The flush timer fires on the Event Queue, so closing there means it can never touch a closed stream.
+  SyncOnEventQueue(^{
+    if (__stdout == NULL) {
+      return;
+    }
+    if (__binaryEvents) {
+      dispatch_source_cancel(__binaryFlushTimer);
+      BinaryWriteFrame(kReporter_Binary_FrameEndOfStream, NULL, 0);
+    } else {
+      fprintf(__stdout, "\n");
+    }
+    FILE *file = __stdout;
+    __stdout = NULL;
+    fclose(file);
+  });
 }
 
 #pragma mark - Entry
@@ -880,6 +1067,7 @@ __attribute__((constructor)) static void EntryPoint()
   NSString *bundleRunPath = NSProcessInfo.processInfo.environment[@"TEST_SHIM_BUNDLE_PATH"];
   if (bundleRunPath) {
     assignOutputFiles();
+    ConfigureBinaryEventsIfRequested();
     UpdateTestScope();
 
     struct sigaction sa_abort;
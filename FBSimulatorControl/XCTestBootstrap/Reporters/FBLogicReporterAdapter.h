@@ -16,8 +16,8 @@ NS_ASSUME_NONNULL_BEGIN
 @protocol FBControlCoreLogger;
 
 /**
- This adapter parses streams of events in JSON and invokes
- the corresponding methods in the provided FBXCTestReporter
+ This adapter parses streams of events in JSON, or the binary framing of FBLogicReporterBinaryDecoder,
+ and invokes the corresponding methods in the provided FBXCTestReporter
  */
 @interface FBLogicReporterAdapter : NSObject <FBLogicXCTestReporter>
 
@@ -11,10 +11,13 @@
 #import <XCTestBootstrap/FBXCTestReporter.h>
 #import <XCTestBootstrap/FBXCTestLogger.h>
 
+#import "FBLogicReporterBinaryDecoder.h"
+
 @interface FBLogicReporterAdapter ()
 
 @property (nonatomic, readonly) id<FBXCTestReporter> reporter;
 @property (nonatomic, readonly) FBXCTestLogger *logger;
+@property (nonatomic, strong, readonly) FBLogicReporterBinaryDecoder *binaryDecoder;
 
 @end
 
@@ -28,6 +31,7 @@
   }
   _reporter = reporter;
   _logger = [logger withName:@"FBLogicReporterAdapter"];
+  _binaryDecoder = [[FBLogicReporterBinaryDecoder alloc] initWithReporter:reporter logger:_logger];
 
   return self;
 }
@@ -104,6 +108,14 @@
   }
 }
 
+- (void)handleEventBinaryData:(NSData *)data
+{
+  NSError *error = nil;
+  if (![self.binaryDecoder consumeData:data error:&error]) {
+    [self.logger logFormat:@"Received invalid binary event data: %@", error];
+  }
+}
+
 - (void)handleEndTest:(NSDictionary<NSString *, id> *)JSONEvent data:(NSData *)data
 {
   id<FBXCTestReporter> reporter = self.reporter;
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol FBXCTestReporter;
+@protocol FBLogicXCTestReporter;
+
+/**
+ The name of the environment variable that opts the reporter shim into binary framing of events.
+ */
+extern NSString *const FBLogicReporterBinaryEventsEnvironmentKey;
+
+/**
+ The bytes that a binary event stream begins with.
+ The first byte is never valid as the start of a JSON event line, so streams can be sniffed.
+ */
+extern const uint8_t FBLogicReporterBinaryMagic[4];
+
+/**
+ The Frame Types of the binary event stream.
+ All integers are little-endian, all doubles are IEEE754 little-endian.
+ "string" is a uint32 index into the strings previously defined in the stream.
+ */
+typedef NS_ENUM(uint8_t, FBLogicReporterBinaryFrameType) {
+  FBLogicReporterBinaryFrameTypeString = 1, // uint32 index, UTF8 bytes for the remainder of the frame.
+  FBLogicReporterBinaryFrameTypeBeginTestSuite = 2, // double timestamp, string suite.
+  FBLogicReporterBinaryFrameTypeEndTestSuite = 3, // double timestamp, string suite, uint32 test count, uint32 failure count, uint32 unexpected count, double test duration, double total duration.
+  FBLogicReporterBinaryFrameTypeBeginTest = 4, // double timestamp, string class, string method.
+  FBLogicReporterBinaryFrameTypeEndTest = 5, // double timestamp, string class, string method, uint8 result, double duration, uint8 has failure. Then, if there is a failure: string file, uint32 line, UTF8 reason for the remainder of the frame.
+  FBLogicReporterBinaryFrameTypeJSON = 6, // A JSON encoded event for the remainder of the frame.
+  FBLogicReporterBinaryFrameTypeEndOfStream = 7, // No payload, written as the shim closes the stream.
+};
+
+/**
+ The values of the result in an End Test frame.
+ */
+typedef NS_ENUM(uint8_t, FBLogicReporterBinaryTestResult) {
+  FBLogicReporterBinaryTestResultSuccess = 0,
+  FBLogicReporterBinaryTestResultFailure = 1,
+  FBLogicReporterBinaryTestResultError = 2,
+};
+
+/**
+ Decodes the compact binary event stream written by the reporter shim.
+
+ The stream is the 4 magic bytes followed by frames of the form:
+ - uint32 little-endian length of the remainder of the frame.
+ - uint8 frame type.
+ - The payload for the frame type.
+ Strings such as Test Class, Method & Suite names are defined once in a string frame and referenced by index thereafter.
+ Frames may be split across calls to -consumeData:error:, incomplete frames are buffered until the remainder arrives.
+ A frame with an invalid length means that the position of the following frames is unknown, so the decoder fails and rejects all subsequent data.
+ */
+@interface FBLogicReporterBinaryDecoder : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param reporter the reporter to report decoded events to.
+ @param logger an optional logger to log to.
+ @return a new Decoder.
+ */
+- (instancetype)initWithReporter:(id<FBXCTestReporter>)reporter logger:(nullable id<FBControlCoreLogger>)logger;
+
+/**
+ A Data Consumer for the output of the reporter shim.
+ The first bytes of the stream are inspected, binary streams are delivered to -[FBLogicXCTestReporter handleEventBinaryData:]
+ and JSON streams are split into lines and delivered to -[FBLogicXCTestReporter handleEventJSONData:].
+
+ @param reporter the reporter to deliver to.
+ @param queue the queue to deliver on.
+ @return a new Data Consumer.
+ */
++ (id<FBDataConsumer, FBDataConsumerLifecycle>)shimOutputConsumerForReporter:(id<FBLogicXCTestReporter>)reporter queue:(dispatch_queue_t)queue;
+
+#pragma mark Public Methods
+
+/**
+ Decodes a chunk of the event stream, reporting all the complete events that it contains.
+
+ @param data the data to decode.
+ @param error an error out for a malformed stream.
+ @return YES if the data was decoded, NO if the stream is malformed or has previously failed to decode.
+ */
+- (BOOL)consumeData:(NSData *)data error:(NSError **)error;
+
+/**
+ YES if there is a partial frame that has been buffered.
+ */
+@property (nonatomic, assign, readonly) BOOL hasPartialFrame;
+
+@end
+
+NS_ASSUME_NONNULL_END
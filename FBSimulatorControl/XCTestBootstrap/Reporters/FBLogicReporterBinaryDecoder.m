@@ -0,0 +1,429 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBLogicReporterBinaryDecoder.h"
+
+#import <libkern/OSByteOrder.h>
+
+#import <XCTestBootstrap/FBLogicXCTestReporter.h>
+#import <XCTestBootstrap/FBXCTestReporter.h>
+
+#import "XCTestBootstrapError.h"
+
+NSString *const FBLogicReporterBinaryEventsEnvironmentKey = @"OTEST_SHIM_BINARY_EVENTS";
+
+const uint8_t FBLogicReporterBinaryMagic[4] = {0xFB, 'X', 'T', 0x01};
+
+static const uint32_t FrameHeaderLength = sizeof(uint32_t);
+static const uint32_t MaximumFrameLength = 64 * 1024 * 1024;
+
+typedef struct {
+  const uint8_t *bytes;
+  NSUInteger length;
+  NSUInteger offset;
+} FBBinaryFrameCursor;
+
+static BOOL ReadUInt8(FBBinaryFrameCursor *cursor, uint8_t *value)
+{
+  if (cursor->offset + sizeof(uint8_t) > cursor->length) {
+    return NO;
+  }
+  *value = cursor->bytes[cursor->offset];
+  cursor->offset += sizeof(uint8_t);
+  return YES;
+}
+
+static BOOL ReadUInt32(FBBinaryFrameCursor *cursor, uint32_t *value)
+{
+  if (cursor->offset + sizeof(uint32_t) > cursor->length) {
+    return NO;
+  }
+  *value = OSReadLittleInt32(cursor->bytes, cursor->offset);
+  cursor->offset += sizeof(uint32_t);
+  return YES;
+}
+
+static BOOL ReadDouble(FBBinaryFrameCursor *cursor, double *value)
+{
+  if (cursor->offset + sizeof(uint64_t) > cursor->length) {
+    return NO;
+  }
+  uint64_t raw = OSReadLittleInt64(cursor->bytes, cursor->offset);
+  memcpy(value, &raw, sizeof(double));
+  cursor->offset += sizeof(uint64_t);
+  return YES;
+}
+
+static NSString *ReadRemainingString(FBBinaryFrameCursor *cursor)
+{
+  NSString *string = [[NSString alloc] initWithBytes:cursor->bytes + cursor->offset length:cursor->length - cursor->offset encoding:NSUTF8StringEncoding];
+  cursor->offset = cursor->length;
+  return string;
+}
+
+@interface FBLogicReporterBinaryDecoder ()
+
+@property (nonatomic, strong, readonly) id<FBXCTestReporter> reporter;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) NSMutableData *buffer;
+@property (nonatomic, strong, readonly) NSMutableArray<NSString *> *strings;
+@property (nonatomic, assign, readwrite) BOOL hasReadMagic;
+@property (nonatomic, assign, readwrite) BOOL hasFailed;
+
+@end
+
+/**
+ Sniffs the first byte of the shim output to determine which decoding to use.
+ */
+@interface FBLogicReporterShimOutputConsumer : NSObject <FBDataConsumer, FBDataConsumerLifecycle>
+
+@property (nonatomic, strong, readonly) id<FBLogicXCTestReporter> reporter;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, nullable, readwrite) id<FBDataConsumer, FBDataConsumerLifecycle> lineConsumer;
+@property (nonatomic, assign, readwrite) BOOL isBinary;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *eofHasBeenReceivedFuture;
+
+@end
+
+@implementation FBLogicReporterShimOutputConsumer
+
+- (instancetype)initWithReporter:(id<FBLogicXCTestReporter>)reporter queue:(dispatch_queue_t)queue
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _reporter = reporter;
+  _queue = queue;
+  _eofHasBeenReceivedFuture = FBMutableFuture.future;
+
+  return self;
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  if (data.length == 0) {
+    return;
+  }
+  @synchronized (self) {
+    if (!self.lineConsumer && !self.isBinary) {
+      [self determineFormatFromFirstByte:((const uint8_t *) data.bytes)[0]];
+    }
+    if (self.lineConsumer) {
+      [self.lineConsumer consumeData:data];
+      return;
+    }
+  }
+  id<FBLogicXCTestReporter> reporter = self.reporter;
+  dispatch_async(self.queue, ^{
+    [reporter handleEventBinaryData:data];
+  });
+}
+
+- (void)consumeEndOfFile
+{
+  @synchronized (self) {
+    if (self.lineConsumer) {
+      [self.lineConsumer consumeEndOfFile];
+      [self.eofHasBeenReceivedFuture resolveFromFuture:self.lineConsumer.eofHasBeenReceived];
+      return;
+    }
+  }
+  // Resolve after all of the pending data has been delivered.
+  dispatch_async(self.queue, ^{
+    [self.eofHasBeenReceivedFuture resolveWithResult:NSNull.null];
+  });
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)eofHasBeenReceived
+{
+  return self.eofHasBeenReceivedFuture;
+}
+
+#pragma mark Private
+
+- (void)determineFormatFromFirstByte:(uint8_t)byte
+{
+  if (byte == FBLogicReporterBinaryMagic[0] && [self.reporter respondsToSelector:@selector(handleEventBinaryData:)]) {
+    self.isBinary = YES;
+    return;
+  }
+  id<FBLogicXCTestReporter> reporter = self.reporter;
+  self.lineConsumer = [FBLineDataConsumer asynchronousReaderWithQueue:self.queue dataConsumer:^(NSData *line) {
+    [reporter handleEventJSONData:line];
+  }];
+}
+
+@end
+
+@implementation FBLogicReporterBinaryDecoder
+
+#pragma mark Initializers
+
+- (instancetype)initWithReporter:(id<FBXCTestReporter>)reporter logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _reporter = reporter;
+  _logger = logger;
+  _buffer = [NSMutableData data];
+  _strings = [NSMutableArray array];
+
+  return self;
+}
+
++ (id<FBDataConsumer, FBDataConsumerLifecycle>)shimOutputConsumerForReporter:(id<FBLogicXCTestReporter>)reporter queue:(dispatch_queue_t)queue
+{
+  return [[FBLogicReporterShimOutputConsumer alloc] initWithReporter:reporter queue:queue];
+}
+
+#pragma mark Public Methods
+
+- (BOOL)consumeData:(NSData *)data error:(NSError **)error
+{
+  if (self.hasFailed) {
+    return [[XCTestBootstrapError
+      describe:@"Binary event stream has previously failed to decode"]
+      failBool:error];
+  }
+  [self.buffer appendData:data];
+
+  const uint8_t *bytes = self.buffer.bytes;
+  NSUInteger length = self.buffer.length;
+  NSUInteger offset = 0;
+
+  if (!self.hasReadMagic) {
+    if (length < sizeof(FBLogicReporterBinaryMagic)) {
+      return YES;
+    }
+    if (memcmp(bytes, FBLogicReporterBinaryMagic, sizeof(FBLogicReporterBinaryMagic)) != 0) {
+      [self failStream];
+      return [[XCTestBootstrapError
+        describe:@"Binary event stream does not start with the expected magic"]
+        failBool:error];
+    }
+    offset += sizeof(FBLogicReporterBinaryMagic);
+    self.hasReadMagic = YES;
+  }
+
+  BOOL success = YES;
+  while (length - offset >= FrameHeaderLength) {
+    uint32_t frameLength = OSReadLittleInt32(bytes, offset);
+    if (frameLength == 0 || frameLength > MaximumFrameLength) {
+      // There's no way of finding the start of the next frame, so nothing more can be decoded.
+      [self failStream];
+      return [[XCTestBootstrapError
+        describeFormat:@"Binary event frame has an invalid length of %u", frameLength]
+        failBool:error];
+    }
+    if (length - offset - FrameHeaderLength < frameLength) {
+      break;
+    }
+    FBBinaryFrameCursor cursor = {
+      .bytes = bytes + offset + FrameHeaderLength,
+      .length = frameLength,
+      .offset = 0,
+    };
+    offset += FrameHeaderLength + frameLength;
+    if (![self decodeFrame:&cursor error:error]) {
+      success = NO;
+      break;
+    }
+  }
+
+  [self.buffer replaceBytesInRange:NSMakeRange(0, offset) withBytes:NULL length:0];
+  return success;
+}
+
+- (BOOL)hasPartialFrame
+{
+  return self.buffer.length > 0;
+}
+
+#pragma mark Private
+
+- (void)failStream
+{
+  self.hasFailed = YES;
+  self.buffer.length = 0;
+}
+
+- (BOOL)decodeFrame:(FBBinaryFrameCursor *)cursor error:(NSError **)error
+{
+  uint8_t frameType = 0;
+  ReadUInt8(cursor, &frameType);
+  switch (frameType) {
+    case FBLogicReporterBinaryFrameTypeString:
+      return [self decodeStringFrame:cursor error:error];
+    case FBLogicReporterBinaryFrameTypeBeginTestSuite:
+      return [self decodeBeginTestSuiteFrame:cursor error:error];
+    case FBLogicReporterBinaryFrameTypeEndTestSuite:
+      return [self decodeEndTestSuiteFrame:cursor error:error];
+    case FBLogicReporterBinaryFrameTypeBeginTest:
+      return [self decodeBeginTestFrame:cursor error:error];
+    case FBLogicReporterBinaryFrameTypeEndTest:
+      return [self decodeEndTestFrame:cursor error:error];
+    case FBLogicReporterBinaryFrameTypeJSON:
+      [self.reporter handleExternalEvent:ReadRemainingString(cursor)];
+      return YES;
+    case FBLogicReporterBinaryFrameTypeEndOfStream:
+      return YES;
+    default:
+      [self.logger logFormat:@"Skipping unknown binary event frame of type %d", frameType];
+      return YES;
+  }
+}
+
+- (BOOL)decodeStringFrame:(FBBinaryFrameCursor *)cursor error:(NSError **)error
+{
+  uint32_t index = 0;
+  if (!ReadUInt32(cursor, &index)) {
+    return [self failMalformedFrame:FBLogicReporterBinaryFrameTypeString error:error];
+  }
+  if (index != self.strings.count) {
+    return [[XCTestBootstrapError
+      describeFormat:@"String defined at index %u, but the next index is %lu", index, (unsigned long) self.strings.count]
+      failBool:error];
+  }
+  NSString *string = ReadRemainingString(cursor);
+  if (!string) {
+    return [[XCTestBootstrapError
+      describeFormat:@"String at index %u is not valid UTF8", index]
+      failBool:error];
+  }
+  [self.strings addObject:string];
+  return YES;
+}
+
+- (BOOL)decodeBeginTestSuiteFrame:(FBBinaryFrameCursor *)cursor error:(NSError **)error
+{
+  double timestamp = 0;
+  NSString *suite = nil;
+  if (!ReadDouble(cursor, &timestamp) || !(suite = [self readString:cursor])) {
+    return [self failMalformedFrame:FBLogicReporterBinaryFrameTypeBeginTestSuite error:error];
+  }
+  [self.reporter testSuite:suite didStartAt:@(timestamp).stringValue];
+  return YES;
+}
+
+- (BOOL)decodeEndTestSuiteFrame:(FBBinaryFrameCursor *)cursor error:(NSError **)error
+{
+  double timestamp = 0;
+  NSString *suite = nil;
+  uint32_t testCaseCount = 0;
+  uint32_t totalFailureCount = 0;
+  uint32_t unexpectedExceptionCount = 0;
+  double testDuration = 0;
+  double totalDuration = 0;
+  if (!ReadDouble(cursor, &timestamp)
+    || !(suite = [self readString:cursor])
+    || !ReadUInt32(cursor, &testCaseCount)
+    || !ReadUInt32(cursor, &totalFailureCount)
+    || !ReadUInt32(cursor, &unexpectedExceptionCount)
+    || !ReadDouble(cursor, &testDuration)
+    || !ReadDouble(cursor, &totalDuration)) {
+    return [self failMalformedFrame:FBLogicReporterBinaryFrameTypeEndTestSuite error:error];
+  }
+  FBTestManagerResultSummary *summary = [[FBTestManagerResultSummary alloc]
+    initWithTestSuite:suite
+    finishTime:[NSDate dateWithTimeIntervalSince1970:timestamp]
+    runCount:testCaseCount
+    failureCount:totalFailureCount
+    unexpected:unexpectedExceptionCount
+    testDuration:testDuration
+    totalDuration:totalDuration];
+  [self.reporter finishedWithSummary:summary];
+  return YES;
+}
+
+- (BOOL)decodeBeginTestFrame:(FBBinaryFrameCursor *)cursor error:(NSError **)error
+{
+  double timestamp = 0;
+  NSString *testClass = nil;
+  NSString *method = nil;
+  if (!ReadDouble(cursor, &timestamp)
+    || !(testClass = [self readString:cursor])
+    || !(method = [self readString:cursor])) {
+    return [self failMalformedFrame:FBLogicReporterBinaryFrameTypeBeginTest error:error];
+  }
+  [self.reporter testCaseDidStartForTestClass:testClass method:method];
+  return YES;
+}
+
+- (BOOL)decodeEndTestFrame:(FBBinaryFrameCursor *)cursor error:(NSError **)error
+{
+  double timestamp = 0;
+  NSString *testClass = nil;
+  NSString *method = nil;
+  uint8_t result = 0;
+  double duration = 0;
+  uint8_t hasFailure = 0;
+  if (!ReadDouble(cursor, &timestamp)
+    || !(testClass = [self readString:cursor])
+    || !(method = [self readString:cursor])
+    || !ReadUInt8(cursor, &result)
+    || !ReadDouble(cursor, &duration)
+    || !ReadUInt8(cursor, &hasFailure)) {
+    return [self failMalformedFrame:FBLogicReporterBinaryFrameTypeEndTest error:error];
+  }
+
+  id<FBXCTestReporter> reporter = self.reporter;
+  switch (result) {
+    case FBLogicReporterBinaryTestResultSuccess:
+      [reporter testCaseDidFinishForTestClass:testClass method:method withStatus:FBTestReportStatusPassed duration:duration];
+      return YES;
+    case FBLogicReporterBinaryTestResultFailure:
+    case FBLogicReporterBinaryTestResultError:
+      break;
+    default:
+      return [[XCTestBootstrapError
+        describeFormat:@"Unknown test result %d for %@/%@", result, testClass, method]
+        failBool:error];
+  }
+
+  // As with JSON events, a failing test is always reported as a failure, even when there is no exception to describe it.
+  NSString *file = @"";
+  uint32_t line = 0;
+  NSString *message = @"";
+  if (hasFailure) {
+    if (!(file = [self readString:cursor]) || !ReadUInt32(cursor, &line)) {
+      return [self failMalformedFrame:FBLogicReporterBinaryFrameTypeEndTest error:error];
+    }
+    message = ReadRemainingString(cursor) ?: @"";
+  }
+  [reporter testCaseDidFailForTestClass:testClass method:method withMessage:message file:file line:line];
+  [reporter testCaseDidFinishForTestClass:testClass method:method withStatus:FBTestReportStatusFailed duration:duration];
+  return YES;
+}
+
+- (nullable NSString *)readString:(FBBinaryFrameCursor *)cursor
+{
+  uint32_t index = 0;
+  if (!ReadUInt32(cursor, &index) || index >= self.strings.count) {
+    return nil;
+  }
+  return self.strings[index];
+}
+
+- (BOOL)failMalformedFrame:(FBLogicReporterBinaryFrameType)frameType error:(NSError **)error
+{
+  return [[XCTestBootstrapError
+    describeFormat:@"Binary event frame of type %d is truncated or references an undefined string", frameType]
+    failBool:error];
+}
+
+@end
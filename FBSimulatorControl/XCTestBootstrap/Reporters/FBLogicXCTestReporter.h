@@ -55,4 +55,14 @@
  */
 - (void)didCrashDuringTest:(NSError *)error;
 
+@optional
+
+/**
+ Called when events arrive from a shim that has been opted into binary framing.
+ The chunks are contiguous, but are not aligned to frame boundaries.
+
+ @param data a chunk of the binary event stream.
+ */
+- (void)handleEventBinaryData:(NSData *)data;
+
 @end
@@ -8,6 +8,7 @@
  */
 
 #import "FBLogicTestRunStrategy.h"
+#import "FBLogicReporterBinaryDecoder.h"
 #import "FBLogicXCTestReporter.h"
 
 #import <sys/types.h>
@@ -105,6 +106,10 @@ static NSTimeInterval EndOfFileFromStopReadingTimeout = 5;
     @"FB_TEST_TIMEOUT": @(self.configuration.testTimeout).stringValue,
   }];
   [environment addEntriesFromDictionary:self.configuration.processUnderTestEnvironment];
+  [environment removeObjectForKey:FBLogicReporterBinaryEventsEnvironmentKey];
+  if (self.binaryEventsEnabled) {
+    environment[FBLogicReporterBinaryEventsEnvironmentKey] = @"1";
+  }
 
   // Get the Launch Path and Arguments for the xctest process.
   NSString *testSpecifier = self.configuration.testFilters.firstObject ?: @"All";
@@ -188,6 +193,13 @@ static NSTimeInterval EndOfFileFromStopReadingTimeout = 5;
     }];
 }
 
+// Binary events are opted into from the environment, but only when the reporter is able to decode them.
+- (BOOL)binaryEventsEnabled
+{
+  NSString *binaryEvents = self.configuration.processUnderTestEnvironment[FBLogicReporterBinaryEventsEnvironmentKey] ?: NSProcessInfo.processInfo.environment[FBLogicReporterBinaryEventsEnvironmentKey];
+  return [binaryEvents isEqualToString:@"1"] && [self.reporter respondsToSelector:@selector(handleEventBinaryData:)];
+}
+
 - (FBFuture<NSArray<id<FBDataConsumerLifecycle>> *> *)buildOutputsForUUID:(NSUUID *)udid
 {
   id<FBLogicXCTestReporter> reporter = self.reporter;
@@ -201,9 +213,8 @@ static NSTimeInterval EndOfFileFromStopReadingTimeout = 5;
   NSMutableArray<id<FBDataConsumer>> *stdOutConsumers = [NSMutableArray array];
   NSMutableArray<id<FBDataConsumer>> *stdErrConsumers = [NSMutableArray array];
 
-  id<FBDataConsumer> shimReportingConsumer = [FBLineDataConsumer asynchronousReaderWithQueue:queue dataConsumer:^(NSData *line) {
-    [reporter handleEventJSONData:line];
-  }];
+  // The shim writes JSON lines by default, or binary frames when opted in via the environment.
+  id<FBDataConsumer> shimReportingConsumer = [FBLogicReporterBinaryDecoder shimOutputConsumerForReporter:reporter queue:queue];
   [shimConsumers addObject:shimReportingConsumer];
 
   id<FBDataConsumer> stdOutReportingConsumer = [FBLineDataConsumer asynchronousReaderWithQueue:queue consumer:^(NSString *line){
@@ -217,7 +228,10 @@ static NSTimeInterval EndOfFileFromStopReadingTimeout = 5;
   [stdErrConsumers addObject:stdErrReportingConsumer];
 
   if (mirrorToLogger) {
-    [shimConsumers addObject:[FBLoggingDataConsumer consumerWithLogger:logger]];
+    // Binary frames are not text, so only the JSON shim output is mirrored to the logger.
+    if (!self.binaryEventsEnabled) {
+      [shimConsumers addObject:[FBLoggingDataConsumer consumerWithLogger:logger]];
+    }
     [stdErrConsumers addObject:[FBLoggingDataConsumer consumerWithLogger:logger]];
     [stdErrConsumers addObject:[FBLoggingDataConsumer consumerWithLogger:logger]];
   }
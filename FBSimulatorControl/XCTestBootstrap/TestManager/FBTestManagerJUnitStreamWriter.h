@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBTestManagerResultSummary;
+@class FBTestManagerTestReporterTestCaseFailure;
+
+/**
+ Incrementally writes the JUnit XML format to a file, without building a tree of all of the Test Suites and Test Cases.
+
+ Each <testcase> element is appended to the file as soon as the Test Case finishes.
+ The only part of the document that depends on later events is the opening <testsuite> tag, as it contains the counts for the suite.
+ This tag is written with placeholder counts and enough trailing whitespace for the final counts, then overwritten in place when the suite finishes.
+ Memory usage is therefore proportional to the depth of the running Test Suites, not to the number of Test Cases.
+
+ The output is equivalent to the pretty-printed document of FBTestManagerJUnitGenerator, except for whitespace before the closing bracket of <testsuite> tags.
+ */
+@interface FBTestManagerJUnitStreamWriter : NSObject
+
+#pragma mark Initializers
+
+/**
+ Constructs a JUnit Stream Writer.
+
+ @param filePath the path of the file to write the JUnit XML document to. Any existing file is replaced.
+ @param packagePrefix the package prefix to prepend on each test case class name, may be nil.
+ @param error an error out for any error in creating the file.
+ @return a new JUnit Stream Writer on success, nil otherwise.
+ */
++ (nullable instancetype)writerForFilePath:(NSString *)filePath packagePrefix:(nullable NSString *)packagePrefix error:(NSError **)error;
+
+#pragma mark Public Methods
+
+/**
+ Starts a Test Suite, nested within the currently running Test Suite, if there is one.
+
+ @param testSuite the name of the Test Suite.
+ */
+- (void)startTestSuite:(NSString *)testSuite;
+
+/**
+ Writes a finished Test Case in the currently running Test Suite.
+
+ @param testClass the class of the Test Case.
+ @param method the method of the Test Case.
+ @param duration the duration of the Test Case.
+ @param failures the failures of the Test Case.
+ */
+- (void)finishTestCaseForTestClass:(NSString *)testClass method:(NSString *)method duration:(NSTimeInterval)duration failures:(NSArray<FBTestManagerTestReporterTestCaseFailure *> *)failures;
+
+/**
+ Finishes the currently running Test Suite.
+
+ @param summary the summary of the Test Suite.
+ */
+- (void)finishTestSuiteWithSummary:(FBTestManagerResultSummary *)summary;
+
+/**
+ Completes the document and closes the file.
+ Any Test Suites that have not been finished are closed using the counts of the Test Cases that have been written.
+
+ @param error an error out for any error in writing the file.
+ @return YES if successful, NO otherwise.
+ */
+- (BOOL)finishWithError:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,304 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBTestManagerJUnitStreamWriter.h"
+
+#import <errno.h>
+#import <fcntl.h>
+#import <string.h>
+#import <unistd.h>
+
+#import "FBTestManagerResultSummary.h"
+#import "FBTestManagerTestReporterTestCaseFailure.h"
+#import "XCTestBootstrapError.h"
+
+static NSString *const FBJUnitStreamHeader = @"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<testsuites>";
+static NSString *const FBJUnitStreamFooter = @"</testsuites>";
+
+// Room for the widest counts and time of a <testsuite> tag, over the placeholder values that are first written.
+static const NSUInteger FBJUnitStreamReservedAttributeLength = 3 * 20 + 32;
+
+static NSString *FBJUnitIndentation(NSUInteger depth)
+{
+  return [@"" stringByPaddingToLength:depth * 4 withString:@" " startingAtIndex:0];
+}
+
+static NSString *FBJUnitEscapeText(NSString *string)
+{
+  if (!string) {
+    return @"";
+  }
+  NSMutableString *escaped = [string mutableCopy];
+  [escaped replaceOccurrencesOfString:@"&" withString:@"&amp;" options:NSLiteralSearch range:NSMakeRange(0, escaped.length)];
+  [escaped replaceOccurrencesOfString:@"<" withString:@"&lt;" options:NSLiteralSearch range:NSMakeRange(0, escaped.length)];
+  [escaped replaceOccurrencesOfString:@">" withString:@"&gt;" options:NSLiteralSearch range:NSMakeRange(0, escaped.length)];
+  [escaped replaceOccurrencesOfString:@"\r" withString:@"&#xD;" options:NSLiteralSearch range:NSMakeRange(0, escaped.length)];
+  return escaped;
+}
+
+static NSString *FBJUnitEscapeAttribute(NSString *string)
+{
+  NSMutableString *escaped = [FBJUnitEscapeText(string) mutableCopy];
+  [escaped replaceOccurrencesOfString:@"\"" withString:@"&quot;" options:NSLiteralSearch range:NSMakeRange(0, escaped.length)];
+  [escaped replaceOccurrencesOfString:@"\n" withString:@"&#xA;" options:NSLiteralSearch range:NSMakeRange(0, escaped.length)];
+  [escaped replaceOccurrencesOfString:@"\t" withString:@"&#x9;" options:NSLiteralSearch range:NSMakeRange(0, escaped.length)];
+  return escaped;
+}
+
+/**
+ A Test Suite that has been started, but not finished.
+ */
+@interface FBTestManagerJUnitStreamSuite : NSObject
+
+@property (nonatomic, copy, readonly) NSString *name;
+@property (nonatomic, assign, readonly) NSUInteger depth;
+@property (nonatomic, assign, readonly) off_t offset;
+@property (nonatomic, assign, readonly) NSUInteger openingTagLength;
+@property (nonatomic, assign, readwrite) BOOL hasChildren;
+@property (nonatomic, assign, readwrite) NSInteger runCount;
+@property (nonatomic, assign, readwrite) NSInteger failureCount;
+@property (nonatomic, assign, readwrite) NSTimeInterval duration;
+
+@end
+
+@implementation FBTestManagerJUnitStreamSuite
+
+- (instancetype)initWithName:(NSString *)name depth:(NSUInteger)depth offset:(off_t)offset openingTagLength:(NSUInteger)openingTagLength
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _name = name;
+  _depth = depth;
+  _offset = offset;
+  _openingTagLength = openingTagLength;
+
+  return self;
+}
+
+@end
+
+@interface FBTestManagerJUnitStreamWriter ()
+
+@property (nonatomic, copy, nullable, readonly) NSString *packagePrefix;
+@property (nonatomic, strong, readonly) NSMutableArray<FBTestManagerJUnitStreamSuite *> *runningSuites;
+@property (nonatomic, assign, readwrite) int fileDescriptor;
+@property (nonatomic, assign, readwrite) off_t length;
+@property (nonatomic, assign, readwrite) BOOL hasSuites;
+@property (nonatomic, strong, nullable, readwrite) NSError *writeError;
+
+@end
+
+@implementation FBTestManagerJUnitStreamWriter
+
+#pragma mark Initializers
+
++ (nullable instancetype)writerForFilePath:(NSString *)filePath packagePrefix:(nullable NSString *)packagePrefix error:(NSError **)error
+{
+  int fileDescriptor = open(filePath.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fileDescriptor == -1) {
+    return [[XCTestBootstrapError
+      describeFormat:@"Could not open the JUnit output file %@: %s", filePath, strerror(errno)]
+      fail:error];
+  }
+  FBTestManagerJUnitStreamWriter *writer = [[self alloc] initWithFileDescriptor:fileDescriptor packagePrefix:packagePrefix];
+  [writer append:FBJUnitStreamHeader];
+  if (writer.writeError) {
+    return [XCTestBootstrapError failWithError:writer.writeError errorOut:error];
+  }
+  return writer;
+}
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor packagePrefix:(nullable NSString *)packagePrefix
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _fileDescriptor = fileDescriptor;
+  _packagePrefix = packagePrefix;
+  _runningSuites = [NSMutableArray array];
+
+  return self;
+}
+
+- (void)dealloc
+{
+  if (_fileDescriptor != -1) {
+    close(_fileDescriptor);
+  }
+}
+
+#pragma mark Public Methods
+
+- (void)startTestSuite:(NSString *)testSuite
+{
+  if (!self.hasSuites) {
+    self.hasSuites = YES;
+    [self append:@"\n"];
+  }
+  self.runningSuites.lastObject.hasChildren = YES;
+
+  // The counts are not known until the suite finishes, so placeholders are written with enough room for the final values.
+  NSUInteger depth = self.runningSuites.count + 1;
+  NSString *openingTag = [NSString stringWithFormat:
+    @"%@%@>\n",
+    [self openingTagForName:testSuite depth:depth runCount:0 failureCount:0 errorCount:0 duration:0],
+    [@"" stringByPaddingToLength:FBJUnitStreamReservedAttributeLength withString:@" " startingAtIndex:0]
+  ];
+  off_t offset = self.length;
+  NSUInteger openingTagLength = [self append:openingTag];
+  [self.runningSuites addObject:[[FBTestManagerJUnitStreamSuite alloc] initWithName:testSuite depth:depth offset:offset openingTagLength:openingTagLength]];
+}
+
+- (void)finishTestCaseForTestClass:(NSString *)testClass method:(NSString *)method duration:(NSTimeInterval)duration failures:(NSArray<FBTestManagerTestReporterTestCaseFailure *> *)failures
+{
+  FBTestManagerJUnitStreamSuite *suite = self.runningSuites.lastObject;
+  if (!suite) {
+    return;
+  }
+  suite.hasChildren = YES;
+  for (FBTestManagerJUnitStreamSuite *runningSuite in self.runningSuites) {
+    runningSuite.runCount += 1;
+    runningSuite.failureCount += failures.count > 0 ? 1 : 0;
+    runningSuite.duration += duration;
+  }
+
+  NSString *className = self.packagePrefix.length ? [NSString stringWithFormat:@"%@.%@", self.packagePrefix, testClass] : testClass;
+  NSUInteger depth = suite.depth + 1;
+  NSMutableString *element = [NSMutableString stringWithFormat:
+    @"%@<testcase classname=\"%@\" name=\"%@\" time=\"%@\">",
+    FBJUnitIndentation(depth),
+    FBJUnitEscapeAttribute(className),
+    FBJUnitEscapeAttribute(method),
+    @(duration).stringValue
+  ];
+  if (failures.count == 0) {
+    [element appendString:@"</testcase>\n"];
+  } else {
+    [element appendString:@"\n"];
+    for (FBTestManagerTestReporterTestCaseFailure *failure in failures) {
+      NSString *location = [NSString stringWithFormat:@"%@:%zd", failure.file, failure.line];
+      [element appendFormat:
+        @"%@<failure type=\"Failure\" message=\"%@\">%@</failure>\n",
+        FBJUnitIndentation(depth + 1),
+        FBJUnitEscapeAttribute(failure.message),
+        FBJUnitEscapeText(location)
+      ];
+    }
+    [element appendFormat:@"%@</testcase>\n", FBJUnitIndentation(depth)];
+  }
+  [self append:element];
+}
+
+- (void)finishTestSuiteWithSummary:(FBTestManagerResultSummary *)summary
+{
+  FBTestManagerJUnitStreamSuite *suite = self.runningSuites.lastObject;
+  if (!suite) {
+    return;
+  }
+  [self finishTestSuite:suite runCount:summary.runCount failureCount:summary.failureCount errorCount:summary.unexpected duration:summary.totalDuration];
+}
+
+- (BOOL)finishWithError:(NSError **)error
+{
+  if (self.fileDescriptor == -1) {
+    return [[XCTestBootstrapError
+      describe:@"The JUnit output has already been finished"]
+      failBool:error];
+  }
+  while (self.runningSuites.count > 0) {
+    FBTestManagerJUnitStreamSuite *suite = self.runningSuites.lastObject;
+    [self finishTestSuite:suite runCount:suite.runCount failureCount:suite.failureCount errorCount:0 duration:suite.duration];
+  }
+  [self append:FBJUnitStreamFooter];
+  if (!self.writeError && close(self.fileDescriptor) != 0) {
+    self.writeError = [[XCTestBootstrapError describeFormat:@"Failed to close the JUnit output file: %s", strerror(errno)] build];
+  }
+  self.fileDescriptor = -1;
+  if (self.writeError) {
+    return [[[XCTestBootstrapError
+      describe:@"Failed to write the JUnit output file"]
+      causedBy:self.writeError]
+      failBool:error];
+  }
+  return YES;
+}
+
+#pragma mark Private
+
+- (NSString *)openingTagForName:(NSString *)name depth:(NSUInteger)depth runCount:(NSInteger)runCount failureCount:(NSInteger)failureCount errorCount:(NSInteger)errorCount duration:(NSTimeInterval)duration
+{
+  return [NSString stringWithFormat:
+    @"%@<testsuite tests=\"%@\" failures=\"%@\" errors=\"%@\" time=\"%@\" name=\"%@\"",
+    FBJUnitIndentation(depth),
+    @(runCount).stringValue,
+    @(failureCount).stringValue,
+    @(errorCount).stringValue,
+    @(duration).stringValue,
+    FBJUnitEscapeAttribute(name)
+  ];
+}
+
+- (void)finishTestSuite:(FBTestManagerJUnitStreamSuite *)suite runCount:(NSInteger)runCount failureCount:(NSInteger)failureCount errorCount:(NSInteger)errorCount duration:(NSTimeInterval)duration
+{
+  [self.runningSuites removeLastObject];
+
+  NSString *openingTag = [self openingTagForName:suite.name depth:suite.depth runCount:runCount failureCount:failureCount errorCount:errorCount duration:duration];
+  if (!suite.hasChildren) {
+    // Nothing has been written after the placeholder, so the whole suite can be re-written on one line.
+    if (!self.writeError && ftruncate(self.fileDescriptor, suite.offset) != 0) {
+      self.writeError = [[XCTestBootstrapError describeFormat:@"Failed to truncate the JUnit output file: %s", strerror(errno)] build];
+    }
+    self.length = suite.offset;
+    [self append:[openingTag stringByAppendingString:@"></testsuite>\n"]];
+    return;
+  }
+  // The final tag is padded with whitespace before the closing bracket, so that it exactly overwrites the placeholder.
+  NSData *tagData = [openingTag dataUsingEncoding:NSUTF8StringEncoding];
+  NSMutableData *data = [NSMutableData dataWithLength:suite.openingTagLength];
+  memset(data.mutableBytes, ' ', data.length);
+  memcpy(data.mutableBytes, tagData.bytes, MIN(tagData.length, data.length - 2));
+  memcpy((uint8_t *) data.mutableBytes + data.length - 2, ">\n", 2);
+  [self writeData:data atOffset:suite.offset];
+  [self append:[NSString stringWithFormat:@"%@</testsuite>\n", FBJUnitIndentation(suite.depth)]];
+}
+
+- (NSUInteger)append:(NSString *)string
+{
+  NSData *data = [string dataUsingEncoding:NSUTF8StringEncoding];
+  [self writeData:data atOffset:self.length];
+  self.length += (off_t) data.length;
+  return data.length;
+}
+
+- (void)writeData:(NSData *)data atOffset:(off_t)offset
+{
+  if (self.writeError) {
+    return;
+  }
+  const uint8_t *bytes = data.bytes;
+  size_t written = 0;
+  while (written < data.length) {
+    ssize_t result = pwrite(self.fileDescriptor, bytes + written, data.length - written, offset + (off_t) written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      self.writeError = [[XCTestBootstrapError describeFormat:@"Failed to write %lu bytes to the JUnit output file: %s", (unsigned long) data.length, strerror(errno)] build];
+      return;
+    }
+    written += (size_t) result;
+  }
+}
+
+@end
@@ -28,6 +28,12 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) FBTestManagerTestReporterTestSuite *testSuite;
 
+/**
+ Whether finished Test Cases are added to the Test Suites, defaults to YES.
+ Subclasses that write each Test Case as it finishes can return NO, so that only the Test Suites and their summaries are kept.
+ */
+@property (nonatomic, assign, readonly) BOOL retainsTestCases;
+
 @end
 
 NS_ASSUME_NONNULL_END
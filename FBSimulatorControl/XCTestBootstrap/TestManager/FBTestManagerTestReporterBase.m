@@ -23,6 +23,13 @@
 
 @implementation FBTestManagerTestReporterBase
 
+#pragma mark - Properties
+
+- (BOOL)retainsTestCases
+{
+  return YES;
+}
+
 #pragma mark - FBTestManagerTestReporter
 
 - (void)testManagerMediator:(FBTestManagerAPIMediator *)mediator
@@ -61,7 +68,9 @@
   FBTestManagerTestReporterTestCase *testCase =
       [FBTestManagerTestReporterTestCase withTestClass:testClass method:method];
   self.currentTestCase = testCase;
-  [self.currentTestSuite addTestCase:testCase];
+  if (self.retainsTestCases) {
+    [self.currentTestSuite addTestCase:testCase];
+  }
 }
 
 - (void)testManagerMediator:(FBTestManagerAPIMediator *)mediator
@@ -16,6 +16,9 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  A Test Reporter that implements the FBTestManagerTestReporter interface.
  It writes the Test Result to a given File Handle in the JUnit XML format.
+ Test Cases are streamed to a '.partial' sibling of the output file with FBTestManagerJUnitStreamWriter as they finish.
+ The partial file is moved into place when the Test Plan finishes, so the output file is replaced atomically.
+ Test Cases are not retained in the Test Suites once they have been written.
  */
 @interface FBTestManagerTestReporterJUnit : FBTestManagerTestReporterBase
 
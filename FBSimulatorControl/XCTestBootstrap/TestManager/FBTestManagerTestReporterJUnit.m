@@ -8,11 +8,17 @@
  */
 
 #import "FBTestManagerTestReporterJUnit.h"
-#import "FBTestManagerJUnitGenerator.h"
+
+#import <FBControlCore/FBControlCore.h>
+
+#import "FBTestManagerJUnitStreamWriter.h"
+#import "FBTestManagerTestReporterTestCaseFailure.h"
 
 @interface FBTestManagerTestReporterJUnit ()
 
 @property (nonatomic, strong) NSURL *outputFileURL;
+@property (nonatomic, strong, nullable) FBTestManagerJUnitStreamWriter *writer;
+@property (nonatomic, strong, nullable) NSMutableArray<FBTestManagerTestReporterTestCaseFailure *> *currentTestCaseFailures;
 
 @end
 
@@ -35,14 +41,110 @@
   return self;
 }
 
+#pragma mark - Properties
+
+- (BOOL)retainsTestCases
+{
+  // Test Cases are written by the stream writer as they finish, so only the Test Suites need to be kept.
+  return NO;
+}
+
 #pragma mark - FBTestManagerTestReporter
 
+- (void)testManagerMediator:(FBTestManagerAPIMediator *)mediator
+                  testSuite:(NSString *)testSuite
+                 didStartAt:(NSString *)startTime
+{
+  [super testManagerMediator:mediator testSuite:testSuite didStartAt:startTime];
+
+  [self.streamWriter startTestSuite:testSuite];
+}
+
+- (void)testManagerMediator:(FBTestManagerAPIMediator *)mediator
+    testCaseDidStartForTestClass:(NSString *)testClass
+                          method:(NSString *)method
+{
+  [super testManagerMediator:mediator testCaseDidStartForTestClass:testClass method:method];
+
+  self.currentTestCaseFailures = [NSMutableArray array];
+}
+
+- (void)testManagerMediator:(FBTestManagerAPIMediator *)mediator
+    testCaseDidFinishForTestClass:(NSString *)testClass
+                           method:(NSString *)method
+                       withStatus:(FBTestReportStatus)status
+                         duration:(NSTimeInterval)duration
+{
+  [super testManagerMediator:mediator testCaseDidFinishForTestClass:testClass method:method withStatus:status duration:duration];
+
+  [self.streamWriter finishTestCaseForTestClass:testClass method:method duration:duration failures:self.currentTestCaseFailures ?: @[]];
+  self.currentTestCaseFailures = nil;
+}
+
+- (void)testManagerMediator:(FBTestManagerAPIMediator *)mediator
+    testCaseDidFailForTestClass:(NSString *)testClass
+                         method:(NSString *)method
+                    withMessage:(NSString *)message
+                           file:(NSString *)file
+                           line:(NSUInteger)line
+{
+  [super testManagerMediator:mediator testCaseDidFailForTestClass:testClass method:method withMessage:message file:file line:line];
+
+  [self.currentTestCaseFailures addObject:[FBTestManagerTestReporterTestCaseFailure withMessage:message file:file line:line]];
+}
+
+- (void)testManagerMediator:(FBTestManagerAPIMediator *)mediator
+        finishedWithSummary:(FBTestManagerResultSummary *)summary
+{
+  [super testManagerMediator:mediator finishedWithSummary:summary];
+
+  [self.streamWriter finishTestSuiteWithSummary:summary];
+}
+
 - (void)testManagerMediatorDidFinishExecutingTestPlan:(FBTestManagerAPIMediator *)mediator
 {
   [super testManagerMediatorDidFinishExecutingTestPlan:mediator];
 
-  NSXMLDocument *document = [FBTestManagerJUnitGenerator documentForTestSuite:self.testSuite];
-  [[document XMLDataWithOptions:NSXMLNodePrettyPrint] writeToURL:self.outputFileURL atomically:YES];
+  FBTestManagerJUnitStreamWriter *writer = self.streamWriter;
+  if (!writer) {
+    return;
+  }
+  NSError *error = nil;
+  BOOL success = [writer finishWithError:&error];
+  self.writer = nil;
+
+  NSString *partialPath = self.partialFilePath;
+  if (!success) {
+    [FBControlCoreGlobalConfiguration.defaultLogger.error logFormat:@"Could not write the JUnit output: %@", error];
+    [NSFileManager.defaultManager removeItemAtPath:partialPath error:nil];
+    return;
+  }
+  if (rename(partialPath.fileSystemRepresentation, self.outputFileURL.path.fileSystemRepresentation) != 0) {
+    [FBControlCoreGlobalConfiguration.defaultLogger.error logFormat:@"Could not move the JUnit output to %@: %s", self.outputFileURL.path, strerror(errno)];
+  }
+}
+
+#pragma mark Private
+
+- (NSString *)partialFilePath
+{
+  return [self.outputFileURL.path stringByAppendingPathExtension:@"partial"];
+}
+
+- (nullable FBTestManagerJUnitStreamWriter *)streamWriter
+{
+  if (self.writer) {
+    return self.writer;
+  }
+  // Output is streamed to a sibling of the output file which is moved into place when finished, so the output file is replaced atomically.
+  NSError *error = nil;
+  FBTestManagerJUnitStreamWriter *writer = [FBTestManagerJUnitStreamWriter writerForFilePath:self.partialFilePath packagePrefix:nil error:&error];
+  if (!writer) {
+    [FBControlCoreGlobalConfiguration.defaultLogger.error logFormat:@"Could not create the JUnit writer: %@", error];
+    return nil;
+  }
+  self.writer = writer;
+  return writer;
 }
 
 @end
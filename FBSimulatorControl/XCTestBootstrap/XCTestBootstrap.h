@@ -23,6 +23,7 @@
 #import <XCTestBootstrap/FBTestManager.h>
 #import <XCTestBootstrap/FBTestManagerAPIMediator.h>
 #import <XCTestBootstrap/FBTestManagerJUnitGenerator.h>
+#import <XCTestBootstrap/FBTestManagerJUnitStreamWriter.h>
 #import <XCTestBootstrap/FBTestManagerResult.h>
 #import <XCTestBootstrap/FBTestManagerResultSummary.h>
 #import <XCTestBootstrap/FBTestManagerTestReporter.h>
@@ -43,6 +44,7 @@
 #import <XCTestBootstrap/FBXCTestReporter.h>
 #import <XCTestBootstrap/FBXCTestReporterAdapter.h>
 #import <XCTestBootstrap/FBLogicReporterAdapter.h>
+#import <XCTestBootstrap/FBLogicReporterBinaryDecoder.h>
 #import <XCTestBootstrap/FBXCTestRunner.h>
 #import <XCTestBootstrap/FBXCTestRunStrategy.h>
 #import <XCTestBootstrap/FBXCTestShimConfiguration.h>
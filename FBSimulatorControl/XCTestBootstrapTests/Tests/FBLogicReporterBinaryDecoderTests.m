@@ -0,0 +1,288 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <libkern/OSByteOrder.h>
+
+#import <XCTestBootstrap/FBLogicReporterAdapter.h>
+#import <XCTestBootstrap/FBLogicReporterBinaryDecoder.h>
+#import <XCTestBootstrap/FBXCTestReporter.h>
+#import <XCTestBootstrap/FBTestManagerResultSummary.h>
+#import <OCMock/OCMock.h>
+
+/**
+ Builds a binary event stream, in the same way as the reporter shim.
+ */
+@interface FBLogicReporterBinaryEventWriter : NSObject
+
+@property (nonatomic, strong, readonly) NSMutableData *data;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSNumber *> *strings;
+
+- (void)appendFrame:(FBLogicReporterBinaryFrameType)type payload:(NSData *)payload;
+
+@end
+
+@implementation FBLogicReporterBinaryEventWriter
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _data = [NSMutableData dataWithBytes:FBLogicReporterBinaryMagic length:sizeof(FBLogicReporterBinaryMagic)];
+  _strings = [NSMutableDictionary dictionary];
+
+  return self;
+}
+
+- (void)appendFrame:(FBLogicReporterBinaryFrameType)type payload:(NSData *)payload
+{
+  uint32_t length = OSSwapHostToLittleInt32((uint32_t) payload.length + 1);
+  [self.data appendBytes:&length length:sizeof(length)];
+  [self.data appendBytes:&type length:sizeof(type)];
+  [self.data appendData:payload];
+}
+
+- (void)appendUInt8:(uint8_t)value to:(NSMutableData *)payload
+{
+  [payload appendBytes:&value length:sizeof(value)];
+}
+
+- (void)appendUInt32:(uint32_t)value to:(NSMutableData *)payload
+{
+  value = OSSwapHostToLittleInt32(value);
+  [payload appendBytes:&value length:sizeof(value)];
+}
+
+- (void)appendDouble:(double)value to:(NSMutableData *)payload
+{
+  uint64_t raw = 0;
+  memcpy(&raw, &value, sizeof(raw));
+  raw = OSSwapHostToLittleInt64(raw);
+  [payload appendBytes:&raw length:sizeof(raw)];
+}
+
+- (void)appendString:(NSString *)string to:(NSMutableData *)payload
+{
+  NSNumber *index = self.strings[string];
+  if (!index) {
+    index = @(self.strings.count);
+    self.strings[string] = index;
+    NSMutableData *definition = [NSMutableData data];
+    [self appendUInt32:index.unsignedIntValue to:definition];
+    [definition appendData:[string dataUsingEncoding:NSUTF8StringEncoding]];
+    [self appendFrame:FBLogicReporterBinaryFrameTypeString payload:definition];
+  }
+  [self appendUInt32:index.unsignedIntValue to:payload];
+}
+
+- (void)beginTestSuite:(NSString *)suite
+{
+  NSMutableData *payload = [NSMutableData data];
+  [self appendDouble:1510917478 to:payload];
+  [self appendString:suite to:payload];
+  [self appendFrame:FBLogicReporterBinaryFrameTypeBeginTestSuite payload:payload];
+}
+
+- (void)endTestSuite:(NSString *)suite testCount:(uint32_t)testCount failureCount:(uint32_t)failureCount
+{
+  NSMutableData *payload = [NSMutableData data];
+  [self appendDouble:1510917478.5 to:payload];
+  [self appendString:suite to:payload];
+  [self appendUInt32:testCount to:payload];
+  [self appendUInt32:failureCount to:payload];
+  [self appendUInt32:0 to:payload];
+  [self appendDouble:0.25 to:payload];
+  [self appendDouble:0.5 to:payload];
+  [self appendFrame:FBLogicReporterBinaryFrameTypeEndTestSuite payload:payload];
+}
+
+- (void)beginTestClass:(NSString *)testClass method:(NSString *)method
+{
+  NSMutableData *payload = [NSMutableData data];
+  [self appendDouble:1510917478 to:payload];
+  [self appendString:testClass to:payload];
+  [self appendString:method to:payload];
+  [self appendFrame:FBLogicReporterBinaryFrameTypeBeginTest payload:payload];
+}
+
+- (void)endTestClass:(NSString *)testClass method:(NSString *)method result:(FBLogicReporterBinaryTestResult)result duration:(double)duration file:(NSString *)file line:(uint32_t)line message:(NSString *)message
+{
+  NSMutableData *payload = [NSMutableData data];
+  [self appendDouble:1510917478 to:payload];
+  [self appendString:testClass to:payload];
+  [self appendString:method to:payload];
+  [self appendUInt8:result to:payload];
+  [self appendDouble:duration to:payload];
+  [self appendUInt8:(message != nil) to:payload];
+  if (message) {
+    [self appendString:file to:payload];
+    [self appendUInt32:line to:payload];
+    [payload appendData:[message dataUsingEncoding:NSUTF8StringEncoding]];
+  }
+  [self appendFrame:FBLogicReporterBinaryFrameTypeEndTest payload:payload];
+}
+
+@end
+
+@interface FBLogicReporterBinaryDecoderTests : XCTestCase
+
+@property (nonatomic, strong, nullable, readwrite) OCMockObject *reporterMock;
+@property (nonatomic, strong, nullable, readwrite) FBLogicReporterBinaryDecoder *decoder;
+@property (nonatomic, strong, nullable, readwrite) FBLogicReporterBinaryEventWriter *writer;
+
+@end
+
+@implementation FBLogicReporterBinaryDecoderTests
+
+- (void)setUp
+{
+  [super setUp];
+  self.reporterMock = [OCMockObject mockForProtocol:@protocol(FBXCTestReporter)];
+  self.decoder = [[FBLogicReporterBinaryDecoder alloc] initWithReporter:(id)self.reporterMock logger:nil];
+  self.writer = [FBLogicReporterBinaryEventWriter new];
+}
+
+- (void)testDecodesTestCaseLifecycle
+{
+  OCMockObject *mock = self.reporterMock;
+  [[mock expect] testSuite:@"NARANJA" didStartAt:[OCMArg any]];
+  [[mock expect] testCaseDidStartForTestClass:@"OmniClass" method:@"theMethod:toRule:themAll:"];
+  [[mock expect] testCaseDidFinishForTestClass:@"OmniClass" method:@"theMethod:toRule:themAll:" withStatus:FBTestReportStatusPassed duration:0.0050642];
+  [[mock expect] finishedWithSummary:[OCMArg checkWithBlock:^ BOOL (FBTestManagerResultSummary *summary) {
+    return [summary.testSuite isEqualToString:@"NARANJA"] && summary.runCount == 1 && summary.failureCount == 0;
+  }]];
+
+  [self.writer beginTestSuite:@"NARANJA"];
+  [self.writer beginTestClass:@"OmniClass" method:@"theMethod:toRule:themAll:"];
+  [self.writer endTestClass:@"OmniClass" method:@"theMethod:toRule:themAll:" result:FBLogicReporterBinaryTestResultSuccess duration:0.0050642 file:nil line:0 message:nil];
+  [self.writer endTestSuite:@"NARANJA" testCount:1 failureCount:0];
+
+  NSError *error = nil;
+  BOOL success = [self.decoder consumeData:self.writer.data error:&error];
+  XCTAssertNil(error);
+  XCTAssertTrue(success);
+  XCTAssertFalse(self.decoder.hasPartialFrame);
+  [mock verify];
+}
+
+- (void)testDecodesFailures
+{
+  OCMockObject *mock = self.reporterMock;
+  NSString *message = @"The message to win all messages";
+  [[mock expect] testCaseDidFailForTestClass:@"OmniClass" method:@"theMethod" withMessage:message file:@"dasLiebstenFeile" line:969];
+  [[mock expect] testCaseDidFinishForTestClass:@"OmniClass" method:@"theMethod" withStatus:FBTestReportStatusFailed duration:0.5];
+
+  [self.writer endTestClass:@"OmniClass" method:@"theMethod" result:FBLogicReporterBinaryTestResultFailure duration:0.5 file:@"dasLiebstenFeile" line:969 message:message];
+
+  NSError *error = nil;
+  BOOL success = [self.decoder consumeData:self.writer.data error:&error];
+  XCTAssertNil(error);
+  XCTAssertTrue(success);
+  [mock verify];
+}
+
+- (void)testDecodesFailuresWithoutAnException
+{
+  OCMockObject *mock = self.reporterMock;
+  [[mock expect] testCaseDidFailForTestClass:@"OmniClass" method:@"theMethod" withMessage:@"" file:@"" line:0];
+  [[mock expect] testCaseDidFinishForTestClass:@"OmniClass" method:@"theMethod" withStatus:FBTestReportStatusFailed duration:0.5];
+
+  [self.writer endTestClass:@"OmniClass" method:@"theMethod" result:FBLogicReporterBinaryTestResultError duration:0.5 file:nil line:0 message:nil];
+  [self.writer appendFrame:FBLogicReporterBinaryFrameTypeEndOfStream payload:NSData.data];
+
+  NSError *error = nil;
+  BOOL success = [self.decoder consumeData:self.writer.data error:&error];
+  XCTAssertNil(error);
+  XCTAssertTrue(success);
+  XCTAssertFalse(self.decoder.hasPartialFrame);
+  [mock verify];
+}
+
+- (void)testDecodesFramesSplitAcrossChunks
+{
+  OCMockObject *mock = self.reporterMock;
+  [[mock expect] testCaseDidStartForTestClass:@"OmniClass" method:@"first"];
+  [[mock expect] testCaseDidStartForTestClass:@"OmniClass" method:@"second"];
+
+  [self.writer beginTestClass:@"OmniClass" method:@"first"];
+  [self.writer beginTestClass:@"OmniClass" method:@"second"];
+
+  NSData *data = self.writer.data;
+  for (NSUInteger index = 0; index < data.length; index++) {
+    NSError *error = nil;
+    BOOL success = [self.decoder consumeData:[data subdataWithRange:NSMakeRange(index, 1)] error:&error];
+    XCTAssertNil(error);
+    XCTAssertTrue(success);
+  }
+  XCTAssertFalse(self.decoder.hasPartialFrame);
+  [mock verify];
+}
+
+- (void)testFailsForInvalidMagic
+{
+  NSError *error = nil;
+  BOOL success = [self.decoder consumeData:[@"{\"event\": \"begin-test\"}\n" dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+  XCTAssertNotNil(error);
+  XCTAssertFalse(success);
+}
+
+- (void)testFailsForInvalidFrameLengthAndRejectsFurtherData
+{
+  NSMutableData *data = [NSMutableData dataWithBytes:FBLogicReporterBinaryMagic length:sizeof(FBLogicReporterBinaryMagic)];
+  uint8_t frame[] = {0x00, 0x00, 0x00, 0x00, FBLogicReporterBinaryFrameTypeBeginTest};
+  [data appendBytes:frame length:sizeof(frame)];
+
+  NSError *error = nil;
+  BOOL success = [self.decoder consumeData:data error:&error];
+  XCTAssertNotNil(error);
+  XCTAssertFalse(success);
+  XCTAssertFalse(self.decoder.hasPartialFrame);
+
+  [self.writer beginTestClass:@"OmniClass" method:@"theMethod"];
+  error = nil;
+  success = [self.decoder consumeData:self.writer.data error:&error];
+  XCTAssertNotNil(error);
+  XCTAssertFalse(success);
+  XCTAssertFalse(self.decoder.hasPartialFrame);
+  [self.reporterMock verify];
+}
+
+- (void)testFailsForUndefinedString
+{
+  NSMutableData *data = [NSMutableData dataWithBytes:FBLogicReporterBinaryMagic length:sizeof(FBLogicReporterBinaryMagic)];
+  uint8_t frame[] = {
+    0x0d, 0x00, 0x00, 0x00, // length
+    FBLogicReporterBinaryFrameTypeBeginTestSuite,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // timestamp
+    0x07, 0x00, 0x00, 0x00, // undefined string
+  };
+  [data appendBytes:frame length:sizeof(frame)];
+
+  NSError *error = nil;
+  BOOL success = [self.decoder consumeData:data error:&error];
+  XCTAssertNotNil(error);
+  XCTAssertFalse(success);
+}
+
+- (void)testAdapterForwardsBinaryData
+{
+  OCMockObject *mock = self.reporterMock;
+  [[mock expect] testCaseDidStartForTestClass:@"OmniClass" method:@"theMethod"];
+
+  [self.writer beginTestClass:@"OmniClass" method:@"theMethod"];
+  FBLogicReporterAdapter *adapter = [[FBLogicReporterAdapter alloc] initWithReporter:(id)mock logger:nil];
+  [adapter handleEventBinaryData:self.writer.data];
+  [mock verify];
+}
+
+@end
@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <XCTestBootstrap/XCTestBootstrap.h>
+
+@interface FBTestManagerJUnitStreamWriterTests : XCTestCase
+
+@property (nonatomic, strong) FBTestManagerTestReporterBase *treeReporter;
+@property (nonatomic, strong) FBTestManagerJUnitStreamWriter *writer;
+@property (nonatomic, copy) NSString *filePath;
+@property (nonatomic, strong) NSMutableArray<FBTestManagerTestReporterTestCaseFailure *> *failures;
+
+@end
+
+@implementation FBTestManagerJUnitStreamWriterTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.treeReporter = [FBTestManagerTestReporterBase new];
+  self.filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.xml", NSUUID.UUID.UUIDString]];
+  NSError *error = nil;
+  self.writer = [FBTestManagerJUnitStreamWriter writerForFilePath:self.filePath packagePrefix:nil error:&error];
+  XCTAssertNil(error);
+  XCTAssertNotNil(self.writer);
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.filePath error:nil];
+
+  [super tearDown];
+}
+
+#pragma mark Helpers
+
+- (void)startSuite:(NSString *)name
+{
+  [self.treeReporter testManagerMediator:nil testSuite:name didStartAt:@"2017-08-07 10:31:33"];
+  [self.writer startTestSuite:name];
+}
+
+- (void)runTestClass:(NSString *)testClass method:(NSString *)method duration:(NSTimeInterval)duration failures:(NSArray<FBTestManagerTestReporterTestCaseFailure *> *)failures
+{
+  [self.treeReporter testManagerMediator:nil testCaseDidStartForTestClass:testClass method:method];
+  for (FBTestManagerTestReporterTestCaseFailure *failure in failures) {
+    [self.treeReporter testManagerMediator:nil testCaseDidFailForTestClass:testClass method:method withMessage:failure.message file:failure.file line:failure.line];
+  }
+  FBTestReportStatus status = failures.count ? FBTestReportStatusFailed : FBTestReportStatusPassed;
+  [self.treeReporter testManagerMediator:nil testCaseDidFinishForTestClass:testClass method:method withStatus:status duration:duration];
+  [self.writer finishTestCaseForTestClass:testClass method:method duration:duration failures:failures];
+}
+
+- (void)finishSuite:(NSString *)name runCount:(NSInteger)runCount failures:(NSInteger)failures unexpected:(NSInteger)unexpected duration:(NSTimeInterval)duration
+{
+  FBTestManagerResultSummary *summary = [[FBTestManagerResultSummary alloc]
+    initWithTestSuite:name
+    finishTime:[NSDate date]
+    runCount:runCount
+    failureCount:failures
+    unexpected:unexpected
+    testDuration:duration
+    totalDuration:duration];
+  [self.treeReporter testManagerMediator:nil finishedWithSummary:summary];
+  [self.writer finishTestSuiteWithSummary:summary];
+}
+
+- (NSString *)writtenContents
+{
+  return [NSString stringWithContentsOfFile:self.filePath encoding:NSUTF8StringEncoding error:nil];
+}
+
+- (NSString *)normalizedDocument:(NSString *)string
+{
+  NSError *error = nil;
+  NSXMLDocument *document = [[NSXMLDocument alloc] initWithXMLString:string options:0 error:&error];
+  XCTAssertNotNil(document, @"%@", error);
+  return [document XMLStringWithOptions:NSXMLNodePrettyPrint];
+}
+
+- (NSString *)generatedDocumentWithPackagePrefix:(NSString *)packagePrefix
+{
+  NSXMLElement *element = [FBTestManagerJUnitGenerator elementForTestSuite:self.treeReporter.testSuite packagePrefix:packagePrefix];
+  NSXMLDocument *document = [FBTestManagerJUnitGenerator documentForTestSuiteElements:@[element]];
+  return [self normalizedDocument:[[NSString alloc] initWithData:[document XMLDataWithOptions:NSXMLNodePrettyPrint] encoding:NSUTF8StringEncoding]];
+}
+
+- (NSString *)streamedDocument
+{
+  NSError *error = nil;
+  BOOL success = [self.writer finishWithError:&error];
+  XCTAssertNil(error);
+  XCTAssertTrue(success);
+  return self.writtenContents;
+}
+
+#pragma mark Tests
+
+- (void)testMatchesGeneratedDocument
+{
+  [self startSuite:@"All Tests"];
+  [self startSuite:@"UnitTests.xctest"];
+  [self runTestClass:@"CalculatorTest" method:@"testMultiplication" duration:0.06 failures:@[]];
+  [self runTestClass:@"CalculatorTest" method:@"testDivision" duration:0.12 failures:@[
+    [FBTestManagerTestReporterTestCaseFailure withMessage:@"division by zero" file:@"CalculatorTest.m" line:42],
+    [FBTestManagerTestReporterTestCaseFailure withMessage:@"\"a\" < 'b' && c > d" file:@"CalculatorTest.m" line:43],
+  ]];
+  [self finishSuite:@"UnitTests.xctest" runCount:2 failures:1 unexpected:1 duration:0.18];
+  [self startSuite:@"Empty.xctest"];
+  [self finishSuite:@"Empty.xctest" runCount:0 failures:0 unexpected:0 duration:0];
+  [self startSuite:@"UITests.xctest"];
+  [self runTestClass:@"CalculatorInterfaceTest" method:@"testInteraction" duration:0.05 failures:@[]];
+  [self finishSuite:@"UITests.xctest" runCount:1 failures:0 unexpected:0 duration:0.05];
+  [self finishSuite:@"All Tests" runCount:3 failures:1 unexpected:1 duration:0.23];
+
+  XCTAssertEqualObjects([self normalizedDocument:[self streamedDocument]], [self generatedDocumentWithPackagePrefix:nil]);
+}
+
+- (void)testMatchesGeneratedDocumentWithPackagePrefix
+{
+  NSError *error = nil;
+  self.writer = [FBTestManagerJUnitStreamWriter writerForFilePath:self.filePath packagePrefix:@"com.example" error:&error];
+  XCTAssertNil(error);
+
+  [self startSuite:@"One"];
+  [self runTestClass:@"TestOne" method:@"method" duration:0.05 failures:@[]];
+  [self startSuite:@"Two"];
+  [self runTestClass:@"TestTwo" method:@"method" duration:0.05 failures:@[]];
+  [self finishSuite:@"Two" runCount:1 failures:0 unexpected:0 duration:0.05];
+  [self finishSuite:@"One" runCount:2 failures:0 unexpected:0 duration:0.1];
+
+  XCTAssertEqualObjects([self normalizedDocument:[self streamedDocument]], [self generatedDocumentWithPackagePrefix:@"com.example"]);
+}
+
+- (void)testWritesTestCasesBeforeTheSuiteFinishes
+{
+  [self startSuite:@"Running"];
+  [self runTestClass:@"Foo" method:@"testFirst" duration:1 failures:@[]];
+  XCTAssertTrue([self.writtenContents containsString:@"<testcase classname=\"Foo\" name=\"testFirst\" time=\"1\"></testcase>"]);
+  XCTAssertFalse([self.writtenContents containsString:@"</testsuite>"]);
+
+  [self runTestClass:@"Foo" method:@"testSecond" duration:2 failures:@[]];
+  [self finishSuite:@"Running" runCount:2 failures:0 unexpected:0 duration:3];
+  XCTAssertTrue([self.writtenContents containsString:@"<testsuite tests=\"2\" failures=\"0\" errors=\"0\" time=\"3\" name=\"Running\""]);
+  XCTAssertEqualObjects([self normalizedDocument:[self streamedDocument]], [self generatedDocumentWithPackagePrefix:nil]);
+}
+
+- (void)testClosesUnfinishedSuitesWithCountedResults
+{
+  [self.writer startTestSuite:@"Crashed"];
+  [self.writer finishTestCaseForTestClass:@"Foo" method:@"testPasses" duration:1 failures:@[]];
+  [self.writer finishTestCaseForTestClass:@"Foo" method:@"testFails" duration:2 failures:@[
+    [FBTestManagerTestReporterTestCaseFailure withMessage:@"bad" file:@"Foo.m" line:1],
+  ]];
+
+  NSError *error = nil;
+  NSXMLDocument *document = [[NSXMLDocument alloc] initWithXMLString:[self streamedDocument] options:0 error:&error];
+  XCTAssertNil(error);
+  NSXMLElement *suite = [[document nodesForXPath:@"/testsuites/testsuite" error:&error] firstObject];
+  XCTAssertEqualObjects([suite attributeForName:@"name"].stringValue, @"Crashed");
+  XCTAssertEqualObjects([suite attributeForName:@"tests"].stringValue, @"2");
+  XCTAssertEqualObjects([suite attributeForName:@"failures"].stringValue, @"1");
+  XCTAssertEqualObjects([suite attributeForName:@"time"].stringValue, @"3");
+  XCTAssertEqual([suite elementsForName:@"testcase"].count, 2u);
+}
+
+- (void)testEmptyDocument
+{
+  XCTAssertEqualObjects([self streamedDocument], @"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<testsuites></testsuites>");
+}
+
+- (void)testStreamsManyTestCasesAcrossChunks
+{
+  static NSUInteger const TestCount = 20000;
+  [self startSuite:@"Large"];
+  for (NSUInteger index = 0; index < TestCount; index++) {
+    [self runTestClass:@"LargeTest" method:[NSString stringWithFormat:@"testNumber%lu", (unsigned long) index] duration:0.001 failures:@[]];
+  }
+  [self finishSuite:@"Large" runCount:TestCount failures:0 unexpected:0 duration:20];
+
+  XCTAssertEqualObjects([self normalizedDocument:[self streamedDocument]], [self generatedDocumentWithPackagePrefix:nil]);
+}
+
+@end
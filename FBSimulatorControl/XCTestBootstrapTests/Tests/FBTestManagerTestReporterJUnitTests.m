@@ -94,6 +94,50 @@
   XCTAssertEqualObjects(expected, actual);
 }
 
+- (void)testJUnitReporterMovesPartialOutputIntoPlaceWhenFinished
+{
+  NSString *partialPath = [self.outputFileURL.path stringByAppendingPathExtension:@"partial"];
+
+  [self testSuite:@"UnitTests.xctest" didStartAt:@"2016-08-07 10:31:34"];
+  [self testCaseDidStart:@"CalculatorTest" method:@"testMultiplication"];
+  [self testCaseDidFinish:@"CalculatorTest" method:@"testMultiplication" status:FBTestReportStatusPassed duration:0.06];
+
+  NSString *partial = [NSString stringWithContentsOfFile:partialPath encoding:NSUTF8StringEncoding error:nil];
+  XCTAssertTrue([partial containsString:@"testMultiplication"]);
+  XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:self.outputFileURL.path]);
+
+  [self testSuiteDidFinish:@"UnitTests.xctest" at:@"2016-08-07 10:31:35" runCount:1 failures:0 unexpected:0 testDuration:0.06 totalDuration:0.06];
+  [self testManagerMediatorDidFinishExecutingTestPlan];
+
+  XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:partialPath]);
+  XCTAssertTrue([[self stringWithContentsOfJUnitResult:self.outputFileURL] containsString:@"testMultiplication"]);
+  XCTAssertEqualObjects(self.reporter.testSuite.name, @"UnitTests.xctest");
+  XCTAssertEqual(self.reporter.testSuite.testCases.count, 0u);
+}
+
+- (void)testJUnitReporterDoesNotRetainFinishedTestCases
+{
+  [self testSuite:@"UnitTests.xctest" didStartAt:@"2016-08-07 10:31:34"];
+
+  __weak FBTestManagerTestReporterTestCase *testCase = nil;
+  @autoreleasepool {
+    [self testCaseDidStart:@"CalculatorTest" method:@"testDivision"];
+    testCase = [self.reporter valueForKey:@"currentTestCase"];
+    XCTAssertNotNil(testCase);
+    [self testCaseDidFail:@"CalculatorTest" method:@"testDivision" withMessage:@"division by zero" file:@"CalculatorTest.m" line:42];
+    [self testCaseDidFinish:@"CalculatorTest" method:@"testDivision" status:FBTestReportStatusFailed duration:0.12];
+  }
+
+  XCTAssertNil(testCase);
+  XCTAssertEqual(self.reporter.testSuite.testCases.count, 0u);
+
+  [self testSuiteDidFinish:@"UnitTests.xctest" at:@"2016-08-07 10:31:35" runCount:1 failures:1 unexpected:1 testDuration:0.12 totalDuration:0.12];
+  [self testManagerMediatorDidFinishExecutingTestPlan];
+
+  XCTAssertEqual(self.reporter.testSuite.summary.runCount, 1);
+  XCTAssertTrue([[self stringWithContentsOfJUnitResult:self.outputFileURL] containsString:@"division by zero"]);
+}
+
 #pragma mark -
 
 - (NSString *)stringWithContentsOfJUnitResult:(NSURL *)path
@@ -101,7 +145,10 @@
   NSError *error;
   NSString *string = [NSString stringWithContentsOfURL:path encoding:NSUTF8StringEncoding error:&error];
   XCTAssertNil(error);
-  return string;
+  // The streamed output may contain whitespace before the closing bracket of a tag, so compare the documents after re-formatting.
+  NSXMLDocument *document = [[NSXMLDocument alloc] initWithXMLString:string options:0 error:&error];
+  XCTAssertNil(error);
+  return [document XMLStringWithOptions:NSXMLNodePrettyPrint];
 }
 
 - (void)testSuite:(NSString *)testSuite didStartAt:(NSString *)startTime
@@ -131,6 +131,10 @@ function all_frameworks_test() {
   device_framework_test
 }
 
+function all_frameworks_benchmark() {
+  framework_test FBPerformanceTests
+}
+
 function strip_framework() {
   local FRAMEWORK_PATH="$BUILD_DIRECTORY/Build/Products/Debug/$1"
   if [ -d "$FRAMEWORK_PATH" ]; then
@@ -221,6 +225,8 @@ Supported Commands:
     Build the FBSimulatorControl.framework. Optionally copies the Framework to <output-directory>
   framework test
     Build then Test the FBSimulatorControl.framework.
+  framework benchmark
+    Build then run the performance tests of the Frameworks. These are not run as part of 'framework test'.
   fbsimctl build <output-directory>
     Build the fbsimctl exectutable. Optionally copies the executable and it's dependencies to <output-directory>
   fbsimctl test
@@ -275,6 +281,8 @@ case $TARGET in
       test)
         build_test_deps
         all_frameworks_test;;
+      benchmark)
+        all_frameworks_benchmark;;
       *)
         echo "Unknown Command $2"
         exit 1;;
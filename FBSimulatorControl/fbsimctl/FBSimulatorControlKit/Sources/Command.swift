@@ -67,6 +67,7 @@ public enum Record {
 public enum FileOutput {
   case path(String)
   case standardOut
+  case sharedMemory(String)
 }
 
 /**
@@ -312,6 +313,8 @@ public func == (left: FileOutput, right: FileOutput) -> Bool {
     return leftPath == rightPath
   case (.standardOut, .standardOut):
     return true
+  case (.sharedMemory(let leftName), .sharedMemory(let rightName)):
+    return leftName == rightName
   default:
     return false
   }
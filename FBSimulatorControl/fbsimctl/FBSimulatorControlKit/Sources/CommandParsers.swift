@@ -493,6 +493,7 @@ extension FileOutput: Parsable {
   public static var parser: Parser<FileOutput> {
     return Parser.alternative([
       Parser.ofString("-", FileOutput.standardOut),
+      Parser<String>.ofFlagWithArg("shm", Parser<String>.ofAny, "The name of a shared memory object to publish frames to").fmap(FileOutput.sharedMemory),
       Parser<FileOutput>.ofFile.fmap(FileOutput.path),
     ])
   }
@@ -1192,11 +1193,18 @@ struct FBBitmapStreamConfigurationParser {
       .ofFlagWithArg("fps", Parser<Int>.ofInt, "Frames Per Second of Output")
       .fmap { NSNumber(integerLiteral: $0) }
       .optional()
+    let latencyBudgetParser = Parser<NSNumber>
+      .ofFlagWithArg("latency-budget", Parser<Double>.ofDouble, "Lower the frame rate to keep the end-to-end latency of frames within this many seconds")
+      .fmap { NSNumber(value: $0) }
+      .optional()
     return Parser
-      .ofTwoSequenced(
+      .ofThreeSequenced(
         typeParser,
-        fpsParser
+        fpsParser,
+        latencyBudgetParser
       )
-      .fmap(FBBitmapStreamConfiguration.init)
+      .fmap { encoding, framesPerSecond, latencyBudget in
+        return FBBitmapStreamConfiguration(encoding: encoding, framesPerSecond: framesPerSecond, latencyBudget: latencyBudget)
+      }
   }
 }
@@ -281,6 +281,42 @@ struct ScreenshotRoute: Route {
   }
 }
 
+struct DiagnosticArchiveRoute: Route {
+  static let maximumConcurrency = 8
+
+  var method: HttpMethod {
+    return HttpMethod.POST
+  }
+
+  var endpoint: String {
+    return "diagnose.tar.gz"
+  }
+
+  func responseHandler(performer: ActionPerformer) -> HttpResponseHandler {
+    return SimpleResponseHandler { request in
+      let json = try request.jsonBody()
+      let diagnosticQuery = try FBDiagnosticQuery.inflate(fromJSON: json.decode())
+      let bodyQuery = try? FBiOSTargetQuery.inflate(fromJSON: json.getValue("simulators").decode())
+      let targetQuery = try SimpleResponseHandler.extractQueryFromPath(request) ?? bodyQuery ?? performer.query
+      let targets = performer.runnerContext(HttpEventReporter()).query(targetQuery)
+      if targets.isEmpty {
+        throw QueryError.NoMatches
+      }
+
+      // The archive is streamed to a temporary file, then served from a mapping of that file.
+      let path = (NSTemporaryDirectory() as NSString).appendingPathComponent("fbsimctl_diagnostics_\(UUID().uuidString).tar.gz")
+      defer {
+        try? FileManager.default.removeItem(atPath: path)
+      }
+      let writer = try FBFileWriter.syncWriter(forFilePath: path)
+      let archiver = FBDiagnosticArchiver(consumer: writer, maximumConcurrency: DiagnosticArchiveRoute.maximumConcurrency, logger: FBControlCoreGlobalConfiguration.defaultLogger)
+      _ = try archiver.archiveQuery(diagnosticQuery, ofTargets: targets).await(withTimeout: FBControlCoreGlobalConfiguration.slowTimeout)
+      let archiveData = try Data(contentsOf: URL(fileURLWithPath: path), options: .alwaysMapped)
+      return HttpResponse(statusCode: 200, body: archiveData, contentType: "application/gzip")
+    }
+  }
+}
+
 class HttpRelay: Relay {
   struct HttpError: Error, CustomStringConvertible {
     let message: String
@@ -496,6 +532,7 @@ class HttpRelay: Relay {
       self.uploadRoute,
       ScreenshotRoute(format: FBScreenshotFormat.PNG),
       ScreenshotRoute(format: FBScreenshotFormat.JPEG),
+      DiagnosticArchiveRoute(),
     ]
   }
 }
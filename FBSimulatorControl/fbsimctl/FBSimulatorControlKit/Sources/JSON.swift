@@ -76,12 +76,11 @@ public indirect enum JSON {
   }
 
   static func fromData(_ data: Data) throws -> JSON {
-    let object = try JSONSerialization.jsonObject(with: data, options: JSONSerialization.ReadingOptions())
-    return try JSON.encode(object as AnyObject)
+    return try JSONParser.parse(data)
   }
 
   var data: Data {
-    return try! JSONSerialization.data(withJSONObject: decode(), options: JSONSerialization.WritingOptions())
+    return try! JSONWriter.serialize(self)
   }
 
   func decode() -> AnyObject {
@@ -121,18 +120,15 @@ public indirect enum JSON {
   }
 
   func serializeToString(_ pretty: Bool) throws -> String {
-    do {
-      let writingOptions = pretty ? JSONSerialization.WritingOptions.prettyPrinted : JSONSerialization.WritingOptions()
-      let jsonObject = try decodeContainer()
-      let data = try JSONSerialization.data(withJSONObject: jsonObject, options: writingOptions)
+    switch self {
+    case .array, .dictionary:
+      let data = try JSONWriter.serialize(self, pretty: pretty)
       guard let string = String(data: data, encoding: String.Encoding.utf8) else {
         throw JSONError.stringifying(data)
       }
       return string
-    } catch let error as JSONError {
-      throw error
-    } catch let error as NSError {
-      throw JSONError.serialization(error)
+    default:
+      throw JSONError.notContainer(self)
     }
   }
 }
@@ -0,0 +1,512 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+import Foundation
+
+private enum Byte {
+  static let quote = UInt8(ascii: "\"")
+  static let backslash = UInt8(ascii: "\\")
+  static let slash = UInt8(ascii: "/")
+  static let comma = UInt8(ascii: ",")
+  static let colon = UInt8(ascii: ":")
+  static let openBrace = UInt8(ascii: "{")
+  static let closeBrace = UInt8(ascii: "}")
+  static let openBracket = UInt8(ascii: "[")
+  static let closeBracket = UInt8(ascii: "]")
+  static let minus = UInt8(ascii: "-")
+  static let plus = UInt8(ascii: "+")
+  static let period = UInt8(ascii: ".")
+  static let zero = UInt8(ascii: "0")
+  static let nine = UInt8(ascii: "9")
+  static let lowerE = UInt8(ascii: "e")
+  static let upperE = UInt8(ascii: "E")
+  static let space = UInt8(ascii: " ")
+  static let tab = UInt8(ascii: "\t")
+  static let newline = UInt8(ascii: "\n")
+  static let carriageReturn = UInt8(ascii: "\r")
+}
+
+/**
+ A single-pass parser from UTF-8 bytes to the JSON Type.
+ Unlike JSONSerialization, no intermediate Foundation objects are created.
+ As with JSONSerialization, strings that are not valid UTF-8 are rejected rather than repaired.
+ Unlike JSONSerialization, the input must be UTF-8, other Unicode encodings are not detected.
+ */
+struct JSONParser {
+  static let maximumDepth = 512
+
+  private let bytes: UnsafeBufferPointer<UInt8>
+  private var index: Int = 0
+  private var depth: Int = 0
+
+  private init(bytes: UnsafeBufferPointer<UInt8>) {
+    self.bytes = bytes
+  }
+
+  /**
+   Parses the provided data.
+
+   - parameter data: UTF-8 encoded JSON.
+   - parameter allowFragments: if false, the top level value must be an array or dictionary.
+   - returns: the parsed JSON.
+   */
+  static func parse(_ data: Data, allowFragments: Bool = false) throws -> JSON {
+    return try data.withUnsafeBytes { (pointer: UnsafePointer<UInt8>) -> JSON in
+      var parser = JSONParser(bytes: UnsafeBufferPointer(start: pointer, count: data.count))
+      parser.skipWhitespace()
+      if !allowFragments, let byte = parser.peek(), byte != Byte.openBrace, byte != Byte.openBracket {
+        throw parser.error("Expected an array or dictionary at the top level")
+      }
+      let value = try parser.parseValue()
+      parser.skipWhitespace()
+      if parser.index != parser.bytes.count {
+        throw parser.error("Unexpected trailing content")
+      }
+      return value
+    }
+  }
+
+  private func peek() -> UInt8? {
+    return index < bytes.count ? bytes[index] : nil
+  }
+
+  private func error(_ message: String) -> JSONError {
+    return JSONError.parse("\(message) at offset \(index)")
+  }
+
+  private mutating func skipWhitespace() {
+    while index < bytes.count {
+      switch bytes[index] {
+      case Byte.space, Byte.tab, Byte.newline, Byte.carriageReturn:
+        index += 1
+      default:
+        return
+      }
+    }
+  }
+
+  private mutating func expect(_ byte: UInt8) throws {
+    skipWhitespace()
+    guard peek() == byte else {
+      throw error("Expected '\(Character(UnicodeScalar(byte)))'")
+    }
+    index += 1
+  }
+
+  private mutating func parseValue() throws -> JSON {
+    skipWhitespace()
+    guard let byte = peek() else {
+      throw error("Unexpected end of input")
+    }
+    switch byte {
+    case Byte.openBrace:
+      return try parseDictionary()
+    case Byte.openBracket:
+      return try parseArray()
+    case Byte.quote:
+      return JSON.string(try parseString())
+    case Byte.minus, Byte.zero ... Byte.nine:
+      return JSON.number(try parseNumber())
+    case UInt8(ascii: "t"):
+      try parseLiteral("true")
+      return JSON.bool(true)
+    case UInt8(ascii: "f"):
+      try parseLiteral("false")
+      return JSON.bool(false)
+    case UInt8(ascii: "n"):
+      try parseLiteral("null")
+      return JSON.null
+    default:
+      throw error("Unexpected character '\(Character(UnicodeScalar(byte)))'")
+    }
+  }
+
+  private mutating func enterContainer() throws {
+    depth += 1
+    if depth > JSONParser.maximumDepth {
+      throw error("Exceeded the maximum nesting depth of \(JSONParser.maximumDepth)")
+    }
+  }
+
+  private mutating func parseDictionary() throws -> JSON {
+    try enterContainer()
+    index += 1
+    var dictionary: [String: JSON] = [:]
+    skipWhitespace()
+    if peek() == Byte.closeBrace {
+      index += 1
+      depth -= 1
+      return JSON.dictionary(dictionary)
+    }
+    while true {
+      skipWhitespace()
+      guard peek() == Byte.quote else {
+        throw error("Expected a string key")
+      }
+      let key = try parseString()
+      try expect(Byte.colon)
+      dictionary[key] = try parseValue()
+      skipWhitespace()
+      guard let byte = peek() else {
+        throw error("Unterminated dictionary")
+      }
+      index += 1
+      if byte == Byte.closeBrace {
+        break
+      }
+      if byte != Byte.comma {
+        throw error("Expected ',' or '}' in dictionary")
+      }
+    }
+    depth -= 1
+    return JSON.dictionary(dictionary)
+  }
+
+  private mutating func parseArray() throws -> JSON {
+    try enterContainer()
+    index += 1
+    var array: [JSON] = []
+    skipWhitespace()
+    if peek() == Byte.closeBracket {
+      index += 1
+      depth -= 1
+      return JSON.array(array)
+    }
+    while true {
+      array.append(try parseValue())
+      skipWhitespace()
+      guard let byte = peek() else {
+        throw error("Unterminated array")
+      }
+      index += 1
+      if byte == Byte.closeBracket {
+        break
+      }
+      if byte != Byte.comma {
+        throw error("Expected ',' or ']' in array")
+      }
+    }
+    depth -= 1
+    return JSON.array(array)
+  }
+
+  private mutating func parseLiteral(_ literal: StaticString) throws {
+    let count = literal.utf8CodeUnitCount
+    guard index + count <= bytes.count, memcmp(bytes.baseAddress! + index, literal.utf8Start, count) == 0 else {
+      throw error("Expected '\(literal)'")
+    }
+    index += count
+  }
+
+  private mutating func parseString() throws -> String {
+    index += 1
+    let start = index
+    var isASCII = true
+    // Strings without escapes, the common case, are decoded directly from the input.
+    while index < bytes.count {
+      let byte = bytes[index]
+      if byte == Byte.quote {
+        let string = try decodeString(UnsafeBufferPointer(rebasing: bytes[start ..< index]), isASCII: isASCII)
+        index += 1
+        return string
+      }
+      if byte == Byte.backslash {
+        break
+      }
+      if byte < 0x20 {
+        throw error("Unescaped control character in string")
+      }
+      isASCII = isASCII && byte < 0x80
+      index += 1
+    }
+    var scalars: [UInt8] = Array(bytes[start ..< index])
+    while index < bytes.count {
+      let byte = bytes[index]
+      index += 1
+      switch byte {
+      case Byte.quote:
+        return try scalars.withUnsafeBufferPointer { try decodeString($0, isASCII: false) }
+      case Byte.backslash:
+        try parseEscape(into: &scalars)
+      case 0 ..< 0x20:
+        throw error("Unescaped control character in string")
+      default:
+        scalars.append(byte)
+      }
+    }
+    throw error("Unterminated string")
+  }
+
+  private func decodeString(_ buffer: UnsafeBufferPointer<UInt8>, isASCII: Bool) throws -> String {
+    // ASCII is always valid UTF-8, otherwise the bytes are validated instead of invalid sequences being replaced.
+    if isASCII {
+      return String(decoding: buffer, as: UTF8.self)
+    }
+    guard let string = String(bytes: buffer, encoding: String.Encoding.utf8) else {
+      throw error("Invalid UTF-8 in string")
+    }
+    return string
+  }
+
+  private mutating func parseEscape(into output: inout [UInt8]) throws {
+    guard let byte = peek() else {
+      throw error("Unterminated escape")
+    }
+    index += 1
+    switch byte {
+    case Byte.quote, Byte.backslash, Byte.slash:
+      output.append(byte)
+    case UInt8(ascii: "b"):
+      output.append(0x08)
+    case UInt8(ascii: "f"):
+      output.append(0x0C)
+    case UInt8(ascii: "n"):
+      output.append(Byte.newline)
+    case UInt8(ascii: "r"):
+      output.append(Byte.carriageReturn)
+    case UInt8(ascii: "t"):
+      output.append(Byte.tab)
+    case UInt8(ascii: "u"):
+      var codePoint = UInt32(try parseHexQuad())
+      // A high surrogate must be followed by an escaped low surrogate.
+      if codePoint >= 0xD800 && codePoint < 0xDC00 {
+        guard index + 1 < bytes.count, bytes[index] == Byte.backslash, bytes[index + 1] == UInt8(ascii: "u") else {
+          throw error("Unpaired high surrogate")
+        }
+        index += 2
+        let low = UInt32(try parseHexQuad())
+        guard low >= 0xDC00 && low < 0xE000 else {
+          throw error("Invalid low surrogate")
+        }
+        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00)
+      } else if codePoint >= 0xDC00 && codePoint < 0xE000 {
+        throw error("Unpaired low surrogate")
+      }
+      guard let scalar = UnicodeScalar(codePoint) else {
+        throw error("Invalid code point \(codePoint)")
+      }
+      output.append(contentsOf: String(scalar).utf8)
+    default:
+      throw error("Invalid escape '\(Character(UnicodeScalar(byte)))'")
+    }
+  }
+
+  private mutating func parseHexQuad() throws -> UInt16 {
+    guard index + 4 <= bytes.count else {
+      throw error("Truncated unicode escape")
+    }
+    var value: UInt16 = 0
+    for _ in 0 ..< 4 {
+      let byte = bytes[index]
+      let digit: UInt8
+      switch byte {
+      case Byte.zero ... Byte.nine:
+        digit = byte - Byte.zero
+      case UInt8(ascii: "a") ... UInt8(ascii: "f"):
+        digit = byte - UInt8(ascii: "a") + 10
+      case UInt8(ascii: "A") ... UInt8(ascii: "F"):
+        digit = byte - UInt8(ascii: "A") + 10
+      default:
+        throw error("Invalid hex digit in unicode escape")
+      }
+      value = (value << 4) | UInt16(digit)
+      index += 1
+    }
+    return value
+  }
+
+  private mutating func consumeDigits() -> Int {
+    let start = index
+    while index < bytes.count && bytes[index] >= Byte.zero && bytes[index] <= Byte.nine {
+      index += 1
+    }
+    return index - start
+  }
+
+  private mutating func parseNumber() throws -> NSNumber {
+    let start = index
+    let negative = bytes[index] == Byte.minus
+    if negative {
+      index += 1
+    }
+    let integerStart = index
+    let integerDigits = consumeDigits()
+    if integerDigits == 0 {
+      throw error("Expected a digit")
+    }
+    if integerDigits > 1 && bytes[integerStart] == Byte.zero {
+      throw error("Leading zeros are not permitted")
+    }
+    var isInteger = true
+    if peek() == Byte.period {
+      index += 1
+      isInteger = false
+      if consumeDigits() == 0 {
+        throw error("Expected a digit after the decimal point")
+      }
+    }
+    if let byte = peek(), byte == Byte.lowerE || byte == Byte.upperE {
+      index += 1
+      isInteger = false
+      if let sign = peek(), sign == Byte.plus || sign == Byte.minus {
+        index += 1
+      }
+      if consumeDigits() == 0 {
+        throw error("Expected a digit in the exponent")
+      }
+    }
+    // Integers that cannot overflow are accumulated directly, otherwise the text is converted.
+    if isInteger && integerDigits <= 18 {
+      var value: Int64 = 0
+      for offset in integerStart ..< index {
+        value = (value * 10) + Int64(bytes[offset] - Byte.zero)
+      }
+      return NSNumber(value: negative ? -value : value)
+    }
+    let text = String(decoding: UnsafeBufferPointer(rebasing: bytes[start ..< index]), as: UTF8.self)
+    if isInteger, let value = Int64(text) {
+      return NSNumber(value: value)
+    }
+    guard let value = Double(text) else {
+      throw error("Invalid number \(text)")
+    }
+    return NSNumber(value: value)
+  }
+}
+
+/**
+ Serializes the JSON Type to UTF-8 bytes, without creating Foundation objects.
+ The output matches the formatting and string escaping of JSONSerialization, including when pretty printing.
+ As with JSONSerialization, the order of dictionary keys is unspecified.
+ */
+struct JSONWriter {
+  private var output: [UInt8] = []
+  private let pretty: Bool
+
+  private init(pretty: Bool) {
+    self.pretty = pretty
+  }
+
+  static func serialize(_ json: JSON, pretty: Bool = false) throws -> Data {
+    var writer = JSONWriter(pretty: pretty)
+    try writer.write(json, depth: 0)
+    return Data(bytes: writer.output)
+  }
+
+  private mutating func write(_ json: JSON, depth: Int) throws {
+    switch json {
+    case .dictionary(let dictionary):
+      if dictionary.isEmpty {
+        output.append(contentsOf: "{}".utf8)
+        return
+      }
+      output.append(Byte.openBrace)
+      var first = true
+      for (key, value) in dictionary {
+        if !first {
+          output.append(Byte.comma)
+        }
+        first = false
+        writeIndentation(depth + 1)
+        writeString(key)
+        output.append(contentsOf: pretty ? " : ".utf8 : ":".utf8)
+        try write(value, depth: depth + 1)
+      }
+      writeIndentation(depth)
+      output.append(Byte.closeBrace)
+    case .array(let array):
+      if array.isEmpty {
+        output.append(contentsOf: "[]".utf8)
+        return
+      }
+      output.append(Byte.openBracket)
+      for (offset, value) in array.enumerated() {
+        if offset > 0 {
+          output.append(Byte.comma)
+        }
+        writeIndentation(depth + 1)
+        try write(value, depth: depth + 1)
+      }
+      writeIndentation(depth)
+      output.append(Byte.closeBracket)
+    case .string(let string):
+      writeString(string)
+    case .number(let number):
+      try writeNumber(number)
+    case .bool(let bool):
+      output.append(contentsOf: bool ? "true".utf8 : "false".utf8)
+    case .null:
+      output.append(contentsOf: "null".utf8)
+    }
+  }
+
+  private mutating func writeIndentation(_ depth: Int) {
+    guard pretty else {
+      return
+    }
+    output.append(Byte.newline)
+    output.append(contentsOf: repeatElement(Byte.space, count: depth * 2))
+  }
+
+  private static let hexDigits = Array("0123456789abcdef".utf8)
+
+  private mutating func writeString(_ string: String) {
+    output.append(Byte.quote)
+    for byte in string.utf8 {
+      switch byte {
+      case Byte.quote, Byte.backslash, Byte.slash:
+        output.append(Byte.backslash)
+        output.append(byte)
+      case 0x08:
+        output.append(contentsOf: "\\b".utf8)
+      case 0x0C:
+        output.append(contentsOf: "\\f".utf8)
+      case Byte.newline:
+        output.append(contentsOf: "\\n".utf8)
+      case Byte.carriageReturn:
+        output.append(contentsOf: "\\r".utf8)
+      case Byte.tab:
+        output.append(contentsOf: "\\t".utf8)
+      case 0 ..< 0x20:
+        output.append(contentsOf: "\\u00".utf8)
+        output.append(JSONWriter.hexDigits[Int(byte >> 4)])
+        output.append(JSONWriter.hexDigits[Int(byte & 0xF)])
+      default:
+        output.append(byte)
+      }
+    }
+    output.append(Byte.quote)
+  }
+
+  private mutating func writeNumber(_ number: NSNumber) throws {
+    if CFGetTypeID(number as CFTypeRef) == CFBooleanGetTypeID() {
+      output.append(contentsOf: number.boolValue ? "true".utf8 : "false".utf8)
+      return
+    }
+    switch UInt8(bitPattern: number.objCType.pointee) {
+    case UInt8(ascii: "d"), UInt8(ascii: "f"):
+      let value = number.doubleValue
+      guard value.isFinite else {
+        throw JSONError.nonEncodable(number)
+      }
+      // Whole numbers are written without a fraction, as JSONSerialization does.
+      if value == value.rounded() && abs(value) < 1e15 && !(value == 0 && value.sign == .minus) {
+        output.append(contentsOf: String(Int64(value)).utf8)
+        return
+      }
+      // The formatting of fractional and large values differs from Swift's description, so JSONSerialization writes them.
+      let data = try JSONSerialization.data(withJSONObject: [number], options: JSONSerialization.WritingOptions())
+      output.append(contentsOf: data.dropFirst().dropLast())
+    case UInt8(ascii: "Q"):
+      output.append(contentsOf: String(number.uint64Value).utf8)
+    default:
+      output.append(contentsOf: String(number.int64Value).utf8)
+    }
+  }
+}
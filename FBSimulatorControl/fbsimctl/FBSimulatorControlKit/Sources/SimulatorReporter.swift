@@ -53,6 +53,10 @@ open class SimulatorReporter: NSObject, FBSimulatorEventSink, iOSReporter {
     reportValue(.launch, .discrete, launchdProcess)
   }
 
+  open func simulatorDidBoot(_ timeline: FBSimulatorBootTimeline) {
+    reportValue(.boot, .discrete, timeline)
+  }
+
   open func simulatorDidTerminate(_ launchdProcess: FBProcessInfo, expected: Bool) {
     reportValue(.terminate, .discrete, launchdProcess)
   }
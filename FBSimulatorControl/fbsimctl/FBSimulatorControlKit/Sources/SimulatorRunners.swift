@@ -11,12 +11,22 @@ import FBSimulatorControl
 import Foundation
 
 extension FileOutput {
-  func makeWriter() throws -> FBDataConsumer {
+  func makeWriter(stream: FBBitmapStream, configuration: FBBitmapStreamConfiguration) throws -> FBDataConsumer {
     switch self {
     case .path(let path):
       return try FBFileWriter.syncWriter(forFilePath: path)
     case .standardOut:
       return FBFileWriter.syncWriter(with: FileHandle.standardOutput)
+    case .sharedMemory(let name):
+      // Shared memory holds a single fixed-size raw frame, which an H264 stream of variable-size packets can't be written into.
+      guard configuration.encoding == .BGRA else {
+        throw FBControlCoreError.describe("--shm requires BGRA frames, but \(configuration.encoding.rawValue) encoding was requested. Use --bgra, or write H264 to a file or stdout").build()
+      }
+      let attributes = try stream.streamAttributes().await()
+      guard let frameSize = attributes.attributes["frame_size"] as? NSNumber else {
+        throw FBControlCoreError.describe("Stream attributes \(attributes.attributes) do not contain a frame size").build()
+      }
+      return try FBSharedMemoryFrameWriter(name: name, frameCapacity: frameSize.intValue, logger: FBControlCoreGlobalConfiguration.defaultLogger)
     }
   }
 }
@@ -43,8 +53,8 @@ extension iOSRunnerContext {
 extension FBBitmapStreamingCommands {
   func startStreaming(configuration: FBBitmapStreamConfiguration, output: FileOutput) -> FBFuture<FBiOSTargetContinuation> {
     do {
-      let writer = try output.makeWriter()
       let stream = try createStream(with: configuration).await()
+      let writer = try output.makeWriter(stream: stream, configuration: configuration)
       return stream.startStreaming(writer).mapReplace(stream) as! FBFuture<FBiOSTargetContinuation>
     } catch let error {
       return FBFuture(error: error)
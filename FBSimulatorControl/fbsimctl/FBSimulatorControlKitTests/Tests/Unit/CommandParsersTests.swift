@@ -251,6 +251,9 @@ let validActions: [([String], Action)] = [
   (["stream", "--h264", "-"], Action.stream(FBBitmapStreamConfiguration(encoding: .H264, framesPerSecond: nil), .standardOut)),
   (["stream", "--fps=30", "-"], Action.stream(FBBitmapStreamConfiguration(encoding: .BGRA, framesPerSecond: 30), .standardOut)),
   (["stream", "--bgra", "--fps=25", "-"], Action.stream(FBBitmapStreamConfiguration(encoding: .BGRA, framesPerSecond: 25), .standardOut)),
+  (["stream", "--shm", "/fbsimctl.frames"], Action.stream(FBBitmapStreamConfiguration(encoding: .BGRA, framesPerSecond: nil), .sharedMemory("/fbsimctl.frames"))),
+  (["stream", "--fps=30", "--shm=/fbsimctl.frames"], Action.stream(FBBitmapStreamConfiguration(encoding: .BGRA, framesPerSecond: 30), .sharedMemory("/fbsimctl.frames"))),
+  (["stream", "--fps=30", "--latency-budget=0.1", "-"], Action.stream(FBBitmapStreamConfiguration(encoding: .BGRA, framesPerSecond: 30, latencyBudget: 0.1), .standardOut)),
   (["stream", "--fps", "60", "/tmp/video.dump"], Action.stream(FBBitmapStreamConfiguration(encoding: .BGRA, framesPerSecond: 60), .path("/tmp/video.dump"))),
   (["terminate", "com.foo.bar"], .terminate("com.foo.bar")),
   (["uninstall", "com.foo.bar"], .uninstall("com.foo.bar")),
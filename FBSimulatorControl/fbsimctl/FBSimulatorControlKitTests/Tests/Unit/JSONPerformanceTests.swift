@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+@testable import FBSimulatorControlKit
+import XCTest
+
+class JSONPerformanceTests: XCTestCase {
+
+  // Request bodies of the kind that the HTTP relay receives.
+  static let requestBodies: [Data] = [
+    "{\"simulators\": [\"E1C2F3A4-5B6C-4D7E-8F90-A1B2C3D4E5F6\"], \"bundle_id\": \"com.example.app\", \"bundle_name\": null, \"arguments\": [\"-AppleLanguages\", \"(en)\", \"--verbose\"], \"environment\": {\"DYLD_INSERT_LIBRARIES\": \"/tmp/lib.dylib\", \"LOG_LEVEL\": \"debug\"}, \"wait_for_debugger\": false, \"output\": {\"stdout\": \"/tmp/stdout.log\", \"stderr\": null}}",
+    "{\"events\": [{\"class\": \"touch\", \"direction\": \"down\", \"x\": 120.5, \"y\": 300}, {\"class\": \"delay\", \"duration\": 0.1}, {\"class\": \"touch\", \"direction\": \"up\", \"x\": 120.5, \"y\": 300}], \"class\": \"composite\"}",
+    "{\"type\": \"application\", \"bundle_id\": \"com.example.app\", \"filenames\": [\"report.json\", \"screenshot.png\"], \"filename_globs\": [\"*.log\", \"*.crash\"], \"fallback_to_global_search\": true}",
+  ].map { $0.data(using: String.Encoding.utf8)! }
+
+  func testFoundationParsePerformance() {
+    let bodies = JSONPerformanceTests.requestBodies
+    measure {
+      for _ in 0 ..< 2000 {
+        for body in bodies {
+          let object = try! JSONSerialization.jsonObject(with: body, options: JSONSerialization.ReadingOptions())
+          _ = try! JSON.encode(object as AnyObject)
+        }
+      }
+    }
+  }
+
+  func testDirectParsePerformance() {
+    let bodies = JSONPerformanceTests.requestBodies
+    measure {
+      for _ in 0 ..< 2000 {
+        for body in bodies {
+          _ = try! JSONParser.parse(body)
+        }
+      }
+    }
+  }
+
+  func testFoundationWritePerformance() {
+    let values = JSONPerformanceTests.requestBodies.map { try! JSON.fromData($0) }
+    measure {
+      for _ in 0 ..< 2000 {
+        for value in values {
+          _ = try! JSONSerialization.data(withJSONObject: value.decode(), options: JSONSerialization.WritingOptions())
+        }
+      }
+    }
+  }
+
+  func testDirectWritePerformance() {
+    let values = JSONPerformanceTests.requestBodies.map { try! JSON.fromData($0) }
+    measure {
+      for _ in 0 ..< 2000 {
+        for value in values {
+          _ = value.data
+        }
+      }
+    }
+  }
+}
@@ -56,4 +56,83 @@ class JSONTests: XCTestCase {
       XCTFail("JSON Failure \(error)")
     }
   }
+
+  func testParsesDirectly() {
+    let input = "{\"string\": \"a\\\"b\\\\c\\n\\u00e9\\ud83d\\ude00\", \"int\": -42, \"double\": 1.5e3, \"bool\": true, \"null\": null, \"array\": [1, [], {}]}"
+    do {
+      let json = try JSON.fromData(input.data(using: String.Encoding.utf8)!)
+      XCTAssertEqual(try json.getValue("string").getString(), "a\"b\\c\n\u{e9}\u{1F600}")
+      XCTAssertEqual(try json.getValue("int").getNumber(), NSNumber(value: -42))
+      XCTAssertEqual(try json.getValue("double").getNumber().doubleValue, 1500)
+      XCTAssertEqual(try json.getValue("bool").getBool(), true)
+      XCTAssertEqual(try json.getValue("array").getArray().count, 3)
+      let expected = try JSONSerialization.jsonObject(with: input.data(using: String.Encoding.utf8)!, options: JSONSerialization.ReadingOptions()) as! NSDictionary
+      XCTAssertEqual(json.decode() as? NSDictionary, expected)
+      let big = try JSON.fromData("[12345678901234567890]".data(using: String.Encoding.utf8)!)
+      XCTAssertEqual(try big.getArray()[0].getNumber().doubleValue, 12345678901234567890.0)
+    } catch let error {
+      XCTFail("JSON Failure \(error)")
+    }
+  }
+
+  func testRejectsInvalidInput() {
+    let inputs = [
+      "",
+      "\"fragment\"",
+      "{\"a\": 1,}",
+      "[01]",
+      "[1.]",
+      "[\"unterminated]",
+      "[\"\\ud83d\"]",
+      "{\"a\" 1}",
+      "[true] false",
+      String(repeating: "[", count: JSONParser.maximumDepth + 1) + String(repeating: "]", count: JSONParser.maximumDepth + 1),
+    ]
+    for input in inputs {
+      if case .some = try? JSON.fromData(input.data(using: String.Encoding.utf8)!) {
+        XCTFail("\(input) should fail to parse")
+      }
+    }
+    // Invalid UTF-8 is rejected, with or without escapes in the same string, as JSONSerialization does.
+    for input in [Data(bytes: [0x5B, 0x22, 0x61, 0xFF, 0x22, 0x5D]), Data(bytes: [0x5B, 0x22, 0x5C, 0x6E, 0xC3, 0x22, 0x5D])] {
+      if case .some = try? JSON.fromData(input) {
+        XCTFail("\(input) should fail to parse")
+      }
+      if case .some = try? JSONSerialization.jsonObject(with: input, options: JSONSerialization.ReadingOptions()) {
+        XCTFail("\(input) should fail to parse with JSONSerialization")
+      }
+    }
+  }
+
+  func testWritesRoundTrip() {
+    let json = JSON.dictionary([
+      "string": JSON.string("quote \" slash \\ tab \t bell \u{07} \u{1F600}"),
+      "numbers": JSON.array([JSON.number(NSNumber(value: 1)), JSON.number(NSNumber(value: 2.5)), JSON.number(NSNumber(value: Int64.min))]),
+      "flags": JSON.array([JSON.bool(false), JSON.number(NSNumber(booleanLiteral: true)), JSON.null]),
+      "empty": JSON.dictionary([:]),
+    ])
+    do {
+      let decoded = try JSONSerialization.jsonObject(with: json.data, options: JSONSerialization.ReadingOptions()) as! NSDictionary
+      XCTAssertEqual(decoded, json.decode() as? NSDictionary)
+      let pretty = try json.serializeToString(true)
+      XCTAssertEqual(try JSON.fromData(pretty.data(using: String.Encoding.utf8)!).decode() as? NSDictionary, decoded)
+      XCTAssertEqual(try JSON.array([JSON.number(NSNumber(value: 3))]).serializeToString(true), "[\n  3\n]")
+      let escaped = JSON.array([JSON.string("path/to \"file\" \\ \u{08} \u{0C} \n \r \t \u{07} \u{1F600}")])
+      XCTAssertEqual(escaped.data, try JSONSerialization.data(withJSONObject: escaped.decode(), options: JSONSerialization.WritingOptions()))
+    } catch let error {
+      XCTFail("JSON Failure \(error)")
+    }
+  }
+
+  func testWritesNumbersAsJSONSerializationDoes() {
+    let values: [Double] = [0, -0.0, 3, -42, 0.1, 1.5, -2.25, 120.5, 123456789.123, 1e15, 1e20, -4.5e18, 1.5e300, 2.5e-8]
+    do {
+      let numbers = JSON.array(values.map { JSON.number(NSNumber(value: $0)) })
+      XCTAssertEqual(numbers.data, try JSONSerialization.data(withJSONObject: numbers.decode(), options: JSONSerialization.WritingOptions()))
+      let parsed = try JSON.fromData(numbers.data).decode() as? [NSNumber]
+      XCTAssertEqual(parsed?.map { $0.doubleValue }, values)
+    } catch let error {
+      XCTFail("JSON Failure \(error)")
+    }
+  }
 }
@@ -11,4 +11,5 @@
 #import <FBXCTestKit/FBXCTestCommandLine.h>
 #import <FBXCTestKit/FBXCTestContext.h>
 #import <FBXCTestKit/FBXCTestDestination.h>
+#import <FBXCTestKit/FBXCTestDurationHistory.h>
 #import <FBXCTestKit/FBXCTestSimulatorConfigurator.h>
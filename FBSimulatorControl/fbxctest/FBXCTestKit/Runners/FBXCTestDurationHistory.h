@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <XCTestBootstrap/XCTestBootstrap.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol FBControlCoreLogger;
+
+/**
+ The Environment Variable for overriding the directory that Duration Histories are stored in.
+ */
+extern NSString *const FBXCTestDurationHistoryDirectoryEnv;
+
+/**
+ A persistent record of how long each Test Case of a Test Bundle took in previous runs.
+ Tests are identified by "TestClass/testMethod", the same form as a test filter.
+
+ Durations are stored as a moving average, so that a single slow run does not dominate.
+ The store is a compact binary plist per Test Bundle, identified by the Bundle ID or the full path of the Test Bundle.
+ Saving holds a file lock while merging with the store on disk, so concurrent runs of different shards of the same Test Bundle do not lose each other's durations.
+
+ The history can be used to schedule work by cost, using Longest Processing Time first scheduling:
+ Ordering the longest tests first and assigning each test to the least-loaded shard gives a makespan within 4/3 of the optimal.
+ */
+@interface FBXCTestDurationHistory : NSObject
+
+#pragma mark Initializers
+
+/**
+ The default directory for storing Duration Histories.
+ This is the value of FBXCTestDurationHistoryDirectoryEnv if set, otherwise a directory in the user's Caches.
+ */
+@property (nonatomic, copy, readonly, class) NSString *defaultDirectory;
+
+/**
+ Loads the Duration History for a Test Bundle.
+ If there is no history, or it cannot be read, the history will be empty.
+
+ @param testBundlePath the path of the Test Bundle.
+ @param directory the directory that histories are stored in.
+ @param logger the logger to log to.
+ @return a Duration History.
+ */
++ (instancetype)historyForTestBundlePath:(NSString *)testBundlePath directory:(NSString *)directory logger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Properties
+
+/**
+ The path of the file that the history is stored in.
+ */
+@property (nonatomic, copy, readonly) NSString *storePath;
+
+/**
+ The identifiers of all of the tests that have a known duration.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSString *> *knownTests;
+
+#pragma mark Recording
+
+/**
+ Records the duration of a Test Case.
+
+ @param duration the duration of the Test Case.
+ @param testClass the class of the Test Case.
+ @param method the method of the Test Case.
+ */
+- (void)recordDuration:(NSTimeInterval)duration forTestClass:(NSString *)testClass method:(NSString *)method;
+
+/**
+ Wraps a reporter, so that the durations of finished Test Cases are recorded.
+ The history is saved when the report is printed.
+
+ @param reporter the reporter to wrap.
+ @return a reporter that forwards to the wrapped reporter.
+ */
+- (id<FBXCTestReporter>)recordingReporterForReporter:(id<FBXCTestReporter>)reporter;
+
+/**
+ Saves the recorded durations, merging with the durations that are already stored.
+
+ @param error an error out for any error that occurs.
+ @return YES if successful, NO otherwise.
+ */
+- (BOOL)saveWithError:(NSError **)error;
+
+#pragma mark Scheduling
+
+/**
+ The expected duration of a test.
+ Tests without a known duration are assumed to take the median of the known durations.
+
+ @param test the test identifier.
+ @return the expected duration.
+ */
+- (NSTimeInterval)expectedDurationForTest:(NSString *)test;
+
+/**
+ The test identifiers selected by test filters.
+ A filter of "TestClass/testMethod" selects that test, whether or not it is known. A filter of "TestClass" selects all of the known tests of the class.
+ Each filter may also contain several comma-separated filters.
+
+ @param testFilters the test filters. If nil or empty, all of the known tests are selected.
+ @return the selected test identifiers, without duplicates.
+ */
+- (NSArray<NSString *> *)testsMatchingFilters:(nullable NSArray<NSString *> *)testFilters;
+
+/**
+ Orders tests so that the longest are first.
+ Tests with equal expected durations keep their relative order.
+
+ @param tests the test identifiers to order.
+ @return the ordered test identifiers.
+ */
+- (NSArray<NSString *> *)testsOrderedLongestFirst:(NSArray<NSString *> *)tests;
+
+/**
+ Partitions tests into shards of balanced expected duration.
+
+ @param tests the test identifiers to partition.
+ @param shardCount the number of shards, must be greater than zero.
+ @return an array of shardCount arrays of test identifiers, each ordered longest first.
+ */
+- (NSArray<NSArray<NSString *> *> *)partitionTests:(NSArray<NSString *> *)tests intoShards:(NSUInteger)shardCount;
+
+/**
+ The estimated time to run tests across a number of parallel workers.
+
+ @param tests the test identifiers. If nil, all of the known tests.
+ @param parallelism the number of workers, must be greater than zero.
+ @return the estimated wall-clock duration.
+ */
+- (NSTimeInterval)estimatedDurationForTests:(nullable NSArray<NSString *> *)tests parallelism:(NSUInteger)parallelism;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,425 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBXCTestDurationHistory.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <sys/file.h>
+
+#import <FBControlCore/FBControlCore.h>
+
+NSString *const FBXCTestDurationHistoryDirectoryEnv = @"FBXCTEST_DURATION_HISTORY_DIRECTORY";
+
+static NSString *const KeyVersion = @"version";
+static NSString *const KeyDurations = @"durations";
+static NSInteger const StoreVersion = 1;
+
+// The weight given to the newest duration in the moving average.
+static double const NewDurationWeight = 0.5;
+// The duration assumed for tests when nothing is known.
+static NSTimeInterval const DefaultDuration = 1.0;
+
+static NSString *TestIdentifier(NSString *testClass, NSString *method)
+{
+  return [NSString stringWithFormat:@"%@/%@", testClass, method];
+}
+
+@interface FBXCTestDurationHistory ()
+
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSNumber *> *durations;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSNumber *> *recordedDurations;
+
+@end
+
+/**
+ Forwards to a reporter, recording the durations of finished test cases.
+ */
+@interface FBXCTestDurationRecordingReporter : NSObject <FBXCTestReporter>
+
+@property (nonatomic, strong, readonly) id<FBXCTestReporter> reporter;
+@property (nonatomic, strong, readonly) FBXCTestDurationHistory *history;
+
+@end
+
+@implementation FBXCTestDurationRecordingReporter
+
+- (instancetype)initWithReporter:(id<FBXCTestReporter>)reporter history:(FBXCTestDurationHistory *)history
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _reporter = reporter;
+  _history = history;
+
+  return self;
+}
+
+#pragma mark NSObject
+
+- (BOOL)respondsToSelector:(SEL)selector
+{
+  // The variant with logs is preferred by callers if implemented, so this must only be implemented if the wrapped reporter does.
+  if (selector == @selector(testCaseDidFinishForTestClass:method:withStatus:duration:logs:)) {
+    return [self.reporter respondsToSelector:selector];
+  }
+  return [super respondsToSelector:selector] || [self.reporter respondsToSelector:selector];
+}
+
+- (id)forwardingTargetForSelector:(SEL)selector
+{
+  return self.reporter;
+}
+
+#pragma mark FBXCTestReporter
+
+- (void)processWaitingForDebuggerWithProcessIdentifier:(pid_t)pid
+{
+  [self.reporter processWaitingForDebuggerWithProcessIdentifier:pid];
+}
+
+- (void)debuggerAttached
+{
+  [self.reporter debuggerAttached];
+}
+
+- (void)didBeginExecutingTestPlan
+{
+  [self.reporter didBeginExecutingTestPlan];
+}
+
+- (void)didFinishExecutingTestPlan
+{
+  [self.reporter didFinishExecutingTestPlan];
+}
+
+- (void)testSuite:(NSString *)testSuite didStartAt:(NSString *)startTime
+{
+  [self.reporter testSuite:testSuite didStartAt:startTime];
+}
+
+- (void)testCaseDidFinishForTestClass:(NSString *)testClass method:(NSString *)method withStatus:(FBTestReportStatus)status duration:(NSTimeInterval)duration
+{
+  [self.history recordDuration:duration forTestClass:testClass method:method];
+  [self.reporter testCaseDidFinishForTestClass:testClass method:method withStatus:status duration:duration];
+}
+
+- (void)testCaseDidFinishForTestClass:(NSString *)testClass method:(NSString *)method withStatus:(FBTestReportStatus)status duration:(NSTimeInterval)duration logs:(nullable NSArray *)logs
+{
+  [self.history recordDuration:duration forTestClass:testClass method:method];
+  [self.reporter testCaseDidFinishForTestClass:testClass method:method withStatus:status duration:duration logs:logs];
+}
+
+- (void)testCaseDidFailForTestClass:(NSString *)testClass method:(NSString *)method withMessage:(NSString *)message file:(NSString *)file line:(NSUInteger)line
+{
+  [self.reporter testCaseDidFailForTestClass:testClass method:method withMessage:message file:file line:line];
+}
+
+- (void)testCaseDidStartForTestClass:(NSString *)testClass method:(NSString *)method
+{
+  [self.reporter testCaseDidStartForTestClass:testClass method:method];
+}
+
+- (void)finishedWithSummary:(FBTestManagerResultSummary *)summary
+{
+  [self.reporter finishedWithSummary:summary];
+}
+
+- (void)testHadOutput:(NSString *)output
+{
+  [self.reporter testHadOutput:output];
+}
+
+- (void)handleExternalEvent:(NSString *)event
+{
+  [self.reporter handleExternalEvent:event];
+}
+
+- (BOOL)printReportWithError:(NSError **)error
+{
+  // Failing to save the history should not fail the test run.
+  NSError *saveError = nil;
+  if (![self.history saveWithError:&saveError]) {
+    [self.history.logger logFormat:@"Failed to save test duration history: %@", saveError];
+  }
+  return [self.reporter printReportWithError:error];
+}
+
+@end
+
+@implementation FBXCTestDurationHistory
+
+#pragma mark Initializers
+
++ (NSString *)defaultDirectory
+{
+  NSString *directory = NSProcessInfo.processInfo.environment[FBXCTestDurationHistoryDirectoryEnv];
+  if (directory.length) {
+    return directory;
+  }
+  NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject ?: NSTemporaryDirectory();
+  return [[caches stringByAppendingPathComponent:@"fbxctest"] stringByAppendingPathComponent:@"durations"];
+}
+
++ (instancetype)historyForTestBundlePath:(NSString *)testBundlePath directory:(NSString *)directory logger:(nullable id<FBControlCoreLogger>)logger
+{
+  NSString *storePath = [directory stringByAppendingPathComponent:[self storeNameForTestBundlePath:testBundlePath]];
+  NSDictionary<NSString *, NSNumber *> *durations = [self durationsAtPath:storePath logger:logger];
+  return [[self alloc] initWithStorePath:storePath durations:durations logger:logger];
+}
+
+- (instancetype)initWithStorePath:(NSString *)storePath durations:(NSDictionary<NSString *, NSNumber *> *)durations logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _storePath = storePath;
+  _logger = logger;
+  _durations = [durations mutableCopy];
+  _recordedDurations = [NSMutableDictionary dictionary];
+
+  return self;
+}
+
+#pragma mark Properties
+
+- (NSArray<NSString *> *)knownTests
+{
+  @synchronized (self) {
+    return [self.durations.allKeys sortedArrayUsingSelector:@selector(compare:)];
+  }
+}
+
+#pragma mark Recording
+
+- (void)recordDuration:(NSTimeInterval)duration forTestClass:(NSString *)testClass method:(NSString *)method
+{
+  if (duration < 0) {
+    return;
+  }
+  NSString *test = TestIdentifier(testClass, method);
+  @synchronized (self) {
+    self.recordedDurations[test] = @(duration);
+    self.durations[test] = @([self.class averageOfDuration:self.durations[test] withDuration:duration]);
+  }
+}
+
+- (id<FBXCTestReporter>)recordingReporterForReporter:(id<FBXCTestReporter>)reporter
+{
+  return [[FBXCTestDurationRecordingReporter alloc] initWithReporter:reporter history:self];
+}
+
+- (BOOL)saveWithError:(NSError **)error
+{
+  @synchronized (self) {
+    if (self.recordedDurations.count == 0) {
+      return YES;
+    }
+    if (![NSFileManager.defaultManager createDirectoryAtPath:self.storePath.stringByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:error]) {
+      return NO;
+    }
+    // Shards of the same Test Bundle may be saving at the same time from other processes.
+    // The lock is held across the load, merge and write so that no shard's durations are lost.
+    NSString *lockPath = [self.storePath stringByAppendingPathExtension:@"lock"];
+    int lockDescriptor = open(lockPath.fileSystemRepresentation, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lockDescriptor < 0) {
+      return [[FBXCTestError
+        describeFormat:@"Could not open test duration history lock %@: %s", lockPath, strerror(errno)]
+        failBool:error];
+    }
+    if (flock(lockDescriptor, LOCK_EX) != 0) {
+      close(lockDescriptor);
+      return [[FBXCTestError
+        describeFormat:@"Could not lock test duration history %@: %s", lockPath, strerror(errno)]
+        failBool:error];
+    }
+    BOOL success = [self mergeRecordedDurationsWithError:error];
+    flock(lockDescriptor, LOCK_UN);
+    close(lockDescriptor);
+    return success;
+  }
+}
+
+#pragma mark Scheduling
+
+- (NSTimeInterval)expectedDurationForTest:(NSString *)test
+{
+  @synchronized (self) {
+    NSNumber *duration = self.durations[test];
+    return duration ? duration.doubleValue : self.medianDuration;
+  }
+}
+
+- (NSArray<NSString *> *)testsMatchingFilters:(nullable NSArray<NSString *> *)testFilters
+{
+  NSArray<NSString *> *knownTests = self.knownTests;
+  if (testFilters.count == 0) {
+    return knownTests;
+  }
+  NSMutableOrderedSet<NSString *> *tests = [NSMutableOrderedSet orderedSet];
+  for (NSString *filters in testFilters) {
+    for (NSString *filter in [filters componentsSeparatedByString:@","]) {
+      if (filter.length == 0) {
+        continue;
+      }
+      if ([filter containsString:@"/"]) {
+        [tests addObject:filter];
+        continue;
+      }
+      NSString *classPrefix = [filter stringByAppendingString:@"/"];
+      for (NSString *test in knownTests) {
+        if ([test hasPrefix:classPrefix]) {
+          [tests addObject:test];
+        }
+      }
+    }
+  }
+  return tests.array;
+}
+
+- (NSArray<NSString *> *)testsOrderedLongestFirst:(NSArray<NSString *> *)tests
+{
+  NSDictionary<NSString *, NSNumber *> *expected = [self expectedDurationsForTests:tests];
+  return [tests sortedArrayWithOptions:NSSortStable usingComparator:^ NSComparisonResult (NSString *left, NSString *right) {
+    return [expected[right] compare:expected[left]];
+  }];
+}
+
+- (NSArray<NSArray<NSString *> *> *)partitionTests:(NSArray<NSString *> *)tests intoShards:(NSUInteger)shardCount
+{
+  NSParameterAssert(shardCount > 0);
+  NSDictionary<NSString *, NSNumber *> *expected = [self expectedDurationsForTests:tests];
+  NSMutableArray<NSMutableArray<NSString *> *> *shards = [NSMutableArray array];
+  NSTimeInterval loads[shardCount];
+  for (NSUInteger index = 0; index < shardCount; index++) {
+    [shards addObject:[NSMutableArray array]];
+    loads[index] = 0;
+  }
+  for (NSString *test in [self testsOrderedLongestFirst:tests]) {
+    NSUInteger leastLoaded = 0;
+    for (NSUInteger index = 1; index < shardCount; index++) {
+      if (loads[index] < loads[leastLoaded]) {
+        leastLoaded = index;
+      }
+    }
+    [shards[leastLoaded] addObject:test];
+    loads[leastLoaded] += expected[test].doubleValue;
+  }
+  return shards;
+}
+
+- (NSTimeInterval)estimatedDurationForTests:(nullable NSArray<NSString *> *)tests parallelism:(NSUInteger)parallelism
+{
+  NSParameterAssert(parallelism > 0);
+  tests = tests ?: self.knownTests;
+  NSDictionary<NSString *, NSNumber *> *expected = [self expectedDurationsForTests:tests];
+  NSTimeInterval makespan = 0;
+  for (NSArray<NSString *> *shard in [self partitionTests:tests intoShards:parallelism]) {
+    NSTimeInterval load = 0;
+    for (NSString *test in shard) {
+      load += expected[test].doubleValue;
+    }
+    makespan = MAX(makespan, load);
+  }
+  return makespan;
+}
+
+#pragma mark Private
+
++ (NSString *)storeNameForTestBundlePath:(NSString *)testBundlePath
+{
+  // Different Test Bundles can share a file name, so the store is named after the Bundle ID, or the full path if there isn't one.
+  NSString *key = [NSBundle bundleWithPath:testBundlePath].bundleIdentifier ?: testBundlePath.stringByStandardizingPath;
+  const char *representation = key.UTF8String;
+  unsigned char bytes[CC_SHA256_DIGEST_LENGTH];
+  CC_SHA256(representation, (CC_LONG) strlen(representation), bytes);
+  NSMutableString *name = [NSMutableString stringWithFormat:@"%@-", testBundlePath.lastPathComponent.stringByDeletingPathExtension];
+  for (NSUInteger index = 0; index < 8; index++) {
+    [name appendFormat:@"%02x", bytes[index]];
+  }
+  return [name stringByAppendingPathExtension:@"plist"];
+}
+
+- (BOOL)mergeRecordedDurationsWithError:(NSError **)error
+{
+  // Another run may have saved since this history was loaded, so merge the durations from this run into what is on disk now.
+  NSMutableDictionary<NSString *, NSNumber *> *durations = [[self.class durationsAtPath:self.storePath logger:self.logger] mutableCopy];
+  for (NSString *test in self.recordedDurations) {
+    durations[test] = @([self.class averageOfDuration:durations[test] withDuration:self.recordedDurations[test].doubleValue]);
+  }
+  NSDictionary<NSString *, id> *store = @{
+    KeyVersion: @(StoreVersion),
+    KeyDurations: durations,
+  };
+  NSData *data = [NSPropertyListSerialization dataWithPropertyList:store format:NSPropertyListBinaryFormat_v1_0 options:0 error:error];
+  if (!data) {
+    return NO;
+  }
+  if (![data writeToFile:self.storePath options:NSDataWritingAtomic error:error]) {
+    return NO;
+  }
+  [self.durations setDictionary:durations];
+  [self.recordedDurations removeAllObjects];
+  return YES;
+}
+
++ (NSDictionary<NSString *, NSNumber *> *)durationsAtPath:(NSString *)path logger:(nullable id<FBControlCoreLogger>)logger
+{
+  NSData *data = [NSData dataWithContentsOfFile:path];
+  if (!data) {
+    return @{};
+  }
+  NSError *error = nil;
+  NSDictionary<NSString *, id> *store = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:nil error:&error];
+  if (![store isKindOfClass:NSDictionary.class] || ![store[KeyVersion] isEqual:@(StoreVersion)]) {
+    [logger logFormat:@"Ignoring unreadable test duration history at %@ %@", path, error ?: @""];
+    return @{};
+  }
+  NSDictionary<NSString *, NSNumber *> *durations = store[KeyDurations];
+  if (![FBCollectionInformation isDictionaryHeterogeneous:durations keyClass:NSString.class valueClass:NSNumber.class]) {
+    [logger logFormat:@"Ignoring malformed test duration history at %@", path];
+    return @{};
+  }
+  return durations;
+}
+
++ (NSTimeInterval)averageOfDuration:(nullable NSNumber *)previous withDuration:(NSTimeInterval)duration
+{
+  if (!previous) {
+    return duration;
+  }
+  return (previous.doubleValue * (1 - NewDurationWeight)) + (duration * NewDurationWeight);
+}
+
+- (NSTimeInterval)medianDuration
+{
+  NSArray<NSNumber *> *sorted = [self.durations.allValues sortedArrayUsingSelector:@selector(compare:)];
+  if (sorted.count == 0) {
+    return DefaultDuration;
+  }
+  return sorted[sorted.count / 2].doubleValue;
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)expectedDurationsForTests:(NSArray<NSString *> *)tests
+{
+  @synchronized (self) {
+    NSTimeInterval median = self.medianDuration;
+    NSMutableDictionary<NSString *, NSNumber *> *expected = [NSMutableDictionary dictionaryWithCapacity:tests.count];
+    for (NSString *test in tests) {
+      expected[test] = self.durations[test] ?: @(median);
+    }
+    return expected;
+  }
+}
+
+@end
@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <FBControlCore/FBControlCore.h>
+#import <FBXCTestKit/FBXCTestKit.h>
+
+@interface FBXCTestDurationHistoryTests : XCTestCase
+
+@property (nonatomic, copy) NSString *directory;
+
+@end
+
+@implementation FBXCTestDurationHistoryTests
+
+- (void)setUp
+{
+  [super setUp];
+
+  self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+}
+
+- (void)tearDown
+{
+  [NSFileManager.defaultManager removeItemAtPath:self.directory error:nil];
+
+  [super tearDown];
+}
+
+- (FBXCTestDurationHistory *)history
+{
+  return [FBXCTestDurationHistory historyForTestBundlePath:@"/tmp/Foo.xctest" directory:self.directory logger:nil];
+}
+
+- (void)testEmptyHistory
+{
+  FBXCTestDurationHistory *history = self.history;
+  XCTAssertEqualObjects(history.knownTests, @[]);
+  XCTAssertEqual([history expectedDurationForTest:@"Foo/testBar"], 1.0);
+  XCTAssertTrue([history saveWithError:nil]);
+  XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:history.storePath]);
+}
+
+- (void)testPersistsDurations
+{
+  FBXCTestDurationHistory *history = self.history;
+  [history recordDuration:2 forTestClass:@"Foo" method:@"testSlow"];
+  [history recordDuration:0.5 forTestClass:@"Foo" method:@"testFast"];
+  NSError *error = nil;
+  XCTAssertTrue([history saveWithError:&error]);
+  XCTAssertNil(error);
+
+  FBXCTestDurationHistory *loaded = self.history;
+  XCTAssertEqualObjects(loaded.knownTests, (@[@"Foo/testFast", @"Foo/testSlow"]));
+  XCTAssertEqual([loaded expectedDurationForTest:@"Foo/testSlow"], 2);
+  XCTAssertEqual([loaded expectedDurationForTest:@"Foo/testFast"], 0.5);
+}
+
+- (void)testAveragesDurationsAcrossRuns
+{
+  FBXCTestDurationHistory *first = self.history;
+  [first recordDuration:4 forTestClass:@"Foo" method:@"testBar"];
+  XCTAssertTrue([first saveWithError:nil]);
+
+  FBXCTestDurationHistory *second = self.history;
+  [second recordDuration:2 forTestClass:@"Foo" method:@"testBar"];
+  XCTAssertTrue([second saveWithError:nil]);
+
+  XCTAssertEqual([self.history expectedDurationForTest:@"Foo/testBar"], 3);
+}
+
+- (void)testMergesConcurrentSaves
+{
+  FBXCTestDurationHistory *first = self.history;
+  FBXCTestDurationHistory *second = self.history;
+  [first recordDuration:1 forTestClass:@"Foo" method:@"testOne"];
+  [second recordDuration:2 forTestClass:@"Foo" method:@"testTwo"];
+  XCTAssertTrue([first saveWithError:nil]);
+  XCTAssertTrue([second saveWithError:nil]);
+
+  XCTAssertEqualObjects(self.history.knownTests, (@[@"Foo/testOne", @"Foo/testTwo"]));
+}
+
+- (void)testIgnoresCorruptStore
+{
+  [NSFileManager.defaultManager createDirectoryAtPath:self.directory withIntermediateDirectories:YES attributes:nil error:nil];
+  [[@"garbage" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:self.history.storePath atomically:YES];
+
+  XCTAssertEqualObjects(self.history.knownTests, @[]);
+}
+
+- (void)testSchedulesLongestFirstAcrossShards
+{
+  FBXCTestDurationHistory *history = self.history;
+  [history recordDuration:7 forTestClass:@"Foo" method:@"a"];
+  [history recordDuration:5 forTestClass:@"Foo" method:@"b"];
+  [history recordDuration:4 forTestClass:@"Foo" method:@"c"];
+  [history recordDuration:3 forTestClass:@"Foo" method:@"d"];
+  [history recordDuration:1 forTestClass:@"Foo" method:@"e"];
+  NSArray<NSString *> *tests = @[@"Foo/e", @"Foo/c", @"Foo/a", @"Foo/d", @"Foo/b"];
+
+  XCTAssertEqualObjects([history testsOrderedLongestFirst:tests], (@[@"Foo/a", @"Foo/b", @"Foo/c", @"Foo/d", @"Foo/e"]));
+
+  NSArray<NSArray<NSString *> *> *shards = [history partitionTests:tests intoShards:2];
+  XCTAssertEqualObjects(shards, (@[
+    @[@"Foo/a", @"Foo/d"],
+    @[@"Foo/b", @"Foo/c", @"Foo/e"],
+  ]));
+  XCTAssertEqual([history estimatedDurationForTests:tests parallelism:2], 10);
+  XCTAssertEqual([history estimatedDurationForTests:nil parallelism:1], 20);
+}
+
+- (void)testEstimatesOnlyFilteredTests
+{
+  FBXCTestDurationHistory *history = self.history;
+  [history recordDuration:7 forTestClass:@"Foo" method:@"a"];
+  [history recordDuration:5 forTestClass:@"Foo" method:@"b"];
+  [history recordDuration:3 forTestClass:@"Bar" method:@"c"];
+
+  XCTAssertEqualObjects([history testsMatchingFilters:nil], (@[@"Bar/c", @"Foo/a", @"Foo/b"]));
+  XCTAssertEqualObjects([history testsMatchingFilters:@[@"Foo"]], (@[@"Foo/a", @"Foo/b"]));
+  XCTAssertEqualObjects([history testsMatchingFilters:@[@"Bar/c,Foo/a", @"Foo/a", @"Foo/unknown"]], (@[@"Bar/c", @"Foo/a", @"Foo/unknown"]));
+
+  XCTAssertEqual([history estimatedDurationForTests:[history testsMatchingFilters:@[@"Foo"]] parallelism:1], 12);
+  // The unknown test is assumed to take the median duration.
+  XCTAssertEqual([history estimatedDurationForTests:[history testsMatchingFilters:@[@"Foo/a", @"Foo/unknown"]] parallelism:1], 12);
+  XCTAssertEqual([history estimatedDurationForTests:[history testsMatchingFilters:@[@"Foo/a", @"Foo/unknown"]] parallelism:2], 7);
+}
+
+- (void)testSeparatesBundlesWithTheSameName
+{
+  FBXCTestDurationHistory *first = [FBXCTestDurationHistory historyForTestBundlePath:@"/tmp/A/Foo.xctest" directory:self.directory logger:nil];
+  FBXCTestDurationHistory *second = [FBXCTestDurationHistory historyForTestBundlePath:@"/tmp/B/Foo.xctest" directory:self.directory logger:nil];
+  XCTAssertNotEqualObjects(first.storePath, second.storePath);
+
+  [first recordDuration:2 forTestClass:@"Foo" method:@"testBar"];
+  XCTAssertTrue([first saveWithError:nil]);
+  XCTAssertEqualObjects([FBXCTestDurationHistory historyForTestBundlePath:@"/tmp/B/Foo.xctest" directory:self.directory logger:nil].knownTests, @[]);
+  XCTAssertEqualObjects([FBXCTestDurationHistory historyForTestBundlePath:@"/tmp/A/../A/Foo.xctest" directory:self.directory logger:nil].knownTests, @[@"Foo/testBar"]);
+}
+
+- (void)testMergesSavesFromManyShards
+{
+  // Each history saves under the file lock from its own queue, as separate shards would.
+  dispatch_group_t group = dispatch_group_create();
+  for (NSUInteger index = 0; index < 16; index++) {
+    dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+      FBXCTestDurationHistory *history = self.history;
+      [history recordDuration:1 forTestClass:@"Foo" method:[NSString stringWithFormat:@"test%lu", (unsigned long) index]];
+      XCTAssertTrue([history saveWithError:nil]);
+    });
+  }
+  dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+  XCTAssertEqual(self.history.knownTests.count, 16u);
+}
+
+- (void)testUnknownTestsUseMedianDuration
+{
+  FBXCTestDurationHistory *history = self.history;
+  [history recordDuration:1 forTestClass:@"Foo" method:@"a"];
+  [history recordDuration:3 forTestClass:@"Foo" method:@"b"];
+  [history recordDuration:9 forTestClass:@"Foo" method:@"c"];
+
+  XCTAssertEqual([history expectedDurationForTest:@"Foo/unknown"], 3);
+}
+
+@end
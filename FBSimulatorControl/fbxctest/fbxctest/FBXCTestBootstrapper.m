@@ -59,6 +59,17 @@
   }
 }
 
+- (nullable NSArray<NSString *> *)testFiltersForConfiguration:(FBXCTestConfiguration *)configuration
+{
+  if ([configuration isKindOfClass:FBLogicTestConfiguration.class]) {
+    return [(FBLogicTestConfiguration *) configuration testFilters];
+  }
+  if ([configuration isKindOfClass:FBTestManagerTestConfiguration.class]) {
+    return [(FBTestManagerTestConfiguration *) configuration testFilters];
+  }
+  return nil;
+}
+
 - (BOOL)bootstrap
 {
   NSError *error;
@@ -91,7 +102,13 @@
     return [self printErrorMessage:error file:__FILE__ line:__LINE__];
   }
   id<FBDataConsumer> stdOutFileWriter = [FBFileWriter syncWriterWithFileHandle:NSFileHandle.fileHandleWithStandardOutput];
-  FBJSONTestReporter *reporter = [[FBJSONTestReporter alloc] initWithTestBundlePath:commandLine.configuration.testBundlePath testType:commandLine.configuration.testType logger:self.logger dataConsumer:stdOutFileWriter];
+  id<FBXCTestReporter> reporter = [[FBJSONTestReporter alloc] initWithTestBundlePath:commandLine.configuration.testBundlePath testType:commandLine.configuration.testType logger:self.logger dataConsumer:stdOutFileWriter];
+  if (![commandLine.configuration isKindOfClass:FBListTestConfiguration.class]) {
+    FBXCTestDurationHistory *history = [FBXCTestDurationHistory historyForTestBundlePath:commandLine.configuration.testBundlePath directory:FBXCTestDurationHistory.defaultDirectory logger:self.logger];
+    NSArray<NSString *> *tests = [history testsMatchingFilters:[self testFiltersForConfiguration:commandLine.configuration]];
+    [self.logger.info logFormat:@"Estimated test duration from %lu previous test durations: %.2fs", (unsigned long) history.knownTests.count, [history estimatedDurationForTests:tests parallelism:1]];
+    reporter = [history recordingReporterForReporter:reporter];
+  }
   FBXCTestContext *context = [FBXCTestContext contextWithReporter:reporter logger:self.logger];
 
   [self.logger.info logFormat:@"Bootstrapping Test Runner with Configuration %@", [FBCollectionInformation oneLineJSONDescription:commandLine.configuration]];